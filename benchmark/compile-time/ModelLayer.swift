@@ -0,0 +1,112 @@
+//===--- ModelLayer.swift - Application-style model code ------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// The kind of code found in the model layer of an application: value types,
+// an enum with payloads, protocol extensions and closure-heavy collection
+// code that leans on type inference.
+
+enum JSON {
+  case Null
+  case Bool(Swift.Bool)
+  case Number(Double)
+  case Text(String)
+  case List([JSON])
+  case Object([String: JSON])
+
+  subscript(key: String) -> JSON {
+    if case .Object(let fields) = self, let value = fields[key] {
+      return value
+    }
+    return .Null
+  }
+
+  var number: Double? {
+    if case .Number(let value) = self { return value }
+    return nil
+  }
+
+  var text: String? {
+    if case .Text(let value) = self { return value }
+    return nil
+  }
+}
+
+protocol JSONDecodable {
+  init?(json: JSON)
+}
+
+extension JSONDecodable {
+  static func decodeList(json: JSON) -> [Self] {
+    guard case .List(let elements) = json else { return [] }
+    return elements.flatMap { Self(json: $0) }
+  }
+}
+
+struct Address : JSONDecodable {
+  var street: String
+  var city: String
+
+  init?(json: JSON) {
+    guard let street = json["street"].text, city = json["city"].text else {
+      return nil
+    }
+    self.street = street
+    self.city = city
+  }
+}
+
+struct Customer : JSONDecodable {
+  var name: String
+  var age: Int
+  var addresses: [Address]
+
+  init?(json: JSON) {
+    guard let name = json["name"].text, age = json["age"].number else {
+      return nil
+    }
+    self.name = name
+    self.age = Int(age)
+    self.addresses = Address.decodeList(json["addresses"])
+  }
+}
+
+struct Order {
+  var customer: Customer
+  var items: [(name: String, price: Double, quantity: Int)]
+
+  var total: Double {
+    return items.map { $0.price * Double($0.quantity) }.reduce(0, combine: +)
+  }
+}
+
+func report(orders: [Order]) -> [String: Double] {
+  var totals = [String: Double]()
+  for order in orders.filter({ $0.customer.age >= 18 }) {
+    let city = order.customer.addresses.first?.city ?? "unknown"
+    totals[city] = (totals[city] ?? 0) + order.total
+  }
+  return totals
+}
+
+let payload = JSON.List([
+  .Object(["name": .Text("Ann"), "age": .Number(34),
+           "addresses": .List([.Object(["street": .Text("1 Main St"),
+                                        "city": .Text("Springfield")])])]),
+  .Object(["name": .Text("Bob"), "age": .Number(17), "addresses": .List([])]),
+])
+
+let customers = Customer.decodeList(payload)
+let orders = customers.map {
+  Order(customer: $0, items: [("book", 12.5, 2), ("pen", 1.25, 10)])
+}
+let totals = report(orders)
+print(totals.sort { $0.1 > $1.1 }.map { "\($0.0): \($0.1)" })
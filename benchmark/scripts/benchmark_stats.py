@@ -0,0 +1,69 @@
+##===--- benchmark_stats.py ---------------------------*- coding: utf-8 -*-===##
+##
+## This source file is part of the Swift.org open source project
+##
+## Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+## Licensed under Apache License v2.0 with Runtime Library Exception
+##
+## See http://swift.org/LICENSE.txt for license information
+## See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+##
+##===----------------------------------------------------------------------===##
+
+# Robust statistics shared by Benchmark_Driver and Compile_Time_Driver.
+
+
+def median(values):
+    values = sorted(values)
+    mid = len(values) // 2
+    if len(values) % 2:
+        return values[mid]
+    return (values[mid - 1] + values[mid]) / 2.0
+
+
+def median_absolute_deviation(values):
+    m = median(values)
+    return median([abs(v - m) for v in values])
+
+
+def reject_outliers(samples, max_mads):
+    """Drop samples that are more than max_mads scaled MADs from the median.
+
+    1.4826 scales the MAD to estimate the standard deviation of normally
+    distributed samples.
+    """
+    m = median(samples)
+    limit = max_mads * 1.4826 * median_absolute_deviation(samples)
+    if limit == 0:
+        return samples
+    return [s for s in samples if abs(s - m) <= limit]
+
+
+def summarize(samples, max_mads):
+    """Returns the sample count, number of outliers, and the minimum, median
+    and MAD of the samples that are not outliers."""
+    kept = reject_outliers(samples, max_mads)
+    return {
+        'samples': len(samples),
+        'outliers': len(samples) - len(kept),
+        'min': min(kept),
+        'median': median(kept),
+        'mad': median_absolute_deviation(kept),
+    }
+
+
+def classify_change(old, new, threshold):
+    """Compares two results of summarize().
+
+    Returns the change of the median in percent, and 'regression',
+    'improvement' or '' depending on whether the change is significant: it
+    has to exceed threshold percent and three times the MAD of either run.
+    """
+    if old['median'] == 0:
+        return 0.0, ''
+    delta = new['median'] - old['median']
+    percent = 100.0 * delta / old['median']
+    noise = 3 * max(old['mad'], new['mad'])
+    if abs(percent) <= threshold or abs(delta) <= noise:
+        return percent, ''
+    return percent, 'regression' if delta > 0 else 'improvement'
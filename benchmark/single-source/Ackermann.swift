@@ -0,0 +1,30 @@
+//===--- Ackermann.swift - Deep recursion ---------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+func ackermann(m: Int, _ n: Int) -> Int {
+  if m == 0 { return n + 1 }
+  if n == 0 { return ackermann(m - 1, 1) }
+  return ackermann(m - 1, ackermann(m, n - 1))
+}
+
+@inline(never)
+func run_Ackermann(N: Int) {
+  for _ in 0..<N {
+    let result = ackermann(2, 200)
+    if result != 403 {
+      print("Ackermann: incorrect result \(result)")
+      return
+    }
+  }
+}
+
+run_Ackermann(Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
@@ -0,0 +1,31 @@
+//===--- ArrayAppend.swift - Growing arrays -------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+@inline(never)
+func run_ArrayAppend(N: Int) {
+  for _ in 0..<N {
+    var numbers = [Int]()
+    for i in 0..<40_000 {
+      numbers.append(i)
+    }
+    var strings = [String]()
+    for i in 0..<1_000 {
+      strings.append(String(i))
+    }
+    if numbers.count != 40_000 || strings.count != 1_000 {
+      print("ArrayAppend: incorrect count")
+      return
+    }
+  }
+}
+
+run_ArrayAppend(Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
@@ -0,0 +1,52 @@
+//===--- ClassTreeTraversal.swift - Reference counting --------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+final class Node {
+  let value: Int
+  var left: Node?
+  var right: Node?
+
+  init(_ value: Int) {
+    self.value = value
+  }
+}
+
+func buildTree(depth: Int, _ value: Int) -> Node {
+  let node = Node(value)
+  if depth > 0 {
+    node.left = buildTree(depth - 1, 2 * value)
+    node.right = buildTree(depth - 1, 2 * value + 1)
+  }
+  return node
+}
+
+func sumTree(node: Node?) -> Int {
+  guard let node = node else { return 0 }
+  return node.value + sumTree(node.left) + sumTree(node.right)
+}
+
+@inline(never)
+func run_ClassTreeTraversal(N: Int) {
+  let depth = 12
+  let nodes = (1 << (depth + 1)) - 1
+  for _ in 0..<N {
+    let tree = buildTree(depth, 1)
+    let sum = sumTree(tree)
+    if sum != nodes * (nodes + 1) / 2 {
+      print("ClassTreeTraversal: incorrect result \(sum)")
+      return
+    }
+  }
+}
+
+run_ClassTreeTraversal(
+  Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
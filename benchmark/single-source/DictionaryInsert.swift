@@ -0,0 +1,36 @@
+//===--- DictionaryInsert.swift - Hashing and lookup ----------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+@inline(never)
+func run_DictionaryInsert(N: Int) {
+  let size = 10_000
+  for _ in 0..<N {
+    var dict = [Int: Int]()
+    for i in 0..<size {
+      dict[i] = i * 3
+    }
+    var sum = 0
+    for i in 0..<size {
+      sum += dict[i]!
+    }
+    for i in 0..<size where i % 2 == 0 {
+      dict.removeValueForKey(i)
+    }
+    if sum != 3 * size * (size - 1) / 2 || dict.count != size / 2 {
+      print("DictionaryInsert: incorrect result \(sum)")
+      return
+    }
+  }
+}
+
+run_DictionaryInsert(
+  Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
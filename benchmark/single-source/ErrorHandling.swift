@@ -0,0 +1,51 @@
+//===--- ErrorHandling.swift - Throwing and catching errors --------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// A parser which rejects most of its input. Every rejection throws and
+// catches an error, so this measures the throw-and-catch rate of simple
+// error enums.
+
+enum ParseError : ErrorType {
+  case Empty
+  case UnexpectedCharacter(Int)
+}
+
+@inline(never)
+func parseDigit(c: Int) throws -> Int {
+  if c == 0 { throw ParseError.Empty }
+  if c < 48 || c > 57 { throw ParseError.UnexpectedCharacter(c) }
+  return c - 48
+}
+
+@inline(never)
+func run_ErrorHandling(N: Int) {
+  var accepted = 0
+  var rejected = 0
+  for _ in 0..<N {
+    for c in 0..<1000 {
+      do {
+        accepted += try parseDigit(c)
+      } catch ParseError.Empty {
+        rejected += 1
+      } catch ParseError.UnexpectedCharacter(let c) {
+        rejected += c & 1
+      } catch {
+        rejected += 2
+      }
+    }
+  }
+  if accepted != 45 * N || rejected != 496 * N {
+    print("ErrorHandling: incorrect result \(accepted) \(rejected)")
+  }
+}
+
+run_ErrorHandling(Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
@@ -0,0 +1,73 @@
+//===--- RC4.swift - Byte-level stream cipher -----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+struct RC4 {
+  var state = [UInt8](count: 256, repeatedValue: 0)
+  var i: UInt8 = 0
+  var j: UInt8 = 0
+
+  init(key: [UInt8]) {
+    for k in 0..<256 {
+      state[k] = UInt8(k)
+    }
+    var j: UInt8 = 0
+    for k in 0..<256 {
+      j = j &+ state[k] &+ key[k % key.count]
+      swapByIndex(k, Int(j))
+    }
+  }
+
+  mutating func swapByIndex(x: Int, _ y: Int) {
+    let t = state[x]
+    state[x] = state[y]
+    state[y] = t
+  }
+
+  mutating func next() -> UInt8 {
+    i = i &+ 1
+    j = j &+ state[Int(i)]
+    swapByIndex(Int(i), Int(j))
+    return state[Int(state[Int(i)] &+ state[Int(j)])]
+  }
+
+  mutating func encrypt(inout data: [UInt8]) {
+    for k in 0..<data.count {
+      data[k] = data[k] ^ next()
+    }
+  }
+}
+
+@inline(never)
+func run_RC4(N: Int) {
+  let secret = Array("This is my secret message".utf8)
+  let key = Array("This is my key".utf8)
+  var message = [UInt8]()
+  for k in 0..<5_000 {
+    message.append(secret[k % secret.count])
+  }
+  let original = message
+
+  for _ in 0..<N {
+    var encoder = RC4(key: key)
+    var decoder = RC4(key: key)
+    for _ in 0..<10 {
+      encoder.encrypt(&message)
+      decoder.encrypt(&message)
+    }
+    if message != original {
+      print("RC4: decryption failed")
+      return
+    }
+  }
+}
+
+run_RC4(Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
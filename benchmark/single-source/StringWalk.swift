@@ -0,0 +1,45 @@
+//===--- StringWalk.swift - Character iteration ---------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+let text = "Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do " +
+  "eiusmod tempor incididunt ut labore et dolore magna aliqua. Ut enim ad " +
+  "minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip " +
+  "ex ea commodo consequat. \u{1F1FA}\u{1F1F8} caf\u{E9} na\u{EF}ve"
+
+@inline(never)
+func countSpaces(s: String) -> (characters: Int, spaces: Int) {
+  var characters = 0
+  var spaces = 0
+  for c in s.characters {
+    characters += 1
+    if c == " " {
+      spaces += 1
+    }
+  }
+  return (characters, spaces)
+}
+
+@inline(never)
+func run_StringWalk(N: Int) {
+  let (expectedCharacters, expectedSpaces) = countSpaces(text)
+  for _ in 0..<N {
+    for _ in 0..<50 {
+      let (characters, spaces) = countSpaces(text)
+      if characters != expectedCharacters || spaces != expectedSpaces {
+        print("StringWalk: incorrect result")
+        return
+      }
+    }
+  }
+}
+
+run_StringWalk(Process.arguments.count > 1 ? Int(Process.arguments[1])! : 1)
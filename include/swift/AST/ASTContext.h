@@ -80,6 +80,7 @@ namespace swift {
   class DiagnosticEngine;
   class Substitution;
   class TypeCheckerDebugConsumer;
+  class FrontendStats;
   class DocComment;
 
   enum class KnownProtocolKind : uint8_t;
@@ -214,9 +215,17 @@ public:
   /// This state should be tracked somewhere else.
   unsigned LastCheckedExternalDefinition = 0;
 
+  /// Incremented whenever declarations may be added to a module after it
+  /// has been loaded, for example when an operator is derived for a protocol
+  /// conformance. This invalidates Module::getReexportLookupCache.
+  unsigned ModuleContentsGeneration = 0;
+
   /// A consumer of type checker debug output.
   std::unique_ptr<TypeCheckerDebugConsumer> TypeCheckerDebug;
 
+  /// If non-null, the statistics being gathered for this compilation.
+  FrontendStats *Stats = nullptr;
+
   /// Cache for names of canonical GenericTypeParamTypes.
   mutable llvm::DenseMap<unsigned, Identifier>
     CanonicalGenericTypeParamTypeNames;
@@ -250,10 +259,19 @@ public:
 
     if (LangOpts.UseMalloc)
       return AlignedAlloc(bytes, alignment);
+
+    // The constraint solver arena belongs to a single type checker.
+    if (LangOpts.EnableConcurrentTypeUniquing &&
+        arena == AllocationArena::Permanent)
+      return AllocateConcurrently(bytes, alignment);
     
     return getAllocator(arena).Allocate(bytes, alignment);
   }
 
+  /// Allocate memory from the permanent arena while holding the uniquing
+  /// lock, for contexts shared between threads.
+  void *AllocateConcurrently(unsigned long bytes, unsigned alignment) const;
+
   template <typename T>
   T *Allocate(AllocationArena arena = AllocationArena::Permanent) const {
     T *res = (T *) Allocate(sizeof(T), alignof(T), arena);
@@ -743,6 +761,10 @@ public:
   /// \brief Returns memory used exclusively by constraint solver.
   size_t getSolverMemory() const;
 
+  /// \brief Returns the most memory used by a single constraint system so
+  /// far, including the allocator it was solved with.
+  size_t getPeakSolverMemory() const;
+
   /// Complain if @objc or dynamic is used without importing Foundation.
   void diagnoseAttrsRequiringFoundation(SourceFile &SF);
 
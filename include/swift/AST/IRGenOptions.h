@@ -74,6 +74,11 @@ public:
   /// used to force-load this module.
   std::string ForceLoadSymbolName;
 
+  /// If non-empty, the directory of the object file cache. Object files are
+  /// looked up in and added to the cache by a hash of the unoptimized and of
+  /// the optimized LLVM module, together with the code generation options.
+  std::string ObjectCachePath;
+
   /// The kind of compilation we should do.
   IRGenOutputKind OutputKind : 3;
 
@@ -99,6 +104,10 @@ public:
   /// \brief Whether we should run LLVM SLP vectorizer.
   unsigned DisableLLVMSLPVectorizer : 1;
 
+  /// \brief Whether we should skip merging identical functions, such as
+  /// generic specializations over types with the same layout.
+  unsigned DisableLLVMMergeFunctions : 1;
+
   /// Disable frame pointer elimination?
   unsigned DisableFPElim : 1;
   
@@ -109,10 +118,20 @@ public:
   /// objects.
   unsigned EmitStackPromotionChecks : 1;
 
+  /// Emit a table of the generic type metadata accessors the module uses and
+  /// register it with the runtime at load time, so that the metadata is
+  /// instantiated eagerly on a background thread.
+  unsigned EmitMetadataPrefetchTable : 1;
+
   /// The maximum number of bytes used on a stack frame for stack promotion
   /// (includes alloc_stack allocations).
   unsigned StackPromotionSizeLimit = 1024;
 
+  /// If non-zero, copies and destroys of non-trivial loadable structs and
+  /// tuples whose explosion has at least this many values are emitted as calls
+  /// to outlined helper functions instead of inline.
+  unsigned OutlineValueOperationsThreshold = 0;
+
   /// Emit code to verify that static and runtime type layout are consistent for
   /// the given type names.
   SmallVector<StringRef, 1> VerifyTypeLayoutNames;
@@ -123,6 +142,10 @@ public:
   /// Instrument code to generate profiling information.
   unsigned GenerateProfile : 1;
 
+  /// Increment a per-thread copy of the profile counters, which is merged
+  /// into the shared counters when the thread exits.
+  unsigned ThreadLocalProfileCounters : 1;
+
   /// Whether we should embed the bitcode file.
   IRGenEmbedMode EmbedMode : 2;
 
@@ -133,8 +156,10 @@ public:
                    Optimize(false), DebugInfoKind(IRGenDebugInfoKind::None),
                    UseJIT(false), DisableLLVMOptzns(false),
                    DisableLLVMARCOpts(false), DisableLLVMSLPVectorizer(false),
-                   DisableFPElim(true), Playground(false),
-                   EmitStackPromotionChecks(false), GenerateProfile(false),
+                   DisableLLVMMergeFunctions(false), DisableFPElim(true), Playground(false),
+                   EmitStackPromotionChecks(false),
+                   EmitMetadataPrefetchTable(false), GenerateProfile(false),
+                   ThreadLocalProfileCounters(false),
                    EmbedMode(IRGenEmbedMode::None) {}
   
   /// Gets the name of the specified output filename.
@@ -17,6 +17,7 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
 #include "swift/AST/TypeLoc.h"
 #include "llvm/ADT/Fixnum.h"
 
@@ -138,6 +139,20 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Populates the given vector with the member decls of \p D whose base
+  /// name is \p baseName, without loading any other members.
+  ///
+  /// The implementation should \em not add the members to D; they will be
+  /// added again by \c loadAllMembers if the rest of the members are needed.
+  ///
+  /// \returns false if this loader can't look up members by name, in which
+  /// case the caller has to use \c loadAllMembers instead.
+  virtual bool
+  loadNamedMembers(const Decl *D, Identifier baseName, uint64_t contextData,
+                   SmallVectorImpl<ValueDecl *> &members) {
+    return false;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
   /// The implementation should \em not call setConformances on \p D.
@@ -275,6 +275,20 @@ private:
   /// The magic __dso_handle variable.
   llvm::PointerIntPair<VarDecl *, 2, OptionSet<Flags>> DSOHandleAndFlags;
 
+public:
+  /// Maps a name, ResolutionKind and NLKind to the result of looking that name
+  /// up in this module and the modules it re-exports.
+  using ReexportLookupCacheTy =
+    llvm::DenseMap<std::pair<DeclName, unsigned>, TinyPtrVector<ValueDecl *>>;
+
+private:
+  /// \see getReexportLookupCache
+  ReexportLookupCacheTy ReexportLookupCache;
+
+  /// The value of ASTContext::ModuleContentsGeneration when
+  /// ReexportLookupCache was last known to be valid.
+  unsigned ReexportLookupCacheGeneration = 0;
+
   ModuleDecl(Identifier name, ASTContext &ctx);
 
 public:
@@ -305,6 +319,15 @@ public:
   DerivedFileUnit &getDerivedFileUnit() const;
 
   DebuggerClient *getDebugClient() const { return DebugClient; }
+
+  /// Returns the cached results of name lookups into this module and its
+  /// re-exports, shared by every file that imports it.
+  ///
+  /// The cache is emptied whenever declarations may have been added to a
+  /// module after it was loaded. It must only be used for modules that have
+  /// no source files.
+  ReexportLookupCacheTy &getReexportLookupCache();
+
   void setDebugClient(DebuggerClient *R) {
     assert(!DebugClient && "Debugger client already set");
     DebugClient = R;
@@ -790,9 +813,7 @@ public:
   DerivedFileUnit(ModuleDecl &M);
   ~DerivedFileUnit() = default;
 
-  void addDerivedDecl(FuncDecl *FD) {
-    DerivedDecls.push_back(FD);
-  }
+  void addDerivedDecl(FuncDecl *FD);
 
   void lookupValue(ModuleDecl::AccessPathTy accessPath, DeclName name,
                    NLKind lookupKind,
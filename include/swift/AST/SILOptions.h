@@ -57,6 +57,10 @@ public:
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
+  /// Assume that the program is single-threaded, so that all reference
+  /// counting operations can be non-atomic.
+  bool AssumeSingleThreaded = false;
+
   /// Controls whether the SIL ARC optimizations are run.
   bool EnableARCOptimizations = true;
 
@@ -95,6 +99,20 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// Publish specializations of public generic functions of this module, and
+  /// use published specializations of imported modules instead of
+  /// specializing their generic functions again.
+  bool ShareSpecializations = false;
+
+  /// The path of a generic metadata profile written by the runtime, whose
+  /// most requested instantiations of this module's generic types should be
+  /// prespecialized, or empty if there is none.
+  std::string PrespecializeProfilePath;
+
+  /// The path of an indexed profile (.profdata) whose execution counts should
+  /// guide optimization, or empty if there is none.
+  std::string ProfileUsePath;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   StringRef ExternalPassPipelineFilename;
 };
@@ -89,6 +89,7 @@ public:
   
 private:
   friend class ProtocolConformance;
+  friend class SubstitutionMap;
   
   Substitution subst(ModuleDecl *module,
                      ArrayRef<Substitution> subs,
@@ -96,6 +97,51 @@ private:
                      ArchetypeConformanceMap &conformanceMap) const;
 };
 
+/// The substitutions for the archetypes of a generic context, with memoized
+/// results of substituting them into types and other substitutions.
+///
+/// Substitution::subst builds the type and conformance maps of the context
+/// every time it is called. Clients which substitute the same substitutions
+/// into many types and substitutions, like the cloners which specialize
+/// generic functions, should keep one of these instead.
+class SubstitutionMap {
+  ModuleDecl *Module;
+  ArrayRef<Substitution> Subs;
+  TypeSubstitutionMap TypeMap;
+  ArchetypeConformanceMap ConformanceMap;
+
+  /// The substituted types, by original type.
+  llvm::DenseMap<TypeBase *, Type> SubstitutedTypes;
+
+  /// The substituted substitutions, by original archetype and replacement.
+  /// The conformances of the original substitution are kept to check hits.
+  llvm::DenseMap<std::pair<ArchetypeType *, TypeBase *>,
+                 std::pair<ArrayRef<ProtocolConformance *>, Substitution>>
+    SubstitutedSubstitutions;
+
+public:
+  /// Creates the map for the substitutions \p subs for the archetypes of
+  /// \p context, in the order of GenericParamList::getAllNestedArchetypes.
+  SubstitutionMap(ModuleDecl *module, GenericParamList *context,
+                  ArrayRef<Substitution> subs);
+
+  SubstitutionMap(const SubstitutionMap &) = delete;
+  SubstitutionMap &operator=(const SubstitutionMap &) = delete;
+
+  ArrayRef<Substitution> getSubstitutions() const { return Subs; }
+
+  /// The mapping from the primary archetypes of the context to their
+  /// replacements, as Type::subst takes it.
+  TypeSubstitutionMap &getTypeMap() { return TypeMap; }
+
+  /// Substitutes into \p type, like Type::subst with no options.
+  Type subst(Type type);
+
+  /// Substitutes into the replacement and conformances of \p sub, like
+  /// Substitution::subst.
+  Substitution subst(const Substitution &sub);
+};
+
 void dump(const ArrayRef<Substitution> &subs);
 
 } // end namespace swift
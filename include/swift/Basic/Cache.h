@@ -129,6 +129,13 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Limits the total cost of the values in the cache.
+  ///
+  /// When the total cost exceeds the limit, the least recently used keys are
+  /// removed until it doesn't. With libcache this has no effect, since
+  /// libcache purges its caches when the system is under memory pressure.
+  void setCostLimit(size_t Limit);
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +199,12 @@ public:
     removeAll();
   }
 
+  /// Limits the total cost of the values in the cache; see
+  /// \c CacheImpl::setCostLimit.
+  void setCostLimit(size_t Limit) {
+    CacheImpl::setCostLimit(Limit);
+  }
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
@@ -18,6 +18,7 @@
 #include <vector>
 #include <cassert>
 #include <cstdint>
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "swift/Basic/Malloc.h"
 
@@ -79,6 +80,8 @@ enum class FunctionSigSpecializationParamKind : unsigned {
   ConstantPropString = 4,
   ClosureProp = 5,
   InOutToValue = 6,
+  ReturnValueOwnedToUnowned = 7,
+  ExistentialToConcrete = 8,
 
   // Option Set Flags use bits 6-31. This gives us 26 bits to use for option
   // flags.
@@ -98,6 +101,7 @@ enum class SpecializationPass : uint8_t {
   CapturePropagation,
   FunctionSignatureOpts,
   GenericSpecializer,
+  ExistentialSpecializer,
 };
 
 static inline char encodeSpecializationPass(SpecializationPass Pass) {
@@ -154,27 +158,35 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
+  // Almost all nodes have at most two children, so store those inline to
+  // avoid a separate heap allocation per node.
+  typedef llvm::SmallVector<NodePointer, 2> NodeVector;
   NodeVector Children;
 
-  Node(Kind k)
+  /// Only NodeFactory can create this key, which makes the constructors
+  /// private to it while still allowing them to be used by make_shared.
+  class FactoryKey {
+    FactoryKey() {}
+    friend struct NodeFactory;
+  };
+
+  friend struct NodeFactory;
+
+public:
+  Node(FactoryKey, Kind k)
       : NodeKind(k), NodePayloadKind(PayloadKind::None) {
   }
-  Node(Kind k, std::string &&t)
+  Node(FactoryKey, Kind k, std::string &&t)
       : NodeKind(k), NodePayloadKind(PayloadKind::Text) {
     new (&TextPayload) std::string(std::move(t));
   }
-  Node(Kind k, IndexType index)
+  Node(FactoryKey, Kind k, IndexType index)
       : NodeKind(k), NodePayloadKind(PayloadKind::Index) {
     IndexPayload = index;
   }
   Node(const Node &) = delete;
   Node &operator=(const Node &) = delete;
 
-  friend struct NodeFactory;
-
-public:
   ~Node();
 
   Kind getKind() const { return NodeKind; }
@@ -211,8 +223,8 @@ public:
   /// \returns child
   NodePointer addChild(NodePointer child) {
     assert(child && "adding null child!");
-    Children.push_back(child);
-    return child;
+    Children.push_back(std::move(child));
+    return Children.back();
   }
 
   /// A convenience method for adding two children at once.
@@ -347,22 +359,24 @@ std::string mangleNode(const NodePointer &root);
 std::string nodeToString(NodePointer Root,
                          const DemangleOptions &Options = DemangleOptions());
 
+/// Creates nodes. make_shared allocates the node and its reference count
+/// together, so that each node is a single heap allocation.
 struct NodeFactory {
   static NodePointer create(Node::Kind K) {
-    return NodePointer(new Node(K));
+    return std::make_shared<Node>(Node::FactoryKey(), K);
   }
   static NodePointer create(Node::Kind K, Node::IndexType Index) {
-    return NodePointer(new Node(K, Index));
+    return std::make_shared<Node>(Node::FactoryKey(), K, Index);
   }
   static NodePointer create(Node::Kind K, llvm::StringRef Text) {
-    return NodePointer(new Node(K, Text));
+    return std::make_shared<Node>(Node::FactoryKey(), K, Text.str());
   }
   static NodePointer create(Node::Kind K, std::string &&Text) {
-    return NodePointer(new Node(K, std::move(Text)));
+    return std::make_shared<Node>(Node::FactoryKey(), K, std::move(Text));
   }
   template <size_t N>
   static NodePointer create(Node::Kind K, const char (&Text)[N]) {
-    return NodePointer(new Node(K, llvm::StringRef(Text)));
+    return create(K, llvm::StringRef(Text));
   }
 };
 
@@ -108,6 +108,12 @@ public:
       return a.Depth != b.Depth;
     }
 
+    /// Orders stable iterators from the bottom of the stack to the top, i.e.
+    /// \p a < \p b if \p a is deeper in the stack than \p b.
+    friend bool operator<(stable_iterator a, stable_iterator b) {
+      return a.Depth < b.Depth;
+    }
+
     static stable_iterator invalid() {
       return stable_iterator((std::size_t) -1);
     }
@@ -0,0 +1,180 @@
+//===--- FrontendStats.h - Per-job compilation statistics -------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines FrontendStats, which records how long a frontend job spent
+/// in each phase of compilation, along with a few counters describing how
+/// much work each phase had to do and how much memory each subsystem held
+/// at the end of it.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_FRONTENDSTATS_H
+#define SWIFT_BASIC_FRONTENDSTATS_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/TimeValue.h"
+
+#include <cstdint>
+
+namespace swift {
+
+/// Statistics gathered by a single frontend job, written out as JSON when the
+/// job is passed -stats-output-dir.
+///
+/// Phase times are exclusive: while a phase is nested inside another, for
+/// example when LLVM runs from within IRGen, time is only charged to the
+/// innermost one.
+class FrontendStats {
+public:
+  enum class Phase : unsigned {
+    Parse,
+    Import,
+    Sema,
+    SILGen,
+    SILOptimization,
+    IRGen,
+    LLVM,
+  };
+  enum : unsigned { NumPhases = unsigned(Phase::LLVM) + 1 };
+
+  /// The subsystems whose memory use is accounted separately.
+  enum class MemoryCategory : unsigned {
+    /// The permanent arena and tables of the ASTContext.
+    ASTContext,
+    /// The largest constraint solver arena, including the solver's
+    /// allocator, used so far.
+    ConstraintSolverPeak,
+    /// The allocator of the SILModule.
+    SILModule,
+    /// The TypeConverter's lowered types and caches.
+    SILTypeLowering,
+    /// The ClangImporter's own tables.
+    ClangImporter,
+    /// Clang's ASTContext, preprocessor and source manager.
+    Clang,
+    /// The buffers of the serialized modules that were loaded.
+    SerializedModules,
+    /// All memory allocated with malloc, which includes the subsystems above
+    /// as well as LLVM.
+    Malloc,
+  };
+  enum : unsigned {
+    NumMemoryCategories = unsigned(MemoryCategory::Malloc) + 1
+  };
+
+  /// The memory used by each subsystem, in bytes.
+  struct MemoryUsage {
+    uint64_t Bytes[NumMemoryCategories] = {};
+
+    uint64_t &operator[](MemoryCategory C) { return Bytes[unsigned(C)]; }
+    uint64_t operator[](MemoryCategory C) const { return Bytes[unsigned(C)]; }
+  };
+
+  /// The time spent in one phase, in microseconds.
+  struct PhaseTime {
+    int64_t WallUSec = 0;
+    int64_t UserUSec = 0;
+    int64_t SystemUSec = 0;
+  };
+
+  /// \brief Charges the time between its construction and destruction to a
+  /// phase. Does nothing if constructed with a null FrontendStats.
+  class PhaseTimer {
+    FrontendStats *Stats;
+  public:
+    PhaseTimer(FrontendStats *Stats, Phase P) : Stats(Stats) {
+      if (Stats)
+        Stats->beginPhase(P);
+    }
+    ~PhaseTimer() {
+      if (Stats)
+        Stats->endPhase();
+    }
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+  };
+
+  /// The number of frontend jobs these statistics cover.
+  uint64_t NumJobs = 0;
+
+  /// The number of declarations deserialized from Swift modules.
+  uint64_t NumDeclsDeserialized = 0;
+
+  /// The number of declarations imported from Clang modules.
+  uint64_t NumClangDeclsImported = 0;
+
+  /// The number of SIL instructions, after SIL optimization.
+  uint64_t NumSILInstructions = 0;
+
+  /// The number of LLVM instructions emitted by IRGen, before LLVM
+  /// optimization.
+  uint64_t NumLLVMInstructions = 0;
+
+private:
+  PhaseTime Phases[NumPhases];
+
+  /// The memory in use at the end of each phase.
+  MemoryUsage PhaseMemory[NumPhases];
+
+  /// The phases currently being timed, innermost last.
+  SmallVector<Phase, 4> ActivePhases;
+
+  /// The times at which the innermost active phase was last resumed.
+  llvm::sys::TimeValue LastWall, LastUser, LastSystem;
+
+  void beginPhase(Phase P);
+  void endPhase();
+
+  /// Charge the time since the innermost active phase was last resumed to
+  /// that phase.
+  void chargeActivePhase();
+
+public:
+  /// \returns the name used for \p P in the JSON representation.
+  static StringRef getPhaseName(Phase P);
+
+  const PhaseTime &getPhaseTime(Phase P) const {
+    return Phases[unsigned(P)];
+  }
+
+  /// \returns the name used for \p C in the JSON representation.
+  static StringRef getMemoryCategoryName(MemoryCategory C);
+
+  /// Records \p Usage as the memory in use at the end of \p P, keeping the
+  /// larger value of each category if \p P ends several times.
+  void recordMemoryUsage(Phase P, const MemoryUsage &Usage);
+
+  const MemoryUsage &getMemoryUsage(Phase P) const {
+    return PhaseMemory[unsigned(P)];
+  }
+
+  /// Adds the times and counters of \p Other to this one.
+  ///
+  /// Memory is not additive across jobs, which run in separate processes, so
+  /// the largest use of each category is kept instead.
+  void add(const FrontendStats &Other);
+
+  /// Writes these statistics as a JSON object.
+  void writeJSON(raw_ostream &os) const;
+
+  /// Reads statistics written by \ref writeJSON from \p Path and adds them to
+  /// this object.
+  ///
+  /// \returns true on error
+  bool addFromFile(StringRef Path);
+};
+
+} // end namespace swift
+
+#endif
@@ -87,6 +87,11 @@ namespace swift {
     /// expression.
     bool CodeCompleteInitsInPostfixExpr = false;
 
+    /// Whether to type check only the statements a member access completion
+    /// depends on, instead of the whole function body up to the completion
+    /// point.
+    bool CodeCompleteOnlyDependencies = false;
+
     ///
     /// Flags for use by tests
     ///
@@ -125,6 +130,10 @@ namespace swift {
     /// Debug the generic signatures computed by the archetype builder.
     bool DebugGenericSignatures = false;
 
+    /// Record which requests cause decls to be deserialized from Swift
+    /// modules, for -print-deserialization-stats.
+    bool TraceDeserialization = false;
+
     /// Triggers llvm fatal_error if typechecker tries to typecheck a decl or an
     /// identifier reference with the provided prefix name.
     /// This is for testing purposes.
@@ -136,13 +145,45 @@ namespace swift {
     /// ID of the current process for the purposes of AST verification.
     unsigned ASTVerifierProcessId = 1U;
 
+    /// The percentage of top-level declarations in each source file that the
+    /// AST verifier checks.
+    unsigned ASTVerifierSamplePercent = 100U;
+
     /// \brief The upper bound, in bytes, of temporary data that can be
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 15000000;
 
+    /// \brief The upper bound on the type variable bindings the constraint
+    /// solver may attempt for one constraint system before the expression
+    /// is reported as too complex, or zero for no limit.
+    ///
+    /// Unlike the time-based warnings, this limit gives the same answer on
+    /// every machine.
+    unsigned SolverBindingThreshold = 0;
+
+    /// \brief Solve expressions with the bodies of their single-expression
+    /// closures left out of the constraint system, and type-check each body
+    /// on its own once the closure type is known.
+    ///
+    /// Expressions whose closure types can't be determined without the
+    /// bodies are solved again with them.
+    bool SolveClosureBodiesSeparately = false;
+
+    /// \brief If non-zero, warn about any expression that takes longer than
+    /// this many milliseconds to type-check.
+    unsigned WarnLongExpressionTypeChecking = 0;
+
+    /// \brief If non-zero, warn about any expression whose type-checking
+    /// attempts more than this many type variable bindings.
+    unsigned WarnExpressionTypeVariableBindings = 0;
+
     /// \brief Perform all dynamic allocations using malloc/free instead of
     /// optimized custom allocator, so that memory debugging tools can be used.
     bool UseMalloc = false;
+
+    /// \brief Serialize type uniquing and permanent allocations in the
+    /// ASTContext, so that several threads can build types at once.
+    bool EnableConcurrentTypeUniquing = false;
     
     /// \brief Enable experimental "switch" pattern-matching features.
     bool EnableExperimentalPatterns = false;
@@ -40,6 +40,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <iterator>
+#include <tuple>
 #include "swift/Basic/type_traits.h"
 
 namespace swift {
@@ -633,6 +634,46 @@ public:
                          [&]() -> const ValueType & { return value; });
   }
 
+  /// Insert entries whose keys are sorted and distinct into the map.
+  ///
+  /// Since siblings are never rebalanced, inserting sorted keys one at a
+  /// time in order turns every run of siblings into a linked list, and
+  /// lookups become linear in the number of keys.  This inserts the median
+  /// of each range before its halves, which keeps the siblings balanced
+  /// when the map starts out empty.
+  ///
+  /// \param getKey Produces the key of an element of \p entries.
+  /// \param getValue Produces the value of an element of \p entries.
+  template <typename EntryType, typename KeyFn, typename ValueFn>
+  void insertSorted(ArrayRef<EntryType> entries, const KeyFn &getKey,
+                    const ValueFn &getValue) {
+    SmallVector<std::pair<size_t, size_t>, 16> ranges; // actually a stack
+    if (!entries.empty())
+      ranges.push_back({0, entries.size()});
+    while (!ranges.empty()) {
+      size_t begin, end;
+      std::tie(begin, end) = ranges.pop_back_val();
+      size_t mid = begin + (end - begin) / 2;
+#ifndef NDEBUG
+      if (mid != begin) {
+        KeyType prev = getKey(entries[mid - 1]), cur = getKey(entries[mid]);
+        assert(std::lexicographical_compare(prev.begin(), prev.end(),
+                                            cur.begin(), cur.end()) &&
+               "keys must be sorted and distinct");
+      }
+#endif
+      insertNewLazy(getKey(entries[mid]),
+                    [&]() -> decltype(getValue(entries[mid])) {
+        return getValue(entries[mid]);
+      });
+      // Visit the left half first.
+      if (mid + 1 != end)
+        ranges.push_back({mid + 1, end});
+      if (begin != mid)
+        ranges.push_back({begin, mid});
+    }
+  }
+
   void dump() const { print(llvm::errs()); }
   void print(raw_ostream &out) const {
     printOpaquePrefixMap(out, Root,
@@ -96,6 +96,11 @@ public:
   using PointerTy = T*;
 
   PointerTy get() const & {
+    // A zero offset would refer to the pointer itself, which no record ever
+    // does, so it is used to represent null.
+    if (RelativeOffset == 0)
+      return nullptr;
+
     // The function entry point is addressed relative to `this`.
     auto base = reinterpret_cast<intptr_t>(this);
     intptr_t absolute = base + RelativeOffset;
@@ -136,7 +141,7 @@ public:
     return this->get();
   }
 
-  RetTy operator()(ArgTy...arg) {
+  RetTy operator()(ArgTy...arg) const {
     return this->get()(std::forward<ArgTy>(arg)...);
   }
 };
@@ -14,10 +14,12 @@
 #define SWIFT_SOURCEMANAGER_H
 
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/SourceMgr.h"
 #include <map>
+#include <vector>
 
 namespace swift {
 
@@ -42,6 +44,11 @@ class SourceManager {
   std::map<const char *, VirtualFile> VirtualFiles;
   mutable std::pair<const char *, const VirtualFile*> CachedVFile = {};
 
+  /// The offsets of the start of every line after the first, per buffer ID.
+  ///
+  /// Built on the first line number query into a buffer.
+  mutable llvm::DenseMap<unsigned, std::vector<unsigned>> LineTables;
+
 public:
   llvm::SourceMgr &getLLVMSourceMgr() {
     return LLVMSourceMgr;
@@ -180,24 +187,24 @@ public:
   ///
   /// This respects #line directives.
   std::pair<unsigned, unsigned>
-  getLineAndColumn(SourceLoc Loc, unsigned BufferID = 0) const {
-    assert(Loc.isValid());
-    int LineOffset = getLineOffset(Loc);
-    int l, c;
-    std::tie(l, c) = LLVMSourceMgr.getLineAndColumn(Loc.Value, BufferID);
-    assert(LineOffset+l > 0 && "bogus line offset");
-    return { LineOffset + l, c };
-  }
+  getLineAndColumn(SourceLoc Loc, unsigned BufferID = 0) const;
+
+  /// Returns the line and column of each of the given source locations.
+  ///
+  /// This is faster than calling getLineAndColumn() for each location when
+  /// consecutive locations tend to come from the same buffer.
+  ///
+  /// This respects #line directives.
+  void getLineAndColumns(ArrayRef<SourceLoc> Locs,
+                         SmallVectorImpl<std::pair<unsigned, unsigned>> &Result)
+                           const;
 
   /// Returns the real line number for a source location.
   ///
   /// If \p BufferID is provided, \p Loc must come from that source buffer.
   ///
   /// This does not respect #line directives.
-  unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const {
-    assert(Loc.isValid());
-    return LLVMSourceMgr.FindLineNumber(Loc.Value, BufferID);
-  }
+  unsigned getLineNumber(SourceLoc Loc, unsigned BufferID = 0) const;
 
   StringRef extractText(CharSourceRange Range,
                         Optional<unsigned> BufferID = None) const;
@@ -223,6 +230,14 @@ public:
 private:
   const VirtualFile *getVirtualFile(SourceLoc Loc) const;
 
+  /// Returns the line table for the given buffer, building it if necessary.
+  const std::vector<unsigned> &getLineTable(unsigned BufferID) const;
+
+  /// Returns the real line and column of \p Loc, which must come from the
+  /// buffer \p BufferID.
+  std::pair<unsigned, unsigned> getRealLineAndColumn(SourceLoc Loc,
+                                                     unsigned BufferID) const;
+
   int getLineOffset(SourceLoc Loc) const {
     if (auto VFile = getVirtualFile(Loc))
       return VFile->LineOffset;
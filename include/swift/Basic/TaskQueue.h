@@ -38,6 +38,23 @@ enum class TaskFinishedResponse {
   StopExecution,
 };
 
+/// \brief The resources a task consumed, as reported by the system once the
+/// task has exited.
+struct TaskResourceUsage {
+  /// Whether the fields below were reported. (This may not be available on
+  /// all platforms.)
+  bool Valid = false;
+
+  /// The CPU time spent executing the task's own code, in microseconds.
+  int64_t UserTimeUSec = 0;
+
+  /// The CPU time the system spent on behalf of the task, in microseconds.
+  int64_t SystemTimeUSec = 0;
+
+  /// The largest resident set size of the task, in bytes.
+  int64_t MaxResidentSetBytes = 0;
+};
+
 /// \brief A class encapsulating the execution of multiple tasks in parallel.
 class TaskQueue {
   /// Tasks which have not begun execution.
@@ -65,6 +82,16 @@ public:
   /// \param Context the context which was passed when the task was added
   typedef std::function<void(ProcessId Pid, void *Context)> TaskBeganCallback;
 
+  /// \brief A callback which will be executed whenever a task produces
+  /// output, while it is still executing.
+  ///
+  /// \param Pid the ProcessId of the task which produced output.
+  /// \param Output the output produced since the last time this callback was
+  /// called for the task. This is not necessarily split at line boundaries.
+  /// \param Context the context which was passed when the task was added
+  typedef std::function<void(ProcessId Pid, StringRef Output, void *Context)>
+    TaskOutputCallback;
+
   /// \brief A callback which will be executed after each task finishes
   /// execution.
   ///
@@ -72,12 +99,15 @@ public:
   /// \param ReturnCode the return code of the task which finished execution.
   /// \param Output the output from the task which finished execution,
   /// if available. (This may not be available on all platforms.)
+  /// \param Usage the resources consumed by the task
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns true if further execution of tasks should stop,
   /// false if execution should continue
   typedef std::function<TaskFinishedResponse(ProcessId Pid, int ReturnCode,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             const TaskResourceUsage &Usage,
+                                             void *Context)>
     TaskFinishedCallback;
 
   /// \brief A callback which will be executed if a task exited abnormally due
@@ -88,12 +118,15 @@ public:
   /// no reason could be deduced, this may be empty.
   /// \param Output the output from the task which exited abnormally, if
   /// available. (This may not be available on all platforms.)
+  /// \param Usage the resources consumed by the task
   /// \param Context the context which was passed when the task was added
   ///
   /// \returns a TaskFinishedResponse indicating whether or not execution
   /// should proceed
   typedef std::function<TaskFinishedResponse(ProcessId Pid, StringRef ErrorMsg,
-                                             StringRef Output, void *Context)>
+                                             StringRef Output,
+                                             const TaskResourceUsage &Usage,
+                                             void *Context)>
     TaskSignalledCallback;
 #pragma clang diagnostic pop
 
@@ -109,6 +142,13 @@ public:
   /// current system.
   static bool supportsParallelExecution();
 
+  /// \brief Indicates whether TaskQueue can deliver the output of tasks while
+  /// they are executing on the current system.
+  ///
+  /// \note If this returns false, a TaskOutputCallback passed to \ref execute
+  /// will never be called.
+  static bool supportsStreamingOutput();
+
   /// \returns the maximum number of tasks which this TaskQueue will execute in
   /// parallel
   unsigned getNumberOfParallelTasks() const;
@@ -130,12 +170,16 @@ public:
   /// \param Finished a callback which will be called when a task finishes
   /// \param Signalled a callback which will be called if a task exited
   /// abnormally due to a signal
+  /// \param Streamed a callback which will be called as tasks produce output.
+  /// If provided, output is not buffered, and the Finished and Signalled
+  /// callbacks receive an empty StringRef for output.
   ///
   /// \returns true if all tasks did not execute successfully
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskOutputCallback Streamed = TaskOutputCallback());
 
   /// Returns true if there are any tasks that have been queued but have not
   /// yet been executed.
@@ -173,7 +217,8 @@ public:
   virtual bool
   execute(TaskBeganCallback Began = TaskBeganCallback(),
           TaskFinishedCallback Finished = TaskFinishedCallback(),
-          TaskSignalledCallback Signalled = TaskSignalledCallback());
+          TaskSignalledCallback Signalled = TaskSignalledCallback(),
+          TaskOutputCallback Streamed = TaskOutputCallback());
 };
 
 } // end namespace sys
@@ -218,6 +218,19 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Writes a precompiled header for the bridging header \p headerPath to
+  /// \p outputPCHPath, using this importer's Clang arguments.
+  ///
+  /// The result can be passed as the bridging header of a later invocation
+  /// with the same arguments, in place of \p headerPath.
+  ///
+  /// \returns true if there was an error.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
+  /// Returns the header that the precompiled bridging header passed at setup
+  /// was built from, or an empty string if no such header was loaded.
+  StringRef getBridgingPCHOriginalHeader() const;
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
@@ -232,6 +245,13 @@ public:
   clang::Sema &getClangSema() const;
   clang::CodeGenOptions &getClangCodeGenOpts() const;
 
+  /// Returns the memory allocated by Clang for its ASTContext, preprocessor
+  /// and source manager.
+  size_t getClangMemory() const;
+
+  /// Returns the memory used by the importer's own tables.
+  size_t getImporterMemory() const;
+
   std::string getClangModuleHash() const;
 
   /// If we already imported a given decl, return the corresponding Swift decl.
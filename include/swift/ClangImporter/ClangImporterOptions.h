@@ -30,6 +30,9 @@ public:
   /// A directory for overriding Clang's resource directory.
   std::string OverrideResourceDir;
 
+  /// A precompiled bridging header to load when setting up Clang.
+  std::string PrecompiledHeaderInputPath;
+
   /// The target CPU to compile for.
   ///
   /// Equivalent to Clang's -mcpu=.
@@ -45,9 +45,11 @@ public:
     REPLJob,
     LinkJob,
     GenerateDSYMJob,
+    GeneratePCHJob,
+    ResolveImportsJob,
 
     JobFirst=CompileJob,
-    JobLast=GenerateDSYMJob
+    JobLast=ResolveImportsJob
   };
 
   static const char *getClassName(ActionClass AC);
@@ -58,6 +60,10 @@ private:
 
   ActionList Inputs;
 
+  /// Inputs that are also inputs of other actions, and so are never deleted
+  /// by this one even when it owns the rest of its inputs.
+  ActionList SharedInputs;
+
   unsigned OwnsInputs : 1;
 
 protected:
@@ -81,6 +87,12 @@ public:
   ArrayRef<Action *> getInputs() const { return Inputs; }
   void addInput(Action *Input) { Inputs.push_back(Input); }
 
+  /// Adds an input that is owned by some other action.
+  void addSharedInput(Action *Input) {
+    Inputs.push_back(Input);
+    SharedInputs.push_back(Input);
+  }
+
   size_type size() const { return Inputs.size(); }
 
   iterator begin() { return Inputs.begin(); }
@@ -132,10 +144,13 @@ public:
     };
     Status status = UpToDate;
     llvm::sys::TimeValue previousModTime;
+    /// A hash of the input's contents when it was last built, or 0 if none
+    /// was recorded.
+    uint64_t previousContentHash = 0;
 
     InputInfo() = default;
-    InputInfo(Status stat, llvm::sys::TimeValue time)
-        : status(stat), previousModTime(time) {}
+    InputInfo(Status stat, llvm::sys::TimeValue time, uint64_t hash = 0)
+        : status(stat), previousModTime(time), previousContentHash(hash) {}
 
     static InputInfo makeNewlyAdded() {
       return InputInfo(Status::NewlyAdded, llvm::sys::TimeValue::MaxTime());
@@ -249,6 +264,31 @@ public:
   }
 };
 
+class GeneratePCHJobAction : public JobAction {
+  virtual void anchor();
+public:
+  explicit GeneratePCHJobAction(Action *Input)
+    : JobAction(Action::GeneratePCHJob, Input, types::TY_PCH) {}
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::GeneratePCHJob;
+  }
+};
+
+/// Loads every module imported by its inputs, populating the module cache
+/// before the compile jobs which would otherwise all build the same missing
+/// Clang modules at once.
+class ResolveImportsJobAction : public JobAction {
+  virtual void anchor();
+public:
+  ResolveImportsJobAction(ArrayRef<Action *> Inputs)
+    : JobAction(Action::ResolveImportsJob, Inputs, types::TY_Nothing) {}
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::ResolveImportsJob;
+  }
+};
+
 class LinkJobAction : public JobAction {
   virtual void anchor();
   LinkKind Kind;
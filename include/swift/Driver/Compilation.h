@@ -87,6 +87,14 @@ private:
   /// This is used for incremental builds.
   std::string CompilationRecordPath;
 
+  /// Write a timeline of the jobs that were run to this file, in Chrome trace
+  /// event format.
+  std::string BuildTracePath;
+
+  /// The directory in which frontend jobs write their statistics; if
+  /// non-empty, the driver writes the totals for all jobs there too.
+  std::string StatsOutputDir;
+
   /// A hash representing all the arguments that could trigger a full rebuild.
   std::string ArgsHash;
 
@@ -127,6 +135,15 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When true, the output of tasks is forwarded as it is produced, instead
+  /// of once each task has finished.
+  bool StreamTaskOutput = false;
+
+  /// When true, the compilation record includes hashes of the inputs and
+  /// external dependencies, and a dependency whose modification time changed
+  /// is only treated as modified if its contents changed too.
+  bool UseContentHashes = false;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -189,6 +206,14 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  void setStreamsTaskOutput(bool value = true) {
+    StreamTaskOutput = value;
+  }
+
+  void setUsesContentHashes(bool value = true) {
+    UseContentHashes = value;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
@@ -198,6 +223,14 @@ public:
     LastBuildTime = time;
   }
 
+  void setBuildTracePath(StringRef path) {
+    BuildTracePath = path;
+  }
+
+  void setStatsOutputDir(StringRef path) {
+    StatsOutputDir = path;
+  }
+
   /// Asks the Compilation to perform the Jobs which it knows about.
   /// \returns result code for the Compilation's Jobs; 0 indicates success and
   /// -2 indicates that one of the Compilation's Jobs crashed during execution
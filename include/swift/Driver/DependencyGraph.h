@@ -123,12 +123,32 @@ private:
   /// this dependency graph.
   llvm::StringSet<> ExternalDependencies;
 
+  /// The interface hash of each external Swift module, as seen by the nodes
+  /// that depend on it, or an empty string if they saw different ones.
+  ///
+  /// \sa serialization::ValidationInfo::interfaceHash
+  llvm::StringMap<std::string> ExternalInterfaceHashes;
+
   /// The interface hash for each node. This determines if the interface of
   /// a modified file has changed.
   ///
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
+  /// The interface hash of each declaration provided by a node, keyed the
+  /// same way as the node's "provides" entries.
+  ///
+  /// Only present for nodes whose dependency files include per-declaration
+  /// hashes.
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>> DeclInterfaceHashes;
+
+  /// For nodes whose interface changed when they were last loaded, the
+  /// provided names whose per-declaration hashes changed.
+  ///
+  /// If a node is present here, the next markTransitive starting from it only
+  /// follows edges that depend on these names.
+  llvm::DenseMap<const void *, llvm::StringSet<>> ChangedDecls;
+
   LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
@@ -187,6 +207,16 @@ public:
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
                             StringSetIterator(ExternalDependencies.end()));
   }
+
+  /// Returns the interface hash of the external module at \p path that the
+  /// nodes depending on it were built against, or an empty string if it is
+  /// unknown.
+  StringRef getExternalInterfaceHash(StringRef path) const {
+    auto iter = ExternalInterfaceHashes.find(path);
+    if (iter == ExternalInterfaceHashes.end())
+      return StringRef();
+    return iter->getValue();
+  }
 };
 
 /// Tracks dependencies between opaque nodes.
@@ -243,6 +273,10 @@ public:
   /// ("depends") are not cleared; new dependencies are considered additive.
   ///
   /// If \p node has already been marked, only its outgoing edges are updated.
+  ///
+  /// If the node's interface hash changed and both the old and new data list
+  /// per-declaration interface hashes, the next markTransitive from \p node
+  /// only traverses dependents of the declarations that changed.
   LoadResult loadFromPath(T node, StringRef path) {
     return DependencyGraphImpl::loadFromPath(Traits::getAsVoidPointer(node),
                                              path);
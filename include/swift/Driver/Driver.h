@@ -104,6 +104,20 @@ public:
 
   /// Returns true if multi-threading is enabled.
   bool isMultiThreading() const { return numThreads > 0; }
+
+  /// The number of frontend jobs the source inputs are divided between in
+  /// batch mode, or 0 if every source input gets its own frontend job.
+  unsigned numBatches = 0;
+
+  /// Returns true if each frontend job compiles several primary files.
+  bool isBatchMode() const { return numBatches > 0; }
+
+  /// Whether the module is emitted by a job of its own that reads the source
+  /// files, rather than by merging the partial modules of the compile jobs.
+  ///
+  /// This lets the module be finished, and dependent modules start building,
+  /// while the compile jobs are still generating code.
+  bool ShouldEmitModuleSeparately = false;
   
   /// The name of the module which we are building.
   std::string ModuleName;
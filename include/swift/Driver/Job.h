@@ -46,7 +46,11 @@ class CommandOutput {
   /// from which the output file is derived.
   SmallVector<StringRef, 1> BaseInputs;
 
-  llvm::SmallDenseMap<types::ID, std::string, 4> AdditionalOutputsMap;
+  /// The additional output files of the command, by type. Usually there is
+  /// at most one of each type. Only the compiler in batch mode produces one
+  /// per primary output file.
+  llvm::SmallDenseMap<types::ID, SmallVector<std::string, 1>, 4>
+    AdditionalOutputsMap;
 
 public:
   CommandOutput(types::ID PrimaryOutputType)
@@ -73,6 +77,11 @@ public:
   void setAdditionalOutputForType(types::ID type, StringRef OutputFilename);
   const std::string &getAdditionalOutputForType(types::ID type) const;
 
+  /// Adds an output of type \p type without replacing the existing ones.
+  /// In batch mode these are added in the same order as the primary outputs.
+  void addAdditionalOutputForType(types::ID type, StringRef OutputFilename);
+  ArrayRef<std::string> getAdditionalOutputsForType(types::ID type) const;
+
   const std::string &getAnyOutputForType(types::ID type) const;
 
   StringRef getBaseInput(int Index) const { return BaseInputs[Index]; }
@@ -108,6 +117,10 @@ private:
   /// The modification time of the main input file, if any.
   llvm::sys::TimeValue InputModTime = llvm::sys::TimeValue::MaxTime();
 
+  /// A hash of the contents of the main input file, or 0 if it wasn't
+  /// computed.
+  uint64_t InputContentHash = 0;
+
 public:
   Job(const Action &Source,
       SmallVectorImpl<const Job *> &&Inputs,
@@ -141,6 +154,14 @@ public:
     return InputModTime;
   }
 
+  void setInputContentHash(uint64_t hash) {
+    InputContentHash = hash;
+  }
+
+  uint64_t getInputContentHash() const {
+    return InputContentHash;
+  }
+
   /// Print the command line for this Job to the given \p stream,
   /// terminating output with the given \p terminator.
   void printCommandLine(raw_ostream &Stream, StringRef Terminator = "\n") const;
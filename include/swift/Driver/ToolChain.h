@@ -79,6 +79,12 @@ protected:
   constructInvocation(const GenerateDSYMJobAction &job,
                       const JobContext &context) const;
   virtual std::pair<const char *, llvm::opt::ArgStringList>
+  constructInvocation(const GeneratePCHJobAction &job,
+                      const JobContext &context) const;
+  virtual std::pair<const char *, llvm::opt::ArgStringList>
+  constructInvocation(const ResolveImportsJobAction &job,
+                      const JobContext &context) const;
+  virtual std::pair<const char *, llvm::opt::ArgStringList>
   constructInvocation(const AutolinkExtractJobAction &job,
                       const JobContext &context) const;
   virtual std::pair<const char *, llvm::opt::ArgStringList>
@@ -30,6 +30,14 @@ namespace driver {
     DynamicLibrary
   };
 
+  /// Computes a hash of the contents of the file at \p path, for deciding
+  /// whether a file whose modification time changed was really modified.
+  ///
+  /// The hash is never 0, so that 0 can stand for "unknown".
+  ///
+  /// \returns true on error
+  bool computeFileContentHash(StringRef path, uint64_t &hash);
+
 } // end namespace driver
 } // end namespace swift
 
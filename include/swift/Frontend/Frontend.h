@@ -313,11 +313,27 @@ class CompilerInstance {
   unsigned MainBufferID = NO_SUCH_BUFFER;
   unsigned PrimaryBufferID = NO_SUCH_BUFFER;
 
+  /// Buffer IDs of the primary inputs after the first one, if several
+  /// -primary-file options were given, indexed like
+  /// FrontendOptions::AdditionalPrimaryInputs.
+  SmallVector<unsigned, 4> AdditionalPrimaryBufferIDs;
+
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// All primary source files, in the order they were added to the main
+  /// module. The first one added is also PrimarySourceFile.
+  SmallVector<SourceFile *, 4> PrimarySourceFiles;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
 
+  /// \returns true if \p BufferID was selected as a primary input.
+  bool isPrimaryBufferID(unsigned BufferID) const;
+
+  /// Record \p BufferID as a primary input if its input index was selected
+  /// with -primary-file.
+  void recordPrimaryBufferID(const SelectedInput &Input, unsigned BufferID);
+
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
 
@@ -388,6 +404,20 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Gets all SourceFiles which are primary inputs for this CompilerInstance.
+  /// This has more than one element only if several -primary-file options
+  /// were given.
+  ArrayRef<SourceFile *> getPrimarySourceFiles() const {
+    return PrimarySourceFiles;
+  }
+
+  /// Gets the SourceFile for the primary input at \p PrimaryIndex, where 0 is
+  /// FrontendOptions::PrimaryInput and \c i > 0 is
+  /// FrontendOptions::AdditionalPrimaryInputs[i-1].
+  ///
+  /// \returns nullptr if that input is not a source file.
+  SourceFile *getPrimarySourceFileForInput(unsigned PrimaryIndex) const;
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
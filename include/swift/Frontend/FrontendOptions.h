@@ -74,6 +74,17 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// Further inputs for which output should be generated, in addition to
+  /// PrimaryInput. These are set when one frontend invocation handles several
+  /// primary files, so that module imports are loaded only once for all of
+  /// them.
+  std::vector<SelectedInput> AdditionalPrimaryInputs;
+
+  /// \returns true if more than one input was selected with -primary-file.
+  bool hasMultiplePrimaryInputs() const {
+    return !AdditionalPrimaryInputs.empty();
+  }
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -96,6 +107,12 @@ public:
   /// The path to which we should emit a module documentation file.
   std::string ModuleDocOutputPath;
 
+  /// The module and module documentation paths for each of
+  /// AdditionalPrimaryInputs, in the same order. Either empty, or one per
+  /// additional primary input.
+  std::vector<std::string> AdditionalModuleOutputPaths;
+  std::vector<std::string> AdditionalModuleDocOutputPaths;
+
   /// The name of the library to link against when using this module.
   std::string ModuleLinkName;
 
@@ -136,6 +153,9 @@ public:
     /// Parse, type-check, and dump type refinement context hierarchy
     DumpTypeRefinementContexts,
 
+    EmitPCH, ///< Emit PCH of imported bridging header
+    ResolveImports, ///< Parse and load the imported modules only
+
     EmitSILGen, ///< Emit raw SIL
     EmitSIL, ///< Emit canonical SIL
 
@@ -166,10 +186,20 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If set, dumps a report of the wall time and constraint solver work taken
+  /// to check each expression and function body to llvm::errs(), sorted by
+  /// time.
+  bool DebugTimeExpressionTypeChecking = false;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether function bodies in files other than the primary files
+  /// should be skipped by the parser.  The bodies of transparent functions
+  /// are still parsed, after all files have been parsed.
+  bool SkipNonPrimaryFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -203,6 +233,10 @@ public:
   /// termination.
   bool PrintClangStats = false;
 
+  /// If non-empty, the directory in which to write the time spent in each
+  /// phase of compilation, and other statistics, as JSON.
+  std::string StatsOutputDir;
+
   /// Indicates whether the playground transformation should be applied.
   bool PlaygroundTransform = false;
 
@@ -210,6 +244,11 @@ public:
   /// instrumentation that has a high runtime performance impact.
   bool PlaygroundHighPerformance = false;
 
+  /// Indicates whether the playground transformation should only instrument
+  /// top-level code, logging the iteration counts of loops instead of the
+  /// statements inside them.
+  bool PlaygroundTopLevelOnly = false;
+
   /// Indicates whether standard help should be shown.
   bool PrintHelp = false;
 
@@ -251,6 +290,12 @@ public:
     OutputFilenames.clear();
     OutputFilenames.push_back(FileName);
   }
+
+  /// Returns a copy of these options describing only the primary input at
+  /// \p PrimaryIndex, with that input's outputs.
+  ///
+  /// Index 0 is PrimaryInput; index \c i > 0 is AdditionalPrimaryInputs[i-1].
+  FrontendOptions getOptionsForPrimaryInput(unsigned PrimaryIndex) const;
 };
 
 }
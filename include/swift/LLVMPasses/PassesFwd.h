@@ -16,6 +16,7 @@
 namespace llvm {
   class FunctionPass;
   class ImmutablePass;
+  class ModulePass;
   class PassRegistry;
 
   void initializeSwiftAAWrapperPassPass(PassRegistry &);
@@ -23,12 +24,14 @@ namespace llvm {
   void initializeSwiftARCOptPass(PassRegistry &);
   void initializeSwiftARCContractPass(PassRegistry &);
   void initializeSwiftStackPromotionPass(PassRegistry &);
+  void initializeSwiftThreadLocalProfileCountersPass(PassRegistry &);
 }
 
 namespace swift {
   llvm::FunctionPass *createSwiftARCOptPass();
   llvm::FunctionPass *createSwiftARCContractPass();
   llvm::FunctionPass *createSwiftStackPromotionPass();
+  llvm::ModulePass *createSwiftThreadLocalProfileCountersPass();
   llvm::ImmutablePass *createSwiftAAWrapperPass();
   llvm::ImmutablePass *createSwiftRCIdentityPass();
 } // end namespace swift
@@ -119,6 +119,46 @@ template <class ElemTy> struct ConcurrentList {
   std::atomic<ConcurrentListNode<ElemTy> *> First;
 };
 
+/// A concurrent hash table with a fixed, power-of-two number of buckets,
+/// each of which is a ConcurrentList. Lookups never take a lock and never
+/// write to shared memory: the bucket is selected by mixing the hash and
+/// masking it, and then walked with acquire loads. Insertions go through
+/// ConcurrentList::push_front and are therefore safe to perform concurrently
+/// with readers; clients that need "insert only if absent" semantics must
+/// serialize their inserters themselves. Like ConcurrentList, removal of
+/// elements is not supported.
+template <class ElemTy, unsigned NumBucketsLog2 = 10>
+class ConcurrentHashTable {
+  static_assert(NumBucketsLog2 > 0 && NumBucketsLog2 < 24,
+                "unreasonable number of buckets");
+
+  enum : size_t { NumBuckets = size_t(1) << NumBucketsLog2 };
+
+  ConcurrentList<ElemTy> Buckets[NumBuckets];
+
+  /// Select a bucket using Fibonacci hashing, so that hashes derived from
+  /// aligned pointers still spread evenly over the buckets.
+  static size_t getBucketIndex(size_t hash) {
+    hash ^= hash >> (sizeof(size_t) * 4);
+    hash *= (size_t)0x9E3779B97F4A7C15ULL;
+    return hash >> (sizeof(size_t) * 8 - NumBucketsLog2);
+  }
+
+public:
+  ConcurrentHashTable() = default;
+
+  ConcurrentHashTable(const ConcurrentHashTable &) = delete;
+  ConcurrentHashTable &operator=(const ConcurrentHashTable &) = delete;
+
+  /// Return the bucket that holds elements with hash value \p hash.
+  ConcurrentList<ElemTy> &getBucket(size_t hash) {
+    return Buckets[getBucketIndex(hash)];
+  }
+
+  /// Return the number of buckets in the table.
+  static constexpr size_t getNumBuckets() { return NumBuckets; }
+};
+
 template <class KeyTy, class ValueTy> struct ConcurrentMapNode {
   ConcurrentMapNode(KeyTy H)
       : Left(nullptr), Right(nullptr), Key(H), Payload() {}
@@ -164,6 +204,25 @@ public:
   /// accelerating the search of the same value again and again.
   std::atomic<NodeTy *> LastSearch;
 
+  /// Search for a node with key value \p Key without modifying the map.
+  /// \returns null if no such node exists. Unlike findOrAllocateNode, this
+  /// never writes to shared memory, so concurrent readers of a warm map do
+  /// not contend on the LastSearch cache line.
+  ConcurrentList<ValueTy> *find(KeyTy Key) const {
+    NodeTy *Last = LastSearch.load(std::memory_order_acquire);
+    if (Last->Key == Key)
+      return &Last->Payload;
+
+    const NodeTy *P = &Sentinel;
+    while (P) {
+      if (P->Key == Key)
+        return const_cast<ConcurrentList<ValueTy> *>(&P->Payload);
+      P = (P->Key > Key) ? P->Left.load(std::memory_order_acquire)
+                         : P->Right.load(std::memory_order_acquire);
+    }
+    return nullptr;
+  }
+
   /// Search a for a node with key value \p. If the node does not exist then
   /// allocate a new bucket and add it to the tree.
   ConcurrentList<ValueTy> &findOrAllocateNode(KeyTy Key) {
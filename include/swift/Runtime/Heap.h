@@ -18,5 +18,28 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <cstddef>
+
+namespace swift {
+
+/// If \p ptr was allocated by swift_slowAlloc from the runtime's slab
+/// allocator, return the usable size of its block. Otherwise return 0; in
+/// that case the memory came from malloc.
+extern "C" size_t swift_slowAllocSize(const void *ptr);
+
+/// Print the statistics collected by swift_slowAlloc and swift_slowDealloc to
+/// stderr. Statistics are only collected if the process was started with
+/// SWIFT_RUNTIME_ALLOCATION_STATS=1.
+extern "C" void swift_slowAllocDumpStatistics();
+
+/// Store the number of allocations made by swift_slowAlloc so far, and their
+/// total size in bytes, into \p allocations and \p bytes. Blocks of the slab
+/// allocator count with their block size. \returns false, leaving the
+/// arguments unchanged, unless the process was started with
+/// SWIFT_RUNTIME_ALLOCATION_STATS=1.
+extern "C" bool swift_slowAllocGetStatistics(size_t *allocations,
+                                             size_t *bytes);
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
@@ -226,8 +226,33 @@ extern "C" void swift_release(HeapObject *object);
 /// count reaches zero, the object is destroyed
 extern "C" void swift_release_n(HeapObject *object, uint32_t n);
 
+/// Variants of swift_retain, swift_retain_n, swift_release and
+/// swift_release_n that update the reference count without atomic
+/// read-modify-write operations.
+///
+/// These may only be used on objects that no other thread can reach, for
+/// example objects that the compiler has proven never escape the function
+/// that allocates them.
+extern "C" void swift_nonatomic_retain(HeapObject *object);
+extern "C" void swift_nonatomic_retain_n(HeapObject *object, uint32_t n);
+extern "C" void swift_nonatomic_release(HeapObject *object);
+extern "C" void swift_nonatomic_release_n(HeapObject *object, uint32_t n);
+
 /// ObjC compatibility. Never call this.
 extern "C" size_t swift_retainCount(HeapObject *object);
+
+/// Write the per-type allocation and reference counting profile collected so
+/// far as JSON to the given path, or to the path in
+/// SWIFT_RUNTIME_OBJECT_PROFILE if \p path is null. Does nothing unless the
+/// process was started with SWIFT_RUNTIME_OBJECT_PROFILE set.
+extern "C" void swift_objectProfileWrite(const char *path);
+
+/// Write the heap objects sampled by the lifetime profiler which are still
+/// alive, grouped by type and allocation site, as JSON to the given path, or
+/// to the path in SWIFT_RUNTIME_LIFETIME_PROFILE if \p path is null. Does
+/// nothing unless the process was started with SWIFT_RUNTIME_LIFETIME_PROFILE
+/// set.
+extern "C" void swift_lifetimeProfileWrite(const char *path);
 extern "C" size_t swift_weakRetainCount(HeapObject *object);
 
 /// Is this pointer a non-null unique reference to an object
@@ -397,10 +422,19 @@ extern "C" void swift_weakRelease_n(HeapObject *value, int n);
 /// deallocated.
 extern "C" void swift_retainUnowned(HeapObject *value);
 
+/// Increment the strong retain count by n of an object which may have been
+/// deallocated.
+extern "C" void swift_retainUnowned_n(HeapObject *value, uint32_t n);
+
 /// Aborts if the object has been deallocated.
 extern "C" void swift_checkUnowned(HeapObject *value);
 
 /// A weak reference value object.  This is ABI.
+///
+/// For a native Swift object, Value does not point to the object itself but
+/// to a small runtime-private side table entry, so that the object's memory
+/// can be freed while weak references to it still exist.  Only the
+/// swift_weak* functions may interpret it.
 struct WeakReference {
   HeapObject *Value;
 };
@@ -45,7 +45,10 @@ class MetadataAllocator {
   ///
   /// Initializing to -1 instead of nullptr ensures that the first allocation
   /// triggers a page allocation since it will always span a "page" boundary.
-  char *next = (char*)(~(uintptr_t)0U);
+  ///
+  /// The pointer is updated with compare-and-swap, so the allocator may be used
+  /// from several threads at once.
+  std::atomic<char*> next{(char*)(~(uintptr_t)0U)};
   
 public:
   MetadataAllocator() = default;
@@ -1189,7 +1192,7 @@ struct NominalTypeDescriptor {
   /// The kind of nominal type descriptor.
   NominalTypeKind Kind;
   /// The mangled name of the nominal type, with no generic parameters.
-  const char *Name;
+  RelativeDirectPointer<const char> Name;
   
   /// The following fields are kind-dependent.
   union {
@@ -1209,12 +1212,13 @@ struct NominalTypeDescriptor {
       
       /// The field names. A doubly-null-terminated list of strings, whose
       /// length and order is consistent with that of the field offset vector.
-      const char *FieldNames;
+      RelativeDirectPointer<const char> FieldNames;
       
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// field offset vector.
-      const FieldType *(*GetFieldTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *)>
+        GetFieldTypes;
 
       /// True if metadata records for this type have a field offset vector for
       /// its stored properties.
@@ -1233,12 +1237,13 @@ struct NominalTypeDescriptor {
       
       /// The field names. A doubly-null-terminated list of strings, whose
       /// length and order is consistent with that of the field offset vector.
-      const char *FieldNames;
+      RelativeDirectPointer<const char> FieldNames;
       
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// field offset vector.
-      const FieldType *(*GetFieldTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *)>
+        GetFieldTypes;
 
       /// True if metadata records for this type have a field offset vector for
       /// its stored properties.
@@ -1256,11 +1261,12 @@ struct NominalTypeDescriptor {
       /// The names of the cases. A doubly-null-terminated list of strings,
       /// whose length is NumNonEmptyCases + NumEmptyCases. Cases are named in
       /// tag order, non-empty cases first, followed by empty cases.
-      const char *CaseNames;
+      RelativeDirectPointer<const char> CaseNames;
       /// The field type vector accessor. Returns a pointer to an array of
       /// type metadata references whose order is consistent with that of the
       /// CaseNames. Only types for payload cases are provided.
-      const FieldType *(*GetCaseTypes)(const Metadata *Self);
+      RelativeDirectPointer<const FieldType * (const Metadata *)>
+        GetCaseTypes;
 
       uint32_t getNumPayloadCases() const {
         return NumPayloadCasesAndPayloadSizeOffset & 0x00FFFFFFU;
@@ -1281,9 +1287,9 @@ struct NominalTypeDescriptor {
     } Enum;
   };
   
-  /// A pointer to the generic metadata pattern that is used to instantiate
+  /// A reference to the generic metadata pattern that is used to instantiate
   /// instances of this type. Null if the type is not generic.
-  GenericMetadata *GenericMetadataPattern;
+  RelativeDirectPointer<GenericMetadata> GenericMetadataPattern;
   
   /// The generic parameter descriptor header. This describes how to find and
   /// parse the generic parameter vector in metadata records for this nominal
@@ -1488,7 +1494,8 @@ public:
   /// Get a pointer to the field type vector, if present, or null.
   const FieldType *getFieldTypes() const {
     assert(isTypeMetadata());
-    auto *getter = Description->Class.GetFieldTypes;
+    const FieldType *(*getter)(const Metadata *)
+      = Description->Class.GetFieldTypes;
     if (!getter)
       return nullptr;
     
@@ -1666,7 +1673,8 @@ struct StructMetadata : public Metadata {
   
   /// Get a pointer to the field type vector, if present, or null.
   const FieldType *getFieldTypes() const {
-    auto *getter = Description->Struct.GetFieldTypes;
+    const FieldType *(*getter)(const Metadata *)
+      = Description->Struct.GetFieldTypes;
     if (!getter)
       return nullptr;
     
@@ -2285,6 +2293,25 @@ extern "C" const Metadata *
 swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments);
 
+/// Write the number of requests for each instantiation of generic type
+/// metadata collected so far to the given path, or to the path in
+/// SWIFT_RUNTIME_GENERIC_METADATA_PROFILE if \p path is null. Does nothing
+/// unless the process was started with SWIFT_RUNTIME_GENERIC_METADATA_PROFILE
+/// set.
+extern "C" void swift_genericMetadataProfileWrite(const char *path);
+
+/// The type of the entries of a metadata prefetch table.
+typedef const Metadata *(*MetadataAccessor)();
+
+/// Call the type metadata accessors in [begin, end) on a background thread.
+///
+/// IRGen emits a call to this from a global constructor of modules compiled
+/// with -emit-metadata-prefetch-table, passing the accessors of the generic
+/// type metadata the module uses. The table must stay valid for as long as
+/// the image is loaded.
+extern "C" void swift_prefetchGenericMetadata(const MetadataAccessor *begin,
+                                              const MetadataAccessor *end);
+
 // Fast entry points for swift_getGenericMetadata with a small number of
 // template arguments.
 extern "C" const Metadata *
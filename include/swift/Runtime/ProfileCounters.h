@@ -0,0 +1,41 @@
+//===--- ProfileCounters.h - Per-thread profile counters --------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Runtime support for code compiled with -profile-thread-local-counters,
+// which increments a per-thread copy of its profile counters.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_PROFILECOUNTERS_H
+#define SWIFT_RUNTIME_PROFILECOUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace swift {
+
+/// Arranges for the given function to be called when the current thread
+/// exits, or when the process exits if it does so on the current thread.
+/// The function merges the thread's copy of a module's profile counters into
+/// the counters of the module.
+extern "C"
+void swift_registerThreadLocalProfileCounters(void (*merge)(void));
+
+/// Adds \p count thread-local counters to the corresponding profile
+/// counters, and resets the thread-local counters to zero.
+extern "C"
+void swift_mergeProfileCounters(uint64_t *counters, uint64_t *threadCounters,
+                                size_t count);
+
+}
+
+#endif
@@ -52,4 +52,23 @@ swift_reflectAny(OpaqueValue *value, const Metadata *T);
 
 #pragma clang diagnostic pop
 
+/// Returns the number of stored properties of \p value, or -1 if its
+/// fields can't be enumerated.
+///
+/// Fields of structs and of native Swift class instances can be enumerated.
+/// For a class, \p value points to the reference, the instance's dynamic
+/// class is used, and the stored properties of superclasses are not counted.
+extern "C" intptr_t
+swift_reflectionFieldCount(const OpaqueValue *value, const Metadata *type);
+
+/// Returns the address of the \p i'th stored property of \p value, and
+/// sets \p outName and \p outType to its name and type.
+///
+/// Nothing is allocated or retained. The name points into the type's
+/// nominal type descriptor and lives as long as the type.
+extern "C" const OpaqueValue *
+swift_reflectionField(intptr_t i, const OpaqueValue *value,
+                      const Metadata *type,
+                      const char **outName, const Metadata **outType);
+
 }
@@ -39,6 +39,30 @@ public:
 
   void verify() const;
 
+  /// \name Incremental updates
+  ///
+  /// These keep the tree up to date with a CFG change, which must already
+  /// have been made when they are called. When an update can't be done
+  /// incrementally the tree is recalculated.
+  /// @{
+
+  /// Update the tree for a new edge from \p From to \p To.
+  void insertEdge(SILBasicBlock *From, SILBasicBlock *To);
+
+  /// Update the tree after the last edge from \p From to \p To was removed.
+  void deleteEdge(SILBasicBlock *From, SILBasicBlock *To);
+
+  /// Update the tree after \p NewBB was split off the end of \p OrigBB, so
+  /// that \p OrigBB branches to \p NewBB, which has \p OrigBB's former
+  /// successors.
+  void splitBlock(SILBasicBlock *OrigBB, SILBasicBlock *NewBB);
+
+  /// Update the tree before \p SuccBB, whose only predecessor is \p BB, is
+  /// merged into \p BB and erased.
+  void mergeBlocks(SILBasicBlock *BB, SILBasicBlock *SuccBB);
+
+  /// @}
+
   /// Return true if the other dominator tree does not match this dominator
   /// tree.
   inline bool errorOccuredOnComparison(const DominanceInfo &Other) const {
@@ -149,6 +149,7 @@ class FunctionSignatureSpecializationMangler
     ConstantProp=1,
     ClosureProp=2,
     InOutToValue=3,
+    ExistentialToConcrete=4,
     First_Option=0, Last_Option=31,
 
     // Option Set Space. 12 bits (i.e. 12 option).
@@ -162,6 +163,9 @@ class FunctionSignatureSpecializationMangler
                             NullablePtr<SILInstruction>>;
   llvm::SmallVector<ArgInfo, 8> Args;
 
+  /// Is the @owned result returned @unowned by the specialization?
+  bool ReturnValueOwnedToUnowned = false;
+
 public:
   FunctionSignatureSpecializationMangler(SpecializationPass Pass,
                                          Mangler &M, SILFunction *F);
@@ -172,12 +176,16 @@ public:
   void setArgumentOwnedToGuaranteed(unsigned ArgNo);
   void setArgumentSROA(unsigned ArgNo);
   void setArgumentInOutToValue(unsigned ArgNo);
+  void setArgumentExistentialToConcrete(unsigned ArgNo,
+                                        SILInstruction *InitExistential);
+  void setReturnValueOwnedToUnowned();
 
 private:
   void mangleSpecialization();
   void mangleConstantProp(LiteralInst *LI);
   void mangleClosureProp(PartialApplyInst *PAI);
   void mangleClosureProp(ThinToThickFunctionInst *TTTFI);
+  void mangleExistentialToConcrete(SILInstruction *InitExistential);
   void mangleArgument(ArgumentModifierIntBase ArgMod,
                       NullablePtr<SILInstruction> Inst);
 };
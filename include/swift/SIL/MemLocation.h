@@ -26,7 +26,9 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SparseBitVector.h"
 #include "llvm/Support/Debug.h"
 
 namespace swift {
@@ -345,6 +347,113 @@ using MemLocationList = llvm::SmallVector<MemLocation, 8>;
 using MemLocationIndexMap = llvm::DenseMap<MemLocation, unsigned>;
 using TypeExpansionMap = llvm::DenseMap<SILType, ProjectionPathList>;
 
+/// Maps each base to the indices of the MemLocations in the vault derived
+/// from it, in increasing order. Alias queries that only depend on the base
+/// can then be made once per base instead of once per location.
+using MemLocationBaseMap =
+    llvm::SmallMapVector<SILValue, llvm::SmallVector<unsigned, 4>, 8>;
+
+/// A set of indices into a MemLocation vault, stored sparsely.
+///
+/// The set can also be the complement of the stored indices. This represents
+/// the "all locations" state the RLE and DSE dataflows start from, and the
+/// sets computed from it, without enumerating every location in the vault.
+class MemLocationBitSet {
+  llvm::SparseBitVector<> Bits;
+
+  /// If true, the set contains the locations *not* in Bits.
+  bool Complemented = false;
+
+public:
+  /// Returns the set of all locations.
+  static MemLocationBitSet getAll() {
+    MemLocationBitSet S;
+    S.Complemented = true;
+    return S;
+  }
+
+  bool test(unsigned i) const { return Bits.test(i) != Complemented; }
+
+  void set(unsigned i) {
+    if (Complemented)
+      Bits.reset(i);
+    else
+      Bits.set(i);
+  }
+
+  void reset(unsigned i) {
+    if (Complemented)
+      Bits.set(i);
+    else
+      Bits.reset(i);
+  }
+
+  /// Removes all locations.
+  void clear() {
+    Bits.clear();
+    Complemented = false;
+  }
+
+  /// this = this & RHS.
+  void intersect(const MemLocationBitSet &RHS) {
+    combine(RHS.Bits, RHS.Complemented, /*Union=*/false);
+  }
+
+  /// this = this | RHS.
+  void unite(const MemLocationBitSet &RHS) {
+    combine(RHS.Bits, RHS.Complemented, /*Union=*/true);
+  }
+
+  /// this = this & ~RHS.
+  void subtract(const MemLocationBitSet &RHS) {
+    combine(RHS.Bits, !RHS.Complemented, /*Union=*/false);
+  }
+
+  /// Appends the locations in the set, out of a vault of \p NumLocations
+  /// locations, to \p Indices in increasing order.
+  void getIndices(unsigned NumLocations,
+                  llvm::SmallVectorImpl<unsigned> &Indices) const {
+    if (!Complemented) {
+      for (unsigned i : Bits)
+        Indices.push_back(i);
+      return;
+    }
+    for (unsigned i = 0; i < NumLocations; ++i)
+      if (!Bits.test(i))
+        Indices.push_back(i);
+  }
+
+  bool operator==(const MemLocationBitSet &RHS) const {
+    return Complemented == RHS.Complemented && Bits == RHS.Bits;
+  }
+  bool operator!=(const MemLocationBitSet &RHS) const {
+    return !(*this == RHS);
+  }
+
+private:
+  /// Combines this set with the set described by \p RHSBits and
+  /// \p RHSComplemented, by intersection or by union.
+  void combine(const llvm::SparseBitVector<> &RHSBits, bool RHSComplemented,
+               bool Union) {
+    // Union is handled as the intersection of the complements.
+    bool L = Complemented != Union;
+    bool R = RHSComplemented != Union;
+    if (!L && !R) {
+      Bits &= RHSBits;
+    } else if (L && R) {
+      Bits |= RHSBits;
+    } else if (!L) {
+      Bits.intersectWithComplement(RHSBits);
+    } else {
+      llvm::SparseBitVector<> Result = RHSBits;
+      Result.intersectWithComplement(Bits);
+      Bits = Result;
+      L = false;
+    }
+    Complemented = L != Union;
+  }
+};
+
 /// This class represents a field in an allocated object. It consists of a
 /// base that is the tracked SILValue, and a projection path to the
 /// represented field.
@@ -476,6 +585,11 @@ public:
                                     std::vector<MemLocation> &MemLocationVault,
                                     MemLocationIndexMap &LocToBit,
                                     TypeExpansionMap &TypeExpansionVault);
+
+  /// Group the locations in the vault by their base.
+  static void groupMemLocationsByBase(
+      const std::vector<MemLocation> &MemLocationVault,
+      MemLocationBaseMap &BaseToLocs);
 };
 
 static inline llvm::hash_code hash_value(const MemLocation &L) {
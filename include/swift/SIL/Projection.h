@@ -775,6 +775,20 @@ public:
     return LeafIndices.size();
   }
 
+  /// Return the number of fields which can not be projected further, i.e. of
+  /// the scalar values an aggregate of the tree's type consists of.
+  size_t scalarCount() const {
+    return getScalarCount(ProjectionTreeNode::RootIndex);
+  }
+
+  /// Return the number of scalar fields which are part of a live leaf.
+  size_t liveScalarCount() const {
+    size_t Count = 0;
+    for (unsigned LeafIndex : LeafIndices)
+      Count += getScalarCount(LeafIndex);
+    return Count;
+  }
+
   void createTreeFromValue(SILBuilder &B, SILLocation Loc, SILValue NewBase,
                            llvm::SmallVectorImpl<SILValue> &Leafs) const;
 
@@ -784,6 +798,9 @@ public:
 
 private:
 
+  /// Return the number of scalar fields of the node at NodeIndex.
+  size_t getScalarCount(unsigned NodeIndex) const;
+
   void createRoot(SILType BaseTy) {
     assert(ProjectionTreeNodes.empty() &&
            "Should only create root when ProjectionTreeNodes is empty");
@@ -549,13 +549,16 @@ void
 SILCloner<ImplClass>::visitPartialApplyInst(PartialApplyInst *Inst) {
   auto Args = getOpValueArray<8>(Inst->getArguments());
   getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
-  doPostProcess(Inst,
+  auto *NewInst =
     getBuilder().createPartialApply(getOpLocation(Inst->getLoc()),
                                     getOpValue(Inst->getCallee()),
                                     getOpType(Inst->getSubstCalleeSILType()),
                                     getOpSubstitutions(Inst->getSubstitutions()),
                                     Args,
-                                    getOpType(Inst->getType())));
+                                    getOpType(Inst->getType()));
+  if (Inst->canAllocOnStack())
+    NewInst->setStackAllocatable();
+  doPostProcess(Inst, NewInst);
 }
 
 template<typename ImplClass>
@@ -1012,18 +1015,22 @@ template<typename ImplClass>
 void
 SILCloner<ImplClass>::visitRetainValueInst(RetainValueInst *Inst) {
   getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
-  doPostProcess(Inst,
+  auto *NewInst =
     getBuilder().createRetainValue(getOpLocation(Inst->getLoc()),
-                                   getOpValue(Inst->getOperand())));
+                                   getOpValue(Inst->getOperand()));
+  NewInst->setNonAtomic(Inst->isNonAtomic());
+  doPostProcess(Inst, NewInst);
 }
 
 template<typename ImplClass>
 void
 SILCloner<ImplClass>::visitReleaseValueInst(ReleaseValueInst *Inst) {
   getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
-  doPostProcess(Inst,
+  auto *NewInst =
     getBuilder().createReleaseValue(getOpLocation(Inst->getLoc()),
-                                    getOpValue(Inst->getOperand())));
+                                    getOpValue(Inst->getOperand()));
+  NewInst->setNonAtomic(Inst->isNonAtomic());
+  doPostProcess(Inst, NewInst);
 }
 
 template<typename ImplClass>
@@ -1406,9 +1413,11 @@ template<typename ImplClass>
 void
 SILCloner<ImplClass>::visitStrongRetainInst(StrongRetainInst *Inst) {
   getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
-  doPostProcess(Inst,
+  auto *NewInst =
     getBuilder().createStrongRetain(getOpLocation(Inst->getLoc()),
-                                    getOpValue(Inst->getOperand())));
+                                    getOpValue(Inst->getOperand()));
+  NewInst->setNonAtomic(Inst->isNonAtomic());
+  doPostProcess(Inst, NewInst);
 }
 
 template<typename ImplClass>
@@ -1463,9 +1472,11 @@ template<typename ImplClass>
 void
 SILCloner<ImplClass>::visitStrongReleaseInst(StrongReleaseInst *Inst) {
   getBuilder().setCurrentDebugScope(getOpScope(Inst->getDebugScope()));
-  doPostProcess(Inst,
+  auto *NewInst =
     getBuilder().createStrongRelease(getOpLocation(Inst->getLoc()),
-                                     getOpValue(Inst->getOperand())));
+                                     getOpValue(Inst->getOperand()));
+  NewInst->setNonAtomic(Inst->isNonAtomic());
+  doPostProcess(Inst, NewInst);
 }
 
 template<typename ImplClass>
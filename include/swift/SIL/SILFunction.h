@@ -138,6 +138,10 @@ private:
 
   /// The function's effects attribute.
   EffectsKind EK;
+
+  /// The number of times the function was entered in a profiled run, if the
+  /// function was compiled with profile data.
+  Optional<uint64_t> EntryCount;
     
   /// True if this function is inlined at least once. This means that the
   /// debug info keeps a pointer to this function.
@@ -419,6 +423,11 @@ public:
   /// \brief Set the function side effect information.
   void setEffectsKind(EffectsKind E) { EK = E; }
 
+  /// \return the number of times the function was entered in a profiled run,
+  /// or None if there is no profile data for the function.
+  Optional<uint64_t> getEntryCount() const { return EntryCount; }
+  void setEntryCount(uint64_t Count) { EntryCount = Count; }
+
   /// Get this function's global_init attribute.
   ///
   /// The implied semantics are:
@@ -71,6 +71,16 @@ class SILInstruction : public ValueBase,public llvm::ilist_node<SILInstruction>{
   void operator=(const SILInstruction &) = delete;
   void operator delete(void *Ptr, size_t) = delete;
 
+public:
+  /// Allocate instructions with SILModule::allocateInst, which places the
+  /// header needed to recycle their memory once they are deleted.
+  template <typename ContextTy>
+  void *operator new(size_t Bytes, const ContextTy &C,
+                     size_t Alignment = alignof(ValueBase)) {
+    return C.allocateInst(Bytes, Alignment);
+  }
+
+private:
   /// Check any special state of instructions that are not represented in the
   /// instructions operands/type.
   bool hasIdenticalState(const SILInstruction *RHS) const;
@@ -135,6 +145,12 @@ public:
   ///
   void eraseFromParent();
 
+  /// Returns the 1-based position of this instruction on the worklist of the
+  /// pass that currently uses one, or 0 if it is not on a worklist. Only one
+  /// worklist at a time can track its instructions this way.
+  unsigned getWorklistSlot() const { return WorklistSlot; }
+  void setWorklistSlot(unsigned Slot) { WorklistSlot = Slot; }
+
   /// Unlink this instruction from its current basic block and insert it into
   /// the basic block that Later lives in, right before Later.
   void moveBefore(SILInstruction *Later);
@@ -845,7 +861,8 @@ public:
 /// PartialApplyInst - Represents the creation of a closure object by partial
 /// application of a function value.
 class PartialApplyInst
-    : public ApplyInstBase<PartialApplyInst, SILInstruction> {
+    : public ApplyInstBase<PartialApplyInst, SILInstruction>,
+      public StackPromotable {
   friend class SILBuilder;
 
   PartialApplyInst(SILDebugLocation *DebugLoc, SILValue Callee,
@@ -2044,12 +2061,19 @@ public:
 /// RefCountingInst - An abstract class of instructions which
 /// manipulate the reference count of their object operand.
 class RefCountingInst : public SILInstruction {
+  /// Whether the reference count may be updated without atomic operations,
+  /// because no other thread can reach the object.
+  bool NonAtomic = false;
+
 protected:
   RefCountingInst(ValueKind Kind, SILDebugLocation *DebugLoc,
                   SILTypeList *TypeList = 0)
       : SILInstruction(Kind, DebugLoc, TypeList) {}
 
 public:
+  bool isNonAtomic() const { return NonAtomic; }
+  void setNonAtomic(bool value = true) { NonAtomic = value; }
+
   static bool classof(const ValueBase *V) {
     return V->getKind() >= ValueKind::First_RefCountingInst &&
            V->getKind() <= ValueKind::Last_RefCountingInst;
@@ -4405,9 +4429,7 @@ public:
   SILInstruction *provideInitialHead() const { return createSentinel(); }
   SILInstruction *ensureHead(SILInstruction*) const { return createSentinel(); }
   static void noteHead(SILInstruction*, SILInstruction*) {}
-  static void deleteNode(SILInstruction *V) {
-    SILInstruction::destroy(V);
-  }
+  void deleteNode(SILInstruction *V);
 
   void addNodeToList(SILInstruction *I);
   void removeNodeFromList(SILInstruction *I);
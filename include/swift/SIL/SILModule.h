@@ -34,6 +34,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/Support/Allocator.h"
@@ -100,6 +101,23 @@ private:
   mutable llvm::BumpPtrAllocator BPA;
   void *TypeListUniquing;
 
+  /// The number of size classes, in 8-byte steps, in which the memory of
+  /// deleted instructions is recycled. Larger instructions are left to the
+  /// bump allocator.
+  enum : unsigned { NumInstSizeClasses = 64 };
+
+  /// Per size class, the memory of deleted instructions that is ready to be
+  /// reused, linked through its first word. These need to be declared before
+  /// \p functions, because destroying a function deletes its instructions.
+  mutable void *InstFreeLists[NumInstSizeClasses] = {};
+
+  /// Instructions deleted since the last call to reclaimDeletedInstructions,
+  /// whose memory is not reused yet.
+  void *DeletedInsts = nullptr;
+
+  /// The number of bytes of instruction memory that has been reused.
+  mutable uint64_t NumInstBytesReused = 0;
+
   /// The swift Module associated with this SILModule.
   ModuleDecl *TheSwiftModule;
 
@@ -154,6 +172,9 @@ private:
   /// This is the set of undef values we've created, for uniquing purposes.
   llvm::DenseMap<SILType, SILUndef *> UndefValues;
 
+  /// The mangled names of the SILDeclRefs we've looked up, allocated in BPA.
+  llvm::DenseMap<SILDeclRef, StringRef> MangledNames;
+
   /// The stage of processing this module is at.
   SILStage Stage;
 
@@ -369,6 +390,12 @@ public:
   /// \return null if this module has no such function
   SILFunction *lookUpFunction(SILDeclRef fnRef);
 
+  /// Returns the mangled name of \p constant.
+  ///
+  /// The same constants are looked up over and over again, so the result is
+  /// cached for the lifetime of the module.
+  StringRef getMangledName(SILDeclRef constant);
+
   /// Attempt to link the SILFunction. Returns true if linking succeeded, false
   /// otherwise.
   ///
@@ -475,6 +502,12 @@ public:
   /// invariants.
   void verify() const;
 
+  /// \brief Run the SIL verifier on the module's globals and tables, and on
+  /// the bodies of the functions for which \p ShouldVerifyFunction returns
+  /// true.
+  void verify(
+    llvm::function_ref<bool(const SILFunction &)> ShouldVerifyFunction) const;
+
   /// Pretty-print the module.
   void dump(bool Verbose = false) const;
   
@@ -506,6 +539,27 @@ public:
     return BPA.Allocate(Size, Align);
   }
 
+  /// Allocate memory for an instruction, reusing the memory of an instruction
+  /// deleted before the last call to reclaimDeletedInstructions if possible.
+  void *allocateInst(unsigned Size, unsigned Align) const;
+
+  /// Returns the memory allocated by the module's internal allocator.
+  size_t getAllocatedMemory() const { return BPA.getTotalMemory(); }
+
+  /// Called when the instruction \p I has been destroyed. Its memory is not
+  /// reused before the next call to reclaimDeletedInstructions, so that
+  /// pointers to it which are still held by the current pass can't alias a
+  /// newly created instruction.
+  void deallocateInst(SILInstruction *I);
+
+  /// Make the memory of all instructions deleted so far available for reuse.
+  ///
+  /// This is called by the pass manager between passes.
+  void reclaimDeletedInstructions();
+
+  /// Returns the number of bytes of instruction memory that has been reused.
+  uint64_t getNumInstructionBytesReused() const { return NumInstBytesReused; }
+
   /// \brief Looks up the llvm intrinsic ID and type for the builtin function.
   ///
   /// \returns Returns llvm::Intrinsic::not_intrinsic if the function is not an
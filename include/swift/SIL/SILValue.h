@@ -58,6 +58,11 @@ class alignas(8) ValueBase : public SILAllocated<ValueBase> {
 
   const ValueKind Kind;
 
+  /// Storage for SILInstruction's worklist slot. It is kept here so that it
+  /// fits into the padding after Kind.
+  unsigned WorklistSlot = 0;
+  friend class SILInstruction;
+
   ValueBase(const ValueBase &) = delete;
   ValueBase &operator=(const ValueBase &) = delete;
 
@@ -93,6 +93,18 @@ enum IsDependent_t : unsigned {
   IsDependent = true
 };
   
+/// How the declared type of a non-generic struct or enum lowers. Unlike a
+/// TypeLowering, this doesn't depend on the SILModule the type is lowered in,
+/// so it can be recorded in the type's module file and used by every client.
+enum class NominalLoweringKind : uint8_t {
+  /// Trivial and loadable.
+  Trivial,
+  /// Loadable, but not trivial.
+  Loadable,
+  /// Not loadable.
+  AddressOnly,
+};
+
 /// Extended type information used by SIL.
 class TypeLowering {
 public:
@@ -534,7 +546,10 @@ class TypeConverter {
   llvm::DenseSet<NominalTypeDecl *> RecursiveNominalTypes;
   
   /// ArchetypeBuilder used for lowering types in generic function contexts.
-  Optional<ArchetypeBuilder> GenericArchetypes;
+  ///
+  /// This is the ASTContext's builder for the signature of the context, which
+  /// is shared by all the functions with that signature.
+  ArchetypeBuilder *GenericArchetypes = nullptr;
 
   /// The current generic context signature.
   CanGenericSignature CurGenericContext;
@@ -556,6 +571,7 @@ class TypeConverter {
 
   const TypeLowering &getTypeLoweringForLoweredType(TypeKey key);
   const TypeLowering &getTypeLoweringForUncachedLoweredType(TypeKey key);
+  const TypeLowering *getTypeLoweringFromSerializedKind(TypeKey key);
   const TypeLowering &getTypeLoweringForLoweredFunctionType(TypeKey key);
   const TypeLowering &getTypeLoweringForUncachedLoweredFunctionType(TypeKey key);
 
@@ -568,6 +584,10 @@ public:
   TypeConverter(TypeConverter const &) = delete;
   TypeConverter &operator=(TypeConverter const &) = delete;
 
+  /// Returns the memory used by the type lowerings and the caches of the
+  /// converter.
+  size_t getTotalMemory() const;
+
   /// Return the CaptureKind to use when capturing a decl.
   CaptureKind getDeclCaptureKind(CapturedValue capture);
 
@@ -648,6 +668,10 @@ public:
     return ti.getLoweredType();
   }
 
+  /// Returns how the declared type of \p D lowers, for recording in its
+  /// module file. \p D must be a non-generic struct or enum.
+  NominalLoweringKind getNominalLoweringKind(NominalTypeDecl *D);
+
   AbstractionPattern getAbstractionPattern(AbstractStorageDecl *storage);
   AbstractionPattern getAbstractionPattern(VarDecl *var);
   AbstractionPattern getAbstractionPattern(SubscriptDecl *subscript);
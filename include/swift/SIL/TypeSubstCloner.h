@@ -18,6 +18,7 @@
 #ifndef SWIFT_SIL_TYPESUBSTCLONER_H
 #define SWIFT_SIL_TYPESUBSTCLONER_H
 
+#include "swift/AST/Substitution.h"
 #include "swift/AST/Type.h"
 #include "swift/SIL/SILCloner.h"
 #include "swift/SIL/DynamicCasts.h"
@@ -66,17 +67,39 @@ public:
 
 protected:
   SILType remapType(SILType Ty) {
-    return SILType::substType(Original.getModule(), SwiftMod, SubsMap, Ty);
+    // Most clones, such as inlining a non-generic function, substitute
+    // nothing; don't rebuild every type just to get it back unchanged.
+    if (SubsMap.empty())
+      return Ty;
+    // A cloned body uses the same few types over and over.
+    SILType &Remapped = RemappedTypes[Ty];
+    if (!Remapped)
+      Remapped = SILType::substType(Original.getModule(), SwiftMod, SubsMap,
+                                    Ty);
+    return Remapped;
   }
 
   CanType remapASTType(CanType ty) {
-    return ty.subst(SwiftMod, SubsMap, None)->getCanonicalType();
+    if (SubsMap.empty())
+      return ty;
+    CanType &Remapped = RemappedASTTypes[ty.getPointer()];
+    if (!Remapped)
+      Remapped = ty.subst(SwiftMod, SubsMap, None)->getCanonicalType();
+    return Remapped;
+  }
+
+  /// Returns the map of the call site substitutions, creating it the first
+  /// time it is needed.
+  SubstitutionMap &getApplySubsMap() {
+    if (!ApplySubsMap)
+      ApplySubsMap.reset(new SubstitutionMap(SwiftMod,
+                                             Original.getContextGenericParams(),
+                                             ApplySubs));
+    return *ApplySubsMap;
   }
 
   Substitution remapSubstitution(Substitution sub) {
-    auto newSub = sub.subst(SwiftMod,
-                            Original.getContextGenericParams(),
-                            ApplySubs);
+    auto newSub = getApplySubsMap().subst(sub);
     // Remap opened archetypes into the cloned context.
     newSub = Substitution(newSub.getArchetype(),
                           getASTTypeInClonedContext(newSub.getReplacement()
@@ -195,10 +218,7 @@ protected:
     //
     // FIXME: This needs to not only handle Self but all Self derived types so
     // we handle type aliases correctly.
-    auto sub =
-      Inst->getSelfSubstitution().subst(Inst->getModule().getSwiftModule(),
-                                        Original.getContextGenericParams(),
-                                        ApplySubs);
+    auto sub = getApplySubsMap().subst(Inst->getSelfSubstitution());
 
     assert(sub.getConformances().size() == 1 &&
            "didn't get conformance from substitution?!");
@@ -282,6 +302,11 @@ protected:
   ArrayRef<Substitution> ApplySubs;
   /// True, if used for inlining.
   bool Inlining;
+  /// The memoized results of remapType and remapASTType.
+  llvm::DenseMap<SILType, SILType> RemappedTypes;
+  llvm::DenseMap<TypeBase *, CanType> RemappedASTTypes;
+  /// The substitution map for ApplySubs, created on demand.
+  std::unique_ptr<SubstitutionMap> ApplySubsMap;
 };
 
 } // end namespace swift
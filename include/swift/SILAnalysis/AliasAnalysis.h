@@ -70,6 +70,21 @@ private:
 
   using MemoryBehavior = SILInstruction::MemoryBehavior;
 
+  using AliasCacheKey = std::pair<std::pair<SILValue, SILValue>, TBAACacheKey>;
+  using MemoryBehaviorCacheKey =
+    std::pair<std::pair<SILInstruction *, SILValue>, unsigned>;
+
+  /// Caches of the results of alias and memory behavior queries.
+  ///
+  /// The memory of deleted instructions is only reused after the pass that
+  /// deleted them has finished, and its invalidation has cleared these
+  /// caches, so a key never refers to a different value than the one it was
+  /// computed for. Results also change when the IR does, so both caches are
+  /// cleared whenever the pass manager reports an invalidation, and when they
+  /// outgrow -aa-cache-size-limit.
+  llvm::DenseMap<AliasCacheKey, AliasResult> AliasCache;
+  llvm::DenseMap<MemoryBehaviorCacheKey, MemoryBehavior> MemoryBehaviorCache;
+
   AliasResult aliasAddressProjection(SILValue V1, SILValue V2,
                                      SILValue O1, SILValue O2);
 
@@ -81,6 +96,11 @@ private:
   /// Returns True if memory of type \p T1 and \p T2 may alias.
   bool typesMayAlias(SILType T1, SILType T2);
 
+  /// Compute the memory behavior of Inst with respect to V, bypassing the
+  /// cache.
+  MemoryBehavior computeMemoryBehaviorInner(SILInstruction *Inst, SILValue V,
+                                            RetainObserveKind);
+
 public:
   AliasAnalysis(SILModule *M) :
     SILAnalysis(AnalysisKind::Alias), Mod(M), SEA(nullptr) {}
@@ -168,7 +188,18 @@ public:
     return MemoryBehavior::MayHaveSideEffects == B;
   }
 
-  virtual void invalidate(SILAnalysis::InvalidationKind K) { }
+  /// Drop all cached alias and memory behavior results.
+  void clearCaches() {
+    AliasCache.clear();
+    MemoryBehaviorCache.clear();
+  }
+
+  /// Any change to any function may change the results: memory behavior of
+  /// calls depends on the side effects of the callees.
+  virtual void invalidate(SILAnalysis::InvalidationKind K) {
+    if (K != InvalidationKind::Nothing)
+      clearCaches();
+  }
 
   virtual void invalidate(SILFunction *, SILAnalysis::InvalidationKind K) {
     invalidate(K);
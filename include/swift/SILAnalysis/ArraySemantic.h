@@ -50,6 +50,9 @@ public:
                      bool MatchPartialName);
 
   /// Match any array semantics call.
+  ///
+  /// This does not match the "dictionary." and "set." semantics calls, which
+  /// only support the make_mutable and mutate_unknown kinds.
   ArraySemanticsCall(ValueBase *V) : ArraySemanticsCall(V, "array.", true) {}
 
   /// Match a specific array semantic call.
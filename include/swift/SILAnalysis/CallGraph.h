@@ -571,6 +571,15 @@ public:
       CG->addEdges(F);
   }
 
+  /// Recomputes the callee edges of function \p F, after the call sites in
+  /// \p F were changed without updating the call graph.
+  void updateEdgesForFunction(SILFunction *F);
+
+  /// Returns true if the call graph has a node for function \p F.
+  bool hasNode(SILFunction *F) const {
+    return CG && CG->tryGetCallGraphNode(F);
+  }
+
   void removeEdgeIfPresent(SILInstruction *I) {
     if (CG)
       if (auto *Edge = CG->tryGetCallGraphEdge(I))
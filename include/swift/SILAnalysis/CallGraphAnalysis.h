@@ -59,8 +59,17 @@ public:
     }
   }
 
-  virtual void invalidate(SILFunction *, SILAnalysis::InvalidationKind K) {
-    invalidate(K);
+  virtual void invalidate(SILFunction *F, SILAnalysis::InvalidationKind K) {
+    // Added or removed functions affect the callee sets of method calls, so
+    // the call graph needs to be rebuilt.
+    if ((K & InvalidationKind::Functions) || !CallGraphEditor(CG).hasNode(F)) {
+      invalidate(K);
+      return;
+    }
+
+    // Changed call sites only affect the callee edges of this function.
+    if (K & InvalidationKind::Calls)
+      CallGraphEditor(CG).updateEdgesForFunction(F);
   }
 
   virtual void verify() const {
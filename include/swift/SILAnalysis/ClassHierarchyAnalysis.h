@@ -27,6 +27,7 @@ namespace swift {
 
 class SILModule;
 class ClassDecl;
+class FuncDecl;
 class ClassHierarchyAnalysis : public SILAnalysis {
 public:
   typedef SmallVector<ClassDecl *, 8> ClassList;
@@ -88,6 +89,20 @@ public:
     return ProtocolImplementationsCache.count(C);
   }
 
+  /// Returns true if every subclass of \p C is known to this analysis, i.e.
+  /// if \p C can't be subclassed outside of the current module. Unless this
+  /// is a whole-module compilation, only private classes qualify.
+  bool areAllSubclassesKnown(ClassDecl *C);
+
+  /// Returns true if \p C is final, or if it has no subclasses and can't be
+  /// subclassed anywhere else.
+  bool isEffectivelyFinal(ClassDecl *C);
+
+  /// Returns true if a call of \p Method on an instance whose static type is
+  /// \p C always dispatches to the implementation which \p C uses, because
+  /// no subclass of \p C overrides it and there are no unknown subclasses.
+  bool isEffectivelyFinal(FuncDecl *Method, ClassDecl *C);
+
   virtual void invalidate(SILFunction *F, SILAnalysis::InvalidationKind K) {
     invalidate(K);
   }
@@ -0,0 +1,157 @@
+//===--- ValueRange.h - Ranges of SIL integer values ------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This file computes intervals of the values a builtin integer SSA value can
+// have at a given instruction. The intervals are derived from literals,
+// arithmetic, conditional branches and cond_fails which dominate the
+// instruction, and loop induction variables.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILANALYSIS_VALUERANGE_H
+#define SWIFT_SILANALYSIS_VALUERANGE_H
+
+#include "swift/AST/Builtins.h"
+#include "swift/SIL/SILValue.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace swift {
+
+class BuiltinInst;
+class DominanceInfo;
+class SILArgument;
+class SILBasicBlock;
+class SILFunction;
+class SILInstruction;
+
+/// An inclusive interval [Min, Max] of signed integers of a fixed bit width.
+class IntRange {
+  llvm::APInt Min, Max;
+
+public:
+  IntRange(const llvm::APInt &Min, const llvm::APInt &Max)
+    : Min(Min), Max(Max) {
+    assert(Min.getBitWidth() == Max.getBitWidth() && Min.sle(Max) &&
+           "invalid range");
+  }
+
+  /// Returns the range of all values of \p BitWidth bits.
+  static IntRange getFull(unsigned BitWidth) {
+    return IntRange(llvm::APInt::getSignedMinValue(BitWidth),
+                    llvm::APInt::getSignedMaxValue(BitWidth));
+  }
+
+  static IntRange getConstant(const llvm::APInt &Value) {
+    return IntRange(Value, Value);
+  }
+
+  unsigned getBitWidth() const { return Min.getBitWidth(); }
+  const llvm::APInt &getMin() const { return Min; }
+  const llvm::APInt &getMax() const { return Max; }
+
+  bool isFull() const {
+    return Min.isMinSignedValue() && Max.isMaxSignedValue();
+  }
+  bool isNonNegative() const { return !Min.isNegative(); }
+
+  /// Returns the intersection with \p Other, or None if it is empty.
+  Optional<IntRange> intersect(const IntRange &Other) const;
+
+  /// Returns the smallest range which contains this range and \p Other.
+  IntRange unionWith(const IntRange &Other) const;
+
+  /// Returns the range of the results of the overflow-checking arithmetic
+  /// builtin \p Kind applied to values in \p LHS and \p RHS, if none of them
+  /// overflows.
+  static Optional<IntRange> getExactResult(BuiltinValueKind Kind,
+                                           const IntRange &LHS,
+                                           const IntRange &RHS);
+
+  /// Returns true if the overflow-checking arithmetic builtin \p Kind may
+  /// overflow for some values in \p LHS and \p RHS.
+  static bool canOverflow(BuiltinValueKind Kind, const IntRange &LHS,
+                          const IntRange &RHS);
+
+  void print(llvm::raw_ostream &OS) const;
+};
+
+/// Computes the ranges of builtin integer values in a function.
+///
+/// Conditions are collected once, when the info is created. A cond_fail must
+/// not be removed while the info is still in use unless it is redundant, i.e.
+/// implied by the remaining conditions.
+class ValueRangeInfo {
+  /// A relation "V Pred Other" between some value V and Other, which holds in
+  /// the blocks dominated by Block or, if After is set, at the instructions
+  /// which After properly dominates.
+  struct Fact {
+    SILBasicBlock *Block;
+    SILInstruction *After;
+    BuiltinValueKind Pred;
+    SILValue Other;
+  };
+
+  DominanceInfo *DT;
+
+  /// The facts about each value.
+  llvm::DenseMap<SILValue, llvm::SmallVector<Fact, 2>> Facts;
+
+  /// The block arguments whose range is being computed, to break cycles.
+  llvm::SmallPtrSet<ValueBase *, 8> VisitingArgs;
+
+  void addCondition(SILValue Cond, bool IsTrue, SILBasicBlock *Block,
+                    SILInstruction *After, unsigned Depth = 0);
+  void addComparison(BuiltinValueKind Pred, SILValue LHS, SILValue RHS,
+                     SILBasicBlock *Block, SILInstruction *After);
+  bool holdsAt(const Fact &F, SILInstruction *At);
+
+  IntRange getRange(SILValue V, SILInstruction *At, unsigned Depth);
+  IntRange getBaseRange(SILValue V, SILInstruction *At, unsigned Depth);
+  IntRange getArgumentRange(SILArgument *Arg, unsigned Depth);
+  Optional<IntRange> getInductionVariableRange(SILArgument *Arg,
+                                               unsigned Depth);
+  IntRange getIncomingRange(SILArgument *Arg, SILBasicBlock *Pred,
+                            unsigned Depth);
+  IntRange refineWithEdgeCondition(SILValue V, IntRange R,
+                                   SILBasicBlock *Pred, SILBasicBlock *Succ,
+                                   unsigned Depth);
+  IntRange refine(const IntRange &R, BuiltinValueKind Pred,
+                  const IntRange &Other);
+  bool isOverflowCheckedAt(BuiltinInst *BI, SILInstruction *At);
+
+public:
+  ValueRangeInfo(SILFunction *F, DominanceInfo *DT);
+
+  ValueRangeInfo(const ValueRangeInfo &) = delete;
+  ValueRangeInfo &operator=(const ValueRangeInfo &) = delete;
+
+  /// Returns true if \p V is a builtin integer of a fixed width, so that
+  /// getRange can be called for it.
+  static bool hasRange(SILValue V);
+
+  /// Returns the range of the values \p V can have when \p At is executed.
+  IntRange getRange(SILValue V, SILInstruction *At) {
+    return getRange(V, At, 0);
+  }
+
+  /// Returns true if the overflow-checking arithmetic builtin \p BI never
+  /// overflows.
+  bool isOverflowImpossible(BuiltinInst *BI);
+};
+
+} // end namespace swift
+
+#endif
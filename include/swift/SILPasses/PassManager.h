@@ -15,6 +15,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
 
@@ -57,8 +58,19 @@ class SILPassManager {
   /// A completed-passes mask for each function.
   llvm::DenseMap<SILFunction *, CompletedPasses> CompletedPassesMap;
 
+  /// The completed-passes mask for module passes. A module pass is skipped if
+  /// it didn't change anything in its last run and nothing in the module was
+  /// invalidated since then.
+  CompletedPasses CompletedModulePasses;
+
   /// Set to true when a pass invalidates an analysis.
   bool currentPassHasInvalidated = false;
+
+  /// Set to true when a pass invalidates an analysis of the whole module.
+  bool currentPassHasInvalidatedModule = false;
+
+  /// The functions the current pass invalidated analyses of.
+  llvm::SmallPtrSet<SILFunction *, 16> currentPassInvalidatedFunctions;
   
 public:
   /// C'tor. It creates and registers all analysis passes, which are defined
@@ -97,9 +109,11 @@ public:
         AP->invalidate(K);
 
     currentPassHasInvalidated = true;
+    currentPassHasInvalidatedModule = true;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
+    CompletedModulePasses.reset();
   }
 
   /// \brief Broadcast the invalidation of the function to all analysis.
@@ -111,8 +125,10 @@ public:
         AP->invalidate(F, K);
     
     currentPassHasInvalidated = true;
+    currentPassInvalidatedFunctions.insert(F);
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
+    CompletedModulePasses.reset();
   }
 
   /// \brief Reset the state of the pass manager and remove all transformation
@@ -156,10 +172,30 @@ public:
 
   typedef llvm::ArrayRef<SILFunctionTransform *> PassList;
 private:
-  /// Run the passes in \p FuncTransforms. Return true
+  /// Run the passes in \p FuncTransforms on all functions of the module,
+  /// visiting callees before their callers. Return true
   /// if the pass manager requested to stop the execution
   /// of the optimization cycle (this is a debug feature).
   bool runFunctionPasses(PassList FuncTransforms);
+
+  /// Run the passes in \p FuncTransforms on the function \p F. Return true
+  /// if the pass manager requested to stop the execution of the optimization
+  /// cycle.
+  bool runPassesOnFunction(PassList FuncTransforms, SILFunction *F);
+
+  /// Return true if any of the passes in \p FuncTransforms needs to run on
+  /// \p F, because \p F changed since the last run of the pass.
+  bool needsToRunPasses(PassList FuncTransforms, SILFunction &F) const;
+
+  /// Return true if \p F is in the sample of functions verified after the
+  /// current pass.
+  bool isSampledForVerification(const SILFunction &F) const;
+
+  /// Verify the module and the analyses after a module pass. \p
+  /// FunctionsBefore are the functions which existed before the pass, if
+  /// only the functions the pass changed or created need to be verified.
+  void verifyAfterModulePass(
+      const llvm::SmallPtrSetImpl<SILFunction *> *FunctionsBefore);
 };
 
 } // end namespace swift
@@ -30,6 +30,8 @@
 #include "llvm/ADT/ArrayRef.h"
 
 namespace swift {
+class ClassHierarchyAnalysis;
+
 /// A pair representing results of devirtualization.
 ///  - The first element is the value representing the result of the
 ///    devirtualized call.
@@ -42,7 +44,12 @@ namespace swift {
 /// casted to produce a properly typed value (first element).
 typedef std::pair<ValueBase *, ApplySite> DevirtualizationResult;
 
-DevirtualizationResult tryDevirtualizeApply(FullApplySite AI);
+/// Attempt to devirtualize the given apply. If \p CHA is given, class
+/// methods which no subclass of the receiver's static type overrides are
+/// devirtualized too.
+DevirtualizationResult tryDevirtualizeApply(FullApplySite AI,
+                                            ClassHierarchyAnalysis *CHA =
+                                              nullptr);
 bool isClassWithUnboundGenericParameters(SILType C, SILModule &M);
 bool canDevirtualizeClassMethod(FullApplySite AI, SILType ClassInstanceType);
 DevirtualizationResult devirtualizeClassMethod(FullApplySite AI,
@@ -52,9 +52,20 @@ public:
                                     TypeSubstitutionMap &ContextSubs,
                                     StringRef NewName, ApplySite Caller,
                             CloneCollector::CallbackType Callback =nullptr) {
+    return cloneFunction(F, InterfaceSubs, ContextSubs, NewName,
+                         Caller.getSubstitutions(), Callback);
+  }
+
+  /// Clone and remap the types in \p F for the substitutions \p Subs,
+  /// without a call site.
+  static SILFunction *cloneFunction(SILFunction *F,
+                                    TypeSubstitutionMap &InterfaceSubs,
+                                    TypeSubstitutionMap &ContextSubs,
+                                    StringRef NewName,
+                                    ArrayRef<Substitution> Subs,
+                            CloneCollector::CallbackType Callback =nullptr) {
     // Clone and specialize the function.
-    GenericCloner SC(F, InterfaceSubs, ContextSubs, NewName,
-                     Caller.getSubstitutions(), Callback);
+    GenericCloner SC(F, InterfaceSubs, ContextSubs, NewName, Subs, Callback);
     SC.populateCloned();
     SC.cleanUp(SC.getCloned());
     return SC.getCloned();
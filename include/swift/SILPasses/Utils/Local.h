@@ -160,6 +160,16 @@ SILLinkage getSpecializedLinkage(SILFunction *F, SILLinkage L);
 /// string literals. Returns a new instruction if optimization was possible.
 SILInstruction *tryToConcatenateStrings(ApplyInst *AI, SILBuilder &B);
 
+/// Tries to fold a string interpolation whose segments are all string literals
+/// or constant integers into a single string literal.
+///
+/// On success all uses of \p AI are replaced by the new string, \p AI and the
+/// instructions creating its segments are deleted, and the apply creating the
+/// new string is returned. \p C is called for each deleted instruction.
+SILInstruction *tryToFoldStringInterpolation(
+  ApplyInst *AI, SILBuilder &B,
+  std::function<void(SILInstruction *)> C = [](SILInstruction *){});
+
 /// Tries to perform jump-threading on a given checked_cast_br terminator.
 bool tryCheckedCastBrJumpThreading(TermInst *Term, DominanceInfo *DT,
                                    SmallVectorImpl<SILBasicBlock *> &BBs);
@@ -197,6 +207,11 @@ bool
 tryDeleteDeadClosure(SILInstruction *Closure,
                      InstModCallbacks Callbacks = InstModCallbacks());
 
+/// Returns true if the closure created by \p PAI cannot outlive the call it
+/// is passed to, i.e. if it is the context of a @noescape closure expression
+/// or a reabstraction thunk applied to such a closure.
+bool isNoEscapeClosure(PartialApplyInst *PAI);
+
 /// Given a SILValue argument to a partial apply \p Arg and the associated
 /// parameter info for that argument, perform the necessary cleanups to Arg when
 /// one is attempting to delete the partial apply.
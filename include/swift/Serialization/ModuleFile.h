@@ -26,8 +26,10 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Fixnum.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Bitcode/BitstreamReader.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 namespace llvm {
@@ -74,6 +76,9 @@ class ModuleFile : public LazyMemberLoader {
   /// The target the module was built for.
   StringRef TargetTriple;
 
+  /// The hash of the module's interface, or empty if it wasn't recorded.
+  StringRef InterfaceHash;
+
   /// The data blob containing all of the module's identifiers.
   StringRef IdentifierData;
 
@@ -231,21 +236,73 @@ public:
     }
   };
 
+  /// A table of entities that are looked up by index.
+  ///
+  /// The table refers directly to the array of 32-bit offsets in the module
+  /// buffer. An entry is created from its offset the first time it is looked
+  /// up, so opening a module doesn't do any work per entity, and untouched
+  /// parts of the array are never paged in.
+  template <typename T>
+  class LazyOffsetTable {
+    /// The on-disk offsets, in little-endian byte order.
+    StringRef RawOffsets;
+
+    /// The entries that have been looked up, allocated on first use.
+    std::unique_ptr<Optional<T>[]> Entries;
+
+  public:
+    void assign(StringRef rawOffsets) {
+      assert(rawOffsets.size() % sizeof(uint32_t) == 0 &&
+             "offset array is not a whole number of offsets");
+      RawOffsets = rawOffsets;
+      Entries.reset();
+    }
+
+    size_t size() const {
+      return RawOffsets.size() / sizeof(uint32_t);
+    }
+
+    T &operator[](size_t index) {
+      assert(index < size() && "invalid index");
+      if (!Entries)
+        Entries.reset(new Optional<T>[size()]);
+
+      Optional<T> &entry = Entries[index];
+      if (!entry) {
+        using namespace llvm::support;
+        const char *rawOffset = RawOffsets.data() + index * sizeof(uint32_t);
+        serialization::BitOffset offset{
+          endian::read<uint32_t, little, unaligned>(rawOffset)
+        };
+        entry = T(offset);
+      }
+      return entry.getValue();
+    }
+
+    /// Returns the entry at \p index if it has been looked up already, or
+    /// null otherwise.
+    const T *getIfLoaded(size_t index) const {
+      if (!Entries || !Entries[index])
+        return nullptr;
+      return Entries[index].getPointer();
+    }
+  };
+
 private:
   /// Decls referenced by this module.
-  std::vector<Serialized<Decl*>> Decls;
+  LazyOffsetTable<Serialized<Decl*>> Decls;
 
   /// DeclContexts referenced by this module.
-  std::vector<Serialized<DeclContext*>> DeclContexts;
+  LazyOffsetTable<Serialized<DeclContext*>> DeclContexts;
 
   /// Local DeclContexts referenced by this module.
-  std::vector<Serialized<DeclContext*>> LocalDeclContexts;
+  LazyOffsetTable<Serialized<DeclContext*>> LocalDeclContexts;
 
   /// Normal protocol conformances referenced by this module.
-  std::vector<Serialized<NormalProtocolConformance *>> NormalConformances;
+  LazyOffsetTable<Serialized<NormalProtocolConformance *>> NormalConformances;
 
   /// Types referenced by this module.
-  std::vector<Serialized<Type>> Types;
+  LazyOffsetTable<Serialized<Type>> Types;
 
   /// Represents an identifier that may or may not have been deserialized yet.
   ///
@@ -261,7 +318,54 @@ private:
   };
 
   /// Identifiers referenced by this module.
-  std::vector<SerializedIdentifier> Identifiers;
+  LazyOffsetTable<SerializedIdentifier> Identifiers;
+
+public:
+  /// The number of entities deserialized from this module so far.
+  struct DeserializationStats {
+    unsigned NumDecls = 0;
+    unsigned NumTypes = 0;
+    unsigned NumConformances = 0;
+    unsigned NumSILFunctions = 0;
+  };
+
+  /// Names the request that decls are being deserialized for while it is
+  /// being served, so that they can be attributed to it in
+  /// -print-deserialization-stats.
+  ///
+  /// Only the outermost request is recorded: anything deserialized while
+  /// serving it counts towards it. Does nothing unless deserialization is
+  /// being traced.
+  class DeserializationTriggerRAII {
+    ModuleFile &File;
+    bool IsOutermost = false;
+
+  public:
+    DeserializationTriggerRAII(ModuleFile &file, StringRef kind,
+                               StringRef name = StringRef());
+    ~DeserializationTriggerRAII() {
+      if (IsOutermost)
+        File.CurrentTrigger.clear();
+    }
+
+    DeserializationTriggerRAII(const DeserializationTriggerRAII &) = delete;
+    void operator=(const DeserializationTriggerRAII &) = delete;
+  };
+
+private:
+  DeserializationStats Stats;
+
+  /// While tracing, the request currently being served, or an empty string.
+  std::string CurrentTrigger;
+
+  /// While tracing, the number of decls deserialized for each request.
+  llvm::StringMap<unsigned> DeclsByTrigger;
+
+  /// Whether to record which requests cause decls to be deserialized.
+  bool isTracingDeserialization() const;
+
+  /// Counts a decl as deserialized, attributing it to the current request.
+  void noteDeserializedDecl();
 
   class DeclTableInfo;
   using SerializedDeclTable =
@@ -278,6 +382,12 @@ private:
   std::unique_ptr<SerializedDeclTable> OperatorMethodDecls;
   std::unique_ptr<SerializedLocalDeclTable> LocalTypeDecls;
 
+  class DeclMemberNamesTableInfo;
+  using SerializedDeclMemberNamesTable =
+      llvm::OnDiskIterableChainedHashTable<DeclMemberNamesTableInfo>;
+
+  std::unique_ptr<SerializedDeclMemberNamesTable> DeclMemberNames;
+
   class ObjCMethodTableInfo;
   using SerializedObjCMethodTable =
     llvm::OnDiskIterableChainedHashTable<ObjCMethodTableInfo>;
@@ -383,6 +493,11 @@ private:
   std::unique_ptr<SerializedLocalDeclTable>
   readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData);
 
+  /// Read an on-disk member name table stored in
+  /// index_block::DeclListLayout format.
+  std::unique_ptr<SerializedDeclMemberNamesTable>
+  readDeclMemberNamesTable(ArrayRef<uint64_t> fields, StringRef blobData);
+
   /// Read an on-disk Objective-C method table stored in
   /// index_block::ObjCMethodTableLayout format.
   std::unique_ptr<ModuleFile::SerializedObjCMethodTable>
@@ -583,15 +698,48 @@ public:
     return TargetTriple;
   }
 
+  /// Returns the hash of everything clients of the module depend on, as
+  /// stored in the serialized data, or an empty string if there is none.
+  StringRef getInterfaceHash() const {
+    return InterfaceHash;
+  }
+
   /// AST-verify imported decls.
   ///
   /// Has no effect in NDEBUG builds.
   void verify() const;
 
+  const DeserializationStats &getDeserializationStats() const {
+    return Stats;
+  }
+
+  /// Counts a SIL function as deserialized.
+  void noteDeserializedSILFunction() {
+    ++Stats.NumSILFunctions;
+  }
+
+  /// Prints how many entities were deserialized from this module and, if
+  /// deserialization was traced, the requests that caused the most decls to
+  /// be deserialized.
+  void printDeserializationStats(raw_ostream &os) const;
+
+  /// Returns the size of the module and module documentation buffers held by
+  /// this file.
+  size_t getBufferMemory() const {
+    size_t size = ModuleInputBuffer ? ModuleInputBuffer->getBufferSize() : 0;
+    if (ModuleDocInputBuffer)
+      size += ModuleDocInputBuffer->getBufferSize();
+    return size;
+  }
+
   virtual void loadAllMembers(Decl *D,
                               uint64_t contextData,
                               bool *ignored) override;
 
+  virtual bool loadNamedMembers(const Decl *D, Identifier baseName,
+                                uint64_t contextData,
+                                SmallVectorImpl<ValueDecl *> &members) override;
+
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
                       SmallVectorImpl<ProtocolConformance*> &Conforms) override;
@@ -51,7 +51,7 @@ const uint16_t VERSION_MAJOR = 0;
 /// To ensure that two separate changes don't silently get merged into one
 /// in source control, you should also update the comment to briefly
 /// describe what change you made.
-const uint16_t VERSION_MINOR = 222; // Last change: @_fixed_layout
+const uint16_t VERSION_MINOR = 230; // Last change: canonical SIL in SIB
 
 using DeclID = Fixnum<31>;
 using DeclIDField = BCFixed<31>;
@@ -401,7 +401,8 @@ namespace control_block {
   enum {
     METADATA = 1,
     MODULE_NAME,
-    TARGET
+    TARGET,
+    INTERFACE_HASH
   };
 
   using MetadataLayout = BCRecordLayout<
@@ -420,6 +421,11 @@ namespace control_block {
     TARGET,
     BCBlob // LLVM triple
   >;
+
+  using InterfaceHashLayout = BCRecordLayout<
+    INTERFACE_HASH,
+    BCBlob // hash of everything importers depend on, as a hex string
+  >;
 }
 
 /// The record types within the options block (a sub-block of the control
@@ -433,7 +439,8 @@ namespace options_block {
     SDK_PATH = 1,
     XCC,
     IS_SIB,
-    IS_TESTABLE
+    IS_TESTABLE,
+    IS_CANONICAL_SIL
   };
 
   using SDKPathLayout = BCRecordLayout<
@@ -454,6 +461,10 @@ namespace options_block {
   using IsTestableLayout = BCRecordLayout<
     IS_TESTABLE
   >;
+
+  using IsCanonicalSILLayout = BCRecordLayout<
+    IS_CANONICAL_SIL
+  >;
 }
 
 /// The record types within the input block.
@@ -1422,11 +1433,19 @@ namespace index_block {
     DECL_CONTEXT_OFFSETS,
     LOCAL_TYPE_DECLS,
     NORMAL_CONFORMANCE_OFFSETS,
+
+    /// The member name index, which maps the base name of every member of a
+    /// nominal type or extension to the member list it appears in and the
+    /// member's decl ID. Uses the DeclListLayout format.
+    DECL_MEMBER_NAMES,
   };
 
+  /// The offsets are stored as an array of 32-bit little-endian integers, so
+  /// that they can be read straight out of the module buffer when an entry is
+  /// first needed, rather than decoded up front.
   using OffsetsLayout = BCGenericRecordLayout<
     BCFixed<4>,  // record ID
-    BCArray<BitOffsetField>
+    BCBlob       // array of BitOffsets, 32 bits each
   >;
 
   using DeclListLayout = BCGenericRecordLayout<
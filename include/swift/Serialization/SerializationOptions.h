@@ -38,6 +38,10 @@ namespace swift {
     bool SerializeAllSIL = false;
     bool SerializeOptionsForDebugging = false;
     bool IsSIB = false;
+
+    /// The number of threads to use to build the module's lookup tables.
+    /// With fewer than two, they are built on the calling thread.
+    unsigned NumThreads = 0;
   };
 
 } // end namespace swift
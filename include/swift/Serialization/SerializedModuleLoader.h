@@ -91,6 +91,17 @@ public:
                  llvm::TinyPtrVector<AbstractFunctionDecl *> &methods) override;
 
   virtual void verifyAllModules() override;
+
+  /// Keep the contents of every module file read from disk for the rest of
+  /// the process, so that later ASTContexts importing the same unchanged
+  /// files don't have to read them again.
+  ///
+  /// This is meant for long-running processes that perform many
+  /// compilations, such as the compile server and SourceKit. The contents are
+  /// reference-counted by the ASTContexts using them, so a module file that
+  /// changes on disk is re-read without invalidating existing contexts. Decls
+  /// are still deserialized separately into each ASTContext.
+  static void enableProcessWideBufferCache();
 };
 
 /// A file-unit loaded from a serialized AST file.
@@ -151,6 +162,20 @@ public:
 
   virtual StringRef getFilename() const override;
 
+  /// Returns the hash of everything clients of the module depend on, or an
+  /// empty string if the module file doesn't have one.
+  StringRef getInterfaceHash() const;
+
+  /// Prints how many entities were deserialized from this file.
+  ///
+  /// \sa ModuleFile::printDeserializationStats
+  void printDeserializationStats(raw_ostream &os) const;
+
+  /// Returns the size of the buffers the module was read from.
+  ///
+  /// \sa ModuleFile::getBufferMemory
+  size_t getBufferMemory() const;
+
   ClassDecl *getMainClass() const override;
 
   bool hasEntryPoint() const override;
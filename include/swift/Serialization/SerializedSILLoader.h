@@ -30,6 +30,23 @@ class SILModule;
 class SILVTable;
 class SILWitnessTable;
 
+namespace Lowering {
+  enum class NominalLoweringKind : uint8_t;
+}
+
+/// What a serialized module records about one of its SIL functions, which
+/// can be read without deserializing the function.
+struct SILFunctionSummary {
+  /// The number of instructions in the serialized body.
+  unsigned NumInstructions = 0;
+  bool HasBody = false;
+  bool IsGeneric = false;
+  bool IsTransparent = false;
+  bool IsAlwaysInline = false;
+  bool IsNoInline = false;
+  bool HasSemantics = false;
+};
+
 /// Maintains a list of SILDeserializer, one for each serialized modules
 /// in ASTContext. It provides lookupSILFunction that will perform lookup
 /// on each SILDeserializer.
@@ -82,6 +99,16 @@ public:
   SILFunction *lookupSILFunction(SILFunction *Callee);
   SILFunction *lookupSILFunction(SILDeclRef Decl);
   SILFunction *lookupSILFunction(StringRef Name);
+
+  /// Returns the summary of the function named \p Name, preferring a module
+  /// that has its body, without deserializing it.
+  Optional<SILFunctionSummary> lookupFunctionSummary(StringRef Name);
+
+  /// Returns how the module file that declares \p D recorded that its
+  /// declared type lowers, or None if it didn't.
+  Optional<Lowering::NominalLoweringKind>
+  lookupNominalLoweringKind(const NominalTypeDecl *D);
+
   SILVTable *lookupVTable(Identifier Name);
   SILVTable *lookupVTable(const ClassDecl *C) {
     return lookupVTable(C->getName());
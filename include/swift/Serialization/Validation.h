@@ -67,6 +67,7 @@ namespace serialization {
   struct ValidationInfo {
     StringRef name = {};
     StringRef targetTriple = {};
+    StringRef interfaceHash = {};
     size_t bytes = 0;
     Status status = Status::Malformed;
   };
@@ -84,6 +85,7 @@ namespace serialization {
     struct {
       unsigned IsSIB : 1;
       unsigned IsTestable : 1;
+      unsigned IsCanonicalSIL : 1;
     } Bits;
   public:
     ExtendedValidationInfo() : Bits() {}
@@ -109,6 +111,11 @@ namespace serialization {
     void setIsTestable(bool val) {
       Bits.IsTestable = val;
     }
+    /// Whether the SIL of an intermediate file has been canonicalized.
+    bool isCanonicalSIL() const { return Bits.IsCanonicalSIL; }
+    void setIsCanonicalSIL(bool val) {
+      Bits.IsCanonicalSIL = val;
+    }
   };
 
   /// Returns info about the serialized AST in the given data.
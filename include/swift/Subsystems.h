@@ -137,7 +137,11 @@ namespace swift {
   ///
   /// \param HighPerformance True if the playground transform should omit
   /// instrumentation that has a high runtime performance impact.
-  void performPlaygroundTransform(SourceFile &SF, bool HighPerformance);
+  /// \param TopLevelOnly True if the playground transform should leave
+  /// functions, closures and loop bodies alone, and only log how many times
+  /// each loop in top-level code iterated.
+  void performPlaygroundTransform(SourceFile &SF, bool HighPerformance,
+                                  bool TopLevelOnly = false);
   
   /// Flags used to control type checking.
   enum class TypeCheckingFlags : unsigned {
@@ -151,7 +155,11 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// If set, dumps a report of the wall time and constraint solver work
+    /// taken to check each expression and function body to llvm::errs().
+    DebugTimeExpressions = 1 << 3
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
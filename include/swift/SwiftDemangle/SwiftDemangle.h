@@ -27,7 +27,7 @@
 
 /// Minor version changes when new APIs are added in ABI- and source-compatible
 /// way.
-#define SWIFT_DEMANGLE_VERSION_MINOR 2
+#define SWIFT_DEMANGLE_VERSION_MINOR 3
 
 /// @}
 
@@ -53,6 +53,20 @@ size_t swift_demangle_getSimplifiedDemangledName(const char *MangledName,
                                                  char *OutputBuffer,
                                                  size_t Length);
 
+/// \brief Demangle a batch of Swift function names into one buffer.
+///
+/// The demangled names are written one after another into \p OutputBuffer,
+/// each terminated by a null character, and the offset of the demangled name
+/// of \p MangledNames[i] is stored into \p Offsets[i]. The offset is SIZE_MAX
+/// if the input is not a Swift-mangled function name, or if the demangled name
+/// did not fit into the buffer.
+///
+/// \returns the size of the buffer needed for all demangled names. If it is
+/// greater than \p Length, some names were not written.
+size_t swift_demangle_getDemangledNames(const char *const *MangledNames,
+                                        size_t Count, char *OutputBuffer,
+                                        size_t Length, size_t *Offsets);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
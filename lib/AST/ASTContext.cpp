@@ -39,6 +39,7 @@
 #include "llvm/ADT/StringMap.h"
 #include <algorithm>
 #include <memory>
+#include <mutex>
 
 using namespace swift;
 
@@ -75,6 +76,11 @@ struct ASTContext::Implementation {
 
   llvm::BumpPtrAllocator Allocator; // used in later initializations
 
+  /// Guards the uniquing tables and the permanent allocator when
+  /// LangOptions::EnableConcurrentTypeUniquing is set. Recursive, since
+  /// uniquing a type routinely uniques its components first.
+  std::recursive_mutex UniquingMutex;
+
   /// The set of cleanups to be called when the ASTContext is destroyed.
   std::vector<std::function<void(void)>> Cleanups;
 
@@ -285,6 +291,10 @@ struct ASTContext::Implementation {
     llvm::FoldingSet<InheritedProtocolConformance> InheritedConformances;
 
     ~Arena() {
+      destroyConformances();
+    }
+
+    void destroyConformances() {
       for (auto &conformance : SpecializedConformances)
         conformance.~SpecializedProtocolConformance();
       for (auto &conformance : InheritedConformances)
@@ -296,6 +306,36 @@ struct ASTContext::Implementation {
         conformance.~NormalProtocolConformance();
     }
 
+    /// Forget everything uniqued in this arena, keeping the tables' storage
+    /// around for the next user of the arena.
+    void clear() {
+      destroyConformances();
+      TupleTypes.clear();
+      MetatypeTypes.clear();
+      ExistentialMetatypeTypes.clear();
+      FunctionTypes.clear();
+      ArraySliceTypes.clear();
+      DictionaryTypes.clear();
+      OptionalTypes.clear();
+      ImplicitlyUnwrappedOptionalTypes.clear();
+      ParenTypes.clear();
+      ReferenceStorageTypes.clear();
+      LValueTypes.clear();
+      InOutTypes.clear();
+      SubstitutedTypes.clear();
+      DependentMemberTypes.clear();
+      DynamicSelfTypes.clear();
+      EnumTypes.clear();
+      StructTypes.clear();
+      ClassTypes.clear();
+      UnboundGenericTypes.clear();
+      BoundGenericTypes.clear();
+      BoundGenericSubstitutions.clear();
+      NormalConformances.clear();
+      SpecializedConformances.clear();
+      InheritedConformances.clear();
+    }
+
     size_t getTotalMemory() const;
   };
 
@@ -333,14 +373,14 @@ struct ASTContext::Implementation {
   /// Temporary arena used for a constraint solver.
   struct ConstraintSolverArena : public Arena {
     /// The allocator used for all allocations within this arena.
-    llvm::BumpPtrAllocator &Allocator;
+    llvm::BumpPtrAllocator *Allocator;
 
     /// Callback used to get a type member of a type variable.
     GetTypeVariableMemberCallback GetTypeMember;
 
     ConstraintSolverArena(llvm::BumpPtrAllocator &allocator,
                           GetTypeVariableMemberCallback &&getTypeMember)
-      : Allocator(allocator), GetTypeMember(std::move(getTypeMember)) { }
+      : Allocator(&allocator), GetTypeMember(std::move(getTypeMember)) { }
 
     ConstraintSolverArena(const ConstraintSolverArena &) = delete;
     ConstraintSolverArena(ConstraintSolverArena &&) = delete;
@@ -351,6 +391,15 @@ struct ASTContext::Implementation {
   /// \brief The current constraint solver arena, if any.
   std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
 
+  /// The most memory used by any constraint solver arena, including the
+  /// allocator it was given.
+  size_t PeakSolverMemory = 0;
+
+  /// Constraint solver arenas that are no longer in use, kept so that the
+  /// next constraint system can reuse their tables.
+  std::vector<std::unique_ptr<ConstraintSolverArena>>
+    FreeConstraintSolverArenas;
+
   Arena &getArena(AllocationArena arena) {
     switch (arena) {
     case AllocationArena::Permanent:
@@ -371,18 +420,58 @@ ASTContext::Implementation::~Implementation() {
     cleanup();
 }
 
+namespace {
+  /// Holds the uniquing lock of a context for its lifetime, if that context
+  /// may be used from several threads at once.
+  class UniquingLock {
+    std::unique_lock<std::recursive_mutex> Lock;
+
+  public:
+    explicit UniquingLock(const ASTContext &ctx)
+      : Lock(ctx.Impl.UniquingMutex, std::defer_lock) {
+      if (ctx.LangOpts.EnableConcurrentTypeUniquing)
+        Lock.lock();
+    }
+  };
+}
+
 ConstraintCheckerArenaRAII::
 ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator,
                            GetTypeVariableMemberCallback getTypeMember)
   : Self(self), Data(self.Impl.CurrentConstraintSolverArena.release())
 {
-  Self.Impl.CurrentConstraintSolverArena.reset(
-    new ASTContext::Implementation::ConstraintSolverArena(
-          allocator,
-          std::move(getTypeMember)));
+  auto &freeArenas = Self.Impl.FreeConstraintSolverArenas;
+  if (freeArenas.empty()) {
+    Self.Impl.CurrentConstraintSolverArena.reset(
+      new ASTContext::Implementation::ConstraintSolverArena(
+            allocator,
+            std::move(getTypeMember)));
+    return;
+  }
+
+  auto arena = std::move(freeArenas.back());
+  freeArenas.pop_back();
+  arena->Allocator = &allocator;
+  arena->GetTypeMember = std::move(getTypeMember);
+  Self.Impl.CurrentConstraintSolverArena = std::move(arena);
 }
 
+/// The largest constraint solver arena, in bytes of table storage, that is
+/// kept for reuse. The solver's memory threshold counts that storage, so
+/// keeping larger tables around would eat into the next expression's budget.
+static const size_t MaxReusedSolverArenaSize = 1 << 20;
+
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
+  auto &arena = Self.Impl.CurrentConstraintSolverArena;
+  Self.Impl.PeakSolverMemory =
+    std::max(Self.Impl.PeakSolverMemory,
+             arena->getTotalMemory() + arena->Allocator->getTotalMemory());
+  arena->clear();
+  if (arena->getTotalMemory() <= MaxReusedSolverArenaSize) {
+    arena->GetTypeMember = nullptr;
+    Self.Impl.FreeConstraintSolverArenas.push_back(std::move(arena));
+  }
+
   Self.Impl.CurrentConstraintSolverArena.reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
@@ -446,6 +535,12 @@ ASTContext::~ASTContext() {
   delete &Impl;
 }
 
+void *ASTContext::AllocateConcurrently(unsigned long bytes,
+                                       unsigned alignment) const {
+  std::lock_guard<std::recursive_mutex> lock(Impl.UniquingMutex);
+  return Impl.Allocator.Allocate(bytes, alignment);
+}
+
 llvm::BumpPtrAllocator &ASTContext::getAllocator(AllocationArena arena) const {
   switch (arena) {
   case AllocationArena::Permanent:
@@ -453,7 +548,7 @@ llvm::BumpPtrAllocator &ASTContext::getAllocator(AllocationArena arena) const {
 
   case AllocationArena::ConstraintSolver:
     assert(Impl.CurrentConstraintSolverArena.get() != nullptr);
-    return Impl.CurrentConstraintSolverArena->Allocator;
+    return *Impl.CurrentConstraintSolverArena->Allocator;
   }
   llvm_unreachable("bad AllocationArena");
 }
@@ -479,6 +574,7 @@ Identifier ASTContext::getIdentifier(StringRef Str) const {
   // Make sure null pointers stay null.
   if (Str.data() == nullptr) return Identifier(0);
 
+  UniquingLock lock(*this);
   auto I = Impl.IdentifierTable.insert(std::make_pair(Str, char())).first;
   return Identifier(I->getKeyData());
 }
@@ -1194,6 +1290,7 @@ ASTContext::createTrivialSubstitutions(BoundGenericType *BGT,
   Substitution Subst(Param->getArchetype(), BGT->getGenericArgs()[0], {});
   auto Substitutions = AllocateCopy(llvm::makeArrayRef(Subst));
   auto arena = getArena(BGT->getRecursiveProperties());
+  UniquingLock lock(*this);
   Impl.getArena(arena).BoundGenericSubstitutions
     .insert(std::make_pair(std::make_pair(BGT, gpContext), Substitutions));
   return Substitutions;
@@ -1205,6 +1302,7 @@ ASTContext::getSubstitutions(BoundGenericType* bound,
   assert(gpContext && "Missing generic parameter context");
   auto arena = getArena(bound->getRecursiveProperties());
   assert(bound->isCanonical() && "Requesting non-canonical substitutions");
+  UniquingLock lock(*this);
   auto &boundGenericSubstitutions
     = Impl.getArena(arena).BoundGenericSubstitutions;
   auto known = boundGenericSubstitutions.find({bound, gpContext});
@@ -1223,6 +1321,7 @@ void ASTContext::setSubstitutions(BoundGenericType* Bound,
                                   DeclContext *gpContext,
                                   ArrayRef<Substitution> Subs) const {
   auto arena = getArena(Bound->getRecursiveProperties());
+  UniquingLock lock(*this);
   auto &boundGenericSubstitutions
     = Impl.getArena(arena).BoundGenericSubstitutions;
   assert(Bound->isCanonical() && "Requesting non-canonical substitutions");
@@ -1501,6 +1600,7 @@ ASTContext::getConformance(Type conformingType,
 
   // Did we already record the normal conformance?
   void *insertPos;
+  UniquingLock lock(*this);
   auto &normalConformances =
     Impl.getArena(AllocationArena::Permanent).NormalConformances;
   if (auto result = normalConformances.FindNodeOrInsertPos(id, insertPos))
@@ -1527,6 +1627,7 @@ ASTContext::getSpecializedConformance(Type type,
 
   // Did we already record the specialized conformance?
   void *insertPos;
+  UniquingLock lock(*this);
   auto &specializedConformances = Impl.getArena(arena).SpecializedConformances;
   if (auto result = specializedConformances.FindNodeOrInsertPos(id, insertPos))
     return result;
@@ -1550,6 +1651,7 @@ ASTContext::getInheritedConformance(Type type, ProtocolConformance *inherited) {
 
   // Did we already record the normal protocol conformance?
   void *insertPos;
+  UniquingLock lock(*this);
   auto &inheritedConformances = Impl.getArena(arena).InheritedConformances;
   if (auto result
         = inheritedConformances.FindNodeOrInsertPos(id, insertPos))
@@ -1635,6 +1737,10 @@ size_t ASTContext::getSolverMemory() const {
   return Size;
 }
 
+size_t ASTContext::getPeakSolverMemory() const {
+  return Impl.PeakSolverMemory;
+}
+
 size_t ASTContext::Implementation::Arena::getTotalMemory() const {
   return sizeof(*this) +
     // TupleTypes ?
@@ -2280,6 +2386,7 @@ Type ErrorType::get(const ASTContext &C) { return C.TheErrorType; }
 
 BuiltinIntegerType *BuiltinIntegerType::get(BuiltinIntegerWidth BitWidth,
                                             const ASTContext &C) {
+  UniquingLock lock(C);
   BuiltinIntegerType *&Result = C.Impl.IntegerTypes[BitWidth];
   if (Result == 0)
     Result = new (C, AllocationArena::Permanent) BuiltinIntegerType(BitWidth,C);
@@ -2293,6 +2400,7 @@ BuiltinVectorType *BuiltinVectorType::get(const ASTContext &context,
   BuiltinVectorType::Profile(id, elementType, numElements);
 
   void *insertPos;
+  UniquingLock lock(context);
   if (BuiltinVectorType *vecType
         = context.Impl.BuiltinVectorTypes.FindNodeOrInsertPos(id, insertPos))
     return vecType;
@@ -2309,6 +2417,7 @@ BuiltinVectorType *BuiltinVectorType::get(const ASTContext &context,
 ParenType *ParenType::get(const ASTContext &C, Type underlying) {
   auto properties = underlying->getRecursiveProperties();
   auto arena = getArena(properties);
+  UniquingLock lock(C);
   ParenType *&Result = C.Impl.getArena(arena).ParenTypes[underlying];
   if (Result == 0) {
     Result = new (C, arena) ParenType(underlying, properties);
@@ -2351,6 +2460,7 @@ Type TupleType::get(ArrayRef<TupleTypeElt> Fields, const ASTContext &C) {
   llvm::FoldingSetNodeID ID;
   TupleType::Profile(ID, Fields);
 
+  UniquingLock lock(C);
   if (TupleType *TT
         = C.Impl.getArena(arena).TupleTypes.FindNodeOrInsertPos(ID,InsertPos))
     return TT;
@@ -2391,6 +2501,7 @@ UnboundGenericType* UnboundGenericType::get(NominalTypeDecl *TheDecl,
   if (Parent) properties |= Parent->getRecursiveProperties();
   auto arena = getArena(properties);
 
+  UniquingLock lock(C);
   if (auto unbound = C.Impl.getArena(arena).UnboundGenericTypes
                         .FindNodeOrInsertPos(ID, InsertPos))
     return unbound;
@@ -2437,6 +2548,7 @@ BoundGenericType *BoundGenericType::get(NominalTypeDecl *TheDecl,
   auto arena = getArena(properties);
 
   void *InsertPos = 0;
+  UniquingLock lock(C);
   if (BoundGenericType *BGT =
         C.Impl.getArena(arena).BoundGenericTypes.FindNodeOrInsertPos(ID,
                                                                      InsertPos))
@@ -2503,6 +2615,7 @@ EnumType *EnumType::get(EnumDecl *D, Type Parent, const ASTContext &C) {
   auto arena = getArena(properties);
 
   void *insertPos = 0;
+  UniquingLock lock(C);
   if (auto enumTy
         = C.Impl.getArena(arena).EnumTypes.FindNodeOrInsertPos(id, insertPos))
     return enumTy;
@@ -2530,6 +2643,7 @@ StructType *StructType::get(StructDecl *D, Type Parent, const ASTContext &C) {
   auto arena = getArena(properties);
 
   void *insertPos = 0;
+  UniquingLock lock(C);
   if (auto structTy
         = C.Impl.getArena(arena).StructTypes.FindNodeOrInsertPos(id, insertPos))
     return structTy;
@@ -2557,6 +2671,7 @@ ClassType *ClassType::get(ClassDecl *D, Type Parent, const ASTContext &C) {
   auto arena = getArena(properties);
 
   void *insertPos = 0;
+  UniquingLock lock(C);
   if (auto classTy
         = C.Impl.getArena(arena).ClassTypes.FindNodeOrInsertPos(id, insertPos))
     return classTy;
@@ -2577,6 +2692,7 @@ ProtocolCompositionType::build(const ASTContext &C, ArrayRef<Type> Protocols) {
   void *InsertPos = 0;
   llvm::FoldingSetNodeID ID;
   ProtocolCompositionType::Profile(ID, Protocols);
+  UniquingLock lock(C);
   if (ProtocolCompositionType *Result
         = C.Impl.ProtocolCompositionTypes.FindNodeOrInsertPos(ID, InsertPos))
     return Result;
@@ -2605,6 +2721,7 @@ ReferenceStorageType *ReferenceStorageType::get(Type T, Ownership ownership,
   auto arena = getArena(properties);
 
   auto key = uintptr_t(T.getPointer()) | unsigned(ownership);
+  UniquingLock lock(C);
   auto &entry = C.Impl.getArena(arena).ReferenceStorageTypes[key];
   if (entry) return entry;
 
@@ -2650,6 +2767,7 @@ MetatypeType *MetatypeType::get(Type T, Optional<MetatypeRepresentation> Repr,
   else
     reprKey = 0;
 
+  UniquingLock lock(Ctx);
   MetatypeType *&Entry = Ctx.Impl.getArena(arena).MetatypeTypes[{T, reprKey}];
   if (Entry) return Entry;
 
@@ -2676,6 +2794,7 @@ ExistentialMetatypeType::get(Type T, Optional<MetatypeRepresentation> repr,
   else
     reprKey = 0;
 
+  UniquingLock lock(ctx);
   auto &entry = ctx.Impl.getArena(arena).ExistentialMetatypeTypes[{T, reprKey}];
   if (entry) return entry;
 
@@ -2700,6 +2819,7 @@ ExistentialMetatypeType::ExistentialMetatypeType(Type T,
 ModuleType *ModuleType::get(Module *M) {
   ASTContext &C = M->getASTContext();
 
+  UniquingLock lock(C);
   ModuleType *&Entry = C.Impl.ModuleTypes[M];
   if (Entry) return Entry;
 
@@ -2711,6 +2831,7 @@ DynamicSelfType *DynamicSelfType::get(Type selfType, const ASTContext &ctx) {
   assert(properties.isMaterializable() && "non-materializable dynamic self?");
   auto arena = getArena(properties);
 
+  UniquingLock lock(ctx);
   auto &dynamicSelfTypes = ctx.Impl.getArena(arena).DynamicSelfTypes;
   auto known = dynamicSelfTypes.find(selfType);
   if (known != dynamicSelfTypes.end())
@@ -2781,6 +2902,7 @@ FunctionType *FunctionType::get(Type Input, Type Result,
 
   const ASTContext &C = Input->getASTContext();
 
+  UniquingLock lock(C);
   FunctionType *&Entry
     = C.Impl.getArena(arena).FunctionTypes[{Input, {Result, attrKey} }];
   if (Entry) return Entry;
@@ -2857,6 +2979,7 @@ GenericFunctionType::get(GenericSignature *sig,
 
   // Do we already have this generic function type?
   void *insertPos;
+  UniquingLock lock(ctx);
   if (auto result
         = ctx.Impl.GenericFunctionTypes.FindNodeOrInsertPos(id, insertPos))
     return result;
@@ -2893,6 +3016,7 @@ GenericFunctionType::GenericFunctionType(
 
 GenericTypeParamType *GenericTypeParamType::get(unsigned depth, unsigned index,
                                                 const ASTContext &ctx) {
+  UniquingLock lock(ctx);
   auto known = ctx.Impl.GenericParamTypes.find({ depth, index });
   if (known != ctx.Impl.GenericParamTypes.end())
     return known->second;
@@ -2982,6 +3106,7 @@ SILFunctionType::SILFunctionType(GenericSignature *genericSig,
 
 CanSILBlockStorageType SILBlockStorageType::get(CanType captureType) {
   ASTContext &ctx = captureType->getASTContext();
+  UniquingLock lock(ctx);
   auto found = ctx.Impl.SILBlockStorageTypes.find(captureType);
   if (found != ctx.Impl.SILBlockStorageTypes.end())
     return CanSILBlockStorageType(found->second);
@@ -2996,6 +3121,7 @@ CanSILBlockStorageType SILBlockStorageType::get(CanType captureType) {
 
 CanSILBoxType SILBoxType::get(CanType boxType) {
   ASTContext &ctx = boxType->getASTContext();
+  UniquingLock lock(ctx);
   auto found = ctx.Impl.SILBoxTypes.find(boxType);
   if (found != ctx.Impl.SILBoxTypes.end())
     return CanSILBoxType(found->second);
@@ -3021,6 +3147,7 @@ CanSILFunctionType SILFunctionType::get(GenericSignature *genericSig,
 
   // Do we already have this generic function type?
   void *insertPos;
+  UniquingLock lock(ctx);
   if (auto result
         = ctx.Impl.SILFunctionTypes.FindNodeOrInsertPos(id, insertPos))
     return CanSILFunctionType(result);
@@ -3074,6 +3201,7 @@ ArraySliceType *ArraySliceType::get(Type base) {
 
   const ASTContext &C = base->getASTContext();
 
+  UniquingLock lock(C);
   ArraySliceType *&entry = C.Impl.getArena(arena).ArraySliceTypes[base];
   if (entry) return entry;
 
@@ -3087,6 +3215,7 @@ DictionaryType *DictionaryType::get(Type keyType, Type valueType) {
 
   const ASTContext &C = keyType->getASTContext();
 
+  UniquingLock lock(C);
   DictionaryType *&entry
     = C.Impl.getArena(arena).DictionaryTypes[{keyType, valueType}];
   if (entry) return entry;
@@ -3112,6 +3241,7 @@ OptionalType *OptionalType::get(Type base) {
 
   const ASTContext &C = base->getASTContext();
 
+  UniquingLock lock(C);
   OptionalType *&entry = C.Impl.getArena(arena).OptionalTypes[base];
   if (entry) return entry;
 
@@ -3124,6 +3254,7 @@ ImplicitlyUnwrappedOptionalType *ImplicitlyUnwrappedOptionalType::get(Type base)
 
   const ASTContext &C = base->getASTContext();
 
+  UniquingLock lock(C);
   auto *&entry = C.Impl.getArena(arena).ImplicitlyUnwrappedOptionalTypes[base];
   if (entry) return entry;
 
@@ -3154,6 +3285,7 @@ LValueType *LValueType::get(Type objectTy) {
   auto arena = getArena(properties);
 
   auto &C = objectTy->getASTContext();
+  UniquingLock lock(C);
   auto &entry = C.Impl.getArena(arena).LValueTypes[objectTy];
   if (entry)
     return entry;
@@ -3176,6 +3308,7 @@ InOutType *InOutType::get(Type objectTy) {
   auto arena = getArena(properties);
 
   auto &C = objectTy->getASTContext();
+  UniquingLock lock(C);
   auto &entry = C.Impl.getArena(arena).InOutTypes[objectTy];
   if (entry)
     return entry;
@@ -3191,6 +3324,7 @@ SubstitutedType *SubstitutedType::get(Type Original, Type Replacement,
   auto properties = Replacement->getRecursiveProperties();
   auto arena = getArena(properties);
 
+  UniquingLock lock(C);
   SubstitutedType *&Known
     = C.Impl.getArena(arena).SubstitutedTypes[{Original, Replacement}];
   if (!Known) {
@@ -3207,6 +3341,7 @@ DependentMemberType *DependentMemberType::get(Type base, Identifier name,
   auto arena = getArena(properties);
 
   llvm::PointerUnion<Identifier, AssociatedTypeDecl *> stored(name);
+  UniquingLock lock(ctx);
   auto *&known = ctx.Impl.getArena(arena).DependentMemberTypes[
                                             {base, stored.getOpaqueValue()}];
   if (!known) {
@@ -3225,6 +3360,7 @@ DependentMemberType *DependentMemberType::get(Type base,
   auto arena = getArena(properties);
 
   llvm::PointerUnion<Identifier, AssociatedTypeDecl *> stored(assocType);
+  UniquingLock lock(ctx);
   auto *&known = ctx.Impl.getArena(arena).DependentMemberTypes[
                                             {base, stored.getOpaqueValue()}];
   if (!known) {
@@ -3238,6 +3374,7 @@ DependentMemberType *DependentMemberType::get(Type base,
 CanArchetypeType ArchetypeType::getOpened(Type existential,
                                         Optional<UUID> knownID) {
   auto &ctx = existential->getASTContext();
+  UniquingLock lock(ctx);
   auto &openedExistentialArchetypes = ctx.Impl.OpenedExistentialArchetypes;
   // If we know the ID already...
   if (knownID) {
@@ -3364,6 +3501,7 @@ GenericSignature *GenericSignature::get(ArrayRef<GenericTypeParamType *> params,
 
   auto &ctx = getASTContext(params, requirements);
   void *insertPos;
+  UniquingLock lock(ctx);
   if (auto *sig = ctx.Impl.GenericSignatures.FindNodeOrInsertPos(ID,
                                                                  insertPos)) {
     if (isKnownCanonical)
@@ -3403,6 +3541,7 @@ DeclName::DeclName(ASTContext &C, Identifier baseName,
   CompoundDeclName::Profile(id, baseName, argumentNames);
 
   void *insert = nullptr;
+  UniquingLock lock(C);
   if (CompoundDeclName *compoundName
         = C.Impl.CompoundNames.FindNodeOrInsertPos(id, insert)) {
     SimpleOrCompound = compoundName;
@@ -397,6 +397,8 @@ void ConformanceLookupTable::loadAllConformances(
   if (dc->getParentSourceFile())
     return;
 
+  DeserializedContexts.insert(dc);
+
   // Add entries for each loaded conformance.
   for (auto conformance : conformances) {
     registerProtocolConformance(conformance);
@@ -487,6 +489,11 @@ void ConformanceLookupTable::addProtocols(NominalTypeDecl *nominal,
 void ConformanceLookupTable::expandImpliedConformances(NominalTypeDecl *nominal,
                                                        DeclContext *dc, 
                                                        LazyResolver *resolver) {
+  // The conformances of a serialized context were written out after
+  // expansion, so they already include everything they imply.
+  if (DeserializedContexts.count(dc))
+    return;
+
   // Note: recursive type-checking implies that that AllConformances
   // may be reallocated during this traversal, so pay the lookup cost
   // during each iteration.
@@ -831,6 +838,7 @@ ProtocolConformance *ConformanceLookupTable::getConformance(
 
 void ConformanceLookupTable::addSynthesizedConformance(NominalTypeDecl *nominal,
                                                        ProtocolDecl *protocol) {
+  HasPrecomputedConformances = false;
   addProtocol(nominal, protocol, nominal->getLoc(),
               ConformanceSource::forSynthesized(nominal));
 }
@@ -840,6 +848,7 @@ void ConformanceLookupTable::registerProtocolConformance(
   auto protocol = conformance->getProtocol();
   auto dc = conformance->getDeclContext();
   auto nominal = dc->isNominalTypeOrNominalTypeExtensionContext();
+  HasPrecomputedConformances = false;
 
   // If there is an entry to update, do so.
   auto &dcConformances = AllConformances[dc];
@@ -873,12 +882,106 @@ void ConformanceLookupTable::registerProtocolConformance(
   dcConformances.push_back(entry);
 }
 
+bool ConformanceLookupTable::updatePrecomputedConformances(
+       NominalTypeDecl *nominal,
+       LazyResolver *resolver) {
+  if (PrecomputationDisabled)
+    return false;
+
+  // Only types that come entirely from serialized modules have a fixed set
+  // of conformances; anything from source can still change as it is
+  // type-checked.
+  if (isa<ProtocolDecl>(nominal) || nominal->getParentSourceFile()) {
+    PrecomputationDisabled = true;
+    return false;
+  }
+
+  // Classes inherit the conformances of their superclass, so the
+  // superclass must be precomputed as well.
+  ConformanceLookupTable *superclassTable = nullptr;
+  if (auto classDecl = dyn_cast<ClassDecl>(nominal)) {
+    if (Type superclass = classDecl->getSuperclass()) {
+      if (auto superclassDecl = superclass->getClassOrBoundGenericClass()) {
+        if (VisitingSuperclass)
+          return false;
+        llvm::SaveAndRestore<bool> visiting(VisitingSuperclass, true);
+
+        superclassDecl->prepareConformanceTable();
+        superclassTable = superclassDecl->ConformanceTable;
+        if (!superclassTable->updatePrecomputedConformances(superclassDecl,
+                                                            resolver)) {
+          if (superclassTable->PrecomputationDisabled)
+            PrecomputationDisabled = true;
+          return false;
+        }
+      }
+    }
+  }
+
+  // If nothing has changed since the last time, we're done.
+  nominal->prepareExtensions();
+  if (HasPrecomputedConformances &&
+      PrecomputedLastExtension == nominal->LastExtension &&
+      (!superclassTable ||
+       PrecomputedSuperclassGeneration
+         == superclassTable->PrecomputedGeneration))
+    return true;
+
+  for (auto ext = PrecomputedLastExtension
+                    ? PrecomputedLastExtension->NextExtension.getPointer()
+                    : nominal->FirstExtension;
+       ext; ext = ext->NextExtension.getPointer()) {
+    if (ext->getParentSourceFile()) {
+      PrecomputationDisabled = true;
+      return false;
+    }
+  }
+
+  // Resolve the complete table, then record the conformances for each
+  // protocol.
+  updateLookupTable(nominal, ConformanceStage::Resolved, resolver);
+
+  SmallVector<ProtocolDecl *, 8> protocols;
+  for (const auto &entry : Conformances)
+    protocols.push_back(entry.first);
+
+  PrecomputedConformances.clear();
+  for (auto protocol : protocols) {
+    resolveConformances(nominal, protocol, resolver);
+
+    llvm::TinyPtrVector<ProtocolConformance *> resolved;
+    for (auto entry : Conformances[protocol]) {
+      if (auto conformance = getConformance(nominal, resolver, entry))
+        resolved.push_back(conformance);
+    }
+    if (!resolved.empty())
+      PrecomputedConformances[protocol] = std::move(resolved);
+  }
+
+  PrecomputedLastExtension = nominal->LastExtension;
+  if (superclassTable)
+    PrecomputedSuperclassGeneration = superclassTable->PrecomputedGeneration;
+  ++PrecomputedGeneration;
+  HasPrecomputedConformances = true;
+  return true;
+}
+
 bool ConformanceLookupTable::lookupConformance(
        Module *module, 
        NominalTypeDecl *nominal,
        ProtocolDecl *protocol, 
        LazyResolver *resolver,
        SmallVectorImpl<ProtocolConformance *> &conformances) {
+  // Types from serialized modules can answer from the precomputed table.
+  if (updatePrecomputedConformances(nominal, resolver)) {
+    auto known = PrecomputedConformances.find(protocol);
+    if (known == PrecomputedConformances.end())
+      return false;
+
+    conformances.append(known->second.begin(), known->second.end());
+    return true;
+  }
+
   // Update to record all explicit and inherited conformances.
   updateLookupTable(nominal, ConformanceStage::Inherited, resolver);
 
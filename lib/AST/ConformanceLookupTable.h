@@ -24,9 +24,12 @@
 #include "swift/AST/TypeLoc.h"
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
 
@@ -320,6 +323,40 @@ class ConformanceLookupTable {
   /// Indicates whether we are visiting the superclass.
   bool VisitingSuperclass = false;
 
+  /// The declaration contexts whose conformances were loaded from a
+  /// serialized module.
+  ///
+  /// Serialized conformance lists are already resolved and closed under
+  /// implication, so there is no need to expand them again.
+  llvm::SmallPtrSet<DeclContext *, 4> DeserializedContexts;
+
+  /// The complete, resolved set of conformances for each protocol, computed
+  /// in bulk for nominal types that come entirely from serialized modules.
+  ///
+  /// This lets \c lookupConformance answer with a single lookup rather than
+  /// walking the conformance stages, superclasses, and extensions.
+  llvm::DenseMap<ProtocolDecl *, llvm::TinyPtrVector<ProtocolConformance *>>
+    PrecomputedConformances;
+
+  /// The last extension that was accounted for in
+  /// \c PrecomputedConformances.
+  ExtensionDecl *PrecomputedLastExtension = nullptr;
+
+  /// Incremented each time \c PrecomputedConformances is rebuilt, so that
+  /// subclasses can tell when the conformances they inherit have changed.
+  unsigned PrecomputedGeneration = 0;
+
+  /// The value of the superclass's \c PrecomputedGeneration when
+  /// \c PrecomputedConformances was built.
+  unsigned PrecomputedSuperclassGeneration = 0;
+
+  /// Whether \c PrecomputedConformances is up to date.
+  bool HasPrecomputedConformances = false;
+
+  /// Whether this table can never use precomputed conformances, because
+  /// the nominal type or one of its extensions comes from source.
+  bool PrecomputationDisabled = false;
+
   /// Add a protocol.
   bool addProtocol(NominalTypeDecl *nominal,
                    ProtocolDecl *protocol, SourceLoc loc,
@@ -416,6 +453,15 @@ class ConformanceLookupTable {
                            DeclContext *dc,
                            ArrayRef<ProtocolConformance *> conformances);
 
+  /// Make sure \c PrecomputedConformances is up to date, building it if
+  /// necessary.
+  ///
+  /// \returns false if the nominal type cannot use precomputed
+  /// conformances, in which case clients must go through the conformance
+  /// stages.
+  bool updatePrecomputedConformances(NominalTypeDecl *nominal,
+                                     LazyResolver *resolver);
+
 public:
   /// Create a new conformance lookup table.
   ConformanceLookupTable(ASTContext &ctx, NominalTypeDecl *nominal,
@@ -1900,11 +1900,12 @@ bool NominalTypeDecl::derivesProtocolConformance(ProtocolDecl *protocol) const {
     case KnownProtocolKind::RawRepresentable:
       return enumDecl->hasRawType();
     
-    // Enums without associated values can implicitly derive Equatable and
-    // Hashable conformance.
+    // Enums can derive Equatable and Hashable conformance: implicitly if they
+    // have no associated values, and explicitly if the associated values
+    // conform.
     case KnownProtocolKind::Equatable:
     case KnownProtocolKind::Hashable:
-      return enumDecl->hasOnlyCasesWithoutAssociatedValues();
+      return true;
     
     // @objc enums can explicitly derive their _BridgedNSError conformance.
     case KnownProtocolKind::BridgedNSError:
@@ -1914,6 +1915,19 @@ bool NominalTypeDecl::derivesProtocolConformance(ProtocolDecl *protocol) const {
       return false;
     }
   }
+
+  // Structs can explicitly derive Equatable and Hashable conformance if their
+  // stored properties conform.
+  if (isa<StructDecl>(this)) {
+    switch (*knownProtocol) {
+    case KnownProtocolKind::Equatable:
+    case KnownProtocolKind::Hashable:
+      return true;
+
+    default:
+      return false;
+    }
+  }
   return false;
 }
 
@@ -495,6 +495,12 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &diagnostic) {
     break;
   }
 
+  // Engines used for speculative type checking have no consumers and see
+  // many diagnostics. Don't pretty-print declarations or format text that
+  // nobody will read.
+  if (Consumers.empty())
+    return;
+
   // Figure out the source location.
   SourceLoc loc = diagnostic.getLoc();
   if (loc.isInvalid() && diagnostic.getDecl()) {
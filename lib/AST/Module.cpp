@@ -355,6 +355,7 @@ void Module::addFile(FileUnit &newFile) {
          cast<SourceFile>(newFile).Kind == SourceFileKind::Library ||
          cast<SourceFile>(newFile).Kind == SourceFileKind::SIL);
   Files.push_back(&newFile);
+  ++getASTContext().ModuleContentsGeneration;
 
   switch (newFile.getKind()) {
   case FileUnitKind::Source:
@@ -389,6 +390,15 @@ void Module::removeFile(FileUnit &existingFile) {
   Files.erase(I.base());
 }
 
+Module::ReexportLookupCacheTy &Module::getReexportLookupCache() {
+  unsigned generation = getASTContext().ModuleContentsGeneration;
+  if (ReexportLookupCacheGeneration != generation) {
+    ReexportLookupCache.clear();
+    ReexportLookupCacheGeneration = generation;
+  }
+  return ReexportLookupCache;
+}
+
 DerivedFileUnit &Module::getDerivedFileUnit() const {
   for (auto File : Files) {
     if (auto DFU = dyn_cast<DerivedFileUnit>(File))
@@ -529,6 +539,11 @@ DerivedFileUnit::DerivedFileUnit(Module &M)
   M.getASTContext().addDestructorCleanup(*this);
 }
 
+void DerivedFileUnit::addDerivedDecl(FuncDecl *FD) {
+  DerivedDecls.push_back(FD);
+  ++getASTContext().ModuleContentsGeneration;
+}
+
 void DerivedFileUnit::lookupValue(Module::AccessPathTy accessPath,
                                   DeclName name,
                                   NLKind lookupKind,
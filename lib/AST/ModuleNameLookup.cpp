@@ -137,8 +137,35 @@ static ResolutionKind recordImportDecls(LazyResolver *typeResolver,
   llvm_unreachable("bad ResolutionKind");
 }
 
+/// Returns true if the results of looking up a name in \p module do not
+/// depend on which file the lookup came from, and so can be kept in the
+/// module's re-export lookup cache.
+static bool canUseReexportLookupCache(const Module *module,
+                                      const DeclContext *moduleScopeContext) {
+  // The contents of source files change while they are type-checked.
+  for (auto file : module->getFiles())
+    if (isa<SourceFile>(file))
+      return false;
+
+  // Past the first level of imports, only public declarations are visible.
+  if (!moduleScopeContext)
+    return true;
+
+  // Otherwise, internal declarations are visible to files that import the
+  // module with @testable.
+  if (moduleScopeContext->getParentModule() == module)
+    return false;
+  if (auto SF = dyn_cast<SourceFile>(moduleScopeContext))
+    return !SF->hasTestableImport(module);
+  return true;
+}
+
 /// Performs a qualified lookup into the given module and, if necessary, its
 /// reexports, observing proper shadowing rules.
+///
+/// If \p name is non-null, it is the name being looked up with
+/// \p lookupKind, and results may be shared with other lookups of the same
+/// name through Module::getReexportLookupCache.
 template <typename OverloadSetTy, typename CallbackTy>
 static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
                            SmallVectorImpl<ValueDecl *> &decls,
@@ -148,6 +175,7 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
                            const DeclContext *moduleScopeContext,
                            bool respectAccessControl,
                            ArrayRef<Module::ImportedModule> extraImports,
+                           const DeclName *name, NLKind lookupKind,
                            CallbackTy callback) {
   assert(module);
   assert(std::none_of(extraImports.begin(), extraImports.end(),
@@ -163,6 +191,23 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
     return;
   }
 
+  // Without a type resolver, declarations whose signatures haven't been
+  // resolved yet are kept, so the results aren't stable enough to share.
+  Module::ReexportLookupCacheTy *reexportCache = nullptr;
+  std::pair<DeclName, unsigned> reexportKey;
+  if (name && accessPath.empty() && extraImports.empty() && typeResolver &&
+      canUseReexportLookupCache(module, moduleScopeContext)) {
+    reexportCache = &module->getReexportLookupCache();
+    reexportKey = { *name, (unsigned(resolutionKind) << 1) |
+                           unsigned(lookupKind) };
+    auto known = reexportCache->find(reexportKey);
+    if (known != reexportCache->end()) {
+      iter->second = known->second;
+      decls.append(known->second.begin(), known->second.end());
+      return;
+    }
+  }
+
   size_t initialCount = decls.size();
 
   SmallVector<ValueDecl *, 4> localDecls;
@@ -222,7 +267,8 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
       lookupInModule<OverloadSetTy>(next.second, combinedAccessPath,
                                     resultSet, resolutionKind, canReturnEarly,
                                     typeResolver, cache, moduleScopeContext,
-                                    respectAccessControl, {}, callback);
+                                    respectAccessControl, {}, name,
+                                    lookupKind, callback);
     }
 
     // Add the results from scoped imports.
@@ -250,6 +296,8 @@ static void lookupInModule(Module *module, Module::AccessPathTy accessPath,
   cachedValues.insert(cachedValues.end(),
                       decls.begin() + initialCount,
                       decls.end());
+  if (reexportCache)
+    (*reexportCache)[reexportKey] = cachedValues;
 }
 
 void namelookup::lookupInModule(Module *startModule,
@@ -269,6 +317,7 @@ void namelookup::lookupInModule(Module *startModule,
                                resolutionKind, /*canReturnEarly=*/true,
                                typeResolver, cache, moduleScopeContext,
                                respectAccessControl, extraImports,
+                               &name, lookupKind,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       module->lookupValue(path, name, lookupKind, localDecls);
@@ -292,6 +341,7 @@ void namelookup::lookupVisibleDeclsInModule(
                                     resolutionKind, /*canReturnEarly=*/false,
                                     typeResolver, cache, moduleScopeContext,
                                     respectAccessControl, extraImports,
+                                    /*name=*/nullptr, lookupKind,
     [=](Module *module, Module::AccessPathTy path,
         SmallVectorImpl<ValueDecl *> &localDecls) {
       VectorDeclConsumer consumer(localDecls);
@@ -25,10 +25,18 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
 
+#define DEBUG_TYPE "Name lookup"
+
+STATISTIC(NumMemberLookupsByName,
+          "# of member lookups that loaded only the named members");
+STATISTIC(NumMemberLookupsByNameReused,
+          "# of member lookups by name that reused previously loaded members");
+
 void DebuggerClient::anchor() {}
 
 void AccessFilteringDeclConsumer::foundDecl(ValueDecl *D,
@@ -688,6 +696,11 @@ class swift::MemberLookupTable {
   /// Lookup table mapping names to the set of declarations with that name.
   LookupTable Lookup;
 
+  /// The base names whose members have been loaded by name, without loading
+  /// the complete member lists, mapped to the last extension that was
+  /// searched for them (or null if only the nominal type was searched).
+  llvm::DenseMap<Identifier, ExtensionDecl *> NamesLoaded;
+
 public:
   /// Create a new member lookup table.
   explicit MemberLookupTable(ASTContext &ctx);
@@ -720,6 +733,25 @@ public:
     return Lookup.find(name);
   }
 
+  /// Determine whether the members with the given base name have been
+  /// loaded by name.
+  ///
+  /// \param lastExtension If the name has been loaded, set to the last
+  /// extension that was searched for it.
+  bool isNameLoaded(Identifier baseName, ExtensionDecl *&lastExtension) const {
+    auto known = NamesLoaded.find(baseName);
+    if (known == NamesLoaded.end())
+      return false;
+    lastExtension = known->second;
+    return true;
+  }
+
+  /// Note that the members with the given base name have been loaded from
+  /// the nominal type and from its extensions up to \p lastExtension.
+  void noteNameLoaded(Identifier baseName, ExtensionDecl *lastExtension) {
+    NamesLoaded[baseName] = lastExtension;
+  }
+
   // Only allow allocation of member lookup tables using the allocator in
   // ASTContext or by doing a placement new.
   void *operator new(size_t Bytes, ASTContext &C,
@@ -923,8 +955,76 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
   LookupTable.getPointer()->addMember(member);
 }
 
+/// Loads the members of \p IDC with the given base name into \p table,
+/// without loading its other members.
+///
+/// \returns false if \p IDC's loader can't look up members by name.
+static bool loadNamedMembersIntoTable(MemberLookupTable &table,
+                                      const IterableDeclContext *IDC,
+                                      const Decl *container,
+                                      Identifier baseName) {
+  if (!IDC->isLazy()) {
+    table.addMembers(IDC->getMembers());
+    return true;
+  }
+
+  SmallVector<ValueDecl *, 4> members;
+  if (!IDC->getLoader()->loadNamedMembers(container, baseName,
+                                          IDC->getLoaderContextData(),
+                                          members))
+    return false;
+
+  for (auto member : members)
+    table.addMember(member);
+  return true;
+}
+
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
+  // If this type's members haven't been loaded yet, try to load just the
+  // members with this name, from the type and from its extensions. Protocols
+  // and types with delayed members are always loaded completely.
+  if (!LookupTable.getInt() && hasLazyMembers() &&
+      !hasDelayedMemberDecls() && !isa<ProtocolDecl>(this)) {
+    if (!LookupTable.getPointer()) {
+      auto &ctx = getASTContext();
+      LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
+    }
+    auto &table = *LookupTable.getPointer();
+    Identifier baseName = name.getBaseName();
+
+    // If we have already loaded this name, only the extensions added since
+    // then need to be searched.
+    ExtensionDecl *lastExtension = nullptr;
+    bool loadedByName = table.isNameLoaded(baseName, lastExtension);
+    if (loadedByName)
+      ++NumMemberLookupsByNameReused;
+    else
+      loadedByName = loadNamedMembersIntoTable(table, this, this, baseName);
+
+    if (loadedByName && !ignoreNewExtensions) {
+      prepareExtensions();
+      for (auto E = lastExtension ? lastExtension->NextExtension.getPointer()
+                                  : FirstExtension;
+           E; E = E->NextExtension.getPointer()) {
+        if (!loadNamedMembersIntoTable(table, E, E, baseName)) {
+          loadedByName = false;
+          break;
+        }
+        lastExtension = E;
+      }
+    }
+
+    if (loadedByName) {
+      table.noteNameLoaded(baseName, lastExtension);
+      ++NumMemberLookupsByName;
+      auto known = table.find(name);
+      if (known == table.end())
+        return { };
+      return { known->second.begin(), known->second.size() };
+    }
+  }
+
   // Make sure we have the complete list of members (in this nominal and in all
   // extensions).
   if (!ignoreNewExtensions) {
@@ -164,3 +164,32 @@ found_conformance:;
 
   return Substitution{Archetype, substReplacement, substConformanceRef};
 }
+
+SubstitutionMap::SubstitutionMap(Module *module, GenericParamList *context,
+                                 ArrayRef<Substitution> subs)
+  : Module(module), Subs(subs) {
+  getSubstitutionMaps(context, subs, TypeMap, ConformanceMap);
+}
+
+Type SubstitutionMap::subst(Type type) {
+  auto known = SubstitutedTypes.find(type.getPointer());
+  if (known != SubstitutedTypes.end())
+    return known->second;
+
+  Type substType = type.subst(Module, TypeMap, None);
+  SubstitutedTypes.insert({type.getPointer(), substType});
+  return substType;
+}
+
+Substitution SubstitutionMap::subst(const Substitution &sub) {
+  auto key = std::make_pair(sub.getArchetype(),
+                            sub.getReplacement().getPointer());
+  auto known = SubstitutedSubstitutions.find(key);
+  if (known != SubstitutedSubstitutions.end() &&
+      known->second.first.equals(sub.getConformances()))
+    return known->second.second;
+
+  Substitution substSub = sub.subst(Module, Subs, TypeMap, ConformanceMap);
+  SubstitutedSubstitutions[key] = {sub.getConformances(), substSub};
+  return substSub;
+}
@@ -25,6 +25,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 using namespace swift;
@@ -2859,7 +2860,23 @@ struct ASTNodeBase {};
 void swift::verify(SourceFile &SF) {
 #if !(defined(NDEBUG) || defined(SWIFT_DISABLE_AST_VERIFIER))
   Verifier verifier(SF, &SF);
-  SF.walk(verifier);
+  unsigned SamplePercent = SF.getASTContext().LangOpts.ASTVerifierSamplePercent;
+  if (SamplePercent >= 100) {
+    SF.walk(verifier);
+    return;
+  }
+
+  // Verify a deterministic sample of the top-level declarations, chosen by
+  // their position in the file.
+  llvm::SaveAndRestore<ASTWalker::ParentTy> SAR(verifier.Parent,
+                                                SF.getParentModule());
+  for (unsigned i = 0, e = SF.Decls.size(); i != e; ++i) {
+    size_t Hash = llvm::hash_combine(SF.getFilename(), i);
+    if (Hash % 100 >= SamplePercent)
+      continue;
+    if (SF.Decls[i]->walk(verifier))
+      return;
+  }
 #endif
 }
 
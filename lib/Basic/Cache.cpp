@@ -14,12 +14,22 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation. The entries are
+//  split into shards by key hash, each with its own lock and LRU list. When
+//  the total cost of the values exceeds the cache's cost limit, or the system
+//  runs low on memory, the least recently used entries are evicted.
 
 #include "swift/Basic/Cache.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Mutex.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <unistd.h>
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -32,14 +42,6 @@ struct DefaultCacheKey {
   //DefaultCacheKey() = default;
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
-
-struct DefaultCache {
-  llvm::sys::Mutex Mux;
-  CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
-
-  explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
-};
 } // end anonymous namespace
 
 namespace llvm {
@@ -67,71 +69,280 @@ template<> struct DenseMapInfo<DefaultCacheKey> {
 };
 }
 
+namespace {
+enum { NumShards = 16 };
+
+struct CacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+  /// The value of the cache's clock when the entry was last used.
+  uint64_t LastUse;
+};
+
+/// The entries whose keys hash to the shard, most recently used first.
+struct KeyShard {
+  llvm::sys::Mutex Mux;
+  std::list<CacheEntry> LRU;
+  llvm::DenseMap<DefaultCacheKey, std::list<CacheEntry>::iterator> Entries;
+};
+
+/// Tracks the retains of values, which may outlive their entries.
+struct ValueRecord {
+  unsigned RetainCount = 0;
+  bool InCache = false;
+};
+
+/// The values whose addresses hash to the shard.
+struct ValueShard {
+  llvm::sys::Mutex Mux;
+  llvm::DenseMap<void *, ValueRecord> Values;
+};
+
+/// Returns the memory the system can still hand out without swapping, or 0 if
+/// unknown.
+static size_t getAvailableMemory() {
+#if defined(__linux__)
+  FILE *MemInfo = fopen("/proc/meminfo", "r");
+  if (!MemInfo)
+    return 0;
+  char Line[128];
+  unsigned long long KiloBytes = 0;
+  while (fgets(Line, sizeof(Line), MemInfo))
+    if (sscanf(Line, "MemAvailable: %llu kB", &KiloBytes) == 1)
+      break;
+  fclose(MemInfo);
+  return size_t(KiloBytes * 1024);
+#else
+  return 0;
+#endif
+}
+
+/// Returns the physical memory of the system, or 0 if unknown.
+static size_t getPhysicalMemory() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  long Pages = sysconf(_SC_PHYS_PAGES);
+  long PageSize = sysconf(_SC_PAGESIZE);
+  if (Pages > 0 && PageSize > 0)
+    return size_t(Pages) * size_t(PageSize);
+#endif
+  return 0;
+}
+
+struct DefaultCache {
+  CacheImpl::CallBacks CBs;
+  KeyShard KeyShards[NumShards];
+  ValueShard ValueShards[NumShards];
+
+  /// The sum of the costs of the values in the cache.
+  std::atomic<size_t> TotalCost{0};
+
+  /// The total cost above which entries are evicted.
+  std::atomic<size_t> CostLimit;
+
+  /// Counts insertions, to check for memory pressure periodically.
+  std::atomic<unsigned> NumInsertions{0};
+
+  /// Orders the uses of entries across shards.
+  std::atomic<uint64_t> Clock{0};
+
+  explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) {
+    // By default a cache may use a quarter of the physical memory.
+    size_t PhysicalMemory = getPhysicalMemory();
+    CostLimit = PhysicalMemory ? PhysicalMemory / 4 : SIZE_MAX;
+  }
+
+  KeyShard &getKeyShard(const DefaultCacheKey &Key) {
+    unsigned Hash = llvm::DenseMapInfo<DefaultCacheKey>::getHashValue(Key);
+    return KeyShards[Hash % NumShards];
+  }
+
+  ValueShard &getValueShard(void *Value) {
+    unsigned Hash = llvm::DenseMapInfo<void *>::getHashValue(Value);
+    return ValueShards[Hash % NumShards];
+  }
+
+  /// Drops the cache's reference to \p Value. Returns true if the value must
+  /// be destroyed, because it isn't retained either.
+  bool removeValue(void *Value) {
+    ValueShard &VS = getValueShard(Value);
+    llvm::sys::ScopedLock L(VS.Mux);
+    auto Record = VS.Values.find(Value);
+    assert(Record != VS.Values.end() && Record->second.InCache);
+    if (Record->second.RetainCount != 0) {
+      Record->second.InCache = false;
+      return false;
+    }
+    VS.Values.erase(Record);
+    return true;
+  }
+
+  /// Removes the entry \p I from \p KS, which must be locked. Adds its value
+  /// to \p Destroyed if it must be destroyed once the lock is dropped.
+  void removeEntry(KeyShard &KS, std::list<CacheEntry>::iterator I,
+                   llvm::SmallVectorImpl<void *> &Destroyed) {
+    KS.Entries.erase(DefaultCacheKey(I->Key, &CBs));
+    CBs.keyDestroyCB(I->Key, nullptr);
+    if (removeValue(I->Value))
+      Destroyed.push_back(I->Value);
+    TotalCost -= I->Cost;
+    KS.LRU.erase(I);
+  }
+
+  void destroyValues(llvm::ArrayRef<void *> Destroyed) {
+    for (void *Value : Destroyed)
+      CBs.valueDestroyCB(Value, nullptr);
+  }
+
+  /// Evicts least recently used entries until the total cost is at most
+  /// \p Limit. Must be called with no shard locked.
+  void evictDownTo(size_t Limit) {
+    llvm::SmallVector<void *, 8> Destroyed;
+    while (TotalCost > Limit) {
+      // The least recently used entry of the cache is the least recently used
+      // entry of one of the shards.
+      KeyShard *Oldest = nullptr;
+      uint64_t OldestUse = UINT64_MAX;
+      for (KeyShard &KS : KeyShards) {
+        llvm::sys::ScopedLock L(KS.Mux);
+        if (!KS.LRU.empty() && KS.LRU.back().LastUse < OldestUse) {
+          Oldest = &KS;
+          OldestUse = KS.LRU.back().LastUse;
+        }
+      }
+      if (!Oldest)
+        break;
+
+      // Another thread may have used or removed the entry in the meantime;
+      // then this evicts whatever is least recently used in the shard now.
+      llvm::sys::ScopedLock L(Oldest->Mux);
+      if (!Oldest->LRU.empty())
+        removeEntry(*Oldest, std::prev(Oldest->LRU.end()), Destroyed);
+    }
+    destroyValues(Destroyed);
+  }
+
+  /// Evicts entries if the cache is over its limit, or if the system is
+  /// running low on memory.
+  void evictIfNeeded() {
+    size_t Limit = CostLimit;
+    // Checking for memory pressure reads /proc, so only do it every so often.
+    if ((++NumInsertions % 64) == 0) {
+      size_t Available = getAvailableMemory();
+      size_t Physical = getPhysicalMemory();
+      if (Available && Physical && Available < Physical / 20)
+        Limit = std::min(Limit, TotalCost / 2);
+    }
+    if (TotalCost > Limit)
+      evictDownTo(Limit);
+  }
+};
+} // end anonymous namespace
+
 CacheImpl::ImplTy CacheImpl::create(StringRef Name, const CallBacks &CBs) {
   return new DefaultCache(CBs);
 }
 
 void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
+  llvm::SmallVector<void *, 1> Destroyed;
+  {
+    DefaultCacheKey CKey(Key, &DCache.CBs);
+    KeyShard &KS = DCache.getKeyShard(CKey);
+    llvm::sys::ScopedLock L(KS.Mux);
 
-  DefaultCacheKey CKey(Key, &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
+    auto Entry = KS.Entries.find(CKey);
+    if (Entry != KS.Entries.end())
+      DCache.removeEntry(KS, Entry->second, Destroyed);
 
-  DCache.Entries[CKey] = Value;
+    {
+      ValueShard &VS = DCache.getValueShard(Value);
+      llvm::sys::ScopedLock VL(VS.Mux);
+      ValueRecord &Record = VS.Values[Value];
+      ++Record.RetainCount;
+      Record.InCache = true;
+    }
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+    KS.LRU.push_front({ Key, Value, Cost, ++DCache.Clock });
+    KS.Entries[CKey] = KS.LRU.begin();
+    DCache.TotalCost += Cost;
+  }
+  DCache.destroyValues(Destroyed);
+  DCache.evictIfNeeded();
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
-  }
-  return false;
+  KeyShard &KS = DCache.getKeyShard(CKey);
+  llvm::sys::ScopedLock L(KS.Mux);
+
+  auto Entry = KS.Entries.find(CKey);
+  if (Entry == KS.Entries.end())
+    return false;
+
+  // Mark the entry as the most recently used one.
+  Entry->second->LastUse = ++DCache.Clock;
+  KS.LRU.splice(KS.LRU.begin(), KS.LRU, Entry->second);
+
+  void *Value = Entry->second->Value;
+  ValueShard &VS = DCache.getValueShard(Value);
+  llvm::sys::ScopedLock VL(VS.Mux);
+  ++VS.Values[Value].RetainCount;
+  *Value_out = Value;
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  {
+    ValueShard &VS = DCache.getValueShard(Value);
+    llvm::sys::ScopedLock L(VS.Mux);
+    auto Record = VS.Values.find(Value);
+    assert(Record != VS.Values.end() && Record->second.RetainCount != 0 &&
+           "releasing a value that isn't retained");
+    if (--Record->second.RetainCount != 0 || Record->second.InCache)
+      return;
+    VS.Values.erase(Record);
+  }
+  // The value was removed from the cache while it was retained.
+  DCache.CBs.valueDestroyCB(Value, nullptr);
 }
 
 bool CacheImpl::remove(const void *Key) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
+  llvm::SmallVector<void *, 1> Destroyed;
+  {
+    DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
+    KeyShard &KS = DCache.getKeyShard(CKey);
+    llvm::sys::ScopedLock L(KS.Mux);
 
-  DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-    return true;
+    auto Entry = KS.Entries.find(CKey);
+    if (Entry == KS.Entries.end())
+      return false;
+    DCache.removeEntry(KS, Entry->second, Destroyed);
   }
-  return false;
+  DCache.destroyValues(Destroyed);
+  return true;
 }
 
 void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
-
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
+  llvm::SmallVector<void *, 8> Destroyed;
+  for (KeyShard &KS : DCache.KeyShards) {
+    llvm::sys::ScopedLock L(KS.Mux);
+    while (!KS.LRU.empty())
+      DCache.removeEntry(KS, KS.LRU.begin(), Destroyed);
   }
-  DCache.Entries.clear();
+  DCache.destroyValues(Destroyed);
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  DCache.CostLimit = Limit;
+  if (DCache.TotalCost > Limit)
+    DCache.evictDownTo(Limit);
 }
 
 void CacheImpl::destroy() {
@@ -22,15 +22,22 @@
 using namespace swift;
 
 ClusteredBitVector ClusteredBitVector::fromAPInt(const llvm::APInt &bits) {
-  // This is not a very efficient algorithm.
   ClusteredBitVector result;
-  for (unsigned i = 0, e = bits.getBitWidth(); i != e; ++i) {
-    if (bits[i]) {
-      result.appendSetBits(1);
-    } else {
-      result.appendClearBits(1);
-    }
+  auto numBits = bits.getBitWidth();
+  if (numBits == 0)
+    return result;
+
+  // Don't allocate for an all-clear vector.
+  if (bits.isMinValue()) {
+    result.appendClearBits(numBits);
+    return result;
   }
+
+  // Copy a word at a time.  This assumes that the chunk size is the same
+  // as APInt's, and relies on APInt keeping the unused high bits of its
+  // last word clear.
+  result.reserve(numBits);
+  result.appendReserved(numBits, bits.getRawData());
   return result;
 }
 
@@ -788,6 +788,18 @@ private:
         if (!result)
           return nullptr;
         param->addChild(result);
+      } else if (Mangled.nextIf("ex")) {
+        auto result = FUNCSIGSPEC_CREATE_PARAM_KIND(ExistentialToConcrete);
+        NodePointer type = demangleType();
+        if (!result || !type || !Mangled.nextIf('_'))
+          return nullptr;
+        param->addChild(result);
+        param->addChild(type);
+      } else if (Mangled.nextIf("ru_")) {
+        auto result = FUNCSIGSPEC_CREATE_PARAM_KIND(ReturnValueOwnedToUnowned);
+        if (!result)
+          return nullptr;
+        param->addChild(result);
       } else {
         // Otherwise handle option sets.
         unsigned Value = 0;
@@ -2635,6 +2647,7 @@ unsigned NodePrinter::printFunctionSigSpecializationParam(NodePointer pointer,
   auto K = FunctionSigSpecializationParamKind(V);
   switch (K) {
   case FunctionSigSpecializationParamKind::InOutToValue:
+  case FunctionSigSpecializationParamKind::ReturnValueOwnedToUnowned:
     print(pointer->getChild(Idx++));
     return Idx;
   case FunctionSigSpecializationParamKind::ConstantPropFunction:
@@ -2654,6 +2667,7 @@ unsigned NodePrinter::printFunctionSigSpecializationParam(NodePointer pointer,
   }
   case FunctionSigSpecializationParamKind::ConstantPropInteger:
   case FunctionSigSpecializationParamKind::ConstantPropFloat:
+  case FunctionSigSpecializationParamKind::ExistentialToConcrete:
     Printer << "[";
     print(pointer->getChild(Idx++));
     Printer << " : ";
@@ -3052,7 +3066,12 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
   case Node::Kind::FunctionSignatureSpecializationParam: {
     uint64_t argNum = pointer->getIndex();
 
-    Printer << "Arg[" << argNum << "] = ";
+    // The return value is encoded as a parameter following the arguments.
+    if (pointer->getChild(0)->getIndex() ==
+        unsigned(FunctionSigSpecializationParamKind::ReturnValueOwnedToUnowned))
+      Printer << "Return = ";
+    else
+      Printer << "Arg[" << argNum << "] = ";
 
     unsigned Idx = printFunctionSigSpecializationParam(pointer, 0);
 
@@ -3102,6 +3121,9 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
     case FunctionSigSpecializationParamKind::InOutToValue:
       Printer << "Value Promoted from InOut";
       break;
+    case FunctionSigSpecializationParamKind::ReturnValueOwnedToUnowned:
+      Printer << "Owned To Unowned";
+      break;
     case FunctionSigSpecializationParamKind::ConstantPropFunction:
       Printer << "Constant Propagated Function";
       break;
@@ -3120,6 +3142,9 @@ void NodePrinter::print(NodePointer pointer, bool asContext, bool suppressType)
     case FunctionSigSpecializationParamKind::ClosureProp:
       Printer << "Closure Propagated";
       break;
+    case FunctionSigSpecializationParamKind::ExistentialToConcrete:
+      Printer << "Existential To Concrete";
+      break;
     case FunctionSigSpecializationParamKind::Dead:
     case FunctionSigSpecializationParamKind::OwnedToGuaranteed:
     case FunctionSigSpecializationParamKind::SROA:
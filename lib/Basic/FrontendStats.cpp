@@ -0,0 +1,237 @@
+//===--- FrontendStats.cpp - Per-job compilation statistics ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/FrontendStats.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace swift;
+
+StringRef FrontendStats::getPhaseName(Phase P) {
+  switch (P) {
+  case Phase::Parse: return "parse";
+  case Phase::Import: return "import";
+  case Phase::Sema: return "sema";
+  case Phase::SILGen: return "silgen";
+  case Phase::SILOptimization: return "sil-optimization";
+  case Phase::IRGen: return "irgen";
+  case Phase::LLVM: return "llvm";
+  }
+  llvm_unreachable("Unhandled Phase in switch.");
+}
+
+StringRef FrontendStats::getMemoryCategoryName(MemoryCategory C) {
+  switch (C) {
+  case MemoryCategory::ASTContext: return "ast-context";
+  case MemoryCategory::ConstraintSolverPeak: return "constraint-solver-peak";
+  case MemoryCategory::SILModule: return "sil-module";
+  case MemoryCategory::SILTypeLowering: return "sil-type-lowering";
+  case MemoryCategory::ClangImporter: return "clang-importer";
+  case MemoryCategory::Clang: return "clang";
+  case MemoryCategory::SerializedModules: return "serialized-modules";
+  case MemoryCategory::Malloc: return "malloc";
+  }
+  llvm_unreachable("Unhandled MemoryCategory in switch.");
+}
+
+void FrontendStats::recordMemoryUsage(Phase P, const MemoryUsage &Usage) {
+  MemoryUsage &Recorded = PhaseMemory[unsigned(P)];
+  for (unsigned i = 0; i != NumMemoryCategories; ++i)
+    Recorded.Bytes[i] = std::max(Recorded.Bytes[i], Usage.Bytes[i]);
+}
+
+void FrontendStats::chargeActivePhase() {
+  llvm::sys::TimeValue Wall, User, System;
+  llvm::sys::Process::GetTimeUsage(Wall, User, System);
+  if (!ActivePhases.empty()) {
+    PhaseTime &Time = Phases[unsigned(ActivePhases.back())];
+    Time.WallUSec += (Wall - LastWall).usec();
+    Time.UserUSec += (User - LastUser).usec();
+    Time.SystemUSec += (System - LastSystem).usec();
+  }
+  LastWall = Wall;
+  LastUser = User;
+  LastSystem = System;
+}
+
+void FrontendStats::beginPhase(Phase P) {
+  chargeActivePhase();
+  ActivePhases.push_back(P);
+}
+
+void FrontendStats::endPhase() {
+  assert(!ActivePhases.empty() && "endPhase() without beginPhase()");
+  chargeActivePhase();
+  ActivePhases.pop_back();
+}
+
+void FrontendStats::add(const FrontendStats &Other) {
+  for (unsigned i = 0; i != NumPhases; ++i) {
+    Phases[i].WallUSec += Other.Phases[i].WallUSec;
+    Phases[i].UserUSec += Other.Phases[i].UserUSec;
+    Phases[i].SystemUSec += Other.Phases[i].SystemUSec;
+    recordMemoryUsage(Phase(i), Other.PhaseMemory[i]);
+  }
+  NumJobs += Other.NumJobs;
+  NumDeclsDeserialized += Other.NumDeclsDeserialized;
+  NumClangDeclsImported += Other.NumClangDeclsImported;
+  NumSILInstructions += Other.NumSILInstructions;
+  NumLLVMInstructions += Other.NumLLVMInstructions;
+}
+
+void FrontendStats::writeJSON(raw_ostream &os) const {
+  os << "{\n  \"phases\": {";
+  for (unsigned i = 0; i != NumPhases; ++i) {
+    const PhaseTime &Time = Phases[i];
+    os << (i ? ",\n" : "\n")
+       << "    \"" << getPhaseName(Phase(i)) << "\": {"
+       << "\"wall-usec\": " << Time.WallUSec << ", "
+       << "\"user-usec\": " << Time.UserUSec << ", "
+       << "\"system-usec\": " << Time.SystemUSec << "}";
+  }
+  os << "\n  },\n  \"counters\": {\n"
+     << "    \"jobs\": " << NumJobs << ",\n"
+     << "    \"decls-deserialized\": " << NumDeclsDeserialized << ",\n"
+     << "    \"clang-decls-imported\": " << NumClangDeclsImported << ",\n"
+     << "    \"sil-instructions\": " << NumSILInstructions << ",\n"
+     << "    \"llvm-instructions\": " << NumLLVMInstructions << "\n"
+     << "  },\n  \"memory\": {";
+  for (unsigned i = 0; i != NumPhases; ++i) {
+    os << (i ? ",\n" : "\n")
+       << "    \"" << getPhaseName(Phase(i)) << "\": {";
+    for (unsigned j = 0; j != NumMemoryCategories; ++j)
+      os << (j ? ", " : "")
+         << "\"" << getMemoryCategoryName(MemoryCategory(j)) << "\": "
+         << PhaseMemory[i].Bytes[j];
+    os << "}";
+  }
+  os << "\n  }\n}\n";
+}
+
+/// Reads the integer in \p Node into \p Value.
+/// \returns true on error
+template <typename T>
+static bool readInteger(llvm::yaml::Node *Node, T &Value,
+                        SmallVectorImpl<char> &Scratch) {
+  auto *Scalar = dyn_cast_or_null<llvm::yaml::ScalarNode>(Node);
+  return !Scalar || Scalar->getValue(Scratch).getAsInteger(10, Value);
+}
+
+bool FrontendStats::addFromFile(StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return true;
+
+  namespace yaml = llvm::yaml;
+  llvm::SourceMgr SM;
+  yaml::Stream Stream(Buffer.get()->getMemBufferRef(), SM);
+  auto I = Stream.begin();
+  if (I == Stream.end() || !I->getRoot())
+    return true;
+  auto *TopLevelMap = dyn_cast<yaml::MappingNode>(I->getRoot());
+  if (!TopLevelMap)
+    return true;
+
+  FrontendStats Parsed;
+  SmallString<64> Scratch;
+
+  // FIXME: LLVM's YAML support does incremental parsing in such a way that
+  // for-range loops break.
+  for (auto i = TopLevelMap->begin(), e = TopLevelMap->end(); i != e; ++i) {
+    auto *Key = dyn_cast<yaml::ScalarNode>(i->getKey());
+    if (!Key)
+      return true;
+    StringRef KeyStr = Key->getValue(Scratch);
+    if (KeyStr != "phases" && KeyStr != "counters" && KeyStr != "memory")
+      continue;
+    auto *Value = dyn_cast<yaml::MappingNode>(i->getValue());
+    if (!Value)
+      return true;
+
+    if (KeyStr == "phases" || KeyStr == "memory") {
+      for (auto j = Value->begin(), je = Value->end(); j != je; ++j) {
+        auto *PhaseKey = dyn_cast<yaml::ScalarNode>(j->getKey());
+        auto *PhaseValue = dyn_cast<yaml::MappingNode>(j->getValue());
+        if (!PhaseKey || !PhaseValue)
+          return true;
+        StringRef PhaseName = PhaseKey->getValue(Scratch);
+        unsigned Index = 0;
+        while (Index != NumPhases && getPhaseName(Phase(Index)) != PhaseName)
+          ++Index;
+        if (Index == NumPhases)
+          continue;
+
+        if (KeyStr == "memory") {
+          MemoryUsage &Usage = Parsed.PhaseMemory[Index];
+          for (auto k = PhaseValue->begin(), ke = PhaseValue->end(); k != ke;
+               ++k) {
+            auto *CategoryKey = dyn_cast<yaml::ScalarNode>(k->getKey());
+            if (!CategoryKey)
+              return true;
+            StringRef CategoryName = CategoryKey->getValue(Scratch);
+            unsigned Category = 0;
+            while (Category != NumMemoryCategories &&
+                   getMemoryCategoryName(MemoryCategory(Category)) !=
+                     CategoryName)
+              ++Category;
+            if (Category != NumMemoryCategories &&
+                readInteger(k->getValue(), Usage.Bytes[Category], Scratch))
+              return true;
+          }
+          continue;
+        }
+
+        PhaseTime &Time = Parsed.Phases[Index];
+        for (auto k = PhaseValue->begin(), ke = PhaseValue->end(); k != ke;
+             ++k) {
+          auto *TimeKey = dyn_cast<yaml::ScalarNode>(k->getKey());
+          if (!TimeKey)
+            return true;
+          int64_t *Field = llvm::StringSwitch<int64_t *>(
+                               TimeKey->getValue(Scratch))
+            .Case("wall-usec", &Time.WallUSec)
+            .Case("user-usec", &Time.UserUSec)
+            .Case("system-usec", &Time.SystemUSec)
+            .Default(nullptr);
+          if (Field && readInteger(k->getValue(), *Field, Scratch))
+            return true;
+        }
+      }
+
+    } else {
+      for (auto j = Value->begin(), je = Value->end(); j != je; ++j) {
+        auto *CounterKey = dyn_cast<yaml::ScalarNode>(j->getKey());
+        if (!CounterKey)
+          return true;
+        uint64_t *Field = llvm::StringSwitch<uint64_t *>(
+                              CounterKey->getValue(Scratch))
+          .Case("jobs", &Parsed.NumJobs)
+          .Case("decls-deserialized", &Parsed.NumDeclsDeserialized)
+          .Case("clang-decls-imported", &Parsed.NumClangDeclsImported)
+          .Case("sil-instructions", &Parsed.NumSILInstructions)
+          .Case("llvm-instructions", &Parsed.NumLLVMInstructions)
+          .Default(nullptr);
+        if (Field && readInteger(j->getValue(), *Field, Scratch))
+          return true;
+      }
+    }
+  }
+
+  add(Parsed);
+  return false;
+}
@@ -525,6 +525,14 @@ void Remangler::mangleFunctionSignatureSpecializationParam(Node *node) {
   case FunctionSigSpecializationParamKind::InOutToValue:
     Out << "i_";
     return;
+  case FunctionSigSpecializationParamKind::ExistentialToConcrete:
+    Out << "ex";
+    mangleType(node->getChild(1).get());
+    Out << '_';
+    return;
+  case FunctionSigSpecializationParamKind::ReturnValueOwnedToUnowned:
+    Out << "ru_";
+    return;
   default:
     if (kindValue &
         unsigned(FunctionSigSpecializationParamKind::Dead))
@@ -15,6 +15,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
 
 using namespace swift;
 
@@ -201,6 +203,83 @@ unsigned SourceManager::findBufferContainingLoc(SourceLoc Loc) const {
   llvm_unreachable("no buffer containing location found");
 }
 
+const std::vector<unsigned> &
+SourceManager::getLineTable(unsigned BufferID) const {
+  auto &Table = LineTables[BufferID];
+  if (!Table.empty())
+    return Table;
+
+  // The first entry is a sentinel for the start of the buffer, so that an
+  // empty table means "not built yet".
+  StringRef Buffer = LLVMSourceMgr.getMemoryBuffer(BufferID)->getBuffer();
+  const char *Start = Buffer.begin();
+  const char *End = Buffer.end();
+  Table.push_back(0);
+  // memchr is vectorized by the C library, which makes this much faster than
+  // a byte-by-byte scan.
+  for (const char *Ptr = Start;
+       (Ptr = static_cast<const char *>(memchr(Ptr, '\n', End - Ptr)));
+       ++Ptr) {
+    Table.push_back(Ptr + 1 - Start);
+  }
+  return Table;
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::getRealLineAndColumn(SourceLoc Loc, unsigned BufferID) const {
+  const char *Start =
+    LLVMSourceMgr.getMemoryBuffer(BufferID)->getBufferStart();
+  unsigned Offset = getLocOffsetInBuffer(Loc, BufferID);
+
+  const std::vector<unsigned> &Table = getLineTable(BufferID);
+  auto LineStart = std::upper_bound(Table.begin(), Table.end(), Offset) - 1;
+  unsigned Line = LineStart - Table.begin() + 1;
+
+  // Like llvm::SourceMgr, count columns from the last '\r' as well as the
+  // last '\n'.
+  StringRef LineText(Start + *LineStart, Offset - *LineStart);
+  size_t LastCR = LineText.rfind('\r');
+  unsigned Column = (LastCR == StringRef::npos) ? LineText.size() + 1
+                                                : LineText.size() - LastCR;
+  return { Line, Column };
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::getLineAndColumn(SourceLoc Loc, unsigned BufferID) const {
+  assert(Loc.isValid());
+  if (BufferID == 0)
+    BufferID = findBufferContainingLoc(Loc);
+  int LineOffset = getLineOffset(Loc);
+  auto LineAndCol = getRealLineAndColumn(Loc, BufferID);
+  assert(LineOffset + int(LineAndCol.first) > 0 && "bogus line offset");
+  return { LineOffset + LineAndCol.first, LineAndCol.second };
+}
+
+void SourceManager::getLineAndColumns(
+    ArrayRef<SourceLoc> Locs,
+    SmallVectorImpl<std::pair<unsigned, unsigned>> &Result) const {
+  Result.reserve(Result.size() + Locs.size());
+  unsigned BufferID = 0;
+  CharSourceRange BufferRange;
+  for (SourceLoc Loc : Locs) {
+    assert(Loc.isValid());
+    // Include the end of the buffer, like findBufferContainingLoc.
+    if (BufferID == 0 || !(BufferRange.contains(Loc) ||
+                           BufferRange.getEnd() == Loc)) {
+      BufferID = findBufferContainingLoc(Loc);
+      BufferRange = getRangeForBuffer(BufferID);
+    }
+    Result.push_back(getLineAndColumn(Loc, BufferID));
+  }
+}
+
+unsigned SourceManager::getLineNumber(SourceLoc Loc, unsigned BufferID) const {
+  assert(Loc.isValid());
+  if (BufferID == 0)
+    BufferID = findBufferContainingLoc(Loc);
+  return getRealLineAndColumn(Loc, BufferID).first;
+}
+
 void SourceLoc::printLineAndColumn(raw_ostream &OS,
                                    const SourceManager &SM) const {
   if (isInvalid()) {
@@ -49,7 +49,8 @@ void DummyTaskQueue::addTask(const char *ExecPath, ArrayRef<const char *> Args,
 
 bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
                              TaskQueue::TaskFinishedCallback Finished,
-                             TaskQueue::TaskSignalledCallback Signalled) {
+                             TaskQueue::TaskSignalledCallback Signalled,
+                             TaskQueue::TaskOutputCallback Streamed) {
   typedef std::pair<ProcessId, std::unique_ptr<DummyTask>> PidTaskPair;
   std::queue<PidTaskPair> ExecutingTasks;
 
@@ -80,7 +81,8 @@ bool DummyTaskQueue::execute(TaskQueue::TaskBeganCallback Began,
 
     if (Finished) {
       std::string Output = "Output placeholder\n";
-        if (Finished(P.first, 0, Output, P.second->Context) ==
+        if (Finished(P.first, 0, Output, TaskResourceUsage(),
+                     P.second->Context) ==
             TaskFinishedResponse::StopExecution)
           SubtaskFailed = true;
     }
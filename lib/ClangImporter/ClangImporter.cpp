@@ -34,11 +34,14 @@
 #include "swift/ClangImporter/ClangImporterOptions.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Config.h"
+#include "swift/Strings.h"
+#include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Mangle.h"
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/Module.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/Version.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
@@ -142,6 +145,38 @@ namespace {
     }
   };
 
+  /// Forwards the inputs of a precompiled bridging header to the importer's
+  /// dependencies, as HeaderImportCallbacks does for a parsed one.
+  class PCHDependencyCollector : public clang::DependencyCollector {
+    ClangImporter &Importer;
+  public:
+    explicit PCHDependencyCollector(ClangImporter &importer)
+      : Importer(importer) {}
+
+    bool sawDependency(StringRef filename, bool fromModule, bool isSystem,
+                       bool isModuleFile, bool isMissing) override {
+      if (fromModule && !isModuleFile && !isMissing)
+        Importer.addDependency(filename);
+      return false;
+    }
+  };
+
+  /// Collects the modules imported by a precompiled bridging header as its
+  /// import declarations are deserialized.
+  class PCHImportCollector : public clang::ASTConsumer {
+    ClangImporter::Implementation &Impl;
+  public:
+    explicit PCHImportCollector(ClangImporter::Implementation &impl)
+      : Impl(impl) {}
+
+    bool HandleTopLevelDecl(clang::DeclGroupRef decls) override {
+      for (auto *D : decls)
+        if (auto *importDecl = dyn_cast<clang::ImportDecl>(D))
+          Impl.PCHImportedModules.push_back(importDecl->getImportedModule());
+      return true;
+    }
+  };
+
   class StdStringMemBuffer : public llvm::MemoryBuffer {
     const std::string storage;
     const std::string name;
@@ -518,6 +553,11 @@ ClangImporter::create(ASTContext &ctx,
   }
   addCommonInvocationArguments(invocationArgStrs, ctx, importerOpts);
 
+  if (!importerOpts.PrecompiledHeaderInputPath.empty()) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.PrecompiledHeaderInputPath);
+  }
+
   if (importerOpts.DumpClangDiagnostics) {
     llvm::errs() << "clang '";
     interleave(invocationArgStrs,
@@ -606,6 +646,12 @@ ClangImporter::create(ASTContext &ctx,
   if (importerOpts.Mode == ClangImporterOptions::Modes::EmbedBitcode)
     return importer;
 
+  bool usesPCH = !importerOpts.PrecompiledHeaderInputPath.empty();
+  if (usesPCH) {
+    instance.addDependencyCollector(
+        std::make_shared<PCHDependencyCollector>(*importer));
+  }
+
   bool canBegin = action->BeginSourceFile(instance,
                                           instance.getFrontendOpts().Inputs[0]);
   if (!canBegin)
@@ -626,6 +672,20 @@ ClangImporter::create(ASTContext &ctx,
 
   // Manually run the action, so that the TU stays open for additional parsing.
   instance.createSema(action->getTranslationUnitKind(), nullptr);
+
+  // The import declarations of a precompiled header are deserialized eagerly
+  // once the translation unit starts. Nothing else needs a consumer, so stop
+  // listening right after.
+  if (usesPCH) {
+    importer->Impl.LoadedBridgingPCH = true;
+    importer->Impl.BridgingPCHOriginalHeader =
+        instance.getModuleManager()->getOriginalSourceFile();
+    if (auto *source = instance.getASTContext().getExternalSource()) {
+      PCHImportCollector collector(importer->Impl);
+      source->StartTranslationUnit(&collector);
+      source->StartTranslationUnit(nullptr);
+    }
+  }
   importer->Impl.Parser.reset(new clang::Parser(clangPP, instance.getSema(),
                                                 /*skipFunctionBodies=*/false));
 
@@ -785,6 +845,26 @@ bool ClangImporter::importHeader(StringRef header, Module *adapter,
 bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                                          SourceLoc diagLoc,
                                          bool trackParsedSymbols) {
+  if (llvm::sys::path::extension(header).endswith(PCH_EXTENSION)) {
+    // A precompiled header has to be loaded as Clang is set up, which leaves
+    // only its module imports to be made visible.
+    if (!Impl.LoadedBridgingPCH) {
+      Impl.SwiftContext.Diags.diagnose(diagLoc, diag::bridging_header_error,
+                                       header);
+      return true;
+    }
+
+    Impl.ImportedHeaderOwners.push_back(adapter);
+    for (auto *imported : Impl.PCHImportedModules) {
+      Module *nativeImported =
+        Impl.finishLoadingClangModule(*this, imported, /*adapter=*/true);
+      Impl.ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+    }
+    Impl.PCHImportedModules.clear();
+    Impl.bumpGeneration();
+    return false;
+  }
+
   clang::FileManager &fileManager = Impl.Instance->getFileManager();
   const clang::FileEntry *headerFile = fileManager.getFile(header,
                                                            /*open=*/true);
@@ -807,6 +887,10 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
                            std::move(sourceBuffer));
 }
 
+StringRef ClangImporter::getBridgingPCHOriginalHeader() const {
+  return Impl.BridgingPCHOriginalHeader;
+}
+
 std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
                                                      off_t &fileSize,
                                                      time_t &fileModTime) {
@@ -854,6 +938,39 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = outputPCHPath;
+  invocation->getFrontendOpts().ProgramAction = clang::frontend::GeneratePCH;
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics();
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNamesAndVisibility(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::pair<std::string, bool>> &namesVisiblePairs) {
@@ -1300,6 +1417,23 @@ ClangImporter::Implementation::importDeclName(clang::DeclarationName name,
 Identifier
 ClangImporter::Implementation::importName(const clang::NamedDecl *D,
                                           StringRef removePrefix) {
+  // Names imported without a prefix to remove only depend on the declaration
+  // itself, so remember them.
+  if (!removePrefix.empty())
+    return computeImportedName(D, removePrefix);
+
+  auto known = ImportedNames.find(D);
+  if (known != ImportedNames.end())
+    return known->second;
+
+  Identifier result = computeImportedName(D, removePrefix);
+  ImportedNames[D] = result;
+  return result;
+}
+
+Identifier
+ClangImporter::Implementation::computeImportedName(const clang::NamedDecl *D,
+                                                   StringRef removePrefix) {
   if (auto *nameAttr = D->getAttr<clang::SwiftNameAttr>()) {
     StringRef customName = nameAttr->getName();
     if (Lexer::isIdentifier(customName))
@@ -1618,7 +1752,8 @@ ClangImporter::Implementation::mapSelectorToDeclName(ObjCSelector selector,
                                                      bool isSwiftPrivate)
 {
   // Check whether we've already mapped this selector.
-  auto known = SelectorMappings.find({selector, isInitializer});
+  char mappingKind = isInitializer | (isSwiftPrivate << 1);
+  auto known = SelectorMappings.find({selector, mappingKind});
   if (known != SelectorMappings.end())
     return known->second;
 
@@ -1627,7 +1762,7 @@ ClangImporter::Implementation::mapSelectorToDeclName(ObjCSelector selector,
                                 isSwiftPrivate);
 
   // Cache the result and return.
-  SelectorMappings[{selector, isInitializer}] = result;
+  SelectorMappings[{selector, mappingKind}] = result;
   return result;
 }
 
@@ -3037,6 +3172,30 @@ clang::ASTContext &ClangImporter::getClangASTContext() const {
 clang::Preprocessor &ClangImporter::getClangPreprocessor() const {
   return Impl.getClangPreprocessor();
 }
+
+size_t ClangImporter::getClangMemory() const {
+  clang::ASTContext &ctx = getClangASTContext();
+  clang::SourceManager &sourceMgr = ctx.getSourceManager();
+  return ctx.getASTAllocatedMemory() +
+    ctx.getSideTableAllocatedMemory() +
+    getClangPreprocessor().getTotalMemory() +
+    sourceMgr.getDataStructureSizes() +
+    sourceMgr.getMemoryBufferSizes().malloc_bytes;
+}
+
+size_t ClangImporter::getImporterMemory() const {
+  return sizeof(Impl) +
+    llvm::capacity_in_bytes(Impl.ImportedDecls) +
+    llvm::capacity_in_bytes(Impl.SelectorMappings) +
+    llvm::capacity_in_bytes(Impl.ImportedNames) +
+    Impl.SuperfluousTypedefs.getMemorySize() +
+    Impl.DeclsWithSuperfluousTypedefs.getMemorySize() +
+    llvm::capacity_in_bytes(Impl.ImportedProtocolDecls) +
+    llvm::capacity_in_bytes(Impl.ImportedMacros) +
+    llvm::capacity_in_bytes(Impl.ClassExtensions) +
+    llvm::capacity_in_bytes(Impl.Subscripts) +
+    llvm::capacity_in_bytes(Impl.EnumConstantNamePrefixes);
+}
 const clang::Module *ClangImporter::getClangOwningModule(ClangNode Node) const {
   return ::getClangOwningModule(Node, getClangASTContext());
 }
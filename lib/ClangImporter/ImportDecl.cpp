@@ -26,7 +26,9 @@
 #include "swift/AST/Pattern.h"
 #include "swift/AST/Stmt.h"
 #include "swift/AST/Types.h"
+#include "swift/Basic/Defer.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/ClangImporter/ClangModule.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Config.h"
@@ -4576,112 +4578,172 @@ namespace {
       return false;
     }
 
-    /// Import members of the given Objective-C container and add them to the
-    /// list of corresponding Swift members.
-    void importObjCMembers(const clang::ObjCContainerDecl *decl,
-                           DeclContext *swiftContext,
-                           SmallVectorImpl<Decl *> &members,
-                           bool &hasMissingRequiredMember) {
-      llvm::SmallPtrSet<Decl *, 4> knownMembers;
-      for (auto m = decl->decls_begin(), mEnd = decl->decls_end();
-           m != mEnd; ++m) {
-        auto nd = dyn_cast<clang::NamedDecl>(*m);
-        if (!nd || nd != nd->getCanonicalDecl())
-          continue;
+    /// Compute the base name the Objective-C member \p nd will be imported
+    /// with, without importing it.
+    Identifier importObjCMemberBaseName(const clang::NamedDecl *nd) {
+      auto method = dyn_cast<clang::ObjCMethodDecl>(nd);
+      if (!method)
+        return Impl.importName(nd);
 
-        auto member = Impl.importDecl(nd);
-        if (!member) {
-          if (auto method = dyn_cast<clang::ObjCMethodDecl>(nd)) {
-            if (method->getImplementationControl() ==
-                clang::ObjCMethodDecl::Required)
-              hasMissingRequiredMember = true;
-          } else if (auto prop = dyn_cast<clang::ObjCPropertyDecl>(nd)) {
-            if (prop->getPropertyImplementation() ==
-                clang::ObjCPropertyDecl::Required)
-              hasMissingRequiredMember = true;
-          }
-          continue;
+      if (method->getMethodFamily() == clang::OMF_init &&
+          isReallyInitMethod(method))
+        return Impl.SwiftContext.Id_init;
+
+      if (auto *customNameAttr = method->getAttr<clang::SwiftNameAttr>()) {
+        if (!customNameAttr->getName().startswith("init(")) {
+          if (DeclName name = parseDeclName(customNameAttr->getName()))
+            return name.getBaseName();
         }
+      }
 
-        if (auto objcMethod = dyn_cast<clang::ObjCMethodDecl>(nd)) {
-          // If there is a special declaration associated with this member,
-          // add it now.
-          if (auto special = importSpecialMethod(member, swiftContext)) {
-            if (knownMembers.insert(special).second)
-              members.push_back(special);
-          }
+      bool isSwiftPrivate = method->hasAttr<clang::SwiftPrivateAttr>();
+      DeclName name =
+        Impl.mapSelectorToDeclName(Impl.importSelector(method->getSelector()),
+                                   /*isInitializer=*/false, isSwiftPrivate);
+      return name ? name.getBaseName() : Identifier();
+    }
 
-          // If this is a factory method, try to import it as a constructor.
-          if (auto factory = importFactoryMethodAsConstructor(
-                               member,
-                               objcMethod, 
-                               Impl.importSelector(objcMethod->getSelector()),
-                               swiftContext)) {
-            if (*factory)
-              members.push_back(*factory);
-          }
+    /// Whether importing the Objective-C member \p nd produces any members
+    /// besides the ones named like \p nd itself, or has side effects on
+    /// members with other names.
+    ///
+    /// Such members can only be imported along with the rest of their
+    /// container.
+    bool importsObjCMemberUnderOtherNames(const clang::NamedDecl *nd) {
+      auto method = dyn_cast<clang::ObjCMethodDecl>(nd);
+      if (!method)
+        return false;
 
-          // Objective-C root class instance methods are reflected on the
-          // metatype as well.
-          if (objcMethod->isInstanceMethod()) {
-            Type swiftTy = swiftContext->getDeclaredTypeInContext();
-            auto swiftClass = swiftTy->getClassOrBoundGenericClass();
-            if (swiftClass && !swiftClass->getSuperclass() &&
-                !decl->getClassMethod(objcMethod->getSelector(),
-                                      /*AllowHidden=*/true)) {
-              auto classMember = VisitObjCMethodDecl(objcMethod, swiftContext,
-                                                     true);
-              if (classMember)
-                members.push_back(classMember);
-            }
+      // Class methods may be imported as factory initializers.
+      if (method->isClassMethod())
+        return true;
+
+      // Subscript accessors are also imported as subscripts.
+      auto sel = method->getSelector();
+      return sel == Impl.objectAtIndexedSubscript ||
+             sel == Impl.setObjectAtIndexedSubscript ||
+             sel == Impl.objectForKeyedSubscript ||
+             sel == Impl.setObjectForKeyedSubscript;
+    }
+
+    /// Import a single member \p nd of the Objective-C container \p decl,
+    /// adding the resulting Swift members to \p members.
+    void importObjCMember(const clang::ObjCContainerDecl *decl,
+                          const clang::NamedDecl *nd,
+                          DeclContext *swiftContext,
+                          SmallVectorImpl<Decl *> &members,
+                          llvm::SmallPtrSetImpl<Decl *> &knownMembers,
+                          bool &hasMissingRequiredMember) {
+      auto member = Impl.importDecl(nd);
+      if (!member) {
+        if (auto method = dyn_cast<clang::ObjCMethodDecl>(nd)) {
+          if (method->getImplementationControl() ==
+              clang::ObjCMethodDecl::Required)
+            hasMissingRequiredMember = true;
+        } else if (auto prop = dyn_cast<clang::ObjCPropertyDecl>(nd)) {
+          if (prop->getPropertyImplementation() ==
+              clang::ObjCPropertyDecl::Required)
+            hasMissingRequiredMember = true;
+        }
+        return;
+      }
+
+      if (auto objcMethod = dyn_cast<clang::ObjCMethodDecl>(nd)) {
+        // If there is a special declaration associated with this member,
+        // add it now.
+        if (auto special = importSpecialMethod(member, swiftContext)) {
+          if (knownMembers.insert(special).second)
+            members.push_back(special);
+        }
+
+        // If this is a factory method, try to import it as a constructor.
+        if (auto factory = importFactoryMethodAsConstructor(
+                             member,
+                             objcMethod, 
+                             Impl.importSelector(objcMethod->getSelector()),
+                             swiftContext)) {
+          if (*factory)
+            members.push_back(*factory);
+        }
+
+        // Objective-C root class instance methods are reflected on the
+        // metatype as well.
+        if (objcMethod->isInstanceMethod()) {
+          Type swiftTy = swiftContext->getDeclaredTypeInContext();
+          auto swiftClass = swiftTy->getClassOrBoundGenericClass();
+          if (swiftClass && !swiftClass->getSuperclass() &&
+              !decl->getClassMethod(objcMethod->getSelector(),
+                                    /*AllowHidden=*/true)) {
+            auto classMember = VisitObjCMethodDecl(objcMethod, swiftContext,
+                                                   true);
+            if (classMember)
+              members.push_back(classMember);
           }
+        }
 
-          // Import explicit properties as instance properties, not as separate
-          // getter and setter methods.
-          if (!Impl.isAccessibilityDecl(objcMethod)) {
-            // If this member is a method that is a getter or setter for a
-            // propertythat was imported, don't add it to the list of members
-            // so it won't be found by name lookup. This eliminates the
-            // ambiguity between property names and getter names (by choosing
-            // to only have a variable).
-            if (objcMethod->isPropertyAccessor()) {
-              auto prop = objcMethod->findPropertyDecl(/*checkOverrides=*/false);
-              assert(prop);
-              (void)Impl.importDecl(const_cast<clang::ObjCPropertyDecl *>(prop));
-              // We may have attached this member to an existing property even
-              // if we've failed to import a new property.
-              if (cast<FuncDecl>(member)->isAccessor())
-                continue;
-            } else if (Impl.InferImplicitProperties) {
-              // Try to infer properties for matched getter/setter pairs.
-              // Be careful to only do this once per matched pair.
-              if (auto counterpart = findImplicitPropertyAccessor(objcMethod)) {
-                if (auto counterpartImported = Impl.importDecl(counterpart)) {
-                  if (objcMethod->getReturnType()->isVoidType()) {
-                    if (auto prop = makeImplicitPropertyDecl(counterpartImported,
-                                                             member,
-                                                             swiftContext)) {
-                      members.push_back(prop);
-                    } else {
-                      // If we fail to import the implicit property, fall back to
-                      // adding the accessors as members. We have to add BOTH
-                      // accessors here because we already skipped over the other
-                      // one.
-                      members.push_back(member);
-                      members.push_back(counterpartImported);
-                    }
+        // Import explicit properties as instance properties, not as separate
+        // getter and setter methods.
+        if (!Impl.isAccessibilityDecl(objcMethod)) {
+          // If this member is a method that is a getter or setter for a
+          // propertythat was imported, don't add it to the list of members
+          // so it won't be found by name lookup. This eliminates the
+          // ambiguity between property names and getter names (by choosing
+          // to only have a variable).
+          if (objcMethod->isPropertyAccessor()) {
+            auto prop = objcMethod->findPropertyDecl(/*checkOverrides=*/false);
+            assert(prop);
+            (void)Impl.importDecl(const_cast<clang::ObjCPropertyDecl *>(prop));
+            // We may have attached this member to an existing property even
+            // if we've failed to import a new property.
+            if (cast<FuncDecl>(member)->isAccessor())
+              return;
+          } else if (Impl.InferImplicitProperties) {
+            // Try to infer properties for matched getter/setter pairs.
+            // Be careful to only do this once per matched pair.
+            if (auto counterpart = findImplicitPropertyAccessor(objcMethod)) {
+              if (auto counterpartImported = Impl.importDecl(counterpart)) {
+                if (objcMethod->getReturnType()->isVoidType()) {
+                  if (auto prop = makeImplicitPropertyDecl(counterpartImported,
+                                                           member,
+                                                           swiftContext)) {
+                    members.push_back(prop);
+                  } else {
+                    // If we fail to import the implicit property, fall back to
+                    // adding the accessors as members. We have to add BOTH
+                    // accessors here because we already skipped over the other
+                    // one.
+                    members.push_back(member);
+                    members.push_back(counterpartImported);
                   }
-                  continue;
                 }
+                return;
               }
-            } else if (auto *proto = dyn_cast<clang::ObjCProtocolDecl>(decl)) {
-              if (isPotentiallyConflictingSetter(proto, objcMethod))
-                continue;
             }
+          } else if (auto *proto = dyn_cast<clang::ObjCProtocolDecl>(decl)) {
+            if (isPotentiallyConflictingSetter(proto, objcMethod))
+              return;
           }
         }
+      }
+
+      members.push_back(member);
+    }
+
+    /// Import members of the given Objective-C container and add them to the
+    /// list of corresponding Swift members.
+    void importObjCMembers(const clang::ObjCContainerDecl *decl,
+                           DeclContext *swiftContext,
+                           SmallVectorImpl<Decl *> &members,
+                           bool &hasMissingRequiredMember) {
+      llvm::SmallPtrSet<Decl *, 4> knownMembers;
+      for (auto m = decl->decls_begin(), mEnd = decl->decls_end();
+           m != mEnd; ++m) {
+        auto nd = dyn_cast<clang::NamedDecl>(*m);
+        if (!nd || nd != nd->getCanonicalDecl())
+          continue;
 
-        members.push_back(member);
+        importObjCMember(decl, nd, swiftContext, members, knownMembers,
+                         hasMissingRequiredMember);
       }
 
       // Hack to deal with unannotated Objective-C protocols. If the protocol
@@ -4724,7 +4786,8 @@ namespace {
                                        DeclContext *dc,
                                        ArrayRef<ProtocolDecl *> protocols,
                                        SmallVectorImpl<Decl *> &members,
-                                       ASTContext &Ctx) {
+                                       ASTContext &Ctx,
+                                       Identifier onlyBaseName = Identifier()) {
       Type swiftTy = dc->getDeclaredTypeInContext();
       auto swiftClass = swiftTy->getClassOrBoundGenericClass();
       bool isRoot = swiftClass && !swiftClass->getSuperclass();
@@ -4761,6 +4824,12 @@ namespace {
             continue;
 
         for (auto member : proto->getMembers()) {
+          if (!onlyBaseName.empty()) {
+            auto VD = dyn_cast<ValueDecl>(member);
+            if (!VD || VD->getName() != onlyBaseName)
+              continue;
+          }
+
           if (auto prop = dyn_cast<VarDecl>(member)) {
             auto objcProp =
               dyn_cast_or_null<clang::ObjCPropertyDecl>(prop->getClangDecl());
@@ -5987,6 +6056,8 @@ ClangImporter::Implementation::importDeclImpl(const clang::NamedDecl *ClangDecl,
 void ClangImporter::Implementation::startedImportingEntity() {
   ++NumCurrentImportingEntities;
   ++NumTotalImportedEntities;
+  if (SwiftContext.Stats)
+    ++SwiftContext.Stats->NumClangDeclsImported;
 }
 
 void ClangImporter::Implementation::finishedImportingEntity() {
@@ -6471,6 +6542,96 @@ ClangImporter::Implementation::loadAllMembers(Decl *D, uint64_t unused,
 
 }
 
+bool
+ClangImporter::Implementation::loadNamedMembers(
+    const Decl *D, Identifier baseName, uint64_t unused,
+    SmallVectorImpl<ValueDecl *> &members) {
+  assert(D->hasClangNode());
+
+  // Initializers and subscripts are synthesized from several Objective-C
+  // members each, and inferred properties pair up methods with different
+  // names; those lookups need the complete member list.
+  if (baseName == SwiftContext.Id_init ||
+      baseName == SwiftContext.Id_subscript ||
+      InferImplicitProperties)
+    return false;
+
+  // Only classes and their categories are loaded by name. Instance methods of
+  // root classes are also imported as class methods, which aren't cached.
+  auto DC = dyn_cast<DeclContext>(const_cast<Decl *>(D));
+  auto swiftClass = DC ? DC->getDeclaredTypeOfContext()
+                           ->getClassOrBoundGenericClass()
+                       : nullptr;
+  if (!swiftClass || !swiftClass->getSuperclass())
+    return false;
+
+  // While members are being loaded by name, lookups into the same
+  // declaration see only what has been loaded already, just as they do
+  // while all members are being loaded.
+  if (!MembersLoadingByName.insert(D).second)
+    return true;
+  defer([&]{ MembersLoadingByName.erase(D); });
+
+  auto clangDecl = cast<clang::ObjCContainerDecl>(D->getClangDecl());
+
+  clang::PrettyStackTraceDecl trace(clangDecl, clang::SourceLocation(),
+                                    Instance->getSourceManager(),
+                                    "loading members by name for");
+
+  SwiftDeclConverter converter(*this);
+
+  // Index the container's members by base name the first time it's looked
+  // into, so that each lookup only touches the members it's looking for.
+  auto knownIndex = ObjCMembersByName.find(clangDecl);
+  if (knownIndex == ObjCMembersByName.end()) {
+    auto &index = ObjCMembersByName[clangDecl];
+    for (auto m : clangDecl->decls()) {
+      auto nd = dyn_cast<clang::NamedDecl>(m);
+      if (!nd || nd != nd->getCanonicalDecl())
+        continue;
+      Identifier name = converter.importObjCMemberBaseName(nd);
+      if (!name.empty())
+        index[name].push_back(nd);
+    }
+    knownIndex = ObjCMembersByName.find(clangDecl);
+  }
+
+  // Importing may index other containers, so don't hold on to the entry.
+  SmallVector<const clang::NamedDecl *, 2> candidates;
+  auto knownCandidates = knownIndex->second.find(baseName);
+  if (knownCandidates != knownIndex->second.end())
+    candidates.append(knownCandidates->second.begin(),
+                      knownCandidates->second.end());
+
+  for (auto nd : candidates)
+    if (converter.importsObjCMemberUnderOtherNames(nd))
+      return false;
+
+  ImportingEntityRAII Importing(*this);
+
+  SmallVector<Decl *, 4> imported;
+  llvm::SmallPtrSet<Decl *, 4> knownMembers;
+  bool hasMissingRequiredMember = false;
+  for (auto nd : candidates)
+    converter.importObjCMember(clangDecl, nd, DC, imported, knownMembers,
+                               hasMissingRequiredMember);
+
+  // Mirror the matching members of the adopted protocols, as loadAllMembers
+  // would.
+  if (auto clangClass = dyn_cast<clang::ObjCInterfaceDecl>(clangDecl))
+    clangDecl = clangClass->getDefinition();
+  converter.importMirroredProtocolMembers(clangDecl, DC,
+                                          getImportedProtocols(D), imported,
+                                          SwiftContext, baseName);
+
+  for (auto member : imported) {
+    auto VD = dyn_cast<ValueDecl>(member);
+    if (VD && VD->getName() == baseName)
+      members.push_back(VD);
+  }
+  return true;
+}
+
 void ClangImporter::Implementation::loadAllConformances(
        const Decl *D, uint64_t contextData,
        SmallVectorImpl<ProtocolConformance *> &Conformances) {
@@ -31,6 +31,7 @@
 #include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <set>
@@ -305,9 +306,15 @@ public:
   llvm::SmallDenseMap<const clang::TypedefNameDecl *, MappedTypeNameKind, 16>
     SpecialTypedefNames;
 
-  /// Mapping from Objective-C selectors to method names.
+  /// Mapping from Objective-C selectors to method names, keyed by whether
+  /// the selector names an initializer (bit 0) and whether the method is
+  /// swift_private (bit 1).
   llvm::DenseMap<std::pair<ObjCSelector, char>, DeclName> SelectorMappings;
 
+  /// Mapping from Clang declarations to the names they import with, when no
+  /// prefix is removed.
+  llvm::DenseMap<const clang::NamedDecl *, Identifier> ImportedNames;
+
   /// Is the given identifier a reserved name in Swift?
   static bool isSwiftReservedName(StringRef name);
 
@@ -576,6 +583,16 @@ private:
   llvm::DenseMap<const Decl *, SmallVector<ProtocolDecl *, 4>>
     ImportedProtocols;
 
+  /// The Objective-C members of each container that has been looked into by
+  /// name, keyed by the base name they import with.
+  llvm::DenseMap<const clang::ObjCContainerDecl *,
+                 llvm::DenseMap<Identifier,
+                                TinyPtrVector<const clang::NamedDecl *>>>
+    ObjCMembersByName;
+
+  /// The declarations whose members are currently being loaded by name.
+  llvm::SmallPtrSet<const Decl *, 4> MembersLoadingByName;
+
   void startedImportingEntity();
   void finishedImportingEntity();
   void finishPendingActions();
@@ -612,6 +629,16 @@ public:
   std::vector<llvm::PointerUnion<clang::ImportDecl *, ImportDecl *>>
     BridgeHeaderTopLevelImports;
 
+  /// Whether a precompiled bridging header was loaded as Clang was set up.
+  bool LoadedBridgingPCH = false;
+
+  /// The header the loaded precompiled bridging header was built from.
+  std::string BridgingPCHOriginalHeader;
+
+  /// The modules imported by the precompiled bridging header, until
+  /// importBridgingHeader makes them visible.
+  std::vector<clang::Module *> PCHImportedModules;
+
   /// Tracks macro definitions from the bridging header.
   std::vector<clang::IdentifierInfo *> BridgeHeaderMacros;
   /// Tracks included headers from the bridging header.
@@ -721,6 +748,13 @@ public:
   ///
   /// \sa importName(clang::DeclarationName, StringRef)
   Identifier importName(const clang::NamedDecl *D, StringRef removePrefix = "");
+
+private:
+  /// Computes the result of \c importName, bypassing the cache.
+  Identifier computeImportedName(const clang::NamedDecl *D,
+                                 StringRef removePrefix);
+
+public:
   
   /// \brief Import the given Clang name into Swift.
   ///
@@ -1141,6 +1175,15 @@ public:
     recorded.insert(recorded.end(), protocols.begin(), protocols.end());
   }
 
+  /// Retrieve the imported protocols for the given declaration, leaving
+  /// them in place for \c loadAllMembers.
+  ArrayRef<ProtocolDecl *> getImportedProtocols(const Decl *decl) const {
+    auto known = ImportedProtocols.find(decl);
+    if (known == ImportedProtocols.end())
+      return { };
+    return known->second;
+  }
+
   /// Retrieve the imported protocols for the given declaration.
   SmallVector<ProtocolDecl *, 4> takeImportedProtocols(const Decl *decl) {
     SmallVector<ProtocolDecl *, 4> result;
@@ -1158,6 +1201,10 @@ public:
   loadAllMembers(Decl *D, uint64_t unused,
                  bool *hasMissingRequiredMembers) override;
 
+  virtual bool
+  loadNamedMembers(const Decl *D, Identifier baseName, uint64_t unused,
+                   SmallVectorImpl<ValueDecl *> &members) override;
+
   void
   loadAllConformances(
     const Decl *D, uint64_t contextData,
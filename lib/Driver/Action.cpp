@@ -20,7 +20,10 @@ using namespace llvm::opt;
 
 Action::~Action() {
   if (OwnsInputs) {
-    llvm::DeleteContainerPointers(Inputs);
+    for (Action *Input : Inputs)
+      if (std::find(SharedInputs.begin(), SharedInputs.end(), Input) ==
+          SharedInputs.end())
+        delete Input;
   }
 }
 
@@ -35,6 +38,8 @@ const char *Action::getClassName(ActionClass AC) {
     case REPLJob: return "repl";
     case LinkJob: return "link";
     case GenerateDSYMJob: return "generate-dSYM";
+    case GeneratePCHJob: return "generate-pch";
+    case ResolveImportsJob: return "resolve-imports";
   }
 
   llvm_unreachable("invalid class");
@@ -59,3 +64,7 @@ void REPLJobAction::anchor() {}
 void LinkJobAction::anchor() {}
 
 void GenerateDSYMJobAction::anchor() {}
+
+void GeneratePCHJobAction::anchor() {}
+
+void ResolveImportsJobAction::anchor() {}
@@ -15,6 +15,7 @@
 #include "swift/AST/DiagnosticEngine.h"
 #include "swift/AST/DiagnosticsDriver.h"
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/Basic/Program.h"
 #include "swift/Basic/TaskQueue.h"
 #include "swift/Basic/Version.h"
@@ -24,6 +25,7 @@
 #include "swift/Driver/Driver.h"
 #include "swift/Driver/Job.h"
 #include "swift/Driver/ParseableOutput.h"
+#include "swift/Serialization/Validation.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/StringExtras.h"
@@ -31,9 +33,15 @@
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/YAMLParser.h"
+#include <algorithm>
 
 using namespace swift;
 using namespace swift::sys;
@@ -83,9 +91,38 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// Jobs whose inputs have finished, but which haven't been handed to the
+    /// TaskQueue yet, so that they can be started longest first.
+    SmallVector<const Job *, 16> ReadyCommands;
+
+    struct RunningCommand {
+      llvm::sys::TimeValue BeginTime;
+      /// The parallel command slot the job occupies.
+      unsigned Lane;
+    };
+
+    /// When each running job began, and where.
+    llvm::SmallDenseMap<const Job *, RunningCommand, 16> RunningCommands;
+  };
+
+  /// A job that ran, for the build trace.
+  struct BuildTraceEvent {
+    const Job *Cmd;
+    /// Microseconds since the start of the build.
+    uint64_t Begin;
+    uint64_t Duration;
+    /// The parallel command slot the job ran in.
+    unsigned Lane;
   };
 }
 
+/// Durations of compile jobs in milliseconds, keyed by their primary input.
+using JobDurationMap = llvm::StringMap<uint64_t>;
+
+/// Hashes of the contents of external dependencies, keyed by their path.
+using ContentHashMap = llvm::StringMap<uint64_t>;
+
 Compilation::~Compilation() = default;
 
 Job *Compilation::addJob(std::unique_ptr<Job> J) {
@@ -110,10 +147,14 @@ static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      // Skip the jobs shared by all the compile jobs.
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
+      info.previousContentHash = entry.first->getInputContentHash();
       info.status = entry.second ?
           CompileJobAction::InputInfo::NeedsCascadingBuild :
           CompileJobAction::InputInfo::NeedsNonCascadingBuild;
@@ -127,10 +168,13 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
+      info.previousContentHash = entry->getInputContentHash();
       info.status = CompileJobAction::InputInfo::UpToDate;
       inputs[&inputFile->getInputArg()] = info;
     }
@@ -149,9 +193,43 @@ static void populateInputInfoMap(InputInfoMap &inputs,
   });
 }
 
+bool driver::computeFileContentHash(StringRef path, uint64_t &hash) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return true;
+
+  llvm::MD5 hasher;
+  hasher.update(buffer.get()->getBuffer());
+  llvm::MD5::MD5Result result;
+  hasher.final(result);
+
+  hash = 0;
+  for (unsigned i = 0; i != sizeof(hash); ++i)
+    hash = (hash << 8) | result[i];
+  if (hash == 0)
+    hash = 1;
+  return false;
+}
+
+/// Returns true if the file at \p path is a Swift module whose interface hash
+/// is \p hash.
+static bool hasInterfaceHash(StringRef path, StringRef hash) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return false;
+  auto info = serialization::validateSerializedAST(buffer.get()->getBuffer());
+  return info.status == serialization::Status::Valid &&
+         info.interfaceHash == hash;
+}
+
+/// Diagnoses inputs that were modified while the build was running.
+///
+/// With \p useContentHashes, an input that was only touched is not diagnosed,
+/// and its new modification time is recorded instead.
 static void checkForOutOfDateInputs(DiagnosticEngine &diags,
-                                    const InputInfoMap &inputs) {
-  for (const auto &inputPair : inputs) {
+                                    InputInfoMap &inputs,
+                                    bool useContentHashes) {
+  for (auto &inputPair : inputs) {
     auto recordedModTime = inputPair.second.previousModTime;
     if (recordedModTime == llvm::sys::TimeValue::MaxTime())
       continue;
@@ -166,15 +244,206 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
     }
 
     if (recordedModTime != inputStatus.getLastModificationTime()) {
+      uint64_t recordedHash = inputPair.second.previousContentHash;
+      uint64_t currentHash;
+      if (useContentHashes && recordedHash != 0 &&
+          !computeFileContentHash(input, currentHash) &&
+          currentHash == recordedHash) {
+        inputPair.second.previousModTime =
+            inputStatus.getLastModificationTime();
+        continue;
+      }
       diags.diagnose(SourceLoc(), diag::error_input_changed_during_build,
                      llvm::sys::path::filename(input));
     }
   }
 }
 
+/// Returns the input that the duration of \p Cmd is recorded under, or an
+/// empty string if it isn't a compile job.
+static StringRef getDurationKey(const Job *Cmd) {
+  auto *compileAction = dyn_cast<CompileJobAction>(&Cmd->getSource());
+  if (!compileAction)
+    return StringRef();
+  for (auto *action : compileAction->getInputs())
+    if (auto *inputFile = dyn_cast<InputAction>(action))
+      return inputFile->getInputArg().getValue();
+  return StringRef();
+}
+
+/// Reads the map under \p mapKey in the compilation record written by the
+/// previous build, if any, whose values are integers in the given \p radix.
+///
+/// The job durations are only used as estimates for scheduling, and the
+/// external dependency hashes are checked against the current contents, so
+/// they're read even if the rest of the record is out of date.
+static void readRecordedMap(StringRef path, StringRef mapKey, unsigned radix,
+                            llvm::StringMap<uint64_t> &values) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer)
+    return;
+
+  namespace yaml = llvm::yaml;
+  llvm::SourceMgr SM;
+  yaml::Stream stream(buffer.get()->getMemBufferRef(), SM);
+
+  auto I = stream.begin();
+  if (I == stream.end() || !I->getRoot())
+    return;
+
+  auto *topLevelMap = dyn_cast<yaml::MappingNode>(I->getRoot());
+  if (!topLevelMap)
+    return;
+  SmallString<64> keyScratch;
+  SmallString<64> valueScratch;
+
+  // FIXME: LLVM's YAML support does incremental parsing in such a way that
+  // for-range loops break.
+  for (auto i = topLevelMap->begin(), e = topLevelMap->end(); i != e; ++i) {
+    auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+    if (!key || key->getValue(keyScratch) != mapKey)
+      continue;
+
+    auto *valueMap = dyn_cast<yaml::MappingNode>(i->getValue());
+    if (!valueMap)
+      return;
+
+    for (auto i = valueMap->begin(), e = valueMap->end(); i != e; ++i) {
+      auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+      auto *value = dyn_cast<yaml::ScalarNode>(i->getValue());
+      if (!key || !value)
+        return;
+      uint64_t parsed;
+      if (value->getValue(valueScratch).getAsInteger(radix, parsed))
+        return;
+      values[key->getValue(keyScratch)] = parsed;
+    }
+  }
+}
+
+/// Orders \p commands so that the ones expected to take longest come first.
+///
+/// Starting long jobs first keeps the jobs that wait for all of them (such as
+/// merge-module and link) from waiting on a long job that happened to start
+/// last. Jobs without a recorded duration are assumed to take as long as the
+/// average job.
+static void sortByExpectedDuration(MutableArrayRef<const Job *> commands,
+                                   const JobDurationMap &durations) {
+  uint64_t total = 0;
+  size_t known = 0;
+  for (const Job *Cmd : commands) {
+    auto found = durations.find(getDurationKey(Cmd));
+    if (found != durations.end()) {
+      total += found->getValue();
+      ++known;
+    }
+  }
+  if (known == 0)
+    return;
+  uint64_t average = total / known;
+
+  auto expectedDuration = [&](const Job *Cmd) -> uint64_t {
+    auto found = durations.find(getDurationKey(Cmd));
+    return found != durations.end() ? found->getValue() : average;
+  };
+  std::stable_sort(commands.begin(), commands.end(),
+                   [&](const Job *lhs, const Job *rhs) {
+    return expectedDuration(lhs) > expectedDuration(rhs);
+  });
+}
+
+/// Writes the jobs that ran as complete events in Chrome's trace event format,
+/// one thread per parallel command slot.
+static void writeBuildTrace(StringRef path,
+                            ArrayRef<BuildTraceEvent> events) {
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // FIXME: How should we report this error?
+    out.clear_error();
+    return;
+  }
+
+  out << "{\"traceEvents\": [";
+  bool first = true;
+  for (auto &event : events) {
+    const Job *Cmd = event.Cmd;
+    out << (first ? "\n" : ",\n");
+    first = false;
+
+    out << "  {\"name\": \"" << Cmd->getSource().getClassName();
+    StringRef input = getDurationKey(Cmd);
+    if (!input.empty())
+      out << " " << llvm::yaml::escape(llvm::sys::path::filename(input));
+    out << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.Lane
+        << ", \"ts\": " << event.Begin << ", \"dur\": " << event.Duration
+        << "}";
+  }
+  out << "\n]}\n";
+}
+
+/// Returns the path of the statistics written by the frontend job with the
+/// given pid.
+static std::string getFrontendStatsPath(StringRef dir, ProcessId pid) {
+  SmallString<128> path(dir);
+  llvm::sys::path::append(path, "frontend-" + llvm::Twine(pid) + ".json");
+  return path.str();
+}
+
+/// Writes the totals of the statistics of all frontend jobs that ran.
+static void writeDriverStats(StringRef dir, const FrontendStats &totals) {
+  SmallString<128> path(dir);
+  llvm::sys::path::append(path, "driver-" +
+                                llvm::Twine(llvm::sys::Process::getProcessId()) +
+                                ".json");
+  std::error_code error;
+  llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
+  if (out.has_error()) {
+    // FIXME: How should we report this error?
+    out.clear_error();
+    return;
+  }
+  totals.writeJSON(out);
+}
+
+/// Computes the hashes of the external dependencies in \p graph, to be
+/// recorded for the next build.
+static void hashExternalDependencies(ContentHashMap &hashes,
+                                     const DependencyGraphImpl &graph,
+                                     const ContentHashMap &previousHashes,
+                                     llvm::sys::TimeValue lastBuildTime,
+                                     llvm::sys::TimeValue buildStartTime) {
+  auto buildEndTime = llvm::sys::TimeValue::now();
+  for (StringRef dependency : graph.getExternalDependencies()) {
+    llvm::sys::fs::file_status depStatus;
+    if (llvm::sys::fs::status(dependency, depStatus))
+      continue;
+
+    // A dependency modified while the build ran may not be what the jobs saw,
+    // so don't record a hash for it; the next build falls back to its mtime.
+    auto modTime = depStatus.getLastModificationTime();
+    if (modTime >= buildStartTime && modTime <= buildEndTime)
+      continue;
+
+    // One that hasn't been modified since the last build still has the hash
+    // recorded then.
+    auto previous = previousHashes.find(dependency);
+    if (modTime < lastBuildTime && previous != previousHashes.end()) {
+      hashes[dependency] = previous->getValue();
+      continue;
+    }
+
+    uint64_t hash;
+    if (!computeFileContentHash(dependency, hash))
+      hashes[dependency] = hash;
+  }
+}
+
 static void writeCompilationRecord(StringRef path, StringRef argsHash,
                                    llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+                                   const InputInfoMap &inputs,
+                                   const JobDurationMap &durations,
+                                   const ContentHashMap &externalHashes) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -210,9 +479,44 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
       break;
     }
 
-    writeTimeValue(out, entry.second.previousModTime);
+    uint64_t hash = entry.second.previousContentHash;
+    if (hash == 0) {
+      writeTimeValue(out, entry.second.previousModTime);
+    } else {
+      auto time = entry.second.previousModTime;
+      out << "[" << time.seconds() << ", " << time.nanoseconds() << ", \""
+          << llvm::format_hex_no_prefix(hash, 16) << "\"]";
+    }
     out << "\n";
   }
+
+  if (!externalHashes.empty()) {
+    // Sort the dependencies so that the record is deterministic.
+    std::vector<StringRef> dependencies;
+    for (auto &entry : externalHashes)
+      dependencies.push_back(entry.getKey());
+    std::sort(dependencies.begin(), dependencies.end());
+
+    out << "external_dependencies:\n";
+    for (StringRef dependency : dependencies) {
+      out << "  \"" << llvm::yaml::escape(dependency) << "\": \""
+          << llvm::format_hex_no_prefix(externalHashes.lookup(dependency), 16)
+          << "\"\n";
+    }
+  }
+
+  bool wroteDurationsKey = false;
+  for (auto &entry : inputs) {
+    auto found = durations.find(entry.first->getValue());
+    if (found == durations.end())
+      continue;
+    if (!wroteDurationsKey) {
+      out << "job_durations:\n";
+      wroteDurationsKey = true;
+    }
+    out << "  \"" << llvm::yaml::escape(entry.first->getValue()) << "\": "
+        << found->getValue() << "\n";
+  }
 }
 
 int Compilation::performJobsImpl() {
@@ -225,6 +529,24 @@ int Compilation::performJobsImpl() {
 
   PerformJobsState State;
 
+  // Durations from the previous build are the estimates for this one; the
+  // jobs that run now update them.
+  JobDurationMap JobDurations;
+  if (!CompilationRecordPath.empty())
+    readRecordedMap(CompilationRecordPath, "job_durations", 10, JobDurations);
+
+  // The hashes of external dependencies as of the previous build.
+  ContentHashMap PreviousExternalHashes;
+  if (!CompilationRecordPath.empty() && UseContentHashes)
+    readRecordedMap(CompilationRecordPath, "external_dependencies", 16,
+                    PreviousExternalHashes);
+
+  std::vector<BuildTraceEvent> BuildTrace;
+  SmallVector<bool, 16> BusyLanes;
+
+  // The totals of the statistics written by the frontend jobs.
+  FrontendStats JobStats;
+
   using DependencyGraph = DependencyGraph<const Job *>;
   DependencyGraph DepGraph;
   SmallPtrSet<const Job *, 16> DeferredCommands;
@@ -263,8 +585,18 @@ int Compilation::performJobsImpl() {
     }
 
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+    State.ReadyCommands.push_back(Cmd);
+  };
+
+  // Hand the ready jobs to the TaskQueue. With a single parallel command the
+  // order doesn't change how long the build takes, so it's kept as is.
+  auto startReadyCommands = [&] {
+    if (NumberOfParallelCommands > 1)
+      sortByExpectedDuration(State.ReadyCommands, JobDurations);
+    for (const Job *Cmd : State.ReadyCommands)
+      TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                  (void *)Cmd);
+    State.ReadyCommands.clear();
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -357,6 +689,23 @@ int Compilation::performJobsImpl() {
         if (depStatus.getLastModificationTime() < LastBuildTime)
           continue;
 
+      // A module that was rebuilt without changing its interface doesn't
+      // affect the files that import it.
+      StringRef interfaceHash = DepGraph.getExternalInterfaceHash(dependency);
+      if (!interfaceHash.empty() && hasInterfaceHash(dependency, interfaceHash))
+        continue;
+
+      // A dependency that was only touched since the last build is treated
+      // as unmodified.
+      if (UseContentHashes) {
+        auto previous = PreviousExternalHashes.find(dependency);
+        uint64_t currentHash;
+        if (previous != PreviousExternalHashes.end() &&
+            !computeFileContentHash(dependency, currentHash) &&
+            currentHash == previous->getValue())
+          continue;
+      }
+
       // If the dependency has been modified since the oldest built file,
       // or if we can't stat it for some reason (perhaps it's been deleted?),
       // trigger rebuilds through the dependency graph.
@@ -376,14 +725,49 @@ int Compilation::performJobsImpl() {
     }
   }
 
+  startReadyCommands();
+
   int Result = EXIT_SUCCESS;
 
+  // Record when a task began, and which of the parallel command slots it
+  // occupies.
+  auto noteTaskBegan = [&] (const Job *Cmd) {
+    auto Lane = std::find(BusyLanes.begin(), BusyLanes.end(), false);
+    if (Lane == BusyLanes.end())
+      Lane = BusyLanes.insert(BusyLanes.end(), false);
+    *Lane = true;
+    State.RunningCommands[Cmd] = { llvm::sys::TimeValue::now(),
+                                   unsigned(Lane - BusyLanes.begin()) };
+  };
+
+  // Record how long a task took, for the next build and for the build trace.
+  auto noteTaskEnded = [&] (const Job *Cmd) {
+    auto RunningIter = State.RunningCommands.find(Cmd);
+    if (RunningIter == State.RunningCommands.end())
+      return;
+    auto Running = RunningIter->second;
+    State.RunningCommands.erase(RunningIter);
+    BusyLanes[Running.Lane] = false;
+
+    llvm::sys::TimeValue Duration =
+        llvm::sys::TimeValue::now() - Running.BeginTime;
+    StringRef DurationKey = getDurationKey(Cmd);
+    if (!DurationKey.empty())
+      JobDurations[DurationKey] = Duration.msec();
+
+    if (!BuildTracePath.empty()) {
+      BuildTrace.push_back({Cmd, (Running.BeginTime - BuildStartTime).usec(),
+                            Duration.usec(), Running.Lane});
+    }
+  };
+
   // Set up a callback which will be called immediately after a task has
   // started. This callback may be used to provide output indicating that the
   // task began.
-  auto taskBegan = [this] (ProcessId Pid, void *Context) {
+  auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    noteTaskBegan(BeganCmd);
 
     // For verbose output, print out each command as it begins execution.
     if (Level == OutputLevel::Verbose)
@@ -398,13 +782,20 @@ int Compilation::performJobsImpl() {
   // it should also schedule any additional commands which we now know need
   // to run.
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
+                           const TaskResourceUsage &Usage,
                            void *Context) -> TaskFinishedResponse {
     const Job *FinishedCmd = (const Job *)Context;
+    noteTaskEnded(FinishedCmd);
+
+    // Jobs that aren't frontend invocations, or that failed early, don't
+    // write any statistics.
+    if (!StatsOutputDir.empty())
+      (void)JobStats.addFromFile(getFrontendStatsPath(StatsOutputDir, Pid));
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
       parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
-                                            ReturnCode, Output);
+                                            ReturnCode, Output, Usage);
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -472,17 +863,20 @@ int Compilation::performJobsImpl() {
       }
     }
 
+    startReadyCommands();
     return TaskFinishedResponse::ContinueExecution;
   };
 
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
+                            const TaskResourceUsage &Usage,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
+    noteTaskEnded(SignalledCmd);
 
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
       parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
-                                             ErrorMsg, Output);
+                                             ErrorMsg, Output, Usage);
     } else {
       // Otherwise, send the buffered output to stderr, though only if we
       // support getting buffered output.
@@ -503,9 +897,24 @@ int Compilation::performJobsImpl() {
     return TaskFinishedResponse::StopExecution;
   };
 
+  // Set up a callback which forwards the output of a task as it is produced,
+  // if that was requested. The finished and signalled callbacks then receive
+  // no output.
+  TaskQueue::TaskOutputCallback taskOutput;
+  if (StreamTaskOutput && TaskQueue::supportsStreamingOutput()) {
+    taskOutput = [&] (ProcessId Pid, StringRef Output, void *Context) {
+      const Job *OutputCmd = (const Job *)Context;
+      if (Level == OutputLevel::Parseable)
+        parseable_output::emitOutputMessage(llvm::errs(), *OutputCmd, Pid,
+                                            Output);
+      else
+        llvm::errs() << Output;
+    };
+  }
+
   do {
     // Ask the TaskQueue to execute.
-    TQ->execute(taskBegan, taskFinished, taskSignalled);
+    TQ->execute(taskBegan, taskFinished, taskSignalled, taskOutput);
 
     // Mark all remaining deferred commands as skipped.
     for (const Job *Cmd : DeferredCommands) {
@@ -520,6 +929,7 @@ int Compilation::performJobsImpl() {
     }
 
     // ...which may allow us to go on and do later tasks.
+    startReadyCommands();
   } while (Result == 0 && TQ->hasRemainingTasks());
 
   if (Result == 0) {
@@ -550,11 +960,36 @@ int Compilation::performJobsImpl() {
   if (!CompilationRecordPath.empty() && !SkipTaskExecution) {
     InputInfoMap InputInfo;
     populateInputInfoMap(InputInfo, State);
-    checkForOutOfDateInputs(Diags, InputInfo);
+    checkForOutOfDateInputs(Diags, InputInfo, UseContentHashes);
+
+    ContentHashMap ExternalHashes;
+    if (UseContentHashes) {
+      // Without an incremental build, the dependency graph was never loaded.
+      DependencyGraph FullGraph;
+      const DependencyGraph *Graph = &DepGraph;
+      if (!getIncrementalBuildEnabled()) {
+        for (const Job *Cmd : getJobs()) {
+          StringRef DependenciesFile =
+              Cmd->getOutput().getAdditionalOutputForType(types::TY_SwiftDeps);
+          if (!DependenciesFile.empty())
+            (void)FullGraph.loadFromPath(Cmd, DependenciesFile);
+        }
+        Graph = &FullGraph;
+      }
+      hashExternalDependencies(ExternalHashes, *Graph, PreviousExternalHashes,
+                               LastBuildTime, BuildStartTime);
+    }
+
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, JobDurations, ExternalHashes);
   }
 
+  if (!BuildTracePath.empty())
+    writeBuildTrace(BuildTracePath, BuildTrace);
+
+  if (!StatsOutputDir.empty() && !SkipTaskExecution)
+    writeDriverStats(StatsOutputDir, JobStats);
+
   if (Result == 0)
     Result = Diags.hadAnyError();
   return Result;
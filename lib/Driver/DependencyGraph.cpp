@@ -12,6 +12,7 @@
 
 #include "swift/Driver/DependencyGraph.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -48,12 +49,16 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using DeclInterfaceHashCallbackTy = LoadResult(StringRef, StringRef);
+using ExternalInterfaceHashCallbackTy = LoadResult(StringRef, StringRef);
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<DeclInterfaceHashCallbackTy> declInterfaceHashCallback,
+                    llvm::function_ref<ExternalInterfaceHashCallbackTy> externalInterfaceHashCallback) {
   namespace yaml = llvm::yaml;
 
   // FIXME: Switch to a format other than YAML.
@@ -93,6 +98,70 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       resultUpdate = interfaceHashCallback(valueString);
 
+    } else if (keyString == "decl-interface-hashes") {
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      // Entries are either ["name", "hash"] for top-level names and types, or
+      // ["{MangledBaseName}", "memberName", "hash"] for members.
+      resultUpdate = LoadResult::UpToDate;
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        SmallVector<std::string, 3> parts;
+        for (yaml::Node &rawPart : *entry) {
+          auto *part = dyn_cast<yaml::ScalarNode>(&rawPart);
+          if (!part)
+            return LoadResult::HadError;
+          parts.push_back(part->getValue(scratch));
+        }
+        if (parts.size() != 2 && parts.size() != 3)
+          return LoadResult::HadError;
+
+        // Smash the type and member names together to match the keys used
+        // for "provides-member".
+        SmallString<64> name;
+        name += parts[0];
+        if (parts.size() == 3) {
+          name.push_back('\0');
+          name += parts[1];
+        }
+
+        if (declInterfaceHashCallback(name.str(), parts.back()) ==
+              LoadResult::HadError)
+          return LoadResult::HadError;
+      }
+
+    } else if (keyString == "external-interface-hashes") {
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      // Entries are ["path", "hash"].
+      resultUpdate = LoadResult::UpToDate;
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        SmallVector<std::string, 2> parts;
+        for (yaml::Node &rawPart : *entry) {
+          auto *part = dyn_cast<yaml::ScalarNode>(&rawPart);
+          if (!part)
+            return LoadResult::HadError;
+          parts.push_back(part->getValue(scratch));
+        }
+        if (parts.size() != 2)
+          return LoadResult::HadError;
+
+        if (externalInterfaceHashCallback(parts[0], parts[1]) ==
+              LoadResult::HadError)
+          return LoadResult::HadError;
+      }
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -221,9 +290,12 @@ DependencyGraphImpl::loadFromString(const void *node, StringRef data) {
 LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
                                                llvm::MemoryBuffer &buffer) {
   auto &provides = Provides[node];
+  bool dependsAffectDownstream = false;
+  bool hasDeclInterfaceHashes = false;
+  llvm::StringMap<std::string> newDeclInterfaceHashes;
 
-  auto dependsCallback = [this, node](StringRef name, DependencyKind kind,
-                                      bool isCascading) -> LoadResult {
+  auto dependsCallback = [this, node, &dependsAffectDownstream](
+      StringRef name, DependencyKind kind, bool isCascading) -> LoadResult {
     if (kind == DependencyKind::ExternalFile)
       ExternalDependencies.insert(name);
 
@@ -244,8 +316,10 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
       iter->flags |= flags;
     }
 
-    if (isCascading && (entries.second & kind))
+    if (isCascading && (entries.second & kind)) {
+      dependsAffectDownstream = true;
       return LoadResult::AffectsDownstream;
+    }
     return LoadResult::UpToDate;
   };
 
@@ -284,8 +358,118 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  auto declInterfaceHashCallback =
+      [&hasDeclInterfaceHashes, &newDeclInterfaceHashes](
+          StringRef name, StringRef hash) -> LoadResult {
+    hasDeclInterfaceHashes = true;
+    newDeclInterfaceHashes[name] = hash;
+    return LoadResult::UpToDate;
+  };
+
+  auto externalInterfaceHashCallback =
+      [this](StringRef path, StringRef hash) -> LoadResult {
+    // If jobs were built against different versions of the module, the
+    // interface they saw is unknown.
+    auto insertResult =
+        ExternalInterfaceHashes.insert(std::make_pair(path, hash));
+    if (!insertResult.second && insertResult.first->getValue() != hash)
+      insertResult.first->getValue().clear();
+    return LoadResult::UpToDate;
+  };
+
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          declInterfaceHashCallback,
+                                          externalInterfaceHashCallback);
+  if (result == LoadResult::HadError)
+    return result;
+
+  // If the only thing that changed is the node's interface, and we know the
+  // interface of each declaration before and after, remember which
+  // declarations changed so that marking can skip the unaffected dependents.
+  ChangedDecls.erase(node);
+  auto oldHashes = DeclInterfaceHashes.find(node);
+  if (result == LoadResult::AffectsDownstream && !dependsAffectDownstream &&
+      hasDeclInterfaceHashes && oldHashes != DeclInterfaceHashes.end()) {
+    auto &changed = ChangedDecls[node];
+    for (auto &entry : oldHashes->second) {
+      auto newEntry = newDeclInterfaceHashes.find(entry.getKey());
+      if (newEntry == newDeclInterfaceHashes.end() ||
+          newEntry->getValue() != entry.getValue())
+        changed.insert(entry.getKey());
+    }
+    for (auto &entry : newDeclInterfaceHashes)
+      if (!oldHashes->second.count(entry.getKey()))
+        changed.insert(entry.getKey());
+  }
+
+  if (hasDeclInterfaceHashes)
+    DeclInterfaceHashes[node] = std::move(newDeclInterfaceHashes);
+  else
+    DeclInterfaceHashes.erase(node);
+
+  return result;
+}
+
+namespace {
+/// Answers whether a provided (kind, name) edge is affected by a set of
+/// changed declarations.
+class ChangedDeclFilter {
+  const llvm::StringSet<> &Changed;
+  /// Types that had at least one member change, or changed themselves.
+  llvm::StringSet<> ChangedTypes;
+  /// Names of members that changed, for AnyObject lookup.
+  llvm::StringSet<> ChangedMemberNames;
+
+public:
+  explicit ChangedDeclFilter(const llvm::StringSet<> &changed)
+      : Changed(changed) {
+    for (auto &entry : changed) {
+      StringRef name = entry.getKey();
+      size_t splitPoint = name.find('\0');
+      if (splitPoint == StringRef::npos) {
+        ChangedTypes.insert(name);
+        continue;
+      }
+      ChangedTypes.insert(name.slice(0, splitPoint));
+      ChangedMemberNames.insert(name.substr(splitPoint+1));
+    }
+  }
+
+  bool isAffected(StringRef name,
+                  OptionSet<DependencyGraphImpl::DependencyKind> kindMask) {
+    if (kindMask.contains(DependencyKind::ExternalFile))
+      return true;
+
+    if (kindMask.contains(DependencyKind::TopLevelName) ||
+        kindMask.contains(DependencyKind::NominalType)) {
+      if (Changed.count(name))
+        return true;
+    }
+
+    if (kindMask.contains(DependencyKind::NominalTypeMember)) {
+      size_t splitPoint = name.find('\0');
+      assert(splitPoint != StringRef::npos);
+      StringRef typeName = name.slice(0, splitPoint);
+      StringRef memberName = name.substr(splitPoint+1);
+      // An empty member name stands for all members of the type.
+      if (memberName.empty()) {
+        if (ChangedTypes.count(typeName))
+          return true;
+      } else if (Changed.count(name) || Changed.count(typeName)) {
+        return true;
+      }
+    }
+
+    if (kindMask.contains(DependencyKind::DynamicLookupName)) {
+      if (ChangedMemberNames.count(name))
+        return true;
+    }
+
+    return false;
+  }
+};
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -320,13 +504,29 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
+  // If we know exactly which declarations of the starting node changed, only
+  // follow its edges for those. This only applies once.
+  llvm::StringSet<> changedDecls;
+  Optional<ChangedDeclFilter> filter;
+  auto changedIter = ChangedDecls.find(node);
+  if (changedIter != ChangedDecls.end()) {
+    changedDecls = std::move(changedIter->second);
+    ChangedDecls.erase(changedIter);
+    filter.emplace(changedDecls);
+  }
+
   auto addDependentsToWorklist = [&](const void *next,
-                                     ArrayRef<MarkTracerImpl::Entry> reason) {
+                                     ArrayRef<MarkTracerImpl::Entry> reason,
+                                     bool applyFilter) {
     auto allProvided = Provides.find(next);
     if (allProvided == Provides.end())
       return;
 
     for (const auto &provided : allProvided->second) {
+      if (applyFilter && filter &&
+          !filter->isAffected(provided.name, provided.kindMask))
+        continue;
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -373,7 +573,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
 
   // Always mark through the starting node, even if it's already marked.
   markIntransitive(node);
-  addDependentsToWorklist(node, {});
+  addDependentsToWorklist(node, {}, /*applyFilter=*/true);
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
@@ -385,7 +585,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       continue;
     }
 
-    addDependentsToWorklist(next.Node, next.Reason);
+    addDependentsToWorklist(next.Node, next.Reason, /*applyFilter=*/false);
     if (!markIntransitive(next.Node))
       continue;
     record(next);
@@ -52,6 +52,7 @@
 #include "llvm/Support/raw_ostream.h"
 
 #include <memory>
+#include <thread>
 
 using namespace swift;
 using namespace swift::driver;
@@ -210,8 +211,11 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
   bool versionValid = false;
   bool optionsMatch = true;
 
+  // Reads "[seconds, nanoseconds]". If \p contentHash is non-null, the
+  // sequence may also contain a hash of the input's contents, in hex.
   auto readTimeValue = [&scratch](yaml::Node *node,
-                                  llvm::sys::TimeValue &timeValue) -> bool {
+                                  llvm::sys::TimeValue &timeValue,
+                                  uint64_t *contentHash) -> bool {
     auto *seq = dyn_cast<yaml::SequenceNode>(node);
     if (!seq)
       return true;
@@ -241,6 +245,14 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
       return true;
 
     ++seqI;
+    if (contentHash && seqI != seqE) {
+      auto *hashRaw = dyn_cast<yaml::ScalarNode>(&*seqI);
+      if (!hashRaw)
+        return true;
+      if (hashRaw->getValue(scratch).getAsInteger(16, *contentHash))
+        return true;
+      ++seqI;
+    }
     if (seqI != seqE)
       return true;
 
@@ -273,7 +285,7 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
       if (!value)
         return true;
       llvm::sys::TimeValue timeVal;
-      if (readTimeValue(i->getValue(), timeVal))
+      if (readTimeValue(i->getValue(), timeVal, nullptr))
         return true;
       map[nullptr] = { InputInfo::NeedsCascadingBuild, timeVal };
 
@@ -304,11 +316,13 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
           return true;
 
         llvm::sys::TimeValue timeValue;
-        if (readTimeValue(value, timeValue))
+        uint64_t contentHash = 0;
+        if (readTimeValue(value, timeValue, &contentHash))
           return true;
 
         auto inputName = key->getValue(scratch);
-        previousInputs[inputName] = { *previousBuildState, timeValue };
+        previousInputs[inputName] = { *previousBuildState, timeValue,
+                                      contentHash };
       }
     }
   }
@@ -507,6 +521,18 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_driver_build_trace))
+    C->setBuildTracePath(A->getValue());
+
+  if (C->getArgs().hasArg(options::OPT_driver_stream_output))
+    C->setStreamsTaskOutput();
+
+  if (C->getArgs().hasArg(options::OPT_incremental_content_hashes))
+    C->setUsesContentHashes();
+
+  if (const Arg *A = C->getArgs().getLastArg(options::OPT_stats_output_dir))
+    C->setStatsOutputDir(A->getValue());
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -998,6 +1024,11 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
     return;
   }
 
+  OI.ShouldEmitModuleSeparately =
+      OI.ShouldGenerateModule &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile &&
+      Args.hasArg(options::OPT_emit_module_separately);
+
   if (const Arg *A = Args.getLastArg(options::OPT_module_name)) {
     OI.ModuleName = A->getValue();
   } else if (OI.CompilerMode == OutputInfo::Mode::REPL) {
@@ -1037,6 +1068,50 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
     OI.ShouldGenerateFixitEdits = true;
   }
 
+  if (Args.hasArg(options::OPT_enable_batch_mode) &&
+      OI.CompilerMode == OutputInfo::Mode::StandardCompile) {
+    // Batches are formed before any job runs, so batch mode can't be used
+    // when the driver decides job-by-job what to rebuild, or with outputs
+    // that the frontend only supports for a single primary file.
+    const Arg *Conflict =
+        Args.getLastArg(options::OPT_incremental, options::OPT_num_threads,
+                        options::OPT_embed_bitcode,
+                        options::OPT_serialize_diagnostics,
+                        options::OPT_emit_dependencies,
+                        options::OPT_fixit_code);
+    if (!Conflict) {
+      switch (OI.CompilerOutputType) {
+      case types::TY_Object:
+      case types::TY_Assembly:
+      case types::TY_LLVM_IR:
+      case types::TY_LLVM_BC:
+      case types::TY_SIL:
+      case types::TY_RawSIL:
+        break;
+      default:
+        Conflict = OutputModeArg;
+        if (!Conflict)
+          Conflict = Args.getLastArg(options::OPT_emit_module,
+                                     options::OPT_emit_module_path);
+        assert(Conflict && "output type chosen without an option");
+        break;
+      }
+    }
+
+    if (Conflict) {
+      Diags.diagnose(SourceLoc(), diag::warning_batch_mode_ignored,
+                     Conflict->getSpelling());
+    } else {
+      // Make one batch per parallel job, so that -j keeps its meaning.
+      unsigned NumBatches = 0;
+      if (const Arg *A = Args.getLastArg(options::OPT_j))
+        (void)StringRef(A->getValue()).getAsInteger(10, NumBatches);
+      if (NumBatches == 0)
+        NumBatches = std::max(std::thread::hardware_concurrency(), 1U);
+      OI.numBatches = NumBatches;
+    }
+  }
+
   {
     if (const Arg *A = Args.getLastArg(options::OPT_sdk)) {
       OI.SDKPath = A->getValue();
@@ -1112,6 +1187,69 @@ void Driver::buildActions(const ToolChain &TC,
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
+    // In batch mode, runs of consecutive Swift inputs share a compile job.
+    unsigned BatchSize = 0;
+    if (OI.isBatchMode()) {
+      unsigned NumSwiftInputs =
+          std::count_if(Inputs.begin(), Inputs.end(),
+                        [](const InputPair &Input) {
+                          return Input.first == types::TY_Swift;
+                        });
+      BatchSize = (NumSwiftInputs + OI.numBatches - 1) / OI.numBatches;
+    }
+    Action *CurrentBatch = nullptr;
+    unsigned CurrentBatchSize = 0;
+
+    // Precompile the bridging header once, and have every compile job import
+    // the PCH rather than re-parsing the header.
+    Action *BridgingPCH = nullptr;
+    bool OwnsBridgingPCH = false;
+    if (Args.hasArg(options::OPT_enable_bridging_pch)) {
+      if (const Arg *A = Args.getLastArg(options::OPT_import_objc_header)) {
+        StringRef Value = A->getValue();
+        if (TC.lookupTypeForExtension(llvm::sys::path::extension(Value)) ==
+            types::TY_ObjCHeader) {
+          BridgingPCH =
+              new GeneratePCHJobAction(new InputAction(*A,
+                                                       types::TY_ObjCHeader));
+        }
+      }
+    }
+
+    // Load the imports of all the Swift inputs in a single job before any
+    // compile job starts, so that the Clang modules missing from the module
+    // cache are built once instead of by every compile job at the same time.
+    // After a previous build the cache is already populated.
+    Action *ResolveImports = nullptr;
+    bool OwnsResolveImports = false;
+    if (Args.hasArg(options::OPT_prebuild_clang_modules) && !OutOfDateMap) {
+      ActionList SwiftInputs;
+      for (const InputPair &Input : Inputs)
+        if (Input.first == types::TY_Swift)
+          SwiftInputs.push_back(new InputAction(*Input.second, Input.first));
+      if (SwiftInputs.size() > 1)
+        ResolveImports = new ResolveImportsJobAction(SwiftInputs);
+      else
+        llvm::DeleteContainerPointers(SwiftInputs);
+    }
+
+    // The first compile job owns each job that all of them depend on; the
+    // others share it.
+    auto addSharedJob = [](Action *CA, Action *Job, bool &Owned) {
+      if (!Job)
+        return;
+      if (Owned) {
+        CA->addSharedInput(Job);
+      } else {
+        CA->addInput(Job);
+        Owned = true;
+      }
+    };
+    auto addSharedJobs = [&](Action *CA) {
+      addSharedJob(CA, BridgingPCH, OwnsBridgingPCH);
+      addSharedJob(CA, ResolveImports, OwnsResolveImports);
+    };
+
     for (const InputPair &Input : Inputs) {
       types::ID InputType = Input.first;
       const Arg *InputArg = Input.second;
@@ -1121,6 +1259,26 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_Swift:
       case types::TY_SIL:
       case types::TY_SIB: {
+        if (BatchSize > 0 && InputType == types::TY_Swift) {
+          if (!CurrentBatch || CurrentBatchSize == BatchSize) {
+            CurrentBatch = new CompileJobAction(OI.CompilerOutputType);
+            addSharedJobs(CurrentBatch);
+            CurrentBatchSize = 0;
+            if (!OI.ShouldEmitModuleSeparately)
+              AllModuleInputs.push_back(CurrentBatch);
+            AllLinkerInputs.push_back(CurrentBatch);
+          }
+          if (OI.ShouldEmitModuleSeparately)
+            AllModuleInputs.push_back(Current.get());
+          CurrentBatch->addInput(Current.release());
+          ++CurrentBatchSize;
+          break;
+        }
+
+        // When the module is emitted separately, it's built from the source
+        // files rather than from the compile jobs' partial modules.
+        Action *ModuleInput = Current.get();
+
         // Source inputs always need to be compiled.
         CompileJobAction::InputInfo previousBuildState = {
           CompileJobAction::InputInfo::NeedsCascadingBuild,
@@ -1132,14 +1290,20 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
-          AllModuleInputs.push_back(Current.get());
+          addSharedJobs(Current.get());
+          if (!OI.ShouldEmitModuleSeparately)
+            ModuleInput = Current.get();
+          AllModuleInputs.push_back(ModuleInput);
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
         } else {
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
-          AllModuleInputs.push_back(Current.get());
+          addSharedJobs(Current.get());
+          if (!OI.ShouldEmitModuleSeparately)
+            ModuleInput = Current.get();
+          AllModuleInputs.push_back(ModuleInput);
         }
         AllLinkerInputs.push_back(Current.release());
         break;
@@ -1171,6 +1335,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1392,8 +1557,10 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
           Type != types::TY_dSYM) {
         // Multi-threading compilation has multiple outputs, except those
         // outputs which are produced before the llvm passes (e.g. emit-sil).
-        if (OI.isMultiThreading() && isa<CompileJobAction>(A) &&
-            types::isAfterLLVM(A->getType())) {
+        // Batch mode compilation always has one output per input.
+        if (isa<CompileJobAction>(A) &&
+            (OI.isBatchMode() || (OI.isMultiThreading() &&
+                                  types::isAfterLLVM(A->getType())))) {
           NumOutputs += A->size();
         } else {
           ++NumOutputs;
@@ -1566,9 +1733,19 @@ static void addAuxiliaryOutput(Compilation &C, CommandOutput &output,
 
 /// If the file at \p input has not been modified since the last build (i.e. its
 /// mtime has not changed), adjust the Job's condition accordingly.
+///
+/// With \p useContentHashes, a file whose mtime changed but whose contents
+/// hash to the value recorded in the last build is not considered modified.
 static void
 handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
-                          StringRef input, bool alwaysRebuildDependents) {
+                          StringRef input, bool alwaysRebuildDependents,
+                          bool useContentHashes) {
+  // When using content hashes, record the hash of every input, so that the
+  // next build can compare against it.
+  uint64_t contentHash = 0;
+  if (useContentHashes && !computeFileContentHash(input, contentHash))
+    J->setInputContentHash(contentHash);
+
   if (inputInfo.status == CompileJobAction::InputInfo::NewlyAdded) {
     J->setCondition(Job::Condition::NewlyAdded);
     return;
@@ -1584,8 +1761,11 @@ handleCompileJobCondition(Job *J, CompileJobAction::InputInfo inputInfo,
     return;
 
   J->setInputModTime(inputStatus.getLastModificationTime());
-  if (J->getInputModTime() != inputInfo.previousModTime)
-    return;
+  if (J->getInputModTime() != inputInfo.previousModTime) {
+    // A file that was only touched is treated as unmodified.
+    if (contentHash == 0 || contentHash != inputInfo.previousContentHash)
+      return;
+  }
 
   Job::Condition condition;
   switch (inputInfo.status) {
@@ -1665,10 +1845,13 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
   llvm::SmallString<128> Buf;
   StringRef OutputFile;
 
-  if (OI.isMultiThreading() && isa<CompileJobAction>(JA) &&
-      types::isAfterLLVM(JA->getType())) {
-    // Multi-threaded compilation: A single frontend command produces multiple
-    // output file: one for each input files.
+  bool HasOutputPerInput =
+      isa<CompileJobAction>(JA) &&
+      (OI.isBatchMode() ||
+       (OI.isMultiThreading() && types::isAfterLLVM(JA->getType())));
+  if (HasOutputPerInput) {
+    // Multi-threaded or batch mode compilation: A single frontend command
+    // produces multiple output file: one for each input files.
     auto OutputFunc = [&](StringRef Input) {
       const TypeToPathMap *OMForInput = nullptr;
       if (OFM)
@@ -1685,8 +1868,13 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
       OutputFunc(IA->getInputArg().getValue());
 
     }
-    // Add an output file for each input job.
+    // Add an output file for each input job, other than the bridging PCH and
+    // the job loading the imports, which every primary file depends on
+    // rather than being one.
     for (const Job *job : InputJobs) {
+      types::ID InputJobType = job->getOutput().getPrimaryOutputType();
+      if (InputJobType == types::TY_PCH || InputJobType == types::TY_Nothing)
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
@@ -1697,8 +1885,59 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
     Output->addPrimaryOutput(OutputFile, BaseInput);
   }
 
+  // In batch mode, each primary file gets its own partial module and module
+  // doc file, which the merge-module job combines as usual.
+  if (OI.ShouldGenerateModule && isa<CompileJobAction>(JA) &&
+      OI.isBatchMode() && !OI.ShouldEmitModuleSeparately) {
+    auto getPathFromOutputMap = [&](StringRef Input,
+                                    types::ID Type) -> StringRef {
+      if (!OFM)
+        return StringRef();
+      const TypeToPathMap *OMForInput = OFM->getOutputMapForInput(Input);
+      if (!OMForInput)
+        return StringRef();
+      auto iter = OMForInput->find(Type);
+      if (iter == OMForInput->end())
+        return StringRef();
+      return iter->second;
+    };
+
+    for (size_t i = 0, e = Output->getPrimaryOutputFilenames().size(); i != e;
+         ++i) {
+      StringRef Input = Output->getBaseInput(i);
+
+      llvm::SmallString<128> ModulePath(
+          getPathFromOutputMap(Input, types::TY_SwiftModuleFile));
+      if (ModulePath.empty()) {
+        ModulePath = Output->getPrimaryOutputFilenames()[i];
+        bool isTempFile = C.isTemporaryFile(ModulePath);
+        llvm::sys::path::replace_extension(ModulePath,
+                                           SERIALIZED_MODULE_EXTENSION);
+        if (isTempFile)
+          C.addTemporaryFile(ModulePath);
+      }
+
+      llvm::SmallString<128> DocPath(
+          getPathFromOutputMap(Input, types::TY_SwiftModuleDocFile));
+      if (DocPath.empty()) {
+        DocPath = ModulePath;
+        bool isTempFile = C.isTemporaryFile(DocPath);
+        llvm::sys::path::replace_extension(DocPath,
+                                           SERIALIZED_MODULE_DOC_EXTENSION);
+        if (isTempFile)
+          C.addTemporaryFile(DocPath);
+      }
+
+      Output->addAdditionalOutputForType(types::TY_SwiftModuleFile,
+                                         ModulePath);
+      Output->addAdditionalOutputForType(types::TY_SwiftModuleDocFile,
+                                         DocPath);
+    }
+  }
+
   // Choose the swiftmodule output path.
   if (OI.ShouldGenerateModule && isa<CompileJobAction>(JA) &&
+      !OI.isBatchMode() && !OI.ShouldEmitModuleSeparately &&
       Output->getPrimaryOutputType() != types::TY_SwiftModuleFile) {
     StringRef OFMModuleOutputPath;
     if (OutputMap) {
@@ -1750,7 +1989,9 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
 
   // Choose the swiftdoc output path.
   if (OI.ShouldGenerateModule &&
-      (isa<CompileJobAction>(JA) || isa<MergeModuleJobAction>(JA))) {
+      ((isa<CompileJobAction>(JA) && !OI.isBatchMode() &&
+        !OI.ShouldEmitModuleSeparately) ||
+       isa<MergeModuleJobAction>(JA))) {
     StringRef OFMModuleDocOutputPath;
     if (OutputMap) {
       auto iter = OutputMap->find(types::TY_SwiftModuleDocFile);
@@ -1869,8 +2110,10 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
       auto compileJob = cast<CompileJobAction>(A);
       bool alwaysRebuildDependents =
           C.getArgs().hasArg(options::OPT_driver_always_rebuild_dependents);
+      bool useContentHashes =
+          C.getArgs().hasArg(options::OPT_incremental_content_hashes);
       handleCompileJobCondition(J, compileJob->getInputInfo(), BaseInput,
-                                alwaysRebuildDependents);
+                                alwaysRebuildDependents, useContentHashes);
     }
   }
 
@@ -1912,11 +2155,12 @@ Job *Driver::buildJobsForAction(Compilation &C, const Action *A,
                [] { llvm::outs() << ", "; });
 
     types::forAllTypes([&J](types::ID Ty) {
-      StringRef AdditionalOutput =
-        J->getOutput().getAdditionalOutputForType(Ty);
-      if (!AdditionalOutput.empty()) {
-        llvm::outs() << ", " << types::getTypeName(Ty) << ": \""
-          << AdditionalOutput << '"';
+      for (StringRef AdditionalOutput :
+           J->getOutput().getAdditionalOutputsForType(Ty)) {
+        if (!AdditionalOutput.empty()) {
+          llvm::outs() << ", " << types::getTypeName(Ty) << ": \""
+            << AdditionalOutput << '"';
+        }
       }
     });
     llvm::outs() << '}';
@@ -22,19 +22,34 @@ using namespace swift::driver;
 
 void CommandOutput::setAdditionalOutputForType(types::ID type,
                                                StringRef OutputFilename) {
-  AdditionalOutputsMap[type] = OutputFilename;
+  auto &outputs = AdditionalOutputsMap[type];
+  outputs.clear();
+  outputs.push_back(OutputFilename);
 }
 
 const std::string &
 CommandOutput::getAdditionalOutputForType(types::ID type) const {
   auto iter = AdditionalOutputsMap.find(type);
-  if (iter != AdditionalOutputsMap.end())
-    return iter->second;
+  if (iter != AdditionalOutputsMap.end() && !iter->second.empty())
+    return iter->second.front();
 
   static const std::string empty;
   return empty;
 }
 
+void CommandOutput::addAdditionalOutputForType(types::ID type,
+                                               StringRef OutputFilename) {
+  AdditionalOutputsMap[type].push_back(OutputFilename);
+}
+
+ArrayRef<std::string>
+CommandOutput::getAdditionalOutputsForType(types::ID type) const {
+  auto iter = AdditionalOutputsMap.find(type);
+  if (iter != AdditionalOutputsMap.end())
+    return iter->second;
+  return {};
+}
+
 const std::string &
 CommandOutput::getAnyOutputForType(types::ID type) const {
   if (PrimaryOutputType == type)
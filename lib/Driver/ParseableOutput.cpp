@@ -133,10 +133,11 @@ public:
       }
     }
     types::forAllTypes([&](types::ID Ty) {
-      const std::string &Output =
-          Cmd.getOutput().getAdditionalOutputForType(Ty);
-      if (!Output.empty())
-        Outputs.push_back(OutputPair(Ty, Output));
+      for (const std::string &Output :
+           Cmd.getOutput().getAdditionalOutputsForType(Ty)) {
+        if (!Output.empty())
+          Outputs.push_back(OutputPair(Ty, Output));
+      }
     });
   }
 
@@ -185,30 +186,47 @@ public:
   }
 };
 
-class FinishedMessage : public TaskOutputMessage {
+class TaskExitedMessage : public TaskOutputMessage {
+  TaskResourceUsage Usage;
+public:
+  TaskExitedMessage(StringRef Kind, const Job &Cmd, ProcessId Pid,
+                    StringRef Output, const TaskResourceUsage &Usage) :
+      TaskOutputMessage(Kind, Cmd, Pid, Output), Usage(Usage) {}
+
+  virtual void provideMapping(swift::json::Output &out) {
+    TaskOutputMessage::provideMapping(out);
+    if (Usage.Valid) {
+      out.mapRequired("user-time-usec", Usage.UserTimeUSec);
+      out.mapRequired("system-time-usec", Usage.SystemTimeUSec);
+      out.mapRequired("max-rss-bytes", Usage.MaxResidentSetBytes);
+    }
+  }
+};
+
+class FinishedMessage : public TaskExitedMessage {
   int ExitStatus;
 public:
   FinishedMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
-                  int ExitStatus) : TaskOutputMessage("finished", Cmd, Pid,
-                                                      Output),
-                                    ExitStatus(ExitStatus) {}
+                  int ExitStatus, const TaskResourceUsage &Usage) :
+      TaskExitedMessage("finished", Cmd, Pid, Output, Usage),
+      ExitStatus(ExitStatus) {}
 
   virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
+    TaskExitedMessage::provideMapping(out);
     out.mapRequired("exit-status", ExitStatus);
   }
 };
 
-class SignalledMessage : public TaskOutputMessage {
+class SignalledMessage : public TaskExitedMessage {
   std::string ErrorMsg;
 public:
   SignalledMessage(const Job &Cmd, ProcessId Pid, StringRef Output,
-                   StringRef ErrorMsg) : TaskOutputMessage("signalled", Cmd,
-                                                           Pid, Output),
-                                         ErrorMsg(ErrorMsg) {}
+                   StringRef ErrorMsg, const TaskResourceUsage &Usage) :
+      TaskExitedMessage("signalled", Cmd, Pid, Output, Usage),
+      ErrorMsg(ErrorMsg) {}
 
   virtual void provideMapping(swift::json::Output &out) {
-    TaskOutputMessage::provideMapping(out);
+    TaskExitedMessage::provideMapping(out);
     out.mapOptional("error-message", ErrorMsg, std::string());
   }
 };
@@ -250,18 +268,27 @@ void parseable_output::emitBeganMessage(raw_ostream &os,
   emitMessage(os, msg);
 }
 
+void parseable_output::emitOutputMessage(raw_ostream &os,
+                                         const Job &Cmd, ProcessId Pid,
+                                         StringRef Output) {
+  TaskOutputMessage msg("output", Cmd, Pid, Output);
+  emitMessage(os, msg);
+}
+
 void parseable_output::emitFinishedMessage(raw_ostream &os,
                                            const Job &Cmd, ProcessId Pid,
-                                           int ExitStatus, StringRef Output) {
-  FinishedMessage msg(Cmd, Pid, Output, ExitStatus);
+                                           int ExitStatus, StringRef Output,
+                                           const TaskResourceUsage &Usage) {
+  FinishedMessage msg(Cmd, Pid, Output, ExitStatus, Usage);
   emitMessage(os, msg);
 }
 
 void parseable_output::emitSignalledMessage(raw_ostream &os,
                                             const Job &Cmd, ProcessId Pid,
                                             StringRef ErrorMsg,
-                                            StringRef Output) {
-  SignalledMessage msg(Cmd, Pid, Output, ErrorMsg);
+                                            StringRef Output,
+                                            const TaskResourceUsage &Usage) {
+  SignalledMessage msg(Cmd, Pid, Output, ErrorMsg, Usage);
   emitMessage(os, msg);
 }
 
@@ -55,6 +55,8 @@ ToolChain::constructJob(const JobAction &JA,
   CASE(ModuleWrapJob)
   CASE(LinkJob)
   CASE(GenerateDSYMJob)
+  CASE(GeneratePCHJob)
+  CASE(ResolveImportsJob)
   CASE(AutolinkExtractJob)
   CASE(REPLJob)
 #undef CASE
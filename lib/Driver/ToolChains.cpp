@@ -25,6 +25,7 @@
 #include "swift/Config.h"
 #include "clang/Basic/Version.h"
 #include "clang/Driver/Util.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
@@ -54,9 +55,16 @@ static void addInputsOfType(ArgStringList &Arguments,
                             ArrayRef<const Job *> Jobs,
                             types::ID InputType) {
   for (const Job *Cmd : Jobs) {
-    auto &output = Cmd->getOutput().getAnyOutputForType(InputType);
-    if (!output.empty())
-      Arguments.push_back(output.c_str());
+    const CommandOutput &output = Cmd->getOutput();
+    if (output.getPrimaryOutputType() == InputType) {
+      Arguments.push_back(output.getPrimaryOutputFilenames()[0].c_str());
+      continue;
+    }
+    for (const std::string &additional :
+         output.getAdditionalOutputsForType(InputType)) {
+      if (!additional.empty())
+        Arguments.push_back(additional.c_str());
+    }
   }
 }
 
@@ -73,11 +81,28 @@ static void addPrimaryInputsOfType(ArgStringList &Arguments,
   }
 }
 
+/// Passes on the bridging header, preferring a precompiled form of it if one
+/// of \p inputs produced one.
+static void addBridgingHeaderArg(ArrayRef<const Job *> inputs,
+                                 const ArgList &inputArgs,
+                                 ArgStringList &arguments) {
+  for (const Job *input : inputs) {
+    const CommandOutput &output = input->getOutput();
+    if (output.getPrimaryOutputType() == types::TY_PCH) {
+      arguments.push_back("-import-objc-header");
+      arguments.push_back(output.getPrimaryOutputFilename().c_str());
+      return;
+    }
+  }
+  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
+}
+
 /// Handle arguments common to all invocations of the frontend (compilation,
 /// module-merging, LLDB's REPL, etc).
 static void addCommonFrontendArgs(const ToolChain &TC,
                                   const OutputInfo &OI,
                                   const CommandOutput &output,
+                                  ArrayRef<const Job *> inputs,
                                   const ArgList &inputArgs,
                                   ArgStringList &arguments) {
   arguments.push_back("-target");
@@ -113,10 +138,11 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_autolink_force_load);
   inputArgs.AddLastArg(arguments, options::OPT_color_diagnostics);
   inputArgs.AddLastArg(arguments, options::OPT_fixit_all);
+  inputArgs.AddLastArg(arguments, options::OPT_stats_output_dir);
   inputArgs.AddLastArg(arguments, options::OPT_enable_app_extension);
   inputArgs.AddLastArg(arguments, options::OPT_enable_testing);
   inputArgs.AddLastArg(arguments, options::OPT_g_Group);
-  inputArgs.AddLastArg(arguments, options::OPT_import_objc_header);
+  addBridgingHeaderArg(inputs, inputArgs, arguments);
   inputArgs.AddLastArg(arguments, options::OPT_import_underlying_module);
   inputArgs.AddLastArg(arguments, options::OPT_module_cache_path);
   inputArgs.AddLastArg(arguments, options::OPT_module_link_name);
@@ -126,6 +152,8 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddLastArg(arguments, options::OPT_solver_memory_threshold);
   inputArgs.AddLastArg(arguments, options::OPT_profile_generate);
   inputArgs.AddLastArg(arguments, options::OPT_profile_coverage_mapping);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_thread_local_counters);
+  inputArgs.AddLastArg(arguments, options::OPT_profile_use);
 
   // Pass on any build config options
   inputArgs.AddAllArgs(arguments, options::OPT_D);
@@ -137,9 +165,10 @@ static void addCommonFrontendArgs(const ToolChain &TC,
   inputArgs.AddAllArgs(arguments, options::OPT_Xllvm);
   inputArgs.AddAllArgs(arguments, options::OPT_Xcc);
 
-  const std::string &moduleDocOutputPath =
-      output.getAdditionalOutputForType(types::TY_SwiftModuleDocFile);
-  if (!moduleDocOutputPath.empty()) {
+  for (const std::string &moduleDocOutputPath :
+       output.getAdditionalOutputsForType(types::TY_SwiftModuleDocFile)) {
+    if (moduleDocOutputPath.empty())
+      continue;
     arguments.push_back("-emit-module-doc-path");
     arguments.push_back(moduleDocOutputPath.c_str());
   }
@@ -204,6 +233,7 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -231,28 +261,33 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   
   Arguments.push_back(FrontendModeOption);
 
-  assert(context.Inputs.empty() &&
-         "The Swift frontend does not expect to be fed any input Jobs!");
+  assert(std::all_of(context.Inputs.begin(), context.Inputs.end(),
+                     [](const Job *input) {
+    types::ID type = input->getOutput().getPrimaryOutputType();
+    return type == types::TY_PCH || type == types::TY_Nothing;
+  }) && "The Swift frontend only expects a bridging PCH or the job loading "
+         "its imports as an input Job!");
 
   // Add input arguments.
   switch (context.OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
-    assert(context.InputActions.size() == 1 &&
+    assert((context.InputActions.size() == 1 || context.OI.isBatchMode()) &&
            "The Swift frontend expects exactly one input (the primary file)!");
 
-    auto *IA = cast<InputAction>(context.InputActions[0]);
-    const Arg &PrimaryInputArg = IA->getInputArg();
-    bool FoundPrimaryInput = false;
+    // In batch mode there is one primary file for each input action.
+    llvm::SmallDenseSet<unsigned, 4> PrimaryInputIndices;
+    for (const Action *A : context.InputActions) {
+      auto *IA = cast<InputAction>(A);
+      PrimaryInputIndices.insert(IA->getInputArg().getIndex());
+    }
 
     for (auto *A : make_range(context.Args.filtered_begin(options::OPT_INPUT),
                               context.Args.filtered_end())) {
       // See if this input should be passed with -primary-file.
       // FIXME: This will pick up non-source inputs too, like .o files.
-      if (!FoundPrimaryInput && PrimaryInputArg.getIndex() == A->getIndex()) {
+      if (PrimaryInputIndices.erase(A->getIndex()))
         Arguments.push_back("-primary-file");
-        FoundPrimaryInput = true;
-      }
       Arguments.push_back(A->getValue());
     }
     break;
@@ -272,11 +307,12 @@ ToolChain::constructInvocation(const CompileJobAction &job,
   if (context.Args.hasArg(options::OPT_parse_stdlib))
     Arguments.push_back("-disable-objc-attr-requires-foundation-module");
 
-  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
-                        Arguments);
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                        context.Args, Arguments);
 
   // Pass the optimization level down to the frontend.
   context.Args.AddLastArg(Arguments, options::OPT_O_Group);
+  context.Args.AddLastArg(Arguments, options::OPT_object_cache_path);
 
   if (context.Args.hasArg(options::OPT_parse_as_library) ||
       context.Args.hasArg(options::OPT_emit_library))
@@ -300,9 +336,10 @@ ToolChain::constructInvocation(const CompileJobAction &job,
     break;
   }
 
-  const std::string &ModuleOutputPath =
-    context.Output.getAdditionalOutputForType(types::ID::TY_SwiftModuleFile);
-  if (!ModuleOutputPath.empty()) {
+  for (const std::string &ModuleOutputPath :
+       context.Output.getAdditionalOutputsForType(types::TY_SwiftModuleFile)) {
+    if (ModuleOutputPath.empty())
+      continue;
     Arguments.push_back("-emit-module-path");
     Arguments.push_back(ModuleOutputPath.c_str());
   }
@@ -421,6 +458,7 @@ ToolChain::constructInvocation(const BackendJobAction &job,
     case types::TY_Dependencies:
     case types::TY_SwiftModuleDocFile:
     case types::TY_ClangModuleFile:
+    case types::TY_PCH:
     case types::TY_SerializedDiagnostics:
     case types::TY_ObjCHeader:
     case types::TY_Image:
@@ -519,22 +557,42 @@ ToolChain::constructInvocation(const MergeModuleJobAction &job,
   // mode options.
   Arguments.push_back("-emit-module");
 
-  size_t origLen = Arguments.size();
-  (void)origLen;
-  addInputsOfType(Arguments, context.Inputs, types::TY_SwiftModuleFile);
-  addInputsOfType(Arguments, context.InputActions, types::TY_SwiftModuleFile);
-  assert(Arguments.size() - origLen >=
-         context.Inputs.size() + context.InputActions.size());
-  assert((Arguments.size() - origLen == context.Inputs.size() ||
-          !context.InputActions.empty()) &&
-         "every input to MergeModule must generate a swiftmodule");
+  if (context.OI.ShouldEmitModuleSeparately) {
+    // Build the module from the source files, in parallel with the compile
+    // jobs, instead of waiting for their partial modules.
+    assert(context.Inputs.empty() &&
+           "a separately emitted module only depends on source files");
+    for (const Action *A : context.InputActions)
+      cast<InputAction>(A)->getInputArg().render(context.Args, Arguments);
 
-  // Tell all files to parse as library, which is necessary to load them as
-  // serialized ASTs.
-  Arguments.push_back("-parse-as-library");
+    addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                          context.Args, Arguments);
 
-  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
-                        Arguments);
+    // The serialized SIL should match what the compile jobs produce.
+    context.Args.AddLastArg(Arguments, options::OPT_O_Group);
+
+    if (context.Args.hasArg(options::OPT_parse_as_library) ||
+        context.Args.hasArg(options::OPT_emit_library))
+      Arguments.push_back("-parse-as-library");
+  } else {
+    size_t origLen = Arguments.size();
+    (void)origLen;
+    addInputsOfType(Arguments, context.Inputs, types::TY_SwiftModuleFile);
+    addInputsOfType(Arguments, context.InputActions,
+                    types::TY_SwiftModuleFile);
+    assert(Arguments.size() - origLen >=
+           context.Inputs.size() + context.InputActions.size());
+    assert((Arguments.size() - origLen == context.Inputs.size() ||
+            !context.InputActions.empty()) &&
+           "every input to MergeModule must generate a swiftmodule");
+
+    // Tell all files to parse as library, which is necessary to load them as
+    // serialized ASTs.
+    Arguments.push_back("-parse-as-library");
+
+    addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                          context.Args, Arguments);
+  }
 
   Arguments.push_back("-module-name");
   Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
@@ -603,8 +661,8 @@ ToolChain::constructInvocation(const REPLJobAction &job,
   }
 
   ArgStringList FrontendArgs;
-  addCommonFrontendArgs(*this, context.OI, context.Output, context.Args,
-                        FrontendArgs);
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                        context.Args, FrontendArgs);
   context.Args.AddAllArgs(FrontendArgs, options::OPT_l, options::OPT_framework,
                           options::OPT_L);
 
@@ -649,6 +707,55 @@ ToolChain::constructInvocation(const GenerateDSYMJobAction &job,
   return std::make_pair("dsymutil", Arguments);
 }
 
+std::pair<const char *, llvm::opt::ArgStringList>
+ToolChain::constructInvocation(const GeneratePCHJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.InputActions.size() == 1);
+  assert(context.Output.getPrimaryOutputType() == types::TY_PCH);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                        context.Args, Arguments);
+  addInputsOfType(Arguments, context.InputActions, types::TY_ObjCHeader);
+
+  Arguments.push_back("-emit-pch");
+
+  Arguments.push_back("-module-name");
+  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+
+  Arguments.push_back("-o");
+  Arguments.push_back(
+      context.Args.MakeArgString(context.Output.getPrimaryOutputFilename()));
+
+  return std::make_pair(SWIFT_EXECUTABLE_NAME, Arguments);
+}
+
+std::pair<const char *, llvm::opt::ArgStringList>
+ToolChain::constructInvocation(const ResolveImportsJobAction &job,
+                               const JobContext &context) const {
+  assert(context.Inputs.empty());
+  assert(context.Output.getPrimaryOutputType() == types::TY_Nothing);
+
+  ArgStringList Arguments;
+
+  Arguments.push_back("-frontend");
+
+  addCommonFrontendArgs(*this, context.OI, context.Output, context.Inputs,
+                        context.Args, Arguments);
+  addInputsOfType(Arguments, context.InputActions, types::TY_Swift);
+
+  Arguments.push_back("-resolve-imports");
+
+  Arguments.push_back("-module-name");
+  Arguments.push_back(context.Args.MakeArgString(context.OI.ModuleName));
+
+  return std::make_pair(SWIFT_EXECUTABLE_NAME, Arguments);
+}
+
 std::pair<const char *, llvm::opt::ArgStringList>
 ToolChain::constructInvocation(const AutolinkExtractJobAction &job,
                                const JobContext &context) const {
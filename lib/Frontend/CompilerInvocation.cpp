@@ -119,17 +119,24 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.SkipNonPrimaryFunctionBodies |=
+    Args.hasArg(OPT_skip_non_primary_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
+  if (const Arg *A = Args.getLastArg(OPT_stats_output_dir))
+    Opts.StatsOutputDir = A->getValue();
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
+  Opts.DebugTimeExpressionTypeChecking |=
+    Args.hasArg(OPT_debug_time_expression_type_checking);
 
   Opts.PlaygroundTransform |= Args.hasArg(OPT_playground);
   if (Args.hasArg(OPT_disable_playground_transform))
     Opts.PlaygroundTransform = false;
   Opts.PlaygroundHighPerformance |=
     Args.hasArg(OPT_playground_high_performance);
+  Opts.PlaygroundTopLevelOnly |= Args.hasArg(OPT_playground_top_level_only);
 
   if (const Arg *A = Args.getLastArg(OPT_help, OPT_help_hidden)) {
     if (A->getOption().matches(OPT_help)) {
@@ -147,7 +154,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     if (A->getOption().matches(OPT_INPUT)) {
       Opts.InputFilenames.push_back(A->getValue());
     } else if (A->getOption().matches(OPT_primary_file)) {
-      Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+      if (Opts.PrimaryInput.hasValue())
+        Opts.AdditionalPrimaryInputs.push_back(
+            SelectedInput(Opts.InputFilenames.size()));
+      else
+        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
       Opts.InputFilenames.push_back(A->getValue());
     } else {
       llvm_unreachable("Unknown input-related argument!");
@@ -188,6 +199,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::DumpInterfaceHash;
     } else if (Opt.matches(OPT_print_ast)) {
       Action = FrontendOptions::PrintAST;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
+    } else if (Opt.matches(OPT_resolve_imports)) {
+      Action = FrontendOptions::ResolveImports;
     } else if (Opt.matches(OPT_repl) ||
                Opt.matches(OPT_deprecated_integrated_repl)) {
       Action = FrontendOptions::REPL;
@@ -212,6 +227,38 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     return true;
   }
 
+  // Several primary files share one set of imports, but are otherwise
+  // processed like separate invocations, each with its own outputs. Outputs
+  // that describe the whole invocation rather than one file are not
+  // supported.
+  if (Opts.hasMultiplePrimaryInputs()) {
+    switch (Opts.RequestedAction) {
+    case FrontendOptions::Parse:
+    case FrontendOptions::EmitSILGen:
+    case FrontendOptions::EmitSIL:
+    case FrontendOptions::EmitIR:
+    case FrontendOptions::EmitBC:
+    case FrontendOptions::EmitAssembly:
+    case FrontendOptions::EmitObject:
+      break;
+    default:
+      Diags.diagnose(SourceLoc(), diag::error_mode_multiple_primary_files);
+      return true;
+    }
+
+    for (auto Opt : {OPT_emit_reference_dependencies,
+                     OPT_emit_reference_dependencies_path,
+                     OPT_emit_dependencies, OPT_emit_dependencies_path,
+                     OPT_emit_objc_header, OPT_emit_objc_header_path,
+                     OPT_emit_fixits_path}) {
+      if (const Arg *A = Args.getLastArg(Opt)) {
+        Diags.diagnose(SourceLoc(), diag::error_output_multiple_primary_files,
+                       A->getSpelling());
+        return true;
+      }
+    }
+  }
+
   bool TreatAsSIL = Args.hasArg(OPT_parse_sil);
   if (!TreatAsSIL && Opts.InputFilenames.size() == 1) {
     // If we have exactly one input filename, and its extension is "sil",
@@ -362,6 +409,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Opts.setSingleOutputFilename("-");
       break;
 
+    case FrontendOptions::ResolveImports:
+      // The loaded modules are the only result.
+      Opts.OutputFilenames.clear();
+      break;
+
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::EmitSIL: {
       if (Opts.OutputFilenames.empty())
@@ -371,6 +423,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       break;
     }
 
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
+
     case FrontendOptions::EmitSIBGen:
     case FrontendOptions::EmitSIB:
       Suffix = SIB_EXTENSION;
@@ -547,6 +603,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
+    case FrontendOptions::ResolveImports:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
@@ -573,6 +631,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
+    case FrontendOptions::ResolveImports:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
@@ -601,6 +661,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::DumpAST:
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
+    case FrontendOptions::ResolveImports:
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
@@ -621,6 +683,45 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  // With several primary files, each per-file output must be given once for
+  // each primary file, in the same order as the -primary-file options.
+  if (Opts.hasMultiplePrimaryInputs() &&
+      Opts.RequestedAction != FrontendOptions::Parse) {
+    unsigned NumPrimaries = Opts.AdditionalPrimaryInputs.size() + 1;
+    if (Opts.OutputFilenames.size() != NumPrimaries) {
+      Diags.diagnose(SourceLoc(),
+                     diag::error_output_count_multiple_primary_files, "-o",
+                     NumPrimaries, Opts.OutputFilenames.size());
+      return true;
+    }
+
+    auto splitPerPrimaryPaths = [&](std::string &First,
+                                    std::vector<std::string> &Rest,
+                                    OptSpecifier PathOpt,
+                                    StringRef Spelling) -> bool {
+      if (First.empty())
+        return false;
+      std::vector<std::string> Paths = Args.getAllArgValues(PathOpt);
+      if (Paths.size() != NumPrimaries) {
+        Diags.diagnose(SourceLoc(),
+                       diag::error_output_count_multiple_primary_files,
+                       Spelling, NumPrimaries, Paths.size());
+        return true;
+      }
+      First = Paths.front();
+      Rest.assign(Paths.begin() + 1, Paths.end());
+      return false;
+    };
+    if (splitPerPrimaryPaths(Opts.ModuleOutputPath,
+                             Opts.AdditionalModuleOutputPaths,
+                             OPT_emit_module_path, "-emit-module-path") ||
+        splitPerPrimaryPaths(Opts.ModuleDocOutputPath,
+                             Opts.AdditionalModuleDocOutputPaths,
+                             OPT_emit_module_doc_path,
+                             "-emit-module-doc-path"))
+      return true;
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_module_link_name)) {
     Opts.ModuleLinkName = A->getValue();
   }
@@ -658,6 +759,9 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
 
   Opts.UseMalloc |= Args.hasArg(OPT_use_malloc);
 
+  Opts.EnableConcurrentTypeUniquing |=
+    Args.hasArg(OPT_enable_concurrent_type_uniquing);
+
   Opts.EnableExperimentalPatterns |=
     Args.hasArg(OPT_enable_experimental_patterns);
 
@@ -682,6 +786,8 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
 
   Opts.CodeCompleteInitsInPostfixExpr |=
       Args.hasArg(OPT_code_complete_inits_in_postfix_expr);
+  Opts.CodeCompleteOnlyDependencies |=
+      Args.hasArg(OPT_code_complete_only_dependencies);
 
   if (auto A = Args.getLastArg(OPT_enable_target_os_checking,
                                OPT_disable_target_os_checking)) {
@@ -690,8 +796,11 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
+  Opts.SolveClosureBodiesSeparately |=
+      Args.hasArg(OPT_solve_closure_bodies_separately);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
+  Opts.TraceDeserialization |= Args.hasArg(OPT_print_deserialization_stats);
 
   Opts.DebuggerSupport |= Args.hasArg(OPT_debugger_support);
   if (Opts.DebuggerSupport)
@@ -738,6 +847,35 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     
     Opts.SolverMemoryThreshold = threshold;
   }
+
+  if (const Arg *A = Args.getLastArg(OPT_ast_verifier_sample_percent)) {
+    unsigned percent;
+    if (StringRef(A->getValue()).getAsInteger(10, percent) || percent > 100) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.ASTVerifierSamplePercent = percent;
+  }
+
+  auto parseLimit = [&](swift::options::ID optID, unsigned &limit) -> bool {
+    if (const Arg *A = Args.getLastArg(optID)) {
+      if (StringRef(A->getValue()).getAsInteger(10, limit)) {
+        Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                       A->getAsString(Args), A->getValue());
+        return true;
+      }
+    }
+    return false;
+  };
+
+  if (parseLimit(OPT_solver_binding_threshold, Opts.SolverBindingThreshold) ||
+      parseLimit(OPT_warn_long_expression_type_checking_EQ,
+                 Opts.WarnLongExpressionTypeChecking) ||
+      parseLimit(OPT_warn_expression_type_variable_bindings_EQ,
+                 Opts.WarnExpressionTypeVariableBindings))
+    return true;
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_D),
                                  Args.filtered_end())) {
@@ -816,6 +954,14 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.DumpClangDiagnostics |= Args.hasArg(OPT_dump_clang_diagnostics);
 
+  // A precompiled bridging header has to be loaded as Clang is set up, rather
+  // than parsed afterwards like a plain header.
+  if (const Arg *A = Args.getLastArg(OPT_import_objc_header)) {
+    StringRef header = A->getValue();
+    if (llvm::sys::path::extension(header).endswith(PCH_EXTENSION))
+      Opts.PrecompiledHeaderInputPath = header;
+  }
+
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.Mode = ClangImporterOptions::Modes::EmbedBitcode;
 
@@ -991,6 +1137,7 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   // -Ounchecked might also set removal of runtime asserts (cond_fail).
   Opts.RemoveRuntimeAsserts |= Args.hasArg(OPT_remove_runtime_asserts);
+  Opts.AssumeSingleThreaded |= Args.hasArg(OPT_assume_single_threaded);
 
   Opts.EnableARCOptimizations |= !Args.hasArg(OPT_disable_arc_opts);
   Opts.VerifyAll |= Args.hasArg(OPT_sil_verify_all);
@@ -1002,6 +1149,11 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use))
+    Opts.ProfileUsePath = A->getValue();
+  Opts.ShareSpecializations |= Args.hasArg(OPT_share_specializations);
+  if (const Arg *A = Args.getLastArg(OPT_prespecialize_from_profile))
+    Opts.PrespecializeProfilePath = A->getValue();
 
   return false;
 }
@@ -1083,10 +1235,17 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.DisableLLVMOptzns |= Args.hasArg(OPT_disable_llvm_optzns);
   Opts.DisableLLVMARCOpts |= Args.hasArg(OPT_disable_llvm_arc_opts);
   Opts.DisableLLVMSLPVectorizer |= Args.hasArg(OPT_disable_llvm_slp_vectorizer);
+  Opts.DisableLLVMMergeFunctions |=
+    Args.hasArg(OPT_disable_llvm_merge_functions);
   if (Args.hasArg(OPT_disable_llvm_verify))
     Opts.Verify = false;
 
+  if (const Arg *A = Args.getLastArg(OPT_object_cache_path))
+    Opts.ObjectCachePath = A->getValue();
+
   Opts.EmitStackPromotionChecks |= Args.hasArg(OPT_stack_promotion_checks);
+  Opts.EmitMetadataPrefetchTable |=
+    Args.hasArg(OPT_emit_metadata_prefetch_table);
   if (const Arg *A = Args.getLastArg(OPT_stack_promotion_limit)) {
     unsigned limit;
     if (StringRef(A->getValue()).getAsInteger(10, limit)) {
@@ -1097,6 +1256,16 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     Opts.StackPromotionSizeLimit = limit;
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_outline_value_operations_threshold)) {
+    unsigned threshold;
+    if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.OutlineValueOperationsThreshold = threshold;
+  }
+
   if (Args.hasArg(OPT_autolink_force_load))
     Opts.ForceLoadSymbolName = Args.getLastArgValue(OPT_module_link_name);
 
@@ -1126,6 +1295,8 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   }
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
+  Opts.ThreadLocalProfileCounters |=
+    Args.hasArg(OPT_profile_thread_local_counters);
 
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.EmbedMode = IRGenEmbedMode::EmbedBitcode;
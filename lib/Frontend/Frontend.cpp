@@ -22,6 +22,7 @@
 #include "swift/AST/DiagnosticsFrontend.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/AST/Module.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Parse/DelayedParsingCallbacks.h"
 #include "swift/Parse/Lexer.h"
@@ -45,13 +46,68 @@ void CompilerInstance::createSILModule(bool WholeModule) {
 void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   assert(SF);
   assert(MainModule && "main module not created yet");
-  assert(!PrimarySourceFile && "already has a primary source file");
   assert(PrimaryBufferID == NO_SUCH_BUFFER || !SF->getBufferID().hasValue() ||
-         SF->getBufferID().getValue() == PrimaryBufferID);
+         isPrimaryBufferID(SF->getBufferID().getValue()));
+  PrimarySourceFiles.push_back(SF);
+
+  // The additional primary files are only recorded above. Referenced names
+  // are only tracked for the file selected by PrimaryInput.
+  if (PrimaryBufferID != NO_SUCH_BUFFER && SF->getBufferID().hasValue() &&
+      SF->getBufferID().getValue() != PrimaryBufferID)
+    return;
+  assert(!PrimarySourceFile && "already has a primary source file");
   PrimarySourceFile = SF;
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+bool CompilerInstance::isPrimaryBufferID(unsigned BufferID) const {
+  if (BufferID == NO_SUCH_BUFFER)
+    return false;
+  if (BufferID == PrimaryBufferID)
+    return true;
+  return std::find(AdditionalPrimaryBufferIDs.begin(),
+                   AdditionalPrimaryBufferIDs.end(),
+                   BufferID) != AdditionalPrimaryBufferIDs.end();
+}
+
+void CompilerInstance::recordPrimaryBufferID(const SelectedInput &Input,
+                                             unsigned BufferID) {
+  const FrontendOptions &Opts = Invocation.getFrontendOptions();
+  auto matches = [&](const SelectedInput &Selected) {
+    return Selected.Kind == Input.Kind && Selected.Index == Input.Index;
+  };
+
+  if (Opts.PrimaryInput && matches(*Opts.PrimaryInput)) {
+    PrimaryBufferID = BufferID;
+    return;
+  }
+  for (unsigned i = 0, e = Opts.AdditionalPrimaryInputs.size(); i != e; ++i) {
+    if (matches(Opts.AdditionalPrimaryInputs[i])) {
+      if (AdditionalPrimaryBufferIDs.size() <= i)
+        AdditionalPrimaryBufferIDs.resize(i + 1, NO_SUCH_BUFFER);
+      AdditionalPrimaryBufferIDs[i] = BufferID;
+      return;
+    }
+  }
+}
+
+SourceFile *
+CompilerInstance::getPrimarySourceFileForInput(unsigned PrimaryIndex) const {
+  if (PrimaryIndex == 0)
+    return PrimarySourceFile;
+
+  unsigned AdditionalIndex = PrimaryIndex - 1;
+  if (AdditionalIndex >= AdditionalPrimaryBufferIDs.size())
+    return nullptr;
+  unsigned BufferID = AdditionalPrimaryBufferIDs[AdditionalIndex];
+  for (SourceFile *SF : PrimarySourceFiles) {
+    auto SFBufferID = SF->getBufferID();
+    if (SFBufferID.hasValue() && SFBufferID.getValue() == BufferID)
+      return SF;
+  }
+  return nullptr;
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
@@ -121,9 +177,6 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   if (SILMode)
     Invocation.getLangOptions().EnableAccessControl = false;
 
-  const Optional<SelectedInput> &PrimaryInput =
-    Invocation.getFrontendOptions().PrimaryInput;
-
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
   for (unsigned i = 0, e = Invocation.getInputBuffers().size(); i != e; ++i) {
@@ -141,8 +194,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode)
         MainBufferID = BufferID;
 
-      if (PrimaryInput && PrimaryInput->isBuffer() && PrimaryInput->Index == i)
-        PrimaryBufferID = BufferID;
+      recordPrimaryBufferID(SelectedInput(i, SelectedInput::InputKind::Buffer),
+                            BufferID);
     }
   }
 
@@ -157,9 +210,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (SILMode || (MainMode && filename(File) == "main.swift"))
         MainBufferID = ExistingBufferID.getValue();
 
-      if (PrimaryInput && PrimaryInput->isFilename() &&
-          PrimaryInput->Index == i)
-        PrimaryBufferID = ExistingBufferID.getValue();
+      recordPrimaryBufferID(SelectedInput(i), ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -200,8 +251,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
     if (SILMode || (MainMode && filename(File) == "main.swift"))
       MainBufferID = BufferID;
 
-    if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
-      PrimaryBufferID = BufferID;
+    recordPrimaryBufferID(SelectedInput(i), BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -232,6 +282,10 @@ void CompilerInstance::performSema() {
 
   auto modImpKind = SourceFile::ImplicitModuleImportKind::Stdlib;
 
+  using Phase = FrontendStats::Phase;
+  Optional<FrontendStats::PhaseTimer> importTimer;
+  importTimer.emplace(Context->Stats, Phase::Import);
+
   if (Kind == InputFileKind::IFK_SIL) {
     assert(BufferIDs.size() == 1);
     assert(MainBufferID != NO_SUCH_BUFFER);
@@ -314,6 +368,7 @@ void CompilerInstance::performSema() {
       }
     }
   }
+  importTimer.reset();
 
   auto addAdditionalInitialImports = [&](SourceFile *SF) {
     if (!underlying && !importedHeaderModule && importModules.empty())
@@ -351,10 +406,24 @@ void CompilerInstance::performSema() {
   if (Invocation.isCodeCompletion()) {
     DelayedCB.reset(
         new CodeCompleteDelayedCallbacks(SourceMgr.getCodeCompletionLoc()));
-  } else if (Invocation.isDelayedFunctionBodyParsing()) {
+  } else if (Invocation.isDelayedFunctionBodyParsing() ||
+             options.RequestedAction == FrontendOptions::ResolveImports) {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Function bodies in non-primary files are never type-checked or emitted
+  // by this frontend, so they can be skipped, apart from transparent ones.
+  SkipNonTransparentFunctions SkipNonPrimaryCB;
+  bool SkipNonPrimaryBodies =
+    !DelayedCB && PrimaryBufferID != NO_SUCH_BUFFER &&
+    Invocation.getFrontendOptions().SkipNonPrimaryFunctionBodies;
+  auto getDelayedCallbacks = [&](unsigned BufferID)
+      -> DelayedParsingCallbacks * {
+    if (SkipNonPrimaryBodies && !isPrimaryBufferID(BufferID))
+      return &SkipNonPrimaryCB;
+    return DelayedCB.get();
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -373,7 +442,7 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
+    if (isPrimaryBufferID(MainBufferID))
       setPrimarySourceFile(MainFile);
   }
 
@@ -399,17 +468,21 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
+    if (isPrimaryBufferID(BufferID))
       setPrimarySourceFile(NextInput);
 
     bool Done;
-    do {
-      // Parser may stop at some erroneous constructions like #else, #endif
-      // or '}' in some cases, continue parsing until we are done
-      parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
-    } while (!Done);
+    {
+      FrontendStats::PhaseTimer timer(Context->Stats, Phase::Parse);
+      do {
+        // Parser may stop at some erroneous constructions like #else, #endif
+        // or '}' in some cases, continue parsing until we are done
+        parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
+                            &PersistentState, getDelayedCallbacks(BufferID));
+      } while (!Done);
+    }
 
+    FrontendStats::PhaseTimer timer(Context->Stats, Phase::Import);
     performNameBinding(*NextInput);
   }
 
@@ -432,6 +505,9 @@ void CompilerInstance::performSema() {
   if (Invocation.getFrontendOptions().DebugTimeFunctionBodies) {
     TypeCheckOptions |= TypeCheckingFlags::DebugTimeFunctionBodies;
   }
+  if (Invocation.getFrontendOptions().DebugTimeExpressionTypeChecking) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugTimeExpressions;
+  }
   if (Invocation.getFrontendOptions().actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
@@ -439,7 +515,8 @@ void CompilerInstance::performSema() {
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
     bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+      options.RequestedAction != FrontendOptions::ResolveImports &&
+      (PrimaryBufferID == NO_SUCH_BUFFER || isPrimaryBufferID(MainBufferID));
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -451,10 +528,16 @@ void CompilerInstance::performSema() {
       // after parsing any top level code in a main module, or in SIL mode when
       // there are chunks of swift decls (e.g. imports and types) interspersed
       // with 'sil' definitions.
-      parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
-                          TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+      {
+        FrontendStats::PhaseTimer timer(Context->Stats, Phase::Parse);
+        parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
+                            TheSILModule ? &SILContext : nullptr,
+                            &PersistentState,
+                            TheSILModule ? DelayedCB.get()
+                                         : getDelayedCallbacks(MainBufferID));
+      }
       if (mainIsPrimary) {
+        FrontendStats::PhaseTimer timer(Context->Stats, Phase::Sema);
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem);
       }
@@ -463,30 +546,50 @@ void CompilerInstance::performSema() {
     
     if (mainIsPrimary && !Context->hadError() &&
         Invocation.getFrontendOptions().PlaygroundTransform)
-      performPlaygroundTransform(MainFile, Invocation.getFrontendOptions().PlaygroundHighPerformance);
-    if (!mainIsPrimary)
+      performPlaygroundTransform(
+          MainFile, Invocation.getFrontendOptions().PlaygroundHighPerformance,
+          Invocation.getFrontendOptions().PlaygroundTopLevelOnly);
+    if (!mainIsPrimary) {
+      FrontendStats::PhaseTimer timer(Context->Stats, Phase::Import);
       performNameBinding(MainFile);
+    }
   }
 
-  // Type-check each top-level input besides the main source file.
-  for (auto File : MainModule->getFiles())
-    if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+  // Every import has been loaded now, building any Clang modules which were
+  // missing from the module cache; that is all this action is for.
+  if (options.RequestedAction == FrontendOptions::ResolveImports)
+    return;
+
+  // Type-check each top-level input besides the main source file. When there
+  // are several primary files, they all share the imports loaded above.
+  auto isPrimary = [&](SourceFile *SF) {
+    return std::find(PrimarySourceFiles.begin(), PrimarySourceFiles.end(),
+                     SF) != PrimarySourceFiles.end();
+  };
+  for (auto File : MainModule->getFiles()) {
+    if (auto SF = dyn_cast<SourceFile>(File)) {
+      if (PrimaryBufferID == NO_SUCH_BUFFER || isPrimary(SF)) {
+        FrontendStats::PhaseTimer timer(Context->Stats, Phase::Sema);
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions);
+      }
+    }
+  }
 
   // Even if there were no source files, we should still record known
   // protocols.
   if (auto *stdlib = Context->getStdlibModule())
     Context->recordKnownProtocols(stdlib);
 
-  if (DelayedCB) {
+  if (DelayedCB || SkipNonPrimaryBodies) {
+    FrontendStats::PhaseTimer timer(Context->Stats, Phase::Parse);
     performDelayedParsing(MainModule, PersistentState,
                           Invocation.getCodeCompletionFactory());
   }
 
   // Perform whole-module type checking.
   if (TypeCheckOptions & TypeCheckingFlags::DelayWholeModuleChecking) {
+    FrontendStats::PhaseTimer timer(Context->Stats, Phase::Sema);
     for (auto File : MainModule->getFiles())
       if (auto SF = dyn_cast<SourceFile>(File))
         performWholeModuleTypeChecking(*SF);
@@ -511,6 +614,8 @@ void CompilerInstance::performParseOnly() {
   MainModule->addFile(*Input);
   setPrimarySourceFile(Input);
 
+  FrontendStats::PhaseTimer timer(Context->Stats,
+                                 FrontendStats::Phase::Parse);
   PersistentParserState PersistentState;
   bool Done;
   do {
@@ -26,6 +26,10 @@ bool FrontendOptions::actionHasOutput() const {
   case PrintAST:
   case DumpTypeRefinementContexts:
     return false;
+  case EmitPCH:
+    return true;
+  case ResolveImports:
+    return false;
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -53,6 +57,8 @@ bool FrontendOptions::actionIsImmediate() const {
   case DumpInterfaceHash:
   case PrintAST:
   case DumpTypeRefinementContexts:
+  case EmitPCH:
+  case ResolveImports:
   case EmitSILGen:
   case EmitSIL:
   case EmitSIBGen:
@@ -87,4 +93,34 @@ void FrontendOptions::forAllOutputPaths(
     if (!next->empty())
       fn(*next);
   }
+  for (auto *paths : {&AdditionalModuleOutputPaths,
+                      &AdditionalModuleDocOutputPaths}) {
+    for (const std::string &path : *paths)
+      fn(path);
+  }
+}
+
+FrontendOptions
+FrontendOptions::getOptionsForPrimaryInput(unsigned PrimaryIndex) const {
+  assert(PrimaryIndex <= AdditionalPrimaryInputs.size());
+  FrontendOptions Result = *this;
+  Result.AdditionalPrimaryInputs.clear();
+  Result.AdditionalModuleOutputPaths.clear();
+  Result.AdditionalModuleDocOutputPaths.clear();
+  if (PrimaryIndex == 0) {
+    if (!OutputFilenames.empty())
+      Result.setSingleOutputFilename(OutputFilenames.front());
+    return Result;
+  }
+
+  unsigned AdditionalIndex = PrimaryIndex - 1;
+  Result.PrimaryInput = AdditionalPrimaryInputs[AdditionalIndex];
+  if (PrimaryIndex < OutputFilenames.size())
+    Result.setSingleOutputFilename(OutputFilenames[PrimaryIndex]);
+  if (AdditionalIndex < AdditionalModuleOutputPaths.size())
+    Result.ModuleOutputPath = AdditionalModuleOutputPaths[AdditionalIndex];
+  if (AdditionalIndex < AdditionalModuleDocOutputPaths.size())
+    Result.ModuleDocOutputPath =
+        AdditionalModuleDocOutputPaths[AdditionalIndex];
+  return Result;
 }
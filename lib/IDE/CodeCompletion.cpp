@@ -4317,6 +4317,12 @@ void CodeCompletionCallbacksImpl::doneParsing() {
   // Add keywords even if type checking fails completely.
   addKeywords(CompletionContext.getResultSink());
 
+  // Other completions may list the locals of the function, so they need the
+  // types of all of them.
+  bool &OnlyDependencies = P.Context.LangOpts.CodeCompleteOnlyDependencies;
+  llvm::SaveAndRestore<bool> ChangeOnlyDependencies(
+      OnlyDependencies, OnlyDependencies && Kind == CompletionKind::DotExpr);
+
   if (!typecheckContext())
     return;
 
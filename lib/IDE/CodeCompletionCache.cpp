@@ -2,6 +2,7 @@
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -90,12 +91,6 @@ CodeCompletionCache::~CodeCompletionCache() {}
 /// cached results. This isn't expected to change very often.
 static constexpr uint32_t onDiskCompletionCacheVersion = 0;
 
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
-
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
   StringRef *Buff = Allocator.Allocate<StringRef>(Arr.size());
@@ -114,10 +109,14 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
 
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+///
+/// Strings in the results refer directly into \p in rather than being copied,
+/// so the buffer is kept alive until the sink's allocator is released.
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> inBuffer,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
+  std::shared_ptr<llvm::MemoryBuffer> in(std::move(inBuffer));
   const char *cursor = in->getBufferStart();
   const char *end = in->getBufferEnd();
 
@@ -159,7 +158,14 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
   auto stringCount = read32le(strings);
   assert(strings + stringCount == end && "incorrect file size");
   (void)stringCount; // so it is not seen as "unused" in release builds.
-  
+
+  // Anything that refers into the buffer is allocated from the sink's
+  // allocator, and clients that import these results into other sinks retain
+  // that allocator, so tie the buffer's lifetime to it.
+  V.Sink.Allocator = CodeCompletionResultSink::AllocatorPtr(
+      new llvm::BumpPtrAllocator(),
+      [in](llvm::BumpPtrAllocator *allocator) { delete allocator; });
+
   // STRINGS
   auto getString = [&](uint32_t index) -> StringRef {
     if (index == ~0u)
@@ -167,7 +173,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
   };
 
   // CHUNKS
@@ -270,6 +276,12 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///
 ///   STRINGS
 ///     * A blob of length-prefixed strings referred to in CHUNKS or RESULTS.
+///     * Strings referred to on their own are only stored once. The strings of
+///       a result's associated USRs and decl keywords are stored as a
+///       contiguous sequence, since only the first one is referenced.
+///
+/// The reader refers to the strings in place, so the file is expected to be
+/// memory mapped rather than read.
 static void writeCachedModule(llvm::raw_ostream &out,
                               const CodeCompletionCache::Key &K,
                               CodeCompletionCache::Value &V) {
@@ -308,7 +320,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
   std::string strings_;
   llvm::raw_string_ostream strings(strings_);
 
-  auto addString = [&strings](StringRef str) {
+  auto addStringInSequence = [&strings](StringRef str) {
     if (str.empty())
       return ~0u;
     auto size = strings.tell();
@@ -318,6 +330,17 @@ static void writeCachedModule(llvm::raw_ostream &out,
     return static_cast<uint32_t>(size);
   };
 
+  // Module names and most chunk texts are repeated across many results.
+  llvm::StringMap<uint32_t> uniquedStrings;
+  auto addString = [&](StringRef str) {
+    if (str.empty())
+      return ~0u;
+    auto known = uniquedStrings.insert(std::make_pair(str, 0));
+    if (known.second)
+      known.first->second = addStringInSequence(str);
+    return known.first->second;
+  };
+
   auto addCompletionString = [&](const CodeCompletionString *str) {
     auto size = chunks.tell();
     chunksLE.write(static_cast<uint32_t>(str->getChunks().size()));
@@ -355,9 +378,9 @@ static void writeCachedModule(llvm::raw_ostream &out,
       if (R->getAssociatedUSRs().empty()) {
         LE.write(static_cast<uint32_t>(~0u));
       } else {
-        LE.write(addString(R->getAssociatedUSRs()[0]));
+        LE.write(addStringInSequence(R->getAssociatedUSRs()[0]));
         for (unsigned i = 1; i < R->getAssociatedUSRs().size(); ++i) {
-          addString(R->getAssociatedUSRs()[i]); // ignore result
+          addStringInSequence(R->getAssociatedUSRs()[i]); // ignore result
         }
       }
       auto AllKeywords = R->getDeclKeywords();
@@ -365,11 +388,11 @@ static void writeCachedModule(llvm::raw_ostream &out,
       if (AllKeywords.empty()) {
         LE.write(static_cast<uint32_t>(~0u));
       } else {
-        LE.write(addString(AllKeywords[0].first));
-        addString(AllKeywords[0].second);
+        LE.write(addStringInSequence(AllKeywords[0].first));
+        addStringInSequence(AllKeywords[0].second);
         for (unsigned i = 1; i < AllKeywords.size(); ++i) {
-          addString(AllKeywords[i].first);
-          addString(AllKeywords[i].second);
+          addStringInSequence(AllKeywords[i].first);
+          addStringInSequence(AllKeywords[i].second);
         }
       }
     }
@@ -418,13 +441,15 @@ static std::string getName(StringRef cacheDirectory,
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K),
+                                                 /*FileSize=*/-1,
+                                                 /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -460,7 +485,8 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = llvm::MemoryBuffer::getFile(
+      filename, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
   if (!bufferOrErr)
     return None;
 
@@ -469,7 +495,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
@@ -59,6 +59,19 @@ llvm::Value *irgen::emitCheckedCast(IRGenFunction &IGF,
                                     CheckedCastMode mode) {
   // TODO: attempt to specialize this based on the known types.
 
+  // A cast from a nominal or archetype type to itself always succeeds, so
+  // there's no need to go through the runtime.
+  if (srcType == targetType &&
+      (srcType->getAnyNominal() || isa<ArchetypeType>(srcType))) {
+    auto silType = SILType::getPrimitiveAddressType(srcType);
+    auto &ti = IGF.getTypeInfo(silType);
+    if (shouldTakeOnSuccess(consumptionKind))
+      ti.initializeWithTake(IGF, dest, src, silType);
+    else
+      ti.initializeWithCopy(IGF, dest, src, silType);
+    return IGF.Builder.getTrue();
+  }
+
   DynamicCastFlags flags = getDynamicCastFlags(consumptionKind, mode);
 
   // Cast both addresses to opaque pointer type.
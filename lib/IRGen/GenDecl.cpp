@@ -38,6 +38,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ConvertUTF.h"
+#include "llvm/Transforms/Utils/ModuleUtils.h"
 
 #include "CallingConvention.h"
 #include "Explosion.h"
@@ -644,6 +645,59 @@ void IRGenModule::addProtocolConformanceRecord(
   ProtocolConformances.push_back(conformance);
 }
 
+/// Add the given type metadata accessor to the list of accessors which the
+/// runtime calls eagerly when the image is loaded.
+void IRGenModule::addMetadataPrefetchAccessor(llvm::Function *accessor) {
+  MetadataPrefetchAccessors.push_back(accessor);
+}
+
+/// Emit the table of metadata prefetch accessors and a global constructor
+/// which hands it to the runtime.
+///
+/// The runtime calls the accessors on a background thread, so that the
+/// instantiation of generic metadata like Array<String> is done when the
+/// program first asks for it, instead of on the requesting thread.
+void IRGenModule::emitMetadataPrefetchTable() {
+  if (MetadataPrefetchAccessors.empty())
+    return;
+
+  SmallVector<llvm::Constant *, 8> elts;
+  for (llvm::Function *accessor : MetadataPrefetchAccessors)
+    elts.push_back(llvm::ConstantExpr::getBitCast(accessor, Int8PtrTy));
+
+  auto arrayTy = llvm::ArrayType::get(Int8PtrTy, elts.size());
+  auto var = new llvm::GlobalVariable(Module, arrayTy, /*isConstant*/ true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      llvm::ConstantArray::get(arrayTy, elts),
+                                      "metadata_prefetch_accessors");
+  var->setAlignment(getPointerAlignment().getValue());
+
+  auto fnTy = llvm::FunctionType::get(VoidTy, /*varArg*/ false);
+  auto fn = llvm::Function::Create(fnTy, llvm::GlobalValue::PrivateLinkage,
+                                   "metadata_prefetch_registration",
+                                   getModule());
+  fn->setAttributes(constructInitialAttributes());
+
+  llvm::Constant *beginIndices[] = {
+    llvm::ConstantInt::get(Int32Ty, 0),
+    llvm::ConstantInt::get(Int32Ty, 0),
+  };
+  auto begin = llvm::ConstantExpr::getGetElementPtr(
+      /*Ty=*/nullptr, var, beginIndices);
+  llvm::Constant *endIndices[] = {
+    llvm::ConstantInt::get(Int32Ty, 0),
+    llvm::ConstantInt::get(Int32Ty, elts.size()),
+  };
+  auto end = llvm::ConstantExpr::getGetElementPtr(
+      /*Ty=*/nullptr, var, endIndices);
+
+  IRGenFunction IGF(*this, fn);
+  IGF.Builder.CreateCall(getPrefetchGenericMetadataFn(), {begin, end});
+  IGF.Builder.CreateRetVoid();
+
+  llvm::appendToGlobalCtors(Module, fn, /*priority*/ 65535);
+}
+
 void IRGenModule::emitGlobalLists() {
   if (ObjCInterop) {
     assert(TargetInfo.OutputObjectFormat == llvm::Triple::MachO);
@@ -696,15 +750,30 @@ void IRGenModule::emitGlobalLists() {
                  false);
 }
 
+/// Returns true if \p f is statically known to run rarely, such as a
+/// function that never returns because it reports a fatal error.
+static bool isColdFunction(SILFunction *f) {
+  return f->getLoweredFunctionType()->isNoReturn();
+}
+
 void IRGenModuleDispatcher::emitGlobalTopLevel() {
   // Generate order numbers for the functions in the SIL module that
-  // correspond to definitions in the LLVM module.
+  // correspond to definitions in the LLVM module. Cold functions are placed
+  // after all the others, so that they don't take up space in the
+  // instruction cache between hot ones.
   unsigned nextOrderNumber = 0;
+  SmallVector<SILFunction *, 8> coldFunctions;
   for (auto &silFn : PrimaryIGM->SILMod->getFunctions()) {
     // Don't bother adding external declarations to the function order.
     if (!silFn.isDefinition()) continue;
+    if (isColdFunction(&silFn)) {
+      coldFunctions.push_back(&silFn);
+      continue;
+    }
     FunctionOrder.insert(std::make_pair(&silFn, nextOrderNumber++));
   }
+  for (SILFunction *silFn : coldFunctions)
+    FunctionOrder.insert(std::make_pair(silFn, nextOrderNumber++));
 
   for (SILGlobalVariable &v : PrimaryIGM->SILMod->getSILGlobals()) {
     Decl *decl = v.getDecl();
@@ -1158,11 +1227,30 @@ static void updateLinkageForDefinition(IRGenModule &IGM,
   }
 }
 
+StringRef IRGenModule::getMangledName(const LinkEntity &entity) {
+  auto found = MangledNames.find(entity);
+  if (found != MangledNames.end())
+    return found->second;
+
+  llvm::SmallString<128> buffer;
+  entity.mangle(buffer);
+  char *storage = MangledNameAllocator.Allocate<char>(buffer.size());
+  std::copy(buffer.begin(), buffer.end(), storage);
+  StringRef name(storage, buffer.size());
+  MangledNames.insert({entity, name});
+  return name;
+}
+
 LinkInfo LinkInfo::get(IRGenModule &IGM, const LinkEntity &entity,
                        ForDefinition_t isDefinition) {
   LinkInfo result;
 
-  entity.mangle(result.Name);
+  // SIL functions already know their names; everything else is mangled once
+  // per module.
+  if (entity.isSILFunction())
+    entity.mangle(result.Name);
+  else
+    result.Name = IGM.getMangledName(entity);
 
   std::tie(result.Linkage, result.Visibility) =
     getIRLinkage(IGM, entity.getLinkage(IGM, isDefinition),
@@ -1517,6 +1605,10 @@ llvm::Function *IRGenModule::getAddrOfSILFunction(SILFunction *f,
     attrs = attrs.addAttribute(fnType->getContext(),
                 llvm::AttributeSet::FunctionIndex, llvm::Attribute::ReadOnly);
   }
+  if (isColdFunction(f)) {
+    attrs = attrs.addAttribute(fnType->getContext(),
+                llvm::AttributeSet::FunctionIndex, llvm::Attribute::Cold);
+  }
   fn = link.createFunction(*this, fnType, cc, attrs, insertBefore);
 
   // If we have an order number for this function, set it up as appropriate.
@@ -2721,3 +2813,38 @@ IRGenModule::getOrCreateHelperFunction(StringRef fnName, llvm::Type *resultTy,
   return fn;
 }
 
+/// Get or create the outlined copy or consume function of the loadable type
+/// \p TI, lazily using the given generation function to fill in its body.
+///
+/// The type info does not identify the type across modules, so the function
+/// is private to the module. Returns null if there already is a function for
+/// the type info, but with a different function type.
+llvm::Function *
+IRGenModule::getOrCreateOutlinedValueOperation(const TypeInfo &TI,
+                                               bool isCopy,
+                                               llvm::FunctionType *fnTy,
+                        llvm::function_ref<void(IRGenFunction &IGF)> generate) {
+  auto key = std::make_pair(&TI, unsigned(isCopy));
+  auto found = OutlinedValueOperations.find(key);
+  if (found != OutlinedValueOperations.end()) {
+    llvm::Function *fn = found->second;
+    return fn->getFunctionType() == fnTy ? fn : nullptr;
+  }
+
+  auto *fn = llvm::Function::Create(fnTy, llvm::GlobalValue::InternalLinkage,
+                                    isCopy ? "__swift_outlined_copy"
+                                           : "__swift_outlined_consume",
+                                    &Module);
+  // Register the function before generating its body, which may recursively
+  // outline the operations of the fields.
+  OutlinedValueOperations[key] = fn;
+  fn->setDoesNotThrow();
+  fn->setCallingConv(RuntimeCC);
+
+  IRGenFunction IGF(*this, fn);
+  if (DebugInfo)
+    DebugInfo->emitArtificialFunction(IGF, fn);
+  generate(IGF);
+  return fn;
+}
+
@@ -2211,6 +2211,8 @@ if (Builtin.ID == BuiltinValueKind::id) { \
     if (auto ExpectedPred = IGF.IGM.TargetInfo.OnceDonePredicateValue) {
       auto PredValue = IGF.Builder.CreateLoad(PredPtr,
                                               IGF.IGM.getPointerAlignment());
+      if (IGF.IGM.TargetInfo.OnceDoneCheckNeedsAcquire)
+        PredValue->setAtomic(llvm::AtomicOrdering::Acquire);
       auto ExpectedPredValue = llvm::ConstantInt::getSigned(IGF.IGM.OnceTy,
                                                             *ExpectedPred);
       auto PredIsDone = IGF.Builder.CreateICmpEQ(PredValue, ExpectedPredValue);
@@ -3681,7 +3683,11 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
                                            CanSILFunctionType origType,
                                            CanSILFunctionType substType,
                                            CanSILFunctionType outType,
-                                           Explosion &out) {
+                                           Explosion &out,
+                                           int &StackAllocSize) {
+  int AvailableStackSize = StackAllocSize;
+  StackAllocSize = -1;
+
   // If we have a single Swift-refcounted context value, we can adopt it
   // directly as our closure context without creating a box and thunk.
   enum HasSingleSwiftRefcountedContext { Maybe, Yes, No, Thunkable }
@@ -3874,7 +3880,19 @@ void irgen::emitFunctionPartialApplication(IRGenFunction &IGF,
     // Allocate a new object.
     HeapNonFixedOffsets offsets(IGF, layout);
 
-    data = IGF.emitUnmanagedAlloc(layout, "closure", &offsets);
+    if (layout.isFixedLayout() &&
+        (int)layout.getSize().getValue() < AvailableStackSize) {
+      // Allocate the context on the stack.
+      auto Alloca = IGF.createAlloca(layout.getType(), layout.getAlignment(),
+                                     "closure.raw");
+      data = IGF.Builder.CreateBitCast(Alloca.getAddress(),
+                                       IGF.IGM.RefCountedPtrTy);
+      data = IGF.emitInitStackObjectCall(layout.getPrivateMetadata(IGF.IGM),
+                                         data, "closure");
+      StackAllocSize = layout.getSize().getValue();
+    } else {
+      data = IGF.emitUnmanagedAlloc(layout, "closure", &offsets);
+    }
     Address dataAddr = layout.emitCastTo(IGF, data);
 
     
@@ -47,6 +47,11 @@ namespace irgen {
 
   /// Emit a partial application thunk for a function pointer applied to a
   /// partial set of argument values.
+  ///
+  /// \p StackAllocSize is an in/out parameter: on input it is the number of
+  /// bytes available for allocating the context on the stack (or -1 if the
+  /// context must be allocated on the heap); on output it is the number of
+  /// bytes actually allocated on the stack, or -1.
   void emitFunctionPartialApplication(IRGenFunction &IGF,
                                       llvm::Value *fnPtr,
                                       llvm::Value *fnContext,
@@ -56,7 +61,8 @@ namespace irgen {
                                       CanSILFunctionType origType,
                                       CanSILFunctionType substType,
                                       CanSILFunctionType outType,
-                                      Explosion &out);
+                                      Explosion &out,
+                                      int &StackAllocSize);
   
   /// Does an ObjC method or C function with the given signature
   /// require an sret indirect result?
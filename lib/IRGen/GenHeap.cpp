@@ -802,7 +802,9 @@ void IRGenFunction::emitRetainCall(llvm::Value *value) {
     value = Builder.CreateBitCast(value, IGM.RefCountedPtrTy);
   
   // Emit the call.
-  llvm::CallInst *call = Builder.CreateCall(IGM.getRetainFn(), value);
+  auto fn = NonAtomicRefCounting ? IGM.getNonAtomicRetainFn()
+                                 : IGM.getRetainFn();
+  llvm::CallInst *call = Builder.CreateCall(fn, value);
   call->setCallingConv(IGM.RuntimeCC);
   call->setDoesNotThrow();
 }
@@ -909,7 +911,9 @@ llvm::Type *IRGenModule::getReferenceType(ReferenceCounting refcounting) {
 /// Emit a release of a live value.
 void IRGenFunction::emitRelease(llvm::Value *value) {
   if (doesNotRequireRefCounting(value)) return;
-  emitUnaryRefCountCall(*this, IGM.getReleaseFn(), value);
+  emitUnaryRefCountCall(*this, NonAtomicRefCounting
+                                 ? IGM.getNonAtomicReleaseFn()
+                                 : IGM.getReleaseFn(), value);
 }
 
 /// Fix the lifetime of a live value. This communicates to the LLVM level ARC
@@ -987,9 +991,71 @@ llvm::Value *IRGenFunction::emitLoadBridgeRefcountedPtr(Address addr) {
   return Builder.CreateLoad(src);
 }
 
+/// Emit the uniqueness check of a native object inline, as a relaxed load of
+/// its strong reference count. This must agree with
+/// StrongRefCount::isUniquelyReferenced and isUniquelyReferencedOrPinned in
+/// SwiftShims/RefCount.h.
+static llvm::Value *emitInlineIsUniqueNative(IRGenFunction &IGF,
+                                             llvm::Value *value,
+                                             bool isNonNull,
+                                             bool checkPinned) {
+  // The strong reference count is the second field of the object header.
+  // Its low bit is the pinned flag, the next bit the deallocating flag and
+  // the remaining bits the count.
+  const uint32_t pinnedFlag = 0x1;
+  const uint32_t countMask = ~uint32_t(0x3);
+  const uint32_t countOne = 0x4;
+
+  auto &IGM = IGF.IGM;
+  auto &Builder = IGF.Builder;
+
+  llvm::BasicBlock *entryBB = nullptr, *contBB = nullptr;
+  if (!isNonNull) {
+    auto nonNullBB = IGF.createBasicBlock("is-unique.nonnull");
+    contBB = IGF.createBasicBlock("is-unique.cont");
+    entryBB = Builder.GetInsertBlock();
+    auto isNull = Builder.CreateICmpEQ(value,
+                      llvm::ConstantPointerNull::get(IGM.RefCountedPtrTy));
+    Builder.CreateCondBr(isNull, contBB, nonNullBB);
+    Builder.emitBlock(nonNullBB);
+  }
+
+  Address object(value, IGM.getPointerAlignment());
+  Address refCountAddr = Builder.CreateStructGEP(object, 1,
+                                                 IGM.getPointerSize());
+  llvm::LoadInst *refCount = Builder.CreateLoad(refCountAddr);
+  refCount->setAtomic(llvm::Monotonic);
+
+  llvm::Value *count = Builder.CreateAnd(refCount, countMask);
+  llvm::Value *result = Builder.CreateICmpEQ(count,
+                                             Builder.getInt32(countOne));
+  if (checkPinned) {
+    llvm::Value *pinned = Builder.CreateAnd(refCount, pinnedFlag);
+    pinned = Builder.CreateICmpNE(pinned, Builder.getInt32(0));
+    result = Builder.CreateOr(result, pinned);
+  }
+
+  if (isNonNull)
+    return result;
+
+  auto nonNullEndBB = Builder.GetInsertBlock();
+  Builder.CreateBr(contBB);
+  Builder.emitBlock(contBB);
+  auto phi = Builder.CreatePHI(IGM.Int1Ty, 2);
+  phi->addIncoming(Builder.getFalse(), entryBB);
+  phi->addIncoming(result, nonNullEndBB);
+  return phi;
+}
+
 llvm::Value *IRGenFunction::
 emitIsUniqueCall(llvm::Value *value, SourceLoc loc, bool isNonNull,
                  bool checkPinned) {
+  // A runtime call is only needed if the object may be an ObjC object. The
+  // runtime entry points for native objects are kept without optimization,
+  // for their assertions and DTrace probes.
+  if (IGM.Opts.Optimize && value->getType() == IGM.RefCountedPtrTy)
+    return emitInlineIsUniqueNative(*this, value, isNonNull, checkPinned);
+
   llvm::Constant *fn;
   if (value->getType() == IGM.RefCountedPtrTy) {
     if (checkPinned) {
@@ -235,8 +235,14 @@ llvm::Value *irgen::emitObjCHeapMetadataRef(IRGenFunction &IGF,
   if (allowUninitialized) return classObject;
 
   // TODO: memoize this the same way that we memoize Swift type metadata?
-  return IGF.Builder.CreateCall(IGF.IGM.getGetInitializedObjCClassFn(),
-                                classObject);
+  // Initializing the class is idempotent, so the reference can be treated as
+  // a pure function of the class object.
+  auto call = IGF.Builder.CreateCall(IGF.IGM.getGetInitializedObjCClassFn(),
+                                     classObject);
+  call->setDoesNotThrow();
+  call->addAttribute(llvm::AttributeSet::FunctionIndex,
+                     llvm::Attribute::ReadNone);
+  return call;
 }
 
 /// Emit a reference to the type metadata for a foreign type.
@@ -299,9 +305,12 @@ static llvm::Value *emitNominalMetadataRef(IRGenFunction &IGF,
     // but only if we're doing Objective-C interop.
     if (IGF.IGM.ObjCInterop && isa<ClassDecl>(theDecl)) {
       metadata = IGF.Builder.CreateBitCast(metadata, IGF.IGM.ObjCClassPtrTy);
-      metadata = IGF.Builder.CreateCall(IGF.IGM.getGetInitializedObjCClassFn(),
-                                        metadata);
-      metadata = IGF.Builder.CreateBitCast(metadata, IGF.IGM.TypeMetadataPtrTy);
+      auto call = IGF.Builder.CreateCall(IGF.IGM.getGetInitializedObjCClassFn(),
+                                         metadata);
+      call->setDoesNotThrow();
+      call->addAttribute(llvm::AttributeSet::FunctionIndex,
+                         llvm::Attribute::ReadNone);
+      metadata = IGF.Builder.CreateBitCast(call, IGF.IGM.TypeMetadataPtrTy);
     }
 
     return metadata;
@@ -1158,6 +1167,11 @@ static llvm::Function *getTypeMetadataAccessFunction(IRGenModule &IGM,
     return emitDirectTypeMetadataRef(IGF, type);
   });
 
+  // Instantiations of generic types are what the runtime spends its time on
+  // at first use; let it do them ahead of time if we were asked to.
+  if (IGM.Opts.EmitMetadataPrefetchTable && isa<BoundGenericType>(type))
+    IGM.addMetadataPrefetchAccessor(accessor);
+
   return accessor;
 }
 
@@ -1896,8 +1910,43 @@ namespace {
   class NominalTypeDescriptorBuilderBase : public ConstantBuilder<> {
     Impl &asImpl() { return *static_cast<Impl*>(this); }
 
+    /// Stands in for the address of the descriptor while its fields are
+    /// being laid out, since the real variable can't be created until the
+    /// type of its initializer is known.
+    llvm::GlobalVariable *AddressPlaceholder = nullptr;
+
   public:
     NominalTypeDescriptorBuilderBase(IRGenModule &IGM) : ConstantBuilder(IGM) {}
+
+    /// Add a 32-bit offset from the current position in the descriptor to
+    /// the given target. A null target is represented by a zero offset.
+    void addRelativeAddress(llvm::Constant *target) {
+      if (target->isNullValue()) {
+        addConstantInt32(0);
+        return;
+      }
+
+      if (!AddressPlaceholder)
+        AddressPlaceholder = new llvm::GlobalVariable(IGM.Int8Ty,
+                                          /*constant*/ true,
+                                          llvm::GlobalValue::ExternalLinkage,
+                                          /*init*/ nullptr);
+
+      auto offset = llvm::ConstantInt::get(IGM.Int32Ty,
+                                           getNextOffset().getValue());
+      auto baseElt = llvm::ConstantExpr::getInBoundsGetElementPtr(IGM.Int8Ty,
+                                                  AddressPlaceholder, offset);
+      auto baseAddr = llvm::ConstantExpr::getPtrToInt(baseElt, IGM.SizeTy);
+      auto targetAddr = llvm::ConstantExpr::getPtrToInt(target, IGM.SizeTy);
+      llvm::Constant *relativeAddr
+        = llvm::ConstantExpr::getSub(targetAddr, baseAddr);
+
+      // Relative addresses can be 32-bit even on 64-bit platforms.
+      if (IGM.SizeTy != IGM.RelativeAddressTy)
+        relativeAddr = llvm::ConstantExpr::getTrunc(relativeAddr,
+                                                    IGM.RelativeAddressTy);
+      addInt32(relativeAddr);
+    }
     
     void layout() {
       asImpl().addKind();
@@ -1913,21 +1962,22 @@ namespace {
     
     void addName() {
       NominalTypeDecl *ntd = asImpl().getTarget();
-      addWord(getMangledTypeName(IGM,
-                                 ntd->getDeclaredType()->getCanonicalType()));
+      auto name = getMangledTypeName(IGM,
+                                     ntd->getDeclaredType()->getCanonicalType());
+      addRelativeAddress(name);
     }
     
     void addGenericMetadataPattern() {
       NominalTypeDecl *ntd = asImpl().getTarget();
       if (!ntd->getGenericParams()) {
         // If there are no generic parameters, there's no pattern to link.
-        addWord(llvm::ConstantPointerNull::get(IGM.TypeMetadataPatternPtrTy));
+        addConstantInt32(0);
         return;
       }
       
-      addWord(IGM.getAddrOfTypeMetadata(ntd->getDeclaredType()
-                                          ->getCanonicalType(),
-                                        /*pattern*/ true));
+      addRelativeAddress(IGM.getAddrOfTypeMetadata(ntd->getDeclaredType()
+                                                     ->getCanonicalType(),
+                                                   /*pattern*/ true));
     }
     
     void addGenericParams() {
@@ -1984,6 +2034,14 @@ namespace {
                                                          init->getType()));
       var->setConstant(true);
       var->setInitializer(init);
+
+      // Point the relative references at the real descriptor.
+      if (AddressPlaceholder) {
+        AddressPlaceholder->replaceAllUsesWith(
+                  llvm::ConstantExpr::getBitCast(var, IGM.Int8PtrTy));
+        delete AddressPlaceholder;
+        AddressPlaceholder = nullptr;
+      }
       return var;
     }
     
@@ -2304,14 +2362,14 @@ namespace {
       
       addConstantInt32(numFields);
       addConstantInt32InWords(FieldVectorOffset);
-      addWord(IGM.getAddrOfGlobalString(fieldNames));
+      addRelativeAddress(IGM.getAddrOfGlobalString(fieldNames));
       
       // Build the field type accessor function.
       llvm::Function *fieldTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                    Target->getStoredProperties());
       
-      addWord(fieldTypeVectorAccessor);
+      addRelativeAddress(fieldTypeVectorAccessor);
     }
   };
   
@@ -2388,14 +2446,14 @@ namespace {
       
       addConstantInt32(numFields);
       addConstantInt32InWords(FieldVectorOffset);
-      addWord(IGM.getAddrOfGlobalString(fieldNames));
+      addRelativeAddress(IGM.getAddrOfGlobalString(fieldNames));
       
       // Build the field type accessor function.
       llvm::Function *fieldTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                    Target->getStoredProperties());
       
-      addWord(fieldTypeVectorAccessor);
+      addRelativeAddress(fieldTypeVectorAccessor);
     }
   };
   
@@ -2478,14 +2536,14 @@ namespace {
       // # empty cases
       addConstantInt32(strategy.getElementsWithNoPayload().size());
 
-      addWord(strategy.emitCaseNames());
+      addRelativeAddress(strategy.emitCaseNames());
 
       // Build the case type accessor.
       llvm::Function *caseTypeVectorAccessor
         = getFieldTypeAccessorFn(IGM, Target,
                                  strategy.getElementsWithPayload());
       
-      addWord(caseTypeVectorAccessor);
+      addRelativeAddress(caseTypeVectorAccessor);
     }
   };
 }
@@ -2911,6 +2969,7 @@ namespace {
 
     bool HasRuntimeBase = false;
     bool HasRuntimeParent = false;
+    bool HasRuntimeFieldOffsets = false;
   public:
     /// The 'metadata flags' field in a class is actually a pointer to
     /// the metaclass object for the class.
@@ -3126,8 +3185,10 @@ namespace {
       if (auto offset = tryEmitClassConstantFragileFieldOffset(IGM,Target,var))
         addWord(offset);
       // Otherwise, leave a placeholder for the runtime to populate at runtime.
-      else
+      else {
         addWord(llvm::ConstantInt::get(IGM.IntPtrTy, 0));
+        HasRuntimeFieldOffsets = true;
+      }
     }
 
     void addMethod(SILDeclRef fn) {
@@ -3166,6 +3227,14 @@ namespace {
     bool hasRuntimeBase() const {
       return HasRuntimeBase;
     }
+
+    /// Returns true if the metadata is complete as emitted, so that nothing
+    /// writes to it at runtime. The ObjC runtime realizes every class it
+    /// knows about in place, so this is never true with ObjC interop.
+    bool isCompleteAtCompileTime() const {
+      return !IGM.ObjCInterop && !HasRuntimeBase && !HasRuntimeParent &&
+             !HasRuntimeFieldOffsets;
+    }
   };
 
   class ClassMetadataBuilder :
@@ -3628,6 +3697,7 @@ void irgen::emitClassMetadata(IRGenModule &IGM, ClassDecl *classDecl,
   llvm::Constant *init;
   bool isPattern;
   bool hasRuntimeBase;
+  bool isConstant = false;
   if (classDecl->isGenericContext()) {
     GenericClassMetadataBuilder builder(IGM, classDecl, layout);
     builder.layout();
@@ -3640,6 +3710,7 @@ void irgen::emitClassMetadata(IRGenModule &IGM, ClassDecl *classDecl,
     init = builder.getInit();
     isPattern = false;
     hasRuntimeBase = builder.hasRuntimeBase();
+    isConstant = builder.isCompleteAtCompileTime();
   }
 
   maybeEmitTypeMetadataAccessFunction(IGM, classDecl);
@@ -3653,12 +3724,10 @@ void irgen::emitClassMetadata(IRGenModule &IGM, ClassDecl *classDecl,
   if (classDecl->isObjC())
     section = "__DATA,__objc_data, regular";
 
+  // The metadata can be constant if nothing has to be filled in or adjusted
+  // at runtime, which keeps it out of pages that are dirtied at launch.
   auto var = IGM.defineTypeMetadata(declaredType, isIndirect, isPattern,
-               // TODO: the metadata global can actually be constant in a very
-               // special case: it's not a pattern, ObjC interoperation isn't
-               // required, there are no class fields, and there is nothing that
-               // needs to be runtime-adjusted.
-               /*isConstant*/ false, init, section);
+                                    isConstant, init, section);
 
   // Add non-generic classes to the ObjC class list.
   if (IGM.ObjCInterop && !isPattern && !isIndirect && !hasRuntimeBase) {    
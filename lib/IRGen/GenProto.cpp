@@ -395,6 +395,23 @@ public:
     : Conformance(C) {}
 
   llvm::Value *getTable(IRGenFunction &IGF, CanType type) const override {
+    // Reuse the table if it was already fetched in this function. This is
+    // the only caching for dependent types in unspecialized generic code.
+    if (auto wtable = IGF.tryGetLocalWitnessTable(type, Conformance))
+      return wtable;
+
+    llvm::Value *wtable = emitTable(IGF, type);
+    IGF.setScopedLocalWitnessTable(type, Conformance, wtable);
+    return wtable;
+  }
+
+  llvm::Constant *tryGetConstantTable(IRGenModule &IGM,
+                                      CanType conformingType) const override {
+    return nullptr;
+  }
+
+private:
+  llvm::Value *emitTable(IRGenFunction &IGF, CanType type) const {
     // If the conformance isn't generic, or we're looking up a dependent
     // type, we don't want to / can't cache the result.
     if (!Conformance->getDeclContext()->isGenericContext() ||
@@ -412,11 +429,6 @@ public:
 
     return call;
   }
-
-  llvm::Constant *tryGetConstantTable(IRGenModule &IGM,
-                                      CanType conformingType) const override {
-    return nullptr;
-  }
 };
 
 } //end anonymous namespace
@@ -244,6 +244,16 @@ protected:
       ExplosionSize(explosionSize) {}
 
 private:
+  void copyFields(IRGenFunction &IGF, Explosion &src, Explosion &dest) const {
+    for (auto &field : getFields())
+      cast<LoadableTypeInfo>(field.getTypeInfo()).copy(IGF, src, dest);
+  }
+
+  void consumeFields(IRGenFunction &IGF, Explosion &src) const {
+    for (auto &field : getFields())
+      cast<LoadableTypeInfo>(field.getTypeInfo()).consume(IGF, src);
+  }
+
   template <void (LoadableTypeInfo::*Op)(IRGenFunction &IGF,
                                          Address addr,
                                          Explosion &out) const>
@@ -304,13 +314,65 @@ public:
 
   void copy(IRGenFunction &IGF, Explosion &src,
             Explosion &dest) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo()).copy(IGF, src, dest);
+    if (shouldOutlineValueOperations(IGF.IGM, *this)) {
+      emitOutlinedCopy(IGF, *this, src, dest,
+                       [&](IRGenFunction &IGF, Explosion &src,
+                           Explosion &dest) {
+        copyFields(IGF, src, dest);
+      });
+      return;
+    }
+    copyFields(IGF, src, dest);
   }
       
   void consume(IRGenFunction &IGF, Explosion &src) const override {
-    for (auto &field : getFields())
-      cast<LoadableTypeInfo>(field.getTypeInfo()).consume(IGF, src);
+    if (shouldOutlineValueOperations(IGF.IGM, *this)) {
+      emitOutlinedConsume(IGF, *this, src,
+                          [&](IRGenFunction &IGF, Explosion &src) {
+        consumeFields(IGF, src);
+      });
+      return;
+    }
+    consumeFields(IGF, src);
+  }
+
+  // If the copy and consume operations are outlined, implement the
+  // operations on addresses in terms of them, so that they don't inline the
+  // field-by-field sequences again.
+
+  void assignWithCopy(IRGenFunction &IGF, Address dest,
+                      Address src, SILType T) const override {
+    if (!shouldOutlineValueOperations(IGF.IGM, *this))
+      return super::assignWithCopy(IGF, dest, src, T);
+
+    // Copy the new value before destroying the old one, in case they are
+    // the same.
+    Explosion srcValue, newValue, oldValue;
+    loadAsTake(IGF, src, srcValue);
+    copy(IGF, srcValue, newValue);
+    loadAsTake(IGF, dest, oldValue);
+    initialize(IGF, newValue, dest);
+    consume(IGF, oldValue);
+  }
+
+  void initializeWithCopy(IRGenFunction &IGF, Address dest,
+                          Address src, SILType T) const override {
+    if (!shouldOutlineValueOperations(IGF.IGM, *this))
+      return super::initializeWithCopy(IGF, dest, src, T);
+
+    Explosion srcValue, newValue;
+    loadAsTake(IGF, src, srcValue);
+    copy(IGF, srcValue, newValue);
+    initialize(IGF, newValue, dest);
+  }
+
+  void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
+    if (!shouldOutlineValueOperations(IGF.IGM, *this))
+      return super::destroy(IGF, addr, T);
+
+    Explosion value;
+    loadAsTake(IGF, addr, value);
+    consume(IGF, value);
   }
 
   void fixLifetime(IRGenFunction &IGF, Explosion &src) const override {
@@ -22,6 +22,7 @@
 #include "swift/SIL/SILModule.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/ErrorHandling.h"
 
 #include "EnumPayload.h"
@@ -43,9 +44,14 @@
 #include "UnownedTypeInfo.h"
 #include "WeakTypeInfo.h"
 
+#define DEBUG_TYPE "irgen-outlining"
+
 using namespace swift;
 using namespace irgen;
 
+STATISTIC(NumOutlinedCopies, "Number of copies emitted as outlined calls");
+STATISTIC(NumOutlinedConsumes, "Number of destroys emitted as outlined calls");
+
 llvm::DenseMap<TypeBase*, TypeCacheEntry> &
 TypeConverter::Types_t::getCacheFor(TypeBase *t) {
   return t->hasTypeParameter() ? DependentCache : IndependentCache;
@@ -387,6 +393,89 @@ void LoadableTypeInfo::initializeWithCopy(IRGenFunction &IGF,
   initialize(IGF, copy, destAddr);
 }
 
+bool irgen::shouldOutlineValueOperations(IRGenModule &IGM,
+                                         const LoadableTypeInfo &TI) {
+  unsigned threshold = IGM.Opts.OutlineValueOperationsThreshold;
+  return threshold != 0 && !TI.isPOD(ResilienceScope::Component) &&
+         TI.getExplosionSize() >= threshold;
+}
+
+void irgen::emitOutlinedCopy(IRGenFunction &IGF, const LoadableTypeInfo &TI,
+                             Explosion &src, Explosion &dest,
+          llvm::function_ref<void(IRGenFunction &IGF, Explosion &src,
+                                  Explosion &dest)> emitCopy) {
+  auto values = src.claim(TI.getExplosionSize());
+
+  // The copy returns the copied values as a literal struct.
+  SmallVector<llvm::Type *, 8> valueTys;
+  for (auto value : values)
+    valueTys.push_back(value->getType());
+  auto resultTy = llvm::StructType::get(IGF.IGM.getLLVMContext(), valueTys);
+  auto fnTy = llvm::FunctionType::get(resultTy, valueTys, false);
+
+  auto fn = IGF.IGM.getOrCreateOutlinedValueOperation(TI, /*isCopy*/ true,
+                                                      fnTy,
+                                                      [&](IRGenFunction &IGF) {
+    Explosion params = IGF.collectParameters();
+    Explosion copied;
+    emitCopy(IGF, params, copied);
+
+    llvm::Value *result = llvm::UndefValue::get(resultTy);
+    unsigned index = 0;
+    for (auto value : copied.claimAll())
+      result = IGF.Builder.CreateInsertValue(result, value, index++);
+    IGF.Builder.CreateRet(result);
+  });
+
+  // If the values don't match the outlined function, copy them inline.
+  if (!fn) {
+    Explosion inlineSrc;
+    inlineSrc.add(values);
+    emitCopy(IGF, inlineSrc, dest);
+    return;
+  }
+
+  auto call = IGF.Builder.CreateCall(fn, values);
+  call->setCallingConv(IGF.IGM.RuntimeCC);
+  call->setDoesNotThrow();
+  for (unsigned i = 0, e = values.size(); i != e; ++i)
+    dest.add(IGF.Builder.CreateExtractValue(call, i));
+  ++NumOutlinedCopies;
+}
+
+void irgen::emitOutlinedConsume(IRGenFunction &IGF, const LoadableTypeInfo &TI,
+                                Explosion &src,
+          llvm::function_ref<void(IRGenFunction &IGF,
+                                  Explosion &src)> emitConsume) {
+  auto values = src.claim(TI.getExplosionSize());
+
+  SmallVector<llvm::Type *, 8> valueTys;
+  for (auto value : values)
+    valueTys.push_back(value->getType());
+  auto fnTy = llvm::FunctionType::get(IGF.IGM.VoidTy, valueTys, false);
+
+  auto fn = IGF.IGM.getOrCreateOutlinedValueOperation(TI, /*isCopy*/ false,
+                                                      fnTy,
+                                                      [&](IRGenFunction &IGF) {
+    Explosion params = IGF.collectParameters();
+    emitConsume(IGF, params);
+    IGF.Builder.CreateRetVoid();
+  });
+
+  // If the values don't match the outlined function, consume them inline.
+  if (!fn) {
+    Explosion inlineSrc;
+    inlineSrc.add(values);
+    emitConsume(IGF, inlineSrc);
+    return;
+  }
+
+  auto call = IGF.Builder.CreateCall(fn, values);
+  call->setCallingConv(IGF.IGM.RuntimeCC);
+  call->setDoesNotThrow();
+  ++NumOutlinedConsumes;
+}
+
 LoadedRef LoadableTypeInfo::loadRefcountedPtr(IRGenFunction &IGF,
                                               SourceLoc loc,
                                               Address addr) const {
@@ -22,7 +22,9 @@
 #include "swift/AST/LinkLibrary.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/Basic/Dwarf.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/Basic/Platform.h"
+#include "swift/Basic/Version.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/LLVMPasses/PassesFwd.h"
 #include "swift/LLVMPasses/Passes.h"
@@ -43,8 +45,11 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -54,6 +59,7 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/ObjCARC.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "IRGenModule.h"
 
 #include <thread>
@@ -80,6 +86,12 @@ static void addSwiftStackPromotionPass(const PassManagerBuilder &Builder,
     PM.add(createSwiftStackPromotionPass());
 }
 
+static void addMergeFunctionsPass(const PassManagerBuilder &Builder,
+                                  PassManagerBase &PM) {
+  if (Builder.OptLevel > 0)
+    PM.add(createMergeFunctionsPass());
+}
+
 // FIXME: Copied from clang/lib/CodeGen/CGObjCMac.cpp. 
 // These should be moved to a single definition shared by clang and swift.
 enum ImageInfoFlags {
@@ -142,6 +154,14 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
     PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast,
                            addSwiftContractPass);
   }
+
+  // Generic specializations and thunks often end up with identical bodies,
+  // e.g. when they are specialized for types with the same layout. Merge them
+  // once everything else has run. LLVM keeps the externally visible symbols
+  // of merged functions as thunks or aliases, so linkage is preserved.
+  if (!Opts.DisableLLVMMergeFunctions)
+    PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast,
+                           addMergeFunctionsPass);
   
   // Configure the function passes.
   legacy::FunctionPassManager FunctionPasses(Module);
@@ -187,8 +207,11 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   }
 
   // If we're generating a profile, add the lowering pass now.
-  if (Opts.GenerateProfile)
+  if (Opts.GenerateProfile) {
     ModulePasses.add(createInstrProfilingPass());
+    if (Opts.ThreadLocalProfileCounters)
+      ModulePasses.add(createSwiftThreadLocalProfileCountersPass());
+  }
 
   if (Opts.Verify)
     ModulePasses.add(createVerifierPass());
@@ -197,13 +220,260 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   ModulePasses.run(*Module);
 }
 
+/// Creates a copy of \p TargetMachine for use on another thread.
+static std::unique_ptr<llvm::TargetMachine>
+cloneTargetMachine(llvm::TargetMachine *TargetMachine) {
+  return std::unique_ptr<llvm::TargetMachine>(
+    TargetMachine->getTarget().createTargetMachine(
+      TargetMachine->getTargetTriple().str(), TargetMachine->getTargetCPU(),
+      TargetMachine->getTargetFeatureString(), TargetMachine->Options,
+      TargetMachine->getRelocationModel(), TargetMachine->getCodeModel(),
+      TargetMachine->getOptLevel()));
+}
+
+/// Runs the LLVM optimization pipeline on \p Module in \p NumPartitions
+/// partitions in parallel.
+///
+/// An LLVMContext can't be used from several threads, so every partition is
+/// moved into a context of its own through bitcode. The optimized partitions
+/// are linked into a new module in \p MergedContext, which is returned.
+/// Returns null if anything goes wrong; \p Module is left untouched in that
+/// case and can still be optimized serially.
+///
+/// Each partition is optimized on its own, so nothing is inlined across
+/// partitions.
+static std::unique_ptr<llvm::Module>
+performParallelLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
+                                 llvm::TargetMachine *TargetMachine,
+                                 unsigned NumPartitions,
+                                 llvm::LLVMContext &MergedContext) {
+  // Work on a copy, because splitting consumes the module.
+  llvm::SmallString<0> ModuleBitcode;
+  {
+    llvm::raw_svector_ostream OS(ModuleBitcode);
+    llvm::WriteBitcodeToFile(Module, OS);
+  }
+  llvm::LLVMContext SplitContext;
+  auto SplitModule = llvm::parseBitcodeFile(
+    llvm::MemoryBufferRef(ModuleBitcode.str(), "split"), SplitContext);
+  if (!SplitModule)
+    return nullptr;
+
+  // A partition may only reference symbols of other partitions which are
+  // external, and the optimizer must not drop a definition just because its
+  // own partition doesn't use it. Make every such symbol a hidden external
+  // definition for the time being and restore its linkage after linking.
+  llvm::StringMap<std::pair<llvm::GlobalValue::LinkageTypes,
+                            llvm::GlobalValue::VisibilityTypes>> Linkages;
+  unsigned NumUnnamed = 0;
+  auto externalize = [&](llvm::GlobalValue &GV) {
+    if (GV.isDeclaration() || !GV.isDiscardableIfUnused() ||
+        GV.hasAvailableExternallyLinkage())
+      return;
+    if (!GV.hasName())
+      GV.setName("__swift_partition_unnamed." + Twine(NumUnnamed++));
+    Linkages[GV.getName()] = {GV.getLinkage(), GV.getVisibility()};
+    GV.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    GV.setVisibility(llvm::GlobalValue::HiddenVisibility);
+  };
+  for (auto &F : **SplitModule)
+    externalize(F);
+  for (auto &GV : (*SplitModule)->globals())
+    externalize(GV);
+  for (auto &GA : (*SplitModule)->aliases())
+    externalize(GA);
+
+  std::vector<llvm::SmallString<0>> Partitions;
+  llvm::SplitModule(std::move(*SplitModule), NumPartitions,
+                    [&](std::unique_ptr<llvm::Module> Partition) {
+    Partitions.emplace_back();
+    llvm::raw_svector_ostream OS(Partitions.back());
+    llvm::WriteBitcodeToFile(Partition.get(), OS);
+  });
+
+  // Optimize the partitions. Each thread replaces the bitcode of its
+  // partition with the optimized bitcode, or clears it on failure.
+  std::vector<std::thread> Threads;
+  for (auto &Bitcode : Partitions) {
+    Threads.emplace_back([&Opts, &Bitcode, TargetMachine] {
+      llvm::LLVMContext Context;
+      auto Partition = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(Bitcode.str(), "partition"), Context);
+      Bitcode.clear();
+      if (!Partition)
+        return;
+      auto PartitionTM = cloneTargetMachine(TargetMachine);
+      if (!PartitionTM)
+        return;
+      performLLVMOptimizations(Opts, Partition->get(), PartitionTM.get());
+      llvm::raw_svector_ostream OS(Bitcode);
+      llvm::WriteBitcodeToFile(Partition->get(), OS);
+    });
+  }
+  for (auto &Thread : Threads)
+    Thread.join();
+
+  std::unique_ptr<llvm::Module> Merged;
+  for (auto &Bitcode : Partitions) {
+    if (Bitcode.empty())
+      return nullptr;
+    auto Partition = llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(Bitcode.str(), "partition"), MergedContext);
+    if (!Partition)
+      return nullptr;
+    if (!Merged)
+      Merged = std::move(*Partition);
+    else if (llvm::Linker::LinkModules(Merged.get(), Partition->get()))
+      return nullptr;
+  }
+  if (!Merged)
+    return nullptr;
+
+  auto restore = [&](llvm::GlobalValue &GV) {
+    auto Found = Linkages.find(GV.getName());
+    if (Found == Linkages.end())
+      return;
+    GV.setLinkage(Found->second.first);
+    GV.setVisibility(Found->second.second);
+  };
+  for (auto &F : *Merged)
+    restore(F);
+  for (auto &GV : Merged->globals())
+    restore(GV);
+  for (auto &GA : Merged->aliases())
+    restore(GA);
+
+  // Local definitions which were inlined into all their callers are dead
+  // now that other partitions can't reference them.
+  legacy::PassManager CleanupPasses;
+  CleanupPasses.add(createGlobalDCEPass());
+  if (Opts.Verify)
+    CleanupPasses.add(createVerifierPass());
+  CleanupPasses.run(*Merged);
+  return Merged;
+}
+
+/// Returns the object cache key of \p Module, a hash of its bitcode and of
+/// everything else which influences code generation, so a changed module
+/// never hits a stale cache entry.
+///
+/// \p Pipeline describes the LLVM passes which still have to run on the
+/// module before code generation.
+static std::string getObjectCacheKey(const IRGenOptions &Opts,
+                                     llvm::Module *Module,
+                                     llvm::TargetMachine *TargetMachine,
+                                     StringRef Pipeline) {
+  std::string Bitcode;
+  llvm::raw_string_ostream BitcodeOS(Bitcode);
+  llvm::WriteBitcodeToFile(Module, BitcodeOS);
+  BitcodeOS.flush();
+
+  llvm::MD5 Hash;
+  auto addToHash = [&](StringRef Str) {
+    Hash.update(Str);
+    // Separate the components, so that different splits of the same bytes
+    // produce different keys.
+    Hash.update(StringRef("\0", 1));
+  };
+  addToHash(version::getSwiftFullVersion());
+  addToHash(TargetMachine->getTargetCPU());
+  addToHash(TargetMachine->getTargetFeatureString());
+  addToHash(Opts.Optimize ? "O" : "Onone");
+  addToHash(Opts.DisableLLVMMergeFunctions ? "no-merge-functions" : "");
+  addToHash(Pipeline);
+  addToHash(Bitcode);
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  return Key.str().str();
+}
+
+/// Returns the path of the cache entry \p Key with the given \p Extension.
+static std::string getObjectCacheFile(const IRGenOptions &Opts, StringRef Key,
+                                      StringRef Extension) {
+  SmallString<128> Path(Opts.ObjectCachePath);
+  llvm::sys::path::append(Path, Key + Extension);
+  return Path.str().str();
+}
+
+/// Returns the cached object file of the module which an earlier compilation
+/// optimized from an unoptimized module with the key \p InputKey, if any.
+static std::unique_ptr<llvm::MemoryBuffer>
+lookUpObjectForInput(const IRGenOptions &Opts, StringRef InputKey) {
+  auto ObjectKey =
+    llvm::MemoryBuffer::getFile(getObjectCacheFile(Opts, InputKey, ".input"));
+  if (!ObjectKey)
+    return nullptr;
+  auto Object = llvm::MemoryBuffer::getFile(
+      getObjectCacheFile(Opts, (*ObjectKey)->getBuffer(), ".o"));
+  if (!Object)
+    return nullptr;
+  return std::move(*Object);
+}
+
+/// Adds \p Contents to the object cache as \p CacheFile.
+///
+/// Failing to update the cache is not an error; the next compilation just
+/// doesn't find the entry.
+static void addToObjectCache(StringRef CacheFile, StringRef Contents) {
+  StringRef CacheDir = llvm::sys::path::parent_path(CacheFile);
+  if (llvm::sys::fs::create_directories(CacheDir))
+    return;
+
+  // Write to a temporary file and rename it, so that parallel compilations
+  // never read a partially written cache entry.
+  SmallString<128> TmpPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(CacheFile + "-%%%%%%%%", FD, TmpPath))
+    return;
+
+  llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+  OS << Contents;
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    llvm::sys::fs::remove(TmpPath);
+    return;
+  }
+  if (llvm::sys::fs::rename(TmpPath, CacheFile))
+    llvm::sys::fs::remove(TmpPath);
+}
+
+/// Returns the number of instructions in \p Module.
+static uint64_t getInstructionCount(const llvm::Module &Module) {
+  uint64_t Count = 0;
+  for (const llvm::Function &F : Module)
+    for (const llvm::BasicBlock &BB : F)
+      Count += BB.size();
+  return Count;
+}
+
+/// Records the memory allocated with malloc as in use at the end of \p P.
+/// While the LLVM modules are alive, most of it belongs to LLVM; the frontend
+/// accounts for the other subsystems once IRGen returns.
+static void recordMallocUsage(ASTContext &Ctx, FrontendStats::Phase P) {
+  if (!Ctx.Stats)
+    return;
+  FrontendStats::MemoryUsage Usage;
+  Usage[FrontendStats::MemoryCategory::Malloc] =
+    llvm::sys::Process::GetMallocUsage();
+  Ctx.Stats->recordMemoryUsage(P, Usage);
+}
+
 /// Run the LLVM passes. In multi-threaded compilation this will be done for
 /// multiple LLVM modules in parallel.
+///
+/// If \p NumOptThreads is greater than one, the optimization pipeline is run
+/// on that many partitions of \p Module in parallel. Code generation still
+/// happens in a single thread, since it produces a single output file.
 static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::sys::Mutex *DiagMutex,
                         llvm::Module *Module,
                         llvm::TargetMachine *TargetMachine,
-                        StringRef OutputFilename) {
+                        StringRef OutputFilename,
+                        unsigned NumOptThreads = 1) {
   llvm::SmallString<0> Buffer;
   std::unique_ptr<raw_pwrite_stream> RawOS;
   if (!OutputFilename.empty()) {
@@ -232,7 +502,69 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     RawOS.reset(new raw_svector_ostream(Buffer));
   }
 
-  performLLVMOptimizations(Opts, Module, TargetMachine);
+  // Partitioning needs a module that isn't handed back to the caller, and it
+  // would duplicate the debug info compile unit.
+  bool Partition = NumOptThreads > 1 && Opts.Optimize &&
+                   !Opts.DisableLLVMOptzns &&
+                   Opts.OutputKind != IRGenOutputKind::Module &&
+                   Opts.DebugInfoKind == IRGenDebugInfoKind::None;
+
+  // If there is an object cache, first look for the object which an earlier
+  // compilation produced from the same unoptimized module. In WMO, where
+  // each source file is its own LLVM module, this skips both the LLVM
+  // optimizations and code generation for every file whose IR didn't change.
+  bool UseObjectCache = !Opts.ObjectCachePath.empty() &&
+                        !OutputFilename.empty() &&
+                        Opts.OutputKind == IRGenOutputKind::ObjectFile;
+  std::string InputKey;
+  if (UseObjectCache) {
+    std::string Pipeline;
+    llvm::raw_string_ostream PipelineOS(Pipeline);
+    PipelineOS << "unoptimized"
+               << (Opts.DisableLLVMOptzns ? " no-llvm-optzns" : "")
+               << (Opts.DisableLLVMARCOpts ? " no-arc-opts" : "")
+               << (Opts.GenerateProfile ? " profile" : "")
+               << (Opts.ThreadLocalProfileCounters ? " tls-counters" : "");
+    if (Partition)
+      PipelineOS << " partitions=" << NumOptThreads;
+    InputKey = getObjectCacheKey(Opts, Module, TargetMachine,
+                                 PipelineOS.str());
+    if (auto Cached = lookUpObjectForInput(Opts, InputKey)) {
+      *RawOS << Cached->getBuffer();
+      return false;
+    }
+  }
+
+  llvm::LLVMContext MergedContext;
+  std::unique_ptr<llvm::Module> Merged;
+  if (Partition) {
+    Merged = performParallelLLVMOptimizations(Opts, Module, TargetMachine,
+                                              NumOptThreads, MergedContext);
+  }
+  if (Merged)
+    Module = Merged.get();
+  else
+    performLLVMOptimizations(Opts, Module, TargetMachine);
+
+  // Then look up the object file for the optimized module, since different
+  // inputs often optimize to the same module. On a miss, emit the object into
+  // a buffer, so that it can be written to both the output file and the
+  // cache.
+  std::string ObjectKey, CacheFile;
+  llvm::SmallString<0> ObjectBuffer;
+  std::unique_ptr<raw_svector_ostream> ObjectOS;
+  if (UseObjectCache) {
+    ObjectKey = getObjectCacheKey(Opts, Module, TargetMachine, "optimized");
+    CacheFile = getObjectCacheFile(Opts, ObjectKey, ".o");
+    if (auto Cached = llvm::MemoryBuffer::getFile(CacheFile)) {
+      *RawOS << (*Cached)->getBuffer();
+      addToObjectCache(getObjectCacheFile(Opts, InputKey, ".input"),
+                       ObjectKey);
+      return false;
+    }
+    ObjectOS.reset(new raw_svector_ostream(ObjectBuffer));
+  }
+  raw_pwrite_stream &EmitOS = ObjectOS ? *ObjectOS : *RawOS;
 
   legacy::PassManager EmitPasses;
 
@@ -263,7 +595,7 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     if (Opts.Optimize)
       EmitPasses.add(createObjCARCContractPass());
 
-    bool fail = TargetMachine->addPassesToEmitFile(EmitPasses, *RawOS,
+    bool fail = TargetMachine->addPassesToEmitFile(EmitPasses, EmitOS,
                                                    FileType, !Opts.Verify);
     if (fail) {
       if (DiagMutex)
@@ -278,6 +610,13 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
   }
 
   EmitPasses.run(*Module);
+
+  if (ObjectOS) {
+    StringRef Object = ObjectOS->str();
+    *RawOS << Object;
+    addToObjectCache(CacheFile, Object);
+    addToObjectCache(getObjectCacheFile(Opts, InputKey, ".input"), ObjectKey);
+  }
   return false;
 }
 
@@ -474,13 +813,32 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  if (Ctx.Stats)
+    Ctx.Stats->NumLLVMInstructions += getInstructionCount(*IGM.getModule());
+  recordMallocUsage(Ctx, FrontendStats::Phase::IRGen);
+  FrontendStats::PhaseTimer timer(Ctx.Stats, FrontendStats::Phase::LLVM);
+
+  // In whole-module mode without -num-threads the option is zero. With it,
+  // performParallelIRGeneration is used instead, so here it only applies to
+  // the single module of a primary-file job.
+  unsigned NumOptThreads = std::max(SILMod->getOptions().NumThreads, 1);
+
   embedBitcode(IGM.getModule(), Opts);
   if (performLLVM(IGM.Opts, IGM.Context.Diags, nullptr, IGM.getModule(),
-                  IGM.TargetMachine, IGM.OutputFilename))
+                  IGM.TargetMachine, IGM.OutputFilename, NumOptThreads))
     return nullptr;
+  recordMallocUsage(Ctx, FrontendStats::Phase::LLVM);
   return std::unique_ptr<llvm::Module>(IGM.releaseModule());
 }
 
+/// Deletes an IRGenModule of a multi-threaded compilation together with its
+/// LLVM module and LLVMContext.
+static void destroyGenModule(IRGenModule *IGM) {
+  LLVMContext *Context = &IGM->LLVMContext;
+  delete IGM;
+  delete Context;
+}
+
 static void ThreadEntryPoint(IRGenModuleDispatcher *dispatcher,
                              llvm::sys::Mutex *DiagMutex, int ThreadIdx) {
   while (IRGenModule *IGM = dispatcher->fetchFromQueue()) {
@@ -490,10 +848,16 @@ static void ThreadEntryPoint(IRGenModuleDispatcher *dispatcher,
           "\n";
       DiagMutex->unlock();
     );
+    DiagnosticEngine &Diags = IGM->Context.Diags;
     embedBitcode(IGM->getModule(), IGM->Opts);
-    performLLVM(IGM->Opts, IGM->Context.Diags, DiagMutex, IGM->getModule(),
+    performLLVM(IGM->Opts, Diags, DiagMutex, IGM->getModule(),
                 IGM->TargetMachine, IGM->OutputFilename);
-    if (IGM->Context.Diags.hadAnyError())
+
+    // Nothing refers to the module once its output file is written. Free it
+    // right away, so that the peak memory of the LLVM phase is not the sum of
+    // all modules. Only the modules in flight on the threads are kept alive.
+    destroyGenModule(IGM);
+    if (Diags.hadAnyError())
       return;
   }
   DEBUG(
@@ -652,6 +1016,19 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  if (Ctx.Stats) {
+    for (auto it = dispatcher.begin(); it != dispatcher.end(); ++it)
+      Ctx.Stats->NumLLVMInstructions +=
+        getInstructionCount(*it->second->getModule());
+  }
+  recordMallocUsage(Ctx, FrontendStats::Phase::IRGen);
+  Optional<FrontendStats::PhaseTimer> timer;
+  timer.emplace(Ctx.Stats, FrontendStats::Phase::LLVM);
+
+  // Hand out the most expensive modules first, so that a single large source
+  // file does not end up being compiled alone after all other threads are done.
+  dispatcher.sortQueueByEstimatedSize();
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -667,14 +1044,13 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   for (std::thread &Thread : Threads) {
     Thread.join();
   }
+  timer.reset();
+  recordMallocUsage(Ctx, FrontendStats::Phase::LLVM);
 
-  // Cleanup.
-  for (auto it = dispatcher.begin(); it != dispatcher.end(); ++it) {
-    IRGenModule *IGM = it->second;
-    LLVMContext *Context = &IGM->LLVMContext;
-    delete IGM;
-    delete Context;
-  }
+  // Cleanup. The threads already freed the modules they compiled. Only after
+  // an error there can be modules left in the queue.
+  while (IRGenModule *IGM = dispatcher.fetchFromQueue())
+    destroyGenModule(IGM);
 }
 
 
@@ -749,9 +1125,11 @@ bool swift::performLLVM(IRGenOptions &Opts, ASTContext &Ctx,
   if (!TargetMachine)
     return true;
 
+  FrontendStats::PhaseTimer timer(Ctx.Stats, FrontendStats::Phase::LLVM);
   embedBitcode(Module, Opts);
   if (::performLLVM(Opts, Ctx.Diags, nullptr, Module, TargetMachine,
                     Opts.getSingleOutputFilename()))
     return true;
+  recordMallocUsage(Ctx, FrontendStats::Phase::LLVM);
   return false;
 }
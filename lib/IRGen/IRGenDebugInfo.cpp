@@ -1222,6 +1222,16 @@ IRGenDebugInfo::getStructMembers(NominalTypeDecl *D, Type BaseTy,
 
 /// Create a temporary forward declaration for a struct and add it to
 /// the type cache so we can safely build recursive types.
+/// Whether the full definition of a nominal type is emitted by another
+/// Swift module, so that this one only needs to refer to it by its mangled
+/// name. The debugger can look the definition up in the defining module.
+static bool isDefinedInOtherSwiftModule(NominalTypeDecl *Decl,
+                                        IRGenModule &IGM) {
+  if (Decl->hasClangNode())
+    return false;
+  return Decl->getParentModule() != IGM.SILMod->getSwiftModule();
+}
+
 llvm::DICompositeType *IRGenDebugInfo::createStructType(
     DebugTypeInfo DbgTy, NominalTypeDecl *Decl, Type BaseTy,
     llvm::DIScope *Scope, llvm::DIFile *File, unsigned Line,
@@ -1229,6 +1239,12 @@ llvm::DICompositeType *IRGenDebugInfo::createStructType(
     llvm::DIType *DerivedFrom, unsigned RuntimeLang, StringRef UniqueID) {
   StringRef Name = Decl->getName().str();
 
+  // Don't repeat the members of types that are defined elsewhere.
+  if (!UniqueID.empty() && isDefinedInOtherSwiftModule(Decl, IGM))
+    return DBuilder.createForwardDecl(
+        llvm::dwarf::DW_TAG_structure_type, Name, Scope, File, Line,
+        llvm::dwarf::DW_LANG_Swift, SizeInBits, AlignInBits, UniqueID);
+
   // Forward declare this first because types may be recursive.
   auto FwdDecl = llvm::TempDIType(
     DBuilder.createReplaceableCompositeType(
@@ -1301,6 +1317,13 @@ llvm::DICompositeType *IRGenDebugInfo::createEnumType(
   unsigned SizeInBits = DbgTy.size.getValue() * SizeOfByte;
   unsigned AlignInBits = DbgTy.align.getValue() * SizeOfByte;
 
+  // Don't repeat the cases of types that are defined elsewhere.
+  if (!MangledName.empty() && isDefinedInOtherSwiftModule(Decl, IGM))
+    return DBuilder.createForwardDecl(
+        llvm::dwarf::DW_TAG_union_type, Decl->getName().str(), Scope, File,
+        Line, llvm::dwarf::DW_LANG_Swift, SizeInBits, AlignInBits,
+        MangledName);
+
   // FIXME: Is DW_TAG_union_type the right thing here?
   // Consider using a DW_TAG_variant_type instead.
   auto FwdDecl = llvm::TempDIType(
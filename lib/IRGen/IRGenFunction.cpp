@@ -226,24 +226,38 @@ llvm::Value *IRGenFunction::lookupTypeDataMap(CanType type, LocalTypeData index,
   auto it2 = scopedMap.find(key);
   if (it2 == scopedMap.end())
     return nullptr;
-  
-  if (auto *I = dyn_cast<llvm::Instruction>(it2->second)) {
+
+  if (isAvailableAtInsertionPoint(it2->second))
+    return it2->second;
+  return nullptr;
+}
+
+llvm::Value *
+IRGenFunction::tryGetLocalWitnessTable(CanType type,
+                                       const ProtocolConformance *conformance) {
+  auto it = ScopedWitnessTableMap.find({type.getPointer(), conformance});
+  if (it == ScopedWitnessTableMap.end())
+    return nullptr;
+
+  if (isAvailableAtInsertionPoint(it->second))
+    return it->second;
+  return nullptr;
+}
+
+bool IRGenFunction::isAvailableAtInsertionPoint(llvm::Value *value) {
+  if (auto *I = dyn_cast<llvm::Instruction>(value)) {
     // This is a very very simple dominance check: either the definition is in the
     // entry block or in the current block.
     // TODO: do a better dominance check.
-    if (I->getParent() == &CurFn->getEntryBlock() ||
-        I->getParent() == Builder.GetInsertBlock()) {
-      return I;
-    }
-    return nullptr;
-  }
-  
-  if (isa<llvm::Constant>(it2->second)) {
-    return it2->second;
+    return I->getParent() == &CurFn->getEntryBlock() ||
+           I->getParent() == Builder.GetInsertBlock();
   }
-  
+
+  if (isa<llvm::Constant>(value))
+    return true;
+
   // TODO: other kinds of value?
-  return nullptr;
+  return false;
 }
 
 void IRGenFunction::unimplemented(SourceLoc Loc, StringRef Message) {
@@ -45,6 +45,7 @@ namespace swift {
   class EnumType;
   class Pattern;
   class PatternBindingDecl;
+  class ProtocolConformance;
   class SILDebugScope;
   class SILType;
   class SourceLoc;
@@ -250,6 +251,10 @@ private:
 
 //--- Reference-counting methods -----------------------------------------------
 public:
+  /// If set, native strong retains and releases are emitted as calls to the
+  /// non-atomic runtime entry points.
+  bool NonAtomicRefCounting = false;
+
   llvm::Value *emitUnmanagedAlloc(const HeapLayout &layout,
                                   const llvm::Twine &name,
                                   const HeapNonFixedOffsets *offsets = 0);
@@ -379,6 +384,22 @@ public:
                   getLocalTypeDataKey(type.getSwiftRValueType(), index)] = data;
   }
 
+  /// Look for a witness table for the conformance of \p type, which was
+  /// already fetched in this function and is available at the Builder's
+  /// insertion point.
+  llvm::Value *tryGetLocalWitnessTable(CanType type,
+                                 const ProtocolConformance *conformance);
+
+  /// Add a witness table for the conformance of \p type, which is valid for
+  /// the containing block.
+  void setScopedLocalWitnessTable(CanType type,
+                                  const ProtocolConformance *conformance,
+                                  llvm::Value *wtable) {
+    assert(_isValidScopedLocalTypeData(wtable) &&
+           "witness table not inserted into the Builder's insert-block");
+    ScopedWitnessTableMap[{type.getPointer(), conformance}] = wtable;
+  }
+
   /// The kind of value LocalSelf is.
   enum LocalSelfKind {
     /// An object reference.
@@ -422,6 +443,11 @@ private:
   TypeDataMap ScopedTypeDataMap;
 
   TypeDataMap ScopedTypeDataMapForLayout;
+
+  llvm::DenseMap<std::pair<TypeBase *, const ProtocolConformance *>,
+                 llvm::Value *> ScopedWitnessTableMap;
+
+  bool isAvailableAtInsertionPoint(llvm::Value *value);
   
   /// The value that satisfies metadata lookups for dynamic Self.
   llvm::Value *LocalSelf = nullptr;
@@ -45,6 +45,7 @@
 #include "IRGenDebugInfo.h"
 #include "Linking.h"
 
+#include <algorithm>
 #include <initializer_list>
 
 using namespace swift;
@@ -773,6 +774,7 @@ void IRGenModule::cleanupClangCodeGenMetadata() {
 void IRGenModule::finalize() {
   emitLazyPrivateDefinitions();
   emitAutolinkInfo();
+  emitMetadataPrefetchTable();
   emitGlobalLists();
   if (DebugInfo)
     DebugInfo->finalize();
@@ -810,6 +812,36 @@ void IRGenModuleDispatcher::addGenModule(SourceFile *SF, IRGenModule *IGM) {
   Queue.push_back(IGM);
 }
 
+/// Returns a rough estimate of the work needed to compile \p M to an object
+/// file.
+static uint64_t estimateLLVMWork(llvm::Module *M) {
+  uint64_t Size = 0;
+  for (llvm::Function &F : *M) {
+    if (F.isDeclaration())
+      continue;
+    // Also count each function, so that modules with many small functions
+    // are not considered to be empty.
+    ++Size;
+    for (llvm::BasicBlock &BB : F)
+      Size += BB.size();
+  }
+  return Size;
+}
+
+void IRGenModuleDispatcher::sortQueueByEstimatedSize() {
+  assert(QueueIndex == 0 && "queue is already being processed");
+  llvm::DenseMap<IRGenModule *, uint64_t> EstimatedSize;
+  for (IRGenModule *IGM : Queue)
+    EstimatedSize[IGM] = estimateLLVMWork(IGM->getModule());
+
+  // Use a stable sort to keep the output order deterministic for modules of
+  // equal size.
+  std::stable_sort(Queue.begin(), Queue.end(),
+                   [&](IRGenModule *LHS, IRGenModule *RHS) {
+                     return EstimatedSize[LHS] > EstimatedSize[RHS];
+                   });
+}
+
 IRGenModule *IRGenModuleDispatcher::getGenModule(DeclContext *ctxt) {
   if (GenModules.size() == 1 || !ctxt) {
     return getPrimaryIGM();
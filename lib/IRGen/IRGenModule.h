@@ -31,6 +31,7 @@
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/IR/Attributes.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Target/TargetMachine.h"
 #include "IRGen.h"
 #include "SwiftTargetInfo.h"
@@ -237,6 +238,17 @@ public:
     return it->second;
   }
   
+  /// Reorder the queue of IRGenModules so that the modules with the most
+  /// estimated LLVM work are fetched first.
+  ///
+  /// The LLVM compilation time of a module is roughly proportional to the
+  /// number of instructions in its function definitions. Handing out the
+  /// largest modules first lets the threads which pick up the remaining small
+  /// modules balance the load, instead of a single large module determining
+  /// the critical path at the end. Must be called after all IR is emitted and
+  /// before any thread calls fetchFromQueue().
+  void sortQueueByEstimatedSize();
+
   /// In multi-threaded compilation fetch the next IRGenModule from the queue.
   IRGenModule *fetchFromQueue() {
     int idx = QueueIndex++;
@@ -508,6 +520,7 @@ public:
   void addUsedGlobal(llvm::GlobalValue *global);
   void addObjCClass(llvm::Constant *addr, bool nonlazy);
   void addProtocolConformanceRecord(NormalProtocolConformance *conformance);
+  void addMetadataPrefetchAccessor(llvm::Function *accessor);
 
   void addLazyFieldTypeAccessor(NominalTypeDecl *type,
                                 ArrayRef<FieldTypeInfo> fieldTypes,
@@ -519,10 +532,25 @@ public:
                                             ArrayRef<llvm::Type*> paramTypes,
                         llvm::function_ref<void(IRGenFunction &IGF)> generate);
 
+  llvm::Function *getOrCreateOutlinedValueOperation(const TypeInfo &TI,
+                                                    bool isCopy,
+                                                    llvm::FunctionType *fnTy,
+                        llvm::function_ref<void(IRGenFunction &IGF)> generate);
+
 private:
+  /// The outlined copy and consume functions of loadable types, keyed by the
+  /// type info and whether the function copies.
+  llvm::DenseMap<std::pair<const TypeInfo *, unsigned>, llvm::Function *>
+    OutlinedValueOperations;
+
   llvm::DenseMap<LinkEntity, llvm::Constant*> GlobalVars;
   llvm::DenseMap<LinkEntity, llvm::Constant*> GlobalGOTEquivalents;
   llvm::DenseMap<LinkEntity, llvm::Function*> GlobalFuncs;
+  /// The mangled names of link entities, allocated in MangledNameAllocator.
+  /// Mangling the same types and declarations over and over again is a
+  /// noticeable part of IRGen time.
+  llvm::DenseMap<LinkEntity, StringRef> MangledNames;
+  llvm::BumpPtrAllocator MangledNameAllocator;
   llvm::DenseSet<const clang::Decl *> GlobalClangDecls;
   llvm::StringMap<llvm::Constant*> GlobalStrings;
   llvm::StringMap<llvm::Constant*> GlobalUTF16Strings;
@@ -550,6 +578,9 @@ private:
   SmallVector<llvm::WeakVH, 4> ObjCCategories;
   /// List of protocol conformances to generate records for.
   SmallVector<NormalProtocolConformance *, 4> ProtocolConformances;
+  /// List of the accessors of generic type metadata which the runtime
+  /// instantiates eagerly when the image is loaded.
+  SmallVector<llvm::Function *, 4> MetadataPrefetchAccessors;
   /// List of ExtensionDecls corresponding to the generated
   /// categories.
   SmallVector<ExtensionDecl*, 4> ObjCCategoryDecls;
@@ -588,6 +619,7 @@ private:
 
   void emitGlobalLists();
   void emitAutolinkInfo();
+  void emitMetadataPrefetchTable();
   void cleanupClangCodeGenMetadata();
 
 //--- Runtime ---------------------------------------------------------------
@@ -668,6 +700,10 @@ public:
 
   llvm::Constant *getSize(Size size);
 
+  /// Returns the mangled name of \p entity, which stays valid for the
+  /// lifetime of this module.
+  StringRef getMangledName(const LinkEntity &entity);
+
   Address getAddrOfFieldOffset(VarDecl *D, bool isIndirect,
                                ForDefinition_t forDefinition);
   Address getAddrOfWitnessTableOffset(SILDeclRef fn,
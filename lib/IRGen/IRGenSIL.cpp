@@ -24,6 +24,7 @@
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/SaveAndRestore.h"
 #include "clang/AST/ASTContext.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Range.h"
@@ -290,9 +291,14 @@ public:
   llvm::DenseMap<SILValue, LoweredValue> LoweredValues;
   llvm::DenseMap<SILType, LoweredValue> LoweredUndefs;
 
-  /// All alloc_ref instructions which allocate the object on the stack.
+  /// All alloc_ref and partial_apply instructions which allocate the object
+  /// on the stack.
   llvm::SmallPtrSet<SILInstruction *, 8> StackAllocs;
 
+  /// The stack memory of all stack allocated closure contexts. Their lifetime
+  /// ends when the function returns.
+  llvm::SmallVector<llvm::Value *, 4> StackClosureContexts;
+
   /// Accumulative amount of allocated bytes on the stack. Used to limit the
   /// size for stack promoted objects.
   /// We calculate it on demand, so that we don't have to do it if the
@@ -1641,6 +1647,13 @@ void IRGenSILFunction::visitSILBasicBlock(SILBasicBlock *BB) {
         }
       }
     }
+    if (isa<ReturnInst>(&I) || isa<ThrowInst>(&I) ||
+        isa<AutoreleaseReturnInst>(&I)) {
+      // As for dealloc_ref [stack], this also prevents tail-call optimization
+      // of the final release of a stack allocated closure context.
+      for (llvm::Value *Context : StackClosureContexts)
+        Builder.CreateLifetimeEnd(Context);
+    }
     visit(&I);
   }
   
@@ -2188,13 +2201,29 @@ void IRGenSILFunction::visitPartialApplyInst(swift::PartialApplyInst *i) {
   std::tie(calleeFn, innerContext, origCalleeTy)
     = getPartialApplicationFunction(*this, i->getCallee());
   
+  int StackAllocSize = -1;
+  if (i->canAllocOnStack()) {
+    estimateStackSize();
+    // Is there enough space for stack allocation?
+    StackAllocSize = IGM.Opts.StackPromotionSizeLimit - EstimatedStackSize;
+  }
+
   // Create the thunk and function value.
   Explosion function;
   emitFunctionPartialApplication(*this, calleeFn, innerContext, llArgs,
                                  params, i->getSubstitutions(),
                                  origCalleeTy, i->getSubstCalleeType(),
                                  i->getType().castTo<SILFunctionType>(),
-                                 function);
+                                 function, StackAllocSize);
+  if (StackAllocSize >= 0) {
+    // Remember that this partial_apply allocates the context on the stack.
+    // The context is the result of swift_initStackObject on the alloca.
+    StackAllocs.insert(i);
+    auto *InitCall = cast<llvm::CallInst>(function.getAll().back());
+    StackClosureContexts.push_back(
+      InitCall->getArgOperand(1)->stripPointerCasts());
+    EstimatedStackSize += StackAllocSize;
+  }
   setLoweredExplosion(v, function);
 }
 
@@ -2909,6 +2938,7 @@ void IRGenSILFunction::visitCondBranchInst(swift::CondBranchInst *i) {
 void IRGenSILFunction::visitRetainValueInst(swift::RetainValueInst *i) {
   Explosion in = getLoweredExplosion(i->getOperand());
   Explosion out;
+  SaveAndRestore<bool> nonAtomic(NonAtomicRefCounting, i->isNonAtomic());
   cast<LoadableTypeInfo>(getTypeInfo(i->getOperand().getType()))
     .copy(*this, in, out);
   out.claimAll();
@@ -2926,6 +2956,7 @@ void IRGenSILFunction::visitAutoreleaseValueInst(swift::AutoreleaseValueInst *i)
 
 void IRGenSILFunction::visitReleaseValueInst(swift::ReleaseValueInst *i) {
   Explosion in = getLoweredExplosion(i->getOperand());
+  SaveAndRestore<bool> nonAtomic(NonAtomicRefCounting, i->isNonAtomic());
   cast<LoadableTypeInfo>(getTypeInfo(i->getOperand().getType()))
     .consume(*this, in);
 }
@@ -3186,12 +3217,14 @@ void IRGenSILFunction::visitStrongUnpinInst(swift::StrongUnpinInst *i) {
 void IRGenSILFunction::visitStrongRetainInst(swift::StrongRetainInst *i) {
   Explosion lowered = getLoweredExplosion(i->getOperand());
   auto &ti = cast<ReferenceTypeInfo>(getTypeInfo(i->getOperand().getType()));
+  SaveAndRestore<bool> nonAtomic(NonAtomicRefCounting, i->isNonAtomic());
   ti.retain(*this, lowered);
 }
 
 void IRGenSILFunction::visitStrongReleaseInst(swift::StrongReleaseInst *i) {
   Explosion lowered = getLoweredExplosion(i->getOperand());
   auto &ti = cast<ReferenceTypeInfo>(getTypeInfo(i->getOperand().getType()));
+  SaveAndRestore<bool> nonAtomic(NonAtomicRefCounting, i->isNonAtomic());
   ti.release(*this, lowered);
 }
 
@@ -4609,6 +4642,9 @@ static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
       Elts.push_back(getConstantFP(IGM, FLI));
     else if (auto *SLI = dyn_cast<StringLiteralInst>(SI->getOperand(i)))
       Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
+    else if (isa<EnumInst>(SI->getOperand(i)))
+      // Only nil class references are allowed, which are null pointers.
+      Elts.push_back(llvm::Constant::getNullValue(STy->getElementType(i)));
     else
       llvm_unreachable("Unexpected SILInstruction in static initializer!");
   }
@@ -4635,6 +4671,9 @@ static llvm::Constant *getConstantValue(IRGenModule &IGM, llvm::StructType *STy,
       Elts.push_back(getConstantFP(IGM, FLI));
     else if (auto *SLI = dyn_cast<StringLiteralInst>(TI->getOperand(i)))
       Elts.push_back(getAddrOfString(IGM, SLI->getValue(), SLI->getEncoding()));
+    else if (isa<EnumInst>(TI->getOperand(i)))
+      // Only nil class references are allowed, which are null pointers.
+      Elts.push_back(llvm::Constant::getNullValue(STy->getElementType(i)));
     else
       llvm_unreachable("Unexpected SILInstruction in static initializer!");
   }
@@ -4656,8 +4695,16 @@ void IRGenModule::emitSILStaticInitializer() {
     if (!gvar || !gvar->hasInitializer())
       continue;
 
+    auto *InitValue = v.getValueOfStaticInitializer();
+
+    // A nil class reference is a null pointer.
+    if (isa<EnumInst>(InitValue)) {
+      gvar->setInitializer(
+        llvm::Constant::getNullValue(gvar->getInitializer()->getType()));
+      continue;
+    }
+
     if (auto *STy = dyn_cast<llvm::StructType>(gvar->getInitializer()->getType())) {
-      auto *InitValue = v.getValueOfStaticInitializer();
 
       // Get the StructInst that we write to the SILGlobalVariable.
       if (auto *SI = dyn_cast<StructInst>(InitValue)) {
@@ -410,6 +410,11 @@ public:
 
   void mangle(llvm::raw_ostream &out) const;
   void mangle(SmallVectorImpl<char> &buffer) const;
+
+  /// Returns true if this entity is a SIL function, whose mangled name is
+  /// simply the function's name.
+  bool isSILFunction() const { return getKind() == Kind::SILFunction; }
+
   SILLinkage getLinkage(IRGenModule &IGM, ForDefinition_t isDefinition) const;
   
   /// Returns true if this function or global variable may be inlined into
@@ -138,6 +138,25 @@ public:
   static bool classof(const TypeInfo *type) { return type->isLoadable(); }
 };
 
+/// Should copies and destroys of values of the given aggregate type call
+/// outlined functions instead of being emitted inline?
+bool shouldOutlineValueOperations(IRGenModule &IGM,
+                                  const LoadableTypeInfo &TI);
+
+/// Copy the values of type \p TI from \p src to \p dest by calling an
+/// outlined function, which is generated with \p emitCopy.
+void emitOutlinedCopy(IRGenFunction &IGF, const LoadableTypeInfo &TI,
+                      Explosion &src, Explosion &dest,
+          llvm::function_ref<void(IRGenFunction &IGF, Explosion &src,
+                                  Explosion &dest)> emitCopy);
+
+/// Consume the values of type \p TI in \p src by calling an outlined
+/// function, which is generated with \p emitConsume.
+void emitOutlinedConsume(IRGenFunction &IGF, const LoadableTypeInfo &TI,
+                         Explosion &src,
+          llvm::function_ref<void(IRGenFunction &IGF,
+                                  Explosion &src)> emitConsume);
+
 }
 }
 
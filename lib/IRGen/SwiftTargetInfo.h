@@ -87,6 +87,10 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check for OnceDonePredicateValue must be an acquire
+  /// load. dispatch_once makes a plain load sufficient.
+  bool OnceDoneCheckNeedsAcquire = false;
 };
 
 }
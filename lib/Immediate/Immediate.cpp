@@ -26,6 +26,7 @@
 #include "swift/AST/Module.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILPasses/Passes.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/config.h"
@@ -185,6 +186,20 @@ bool swift::immediate::linkLLVMModules(llvm::Module *Module,
   return !Failed;
 }
 
+/// Returns true if \p M has code that has to be generated in this process,
+/// either because it was type-checked from source or because it carries
+/// serialized SIL. Everything else, such as the standard library and imported
+/// Clang modules, is already compiled into the libraries loaded at startup.
+static bool needsIRGen(const swift::Module *M) {
+  return std::any_of(M->getFiles().begin(), M->getFiles().end(),
+                     [](const FileUnit *File) -> bool {
+    if (isa<SourceFile>(File))
+      return true;
+    auto *SASTF = dyn_cast<SerializedASTFile>(File);
+    return SASTF && SASTF->isSIB();
+  });
+}
+
 bool swift::immediate::IRGenImportedModules(
     CompilerInstance &CI,
     llvm::Module &Module,
@@ -233,6 +248,11 @@ bool swift::immediate::IRGenImportedModules(
     if (!ImportedModules.insert(import).second)
       continue;
 
+    // Don't pay for SILGen, IRGen, and linking of modules that contribute no
+    // code of their own.
+    if (!needsIRGen(import))
+      continue;
+
     std::unique_ptr<SILModule> SILMod = performSILGeneration(import,
                                                              CI.getSILOptions());
     performSILLinking(SILMod.get());
@@ -45,6 +45,7 @@ class ARCEntryPointBuilder {
   NullablePtr<Constant> CheckUnowned;
   NullablePtr<Constant> RetainN;
   NullablePtr<Constant> ReleaseN;
+  NullablePtr<Constant> RetainUnownedN;
   NullablePtr<Constant> UnknownRetainN;
   NullablePtr<Constant> UnknownReleaseN;
   NullablePtr<Constant> BridgeRetainN;
@@ -125,6 +126,14 @@ public:
     return CI;
   }
 
+  CallInst *createRetainUnownedN(Value *V, uint32_t n) {
+    // Cast just to make sure that we have the right object type.
+    V = B.CreatePointerCast(V, getObjectPtrTy());
+    CallInst *CI = B.CreateCall(getRetainUnownedN(), {V, getIntConstant(n)});
+    CI->setTailCall(true);
+    return CI;
+  }
+
   CallInst *createUnknownRetainN(Value *V, uint32_t n) {
     // Cast just to make sure that we have the right object type.
     V = B.CreatePointerCast(V, getObjectPtrTy());
@@ -239,6 +248,22 @@ private:
     return ReleaseN.get();
   }
 
+  /// Return a callable function for swift_retainUnowned_n.
+  Constant *getRetainUnownedN() {
+    if (RetainUnownedN)
+      return RetainUnownedN.get();
+    auto *ObjectPtrTy = getObjectPtrTy();
+    auto &M = getModule();
+
+    auto *Int32Ty = Type::getInt32Ty(M.getContext());
+    auto AttrList = AttributeSet::get(
+        M.getContext(), AttributeSet::FunctionIndex, Attribute::NoUnwind);
+    RetainUnownedN = M.getOrInsertFunction("swift_retainUnowned_n", AttrList,
+                                           Type::getVoidTy(M.getContext()),
+                                           ObjectPtrTy, Int32Ty, nullptr);
+    return RetainUnownedN.get();
+  }
+
   /// getUnknownRetainN - Return a callable function for swift_unknownRetain_n.
   Constant *getUnknownRetainN() {
     if (UnknownRetainN)
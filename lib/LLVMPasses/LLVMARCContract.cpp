@@ -35,6 +35,9 @@ STATISTIC(NumUnknownRetainReleasesEliminatedByMergingIntoRetainReleaseN,
 STATISTIC(NumBridgeRetainReleasesEliminatedByMergingIntoRetainReleaseN,
           "Number of bridge retain/release eliminated by merging into "
           "bridgeRetain_n/bridgeRelease_n");
+STATISTIC(NumRetainsEliminatedByMergingIntoRetainUnownedN,
+          "Number of retain/retainUnowned eliminated by merging into "
+          "retainUnowned_n");
 
 /// Pimpl implementation of SwiftARCContractPass.
 namespace {
@@ -46,6 +49,21 @@ struct LocalState {
   TinyPtrVector<CallInst *> UnknownReleaseList;
   TinyPtrVector<CallInst *> BridgeRetainList;
   TinyPtrVector<CallInst *> BridgeReleaseList;
+
+  /// A retainUnowned and the retains and retainUnowneds of the same object
+  /// after it. Once the first one succeeded the object cannot be deallocating,
+  /// so they can all be done by a single retainUnowned_n.
+  TinyPtrVector<CallInst *> RetainUnownedList;
+
+  /// Set if the object was released after the first call in
+  /// RetainUnownedList. A later retainUnowned may then fail where the first
+  /// one succeeded, so nothing more is added to the list.
+  bool RetainUnownedListClosed = false;
+
+  void noteRelease() {
+    if (!RetainUnownedList.empty())
+      RetainUnownedListClosed = true;
+  }
 };
 
 /// This implements the very late (just before code generation) lowering
@@ -57,6 +75,8 @@ struct LocalState {
 ///
 ///   - Merging together retain and release calls into retain_n, release_n
 ///   - calls.
+///   - Merging a retainUnowned and the retains after it into a
+///     retainUnowned_n call.
 ///
 /// Coming into this function, we assume that the code is in canonical form:
 /// none of these calls have any uses of their return values.
@@ -208,6 +228,26 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
       NumBridgeRetainReleasesEliminatedByMergingIntoRetainReleaseN--;
     }
     BridgeReleaseList.clear();
+
+    auto &RetainUnownedList = P.second.RetainUnownedList;
+    if (RetainUnownedList.size() > 1) {
+      // Create the retainUnownedN call right by the first retainUnowned, which
+      // performs the check for all of them.
+      B.setInsertPoint(RetainUnownedList[0]);
+      O = RetainUnownedList[0]->getArgOperand(0);
+      B.createRetainUnownedN(RC->getSwiftRCIdentityRoot(O),
+                             RetainUnownedList.size());
+
+      // Remove all old retain instructions.
+      for (auto *Inst : RetainUnownedList) {
+        Inst->eraseFromParent();
+        NumRetainsEliminatedByMergingIntoRetainUnownedN++;
+      }
+
+      NumRetainsEliminatedByMergingIntoRetainUnownedN--;
+    }
+    RetainUnownedList.clear();
+    P.second.RetainUnownedListClosed = false;
   }
 }
 
@@ -225,6 +265,7 @@ bool SwiftARCContractImpl::run() {
       // These instructions should not reach here based on the pass ordering.
       // i.e. LLVMARCOpt -> LLVMContractOpt.
       case RT_RetainN:
+      case RT_RetainUnownedN:
       case RT_UnknownRetainN:
       case RT_BridgeRetainN:
       case RT_ReleaseN:
@@ -242,7 +283,20 @@ bool SwiftARCContractImpl::run() {
         auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
 
         LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.RetainList.push_back(CI);
+        if (!LocalEntry.RetainUnownedList.empty() &&
+            !LocalEntry.RetainUnownedListClosed)
+          LocalEntry.RetainUnownedList.push_back(CI);
+        else
+          LocalEntry.RetainList.push_back(CI);
+        continue;
+      }
+      case RT_RetainUnowned: {
+        auto *CI = cast<CallInst>(&Inst);
+        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+
+        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+        if (!LocalEntry.RetainUnownedListClosed)
+          LocalEntry.RetainUnownedList.push_back(CI);
         continue;
       }
       case RT_UnknownRetain: {
@@ -260,6 +314,7 @@ bool SwiftARCContractImpl::run() {
 
         LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
         LocalEntry.ReleaseList.push_back(CI);
+        LocalEntry.noteRelease();
         continue;
       }
       case RT_UnknownRelease: {
@@ -269,6 +324,7 @@ bool SwiftARCContractImpl::run() {
 
         LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
         LocalEntry.UnknownReleaseList.push_back(CI);
+        LocalEntry.noteRelease();
         continue;
       }
       case RT_BridgeRetain: {
@@ -285,12 +341,12 @@ bool SwiftARCContractImpl::run() {
 
         LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
         LocalEntry.BridgeReleaseList.push_back(CI);
+        LocalEntry.noteRelease();
         continue;
       }
       case RT_Unknown:
       case RT_AllocObject:
       case RT_NoMemoryAccessed:
-      case RT_RetainUnowned:
       case RT_CheckUnowned:
       case RT_ObjCRelease:
       case RT_ObjCRetain:
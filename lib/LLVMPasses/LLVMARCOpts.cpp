@@ -58,6 +58,8 @@ STATISTIC(NumAllocateReleasePairs,
           "Number of swift allocate/release pairs eliminated");
 STATISTIC(NumStoreOnlyObjectsEliminated,
           "Number of swift stored-only objects eliminated");
+STATISTIC(NumGlobalRetainReleasePairs,
+          "Number of swift retain/release pairs eliminated across blocks");
 STATISTIC(NumUnknownRetainReleaseSRed,
           "Number of unknownretain/release strength reduced to retain/release");
 
@@ -92,6 +94,7 @@ static bool canonicalizeInputFunction(Function &F, ARCEntryPointBuilder &B,
       // These instructions should not reach here based on the pass ordering.
       // i.e. LLVMARCOpt -> LLVMContractOpt.
       case RT_RetainN:
+      case RT_RetainUnownedN:
       case RT_UnknownRetainN:
       case RT_BridgeRetainN:
       case RT_ReleaseN:
@@ -279,6 +282,7 @@ static bool performLocalReleaseMotion(CallInst &Release, BasicBlock &BB,
     case RT_UnknownRetainN:
     case RT_BridgeRetainN:
     case RT_RetainN:
+    case RT_RetainUnownedN:
     case RT_UnknownReleaseN:
     case RT_BridgeReleaseN:
     case RT_ReleaseN:
@@ -427,6 +431,7 @@ static bool performLocalRetainMotion(CallInst &Retain, BasicBlock &BB,
     // These instructions should not reach here based on the pass ordering.
     // i.e. LLVMARCOpt -> LLVMContractOpt.
     case RT_RetainN:
+    case RT_RetainUnownedN:
     case RT_UnknownRetainN:
     case RT_BridgeRetainN:
     case RT_ReleaseN:
@@ -515,6 +520,95 @@ OutOfLoop:
 }
 
 
+//===----------------------------------------------------------------------===//
+//                         Global Retain() Motion
+//===----------------------------------------------------------------------===//
+
+/// Scan forward from the start of \p BB for a swift_release of \p Object,
+/// skipping only instructions that local retain motion could move a retain
+/// past. \returns the release, or null if something else was found first.
+static CallInst *findReleaseAtStartOfBlock(BasicBlock &BB, Value *Object,
+                                           SwiftRCIdentity *RC) {
+  for (Instruction &I : BB) {
+    switch (classifyInstruction(I)) {
+    case RT_NoMemoryAccessed:
+    case RT_AllocObject:
+    case RT_CheckUnowned:
+    case RT_FixLifetime:
+    case RT_Retain:
+    case RT_UnknownRetain:
+    case RT_BridgeRetain:
+    case RT_RetainUnowned:
+    case RT_ObjCRetain:
+      continue;
+
+    case RT_Release: {
+      CallInst &Release = cast<CallInst>(I);
+      if (RC->getSwiftRCIdentityRoot(Release.getArgOperand(0)) == Object)
+        return &Release;
+      return nullptr;
+    }
+
+    case RT_Unknown:
+      if (isa<TerminatorInst>(I))
+        return nullptr;
+      if (isa<LoadInst>(I) || isa<StoreInst>(I) || isa<MemIntrinsic>(I))
+        continue;
+      return nullptr;
+
+    default:
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+/// performGlobalRetainMotion - Local retain motion leaves a retain that it
+/// could not pair right before the terminator of its block. If every
+/// successor of that block is entered only from it and releases the same
+/// object before doing anything that could observe the retain count, the
+/// retain and all of those releases cancel out.
+///
+/// This catches the pairs that IRGen lowering leaves split across a branch,
+/// such as a retain before a switch on an enum and a release in each case.
+static bool performGlobalRetainMotion(Function &F, SwiftRCIdentity *RC) {
+  bool Changed = false;
+
+  for (BasicBlock &BB : F) {
+    TerminatorInst *Term = BB.getTerminator();
+    if (!isa<BranchInst>(Term) || Term->getIterator() == BB.begin())
+      continue;
+
+    auto &Retain = *std::prev(Term->getIterator());
+    if (classifyInstruction(Retain) != RT_Retain)
+      continue;
+    Value *RetainedObject =
+      RC->getSwiftRCIdentityRoot(cast<CallInst>(Retain).getArgOperand(0));
+
+    // Find a matching release at the start of every successor.
+    SmallVector<CallInst *, 2> Releases;
+    for (unsigned i = 0, e = Term->getNumSuccessors(); i != e; ++i) {
+      BasicBlock *Succ = Term->getSuccessor(i);
+      if (Succ->getSinglePredecessor() != &BB)
+        break;
+      CallInst *Release = findReleaseAtStartOfBlock(*Succ, RetainedObject, RC);
+      if (!Release)
+        break;
+      Releases.push_back(Release);
+    }
+    if (Releases.size() != Term->getNumSuccessors())
+      continue;
+
+    Retain.eraseFromParent();
+    for (CallInst *Release : Releases)
+      Release->eraseFromParent();
+    ++NumGlobalRetainReleasePairs;
+    Changed = true;
+  }
+
+  return Changed;
+}
+
 //===----------------------------------------------------------------------===//
 //                       Store-Only Object Elimination
 //===----------------------------------------------------------------------===//
@@ -577,6 +671,7 @@ static DtorKind analyzeDestructor(Value *P) {
       // These instructions should not reach here based on the pass ordering.
       // i.e. LLVMARCOpt -> LLVMContractOpt.
       case RT_RetainN:
+      case RT_RetainUnownedN:
       case RT_UnknownRetainN:
       case RT_BridgeRetainN:
       case RT_ReleaseN:
@@ -689,6 +784,7 @@ static bool performStoreOnlyObjectElimination(CallInst &Allocation,
     // These instructions should not reach here based on the pass ordering.
     // i.e. LLVMARCOpt -> LLVMContractOpt.
     case RT_RetainN:
+    case RT_RetainUnownedN:
     case RT_UnknownRetainN:
     case RT_BridgeRetainN:
     case RT_ReleaseN:
@@ -1017,5 +1113,9 @@ bool SwiftARCOpt::runOnFunction(Function &F) {
   //    escape.
   Changed |= performGeneralOptimizations(F, B, RC);
 
+  // Finally, pair up the retains that local motion pushed to the end of a
+  // block with releases in its successors.
+  Changed |= performGlobalRetainMotion(F, RC);
+
   return Changed;
 }
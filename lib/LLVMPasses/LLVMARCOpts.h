@@ -30,6 +30,9 @@ enum RT_Kind {
 
   /// void swift::swift_retainUnowned(HeapObject *object)
   RT_RetainUnowned,
+
+  /// void swift::swift_retainUnowned_n(HeapObject *object, uint32_t n)
+  RT_RetainUnownedN,
   
   /// void swift_checkUnowned(HeapObject *object)
   RT_CheckUnowned,
@@ -103,6 +106,7 @@ inline RT_Kind classifyInstruction(const llvm::Instruction &I) {
     .Case("objc_release", RT_ObjCRelease)
     .Case("objc_retain", RT_ObjCRetain)
     .Case("swift_retainUnowned", RT_RetainUnowned)
+    .Case("swift_retainUnowned_n", RT_RetainUnownedN)
     .Case("swift_checkUnowned", RT_CheckUnowned)
     .Case("swift_bridgeObjectRetain", RT_BridgeRetain)
     .Case("swift_bridgeObjectRetain_n", RT_BridgeRetainN)
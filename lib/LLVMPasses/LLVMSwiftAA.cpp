@@ -37,6 +37,7 @@ llvm::ModRefInfo SwiftAAResult::getModRefInfo(llvm::ImmutableCallSite CS,
   case RT_BridgeRetain:
   case RT_UnknownRetain:
   case RT_RetainN:
+  case RT_RetainUnownedN:
   case RT_UnknownRetainN:
   case RT_BridgeRetainN:
   case RT_FixLifetime:
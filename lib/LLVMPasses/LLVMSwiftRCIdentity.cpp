@@ -39,6 +39,7 @@ SwiftRCIdentity::stripReferenceForwarding(llvm::Value *Val) {
   auto Kind = classifyInstruction(*Inst);
   switch(Kind) {
   case RT_RetainN:
+  case RT_RetainUnownedN:
   case RT_UnknownRetainN:
   case RT_BridgeRetainN:
   case RT_ReleaseN:
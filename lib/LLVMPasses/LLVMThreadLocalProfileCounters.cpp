@@ -0,0 +1,223 @@
+//===--- LLVMThreadLocalProfileCounters.cpp - Per-thread counters ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass runs after InstrProfiling has lowered the profile counter
+// increments, and redirects the increments to a thread-local copy of each
+// counter array. Threads which run the same code then don't contend for the
+// cache lines of the shared counters.
+//
+// The module gets a merge function which adds the current thread's counts to
+// the shared counters. Every instrumented function registers it with
+// swift_registerThreadLocalProfileCounters the first time the current thread
+// enters any of them, and the runtime calls it when the thread exits.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-thread-local-profile-counters"
+#include "swift/LLVMPasses/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+
+using namespace llvm;
+using namespace swift;
+
+STATISTIC(NumThreadLocalCounterArrays,
+          "Number of profile counter arrays made thread-local");
+
+//===----------------------------------------------------------------------===//
+//                     SwiftThreadLocalProfileCounters Pass
+//===----------------------------------------------------------------------===//
+
+char SwiftThreadLocalProfileCounters::ID = 0;
+
+INITIALIZE_PASS_BEGIN(SwiftThreadLocalProfileCounters,
+                      "swift-thread-local-profile-counters",
+                      "Swift thread-local profile counters pass",
+                      false, false)
+INITIALIZE_PASS_END(SwiftThreadLocalProfileCounters,
+                    "swift-thread-local-profile-counters",
+                    "Swift thread-local profile counters pass",
+                    false, false)
+
+llvm::ModulePass *swift::createSwiftThreadLocalProfileCountersPass() {
+  initializeSwiftThreadLocalProfileCountersPass(
+    *llvm::PassRegistry::getPassRegistry());
+  return new SwiftThreadLocalProfileCounters();
+}
+
+/// Returns true if \p GV is an array of profile counters created by
+/// InstrProfiling.
+static bool isProfileCounterArray(const GlobalVariable &GV) {
+  return GV.hasSection() &&
+         StringRef(GV.getSection()).endswith("__llvm_prf_cnts") &&
+         isa<ArrayType>(GV.getType()->getElementType());
+}
+
+namespace {
+
+/// Redirects the uses of counter arrays in one function to their thread-local
+/// copies.
+class CounterRedirector {
+  /// The address of the first counter of each thread-local array, computed
+  /// once in the entry block.
+  DenseMap<GlobalVariable *, Instruction *> Bases;
+
+  Function &F;
+
+public:
+  CounterRedirector(Function &F) : F(F) {}
+
+  /// Returns the address of the first counter in \p Local. It is an
+  /// instruction rather than a constant, so that the thread-local address is
+  /// computed only once per call.
+  Instruction *getBase(GlobalVariable *Local) {
+    Instruction *&Base = Bases[Local];
+    if (!Base) {
+      Value *Zero = ConstantInt::get(Type::getInt32Ty(F.getContext()), 0);
+      Base = GetElementPtrInst::CreateInBounds(
+        Local->getType()->getElementType(), Local, {Zero, Zero},
+        Local->getName(), &*F.getEntryBlock().getFirstInsertionPt());
+    }
+    return Base;
+  }
+
+  /// Redirects \p I's use of \p Address, a constant address of a counter, to
+  /// the same counter in \p Local.
+  void redirect(Instruction *I, ConstantExpr *Address, GlobalVariable *Local) {
+    // Counters are addressed as 'getelementptr @counters, 0, <index>'.
+    if (Address->getOpcode() != Instruction::GetElementPtr ||
+        Address->getNumOperands() != 3 ||
+        !cast<Constant>(Address->getOperand(1))->isNullValue()) {
+      I->replaceUsesOfWith(Address,
+                           Address->getWithOperandReplaced(0, Local));
+      return;
+    }
+    Value *Counter = GetElementPtrInst::CreateInBounds(
+      getBase(Local), Address->getOperand(2), "", I);
+    I->replaceUsesOfWith(Address, Counter);
+  }
+};
+
+} // end anonymous namespace
+
+bool SwiftThreadLocalProfileCounters::runOnModule(Module &M) {
+  SmallVector<GlobalVariable *, 16> CounterArrays;
+  for (GlobalVariable &GV : M.globals())
+    if (isProfileCounterArray(GV))
+      CounterArrays.push_back(&GV);
+  if (CounterArrays.empty())
+    return false;
+
+  LLVMContext &Ctx = M.getContext();
+  MapVector<Function *, std::unique_ptr<CounterRedirector>> Redirectors;
+  SmallVector<std::pair<GlobalVariable *, GlobalVariable *>, 16> LocalArrays;
+
+  for (GlobalVariable *Counters : CounterArrays) {
+    Type *ArrayTy = Counters->getType()->getElementType();
+    auto *Local = new GlobalVariable(M, ArrayTy, /*constant*/ false,
+                                     GlobalValue::InternalLinkage,
+                                     Constant::getNullValue(ArrayTy),
+                                     Counters->getName() + ".thread",
+                                     nullptr,
+                                     GlobalValue::GeneralDynamicTLSModel);
+    Local->setAlignment(Counters->getAlignment());
+    LocalArrays.push_back({Counters, Local});
+    ++NumThreadLocalCounterArrays;
+
+    // The increments use constant addresses into the counter array. Other
+    // constants, like the profile data record, keep referring to the shared
+    // array.
+    SmallVector<User *, 8> Users(Counters->user_begin(), Counters->user_end());
+    for (User *U : Users) {
+      auto *Address = dyn_cast<ConstantExpr>(U);
+      if (!Address)
+        continue;
+      SmallVector<User *, 8> AddressUsers(Address->user_begin(),
+                                          Address->user_end());
+      for (User *AU : AddressUsers) {
+        auto *I = dyn_cast<Instruction>(AU);
+        if (!I)
+          continue;
+        Function *F = I->getParent()->getParent();
+        auto &Redirector = Redirectors[F];
+        if (!Redirector)
+          Redirector.reset(new CounterRedirector(*F));
+        Redirector->redirect(I, Address, Local);
+      }
+    }
+  }
+
+  // Create the merge function.
+  Type *VoidTy = Type::getVoidTy(Ctx);
+  Type *Int64PtrTy = Type::getInt64PtrTy(Ctx);
+  Type *SizeTy = M.getDataLayout().getIntPtrType(Ctx);
+  Constant *MergeCounters =
+    M.getOrInsertFunction("swift_mergeProfileCounters", VoidTy, Int64PtrTy,
+                          Int64PtrTy, SizeTy, nullptr);
+  auto *MergeTy = FunctionType::get(VoidTy, false);
+  Function *Merge = Function::Create(MergeTy, GlobalValue::InternalLinkage,
+                                     "__swift_merge_thread_profile_counters",
+                                     &M);
+  {
+    IRBuilder<> B(BasicBlock::Create(Ctx, "entry", Merge));
+    for (auto &Arrays : LocalArrays) {
+      auto *ArrayTy =
+        cast<ArrayType>(Arrays.first->getType()->getElementType());
+      B.CreateCall(MergeCounters, {
+        B.CreateConstInBoundsGEP2_32(ArrayTy, Arrays.first, 0, 0),
+        B.CreateConstInBoundsGEP2_32(ArrayTy, Arrays.second, 0, 0),
+        ConstantInt::get(SizeTy, ArrayTy->getNumElements())
+      });
+    }
+    B.CreateRetVoid();
+  }
+
+  // Register the merge function the first time the thread enters any of the
+  // instrumented functions.
+  Type *Int8Ty = Type::getInt8Ty(Ctx);
+  auto *Registered =
+    new GlobalVariable(M, Int8Ty, /*constant*/ false,
+                       GlobalValue::InternalLinkage,
+                       ConstantInt::get(Int8Ty, 0),
+                       "__swift_thread_profile_counters_registered", nullptr,
+                       GlobalValue::GeneralDynamicTLSModel);
+  Constant *Register =
+    M.getOrInsertFunction("swift_registerThreadLocalProfileCounters", VoidTy,
+                          Merge->getType(), nullptr);
+
+  for (auto &Entry : Redirectors) {
+    // Keep the allocas in the entry block.
+    BasicBlock &EntryBB = Entry.first->getEntryBlock();
+    Instruction *SplitBefore = &*EntryBB.getFirstInsertionPt();
+    for (Instruction &I : EntryBB)
+      if (isa<AllocaInst>(I))
+        SplitBefore = I.getNextNode();
+
+    IRBuilder<> B(SplitBefore);
+    Value *IsRegistered = B.CreateLoad(Registered);
+    Value *Cond = B.CreateICmpEQ(IsRegistered, ConstantInt::get(Int8Ty, 0));
+    TerminatorInst *Then = SplitBlockAndInsertIfThen(Cond, SplitBefore,
+                                                     /*unreachable*/ false);
+    B.SetInsertPoint(Then);
+    B.CreateStore(ConstantInt::get(Int8Ty, 1), Registered);
+    B.CreateCall(Register, {Merge});
+  }
+  return true;
+}
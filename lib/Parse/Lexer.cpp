@@ -28,6 +28,10 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -298,8 +302,156 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
       .fixItRemoveChars(NulLoc, NulEndLoc);
 }
 
+//===----------------------------------------------------------------------===//
+// Fast scanning of uninteresting runs
+//===----------------------------------------------------------------------===//
+//
+// Each of the skip* functions below returns a pointer into [Ptr, End] that is
+// no further than the first byte its caller needs to look at.  They never
+// consume anything the scalar code in the caller would have treated
+// specially, so they can stop early without changing the result.  When SSE2
+// is available they test 16 bytes at a time, and only read bytes before End.
+
+#if defined(__SSE2__)
+typedef __m128i Chunk;
+enum { ChunkSize = sizeof(Chunk) };
+
+static inline Chunk loadChunk(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const Chunk *>(Ptr));
+}
+
+static inline Chunk bytesEqual(Chunk Bytes, char C) {
+  return _mm_cmpeq_epi8(Bytes, _mm_set1_epi8(C));
+}
+
+static inline Chunk either(Chunk A, Chunk B) {
+  return _mm_or_si128(A, B);
+}
+
+/// Returns the offset of the first byte whose high bit is set in \p Stop, or
+/// ChunkSize if there is none.
+static inline unsigned firstStop(Chunk Stop) {
+  unsigned Mask = _mm_movemask_epi8(Stop);
+  return Mask ? llvm::countTrailingZeros(Mask) : unsigned(ChunkSize);
+}
+#endif
+
+/// Skip bytes in a // comment that are not '\n', '\r', a nul or part of a
+/// multi-byte UTF-8 sequence.
+static const char *skipPlainLineCommentBytes(const char *Ptr,
+                                             const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= ChunkSize) {
+    Chunk Bytes = loadChunk(Ptr);
+    // Non-ASCII bytes already have their high bit set.
+    Chunk Stop = either(either(bytesEqual(Bytes, '\n'),
+                               bytesEqual(Bytes, '\r')),
+                        either(bytesEqual(Bytes, 0), Bytes));
+    unsigned Offset = firstStop(Stop);
+    Ptr += Offset;
+    if (Offset != ChunkSize)
+      return Ptr;
+  }
+#endif
+  while (Ptr != End && (signed char)*Ptr > 0 && *Ptr != '\n' && *Ptr != '\r')
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skip bytes in a /* comment that need no attention: everything a // comment
+/// skips, except '*' and '/'.
+static const char *skipPlainBlockCommentBytes(const char *Ptr,
+                                              const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= ChunkSize) {
+    Chunk Bytes = loadChunk(Ptr);
+    Chunk Stop = either(either(either(bytesEqual(Bytes, '\n'),
+                                      bytesEqual(Bytes, '\r')),
+                               either(bytesEqual(Bytes, '*'),
+                                      bytesEqual(Bytes, '/'))),
+                        either(bytesEqual(Bytes, 0), Bytes));
+    unsigned Offset = firstStop(Stop);
+    Ptr += Offset;
+    if (Offset != ChunkSize)
+      return Ptr;
+  }
+#endif
+  while (Ptr != End && (signed char)*Ptr > 0 && *Ptr != '\n' && *Ptr != '\r' &&
+         *Ptr != '*' && *Ptr != '/')
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skip printable ASCII characters in the body of a string literal, stopping
+/// at quotes and backslashes.
+static const char *skipPlainStringLiteralBytes(const char *Ptr,
+                                               const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= ChunkSize) {
+    Chunk Bytes = loadChunk(Ptr);
+    // The signed comparison also catches every non-ASCII byte.
+    Chunk Stop = either(either(_mm_cmplt_epi8(Bytes, _mm_set1_epi8(' ')),
+                               bytesEqual(Bytes, 0x7F)),
+                        either(either(bytesEqual(Bytes, '"'),
+                                      bytesEqual(Bytes, '\'')),
+                               bytesEqual(Bytes, '\\')));
+    unsigned Offset = firstStop(Stop);
+    Ptr += Offset;
+    if (Offset != ChunkSize)
+      return Ptr;
+  }
+#endif
+  while (Ptr != End && isPrintable(*Ptr) && *Ptr != '"' && *Ptr != '\'' &&
+         *Ptr != '\\')
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skip spaces and horizontal tabs.
+static const char *skipSpacesAndTabs(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= ChunkSize) {
+    Chunk Bytes = loadChunk(Ptr);
+    Chunk Blank = either(bytesEqual(Bytes, ' '), bytesEqual(Bytes, '\t'));
+    unsigned Offset = firstStop(_mm_xor_si128(Blank, _mm_set1_epi8(-1)));
+    Ptr += Offset;
+    if (Offset != ChunkSize)
+      return Ptr;
+  }
+#endif
+  while (Ptr != End && (*Ptr == ' ' || *Ptr == '\t'))
+    ++Ptr;
+  return Ptr;
+}
+
+/// Skip ASCII identifier characters: [a-zA-Z0-9_$].
+static const char *skipASCIIIdentifierBytes(const char *Ptr,
+                                            const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= ChunkSize) {
+    Chunk Bytes = loadChunk(Ptr);
+    // Folding to lower case maps no non-letter in the ASCII range to a letter.
+    Chunk Lower = _mm_or_si128(Bytes, _mm_set1_epi8(0x20));
+    Chunk Letter = _mm_and_si128(_mm_cmpgt_epi8(Lower, _mm_set1_epi8('a' - 1)),
+                                 _mm_cmplt_epi8(Lower, _mm_set1_epi8('z' + 1)));
+    Chunk Digit = _mm_and_si128(_mm_cmpgt_epi8(Bytes, _mm_set1_epi8('0' - 1)),
+                                _mm_cmplt_epi8(Bytes, _mm_set1_epi8('9' + 1)));
+    Chunk Body = either(either(Letter, Digit),
+                        either(bytesEqual(Bytes, '_'), bytesEqual(Bytes, '$')));
+    unsigned Offset = firstStop(_mm_xor_si128(Body, _mm_set1_epi8(-1)));
+    Ptr += Offset;
+    if (Offset != ChunkSize)
+      return Ptr;
+  }
+#endif
+  while (Ptr != End && clang::isIdentifierBody(*Ptr, /*dollar*/true))
+    ++Ptr;
+  return Ptr;
+}
+
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipPlainLineCommentBytes(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -353,6 +505,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipPlainBlockCommentBytes(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -548,8 +701,10 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, taking runs of ASCII at once.
+  do {
+    CurPtr = skipASCIIIdentifierBytes(CurPtr, BufferEnd);
+  } while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1129,6 +1284,9 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    // Plain characters can't end the literal or need diagnosing.
+    CurPtr = skipPlainStringLiteralBytes(CurPtr, BufferEnd);
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
@@ -1465,6 +1623,9 @@ Restart:
 
   case ' ':
   case '\t':
+    CurPtr = skipSpacesAndTabs(CurPtr, BufferEnd);
+    goto Restart;  // Skip whitespace.
+
   case '\f':
   case '\v':
     goto Restart;  // Skip whitespace.
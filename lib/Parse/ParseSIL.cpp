@@ -1926,11 +1926,25 @@ bool SILParser::parseSILInstruction(SILBasicBlock *BB) {
     if (parseTypedValueRef(Val, B)) return true; \
     ResultVal = B.create##ID(InstLoc, Val);   \
     break;
+#define REFCOUNTING_INSTRUCTION(ID) \
+  case ValueKind::ID##Inst: {                            \
+    bool isNonAtomic = false;                            \
+    if (parseSILOptional(isNonAtomic, *this, "nonatomic") || \
+        parseTypedValueRef(Val, B))                      \
+      return true;                                       \
+    auto *RCI = B.create##ID(InstLoc, Val);              \
+    RCI->setNonAtomic(isNonAtomic);                      \
+    ResultVal = RCI;                                     \
+    break;                                               \
+  }
+  REFCOUNTING_INSTRUCTION(StrongRetain)
+  REFCOUNTING_INSTRUCTION(StrongRelease)
+  REFCOUNTING_INSTRUCTION(ReleaseValue)
+  REFCOUNTING_INSTRUCTION(RetainValue)
+#undef REFCOUNTING_INSTRUCTION
   UNARY_INSTRUCTION(FixLifetime)
   UNARY_INSTRUCTION(CopyBlock)
   UNARY_INSTRUCTION(StrongPin)
-  UNARY_INSTRUCTION(StrongRetain)
-  UNARY_INSTRUCTION(StrongRelease)
   UNARY_INSTRUCTION(StrongRetainAutoreleased)
   UNARY_INSTRUCTION(StrongUnpin)
   UNARY_INSTRUCTION(AutoreleaseReturn)
@@ -1941,8 +1955,6 @@ bool SILParser::parseSILInstruction(SILBasicBlock *BB) {
   UNARY_INSTRUCTION(IsUniqueOrPinned)
   UNARY_INSTRUCTION(DestroyAddr)
   UNARY_INSTRUCTION(AutoreleaseValue)
-  UNARY_INSTRUCTION(ReleaseValue)
-  UNARY_INSTRUCTION(RetainValue)
   UNARY_INSTRUCTION(Load)
   UNARY_INSTRUCTION(CondFail)
   UNARY_INSTRUCTION(DebugValue)
@@ -3326,6 +3338,11 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
   bool IsNonThrowingApply = false;
   if (parseSILOptional(IsNonThrowingApply, *this, "nothrow"))
     return true;
+
+  bool IsOnStack = false;
+  if (Opcode == ValueKind::PartialApplyInst &&
+      parseSILOptional(IsOnStack, *this, "stack"))
+    return true;
   
   if (parseValueName(FnName))
     return true;
@@ -3418,8 +3435,11 @@ bool SILParser::parseCallInstruction(SILLocation InstLoc,
     SILType closureTy =
       SILBuilder::getPartialApplyResultType(Ty, ArgNames.size(), SILMod, subs);
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
-    ResultVal = B.createPartialApply(InstLoc, FnVal, FnTy,
+    auto *PAI = B.createPartialApply(InstLoc, FnVal, FnTy,
                                      subs, Args, closureTy);
+    if (IsOnStack)
+      PAI->setStackAllocatable();
+    ResultVal = PAI;
     break;
   }
   case ValueKind::TryApplyInst: {
@@ -13,8 +13,12 @@
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILBasicBlock.h"
 #include "swift/SIL/Dominance.h"
+#include "swift/Basic/Range.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/GenericDomTree.h"
 #include "llvm/Support/GenericDomTreeConstruction.h"
+#include <queue>
 
 using namespace swift;
 
@@ -64,6 +68,284 @@ void DominanceInfo::verify() const {
   }
 }
 
+/// Returns the depth of \p Node in the tree, caching the depths of it and its
+/// dominators in \p Levels.
+static unsigned
+getLevel(DominanceInfoNode *Node,
+         llvm::DenseMap<DominanceInfoNode *, unsigned> &Levels) {
+  SmallVector<DominanceInfoNode *, 16> Path;
+  unsigned Level = 0;
+  bool Found = false;
+  for (; Node; Node = Node->getIDom()) {
+    auto It = Levels.find(Node);
+    if (It != Levels.end()) {
+      Level = It->second;
+      Found = true;
+      break;
+    }
+    Path.push_back(Node);
+  }
+  for (auto *PathNode : reversed(Path)) {
+    Level = Found ? Level + 1 : 0;
+    Found = true;
+    Levels[PathNode] = Level;
+  }
+  return Level;
+}
+
+/// Compute the immediate dominators of the blocks in \p Region, which must be
+/// dominated by \p Root and only be reachable through it, with the iterative
+/// algorithm from "A Simple, Fast Dominance Algorithm" (Cooper, Harvey and
+/// Kennedy). Predecessors outside \p Region are ignored.
+///
+/// \p RPO receives the blocks in reverse post-order, starting with \p Root.
+/// \returns false if some block in \p Region is not reachable from \p Root.
+static bool
+computeRegionIDoms(SILBasicBlock *Root,
+                   const llvm::SmallPtrSetImpl<SILBasicBlock *> &Region,
+                   SmallVectorImpl<SILBasicBlock *> &RPO,
+                   llvm::DenseMap<SILBasicBlock *, SILBasicBlock *> &IDoms) {
+  SmallVector<SILBasicBlock *, 32> PostOrder;
+  llvm::SmallPtrSet<SILBasicBlock *, 32> Visited;
+  SmallVector<std::pair<SILBasicBlock *, unsigned>, 32> DFSStack;
+  DFSStack.push_back({Root, 0});
+  Visited.insert(Root);
+  while (!DFSStack.empty()) {
+    SILBasicBlock *BB = DFSStack.back().first;
+    auto Succs = BB->getSuccessors();
+    unsigned SuccIdx = DFSStack.back().second++;
+    if (SuccIdx == Succs.size()) {
+      PostOrder.push_back(BB);
+      DFSStack.pop_back();
+      continue;
+    }
+    SILBasicBlock *Succ = Succs[SuccIdx];
+    if (Region.count(Succ) && Visited.insert(Succ).second)
+      DFSStack.push_back({Succ, 0});
+  }
+  if (PostOrder.size() != Region.size())
+    return false;
+
+  llvm::DenseMap<SILBasicBlock *, unsigned> RPONumbers;
+  for (SILBasicBlock *BB : reversed(PostOrder)) {
+    RPONumbers[BB] = RPO.size();
+    RPO.push_back(BB);
+  }
+
+  auto intersect = [&](SILBasicBlock *A, SILBasicBlock *B) {
+    while (A != B) {
+      while (RPONumbers[A] > RPONumbers[B])
+        A = IDoms[A];
+      while (RPONumbers[B] > RPONumbers[A])
+        B = IDoms[B];
+    }
+    return A;
+  };
+
+  IDoms[Root] = Root;
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (SILBasicBlock *BB : RPO) {
+      if (BB == Root)
+        continue;
+      SILBasicBlock *NewIDom = nullptr;
+      for (SILBasicBlock *Pred : BB->getPreds()) {
+        if (!IDoms.count(Pred))
+          continue;
+        NewIDom = NewIDom ? intersect(Pred, NewIDom) : Pred;
+      }
+      assert(NewIDom && "block in the region has no processed predecessor");
+      SILBasicBlock *&IDom = IDoms[BB];
+      if (IDom != NewIDom) {
+        IDom = NewIDom;
+        Changed = true;
+      }
+    }
+  }
+  return true;
+}
+
+void DominanceInfo::insertEdge(SILBasicBlock *From, SILBasicBlock *To) {
+  // An edge from an unreachable block doesn't change anything.
+  if (!getNode(From))
+    return;
+
+  DominanceInfoNode *ToNode = getNode(To);
+  if (!ToNode) {
+    // To, and everything that was only unreachable because To was, can now
+    // only be reached through this edge. Compute their dominators, with From
+    // standing in for the rest of the function.
+    llvm::SmallPtrSet<SILBasicBlock *, 16> Region;
+    SmallVector<SILBasicBlock *, 16> Worklist;
+    Region.insert(From);
+    Region.insert(To);
+    Worklist.push_back(To);
+    while (!Worklist.empty()) {
+      SILBasicBlock *BB = Worklist.pop_back_val();
+      for (auto &Succ : BB->getSuccessors())
+        if (!getNode(Succ.getBB()) && Region.insert(Succ.getBB()).second)
+          Worklist.push_back(Succ.getBB());
+    }
+
+    SmallVector<SILBasicBlock *, 16> RPO;
+    llvm::DenseMap<SILBasicBlock *, SILBasicBlock *> IDoms;
+    if (!computeRegionIDoms(From, Region, RPO, IDoms)) {
+      recalculate(*From->getParent());
+      return;
+    }
+    for (SILBasicBlock *BB : RPO)
+      if (BB != From)
+        addNewBlock(BB, IDoms[BB]);
+
+    // Now add the edges from the newly reachable blocks back into the rest
+    // of the function.
+    for (SILBasicBlock *BB : RPO) {
+      if (BB == From)
+        continue;
+      for (auto &Succ : BB->getSuccessors())
+        if (!Region.count(Succ.getBB()) || Succ.getBB() == From)
+          insertEdge(BB, Succ.getBB());
+    }
+    return;
+  }
+
+  // The blocks whose immediate dominator changes all get the nearest common
+  // dominator of From and To as their new one. A block W is affected iff it
+  // is more than one level deeper than that dominator, and there is a path
+  // from To to W on which no block is shallower than W (Lemma 2.5 in "An
+  // Experimental Study of Dynamic Dominators", Georgiadis et al.). Find them
+  // by searching from To, deepest candidates first.
+  DominanceInfoNode *NCD = getNode(findNearestCommonDominator(From, To));
+  llvm::DenseMap<DominanceInfoNode *, unsigned> Levels;
+  unsigned NCDLevel = getLevel(NCD, Levels);
+  unsigned ToLevel = getLevel(ToNode, Levels);
+  if (NCDLevel + 1 >= ToLevel)
+    return;
+
+  using LevelAndNode = std::pair<unsigned, DominanceInfoNode *>;
+  auto Shallower = [](const LevelAndNode &LHS, const LevelAndNode &RHS) {
+    return LHS.first < RHS.first;
+  };
+  std::priority_queue<LevelAndNode, SmallVector<LevelAndNode, 8>,
+                      decltype(Shallower)> Bucket(Shallower);
+  llvm::SmallPtrSet<DominanceInfoNode *, 16> Affected, Visited;
+  SmallVector<DominanceInfoNode *, 16> AffectedInOrder, Unaffected;
+
+  Bucket.push({ToLevel, ToNode});
+  Affected.insert(ToNode);
+  while (!Bucket.empty()) {
+    unsigned RootLevel = Bucket.top().first;
+    DominanceInfoNode *Node = Bucket.top().second;
+    Bucket.pop();
+    AffectedInOrder.push_back(Node);
+
+    while (true) {
+      for (auto &Succ : Node->getBlock()->getSuccessors()) {
+        DominanceInfoNode *SuccNode = getNode(Succ.getBB());
+        assert(SuccNode && "successor of a reachable block is unreachable");
+        unsigned SuccLevel = getLevel(SuccNode, Levels);
+        if (SuccLevel > RootLevel) {
+          // Deeper blocks are not affected, but may lead to affected ones.
+          if (Visited.insert(SuccNode).second)
+            Unaffected.push_back(SuccNode);
+        } else if (SuccLevel > NCDLevel + 1 &&
+                   Affected.insert(SuccNode).second) {
+          Bucket.push({SuccLevel, SuccNode});
+        }
+      }
+      if (Unaffected.empty())
+        break;
+      Node = Unaffected.pop_back_val();
+    }
+  }
+
+  for (auto *Node : AffectedInOrder)
+    changeImmediateDominator(Node, NCD);
+}
+
+/// Returns true if \p BB is reachable from the entry through a predecessor it
+/// doesn't dominate.
+static bool hasProperSupport(DominanceInfo &DT, SILBasicBlock *BB) {
+  for (SILBasicBlock *Pred : BB->getPreds())
+    if (DT.getNode(Pred) && !DT.dominates(BB, Pred))
+      return true;
+  return false;
+}
+
+void DominanceInfo::deleteEdge(SILBasicBlock *From, SILBasicBlock *To) {
+  // An edge from an unreachable block didn't contribute anything.
+  if (!getNode(From) || !getNode(To))
+    return;
+
+  // Every path from the entry that used a back edge reached To before, so
+  // removing the edge doesn't change which blocks dominate which.
+  if (dominates(To, From))
+    return;
+
+  // If To became unreachable, blocks outside of its subtree may get deeper
+  // immediate dominators as well.
+  SILFunction *F = From->getParent();
+  DominanceInfoNode *Root = getNode(findNearestCommonDominator(From, To));
+  if (!hasProperSupport(*this, To) || !Root->getIDom()) {
+    recalculate(*F);
+    return;
+  }
+
+  // Otherwise only the blocks dominated by the nearest common dominator of
+  // From and To can get new immediate dominators, and all of them remain
+  // dominated by it. Recompute that subtree.
+  llvm::SmallPtrSet<SILBasicBlock *, 32> SubTree;
+  SmallVector<DominanceInfoNode *, 32> Worklist;
+  Worklist.push_back(Root);
+  while (!Worklist.empty()) {
+    DominanceInfoNode *Node = Worklist.pop_back_val();
+    SubTree.insert(Node->getBlock());
+    Worklist.append(Node->begin(), Node->end());
+  }
+
+  SmallVector<SILBasicBlock *, 32> RPO;
+  llvm::DenseMap<SILBasicBlock *, SILBasicBlock *> IDoms;
+  if (!computeRegionIDoms(Root->getBlock(), SubTree, RPO, IDoms)) {
+    recalculate(*F);
+    return;
+  }
+
+  for (SILBasicBlock *BB : RPO) {
+    DominanceInfoNode *Node = getNode(BB);
+    DominanceInfoNode *IDomNode = getNode(IDoms[BB]);
+    if (Node != Root && Node->getIDom() != IDomNode)
+      changeImmediateDominator(Node, IDomNode);
+  }
+}
+
+void DominanceInfo::splitBlock(SILBasicBlock *OrigBB, SILBasicBlock *NewBB) {
+  DominanceInfoNode *OrigNode = getNode(OrigBB);
+  if (!OrigNode)
+    return;
+
+  // NewBB is dominated by OrigBB, and takes over the blocks it dominated.
+  SmallVector<DominanceInfoNode *, 16> Adoptees(OrigNode->begin(),
+                                                OrigNode->end());
+  DominanceInfoNode *NewNode = addNewBlock(NewBB, OrigBB);
+  for (auto *Adoptee : Adoptees)
+    changeImmediateDominator(Adoptee, NewNode);
+}
+
+void DominanceInfo::mergeBlocks(SILBasicBlock *BB, SILBasicBlock *SuccBB) {
+  DominanceInfoNode *SuccNode = getNode(SuccBB);
+  if (!SuccNode)
+    return;
+
+  // BB takes over the blocks SuccBB dominated.
+  DominanceInfoNode *Node = getNode(BB);
+  SmallVector<DominanceInfoNode *, 8> Children(SuccNode->begin(),
+                                               SuccNode->end());
+  for (auto *Child : Children)
+    changeImmediateDominator(Child, Node);
+  eraseNode(SuccBB);
+}
+
 /// Compute the immmediate-post-dominators map.
 PostDominanceInfo::PostDominanceInfo(SILFunction *F)
   : DominatorTreeBase(/*isPostDom*/ true) {
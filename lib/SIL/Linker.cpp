@@ -17,6 +17,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include <functional>
 
@@ -24,6 +25,14 @@ using namespace swift;
 using namespace Lowering;
 
 STATISTIC(NumFuncLinked, "Number of SIL functions linked");
+STATISTIC(NumFuncSkipped, "Number of SIL functions too large to link");
+STATISTIC(NumFuncReferencesBatched,
+          "Number of distinct function references collected for linking");
+
+static llvm::cl::opt<unsigned> LinkAllBodySizeLimit(
+    "sil-link-all-body-size-limit", llvm::cl::init(0),
+    llvm::cl::desc("When linking everything, don't deserialize the bodies of "
+                   "functions with more instructions than this (0 = no limit)"));
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -45,6 +54,27 @@ static bool shouldImportFunction(SILFunction *F) {
   return true;
 }
 
+/// \return True if the serialized body of the declaration \p F is too large
+/// to be worth deserializing, judging by its summary alone.
+///
+/// Only functions that the optimizer could only ever inline are skipped:
+/// generic, transparent, shared and @_semantics functions are always linked,
+/// since specialization and the semantic passes depend on their bodies.
+static bool isTooLargeToLink(SerializedSILLoader *Loader, SILFunction *F) {
+  if (!LinkAllBodySizeLimit)
+    return false;
+  if (F->isTransparent() || hasSharedVisibility(F->getLinkage()))
+    return false;
+
+  auto Summary = Loader->lookupFunctionSummary(F->getName());
+  if (!Summary || !Summary->HasBody)
+    return false;
+  if (Summary->IsGeneric || Summary->IsTransparent ||
+      Summary->IsAlwaysInline || Summary->HasSemantics)
+    return false;
+  return Summary->NumInstructions > LinkAllBodySizeLimit;
+}
+
 //===----------------------------------------------------------------------===//
 //                               Linker Helpers
 //===----------------------------------------------------------------------===//
@@ -340,6 +370,60 @@ bool SILLinkerVisitor::visitMetatypeInst(MetatypeInst *MI) {
 //                             Top Level Routine
 //===----------------------------------------------------------------------===//
 
+/// Deserialize the body of \p F, which was referenced by a function we are
+/// processing, and add it to the worklist.
+///
+/// \return True if a new body was linked in.
+bool SILLinkerVisitor::linkReferencedFunction(SILFunction *F) {
+  if (!shouldImportFunction(F))
+    return false;
+
+  // The ExternalSource may wish to rewrite non-empty bodies.
+  if (!F->isExternalDeclaration() && ExternalSource) {
+    if (auto *NewFn = ExternalSource->lookupSILFunction(F)) {
+      if (NewFn->isExternalDeclaration())
+        return false;
+
+      NewFn->verify();
+      Worklist.push_back(NewFn);
+
+      // Notify client of new deserialized function.
+      if (Callback)
+        Callback(NewFn);
+
+      ++NumFuncLinked;
+      return true;
+    }
+  }
+
+  DEBUG(llvm::dbgs() << "Imported function: " << F->getName() << "\n");
+  F->setBare(IsBare);
+
+  if (!F->isExternalDeclaration())
+    return false;
+
+  if (isLinkAll() && isTooLargeToLink(Loader, F)) {
+    DEBUG(llvm::dbgs() << "Not linking large function: "
+                       << F->getName() << "\n");
+    ++NumFuncSkipped;
+    return false;
+  }
+
+  auto *NewFn = Loader->lookupSILFunction(F);
+  if (!NewFn || NewFn->isExternalDeclaration())
+    return false;
+
+  NewFn->verify();
+  Worklist.push_back(NewFn);
+
+  // Notify client of new deserialized function.
+  if (Callback)
+    Callback(NewFn);
+
+  ++NumFuncLinked;
+  return true;
+}
+
 // Main loop of the visitor. Called by one of the other *visit* methods.
 bool SILLinkerVisitor::process() {
   // Process everything transitively referenced by one of the functions in the
@@ -354,63 +438,25 @@ bool SILLinkerVisitor::process() {
     DEBUG(llvm::dbgs() << "Process imports in function: "
                        << Fn->getName() << "\n");
 
+    // Collect everything Fn references before deserializing any of it. A
+    // callee that is referenced many times, like an integer operator from the
+    // stdlib, is then only looked up once per function instead of once per
+    // reference.
     for (auto &BB : *Fn) {
       for (auto &I : BB) {
-        // Should we try linking?
-        if (visit(&I)) {
-          for (auto *F : FunctionDeserializationWorklist) {
-
-            if (!shouldImportFunction(F))
-              continue;
-
-            // The ExternalSource may wish to rewrite non-empty bodies.
-            if (!F->isExternalDeclaration() && ExternalSource) {
-              if (auto *NewFn = ExternalSource->lookupSILFunction(F)) {
-                if (NewFn->isExternalDeclaration())
-                  continue;
-
-                NewFn->verify();
-                Worklist.push_back(NewFn);
-
-                // Notify client of new deserialized function.
-                if (Callback)
-                  Callback(NewFn);
-
-                ++NumFuncLinked;
-                Result = true;
-                continue;
-              }
-            }
-
-            DEBUG(llvm::dbgs() << "Imported function: "
-                               << F->getName() << "\n");
-            F->setBare(IsBare);
-
-            if (F->isExternalDeclaration()) {
-              if (auto *NewFn = Loader->lookupSILFunction(F)) {
-                if (NewFn->isExternalDeclaration())
-                  continue;
-
-                NewFn->verify();
-                Worklist.push_back(NewFn);
-                Result = true;
-
-                // Notify client of new deserialized function.
-                if (Callback)
-                  Callback(NewFn);
-
-                ++NumFuncLinked;
-              }
-            }
-          }
-          FunctionDeserializationWorklist.clear();
-        } else {
-          assert(FunctionDeserializationWorklist.empty() &&
+        unsigned NumReferenced = FunctionDeserializationWorklist.size();
+        (void)NumReferenced;
+        if (!visit(&I))
+          assert(FunctionDeserializationWorklist.size() == NumReferenced &&
                  "Worklist should "
-                 "always be empty if visit does not return true.");
-        }
+                 "not grow if visit does not return true.");
       }
     }
+
+    NumFuncReferencesBatched += FunctionDeserializationWorklist.size();
+    for (auto *F : FunctionDeserializationWorklist)
+      Result |= linkReferencedFunction(F);
+    FunctionDeserializationWorklist.clear();
   }
 
   // If we return true, we deserialized at least one function.
@@ -18,6 +18,7 @@
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/Serialization/SerializedSILLoader.h"
+#include "llvm/ADT/SetVector.h"
 #include <functional>
 
 namespace swift {
@@ -38,9 +39,9 @@ class SILLinkerVisitor : public SILInstructionVisitor<SILLinkerVisitor, bool> {
   /// Worklist of SILFunctions we are processing.
   llvm::SmallVector<SILFunction *, 128> Worklist;
 
-  /// A list of callees of the current instruction being visited. cleared after
-  /// every instruction is visited.
-  llvm::SmallVector<SILFunction *, 4> FunctionDeserializationWorklist;
+  /// The distinct callees of the function currently being processed, in the
+  /// order they are referenced. Cleared after every function is processed.
+  llvm::SmallSetVector<SILFunction *, 16> FunctionDeserializationWorklist;
 
   /// The current linking mode.
   LinkingMode Mode;
@@ -95,7 +96,7 @@ public:
 private:
   /// Add a function to our function worklist for processing.
   void addFunctionToWorklist(SILFunction *F) {
-    FunctionDeserializationWorklist.push_back(F);
+    FunctionDeserializationWorklist.insert(F);
   }
 
   /// Is the current mode link all? Link all implies we should try and link
@@ -104,6 +105,10 @@ private:
 
   bool linkInVTable(ClassDecl *D);
 
+  /// Deserialize the body of a function referenced by the function being
+  /// processed. Returns true if a new body was linked in.
+  bool linkReferencedFunction(SILFunction *F);
+
   // Main loop of the visitor. Called by one of the other *visit* methods.
   bool process();
 };
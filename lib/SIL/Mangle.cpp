@@ -127,6 +127,24 @@ setArgumentInOutToValue(unsigned ArgNo) {
   Args[ArgNo].first = ArgumentModifierIntBase(ArgumentModifier::InOutToValue);
 }
 
+void
+FunctionSignatureSpecializationMangler::
+setArgumentExistentialToConcrete(unsigned ArgNo,
+                                 SILInstruction *InitExistential) {
+  assert((isa<InitExistentialAddrInst>(InitExistential) ||
+          isa<InitExistentialRefInst>(InitExistential)) &&
+         "Expected an init_existential_addr or init_existential_ref");
+  auto &Info = Args[ArgNo];
+  Info.first = ArgumentModifierIntBase(ArgumentModifier::ExistentialToConcrete);
+  Info.second = InitExistential;
+}
+
+void
+FunctionSignatureSpecializationMangler::
+setReturnValueOwnedToUnowned() {
+  ReturnValueOwnedToUnowned = true;
+}
+
 void
 FunctionSignatureSpecializationMangler::mangleConstantProp(LiteralInst *LI) {
   Mangler &M = getMangler();
@@ -215,6 +233,23 @@ void FunctionSignatureSpecializationMangler::mangleClosureProp(
   M.mangleIdentifier(FRI->getReferencedFunction()->getName());
 }
 
+void FunctionSignatureSpecializationMangler::mangleExistentialToConcrete(
+    SILInstruction *InitExistential) {
+  Mangler &M = getMangler();
+  llvm::raw_ostream &os = getBuffer();
+
+  os << "ex";
+
+  // Mangle the concrete type the existential argument was specialized for.
+  CanType ConcreteType;
+  if (auto *IEA = dyn_cast<InitExistentialAddrInst>(InitExistential))
+    ConcreteType = IEA->getFormalConcreteType();
+  else
+    ConcreteType =
+      cast<InitExistentialRefInst>(InitExistential)->getFormalConcreteType();
+  M.mangleType(ConcreteType, ResilienceExpansion::Minimal, 0);
+}
+
 void FunctionSignatureSpecializationMangler::mangleArgument(
     ArgumentModifierIntBase ArgMod, NullablePtr<SILInstruction> Inst) {
   if (ArgMod == ArgumentModifierIntBase(ArgumentModifier::ConstantProp)) {
@@ -233,6 +268,12 @@ void FunctionSignatureSpecializationMangler::mangleArgument(
     return;
   }
 
+  if (ArgMod ==
+      ArgumentModifierIntBase(ArgumentModifier::ExistentialToConcrete)) {
+    mangleExistentialToConcrete(Inst.get());
+    return;
+  }
+
   llvm::raw_ostream &os = getBuffer();
 
   if (ArgMod == ArgumentModifierIntBase(ArgumentModifier::Unmodified)) {
@@ -273,4 +314,7 @@ void FunctionSignatureSpecializationMangler::mangleSpecialization() {
     mangleArgument(ArgMod, Inst);
     os << "_";
   }
+
+  if (ReturnValueOwnedToUnowned)
+    os << "ru_";
 }
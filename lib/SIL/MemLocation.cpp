@@ -344,3 +344,9 @@ void MemLocation::enumerateMemLocations(SILFunction &F,
     }
   }
 }
+
+void MemLocation::groupMemLocationsByBase(const std::vector<MemLocation> &LV,
+                                          MemLocationBaseMap &BaseToLocs) {
+  for (unsigned i = 0; i < LV.size(); ++i)
+    BaseToLocs[LV[i].getBase()].push_back(i);
+}
@@ -909,6 +909,17 @@ ProjectionTree::~ProjectionTree() {
     N->~ProjectionTreeNode();
 }
 
+size_t ProjectionTree::getScalarCount(unsigned NodeIndex) const {
+  const ProjectionTreeNode *Node = getNode(NodeIndex);
+  if (Node->ChildProjections.empty())
+    return 1;
+
+  size_t Count = 0;
+  for (unsigned ChildIndex : Node->ChildProjections)
+    Count += getScalarCount(ChildIndex);
+  return Count;
+}
+
 void
 ProjectionTree::computeUsesAndLiveness(SILValue Base) {
   // Propagate liveness and users through the tree.
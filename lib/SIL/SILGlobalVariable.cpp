@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/SIL/SILGlobalVariable.h"
+#include "swift/AST/ASTContext.h"
 #include "swift/SIL/SILModule.h"
 
 using namespace swift;
@@ -67,6 +68,21 @@ SILGlobalVariable::~SILGlobalVariable() {
   getModule().GlobalVariableTable.erase(Name);
 }
 
+/// Returns true if \p EI is an Optional of a class reference without a value.
+/// Its representation is a null pointer, so IRGen can emit it as a zero
+/// constant.
+static bool isNilClassReference(EnumInst *EI) {
+  if (EI->hasOperand())
+    return false;
+  OptionalTypeKind Kind;
+  Type ObjectTy =
+    EI->getType().getSwiftRValueType()->getAnyOptionalObjectType(Kind);
+  if (!ObjectTy || !ObjectTy->isAnyClassReferenceType())
+    return false;
+  return EI->getElement() ==
+         EI->getModule().getASTContext().getOptionalNoneDecl(Kind);
+}
+
 static bool analyzeStaticInitializer(SILFunction *F, SILInstruction *&Val,
                                      SILGlobalVariable *&GVar) {
   Val = nullptr;
@@ -92,9 +108,10 @@ static bool analyzeStaticInitializer(SILFunction *F, SILInstruction *&Val,
       HasStore = true;
       Val = dyn_cast<SILInstruction>(SI->getSrc().getDef());
 
-      // We only handle StructInst and TupleInst being stored to a
-      // global variable for now.
-      if (!isa<StructInst>(Val) && !isa<TupleInst>(Val))
+      // We only handle StructInst, TupleInst and nil class references being
+      // stored to a global variable for now.
+      if (!isa<StructInst>(Val) && !isa<TupleInst>(Val) &&
+          !isa<EnumInst>(Val))
         return false;
     } else {
 
@@ -109,6 +126,14 @@ static bool analyzeStaticInitializer(SILFunction *F, SILInstruction *&Val,
         }
       }
 
+      // Optional class references are only allowed without a value, e.g.
+      // as the owner of a String created from a literal.
+      if (auto *EI = dyn_cast<EnumInst>(&I)) {
+        if (isNilClassReference(EI))
+          continue;
+        return false;
+      }
+
       if (I.getKind() != ValueKind::ReturnInst &&
           I.getKind() != ValueKind::StructInst &&
           I.getKind() != ValueKind::TupleInst &&
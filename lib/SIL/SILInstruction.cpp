@@ -73,6 +73,13 @@ SILBasicBlock *llvm::ilist_traits<SILInstruction>::getContainingBlock() {
 }
 
 
+void llvm::ilist_traits<SILInstruction>::deleteNode(SILInstruction *V) {
+  SILInstruction::destroy(V);
+  // Hand the memory back to the module, to be reused by later passes.
+  if (SILFunction *F = getContainingBlock()->getParent())
+    F->getModule().deallocateInst(V);
+}
+
 void llvm::ilist_traits<SILInstruction>::addNodeToList(SILInstruction *I) {
   assert(I->ParentBB == 0 && "Already in a list!");
   I->ParentBB = getContainingBlock();
@@ -124,6 +124,65 @@ SILModule::~SILModule() {
   delete (SILTypeListUniquingType*)TypeListUniquing;
 }
 
+namespace {
+/// The header allocateInst places in front of each instruction, recording
+/// how to recycle or free its memory.
+struct InstAllocHeader {
+  /// The size class of the instruction, or NumInstSizeClasses if its memory
+  /// can't be recycled.
+  uint32_t SizeClass;
+  /// The distance from the start of the allocation to the instruction.
+  uint32_t Offset;
+};
+static_assert(sizeof(InstAllocHeader) == 8, "header must not break alignment");
+} // end anonymous namespace
+
+static InstAllocHeader &getInstAllocHeader(void *Inst) {
+  return reinterpret_cast<InstAllocHeader *>(Inst)[-1];
+}
+
+void *SILModule::allocateInst(unsigned Size, unsigned Align) const {
+  unsigned SizeClass = (Size + 7) / 8;
+  bool UseMalloc = getASTContext().LangOpts.UseMalloc;
+  if (Align > 8 || SizeClass >= NumInstSizeClasses)
+    SizeClass = NumInstSizeClasses;
+
+  if (SizeClass != NumInstSizeClasses && !UseMalloc) {
+    if (void *Inst = InstFreeLists[SizeClass]) {
+      InstFreeLists[SizeClass] = *reinterpret_cast<void **>(Inst);
+      NumInstBytesReused += SizeClass * 8;
+      return Inst;
+    }
+    // Round up to the size class so the memory fits any instruction of it.
+    Size = SizeClass * 8;
+  }
+
+  unsigned Offset = std::max(Align, unsigned(sizeof(InstAllocHeader)));
+  char *Mem = static_cast<char *>(allocate(Size + Offset, Offset));
+  void *Inst = Mem + Offset;
+  getInstAllocHeader(Inst) = {SizeClass, Offset};
+  return Inst;
+}
+
+void SILModule::deallocateInst(SILInstruction *I) {
+  *reinterpret_cast<void **>(I) = DeletedInsts;
+  DeletedInsts = I;
+}
+
+void SILModule::reclaimDeletedInstructions() {
+  bool UseMalloc = getASTContext().LangOpts.UseMalloc;
+  while (void *Inst = DeletedInsts) {
+    DeletedInsts = *reinterpret_cast<void **>(Inst);
+    InstAllocHeader &Header = getInstAllocHeader(Inst);
+    if (UseMalloc) {
+      AlignedFree(static_cast<char *>(Inst) - Header.Offset);
+    } else if (Header.SizeClass != NumInstSizeClasses) {
+      *reinterpret_cast<void **>(Inst) = InstFreeLists[Header.SizeClass];
+      InstFreeLists[Header.SizeClass] = Inst;
+    }
+  }
+}
+
 SILWitnessTable *
 SILModule::createWitnessTableDeclaration(ProtocolConformance *C,
                                          SILLinkage linkage) {
@@ -313,8 +372,7 @@ SILFunction *SILModule::getOrCreateFunction(SILLocation loc,
                                             SILDeclRef constant,
                                             ForDefinition_t forDefinition) {
 
-  SmallVector<char, 128> buffer;
-  auto name = constant.mangle(buffer);
+  auto name = getMangledName(constant);
   auto constantType = Types.getConstantType(constant).castTo<SILFunctionType>();
   SILLinkage linkage = constant.getLinkage(forDefinition);
 
@@ -493,9 +551,21 @@ const BuiltinInfo &SILModule::getBuiltinInfo(Identifier ID) {
 }
 
 SILFunction *SILModule::lookUpFunction(SILDeclRef fnRef) {
-  llvm::SmallString<32> name;
-  fnRef.mangle(name);
-  return lookUpFunction(name);
+  return lookUpFunction(getMangledName(fnRef));
+}
+
+StringRef SILModule::getMangledName(SILDeclRef constant) {
+  auto found = MangledNames.find(constant);
+  if (found != MangledNames.end())
+    return found->second;
+
+  llvm::SmallString<128> buffer;
+  constant.mangle(buffer);
+  char *storage = static_cast<char *>(allocate(buffer.size(), 1));
+  std::copy(buffer.begin(), buffer.end(), storage);
+  StringRef name(storage, buffer.size());
+  MangledNames.insert({constant, name});
+  return name;
 }
 
 bool SILModule::linkFunction(SILFunction *Fun, SILModule::LinkingMode Mode,
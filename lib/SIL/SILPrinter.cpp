@@ -761,6 +761,8 @@ public:
   
   void visitPartialApplyInst(PartialApplyInst *CI) {
     *this << "partial_apply ";
+    if (CI->canAllocOnStack())
+      *this << "[stack] ";
     *this << getID(CI->getCallee());
     printSubstitutions(CI->getSubstitutions());
     *this << '(';
@@ -1024,11 +1026,13 @@ public:
   }
   
   void visitRetainValueInst(RetainValueInst *I) {
-    *this << "retain_value " << getIDAndType(I->getOperand());
+    *this << "retain_value " << (I->isNonAtomic() ? "[nonatomic] " : "")
+          << getIDAndType(I->getOperand());
   }
 
   void visitReleaseValueInst(ReleaseValueInst *I) {
-    *this << "release_value " << getIDAndType(I->getOperand());
+    *this << "release_value " << (I->isNonAtomic() ? "[nonatomic] " : "")
+          << getIDAndType(I->getOperand());
   }
 
   void visitAutoreleaseValueInst(AutoreleaseValueInst *I) {
@@ -1237,13 +1241,15 @@ public:
     *this << "copy_block " << getIDAndType(RI->getOperand());
   }
   void visitStrongRetainInst(StrongRetainInst *RI) {
-    *this << "strong_retain " << getIDAndType(RI->getOperand());
+    *this << "strong_retain " << (RI->isNonAtomic() ? "[nonatomic] " : "")
+          << getIDAndType(RI->getOperand());
   }
   void visitStrongRetainAutoreleasedInst(StrongRetainAutoreleasedInst *RI) {
     *this << "strong_retain_autoreleased " << getIDAndType(RI->getOperand());
   }
   void visitStrongReleaseInst(StrongReleaseInst *RI) {
-    *this << "strong_release " << getIDAndType(RI->getOperand());
+    *this << "strong_release " << (RI->isNonAtomic() ? "[nonatomic] " : "")
+          << getIDAndType(RI->getOperand());
   }
   void visitStrongPinInst(StrongPinInst *PI) {
     *this << "strong_pin " << getIDAndType(PI->getOperand());
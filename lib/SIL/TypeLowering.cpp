@@ -28,12 +28,17 @@
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SIL/TypeLowering.h"
+#include "swift/Serialization/SerializedSILLoader.h"
 #include "clang/AST/Type.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 using namespace Lowering;
 
+STATISTIC(NumSerializedTypeLowerings,
+          "Number of type lowerings built from their module file's record");
+
 namespace {
   /// A CRTP type visitor for deciding whether the metatype for a type
   /// is a singleton type, i.e. whether there can only ever be one
@@ -1198,7 +1203,7 @@ TypeConverter::TypeConverter(SILModule &m)
 }
 
 TypeConverter::~TypeConverter() {
-  assert(!GenericArchetypes.hasValue() && "generic context was never popped?!");
+  assert(!GenericArchetypes && "generic context was never popped?!");
 
   // The bump pointer allocator destructor will deallocate but not destroy all
   // our independent TypeLowerings.
@@ -1212,6 +1217,17 @@ TypeConverter::~TypeConverter() {
   }
 }
 
+size_t TypeConverter::getTotalMemory() const {
+  return IndependentBPA.getTotalMemory() +
+    DependentBPA.getTotalMemory() +
+    llvm::capacity_in_bytes(IndependentTypes) +
+    llvm::capacity_in_bytes(DependentTypes) +
+    llvm::capacity_in_bytes(ConstantTypes) +
+    llvm::capacity_in_bytes(ConstantOverrideTypes) +
+    llvm::capacity_in_bytes(LoweredCaptures) +
+    RecursiveNominalTypes.getMemorySize();
+}
+
 void *TypeLowering::operator new(size_t size, TypeConverter &tc,
                                  IsDependent_t dependent) {
   return dependent
@@ -1353,7 +1369,7 @@ TypeConverter::getTypeLowering(AbstractionPattern origType,
   CanType substType = origSubstType->getCanonicalType();
   auto key = getTypeKey(origType, substType, uncurryLevel);
   
-  assert(!key.isDependent() || GenericArchetypes.hasValue()
+  assert(!key.isDependent() || GenericArchetypes
          && "dependent type outside of generic context?!");
   
   if (auto existing = find(key))
@@ -1590,6 +1606,12 @@ TypeConverter::getTypeLoweringForUncachedLoweredType(TypeKey key) {
   // builds.
   insert(key, nullptr);
 
+  if (auto *theInfo = getTypeLoweringFromSerializedKind(key)) {
+    ++NumSerializedTypeLowerings;
+    insert(key, theInfo);
+    return *theInfo;
+  }
+
   CanType contextType = key.SubstType;
   if (contextType->hasTypeParameter())
     contextType = getArchetypes().substDependentType(contextType)
@@ -1600,6 +1622,48 @@ TypeConverter::getTypeLoweringForUncachedLoweredType(TypeKey key) {
   return *theInfo;
 }
 
+/// If \p key is the declared type of a struct or enum from a module file that
+/// recorded how it lowers, build its lowering from that record rather than by
+/// classifying each of its fields or payloads.
+const TypeLowering *
+TypeConverter::getTypeLoweringFromSerializedKind(TypeKey key) {
+  CanType type = key.SubstType;
+  if (key.isDependent() || !(isa<StructType>(type) || isa<EnumType>(type)))
+    return nullptr;
+  auto *D = type->getAnyNominal();
+  if (D->getModuleContext() == M.getSwiftModule())
+    return nullptr;
+
+  auto kind = M.getSILLoader()->lookupNominalLoweringKind(D);
+  if (!kind)
+    return nullptr;
+
+  switch (*kind) {
+  case NominalLoweringKind::Trivial:
+    return new (*this, IsNotDependent)
+      TrivialTypeLowering(SILType::getPrimitiveObjectType(type));
+  case NominalLoweringKind::Loadable:
+    if (isa<StructType>(type))
+      return new (*this, IsNotDependent) LoadableStructTypeLowering(type);
+    return new (*this, IsNotDependent) LoadableEnumTypeLowering(type);
+  case NominalLoweringKind::AddressOnly:
+    return new (*this, IsNotDependent)
+      AddressOnlyTypeLowering(SILType::getPrimitiveAddressType(type));
+  }
+  llvm_unreachable("bad nominal lowering kind");
+}
+
+NominalLoweringKind TypeConverter::getNominalLoweringKind(NominalTypeDecl *D) {
+  assert((isa<StructDecl>(D) || isa<EnumDecl>(D)) && !D->isGenericContext() &&
+         "not the declaration of a non-generic value type");
+  auto &lowering = getTypeLowering(D->getDeclaredType());
+  if (lowering.isAddressOnly())
+    return NominalLoweringKind::AddressOnly;
+  if (lowering.isTrivial())
+    return NominalLoweringKind::Trivial;
+  return NominalLoweringKind::Loadable;
+}
+
 namespace {
   using PrimaryArchetypeMap
     = llvm::DenseMap<ArchetypeType *, std::pair<unsigned, unsigned>>;
@@ -2296,16 +2360,15 @@ void TypeConverter::pushGenericContext(CanGenericSignature sig) {
     return;
   
   // GenericFunctionTypes shouldn't nest.
-  assert(!GenericArchetypes.hasValue() && "already in generic context?!");
+  assert(!GenericArchetypes && "already in generic context?!");
   assert(DependentTypes.empty() && "already in generic context?!");
   assert(!CurGenericContext && "already in generic context!");
 
   CurGenericContext = sig;
   
-  // Prepare the ArchetypeBuilder with the generic signature.
-  GenericArchetypes.emplace(*M.getSwiftModule(), M.getASTContext().Diags);
-  if (GenericArchetypes->addGenericSignature(sig, false))
-    llvm_unreachable("error adding generic signature to archetype builder?!");
+  // Use the ArchetypeBuilder of the generic signature, rather than resolving
+  // the same requirements again for every function with this signature.
+  GenericArchetypes = sig->getArchetypeBuilder(*M.getSwiftModule());
 }
 
 void TypeConverter::popGenericContext(CanGenericSignature sig) {
@@ -2313,7 +2376,7 @@ void TypeConverter::popGenericContext(CanGenericSignature sig) {
   if (!sig)
     return;
 
-  assert(GenericArchetypes.hasValue() && "not in generic context?!");
+  assert(GenericArchetypes && "not in generic context?!");
   assert(CurGenericContext == sig && "unpaired push/pop");
   
   // Erase our cached TypeLowering objects and associated mappings for dependent
@@ -2330,7 +2393,7 @@ void TypeConverter::popGenericContext(CanGenericSignature sig) {
   }
   DependentTypes.clear();
   DependentBPA.Reset();
-  GenericArchetypes.reset();
+  GenericArchetypes = nullptr;
   CurGenericContext = nullptr;
 }
 
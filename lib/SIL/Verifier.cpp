@@ -3119,6 +3119,11 @@ void SILGlobalVariable::verify() const {
 
 /// Verify the module.
 void SILModule::verify() const {
+  verify([](const SILFunction &) { return true; });
+}
+
+void SILModule::verify(
+    llvm::function_ref<bool(const SILFunction &)> ShouldVerifyFunction) const {
 #ifndef NDEBUG
   // Uniquing set to catch symbol name collisions.
   llvm::StringSet<> symbolNames;
@@ -3129,7 +3134,8 @@ void SILModule::verify() const {
       llvm::errs() << "Symbol redefined: " << f.getName() << "!\n";
       assert(false && "triggering standard assertion failure routine");
     }
-    f.verify();
+    if (ShouldVerifyFunction(f))
+      f.verify();
   }
 
   // Check all globals.
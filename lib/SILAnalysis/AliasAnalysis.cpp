@@ -22,12 +22,21 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace swift;
 
+STATISTIC(NumAliasCacheHits, "Number of alias queries answered from the cache");
+STATISTIC(NumAliasCacheMisses, "Number of alias queries computed");
+
+llvm::cl::opt<unsigned> AACacheSizeLimit(
+    "aa-cache-size-limit", llvm::cl::init(100000),
+    llvm::cl::desc("The number of alias and memory behavior results to cache "
+                   "before the caches are cleared (0 = don't cache)"));
+
 //===----------------------------------------------------------------------===//
 //                                AA Debugging
 //===----------------------------------------------------------------------===//
@@ -572,7 +581,22 @@ bool AliasAnalysis::typesMayAlias(SILType T1, SILType T2) {
 AliasResult AliasAnalysis::alias(SILValue V1, SILValue V2,
                                  SILType TBAAType1,
                                  SILType TBAAType2) {
-  return aliasInner(V1, V2, TBAAType1, TBAAType2);
+  if (!AACacheSizeLimit)
+    return aliasInner(V1, V2, TBAAType1, TBAAType2);
+
+  AliasCacheKey Key = {{V1, V2}, {TBAAType1, TBAAType2}};
+  auto Cached = AliasCache.find(Key);
+  if (Cached != AliasCache.end()) {
+    ++NumAliasCacheHits;
+    return Cached->second;
+  }
+  ++NumAliasCacheMisses;
+
+  AliasResult Result = aliasInner(V1, V2, TBAAType1, TBAAType2);
+  if (AliasCache.size() >= AACacheSizeLimit)
+    AliasCache.clear();
+  AliasCache[Key] = Result;
+  return Result;
 }
 
 /// The main AA entry point. Performs various analyses on V1, V2 in an attempt
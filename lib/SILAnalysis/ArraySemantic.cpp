@@ -154,6 +154,12 @@ ArrayCallKind swift::ArraySemanticsCall::getKind() const {
           .Case("array.make_mutable", ArrayCallKind::kMakeMutable)
           .Case("array.get_element_address", ArrayCallKind::kGetElementAddress)
           .Case("array.mutate_unknown", ArrayCallKind::kMutateUnknown)
+          // The hashed collections share the copy-on-write entry points. They
+          // are only matched if a client explicitly asks for them.
+          .Case("dictionary.make_mutable", ArrayCallKind::kMakeMutable)
+          .Case("dictionary.mutate_unknown", ArrayCallKind::kMutateUnknown)
+          .Case("set.make_mutable", ArrayCallKind::kMakeMutable)
+          .Case("set.mutate_unknown", ArrayCallKind::kMutateUnknown)
           .Default(ArrayCallKind::kNone);
 
   return Kind;
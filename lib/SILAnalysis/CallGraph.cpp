@@ -35,6 +35,8 @@ using namespace swift;
 STATISTIC(NumCallGraphNodes, "# of call graph nodes created");
 STATISTIC(NumAppliesWithEdges, "# of call sites with edges");
 STATISTIC(NumCallGraphsBuilt, "# of times the call graph is built");
+STATISTIC(NumCallGraphFunctionUpdates,
+          "# of times the edges of a function are recomputed");
 
 llvm::cl::opt<bool> DumpCallGraph("sil-dump-call-graph",
                                   llvm::cl::init(false), llvm::cl::Hidden);
@@ -42,6 +44,11 @@ llvm::cl::opt<bool> DumpCallGraph("sil-dump-call-graph",
 llvm::cl::opt<bool> DumpCallGraphStats("sil-dump-call-graph-stats",
                                        llvm::cl::init(false), llvm::cl::Hidden);
 
+llvm::cl::opt<bool> VerifyCallGraphUpdates(
+    "sil-verify-call-graph-updates", llvm::cl::init(false), llvm::cl::Hidden,
+    llvm::cl::desc("Verify the whole call graph after each incremental "
+                   "update of a function's edges"));
+
 CallGraph::CallGraph(SILModule *Mod, bool completeModule)
   : M(*Mod), NodeOrdinal(0), EdgeOrdinal(0) {
   ++NumCallGraphsBuilt;
@@ -848,6 +855,25 @@ void CallGraphEditor::removeAllCallerEdgesFrom(SILFunction *F) {
   }
 }
 
+void CallGraphEditor::updateEdgesForFunction(SILFunction *F) {
+  if (!CG)
+    return;
+
+  ++NumCallGraphFunctionUpdates;
+
+  // The edges only refer to the apply instructions by address, so it is safe
+  // to remove them even if the instructions were already deleted.
+  removeAllCalleeEdgesFrom(F);
+  CG->addEdges(F);
+
+  // The SCCs may have changed.
+  CG->invalidateBottomUpFunctionOrder();
+  CG->clearBottomUpSCCOrder();
+
+  if (VerifyCallGraphUpdates)
+    CG->verify();
+}
+
 void CallGraphEditor::updatePartialApplyUses(swift::ApplySite AI) {
   if (!CG)
     return;
@@ -118,5 +118,48 @@ void ClassHierarchyAnalysis::getIndirectSubClasses(ClassDecl *Cur,
   }
 }
 
+bool ClassHierarchyAnalysis::areAllSubclassesKnown(ClassDecl *C) {
+  if (C->isFinal())
+    return true;
+
+  // Without an associated context we cannot perform any
+  // access-based optimizations.
+  const DeclContext *DC = M->getAssociatedContext();
+  if (!DC || !C->isChildContextOf(DC) || !C->hasAccessibility())
+    return false;
+
+  switch (C->getEffectiveAccess()) {
+  case Accessibility::Public:
+    return false;
+  case Accessibility::Internal:
+    return M->isWholeModule();
+  case Accessibility::Private:
+    return true;
+  }
+}
+
+bool ClassHierarchyAnalysis::isEffectivelyFinal(ClassDecl *C) {
+  return C->isFinal() ||
+         (areAllSubclassesKnown(C) && !hasKnownDirectSubclasses(C));
+}
+
+bool ClassHierarchyAnalysis::isEffectivelyFinal(FuncDecl *Method,
+                                                ClassDecl *C) {
+  if (Method->isFinal() || isEffectivelyFinal(C))
+    return true;
+  if (!areAllSubclassesKnown(C))
+    return false;
+
+  FuncDecl *Impl = C->findImplementingMethod(Method);
+  if (!Impl)
+    return false;
+  for (auto *S : getDirectSubClasses(C))
+    if (S->findImplementingMethod(Method) != Impl)
+      return false;
+  for (auto *S : getIndirectSubClasses(C))
+    if (S->findImplementingMethod(Method) != Impl)
+      return false;
+  return true;
+}
 
 ClassHierarchyAnalysis::~ClassHierarchyAnalysis() {}
@@ -16,10 +16,19 @@
 #include "swift/SILAnalysis/SideEffectAnalysis.h"
 #include "swift/SILAnalysis/ValueTracking.h"
 #include "swift/SIL/SILVisitor.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+STATISTIC(NumMemBehaviorCacheHits,
+          "Number of memory behavior queries answered from the cache");
+STATISTIC(NumMemBehaviorCacheMisses,
+          "Number of memory behavior queries computed");
+
+extern llvm::cl::opt<unsigned> AACacheSizeLimit;
+
 //===----------------------------------------------------------------------===//
 //                       Memory Behavior Implementation
 //===----------------------------------------------------------------------===//
@@ -308,7 +317,28 @@ MemBehavior MemoryBehaviorVisitor::visitReleaseValueInst(ReleaseValueInst *SI) {
 
 MemBehavior
 AliasAnalysis::computeMemoryBehavior(SILInstruction *Inst, SILValue V,
-                                 RetainObserveKind InspectionMode) {
+                                     RetainObserveKind InspectionMode) {
+  if (!AACacheSizeLimit)
+    return computeMemoryBehaviorInner(Inst, V, InspectionMode);
+
+  MemoryBehaviorCacheKey Key = {{Inst, V}, unsigned(InspectionMode)};
+  auto Cached = MemoryBehaviorCache.find(Key);
+  if (Cached != MemoryBehaviorCache.end()) {
+    ++NumMemBehaviorCacheHits;
+    return Cached->second;
+  }
+  ++NumMemBehaviorCacheMisses;
+
+  MemBehavior Result = computeMemoryBehaviorInner(Inst, V, InspectionMode);
+  if (MemoryBehaviorCache.size() >= AACacheSizeLimit)
+    MemoryBehaviorCache.clear();
+  MemoryBehaviorCache[Key] = Result;
+  return Result;
+}
+
+MemBehavior
+AliasAnalysis::computeMemoryBehaviorInner(SILInstruction *Inst, SILValue V,
+                                          RetainObserveKind InspectionMode) {
   DEBUG(llvm::dbgs() << "GET MEMORY BEHAVIOR FOR:\n    " << *Inst << "    "
                      << *V.getDef());
   assert(SEA && "SideEffectsAnalysis must be initialized!");
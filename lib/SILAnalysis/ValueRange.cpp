@@ -0,0 +1,712 @@
+//===--- ValueRange.cpp - Ranges of SIL integer values ----------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-value-range"
+#include "swift/SILAnalysis/ValueRange.h"
+#include "swift/SIL/Dominance.h"
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace swift;
+using llvm::APInt;
+
+/// The maximum depth of the values visited to compute a range.
+static const unsigned MaxRangeDepth = 5;
+
+//===----------------------------------------------------------------------===//
+//                                 IntRange
+//===----------------------------------------------------------------------===//
+
+static const APInt &smin(const APInt &A, const APInt &B) {
+  return A.slt(B) ? A : B;
+}
+
+static const APInt &smax(const APInt &A, const APInt &B) {
+  return A.sgt(B) ? A : B;
+}
+
+Optional<IntRange> IntRange::intersect(const IntRange &Other) const {
+  const APInt &NewMin = smax(Min, Other.Min);
+  const APInt &NewMax = smin(Max, Other.Max);
+  if (NewMin.sgt(NewMax))
+    return None;
+  return IntRange(NewMin, NewMax);
+}
+
+IntRange IntRange::unionWith(const IntRange &Other) const {
+  return IntRange(smin(Min, Other.Min), smax(Max, Other.Max));
+}
+
+static bool isUnsignedArithmetic(BuiltinValueKind Kind) {
+  return Kind == BuiltinValueKind::UAddOver ||
+         Kind == BuiltinValueKind::USubOver ||
+         Kind == BuiltinValueKind::UMulOver;
+}
+
+/// Computes the bounds of the mathematical results of \p Kind applied to
+/// \p LHS and \p RHS, in a bit width which can't overflow. Returns false if
+/// \p Kind is not supported, or is unsigned and an operand may be negative.
+static bool getWideResult(BuiltinValueKind Kind, const IntRange &LHS,
+                          const IntRange &RHS, APInt &Lo, APInt &Hi) {
+  if (isUnsignedArithmetic(Kind) &&
+      (!LHS.isNonNegative() || !RHS.isNonNegative()))
+    return false;
+
+  unsigned WideWidth = LHS.getBitWidth() * 2 + 2;
+  APInt LMin = LHS.getMin().sext(WideWidth);
+  APInt LMax = LHS.getMax().sext(WideWidth);
+  APInt RMin = RHS.getMin().sext(WideWidth);
+  APInt RMax = RHS.getMax().sext(WideWidth);
+
+  switch (Kind) {
+  case BuiltinValueKind::SAddOver:
+  case BuiltinValueKind::UAddOver:
+    Lo = LMin + RMin;
+    Hi = LMax + RMax;
+    return true;
+  case BuiltinValueKind::SSubOver:
+  case BuiltinValueKind::USubOver:
+    Lo = LMin - RMax;
+    Hi = LMax - RMin;
+    return true;
+  case BuiltinValueKind::SMulOver:
+  case BuiltinValueKind::UMulOver: {
+    APInt Products[] = { LMin * RMin, LMin * RMax, LMax * RMin, LMax * RMax };
+    Lo = Hi = Products[0];
+    for (const APInt &P : Products) {
+      Lo = smin(Lo, P);
+      Hi = smax(Hi, P);
+    }
+    return true;
+  }
+  default:
+    return false;
+  }
+}
+
+/// Returns the bounds of the values of the result type of \p Kind, extended
+/// to \p WideWidth bits.
+static std::pair<APInt, APInt> getResultTypeBounds(BuiltinValueKind Kind,
+                                                   unsigned BitWidth,
+                                                   unsigned WideWidth) {
+  if (isUnsignedArithmetic(Kind))
+    return { APInt(WideWidth, 0),
+             APInt::getMaxValue(BitWidth).zext(WideWidth) };
+  return { APInt::getSignedMinValue(BitWidth).sext(WideWidth),
+           APInt::getSignedMaxValue(BitWidth).sext(WideWidth) };
+}
+
+/// Returns the range of \p Lo to \p Hi, if it is representable as a signed
+/// range of \p BitWidth bits.
+static Optional<IntRange> truncateRange(const APInt &Lo, const APInt &Hi,
+                                        unsigned BitWidth) {
+  unsigned WideWidth = Lo.getBitWidth();
+  if (Lo.slt(APInt::getSignedMinValue(BitWidth).sext(WideWidth)) ||
+      Hi.sgt(APInt::getSignedMaxValue(BitWidth).sext(WideWidth)))
+    return None;
+  return IntRange(Lo.trunc(BitWidth), Hi.trunc(BitWidth));
+}
+
+Optional<IntRange> IntRange::getExactResult(BuiltinValueKind Kind,
+                                            const IntRange &LHS,
+                                            const IntRange &RHS) {
+  if (!canOverflow(Kind, LHS, RHS)) {
+    APInt Lo, Hi;
+    getWideResult(Kind, LHS, RHS, Lo, Hi);
+    return truncateRange(Lo, Hi, LHS.getBitWidth());
+  }
+  return None;
+}
+
+bool IntRange::canOverflow(BuiltinValueKind Kind, const IntRange &LHS,
+                           const IntRange &RHS) {
+  APInt Lo, Hi;
+  if (!getWideResult(Kind, LHS, RHS, Lo, Hi))
+    return true;
+  auto Bounds = getResultTypeBounds(Kind, LHS.getBitWidth(), Lo.getBitWidth());
+  return Lo.slt(Bounds.first) || Hi.sgt(Bounds.second);
+}
+
+void IntRange::print(llvm::raw_ostream &OS) const {
+  OS << '[' << Min.getSExtValue() << ", " << Max.getSExtValue() << ']';
+}
+
+//===----------------------------------------------------------------------===//
+//                              ValueRangeInfo
+//===----------------------------------------------------------------------===//
+
+static BuiltinValueKind swapPredicate(BuiltinValueKind Pred) {
+  switch (Pred) {
+  case BuiltinValueKind::ICMP_SLT: return BuiltinValueKind::ICMP_SGT;
+  case BuiltinValueKind::ICMP_SLE: return BuiltinValueKind::ICMP_SGE;
+  case BuiltinValueKind::ICMP_SGT: return BuiltinValueKind::ICMP_SLT;
+  case BuiltinValueKind::ICMP_SGE: return BuiltinValueKind::ICMP_SLE;
+  case BuiltinValueKind::ICMP_ULT: return BuiltinValueKind::ICMP_UGT;
+  case BuiltinValueKind::ICMP_ULE: return BuiltinValueKind::ICMP_UGE;
+  case BuiltinValueKind::ICMP_UGT: return BuiltinValueKind::ICMP_ULT;
+  case BuiltinValueKind::ICMP_UGE: return BuiltinValueKind::ICMP_ULE;
+  default: return Pred;
+  }
+}
+
+static BuiltinValueKind invertPredicate(BuiltinValueKind Pred) {
+  switch (Pred) {
+  case BuiltinValueKind::ICMP_EQ:  return BuiltinValueKind::ICMP_NE;
+  case BuiltinValueKind::ICMP_NE:  return BuiltinValueKind::ICMP_EQ;
+  case BuiltinValueKind::ICMP_SLT: return BuiltinValueKind::ICMP_SGE;
+  case BuiltinValueKind::ICMP_SLE: return BuiltinValueKind::ICMP_SGT;
+  case BuiltinValueKind::ICMP_SGT: return BuiltinValueKind::ICMP_SLE;
+  case BuiltinValueKind::ICMP_SGE: return BuiltinValueKind::ICMP_SLT;
+  case BuiltinValueKind::ICMP_ULT: return BuiltinValueKind::ICMP_UGE;
+  case BuiltinValueKind::ICMP_ULE: return BuiltinValueKind::ICMP_UGT;
+  case BuiltinValueKind::ICMP_UGT: return BuiltinValueKind::ICMP_ULE;
+  case BuiltinValueKind::ICMP_UGE: return BuiltinValueKind::ICMP_ULT;
+  default: llvm_unreachable("not a comparison");
+  }
+}
+
+static bool isComparison(BuiltinValueKind Kind) {
+  switch (Kind) {
+  case BuiltinValueKind::ICMP_EQ:
+  case BuiltinValueKind::ICMP_NE:
+  case BuiltinValueKind::ICMP_SLT:
+  case BuiltinValueKind::ICMP_SLE:
+  case BuiltinValueKind::ICMP_SGT:
+  case BuiltinValueKind::ICMP_SGE:
+  case BuiltinValueKind::ICMP_ULT:
+  case BuiltinValueKind::ICMP_ULE:
+  case BuiltinValueKind::ICMP_UGT:
+  case BuiltinValueKind::ICMP_UGE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool isOverflowArithmetic(BuiltinValueKind Kind) {
+  switch (Kind) {
+  case BuiltinValueKind::SAddOver:
+  case BuiltinValueKind::SSubOver:
+  case BuiltinValueKind::SMulOver:
+  case BuiltinValueKind::UAddOver:
+  case BuiltinValueKind::USubOver:
+  case BuiltinValueKind::UMulOver:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static unsigned getBitWidth(SILValue V) {
+  return V.getType().castTo<BuiltinIntegerType>()->getFixedWidth();
+}
+
+bool ValueRangeInfo::hasRange(SILValue V) {
+  auto *IntTy = V.getType().getAs<BuiltinIntegerType>();
+  return IntTy && IntTy->isFixedWidth();
+}
+
+ValueRangeInfo::ValueRangeInfo(SILFunction *F, DominanceInfo *DT) : DT(DT) {
+  for (auto &BB : *F) {
+    auto *Term = BB.getTerminator();
+    if (auto *CBI = dyn_cast<CondBranchInst>(Term)) {
+      // The condition is only known in a successor if it can't be reached
+      // in another way.
+      SILBasicBlock *TrueBB = CBI->getTrueBB();
+      SILBasicBlock *FalseBB = CBI->getFalseBB();
+      if (TrueBB != FalseBB) {
+        if (TrueBB->getSinglePredecessor())
+          addCondition(CBI->getCondition(), true, TrueBB, nullptr);
+        if (FalseBB->getSinglePredecessor())
+          addCondition(CBI->getCondition(), false, FalseBB, nullptr);
+      }
+    }
+    for (auto &I : BB)
+      if (auto *CFI = dyn_cast<CondFailInst>(&I))
+        addCondition(CFI->getOperand(), false, &BB, CFI);
+  }
+}
+
+/// Records the facts which follow from \p Cond being \p IsTrue.
+void ValueRangeInfo::addCondition(SILValue Cond, bool IsTrue,
+                                  SILBasicBlock *Block, SILInstruction *After,
+                                  unsigned Depth) {
+  auto *BI = dyn_cast<BuiltinInst>(Cond);
+  if (!BI || Depth > MaxRangeDepth)
+    return;
+
+  BuiltinValueKind Kind = BI->getBuiltinInfo().ID;
+  if (isComparison(Kind)) {
+    addComparison(IsTrue ? Kind : invertPredicate(Kind), BI->getOperand(0),
+                  BI->getOperand(1), Block, After);
+    return;
+  }
+
+  switch (Kind) {
+  case BuiltinValueKind::Xor: {
+    // "xor %c, 1" negates an Int1.
+    for (unsigned i = 0; i != 2; ++i) {
+      auto *IL = dyn_cast<IntegerLiteralInst>(BI->getOperand(i));
+      if (IL && IL->getValue().getBitWidth() == 1 && IL->getValue() == 1)
+        addCondition(BI->getOperand(1 - i), !IsTrue, Block, After, Depth + 1);
+    }
+    return;
+  }
+  case BuiltinValueKind::And:
+    if (IsTrue) {
+      addCondition(BI->getOperand(0), true, Block, After, Depth + 1);
+      addCondition(BI->getOperand(1), true, Block, After, Depth + 1);
+    }
+    return;
+  case BuiltinValueKind::Or:
+    if (!IsTrue) {
+      addCondition(BI->getOperand(0), false, Block, After, Depth + 1);
+      addCondition(BI->getOperand(1), false, Block, After, Depth + 1);
+    }
+    return;
+  default:
+    return;
+  }
+}
+
+void ValueRangeInfo::addComparison(BuiltinValueKind Pred, SILValue LHS,
+                                   SILValue RHS, SILBasicBlock *Block,
+                                   SILInstruction *After) {
+  Facts[LHS].push_back({Block, After, Pred, RHS});
+  Facts[RHS].push_back({Block, After, swapPredicate(Pred), LHS});
+}
+
+bool ValueRangeInfo::holdsAt(const Fact &F, SILInstruction *At) {
+  if (F.After)
+    return DT->properlyDominates(F.After, At);
+  return DT->dominates(F.Block, At->getParent());
+}
+
+/// Returns \p R narrowed to [NewMin, NewMax], or \p R if the intersection is
+/// empty, which can only happen in unreachable code.
+static IntRange narrow(const IntRange &R, const APInt &NewMin,
+                       const APInt &NewMax) {
+  if (NewMin.sgt(NewMax))
+    return R;
+  if (auto Narrowed = R.intersect(IntRange(NewMin, NewMax)))
+    return *Narrowed;
+  return R;
+}
+
+/// Narrows \p R, the range of some value V, with the fact "V Pred X", where
+/// \p Other is the range of X.
+IntRange ValueRangeInfo::refine(const IntRange &R, BuiltinValueKind Pred,
+                                const IntRange &Other) {
+  unsigned BitWidth = R.getBitWidth();
+  if (Other.getBitWidth() != BitWidth)
+    return R;
+
+  APInt SMin = APInt::getSignedMinValue(BitWidth);
+  APInt SMax = APInt::getSignedMaxValue(BitWidth);
+  APInt Zero(BitWidth, 0);
+  APInt One(BitWidth, 1);
+  const APInt &OMin = Other.getMin();
+  const APInt &OMax = Other.getMax();
+
+  switch (Pred) {
+  case BuiltinValueKind::ICMP_EQ:
+    return narrow(R, OMin, OMax);
+  case BuiltinValueKind::ICMP_NE:
+    // Only a constant value can be cut off a bound of the range.
+    if (OMin != OMax || R.getMin() == R.getMax())
+      return R;
+    if (R.getMin() == OMin)
+      return narrow(R, R.getMin() + One, R.getMax());
+    if (R.getMax() == OMin)
+      return narrow(R, R.getMin(), R.getMax() - One);
+    return R;
+  case BuiltinValueKind::ICMP_SLT:
+    if (OMax.isMinSignedValue())
+      return R;
+    return narrow(R, SMin, OMax - One);
+  case BuiltinValueKind::ICMP_SLE:
+    return narrow(R, SMin, OMax);
+  case BuiltinValueKind::ICMP_SGT:
+    if (OMin.isMaxSignedValue())
+      return R;
+    return narrow(R, OMin + One, SMax);
+  case BuiltinValueKind::ICMP_SGE:
+    return narrow(R, OMin, SMax);
+  case BuiltinValueKind::ICMP_ULT:
+    // V <u X, with X non-negative, implies 0 <= V < X.
+    if (!Other.isNonNegative() || OMax == 0)
+      return R;
+    return narrow(R, Zero, OMax - One);
+  case BuiltinValueKind::ICMP_ULE:
+    if (!Other.isNonNegative())
+      return R;
+    return narrow(R, Zero, OMax);
+  case BuiltinValueKind::ICMP_UGT:
+    // V >u X is only a lower bound if V is known to be non-negative.
+    if (!Other.isNonNegative() || !R.isNonNegative() ||
+        OMin.isMaxSignedValue())
+      return R;
+    return narrow(R, OMin + One, SMax);
+  case BuiltinValueKind::ICMP_UGE:
+    if (!Other.isNonNegative() || !R.isNonNegative())
+      return R;
+    return narrow(R, OMin, SMax);
+  default:
+    return R;
+  }
+}
+
+IntRange ValueRangeInfo::getRange(SILValue V, SILInstruction *At,
+                                  unsigned Depth) {
+  assert(hasRange(V) && "value has no integer range");
+  if (Depth > MaxRangeDepth)
+    return IntRange::getFull(getBitWidth(V));
+
+  IntRange R = getBaseRange(V, At, Depth);
+
+  auto It = Facts.find(V);
+  if (It == Facts.end())
+    return R;
+  for (const Fact &F : It->second) {
+    if (!hasRange(F.Other) || !holdsAt(F, At))
+      continue;
+    R = refine(R, F.Pred, getRange(F.Other, At, Depth + 1));
+  }
+  return R;
+}
+
+/// Returns true if the overflow bit of \p BI is checked by a cond_fail which
+/// is executed before \p At.
+bool ValueRangeInfo::isOverflowCheckedAt(BuiltinInst *BI, SILInstruction *At) {
+  for (auto *Use : BI->getUses()) {
+    auto *TEI = dyn_cast<TupleExtractInst>(Use->getUser());
+    if (!TEI || TEI->getFieldNo() != 1)
+      continue;
+    for (auto *FlagUse : TEI->getUses()) {
+      auto *CFI = dyn_cast<CondFailInst>(FlagUse->getUser());
+      if (CFI && DT->properlyDominates(CFI, At))
+        return true;
+    }
+  }
+  return false;
+}
+
+/// Returns the range of the result of an overflow-checked arithmetic builtin,
+/// which is known not to have overflowed.
+static IntRange getCheckedResult(BuiltinValueKind Kind, const IntRange &LHS,
+                                 const IntRange &RHS) {
+  unsigned BitWidth = LHS.getBitWidth();
+  IntRange Full = IntRange::getFull(BitWidth);
+  APInt Lo, Hi;
+  if (!getWideResult(Kind, LHS, RHS, Lo, Hi))
+    return Full;
+  auto Bounds = getResultTypeBounds(Kind, BitWidth, Lo.getBitWidth());
+  APInt ClampedLo = smax(Lo, Bounds.first);
+  APInt ClampedHi = smin(Hi, Bounds.second);
+  if (ClampedLo.sgt(ClampedHi))
+    return Full;
+  if (auto R = truncateRange(ClampedLo, ClampedHi, BitWidth))
+    return *R;
+  return Full;
+}
+
+IntRange ValueRangeInfo::getBaseRange(SILValue V, SILInstruction *At,
+                                      unsigned Depth) {
+  unsigned BitWidth = getBitWidth(V);
+  IntRange Full = IntRange::getFull(BitWidth);
+  ValueBase *Def = V.getDef();
+
+  if (auto *IL = dyn_cast<IntegerLiteralInst>(Def))
+    return IntRange::getConstant(IL->getValue());
+
+  if (auto *Arg = dyn_cast<SILArgument>(Def)) {
+    if (Arg->isFunctionArg())
+      return Full;
+    return getArgumentRange(Arg, Depth);
+  }
+
+  if (auto *SEI = dyn_cast<StructExtractInst>(Def)) {
+    if (auto *SI = dyn_cast<StructInst>(SEI->getOperand()))
+      return getRange(SI->getElements()[SEI->getFieldNo()], At, Depth + 1);
+    return Full;
+  }
+
+  // The value of an overflow-checked operation.
+  if (auto *TEI = dyn_cast<TupleExtractInst>(Def)) {
+    auto *BI = dyn_cast<BuiltinInst>(TEI->getOperand());
+    if (!BI || TEI->getFieldNo() != 0)
+      return Full;
+    BuiltinValueKind Kind = BI->getBuiltinInfo().ID;
+    if (!isOverflowArithmetic(Kind))
+      return Full;
+    IntRange LHS = getRange(BI->getOperand(0), At, Depth + 1);
+    IntRange RHS = getRange(BI->getOperand(1), At, Depth + 1);
+    if (auto R = IntRange::getExactResult(Kind, LHS, RHS))
+      return *R;
+    if (isOverflowCheckedAt(BI, At))
+      return getCheckedResult(Kind, LHS, RHS);
+    return Full;
+  }
+
+  auto *BI = dyn_cast<BuiltinInst>(Def);
+  if (!BI)
+    return Full;
+
+  switch (BI->getBuiltinInfo().ID) {
+  case BuiltinValueKind::Add:
+  case BuiltinValueKind::Sub:
+  case BuiltinValueKind::Mul: {
+    // Wrapping arithmetic has the exact range if it can't wrap.
+    BuiltinValueKind Kind =
+      BI->getBuiltinInfo().ID == BuiltinValueKind::Add ?
+        BuiltinValueKind::SAddOver :
+      BI->getBuiltinInfo().ID == BuiltinValueKind::Sub ?
+        BuiltinValueKind::SSubOver : BuiltinValueKind::SMulOver;
+    IntRange LHS = getRange(BI->getOperand(0), At, Depth + 1);
+    IntRange RHS = getRange(BI->getOperand(1), At, Depth + 1);
+    if (auto R = IntRange::getExactResult(Kind, LHS, RHS))
+      return *R;
+    return Full;
+  }
+  case BuiltinValueKind::And: {
+    // Masking with a non-negative value can't make the value larger.
+    IntRange LHS = getRange(BI->getOperand(0), At, Depth + 1);
+    IntRange RHS = getRange(BI->getOperand(1), At, Depth + 1);
+    if (LHS.isNonNegative() && RHS.isNonNegative())
+      return IntRange(APInt(BitWidth, 0), smin(LHS.getMax(), RHS.getMax()));
+    if (LHS.isNonNegative())
+      return IntRange(APInt(BitWidth, 0), LHS.getMax());
+    if (RHS.isNonNegative())
+      return IntRange(APInt(BitWidth, 0), RHS.getMax());
+    return Full;
+  }
+  case BuiltinValueKind::SExt:
+  case BuiltinValueKind::SExtOrBitCast: {
+    SILValue Op = BI->getOperand(0);
+    if (!hasRange(Op))
+      return Full;
+    IntRange R = getRange(Op, At, Depth + 1);
+    return IntRange(R.getMin().sextOrSelf(BitWidth),
+                    R.getMax().sextOrSelf(BitWidth));
+  }
+  case BuiltinValueKind::ZExt:
+  case BuiltinValueKind::ZExtOrBitCast: {
+    SILValue Op = BI->getOperand(0);
+    if (!hasRange(Op))
+      return Full;
+    unsigned OpWidth = getBitWidth(Op);
+    IntRange R = getRange(Op, At, Depth + 1);
+    if (OpWidth == BitWidth)
+      return R;
+    if (R.isNonNegative())
+      return IntRange(R.getMin().zext(BitWidth), R.getMax().zext(BitWidth));
+    return IntRange(APInt(BitWidth, 0),
+                    APInt::getLowBitsSet(BitWidth, OpWidth));
+  }
+  case BuiltinValueKind::Trunc:
+  case BuiltinValueKind::TruncOrBitCast: {
+    SILValue Op = BI->getOperand(0);
+    if (!hasRange(Op))
+      return Full;
+    IntRange R = getRange(Op, At, Depth + 1);
+    if (auto Truncated = truncateRange(R.getMin(), R.getMax(), BitWidth))
+      return *Truncated;
+    return Full;
+  }
+  default:
+    return Full;
+  }
+}
+
+/// Returns the range of the value \p Arg receives from \p Pred.
+IntRange ValueRangeInfo::getIncomingRange(SILArgument *Arg,
+                                          SILBasicBlock *Pred,
+                                          unsigned Depth) {
+  SILBasicBlock *BB = Arg->getParent();
+  IntRange Full = IntRange::getFull(getBitWidth(Arg));
+  TermInst *Term = Pred->getTerminator();
+
+  SILValue Incoming;
+  if (auto *BI = dyn_cast<BranchInst>(Term)) {
+    Incoming = BI->getArg(Arg->getIndex());
+  } else if (auto *CBI = dyn_cast<CondBranchInst>(Term)) {
+    if (CBI->getTrueBB() == CBI->getFalseBB())
+      return Full;
+    Incoming = CBI->getTrueBB() == BB ? CBI->getTrueArgs()[Arg->getIndex()]
+                                      : CBI->getFalseArgs()[Arg->getIndex()];
+  } else {
+    return Full;
+  }
+
+  IntRange R = getRange(Incoming, Term, Depth + 1);
+  return refineWithEdgeCondition(Incoming, R, Pred, BB, Depth);
+}
+
+/// Narrows \p R, the range of \p V, with the condition of the edge from
+/// \p Pred to \p Succ.
+IntRange ValueRangeInfo::refineWithEdgeCondition(SILValue V, IntRange R,
+                                                 SILBasicBlock *Pred,
+                                                 SILBasicBlock *Succ,
+                                                 unsigned Depth) {
+  auto *CBI = dyn_cast<CondBranchInst>(Pred->getTerminator());
+  if (!CBI || CBI->getTrueBB() == CBI->getFalseBB())
+    return R;
+  auto *Cmp = dyn_cast<BuiltinInst>(CBI->getCondition());
+  if (!Cmp || !isComparison(Cmp->getBuiltinInfo().ID))
+    return R;
+
+  BuiltinValueKind Kind = Cmp->getBuiltinInfo().ID;
+  if (CBI->getFalseBB() == Succ)
+    Kind = invertPredicate(Kind);
+
+  SILValue LHS = Cmp->getOperand(0);
+  SILValue RHS = Cmp->getOperand(1);
+  if (RHS == V) {
+    std::swap(LHS, RHS);
+    Kind = swapPredicate(Kind);
+  }
+  if (LHS != V || !hasRange(RHS))
+    return R;
+  return refine(R, Kind, getRange(RHS, CBI, Depth + 1));
+}
+
+IntRange ValueRangeInfo::getArgumentRange(SILArgument *Arg, unsigned Depth) {
+  IntRange Full = IntRange::getFull(getBitWidth(Arg));
+
+  // The argument depends on itself in a loop. Give up, unless this is handled
+  // as an induction variable further up.
+  if (!VisitingArgs.insert(Arg).second)
+    return Full;
+
+  Optional<IntRange> R = getInductionVariableRange(Arg, Depth);
+  if (!R) {
+    for (auto *Pred : Arg->getParent()->getPreds()) {
+      IntRange Incoming = getIncomingRange(Arg, Pred, Depth);
+      R = R ? R->unionWith(Incoming) : Incoming;
+      if (R->isFull())
+        break;
+    }
+  }
+
+  VisitingArgs.erase(Arg);
+  return R ? *R : Full;
+}
+
+/// If \p V is the value of "sadd_with_overflow %Arg, Step" for a positive
+/// integer literal Step, returns the literal and sets \p Inc to the builtin.
+static IntegerLiteralInst *getCheckedIncrement(SILValue V, SILArgument *Arg,
+                                               BuiltinInst *&Inc) {
+  auto *TEI = dyn_cast<TupleExtractInst>(V);
+  if (!TEI || TEI->getFieldNo() != 0)
+    return nullptr;
+  Inc = dyn_cast<BuiltinInst>(TEI->getOperand());
+  if (!Inc || Inc->getBuiltinInfo().ID != BuiltinValueKind::SAddOver)
+    return nullptr;
+
+  SILValue LHS = Inc->getOperand(0);
+  SILValue RHS = Inc->getOperand(1);
+  if (RHS == SILValue(Arg))
+    std::swap(LHS, RHS);
+  auto *Step = dyn_cast<IntegerLiteralInst>(RHS);
+  if (LHS != SILValue(Arg) || !Step || !Step->getValue().isStrictlyPositive())
+    return nullptr;
+  return Step;
+}
+
+/// Handles a loop header argument which is incremented by a positive step on
+/// each back edge. As the increments are checked for overflow, the argument
+/// never gets smaller than its smallest start value. If it is incremented by
+/// one and the loop exits when the increment reaches a loop invariant end
+/// value, all values are smaller than the end value.
+Optional<IntRange>
+ValueRangeInfo::getInductionVariableRange(SILArgument *Arg, unsigned Depth) {
+  SILBasicBlock *BB = Arg->getParent();
+  unsigned BitWidth = getBitWidth(Arg);
+
+  Optional<IntRange> Start;
+  bool HasIncrement = false;
+  bool IncrementsByOne = true;
+  SILValue End;
+  bool HasEnd = true;
+
+  for (auto *Pred : BB->getPreds()) {
+    TermInst *Term = Pred->getTerminator();
+    SILValue Incoming;
+    if (auto *BI = dyn_cast<BranchInst>(Term))
+      Incoming = BI->getArg(Arg->getIndex());
+    else if (auto *CBI = dyn_cast<CondBranchInst>(Term))
+      Incoming = CBI->getTrueBB() == BB ? CBI->getTrueArgs()[Arg->getIndex()]
+                                        : CBI->getFalseArgs()[Arg->getIndex()];
+    else
+      return None;
+
+    BuiltinInst *Inc = nullptr;
+    if (auto *Step = getCheckedIncrement(Incoming, Arg, Inc)) {
+      if (!isOverflowCheckedAt(Inc, Term))
+        return None;
+      HasIncrement = true;
+      IncrementsByOne &= Step->getValue() == 1;
+
+      // Look for "cond_br (cmp_eq %inc, %end), exit, header".
+      SILValue IncEnd;
+      auto *CBI = dyn_cast<CondBranchInst>(Term);
+      auto *Cmp = CBI ? dyn_cast<BuiltinInst>(CBI->getCondition()) : nullptr;
+      if (Cmp && CBI->getTrueBB() != CBI->getFalseBB()) {
+        BuiltinValueKind Kind = Cmp->getBuiltinInfo().ID;
+        bool StaysOnFalse = CBI->getFalseBB() == BB;
+        if ((Kind == BuiltinValueKind::ICMP_EQ && StaysOnFalse) ||
+            (Kind == BuiltinValueKind::ICMP_NE && !StaysOnFalse)) {
+          if (Cmp->getOperand(0) == Incoming)
+            IncEnd = Cmp->getOperand(1);
+          else if (Cmp->getOperand(1) == Incoming)
+            IncEnd = Cmp->getOperand(0);
+        }
+      }
+      if (!IncEnd || (End && End != IncEnd))
+        HasEnd = false;
+      End = IncEnd;
+      continue;
+    }
+
+    IntRange StartRange = getIncomingRange(Arg, Pred, Depth);
+    Start = Start ? Start->unionWith(StartRange) : StartRange;
+  }
+
+  if (!Start || !HasIncrement)
+    return None;
+
+  APInt Max = APInt::getSignedMaxValue(BitWidth);
+  if (IncrementsByOne && HasEnd && End && hasRange(End)) {
+    // The end value must be defined outside of the loop and be larger than
+    // the start value. Otherwise the induction variable runs until its
+    // increment overflows.
+    SILBasicBlock *EndBB = End.getDef()->getParentBB();
+    if (EndBB && EndBB != BB && DT->properlyDominates(EndBB, BB)) {
+      IntRange EndRange = getRange(End, &*BB->begin(), Depth + 1);
+      if (Start->getMax().slt(EndRange.getMin()))
+        Max = EndRange.getMax() - 1;
+    }
+  }
+  return IntRange(Start->getMin(), Max);
+}
+
+bool ValueRangeInfo::isOverflowImpossible(BuiltinInst *BI) {
+  BuiltinValueKind Kind = BI->getBuiltinInfo().ID;
+  if (!isOverflowArithmetic(Kind) || !hasRange(BI->getOperand(0)) ||
+      !hasRange(BI->getOperand(1)))
+    return false;
+  IntRange LHS = getRange(BI->getOperand(0), BI);
+  IntRange RHS = getRange(BI->getOperand(1), BI);
+  return !IntRange::canOverflow(Kind, LHS, RHS);
+}
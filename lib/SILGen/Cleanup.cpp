@@ -12,16 +12,12 @@
 
 #include "Cleanup.h"
 #include "SILGenFunction.h"
+#include <algorithm>
 using namespace swift;
 using namespace Lowering;
 
-/// Are there any active cleanups in the given range?
-static bool hasAnyActiveCleanups(DiverseStackImpl<Cleanup>::iterator begin,
-                                 DiverseStackImpl<Cleanup>::iterator end) {
-  for (; begin != end; ++begin)
-    if (begin->isActive())
-      return true;
-  return false;
+static bool isActiveState(CleanupState state) {
+  return state >= CleanupState::Active;
 }
 
 namespace {
@@ -46,6 +42,9 @@ void CleanupManager::popTopDeadCleanups(CleanupsDepth end) {
 
   while (Stack.stable_begin() != end && Stack.begin()->isDead()) {
     assert(!Stack.empty());
+    assert((ActiveCleanups.empty() ||
+            ActiveCleanups.back() != Stack.stable_begin()) &&
+           "popping a dead cleanup which is recorded as active");
     Stack.pop();
     Stack.checkIterator(end);
   }
@@ -65,11 +64,18 @@ void CleanupManager::emitCleanups(CleanupsDepth depth, CleanupLocation l,
     Cleanup &cleanup = buffer.getCopy();
 
     // Advance stable iterator.
+    CleanupHandle handle = begin;
     begin = Stack.stabilize(++iter);
 
     // Pop now.
-    if (popCleanups)
+    if (popCleanups) {
+      if (cleanup.isActive()) {
+        assert(ActiveCleanups.back() == handle && "active cleanups out of sync");
+        ActiveCleanups.pop_back();
+      }
       Stack.pop();
+    }
+    (void)handle;
 
     if (cleanup.isActive() && Gen.B.hasValidInsertionPoint())
       cleanup.emit(Gen, l);
@@ -78,6 +84,31 @@ void CleanupManager::emitCleanups(CleanupsDepth depth, CleanupLocation l,
   }
 }
 
+/// Emit the active cleanups above the given depth without popping them.
+///
+/// Unlike emitCleanups, this only visits the active cleanups, so the cost of
+/// an exit through many scopes doesn't depend on the number of dead and
+/// dormant cleanups in those scopes.
+void CleanupManager::emitActiveCleanups(CleanupsDepth depth,
+                                        CleanupLocation l) {
+  Stack.checkIterator(depth);
+
+  // Copy the handles, since emitting a cleanup may push new cleanups.
+  auto first = std::upper_bound(ActiveCleanups.begin(), ActiveCleanups.end(),
+                                depth);
+  SmallVector<CleanupHandle, 8> handles(first, ActiveCleanups.end());
+
+  for (auto i = handles.rbegin(), e = handles.rend(); i != e; ++i) {
+    // Copy the cleanup off the stack in case it pushes a new cleanup and the
+    // backing storage is re-allocated.
+    CleanupBuffer buffer(*Stack.find(*i));
+    Cleanup &cleanup = buffer.getCopy();
+
+    if (cleanup.isActive() && Gen.B.hasValidInsertionPoint())
+      cleanup.emit(Gen, l);
+  }
+}
+
 /// Leave a scope, with all its cleanups.
 void CleanupManager::endScope(CleanupsDepth depth, CleanupLocation l) {
   Stack.checkIterator(depth);
@@ -85,7 +116,7 @@ void CleanupManager::endScope(CleanupsDepth depth, CleanupLocation l) {
   // FIXME: Thread a branch through the cleanups if there are any active
   // cleanups and we have a valid insertion point.
   
-  if (!::hasAnyActiveCleanups(Stack.begin(), Stack.find(depth))) {
+  if (!hasAnyActiveCleanups(depth)) {
     return;
   }
   
@@ -96,11 +127,16 @@ void CleanupManager::endScope(CleanupsDepth depth, CleanupLocation l) {
 
 bool CleanupManager::hasAnyActiveCleanups(CleanupsDepth from,
                                           CleanupsDepth to) {
-  return ::hasAnyActiveCleanups(Stack.find(from), Stack.find(to));
+  Stack.checkIterator(from);
+  Stack.checkIterator(to);
+  auto first = std::upper_bound(ActiveCleanups.begin(), ActiveCleanups.end(),
+                                to);
+  return first != ActiveCleanups.end() && !(from < *first);
 }
 
 bool CleanupManager::hasAnyActiveCleanups(CleanupsDepth from) {
-  return ::hasAnyActiveCleanups(Stack.begin(), Stack.find(from));
+  Stack.checkIterator(from);
+  return !ActiveCleanups.empty() && from < ActiveCleanups.back();
 }
 
 /// emitBranchAndCleanups - Emit a branch to the given jump destination,
@@ -111,7 +147,7 @@ void CleanupManager::emitBranchAndCleanups(JumpDest Dest,
                                            ArrayRef<SILValue> Args) {
   SILGenBuilder &B = Gen.getBuilder();
   assert(B.hasValidInsertionPoint() && "Emitting branch in invalid spot");
-  emitCleanups(Dest.getDepth(), Dest.getCleanupLocation(), /*popCleanups=*/false);
+  emitActiveCleanups(Dest.getDepth(), Dest.getCleanupLocation());
   B.createBranch(BranchLoc, Dest.getBlock(), Args);
 }
 
@@ -119,7 +155,7 @@ void CleanupManager::emitCleanupsForReturn(CleanupLocation Loc) {
   SILGenBuilder &B = Gen.getBuilder();
   assert(B.hasValidInsertionPoint() && "Emitting return in invalid spot");
   (void) B;
-  emitCleanups(Stack.stable_end(), Loc, /*popCleanups=*/false);
+  emitActiveCleanups(Stack.stable_end(), Loc);
 }
 
 /// Emit a new block that jumps to the specified location and runs necessary
@@ -145,13 +181,36 @@ Cleanup &CleanupManager::initCleanup(Cleanup &cleanup,
                                      CleanupState state) {
   cleanup.allocatedSize = allocSize;
   cleanup.state = state;
+  if (isActiveState(state))
+    ActiveCleanups.push_back(Stack.stable_begin());
   return cleanup;
 }
 
+void CleanupManager::updateActiveCleanups(CleanupHandle handle,
+                                          CleanupState oldState,
+                                          CleanupState newState) {
+  bool wasActive = isActiveState(oldState);
+  bool isActive = isActiveState(newState);
+  if (wasActive == isActive)
+    return;
+
+  auto pos = std::lower_bound(ActiveCleanups.begin(), ActiveCleanups.end(),
+                              handle);
+  if (isActive) {
+    assert((pos == ActiveCleanups.end() || *pos != handle) &&
+           "cleanup is already recorded as active");
+    ActiveCleanups.insert(pos, handle);
+  } else {
+    assert(pos != ActiveCleanups.end() && *pos == handle &&
+           "cleanup is not recorded as active");
+    ActiveCleanups.erase(pos);
+  }
+}
+
 void CleanupManager::setCleanupState(CleanupsDepth depth, CleanupState state) {
   auto iter = Stack.find(depth);
   assert(iter != Stack.end() && "can't change end of cleanups stack");
-  setCleanupState(*iter, state);
+  setCleanupState(depth, *iter, state);
   
   if (state == CleanupState::Dead && iter == Stack.begin())
     popTopDeadCleanups(InnermostScope);
@@ -166,20 +225,21 @@ void CleanupManager::forwardCleanup(CleanupsDepth handle) {
   CleanupState newState = (cleanup.getState() == CleanupState::Active
                              ? CleanupState::Dead
                              : CleanupState::Dormant);
-  setCleanupState(cleanup, newState);
+  setCleanupState(handle, cleanup, newState);
 
   if (newState == CleanupState::Dead && iter == Stack.begin())
     popTopDeadCleanups(InnermostScope);
 }
 
-void CleanupManager::setCleanupState(Cleanup &cleanup, CleanupState state) {
+void CleanupManager::setCleanupState(CleanupHandle handle, Cleanup &cleanup,
+                                     CleanupState state) {
   assert(Gen.B.hasValidInsertionPoint() &&
          "changing cleanup state at invalid IP");
 
   // Do the transition now to avoid doing it in N places below.
   CleanupState oldState = cleanup.getState();
-  (void)oldState;
   cleanup.setState(state);
+  updateActiveCleanups(handle, oldState, state);
 
   assert(state != oldState && "trivial cleanup state change");
   assert(oldState != CleanupState::Dead && "changing state of dead cleanup");
@@ -202,6 +262,7 @@ void CleanupStateRestorationScope::pushCleanupState(CleanupHandle handle,
 
   CleanupState oldState = cleanup.getState();
   cleanup.setState(newState);
+  Cleanups.updateActiveCleanups(handle, oldState, newState);
 
   SavedStates.push_back({handle, oldState});
 }
@@ -229,6 +290,8 @@ void CleanupStateRestorationScope::pop() {
     Cleanup &cleanup = *iter;
     assert(cleanup.getState() != CleanupState::Dead &&
            "changing state of dead cleanup");
+    CleanupState oldState = cleanup.getState();
     cleanup.setState(stateToRestore);
+    Cleanups.updateActiveCleanups(handle, oldState, stateToRestore);
   }
 }
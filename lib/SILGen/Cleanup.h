@@ -91,6 +91,15 @@ class LLVM_LIBRARY_VISIBILITY CleanupManager {
   /// Stack - Currently active cleanups in this scope tree.
   DiverseStack<Cleanup, 128> Stack;
 
+  /// The handles of the active cleanups on the stack, from the bottom of the
+  /// stack to the top.
+  ///
+  /// Dead and dormant cleanups stay on the stack as long as there are live
+  /// cleanups above them. Branching out of several scopes only has to visit
+  /// the active cleanups, so it looks them up here instead of walking the
+  /// stack.
+  SmallVector<CleanupHandle, 16> ActiveCleanups;
+
   /// The shallowest depth held by an active Scope object.
   ///
   /// Generally, the rule is that a CleanupHandle is invalidated as
@@ -106,10 +115,14 @@ class LLVM_LIBRARY_VISIBILITY CleanupManager {
   void popTopDeadCleanups(CleanupsDepth end);
   void emitCleanups(CleanupsDepth depth, CleanupLocation l,
                     bool popCleanups=true);
+  void emitActiveCleanups(CleanupsDepth depth, CleanupLocation l);
   void endScope(CleanupsDepth depth, CleanupLocation l);
 
   Cleanup &initCleanup(Cleanup &cleanup, size_t allocSize, CleanupState state);
-  void setCleanupState(Cleanup &cleanup, CleanupState state);
+  void setCleanupState(CleanupHandle handle, Cleanup &cleanup,
+                       CleanupState state);
+  void updateActiveCleanups(CleanupHandle handle, CleanupState oldState,
+                            CleanupState newState);
 
   friend class CleanupStateRestorationScope;
   
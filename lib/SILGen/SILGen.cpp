@@ -26,6 +26,7 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "ManagedValue.h"
 using namespace swift;
@@ -38,6 +39,16 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const auto &Opts = M.getOptions();
+  if (!Opts.ProfileUsePath.empty()) {
+    auto ReaderOrErr =
+        llvm::IndexedInstrProfReader::create(Opts.ProfileUsePath);
+    if (std::error_code EC = ReaderOrErr.getError())
+      diagnose(SourceLoc(), diag::cannot_open_profile, Opts.ProfileUsePath,
+               EC.message());
+    else
+      PGOReader = std::move(ReaderOrErr.get());
+  }
 }
 
 SILGenModule::~SILGenModule() {
@@ -453,6 +453,12 @@ namespace {
       return ManagedValue::forLValue(Res);
     }
 
+    /// Extract this element from a loaded \p base.
+    SILValue extract(SILGenFunction &gen, SILLocation loc, SILValue base) {
+      return gen.B.createTupleExtract(loc, base, ElementIndex,
+                                      getTypeOfRValue());
+    }
+
     void print(raw_ostream &OS) const override {
       OS << "TupleElementComponent(" << ElementIndex << ")\n";
     }
@@ -475,6 +481,19 @@ namespace {
                                                Field, SubstFieldType);
       return ManagedValue::forLValue(Res);
     }
+
+    /// True if the field is stored as its r-value type, rather than as,
+    /// say, an unowned reference.
+    bool isStoredAsRValue() const {
+      return SubstFieldType.getObjectType() == getTypeOfRValue();
+    }
+
+    /// Extract this field from a loaded \p base.
+    SILValue extract(SILGenFunction &gen, SILLocation loc, SILValue base) {
+      return gen.B.createStructExtract(loc, base, Field,
+                                       SubstFieldType.getObjectType());
+    }
+
     void print(raw_ostream &OS) const override {
       OS << "StructElementComponent(" << Field->getName() << ")\n";
     }
@@ -2319,12 +2338,104 @@ static PathComponent &&drillToLastComponent(SILGenFunction &SGF,
   return std::move(**(lv.end() - 1));
 }
 
+/// If the lvalue ends in a getter of a loadable value followed only by
+/// stored struct fields and tuple elements, as in 'a.computed.x', returns the
+/// getter. Otherwise returns src.end().
+static LValue::iterator findLoadableGetterBeforeElements(SILGenFunction &SGF,
+                                                         LValue &src) {
+  auto getter = src.end();
+  while (getter != src.begin()) {
+    PathComponent &component = **(getter - 1);
+    if (component.getKind() == PathComponent::TupleElementKind) {
+      --getter;
+      continue;
+    }
+    if (component.getKind() == PathComponent::StructElementKind &&
+        static_cast<StructElementComponent &>(component).isStoredAsRValue()) {
+      --getter;
+      continue;
+    }
+    break;
+  }
+
+  if (getter == src.end() || getter == src.begin())
+    return src.end();
+  --getter;
+  if ((*getter)->getKind() != PathComponent::GetterSetterKind ||
+      !SGF.getTypeLowering((*getter)->getTypeOfRValue()).isLoadable())
+    return src.end();
+  return getter;
+}
+
+/// Load from an lvalue whose last logical component is \p getter, which is
+/// followed only by stored struct fields and tuple elements. The elements
+/// are extracted from the value the getter returns, rather than addressed
+/// in a temporary it's stored to.
+static ManagedValue emitLoadOfGetterElements(SILGenFunction &SGF,
+                                             SILLocation loc, LValue &&src,
+                                             LValue::iterator getter) {
+  // Work out the access each component needs to its base, as
+  // drillToLastComponent does.
+  SmallVector<AccessKind, 8> accessKinds(src.end() - src.begin());
+  AccessKind accessKind = AccessKind::Read;
+  for (unsigned i = accessKinds.size(); i != 0; --i) {
+    accessKinds[i - 1] = accessKind;
+    accessKind = (*(src.begin() + i - 1))->getBaseAccessKind(SGF, accessKind);
+  }
+
+  ManagedValue base;
+  unsigned index = 0;
+  for (auto i = src.begin(); i != getter; ++i, ++index)
+    base = drillIntoComponent(SGF, loc, std::move(**i), base,
+                              accessKinds[index]);
+
+  auto &getterComponent = (*getter)->asLogical();
+  SILType aggregateType = getterComponent.getTypeOfRValue();
+  AbstractionPattern origType = getterComponent.getOrigFormalType();
+  CanType substType = getterComponent.getSubstFormalType();
+  ManagedValue aggregate =
+    std::move(getterComponent).get(SGF, loc, base, SGFContext());
+  if (aggregate.getType().getSwiftRValueType() !=
+        aggregateType.getSwiftRValueType())
+    aggregate = SGF.emitSubstToOrigValue(loc, aggregate, origType, substType);
+
+  // A getter can't produce a loadable value at an address unless its
+  // result was reabstracted; address into it as usual in that case.
+  if (aggregate.getType().isAddress()) {
+    ManagedValue addr = aggregate;
+    for (auto i = getter + 1; i != src.end(); ++i)
+      addr = std::move((*i)->asPhysical()).offset(SGF, loc, addr,
+                                                   AccessKind::Read);
+    return SGF.emitLoad(loc, addr.getValue(),
+                        SGF.getTypeLowering(src.getTypeOfRValue()),
+                        SGFContext(), IsNotTake);
+  }
+
+  // The aggregate keeps its cleanup, so the element only needs a copy.
+  SILValue element = aggregate.getValue();
+  for (auto i = getter + 1; i != src.end(); ++i) {
+    if ((*i)->getKind() == PathComponent::TupleElementKind)
+      element = static_cast<TupleElementComponent &>(**i)
+                  .extract(SGF, loc, element);
+    else
+      element = static_cast<StructElementComponent &>(**i)
+                  .extract(SGF, loc, element);
+  }
+  return SGF.emitManagedRetain(loc, element);
+}
+
 ManagedValue SILGenFunction::emitLoadOfLValue(SILLocation loc, LValue &&src,
                                               SGFContext C,
                                               bool isGuaranteedValid) {
   // Any writebacks should be scoped to after the load.
   WritebackScope scope(*this);
 
+  // Peephole: project stored elements out of a loadable getter result
+  // directly, instead of storing it to a temporary to address into.
+  auto getter = findLoadableGetterBeforeElements(*this, src);
+  if (getter != src.end())
+    return emitLoadOfGetterElements(*this, loc, std::move(src), getter);
+
   ManagedValue addr;
   PathComponent &&component =
     drillToLastComponent(*this, loc, std::move(src), addr, AccessKind::Read);
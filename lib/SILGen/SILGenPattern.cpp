@@ -18,6 +18,7 @@
 #include "Initialization.h"
 #include "RValue.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallSet.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormattedStream.h"
 #include "swift/AST/DiagnosticsSIL.h"
@@ -243,6 +244,105 @@ static bool isWildcardPattern(const Pattern *p) {
   }
 }
 
+/// If the given type is one of the standard library's fixed-width integer
+/// types, return the stored property holding its builtin integer value.
+static VarDecl *getStdlibIntegerValueProperty(CanType type, bool &isSigned) {
+  auto *structDecl = type->getStructOrBoundGenericStruct();
+  if (!structDecl || structDecl->getGenericParams() ||
+      !structDecl->getParentModule()->isStdlibModule())
+    return nullptr;
+
+  StringRef name = structDecl->getName().str();
+  isSigned = !name.startswith("U");
+  if (!isSigned)
+    name = name.drop_front();
+  if (name != "Int" && name != "Int8" && name != "Int16" && name != "Int32" &&
+      name != "Int64")
+    return nullptr;
+
+  auto members =
+    structDecl->lookupDirect(structDecl->getASTContext().Id_value_);
+  if (members.size() != 1)
+    return nullptr;
+  auto *property = dyn_cast<VarDecl>(members[0]);
+  if (!property || !property->hasType())
+    return nullptr;
+  auto *builtinTy = property->getType()->getAs<BuiltinIntegerType>();
+  if (!builtinTy || !builtinTy->isFixedWidth())
+    return nullptr;
+  return property;
+}
+
+/// If the given pattern is an ExprPattern which compares its value with an
+/// integer literal using the standard library's '~=' for Equatable types,
+/// return the literal's value truncated to \p bitWidth.
+///
+/// For the standard library's integer types this '~=' is just '==', so such
+/// patterns can be tested with a switch_value of the builtin value instead of
+/// with a call of '~=' per pattern.
+static Optional<APInt> getIntegerLiteralPatternValue(Pattern *p,
+                                                    CanType subjectType,
+                                                    unsigned bitWidth,
+                                                    bool isSigned) {
+  auto *exprPattern =
+    dyn_cast_or_null<ExprPattern>(p ? p->getSemanticsProvidingPattern()
+                                    : nullptr);
+  if (!exprPattern || !exprPattern->getMatchExpr())
+    return None;
+
+  // Find the 'literal ~= $match' call within the condition.
+  BinaryExpr *match = nullptr;
+  exprPattern->getMatchExpr()->forEachChildExpr([&](Expr *E) -> Expr * {
+    if (!match)
+      if (auto *binary = dyn_cast<BinaryExpr>(E))
+        if (auto *args = dyn_cast<TupleExpr>(binary->getArg()))
+          if (args->getNumElements() == 2)
+            if (auto *ref = dyn_cast<DeclRefExpr>(
+                  args->getElement(1)->getSemanticsProvidingExpr()))
+              if (ref->getDecl() == exprPattern->getMatchVar())
+                match = binary;
+    return E;
+  });
+  if (!match)
+    return None;
+
+  auto *fn = dyn_cast_or_null<FuncDecl>(match->getCalledValue());
+  if (!fn || !fn->getModuleContext()->isStdlibModule() ||
+      !fn->getGenericParams() || fn->getGenericParams()->size() != 1)
+    return None;
+
+  // The stdlib's other single-parameter '~=' operators are for intervals,
+  // ranges and nil, none of which compare two values of the subject's type.
+  Expr *lhs = cast<TupleExpr>(match->getArg())->getElement(0)
+                ->getSemanticsProvidingExpr();
+  if (!lhs->getType() ||
+      lhs->getType()->getCanonicalType() != subjectType)
+    return None;
+
+  // A literal converted to an integer type is a call of its builtin literal
+  // initializer with the literal, at the builtin type, as the only argument.
+  auto *call = dyn_cast<CallExpr>(lhs);
+  if (!call)
+    return None;
+  Expr *arg = call->getArg();
+  if (auto *tuple = dyn_cast<TupleExpr>(arg)) {
+    if (tuple->getNumElements() != 1)
+      return None;
+    arg = tuple->getElement(0);
+  }
+  auto *literal = dyn_cast<IntegerLiteralExpr>(arg->getSemanticsProvidingExpr());
+  if (!literal || !literal->getType() ||
+      !literal->getType()->is<BuiltinIntegerType>())
+    return None;
+
+  // Leave literals which don't fit to the diagnostics of the '~=' call.
+  APInt value = literal->getValue();
+  if (isSigned ? value.getMinSignedBits() > bitWidth
+               : value.isNegative() || value.getActiveBits() > bitWidth)
+    return None;
+  return value.sextOrTrunc(bitWidth);
+}
+
 /// Check to see if the given pattern is a specializing pattern,
 /// and return a semantic pattern for it.
 Pattern *getSpecializingPattern(Pattern *p) {
@@ -430,6 +530,9 @@ public:
 private:
   void emitWildcardDispatch(ClauseMatrix &matrix, ArgArray args, unsigned row,
                             const FailureHandler &failure);
+  bool emitIntegerLiteralDispatch(ClauseMatrix &matrix, ArgArray args,
+                                  unsigned &firstRow,
+                                  const FailureHandler &failure);
 
   void bindRefutablePatterns(const ClauseRow &row, ArgArray args,
                              const FailureHandler &failure);
@@ -970,8 +1073,12 @@ void PatternMatchEmission::emitDispatch(ClauseMatrix &clauses, ArgArray args,
       SGF.Cleanups.emitBranchAndCleanups(scope.getExitDest(), loc);
     };
 
-    // If there is no necessary column, just emit the first row.
-    if (!column) {
+    // If the next rows compare an integer with literals, test them all with
+    // one switch_value. Otherwise, if there is no necessary column, just emit
+    // the first row.
+    if (emitIntegerLiteralDispatch(clauses, args, firstRow, innerFailure)) {
+      // Dispatched.
+    } else if (!column) {
       unsigned wildcardRow = firstRow++;
       emitWildcardDispatch(clauses, args, wildcardRow, innerFailure);
     } else {
@@ -1048,6 +1155,83 @@ void PatternMatchEmission::emitWildcardDispatch(ClauseMatrix &clauses,
   assert(!SGF.B.hasValidInsertionPoint());
 }
 
+/// Emit the decision tree for a run of rows, starting at \p firstRow, which
+/// each compare a single integer with a literal and have no guard. The run is
+/// tested with one switch_value on the builtin value of the integer, which
+/// LLVM lowers to a jump table or a binary search, instead of with a call of
+/// '~=' per row.
+///
+/// \returns false, without emitting anything, if there are fewer than two
+///   such rows; otherwise advances \p firstRow past the run.
+bool PatternMatchEmission::
+emitIntegerLiteralDispatch(ClauseMatrix &clauses, ArgArray args,
+                           unsigned &firstRow,
+                           const FailureHandler &failure) {
+  if (args.size() != 1 || args[0].getType().isAddress())
+    return false;
+
+  CanType subjectType = args[0].getType().getSwiftRValueType();
+  bool isSigned;
+  VarDecl *valueProperty = getStdlibIntegerValueProperty(subjectType,
+                                                         isSigned);
+  if (!valueProperty)
+    return false;
+  auto *builtinTy = valueProperty->getType()->castTo<BuiltinIntegerType>();
+  unsigned bitWidth = builtinTy->getFixedWidth();
+
+  // Collect the run. A later row with the same value as an earlier one can
+  // only be reached through the rows after the run, so it ends it.
+  SmallVector<APInt, 16> values;
+  llvm::SmallSet<uint64_t, 16> seenValues;
+  unsigned endRow = firstRow;
+  for (unsigned e = clauses.rows(); endRow != e; ++endRow) {
+    const ClauseRow &row = clauses[endRow];
+    if (row.columns() != 1 || row.getCaseGuardExpr())
+      break;
+    auto value = getIntegerLiteralPatternValue(row[0], subjectType, bitWidth,
+                                               isSigned);
+    if (!value || !seenValues.insert(value->getZExtValue()).second)
+      break;
+    values.push_back(*value);
+  }
+  if (values.size() < 2)
+    return false;
+
+  SILLocation loc = PatternMatchStmt;
+  loc.setDebugLoc(clauses[firstRow][0]);
+
+  SILBasicBlock *curBB = SGF.B.getInsertionBB();
+  SILType builtinSILTy = SILType::getPrimitiveObjectType(CanType(builtinTy));
+  SmallVector<std::pair<SILValue, SILBasicBlock*>, 16> caseBBs;
+  caseBBs.reserve(values.size());
+  for (auto &value : values) {
+    curBB = SGF.createBasicBlock(curBB);
+    auto *IL = SGF.B.createIntegerLiteral(loc, builtinSILTy, value);
+    caseBBs.push_back({SILValue(IL, 0), curBB});
+  }
+  SILBasicBlock *defaultBB = SGF.createBasicBlock(curBB);
+
+  // The subject is trivial, so it can be used again by the rows after the
+  // run without being copied.
+  auto *value = SGF.B.createStructExtract(loc, args[0].getValue(),
+                                          valueProperty);
+  SGF.B.createSwitchValue(loc, SILValue(value, 0), defaultBB, caseBBs);
+
+  // Enter each row of the run.
+  unsigned row = firstRow;
+  firstRow = endRow;
+  for (auto &caseBB : caseBBs) {
+    SGF.B.setInsertionPoint(caseBB.second);
+    CompletionHandler(*this, clauses[row++]);
+    assert(!SGF.B.hasValidInsertionPoint() && "did not end block");
+  }
+
+  // Continue with the rows after the run.
+  SGF.B.setInsertionPoint(defaultBB);
+  failure(loc);
+  return true;
+}
+
 /// Bind all the irrefutable patterns in the given row, which is
 /// nothing but wildcard patterns.
 void PatternMatchEmission::
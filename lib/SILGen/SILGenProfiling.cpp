@@ -20,6 +20,7 @@
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/ProfileData/CoverageMapping.h"
 #include "llvm/ProfileData/CoverageMappingWriter.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -29,7 +30,7 @@ using namespace Lowering;
 ProfilerRAII::ProfilerRAII(SILGenModule &SGM, AbstractFunctionDecl *D)
     : SGM(SGM) {
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile)
+  if (!Opts.GenerateProfile && !SGM.PGOReader)
     return;
   SGM.Profiler =
       llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
@@ -71,9 +72,13 @@ struct MapRegionCounters : public ASTWalker {
     } else if (auto *FES = dyn_cast<ForEachStmt>(S)) {
       CounterMap[FES->getBody()] = NextCounter++;
     } else if (auto *SS = dyn_cast<SwitchStmt>(S)) {
-      CounterMap[SS] = NextCounter++;
-    } else if (auto *CS = dyn_cast<CaseStmt>(S)) {
-      CounterMap[CS] = NextCounter++;
+      // The switch is entered as often as its enclosing region, and the last
+      // case is matched whenever none of the others is, so neither needs a
+      // counter of its own.
+      ArrayRef<CaseStmt *> Cases = SS->getCases();
+      if (!Cases.empty())
+        for (CaseStmt *CS : Cases.drop_back())
+          CounterMap[CS] = NextCounter++;
     } else if (auto *DCS = dyn_cast<DoCatchStmt>(S)) {
       CounterMap[DCS] = NextCounter++;
     } else if (auto *CS = dyn_cast<CatchStmt>(S)) {
@@ -471,10 +476,21 @@ public:
       assignCounter(FES->getBody());
 
     } else if (auto *SS = dyn_cast<SwitchStmt>(S)) {
-      assignCounter(SS);
-      // Assign counters for cases so they're available for fallthrough.
-      for (CaseStmt *Case : SS->getCases())
-        assignCounter(Case);
+      CounterExpr *Unmatched =
+          &assignCounter(SS, CounterExpr::Ref(getCurrentCounter()));
+      // Assign counters for cases so they're available for fallthrough. Every
+      // entry of the switch matches exactly one case, so the last case is
+      // matched as often as none of the others is. Fallthroughs are added to
+      // the cases' counters later, so subtract separate copies of them.
+      ArrayRef<CaseStmt *> Cases = SS->getCases();
+      if (!Cases.empty()) {
+        for (CaseStmt *Case : Cases.drop_back()) {
+          assignCounter(Case);
+          CounterExpr &Matched = createCounter(CounterExpr::Leaf(Case));
+          Unmatched = &createCounter(CounterExpr::Sub(*Unmatched, Matched));
+        }
+        assignCounter(Cases.back(), CounterExpr::Ref(*Unmatched));
+      }
 
     } else if (isa<CaseStmt>(S)) {
       pushRegion(S);
@@ -615,6 +631,14 @@ void SILGenProfiling::assignRegionCounters(AbstractFunctionDecl *Root) {
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
 
+  // Read the counts of a previous profiled run, if we have any. Functions
+  // without profile data just don't get any counts.
+  RegionCounts.clear();
+  if (SGM.PGOReader)
+    if (SGM.PGOReader->getFunctionCounts(CurrentFuncName, FunctionHash,
+                                         RegionCounts))
+      RegionCounts.clear();
+
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SGM.M.getASTContext().SourceMgr);
     walkForProfiling(Root, Coverage);
@@ -637,9 +661,22 @@ static SILLocation getLocation(ASTNode Node) {
 void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   auto &C = Builder.getASTContext();
 
+  // Nodes whose counts are derived from other counters don't have a counter
+  // to increment.
   auto CounterIt = RegionCounterMap.find(Node);
-  assert(CounterIt != RegionCounterMap.end() &&
-         "cannot increment non-existent counter");
+  if (CounterIt == RegionCounterMap.end())
+    return;
+
+  // The counter of the region which starts in the entry block tells how often
+  // the function was entered.
+  if (CounterIt->second < RegionCounts.size()) {
+    SILFunction &F = Builder.getFunction();
+    if (!F.getEntryCount() && Builder.getInsertionBB() == &*F.begin())
+      F.setEntryCount(RegionCounts[CounterIt->second]);
+  }
+
+  if (!SGM.M.getOptions().GenerateProfile)
+    return;
 
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
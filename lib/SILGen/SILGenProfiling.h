@@ -47,6 +47,10 @@ private:
 
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
+  // The counts of the current function's counters in a profiled run, if the
+  // function was compiled with profile data.
+  std::vector<uint64_t> RegionCounts;
+
 public:
   SILGenProfiling(SILGenModule &SGM, bool EmitCoverageMapping)
       : SGM(SGM), EmitCoverageMapping(EmitCoverageMapping),
@@ -57,7 +61,8 @@ public:
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(AbstractFunctionDecl *Root);
 
-  /// Emit SIL to increment the counter for \c Node.
+  /// Emit SIL to increment the counter for \c Node, and record the profiled
+  /// count of \c Node if it starts the function's entry block.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 };
 
@@ -219,7 +219,8 @@ bool ARCRegionState::processBlockBottomUp(
 // Find the relevant insertion points for the loop region R in its
 // successors. Returns true if we succeeded. Returns false if any of the
 // non-local successors of the region are not leaking blocks. We currently do
-// not handle early exits, but do handle trapping blocks.
+// not handle early exits, but do handle trapping blocks and blocks that only
+// branch to trapping blocks.
 static bool getInsertionPtsForLoopRegionExits(
     const LoopRegion *R, LoopRegionFunctionInfo *LRFI,
     llvm::DenseMap<const LoopRegion *, ARCRegionState *> &RegionStateInfo,
@@ -230,7 +231,8 @@ static bool getInsertionPtsForLoopRegionExits(
   // ignored, we bail for simplicity. This means that for now we do not handle
   // early exits.
   if (any_of(R->getNonLocalSuccs(), [&](unsigned SuccID) -> bool {
-        return !RegionStateInfo[LRFI->getRegion(SuccID)]->allowsLeaks();
+        auto *SuccRegion = LRFI->getRegionForNonLocalSuccessor(R, SuccID);
+        return !RegionStateInfo[SuccRegion]->allowsLeaks();
       })) {
     return false;
   }
@@ -70,6 +70,10 @@ public:
   /// Is this Region from which we can leak memory safely?
   bool allowsLeaks() const { return AllowsLeaks; }
 
+  /// Mark this region as one from which we can leak memory safely. Used to
+  /// propagate leaking through blocks that just branch to a leaking block.
+  void setAllowsLeaks() { AllowsLeaks = true; }
+
   /// Top Down Iterators
   using topdown_iterator = TopDownMapTy::iterator;
   using topdown_const_iterator = TopDownMapTy::const_iterator;
@@ -32,6 +32,21 @@ using namespace swift;
 //                                  Utility
 //===----------------------------------------------------------------------===//
 
+/// If \p BB does nothing interesting besides unconditionally branching to
+/// another block, return that block. Loop canonicalization introduces such
+/// blocks as dedicated loop exits, so we look through them when deciding if an
+/// exit leads to a trap.
+static SILBasicBlock *getTrampolineDestination(SILBasicBlock *BB) {
+  auto *Br = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!Br)
+    return nullptr;
+  for (auto &I : *BB) {
+    if (&I != Br && I.mayHaveSideEffects())
+      return nullptr;
+  }
+  return Br->getDestBB();
+}
+
 /// Returns true if it is defined to perform a bottom up from \p Succ to \p
 /// Pred.
 ///
@@ -164,7 +179,9 @@ void LoopARCSequenceDataflowEvaluator::mergeSuccessors(const LoopRegion *Region,
     // Check if this block is post dominated by ARC unreachable
     // blocks. Otherwise we clear all state.
     //
-    // TODO: We just check the block itself for now.
+    // TODO: We only look through blocks that unconditionally branch to a
+    // leaking block (see propagateAllowsLeaks). General post dominance is not
+    // handled yet.
     if (SuccState.allowsLeaks()) {
       DEBUG(llvm::dbgs() << "        Allows leaks skipping\n");
       continue;
@@ -258,6 +275,31 @@ LoopARCSequenceDataflowEvaluator::LoopARCSequenceDataflowEvaluator(
   for (auto *R : LRFI->getRegions()) {
     RegionStateInfo[R] = new (Allocator) ARCRegionState(R);
   }
+  propagateAllowsLeaks();
+}
+
+/// Mark block regions that only branch to a leaking block as leaking as well
+/// so that early exits into trapping code do not clear the dataflow state of
+/// the loops they exit.
+void LoopARCSequenceDataflowEvaluator::propagateAllowsLeaks() {
+  bool Changed;
+  do {
+    Changed = false;
+    for (auto *R : LRFI->getRegions()) {
+      if (!R->isBlock())
+        continue;
+      auto *State = RegionStateInfo[R];
+      if (State->allowsLeaks())
+        continue;
+      SILBasicBlock *Dest = getTrampolineDestination(R->getBlock());
+      if (!Dest || Dest == R->getBlock())
+        continue;
+      if (!RegionStateInfo[LRFI->getRegion(Dest)]->allowsLeaks())
+        continue;
+      State->setAllowsLeaks();
+      Changed = true;
+    }
+  } while (Changed);
 }
 
 LoopARCSequenceDataflowEvaluator::~LoopARCSequenceDataflowEvaluator() {
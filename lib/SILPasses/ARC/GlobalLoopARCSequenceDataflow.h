@@ -102,6 +102,9 @@ private:
 
   void computePostDominatingConsumedArgMap();
 
+  /// Mark block regions that just branch to leaking regions as leaking.
+  void propagateAllowsLeaks();
+
   ARCRegionState &getARCState(const LoopRegion *L) {
     auto Iter = RegionStateInfo.find(L);
     assert(Iter != RegionStateInfo.end() && "Should have created state for "
@@ -751,6 +751,14 @@ static bool isApplyOfStringConcat(SILInstruction &I) {
   return false;
 }
 
+static bool isApplyOfStringInterpolation(SILInstruction &I) {
+  if (auto *AI = dyn_cast<ApplyInst>(&I))
+    if (auto *Fn = AI->getCalleeFunction())
+      if (Fn->hasSemanticsString("string.interpolation"))
+        return true;
+  return false;
+}
+
 static bool isFoldable(SILInstruction *I) {
   return isa<IntegerLiteralInst>(I) || isa<FloatLiteralInst>(I);
 }
@@ -797,6 +805,25 @@ constantFoldStringConcatenation(ApplyInst *AI,
   return true;
 }
 
+static bool
+constantFoldStringInterpolation(ApplyInst *AI,
+                                llvm::SetVector<SILInstruction *> &WorkList) {
+  SILBuilder B(AI);
+  auto RemoveCallback = [&](SILInstruction *DeadI) { WorkList.remove(DeadI); };
+  // Try to fold the interpolation of constant segments into a literal.
+  auto *Folded = tryToFoldStringInterpolation(AI, B, RemoveCallback);
+  if (!Folded)
+    return false;
+
+  // The folded literal may be an operand of a string concatenation.
+  for (auto FoldedUse : Folded->getUses()) {
+    if (isApplyOfStringConcat(*FoldedUse->getUser())) {
+      WorkList.insert(FoldedUse->getUser());
+    }
+  }
+  return true;
+}
+
 /// Initialize the worklist to all of the constant instructions.
 static void initializeWorklist(SILFunction &F,
                                bool InstantiateAssertConfiguration,
@@ -823,7 +850,7 @@ static void initializeWorklist(SILFunction &F,
         continue;
       }
 
-      if (!isApplyOfStringConcat(I)) {
+      if (!isApplyOfStringConcat(I) && !isApplyOfStringInterpolation(I)) {
         continue;
       }
       WorkList.insert(&I);
@@ -913,8 +940,10 @@ processFunction(SILFunction &F, bool EnableDiagnostics,
       }
 
     if (auto *AI = dyn_cast<ApplyInst>(I)) {
-      // Apply may only come from a string.concat invocation.
-      if (constantFoldStringConcatenation(AI, WorkList)) {
+      // Apply may only come from a string.concat or string.interpolation
+      // invocation.
+      if (constantFoldStringConcatenation(AI, WorkList) ||
+          constantFoldStringInterpolation(AI, WorkList)) {
         // Invalidate all analysis that's related to the call graph.
         InvalidateInstructions = true;
       }
@@ -382,8 +382,11 @@ runOnFunctionRecursively(SILFunction *F, FullApplySite AI,
         ApplySubs.insert(ApplySubs.end(), PAISubs.begin(), PAISubs.end());
       }
 
-      ContextSubs.copyFrom(CalleeFunction->getContextGenericParams()
-                                         ->getSubstitutionMap(ApplySubs));
+      // A non-generic callee, like most stdlib arithmetic wrappers, has
+      // nothing to substitute.
+      if (!ApplySubs.empty())
+        ContextSubs.copyFrom(CalleeFunction->getContextGenericParams()
+                                           ->getSubstitutionMap(ApplySubs));
 
       SILInliner Inliner(*F, *CalleeFunction,
                          SILInliner::InlineKind::MandatoryInline,
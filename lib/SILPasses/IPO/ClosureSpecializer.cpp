@@ -67,6 +67,7 @@
 #include "swift/SILAnalysis/ValueTracking.h"
 #include "swift/SILPasses/Transforms.h"
 #include "swift/SILPasses/Utils/SILInliner.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/CommandLine.h"
@@ -416,8 +417,10 @@ void CallSiteDescriptor::extendArgumentLifetime(SILValue Arg) const {
   }
 }
 
-static void specializeClosure(ClosureInfo &CInfo,
-                              CallSiteDescriptor &CallDesc) {
+/// Specializes the callee of \p CallDesc for the closure and rewrites the call.
+/// Returns the specialized function if it was newly created.
+static SILFunction *specializeClosure(ClosureInfo &CInfo,
+                                      CallSiteDescriptor &CallDesc) {
   llvm::SmallString<64> NewFName;
   CallDesc.createName(NewFName);
   DEBUG(llvm::dbgs() << "    Perform optimizations with new name " << NewFName
@@ -429,11 +432,13 @@ static void specializeClosure(ClosureInfo &CInfo,
 
   // If not, create a specialized version of ApplyCallee calling the closure
   // directly.
+  SILFunction *CreatedF = nullptr;
   if (!NewF)
-    NewF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
+    NewF = CreatedF = ClosureSpecCloner::cloneFunction(CallDesc, NewFName);
 
   // Rewrite the call
   rewriteApplyInst(CallDesc, NewF);
+  return CreatedF;
 }
 
 static bool isSupportedClosure(const SILInstruction *Closure) {
@@ -673,6 +678,18 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// The specialized functions created so far which have not been visited
+  /// yet. They contain a copy of the closure and may pass it on to a function
+  /// which invokes it.
+  llvm::SmallVector<SILFunction *, 8> NewFunctions;
+
+  /// Caches whether a function invokes the closure passed as the argument at
+  /// the given index.
+  llvm::DenseMap<std::pair<SILFunction *, unsigned>, bool> InvokedArguments;
+
+  bool isInvokedClosureArgument(SILFunction *F, unsigned ArgIndex,
+                                unsigned Depth);
+
 public:
   ClosureSpecializer() = default;
 
@@ -681,6 +698,14 @@ public:
                        llvm::DenseSet<FullApplySite> &MultipleClosureAI);
   bool specialize(SILFunction *Caller);
 
+  /// Returns the next specialized function which was not visited yet, or null
+  /// if there is none.
+  SILFunction *popNewFunction() {
+    if (NewFunctions.empty())
+      return nullptr;
+    return NewFunctions.pop_back_val();
+  }
+
   ArrayRef<SILInstruction *> getPropagatedClosures() {
     if (IsPropagatedClosuresUniqued)
       return PropagatedClosures;
@@ -694,6 +719,86 @@ public:
 
 } // end anonymous namespace
 
+/// Returns true if the load \p LI is the callee of some apply.
+static bool isLoadedForInvocation(LoadInst *LI) {
+  for (auto *Use : LI->getUses()) {
+    auto AI = FullApplySite::isa(Use->getUser());
+    if (AI && AI.getCallee() == SILValue(LI))
+      return true;
+  }
+  return false;
+}
+
+/// Returns true if the argument \p ArgIndex of \p F is a closure which \p F
+/// invokes. Besides a direct apply of the argument this recognizes:
+///
+/// * storing the closure into a local alloc_stack which is then loaded and
+///   applied, and
+/// * forwarding the closure to a known, non-generic callee which invokes it,
+///   up to a small depth.
+bool ClosureSpecializer::isInvokedClosureArgument(SILFunction *F,
+                                                  unsigned ArgIndex,
+                                                  unsigned Depth) {
+  auto Key = std::make_pair(F, ArgIndex);
+  auto Cached = InvokedArguments.find(Key);
+  if (Cached != InvokedArguments.end())
+    return Cached->second;
+
+  // Assume the closure is not invoked while we look at the uses, which breaks
+  // the recursion for recursive callees.
+  InvokedArguments[Key] = false;
+
+  SILValue Arg = F->getArgument(ArgIndex);
+  bool Invoked = false;
+  for (auto *Use : Arg.getUses()) {
+    SILInstruction *User = Use->getUser();
+
+    if (auto AI = FullApplySite::isa(User)) {
+      if (AI.getCallee() == Arg) {
+        Invoked = true;
+        break;
+      }
+
+      // The closure is passed on. Check if the callee invokes it.
+      const unsigned MaxForwardingDepth = 2;
+      SILFunction *Callee = AI.getCalleeFunction();
+      if (Depth >= MaxForwardingDepth || AI.hasSubstitutions() || !Callee ||
+          Callee->isExternalDeclaration())
+        continue;
+      for (unsigned i = 0, e = AI.getNumArguments(); i != e; ++i) {
+        if (AI.getArgument(i) == Arg &&
+            isInvokedClosureArgument(Callee, i, Depth + 1)) {
+          Invoked = true;
+          break;
+        }
+      }
+      if (Invoked)
+        break;
+      continue;
+    }
+
+    // The closure is stored into a local variable and invoked from there.
+    if (auto *SI = dyn_cast<StoreInst>(User)) {
+      auto *ASI = dyn_cast<AllocStackInst>(SI->getDest().getDef());
+      if (!ASI || SI->getSrc() != Arg)
+        continue;
+      for (auto *AddrUse : ASI->getUses()) {
+        auto *LI = dyn_cast<LoadInst>(AddrUse->getUser());
+        if (LI && isLoadedForInvocation(LI)) {
+          Invoked = true;
+          break;
+        }
+      }
+      if (Invoked)
+        break;
+    }
+  }
+
+  // The map may have grown while checking the callees.
+  InvokedArguments[Key] = Invoked;
+  return Invoked;
+}
+
 void ClosureSpecializer::gatherCallSites(
     SILFunction *Caller,
     llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
@@ -761,14 +866,9 @@ void ClosureSpecializer::gatherCallSites(
         //
         // TODO: Maybe just call the function directly instead of moving the
         // partial apply?
-        SILValue Arg = ApplyCallee->getArgument(ClosureIndex.getValue());
-        if (std::none_of(Arg->use_begin(), Arg->use_end(),
-                         [&Arg](Operand *Op) -> bool {
-                           auto UserAI = FullApplySite::isa(Op->getUser());
-                           return UserAI && UserAI.getCallee() == Arg;
-                         })) {
+        if (!isInvokedClosureArgument(ApplyCallee, ClosureIndex.getValue(),
+                                      /*Depth*/ 0))
           continue;
-        }
 
         auto ParamInfo = AI.getSubstCalleeType()->getParameters();
         SILParameterInfo ClosureParamInfo = ParamInfo[ClosureIndex.getValue()];
@@ -822,7 +922,8 @@ bool ClosureSpecializer::specialize(SILFunction *Caller) {
       if (MultipleClosureAI.count(CSDesc.getApplyInst()))
         continue;
 
-      specializeClosure(*CInfo, CSDesc);
+      if (SILFunction *NewF = specializeClosure(*CInfo, CSDesc))
+        NewFunctions.push_back(NewF);
       PropagatedClosures.push_back(CSDesc.getClosure());
       Changed = true;
     }
@@ -861,6 +962,11 @@ public:
         continue;
 
       Changed |= C.specialize(F);
+
+      // The specializations now contain a copy of the closure. If they pass
+      // it on to a function which invokes it, specialize that call as well.
+      while (SILFunction *NewF = C.popNewFunction())
+        Changed |= C.specialize(NewF);
     }
 
     // Invalidate everything since we delete calls as well as add new
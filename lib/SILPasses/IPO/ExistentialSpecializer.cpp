@@ -0,0 +1,385 @@
+//===--- ExistentialSpecializer.cpp - Specialize existential arguments ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Specializes functions which take a protocol-typed argument for the concrete
+// type that a caller wraps into the existential right before the call:
+//
+//   %s = alloc_stack $P
+//   %a = init_existential_addr %s#1 : $*P, $Concrete
+//   store %v to %a : $*Concrete
+//   apply %f(%s#1) : $@convention(thin) (@in P) -> ()
+//
+// The specialized function takes the concrete value and wraps it into the
+// existential in its entry block. This makes the concrete type visible to the
+// open_existential instructions in the callee, so that SILCombine can
+// devirtualize the witness_method calls on the argument, and the inliner and
+// the generic specializer can take it from there.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "existential-specializer"
+#include "swift/SILPasses/Passes.h"
+#include "swift/Basic/Demangle.h"
+#include "swift/SIL/Mangle.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILPasses/Transforms.h"
+#include "swift/SILPasses/Utils/Local.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumExistentialArgsSpecialized,
+          "Number of call sites specialized for a concrete existential "
+          "argument");
+
+namespace {
+
+/// The concrete value which a call site passes in place of an existential
+/// argument.
+struct ConcreteArgument {
+  /// The index of the argument.
+  unsigned Index;
+  /// The init_existential_addr or init_existential_ref which creates the
+  /// existential.
+  SILInstruction *InitExistential;
+  /// The concrete value, or the address of it for opaque existentials.
+  SILValue Value;
+};
+
+/// Clone a function taking an existential argument into a function taking
+/// the concrete value instead.
+class ExistentialSpecializerCloner
+  : public SILClonerWithScopes<ExistentialSpecializerCloner> {
+  using SuperTy = SILClonerWithScopes<ExistentialSpecializerCloner>;
+  friend class SILVisitor<ExistentialSpecializerCloner>;
+  friend class SILCloner<ExistentialSpecializerCloner>;
+
+  SILFunction *OrigF;
+public:
+  ExistentialSpecializerCloner(SILFunction *OrigF, SILFunction *NewF)
+    : SuperTy(*NewF), OrigF(OrigF) {}
+
+  void cloneBlocks(const ConcreteArgument &Concrete);
+};
+
+} // end anonymous namespace
+
+/// Clone the original function, wrapping the concrete argument into the
+/// existential the original body expects.
+void ExistentialSpecializerCloner::cloneBlocks(
+    const ConcreteArgument &Concrete) {
+  SILFunction &CloneF = getBuilder().getFunction();
+  SILModule &M = CloneF.getModule();
+  SILLocation Loc = CloneF.getLocation();
+
+  SILBasicBlock *OrigEntryBB = &*OrigF->begin();
+  SILBasicBlock *ClonedEntryBB = new (M) SILBasicBlock(&CloneF);
+  BBMap.insert(std::make_pair(OrigEntryBB, ClonedEntryBB));
+  getBuilder().setInsertionPoint(ClonedEntryBB);
+
+  AllocStackInst *Container = nullptr;
+  CanSILFunctionType CloneFTy = CloneF.getLoweredFunctionType();
+  for (unsigned i = 0, e = OrigEntryBB->bbarg_size(); i != e; ++i) {
+    SILArgument *Arg = OrigEntryBB->getBBArg(i);
+    if (i != Concrete.Index) {
+      SILValue MappedValue = new (M)
+          SILArgument(ClonedEntryBB, remapType(Arg->getType()),
+                      Arg->getDecl());
+      ValueMap.insert(std::make_pair(Arg, MappedValue));
+      continue;
+    }
+
+    SILType ConcreteTy = CloneFTy->getParameters()[i].getSILType();
+    SILValue ConcreteArg = new (M)
+        SILArgument(ClonedEntryBB, ConcreteTy, Arg->getDecl());
+
+    SILValue Existential;
+    if (auto *IEA = dyn_cast<InitExistentialAddrInst>(
+          Concrete.InitExistential)) {
+      // Move the concrete value into a new existential container. It is
+      // deallocated on every exit of the function below.
+      Container = getBuilder().createAllocStack(Loc,
+                                                Arg->getType().getObjectType());
+      auto *Init = getBuilder().createInitExistentialAddr(
+          Loc, Container->getAddressResult(), IEA->getFormalConcreteType(),
+          IEA->getLoweredConcreteType(), IEA->getConformances());
+      getBuilder().createCopyAddr(Loc, ConcreteArg, SILValue(Init, 0),
+                                  IsTake, IsInitialization);
+      Existential = Container->getAddressResult();
+    } else {
+      auto *IER = cast<InitExistentialRefInst>(Concrete.InitExistential);
+      Existential = getBuilder().createInitExistentialRef(
+          Loc, Arg->getType(), IER->getFormalConcreteType(), ConcreteArg,
+          IER->getConformances());
+    }
+    ValueMap.insert(std::make_pair(Arg, Existential));
+  }
+
+  // Recursively visit original BBs in depth-first preorder, starting with the
+  // entry block, cloning all instructions other than terminators.
+  visitSILBasicBlock(OrigEntryBB);
+
+  // Now iterate over the BBs and fix up the terminators.
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    getBuilder().setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+
+  if (!Container)
+    return;
+  for (auto &BB : CloneF) {
+    TermInst *TI = BB.getTerminator();
+    if (!isa<ReturnInst>(TI) && !isa<ThrowInst>(TI))
+      continue;
+    getBuilder().setInsertionPoint(TI);
+    getBuilder().createDeallocStack(Loc, Container->getContainerResult());
+  }
+}
+
+/// Returns true if the callee opens its existential argument \p Arg, which
+/// is what the specialization helps with.
+static bool isOpened(SILArgument *Arg) {
+  for (Operand *Use : Arg->getUses())
+    if (isa<OpenExistentialAddrInst>(Use->getUser()) ||
+        isa<OpenExistentialRefInst>(Use->getUser()))
+      return true;
+  return false;
+}
+
+/// Returns true if the specialized callee can refer to \p Ty.
+static bool isSpecializableType(CanType Ty) {
+  return !Ty->hasArchetype() && !Ty->hasOpenedExistential();
+}
+
+/// Finds the concrete value of the opaque existential argument \p Arg, which
+/// has to be an alloc_stack that is only initialized by one
+/// init_existential_addr right before \p AI and not used after it.
+static bool getConcreteAddress(ApplyInst *AI, SILValue Arg,
+                               ConcreteArgument &Concrete) {
+  auto *ASI = dyn_cast<AllocStackInst>(Arg.getDef());
+  if (!ASI || Arg != ASI->getAddressResult())
+    return false;
+
+  InitExistentialAddrInst *IEA = nullptr;
+  bool PassedOnce = false;
+  for (Operand *Use : ASI->getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (isa<DeallocStackInst>(User))
+      continue;
+    if (User == AI && !PassedOnce) {
+      PassedOnce = true;
+      continue;
+    }
+    auto *Init = dyn_cast<InitExistentialAddrInst>(User);
+    if (!Init || IEA)
+      return false;
+    IEA = Init;
+  }
+  if (!IEA || !PassedOnce || IEA->getParent() != AI->getParent() ||
+      !isSpecializableType(IEA->getFormalConcreteType()))
+    return false;
+
+  // The concrete value must be initialized between the init_existential_addr
+  // and the call.
+  llvm::SmallPtrSet<SILInstruction *, 8> InitInsts;
+  for (auto II = std::next(SILBasicBlock::iterator(IEA)); &*II != AI; ++II) {
+    if (II == AI->getParent()->end())
+      return false;
+    InitInsts.insert(&*II);
+  }
+  for (Operand *Use : IEA->getUses())
+    if (!InitInsts.count(Use->getUser()))
+      return false;
+
+  Concrete.InitExistential = IEA;
+  Concrete.Value = SILValue(IEA, 0);
+  return true;
+}
+
+/// Finds the concrete class instance of the class existential argument
+/// \p Arg.
+static bool getConcreteReference(SILValue Arg, ConcreteArgument &Concrete) {
+  auto *IER = dyn_cast<InitExistentialRefInst>(Arg.getDef());
+  if (!IER || !isSpecializableType(IER->getFormalConcreteType()))
+    return false;
+  Concrete.InitExistential = IER;
+  Concrete.Value = IER->getOperand();
+  return true;
+}
+
+/// Finds the first existential argument of \p AI whose concrete type is
+/// known and which its callee opens.
+static bool getConcreteArgument(ApplyInst *AI, SILFunction *Callee,
+                                ConcreteArgument &Concrete) {
+  auto Params = Callee->getLoweredFunctionType()->getParameters();
+  SILBasicBlock *EntryBB = &*Callee->begin();
+  for (unsigned i = 0, e = Params.size(); i != e; ++i) {
+    SILType ParamTy = Params[i].getSILType();
+    if (!ParamTy.isExistentialType() || !isOpened(EntryBB->getBBArg(i)))
+      continue;
+    Concrete.Index = i;
+
+    SILValue Arg = AI->getArgument(i);
+    if (Params[i].getConvention() == ParameterConvention::Indirect_In) {
+      if (getConcreteAddress(AI, Arg, Concrete))
+        return true;
+    } else if (!Params[i].isIndirect() && ParamTy.isClassExistentialType()) {
+      if (getConcreteReference(Arg, Concrete))
+        return true;
+    }
+  }
+  return false;
+}
+
+/// Returns the specialization of \p OrigF for \p Concrete, creating it if
+/// necessary.
+static SILFunction *getSpecialization(SILFunction *OrigF,
+                                      const ConcreteArgument &Concrete) {
+  llvm::SmallString<64> Name;
+  {
+    llvm::raw_svector_ostream buffer(Name);
+    Mangle::Mangler M(buffer);
+    auto P = Mangle::SpecializationPass::ExistentialSpecializer;
+    Mangle::FunctionSignatureSpecializationMangler Mangler(P, M, OrigF);
+    Mangler.setArgumentExistentialToConcrete(Concrete.Index,
+                                             Concrete.InitExistential);
+    Mangler.mangle();
+  }
+
+  SILModule &M = OrigF->getModule();
+  if (auto *NewF = M.lookUpFunction(Name))
+    return NewF;
+
+  // Replace the existential parameter with the concrete type.
+  CanSILFunctionType OrigFTy = OrigF->getLoweredFunctionType();
+  SmallVector<SILParameterInfo, 4> Params(OrigFTy->getParameters().begin(),
+                                          OrigFTy->getParameters().end());
+  SILParameterInfo &Param = Params[Concrete.Index];
+  Param = SILParameterInfo(Concrete.Value.getType().getSwiftRValueType(),
+                           Param.getConvention());
+  CanSILFunctionType NewFTy =
+    SILFunctionType::get(OrigFTy->getGenericSignature(),
+                         OrigFTy->getExtInfo(),
+                         OrigFTy->getCalleeConvention(), Params,
+                         OrigFTy->getResult(),
+                         OrigFTy->getOptionalErrorResult(),
+                         M.getASTContext());
+
+  SILFunction *NewF = SILFunction::create(
+      M, SILLinkage::Shared, Name, NewFTy,
+      /*contextGenericParams*/ nullptr, OrigF->getLocation(), OrigF->isBare(),
+      OrigF->isTransparent(), OrigF->isFragile(), OrigF->isThunk(),
+      OrigF->getClassVisibility(), OrigF->getInlineStrategy(),
+      OrigF->getEffectsKind(), /*InsertBefore*/ OrigF,
+      OrigF->getDebugScope(), OrigF->getDeclContext());
+  NewF->setDeclCtx(OrigF->getDeclContext());
+  DEBUG(llvm::dbgs() << "  Specialize callee as ";
+        NewF->printName(llvm::dbgs()); llvm::dbgs() << " " << NewFTy << "\n");
+
+  ExistentialSpecializerCloner Cloner(OrigF, NewF);
+  Cloner.cloneBlocks(Concrete);
+  return NewF;
+}
+
+/// Returns true if \p F is a function whose existential arguments can be
+/// specialized.
+static bool canSpecialize(SILFunction *F) {
+  if (F->isExternalDeclaration() || !F->shouldOptimize() || F->isGlobalInit())
+    return false;
+
+  CanSILFunctionType FTy = F->getLoweredFunctionType();
+  if (FTy->isPolymorphic())
+    return false;
+  switch (FTy->getRepresentation()) {
+  case SILFunctionTypeRepresentation::Thin:
+  case SILFunctionTypeRepresentation::Method:
+    return true;
+  default:
+    return false;
+  }
+}
+
+namespace {
+
+/// Specialize functions taking existential arguments for the concrete types
+/// their callers pass.
+class ExistentialSpecializer : public SILModuleTransform {
+  void run() override {
+    bool Changed = false;
+    for (auto &F : *getModule()) {
+      if (!F.shouldOptimize())
+        continue;
+
+      // Collect the calls first; specializing adds functions to the module.
+      SmallVector<ApplyInst *, 8> Applies;
+      for (auto &BB : F)
+        for (auto &I : BB)
+          if (auto *AI = dyn_cast<ApplyInst>(&I))
+            if (!AI->hasSubstitutions())
+              if (auto *FRI = dyn_cast<FunctionRefInst>(AI->getCallee()))
+                if (FRI->getReferencedFunction() != &F &&
+                    canSpecialize(FRI->getReferencedFunction()))
+                  Applies.push_back(AI);
+
+      for (ApplyInst *AI : Applies)
+        Changed |= specializeApply(AI);
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+  }
+
+  /// Redirects \p AI to the specialization of its callee for a concrete
+  /// existential argument, if it has one.
+  bool specializeApply(ApplyInst *AI) {
+    auto *FRI = cast<FunctionRefInst>(AI->getCallee());
+    SILFunction *Callee = FRI->getReferencedFunction();
+
+    ConcreteArgument Concrete;
+    if (!getConcreteArgument(AI, Callee, Concrete))
+      return false;
+
+    DEBUG(llvm::dbgs() << "Specializing existential argument " <<
+          Concrete.Index << " of " << Callee->getName() << " in\n" << *AI);
+    SILFunction *NewF = getSpecialization(Callee, Concrete);
+
+    SmallVector<SILValue, 8> Args(AI->getArguments().begin(),
+                                  AI->getArguments().end());
+    Args[Concrete.Index] = Concrete.Value;
+
+    SILBuilderWithScope Builder(AI);
+    auto *NewFRI = Builder.createFunctionRef(AI->getLoc(), NewF);
+    auto *NewAI = Builder.createApply(AI->getLoc(), NewFRI, Args,
+                                      AI->isNonThrowingApply());
+    AI->replaceAllUsesWith(NewAI);
+    AI->eraseFromParent();
+
+    // A class existential is dead now, unless it has other uses.
+    if (isa<InitExistentialRefInst>(Concrete.InitExistential))
+      recursivelyDeleteTriviallyDeadInstructions(Concrete.InitExistential);
+    recursivelyDeleteTriviallyDeadInstructions(FRI);
+
+    ++NumExistentialArgsSpecialized;
+    return true;
+  }
+
+  StringRef getName() override { return "Existential Specializer"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createExistentialSpecializer() {
+  return new ExistentialSpecializer();
+}
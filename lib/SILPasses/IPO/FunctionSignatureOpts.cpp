@@ -43,6 +43,10 @@ STATISTIC(NumDeadArgsEliminated, "Total dead args eliminated");
 STATISTIC(NumOwnedConvertedToGuaranteed, "Total owned args -> guaranteed args");
 STATISTIC(NumCallSitesOptimized, "Total call sites optimized");
 STATISTIC(NumSROAArguments, "Total SROA argumments optimized");
+STATISTIC(NumOwnedResultsConvertedToUnowned,
+          "Total owned results -> unowned results");
+STATISTIC(NumCalleeRefCountOpsRemoved,
+          "Total callee retains/releases moved to call sites");
 
 //===----------------------------------------------------------------------===//
 //                                  Utility
@@ -114,6 +118,10 @@ getNonTrivialNonDebugReleaseUse(SILArgument *Arg) {
 //                             Argument Analysis
 //===----------------------------------------------------------------------===//
 
+/// The maximum number of values an argument is exploded into, if the callee
+/// uses only some of its fields.
+static const size_t MaxPartialExplosionSize = 8;
+
 namespace {
 
 /// A structure that maintains all of the information about a specific
@@ -144,6 +152,11 @@ struct ArgumentDescriptor {
   /// function which has a throw block.
   SILInstruction *CalleeReleaseInThrowBlock;
 
+  /// If the return block does not release the parameter itself but each of
+  /// its predecessors does, CalleeRelease is the release in the first
+  /// predecessor and these are the releases in the remaining predecessors.
+  llvm::SmallVector<SILInstruction *, 2> CalleeReleasesInPreds;
+
   /// The projection tree of this arguments.
   ProjectionTree ProjTree;
 
@@ -159,7 +172,8 @@ struct ArgumentDescriptor {
   ArgumentDescriptor(llvm::BumpPtrAllocator &BPA, SILArgument *A)
     : Arg(A), Index(A->getIndex()), ParameterInfo(A->getParameterInfo()),
       Decl(A->getDecl()), IsDead(false), CalleeRelease(),
-      CalleeReleaseInThrowBlock(), ProjTree(A->getModule(), BPA, A->getType()) {
+      CalleeReleaseInThrowBlock(), CalleeReleasesInPreds(),
+      ProjTree(A->getModule(), BPA, A->getType()) {
     ProjTree.computeUsesAndLiveness(A);
   }
 
@@ -214,7 +228,18 @@ struct ArgumentDescriptor {
       return false;
 
     size_t explosionSize = ProjTree.liveLeafCount();
-    return explosionSize >= 1 && explosionSize <= 3;
+    if (explosionSize < 1)
+      return false;
+
+    // Passing a few values is always fine.
+    if (explosionSize <= 3)
+      return true;
+
+    // Otherwise only explode the argument if the callee does not use all of
+    // its fields. Passing just the used ones then needs fewer values than
+    // passing the whole aggregate.
+    return explosionSize <= MaxPartialExplosionSize &&
+           ProjTree.liveScalarCount() < ProjTree.scalarCount();
   }
 };
 
@@ -445,6 +470,11 @@ class FunctionAnalyzer {
   /// an argument that we will use during our optimization.
   llvm::SmallVector<ArgumentDescriptor, 8> ArgDescList;
 
+  /// If non-null, this is the retain of the @owned result in the return block
+  /// of the function. The result is kept alive by a guaranteed argument, so we
+  /// can return it @unowned and let the caller retain it instead.
+  SILInstruction *ResultRetain;
+
 public:
   ArrayRef<ArgumentDescriptor> getArgList() const { return ArgDescList; }
   FunctionAnalyzer() = delete;
@@ -456,7 +486,8 @@ public:
                    SILFunction *F)
     : Allocator(Allocator), RCIA(RCIA), F(F),
       MayBindDynamicSelf(computeMayBindDynamicSelf(F)),
-      ShouldOptimize(false), HaveModifiedSelfArgument(false), ArgDescList() {}
+      ShouldOptimize(false), HaveModifiedSelfArgument(false), ArgDescList(),
+      ResultRetain(nullptr) {}
 
   /// Analyze the given function.
   bool analyze();
@@ -474,6 +505,10 @@ public:
   ArrayRef<ArgumentDescriptor> getArgDescList() const { return ArgDescList; }
   MutableArrayRef<ArgumentDescriptor> getArgDescList() { return ArgDescList; }
 
+  /// Returns the retain of the result that is moved to the callers if we
+  /// convert the @owned result to @unowned, and null otherwise.
+  SILInstruction *getResultRetain() const { return ResultRetain; }
+
   /// Is the given argument required by the ABI?
   ///
   /// Metadata arguments may be required if dynamic Self is bound to any generic
@@ -487,6 +522,10 @@ public:
 private:
   /// Compute the CanSILFunctionType for the optimized function.
   CanSILFunctionType createOptimizedSILFunctionType();
+
+  /// Find a retain of the @owned result in the return block that we can move
+  /// into the callers.
+  SILInstruction *findResultRetain();
 };
 
 } // end anonymous namespace
@@ -510,6 +549,23 @@ FunctionAnalyzer::analyze() {
   if (ThrowBBIter != F->end())
     ArgToThrowReleaseMap.findMatchingReleases(RCIA, &*ThrowBBIter);
 
+  // If an argument is not released in the return block itself, it may still be
+  // released at the end of each path into the return block. We only look at
+  // predecessors that unconditionally branch to the return block so that each
+  // path to the return goes through exactly one of these releases.
+  llvm::SmallVector<ConsumedArgToEpilogueReleaseMatcher, 4> PredReleaseMaps;
+  auto ReturnBBIter = F->findReturnBB();
+  if (ReturnBBIter != F->end() && !ReturnBBIter->pred_empty() &&
+      std::all_of(ReturnBBIter->pred_begin(), ReturnBBIter->pred_end(),
+                  [](SILBasicBlock *Pred) {
+                    return isa<BranchInst>(Pred->getTerminator());
+                  })) {
+    for (SILBasicBlock *Pred : ReturnBBIter->getPreds()) {
+      PredReleaseMaps.emplace_back();
+      PredReleaseMaps.back().findMatchingReleases(RCIA, Pred);
+    }
+  }
+
   for (unsigned i = 0, e = Args.size(); i != e; ++i) {
     ArgumentDescriptor A(Allocator, Args[i]);
     bool HaveOptimizedArg = false;
@@ -528,7 +584,24 @@ FunctionAnalyzer::analyze() {
     // See if we can find a ref count equivalent strong_release or release_value
     // at the end of this function if our argument is an @owned parameter.
     if (A.hasConvention(ParameterConvention::Direct_Owned)) {
-      if (auto *Release = ArgToReturnReleaseMap.releaseForArgument(A.Arg)) {
+      llvm::SmallVector<SILInstruction *, 2> PredReleases;
+      auto *Release = ArgToReturnReleaseMap.releaseForArgument(A.Arg);
+      if (!Release && !PredReleaseMaps.empty()) {
+        for (auto &PredMap : PredReleaseMaps) {
+          auto *PredRelease = PredMap.releaseForArgument(A.Arg);
+          if (!PredRelease) {
+            PredReleases.clear();
+            break;
+          }
+          PredReleases.push_back(PredRelease);
+        }
+        if (!PredReleases.empty()) {
+          Release = PredReleases.front();
+          PredReleases.erase(PredReleases.begin());
+        }
+      }
+
+      if (Release) {
         SILInstruction *ReleaseInThrow = nullptr;
         
         // If the function has a throw block we must also find a matching
@@ -543,6 +616,8 @@ FunctionAnalyzer::analyze() {
           }
           A.CalleeRelease = Release;
           A.CalleeReleaseInThrowBlock = ReleaseInThrow;
+          A.CalleeReleasesInPreds.append(PredReleases.begin(),
+                                         PredReleases.end());
           HaveOptimizedArg = true;
           ++NumOwnedConvertedToGuaranteed;
         }
@@ -566,9 +641,62 @@ FunctionAnalyzer::analyze() {
     ArgDescList.push_back(std::move(A));
   }
 
+  // Now that we know which arguments become guaranteed, see if we can return
+  // the result at +0.
+  if ((ResultRetain = findResultRetain())) {
+    ShouldOptimize = true;
+    ++NumOwnedResultsConvertedToUnowned;
+  }
+
   return ShouldOptimize;
 }
 
+SILInstruction *FunctionAnalyzer::findResultRetain() {
+  CanSILFunctionType FTy = F->getLoweredFunctionType();
+  if (FTy->getResult().getConvention() != ResultConvention::Owned)
+    return nullptr;
+
+  auto ReturnBBIter = F->findReturnBB();
+  if (ReturnBBIter == F->end())
+    return nullptr;
+
+  // The result must be kept alive by an argument that the caller still holds
+  // when the call returns, i.e. a @guaranteed argument or an @owned argument
+  // that we are converting to @guaranteed.
+  auto *RI = cast<ReturnInst>(ReturnBBIter->getTerminator());
+  SILValue Root = RCIA->getRCIdentityRoot(RI->getOperand());
+  auto *Arg = dyn_cast<SILArgument>(Root);
+  if (!Arg || !Arg->isFunctionArg())
+    return nullptr;
+  const ArgumentDescriptor &AD = ArgDescList[Arg->getIndex()];
+  if (!AD.hasConvention(ParameterConvention::Direct_Guaranteed) &&
+      !AD.CalleeRelease)
+    return nullptr;
+
+  // Look for a retain of the result in the epilogue. We only skip over
+  // instructions that can not consume the extra reference count and the
+  // releases of arguments that we move into the callers.
+  auto IsMovedRelease = [&](SILInstruction *I) -> bool {
+    return std::any_of(ArgDescList.begin(), ArgDescList.end(),
+                       [&](const ArgumentDescriptor &A) {
+                         return A.CalleeRelease == I;
+                       });
+  };
+  for (auto II = std::next(ReturnBBIter->rbegin()), IE = ReturnBBIter->rend();
+       II != IE; ++II) {
+    if (isa<StrongRetainInst>(*II) || isa<RetainValueInst>(*II)) {
+      if (RCIA->getRCIdentityRoot(II->getOperand(0)) == Root)
+        return &*II;
+      return nullptr;
+    }
+    if (IsMovedRelease(&*II) || canNeverUseValues(&*II))
+      continue;
+    return nullptr;
+  }
+
+  return nullptr;
+}
+
 //===----------------------------------------------------------------------===//
 //                         Creating the New Function
 //===----------------------------------------------------------------------===//
@@ -587,7 +715,11 @@ FunctionAnalyzer::createOptimizedSILFunctionType() {
     ArgDesc.computeOptimizedInterfaceParams(InterfaceParams);
   }
 
+  // If the caller retains the result, it is returned at +0.
   SILResultInfo InterfaceResult = FTy->getResult();
+  if (ResultRetain)
+    InterfaceResult = SILResultInfo(InterfaceResult.getType(),
+                                    ResultConvention::Unowned);
   auto InterfaceErrorResult = FTy->getOptionalErrorResult();
   auto ExtInfo = FTy->getExtInfo();
 
@@ -660,6 +792,9 @@ llvm::SmallString<64> FunctionAnalyzer::getOptimizedName() {
       }
     }
 
+    if (ResultRetain)
+      FSSM.setReturnValueOwnedToUnowned();
+
     FSSM.mangle();
   }
 
@@ -704,6 +839,11 @@ rewriteApplyInstToCallNewFunction(FunctionAnalyzer &Analyzer,
                                            RealAI->isNonThrowing());
       // Replace all uses of the old apply with the new apply.
       AI->replaceAllUsesWith(NewAI);
+
+      // If the result is now returned at +0, retain it to keep the old
+      // convention for the users of the result.
+      if (Analyzer.getResultRetain())
+        Builder.createRetainValue(Loc, NewAI);
     } else {
       auto *TAI = cast<TryApplyInst>(AI);
       NewAI = Builder.createTryApply(Loc, FRI, LoweredType,
@@ -720,6 +860,9 @@ rewriteApplyInstToCallNewFunction(FunctionAnalyzer &Analyzer,
       }
       // Also insert release_value in the normal block (done below).
       Builder.setInsertionPoint(TAI->getNormalBB(), TAI->getNormalBB()->begin());
+
+      if (Analyzer.getResultRetain())
+        Builder.createRetainValue(Loc, TAI->getNormalBB()->getBBArg(0));
     }
 
     // If we have any arguments that were consumed but are now guaranteed,
@@ -791,6 +934,11 @@ static void createThunkBody(SILBasicBlock *BB, SILFunction *NewF,
                                                ThunkArgs, false);
   }
 
+  // The thunk has to return the result at +1. Retain it before we release any
+  // arguments, since they keep the result alive.
+  if (Analyzer.getResultRetain())
+    Builder.createRetainValue(Loc, ReturnValue);
+
   // If we have any arguments that were consumed but are now guaranteed,
   // insert a release_value.
   for (auto &ArgDesc : ArgDescs) {
@@ -910,12 +1058,24 @@ optimizeFunctionSignature(llvm::BumpPtrAllocator &BPA,
   for (auto &A : Analyzer.getArgDescList()) {
     if (A.CalleeRelease) {
       A.CalleeRelease->eraseFromParent();
+      ++NumCalleeRefCountOpsRemoved;
       if (A.CalleeReleaseInThrowBlock) {
         A.CalleeReleaseInThrowBlock->eraseFromParent();
+        ++NumCalleeRefCountOpsRemoved;
+      }
+      for (auto *Release : A.CalleeReleasesInPreds) {
+        Release->eraseFromParent();
+        ++NumCalleeRefCountOpsRemoved;
       }
     }
   }
 
+  // The same for the retain of the result if we return it at +0 now.
+  if (auto *Retain = Analyzer.getResultRetain()) {
+    Retain->eraseFromParent();
+    ++NumCalleeRefCountOpsRemoved;
+  }
+
   // Rewrite all apply insts calling F to call NewF. Update each call site as
   // appropriate given the form of function signature optimization performed.
   rewriteApplyInstToCallNewFunction(Analyzer, NewF, CallSites);
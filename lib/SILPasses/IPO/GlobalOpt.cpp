@@ -104,6 +104,9 @@ protected:
                                 SILFunction *InitF,
                                 SILGlobalVariable *SILG,
                                 GlobalInitCalls &Calls);
+  // Replace loads from a global let of another module by the value which that
+  // module published.
+  void optimizeExternalLetAccess(SILFunction *AddrF, GlobalInitCalls &Calls);
 };
 
 /// Helper class to copy only a set of SIL instructions providing in the
@@ -455,6 +458,9 @@ void SILGlobalOpt::placeInitializers(SILFunction *InitF,
 }
 
 /// Create a getter function from the intializer function.
+///
+/// The getter of a public global is public and fragile, so that it is
+/// serialized and modules importing the global can use its value, too.
 static SILFunction *genGetterFromInit(SILFunction *InitF, VarDecl *varDecl) {
   // Generate a getter from the global init function without side-effects.
   llvm::SmallString<20> getterBuffer;
@@ -466,6 +472,10 @@ static SILFunction *genGetterFromInit(SILFunction *InitF, VarDecl *varDecl) {
   if (auto *F = InitF->getModule().lookUpFunction(getterStream.str()))
     return F;
 
+  SILLinkage getterLinkage = SILLinkage::PrivateExternal;
+  if (varDecl->getEffectiveAccess() == Accessibility::Public)
+    getterLinkage = SILLinkage::Public;
+
   auto refType = varDecl->getType().getCanonicalTypeOrNull();
   // Function takes no arguments and returns refType
   SILResultInfo ResultInfo(refType, ResultConvention::Owned);
@@ -475,7 +485,7 @@ static SILFunction *genGetterFromInit(SILFunction *InitF, VarDecl *varDecl) {
       ParameterConvention::Direct_Owned, { }, ResultInfo, None,
       InitF->getASTContext());
   auto *GetterF = InitF->getModule().getOrCreateFunction(InitF->getLocation(),
-      getterStream.str(), SILLinkage::PrivateExternal, LoweredType,
+      getterStream.str(), getterLinkage, LoweredType,
       IsBare_t::IsBare, IsTransparent_t::IsNotTransparent,
       IsFragile_t::IsFragile);
 
@@ -583,6 +593,52 @@ static SILInstruction *convertLoadSequence(SILInstruction *I,
   return nullptr;
 }
 
+/// Replace the calls \p Calls of an addressor, whose results are only used to
+/// load from the global, by calls of the getter \p GetterF. The replaced
+/// calls are removed from \p Calls.
+///
+/// Returns true if any call was replaced.
+static bool replaceAddressorCallsByGetter(SILFunction *GetterF,
+                                          SmallVectorImpl<ApplyInst *> &Calls) {
+  SmallVector<ApplyInst *, 4> NotReplaced;
+  for (auto *Call : Calls) {
+    // Now find all uses of Call. They all should be loads, so that
+    // we can replace it.
+    bool isValid = true;
+    for (auto Use : Call->getUses()) {
+      if (!isa<PointerToAddressInst>(Use->getUser())) {
+        isValid = false;
+        break;
+      }
+    }
+
+    if (!isValid) {
+      NotReplaced.push_back(Call);
+      continue;
+    }
+
+    SILBuilderWithScope B(Call);
+    SmallVector<SILValue, 1> Args;
+    auto *GetterRef = B.createFunctionRef(Call->getLoc(), GetterF);
+    auto *NewAI = B.createApply(Call->getLoc(), GetterRef, Args, false);
+
+    for (auto Use : Call->getUses()) {
+      auto *PTAI = dyn_cast<PointerToAddressInst>(Use->getUser());
+      assert(PTAI && "All uses should be pointer_to_address");
+      for (auto PTAIUse : PTAI->getUses()) {
+        replaceLoadSequence(PTAIUse->getUser(), NewAI, B);
+      }
+    }
+
+    eraseUsesOfInstruction(Call);
+    recursivelyDeleteTriviallyDeadInstructions(Call, true);
+  }
+
+  bool Changed = NotReplaced.size() != Calls.size();
+  Calls.assign(NotReplaced.begin(), NotReplaced.end());
+  return Changed;
+}
+
 /// Replace loads from a global variable by the known value.
 void SILGlobalOpt::
 replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
@@ -596,8 +652,12 @@ replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
   eraseUsesOfInstruction(CallToOnce);
   recursivelyDeleteTriviallyDeadInstructions(CallToOnce, true);
 
-  // Make this addressor transparent.
+  // Make this addressor transparent. A public one now just returns the
+  // address of the statically initialized global, so it is serialized for
+  // other modules as well, like any public transparent function.
   AddrF->setTransparent(IsTransparent_t::IsTransparent);
+  if (AddrF->getLinkage() == SILLinkage::Public)
+    AddrF->setFragile(IsFragile_t::IsFragile);
 
   for (int i = 0, e = Calls.size(); i < e; ++i) {
     auto *Call = Calls[i];
@@ -614,47 +674,75 @@ replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
   auto *GetterF = genGetterFromInit(InitF, SILG->getDecl());
 
   // Replace all calls of an addressor by calls of a getter .
-  for (int i = 0, e = Calls.size(); i < e; ++i) {
-    auto *Call = Calls[i];
+  replaceAddressorCallsByGetter(GetterF, Calls);
 
-    // Now find all uses of Call. They all should be loads, so that
-    // we can replace it.
-    bool isValid = true;
-    for (auto Use : Call->getUses()) {
-      if (!isa<PointerToAddressInst>(Use->getUser())) {
-        isValid = false;
-        break;
-      }
-    }
+  Calls.clear();
+  SILG->setInitializer(InitF);
+}
 
-    if (!isValid)
+/// Returns the global let whose address the addressor \p AddrF from another
+/// module returns, if the addressor does nothing else. This is the case once
+/// the other module has statically initialized the global.
+static SILGlobalVariable *getLetOfExternalAddressor(SILFunction *AddrF) {
+  if (AddrF->isExternalDeclaration() || AddrF->size() != 1)
+    return nullptr;
+
+  SILGlobalVariable *SILG = nullptr;
+  for (auto &I : AddrF->front()) {
+    if (auto *GAI = dyn_cast<GlobalAddrInst>(&I)) {
+      if (SILG)
+        return nullptr;
+      SILG = GAI->getReferencedGlobal();
+      continue;
+    }
+    if (isa<AddressToPointerInst>(&I) || isa<ReturnInst>(&I) ||
+        isa<DebugValueInst>(&I))
       continue;
+    return nullptr;
+  }
+  if (!SILG || !SILG->isLet() || !SILG->getDecl())
+    return nullptr;
+  return SILG;
+}
 
-    SILBuilderWithScope B(Call);
-    SmallVector<SILValue, 1> Args;
-    auto *GetterRef = B.createFunctionRef(Call->getLoc(), GetterF);
-    auto *NewAI = B.createApply(Call->getLoc(), GetterRef, Args, false);
+void SILGlobalOpt::optimizeExternalLetAccess(SILFunction *AddrF,
+                                             GlobalInitCalls &Calls) {
+  auto *SILG = getLetOfExternalAddressor(AddrF);
+  if (!SILG)
+    return;
 
-    for (auto Use : Call->getUses()) {
-      auto *PTAI = dyn_cast<PointerToAddressInst>(Use->getUser());
-      assert(PTAI && "All uses should be pointer_to_address");
-      for (auto PTAIUse : PTAI->getUses()) {
-        replaceLoadSequence(PTAIUse->getUser(), NewAI, B);
-      }
-    }
+  // The other module published a getter for the value of the global if it
+  // could initialize it statically.
+  llvm::SmallString<20> getterBuffer;
+  llvm::raw_svector_ostream getterStream(getterBuffer);
+  Mangle::Mangler getterMangler(getterStream);
+  getterMangler.mangleGlobalGetterEntity(SILG->getDecl());
 
-    eraseUsesOfInstruction(Call);
-    recursivelyDeleteTriviallyDeadInstructions(Call, true);
-  }
+  if (!Module->lookUpFunction(getterStream.str()))
+    Module->linkFunction(getterStream.str(),
+                         SILModule::LinkingMode::LinkAll);
+  auto *GetterF = Module->lookUpFunction(getterStream.str());
+  if (!GetterF || GetterF->isExternalDeclaration())
+    return;
 
-  Calls.clear();
-  SILG->setInitializer(InitF);
+  DEBUG(llvm::dbgs() << "GlobalOpt: use published value of " <<
+        SILG->getName() << '\n');
+
+  if (replaceAddressorCallsByGetter(GetterF, Calls))
+    HasChanged = true;
 }
 
 /// We analyze the body of globalinit_func to see if it can be statically
 /// initialized. If yes, we set the initial value of the SILGlobalVariable and
 /// remove the "once" call to globalinit_func from the addressor.
 void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF, GlobalInitCalls &Calls) {
+  // Addressors deserialized from other modules have no initializer to
+  // analyze, but their global may have a known value.
+  if (isAvailableExternally(AddrF->getLinkage())) {
+    optimizeExternalLetAccess(AddrF, Calls);
+    return;
+  }
+
   if (UnhandledOnceCallee)
     return;
 
@@ -862,6 +950,12 @@ bool SILGlobalOpt::run() {
     if (!F.shouldOptimize())
       continue;
 
+    // Public addressors are optimized even if nothing in this module calls
+    // them, so that the values of their globals are published to importers.
+    if (F.isGlobalInit() && F.isDefinition() &&
+        F.getLinkage() == SILLinkage::Public)
+      GlobalInitCallMap[&F];
+
     // Cache cold blocks per function.
     ColdBlockInfo ColdBlocks(DA);
     for (auto &BB : F) {
@@ -0,0 +1,98 @@
+//===------ InferEffects.cpp - Infer @effects attributes of functions -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Sets the effects kind of public functions from the result of the
+// side-effect analysis. The effects kind is serialized with the function, so
+// that clients of the module can optimize calls to these functions, even if
+// the function body is not available to them.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "infer-effects"
+#include "swift/SILPasses/Passes.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILAnalysis/SideEffectAnalysis.h"
+#include "swift/SILPasses/Transforms.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumInferredReadNone, "Number of functions inferred as readnone");
+STATISTIC(NumInferredReadOnly, "Number of functions inferred as readonly");
+
+/// Returns the effects kind which matches the side-effects \p Effects of
+/// function \p F, or EffectsKind::Unspecified if there is none.
+static EffectsKind
+getInferredEffectsKind(SILFunction &F,
+                       const SideEffectAnalysis::FunctionEffects &Effects) {
+  // Calls to readnone and readonly functions may be removed, so the function
+  // must not have any effect which is observable by the caller.
+  if (Effects.mayTrap() || Effects.mayAllocObjects() || Effects.mayReadRC())
+    return EffectsKind::Unspecified;
+
+  switch (Effects.getMemBehavior(RetainObserveKind::ObserveRetains)) {
+    case SILInstruction::MemoryBehavior::None:
+      return EffectsKind::ReadNone;
+    case SILInstruction::MemoryBehavior::MayRead:
+      // Releasing an owned parameter may call a deinit, which itself can do
+      // anything.
+      if (!F.hasOwnedParameters())
+        return EffectsKind::ReadOnly;
+      return EffectsKind::Unspecified;
+    default:
+      return EffectsKind::Unspecified;
+  }
+}
+
+namespace {
+
+class InferEffects : public SILModuleTransform {
+  void run() override {
+    auto *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    SEA->recompute();
+
+    for (auto &F : *getModule()) {
+      // Only public functions can be called from other modules. Internal
+      // callers already get the same information from the analysis.
+      if (F.getLinkage() != SILLinkage::Public || !F.isDefinition())
+        continue;
+
+      // Don't override an explicit @effects attribute.
+      if (F.getEffectsKind() != EffectsKind::Unspecified)
+        continue;
+
+      EffectsKind Kind = getInferredEffectsKind(F, SEA->getEffects(&F));
+      if (Kind == EffectsKind::Unspecified)
+        continue;
+
+      DEBUG(llvm::dbgs() << "  infer "
+                         << (Kind == EffectsKind::ReadNone ? "readnone"
+                                                           : "readonly")
+                         << " for " << F.getName() << '\n');
+      if (Kind == EffectsKind::ReadNone)
+        ++NumInferredReadNone;
+      else
+        ++NumInferredReadOnly;
+      F.setEffectsKind(Kind);
+    }
+  }
+
+  StringRef getName() override { return "Infer Effects"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createInferEffects() {
+  return new InferEffects();
+}
@@ -17,6 +17,7 @@
 #include "swift/SIL/Projection.h"
 #include "swift/SILAnalysis/BasicCalleeAnalysis.h"
 #include "swift/SILAnalysis/CallGraphAnalysis.h"
+#include "swift/SILAnalysis/ClassHierarchyAnalysis.h"
 #include "swift/SILAnalysis/ColdBlockInfo.h"
 #include "swift/SILAnalysis/DominanceAnalysis.h"
 #include "swift/SILAnalysis/FunctionOrder.h"
@@ -52,6 +53,12 @@ namespace {
 
   llvm::cl::opt<int> TestOpt("sil-inline-test",
                                    llvm::cl::init(0), llvm::cl::Hidden);
+
+  // Callers which were entered at least this often in a profiled run get a
+  // larger inlining budget.
+  llvm::cl::opt<unsigned> HotEntryCount("sil-inline-hot-entry-count",
+                                        llvm::cl::init(1000),
+                                        llvm::cl::Hidden);
   
   // The following constants define the cost model for inlining.
   
@@ -75,6 +82,10 @@ namespace {
   // increasing the code size.
   const unsigned TrivialFunctionThreshold = 20;
 
+  // The benefit is multiplied by this factor for call sites in functions
+  // which are hot according to the profile data.
+  const unsigned HotCallerBenefitFactor = 4;
+
   // Represents a value in integer constant evaluation.
   struct IntConst {
     IntConst() : isValid(false), isFromCaller(false) { }
@@ -222,6 +233,9 @@ namespace {
     /// Specifies which functions not to inline, based on @_semantics and
     /// global_init attributes.
     InlineSelection WhatToInline;
+    /// The class hierarchy, used to devirtualize calls of methods which are
+    /// never overridden.
+    ClassHierarchyAnalysis *CHA;
 
 
     /// A set of pairs of function names. This set records a successful
@@ -269,9 +283,10 @@ namespace {
 
   public:
     SILPerformanceInliner(int threshold,
-                          InlineSelection WhatToInline)
+                          InlineSelection WhatToInline,
+                          ClassHierarchyAnalysis *CHA)
       : InlineCostThreshold(threshold),
-    WhatToInline(WhatToInline) {}
+    WhatToInline(WhatToInline), CHA(CHA) {}
 
     void inlineDevirtualizeAndSpecialize(SILFunction *WorkItem,
                                          SILModuleTransform *MT,
@@ -776,6 +791,17 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
     // Only inline trivial functions into thunks (which will not increase the
     // code size).
     Threshold = TrivialFunctionThreshold;
+  } else if (auto CallerCount = AI.getFunction()->getEntryCount()) {
+    // Use the profile data: a call site in a function which was never entered
+    // is not worth any code size. One in a hot function is worth more.
+    auto CalleeCount = Callee->getEntryCount();
+    if (*CallerCount == 0 || (CalleeCount && *CalleeCount == 0)) {
+      DEBUG(llvm::dbgs() << "        Cold according to profile\n");
+      Threshold = 0;
+    } else if (*CallerCount >= HotEntryCount) {
+      DEBUG(llvm::dbgs() << "        Hot according to profile\n");
+      Threshold *= HotCallerBenefitFactor;
+    }
   }
 
   if (CalleeCost > Threshold) {
@@ -822,7 +848,7 @@ static bool isProfitableInColdBlock(SILFunction *Callee) {
 FullApplySite SILPerformanceInliner::devirtualizeUpdatingCallGraph(
                                                             FullApplySite Apply,
                                                                 CallGraph &CG) {
-  auto NewInstPair = tryDevirtualizeApply(Apply);
+  auto NewInstPair = tryDevirtualizeApply(Apply, CHA);
   if (!NewInstPair.second)
     return FullApplySite();
 
@@ -1300,6 +1326,7 @@ public:
     CallGraphAnalysis *CGA = PM->getAnalysis<CallGraphAnalysis>();
     DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
     SILLoopAnalysis *LA = PM->getAnalysis<SILLoopAnalysis>();
+    ClassHierarchyAnalysis *CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
 
     if (getOptions().InlineThreshold == 0) {
       DEBUG(llvm::dbgs() << "*** The Performance Inliner is disabled ***\n");
@@ -1307,7 +1334,7 @@ public:
     }
 
     SILPerformanceInliner Inliner(getOptions().InlineThreshold,
-                                  WhatToInline);
+                                  WhatToInline, CHA);
 
     BottomUpFunctionOrder BottomUpOrder(*getModule(), BCA);
     auto BottomUpFunctions = BottomUpOrder.getFunctions();
@@ -0,0 +1,292 @@
+//===--- ProfilePrespecialization.cpp - Prespecialize hot generic types ---===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Reads a generic metadata profile written by the runtime (see
+// SWIFT_RUNTIME_GENERIC_METADATA_PROFILE) and specializes the public methods
+// of this module's generic types for the type arguments which were requested
+// most often at runtime. The specializations are published like the ones of
+// -share-specializations, so that clients which can't specialize the methods
+// themselves can call them instead of the unspecialized code.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "profile-prespecialize"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/DiagnosticsSIL.h"
+#include "swift/SILPasses/Passes.h"
+#include "swift/SILPasses/Transforms.h"
+#include "swift/SILPasses/Utils/GenericCloner.h"
+#include "swift/SILPasses/Utils/Local.h"
+#include "swift/SIL/Mangle.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace swift;
+
+STATISTIC(NumPrespecialized, "Number of functions prespecialized from the "
+                             "generic metadata profile");
+
+llvm::cl::opt<unsigned> PrespecializeMinRequests(
+    "sil-prespecialize-min-requests", llvm::cl::init(100),
+    llvm::cl::desc("Minimum number of metadata requests in the generic "
+                   "metadata profile for a type to be prespecialized"));
+
+namespace {
+
+/// Parses type names as printed by the runtime for the generic metadata
+/// profile, e.g. "Swift.Dictionary<Swift.String, Swift.Int>".
+///
+/// Only nominal types are understood. Everything which the parser doesn't
+/// understand, or which names a type that isn't visible to this module,
+/// makes it fail.
+class TypeNameParser {
+  ASTContext &Ctx;
+  StringRef Text;
+
+  bool consume(StringRef Prefix) {
+    if (!Text.startswith(Prefix))
+      return false;
+    Text = Text.drop_front(Prefix.size());
+    return true;
+  }
+
+  Identifier parseIdentifier() {
+    size_t Length = Text.find_first_of(".<>, ()");
+    StringRef Name = Text.substr(0, Length);
+    Text = Text.drop_front(Name.size());
+    return Name.empty() ? Identifier() : Ctx.getIdentifier(Name);
+  }
+
+  static NominalTypeDecl *findNominal(ArrayRef<ValueDecl *> Decls) {
+    for (auto *D : Decls)
+      if (auto *Nominal = dyn_cast<NominalTypeDecl>(D))
+        return Nominal;
+    return nullptr;
+  }
+
+public:
+  TypeNameParser(ASTContext &Ctx, StringRef Text) : Ctx(Ctx), Text(Text) {}
+
+  /// Returns true if the whole text has been parsed.
+  bool atEnd() const { return Text.empty(); }
+
+  /// Parses a type name, or returns a null type on failure.
+  Type parseType() {
+    Identifier ModuleName = parseIdentifier();
+    if (ModuleName.empty())
+      return Type();
+    Module *M = Ctx.getLoadedModule(ModuleName);
+    if (!M)
+      return Type();
+
+    // Resolve the top-level type and any nested types.
+    NominalTypeDecl *Nominal = nullptr;
+    Type Parent;
+    while (consume(".")) {
+      Identifier Name = parseIdentifier();
+      if (Name.empty())
+        return Type();
+      if (Nominal) {
+        if (Nominal->getGenericParams())
+          return Type();
+        Parent = Nominal->getDeclaredType();
+        Nominal = findNominal(Nominal->lookupDirect(Name));
+      } else {
+        SmallVector<ValueDecl *, 4> Results;
+        M->lookupValue({}, Name, NLKind::QualifiedLookup, Results);
+        Nominal = findNominal(Results);
+      }
+      if (!Nominal)
+        return Type();
+    }
+    if (!Nominal)
+      return Type();
+
+    if (!consume("<"))
+      return Nominal->getGenericParams() ? Type() : Nominal->getDeclaredType();
+
+    SmallVector<Type, 4> Args;
+    do {
+      Type Arg = parseType();
+      if (!Arg)
+        return Type();
+      Args.push_back(Arg);
+    } while (consume(", "));
+    if (!consume(">"))
+      return Type();
+
+    auto *Params = Nominal->getGenericParams();
+    if (!Params || Params->size() != Args.size())
+      return Type();
+    return BoundGenericType::get(Nominal, Parent, Args);
+  }
+};
+
+/// Specializes the public methods of hot generic types of this module.
+class ProfilePrespecialization : public SILModuleTransform {
+  /// The hot instantiations of each of this module's generic types, in the
+  /// order of the profile.
+  llvm::MapVector<NominalTypeDecl *, SmallVector<BoundGenericType *, 4>>
+    HotTypes;
+
+  void run() override {
+    SILModule &M = *getModule();
+    StringRef Path = M.getOptions().PrespecializeProfilePath;
+    if (Path.empty())
+      return;
+
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (!Buffer) {
+      M.getASTContext().Diags.diagnose(SourceLoc(), diag::cannot_open_profile,
+                                       Path, Buffer.getError().message());
+      return;
+    }
+    readProfile((*Buffer)->getBuffer());
+    if (HotTypes.empty())
+      return;
+
+    // Specializing adds functions to the module, so collect the functions to
+    // specialize first.
+    SmallVector<SILFunction *, 16> Candidates;
+    for (auto &F : M)
+      if (getHotTypesForFunction(F))
+        Candidates.push_back(&F);
+
+    bool Changed = false;
+    for (SILFunction *F : Candidates)
+      for (BoundGenericType *BGT : *getHotTypesForFunction(*F))
+        Changed |= prespecialize(F, BGT);
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Everything);
+  }
+
+  /// Collects the hot instantiations of this module's generic types. Each
+  /// line of the profile has a request count and a type name, separated by
+  /// a tab.
+  void readProfile(StringRef Profile) {
+    SILModule &M = *getModule();
+    while (!Profile.empty()) {
+      StringRef Line;
+      std::tie(Line, Profile) = Profile.split('\n');
+
+      StringRef CountStr, Name;
+      std::tie(CountStr, Name) = Line.split('\t');
+      unsigned long long Count;
+      if (CountStr.getAsInteger(10, Count) || Count < PrespecializeMinRequests)
+        continue;
+
+      TypeNameParser Parser(M.getASTContext(), Name);
+      Type Ty = Parser.parseType();
+      if (!Ty || !Parser.atEnd())
+        continue;
+      auto *BGT = Ty->getAs<BoundGenericType>();
+      if (!BGT || BGT->getDecl()->getParentModule() != M.getSwiftModule())
+        continue;
+
+      DEBUG(llvm::dbgs() << "Hot generic type: " << Name << "\n");
+      HotTypes[BGT->getDecl()].push_back(BGT);
+    }
+  }
+
+  /// Returns the hot instantiations of the type of which \p F is a public
+  /// method, or null if \p F should not be prespecialized.
+  ///
+  /// Only methods without generic parameters of their own are specialized,
+  /// because the profile only has the arguments of the enclosing type.
+  SmallVectorImpl<BoundGenericType *> *
+  getHotTypesForFunction(SILFunction &F) {
+    if (!F.isDefinition() || F.getLinkage() != SILLinkage::Public ||
+        !F.shouldOptimize() || F.isGlobalInit() ||
+        !F.getLoweredFunctionType()->getGenericSignature() ||
+        !F.getContextGenericParams() ||
+        F.getContextGenericParams()->getOuterParameters())
+      return nullptr;
+
+    auto *AFD = dyn_cast_or_null<AbstractFunctionDecl>(F.getDeclContext());
+    if (!AFD || AFD->getGenericParams())
+      return nullptr;
+    auto *Nominal =
+      AFD->getDeclContext()->isNominalTypeOrNominalTypeExtensionContext();
+    if (!Nominal)
+      return nullptr;
+
+    auto Found = HotTypes.find(Nominal);
+    if (Found == HotTypes.end())
+      return nullptr;
+    return &Found->second;
+  }
+
+  /// Creates and publishes the specialization of \p F for \p BGT. Returns
+  /// true if a new function was created.
+  bool prespecialize(SILFunction *F, BoundGenericType *BGT) {
+    SILModule &M = F->getModule();
+    auto *AFD = cast<AbstractFunctionDecl>(F->getDeclContext());
+    ArrayRef<Substitution> Subs =
+      BGT->getSubstitutions(M.getSwiftModule(), nullptr,
+                            AFD->getDeclContext());
+
+    // The arguments may only conform to the requirements of the type in the
+    // module which requested them.
+    if (Subs.size() != F->getContextGenericParams()->getAllArchetypes().size())
+      return false;
+    for (const Substitution &Sub : Subs)
+      for (ProtocolConformance *Conformance : Sub.getConformances())
+        if (!Conformance)
+          return false;
+
+    TypeSubstitutionMap InterfaceSubs =
+      F->getLoweredFunctionType()->getGenericSignature()
+        ->getSubstitutionMap(Subs);
+    TypeSubstitutionMap ContextSubs =
+      F->getContextGenericParams()->getSubstitutionMap(Subs);
+    if (hasUnboundGenericTypes(InterfaceSubs) ||
+        hasDynamicSelfTypes(InterfaceSubs))
+      return false;
+
+    // Use the name that clients compute for the specialization of an apply
+    // with these substitutions.
+    llvm::SmallString<64> ClonedName;
+    {
+      llvm::raw_svector_ostream buffer(ClonedName);
+      Mangle::Mangler Mangler(buffer);
+      Mangle::GenericSpecializationMangler SpecMangler(Mangler, F, Subs);
+      SpecMangler.mangle();
+    }
+    if (M.lookUpFunction(ClonedName))
+      return false;
+
+    DEBUG(llvm::dbgs() << "Prespecializing " << F->getName() << " as "
+                       << ClonedName << "\n");
+    SILFunction *NewF = GenericCloner::cloneFunction(F, InterfaceSubs,
+                                                     ContextSubs, ClonedName,
+                                                     Subs);
+    // DeadFunctionElimination makes the specialization public.
+    NewF->setKeepAsPublic(true);
+    ++NumPrespecialized;
+    return true;
+  }
+
+  StringRef getName() override {
+    return "Prespecialize hot generic types from a profile";
+  }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createProfilePrespecialization() {
+  return new ProfilePrespecialization();
+}
@@ -22,6 +22,7 @@
 #include "swift/SILAnalysis/IVAnalysis.h"
 #include "swift/SILAnalysis/LoopAnalysis.h"
 #include "swift/SILAnalysis/RCIdentityAnalysis.h"
+#include "swift/SILAnalysis/ValueRange.h"
 #include "swift/SILPasses/Passes.h"
 #include "swift/SILPasses/Transforms.h"
 #include "swift/SILPasses/Utils/CFG.h"
@@ -409,10 +410,52 @@ static bool removeRedundantChecksInBlock(SILBasicBlock &BB, ArraySet &Arrays,
   return Changed;
 }
 
+/// A bounds check which dominates the checks in the current block.
+struct DominatingCheck {
+  ValueBase *Array;
+  bool IsCheckIndex;
+  /// The builtin integer value of the checked index.
+  SILValue Index;
+};
+
+/// Returns the builtin integer value of an array index of type Int.
+static SILValue getBuiltinIndex(SILValue ArrayIndex) {
+  auto *SI = dyn_cast<StructInst>(ArrayIndex);
+  if (!SI || SI->getNumOperands() != 1)
+    return SILValue();
+  SILValue Index = SI->getOperand(0);
+  if (!ValueRangeInfo::hasRange(Index))
+    return SILValue();
+  return Index;
+}
+
+/// Checks whether the check of \p Index at \p Inst is implied by one of the
+/// dominating checks of the same array and kind, because the index is not
+/// negative and not larger than the index of the dominating check.
+static bool isImpliedByRange(ValueBase *Array, bool IsCheckIndex,
+                             SILValue Index, SILInstruction *Inst,
+                             ArrayRef<DominatingCheck> DominatingChecks,
+                             ValueRangeInfo &Ranges) {
+  IntRange R = Ranges.getRange(Index, Inst);
+  if (!R.isNonNegative())
+    return false;
+  for (auto &Check : DominatingChecks) {
+    if (Check.Array != Array || Check.IsCheckIndex != IsCheckIndex ||
+        Check.Index.getType() != Index.getType())
+      continue;
+    if (R.getMax().sle(Ranges.getRange(Check.Index, Inst).getMin()))
+      return true;
+  }
+  return false;
+}
+
 /// Walk down the dominator tree inside the loop, removing redundant checks.
 static bool removeRedundantChecks(DominanceInfoNode *CurBB,
                                   ABCAnalysis &ABC,
                                   IndexedArraySet &DominatingSafeChecks,
+                                  SmallVectorImpl<DominatingCheck> &
+                                    DominatingChecks,
+                                  ValueRangeInfo &Ranges,
                                   SILLoop *Loop) {
   auto *BB = CurBB->getBlock();
   if (!Loop->contains(BB))
@@ -422,6 +465,7 @@ static bool removeRedundantChecks(DominanceInfoNode *CurBB,
   // When we come back from the dominator tree recursion we need to remove
   // checks that we have seen for the first time.
   SmallVector<std::pair<ValueBase *, ArrayAccessDesc>, 8> SafeChecksToPop;
+  unsigned NumDominatingChecks = DominatingChecks.size();
 
   // Process all instructions in the current block.
   for (auto Iter = BB->begin(); Iter != BB->end();) {
@@ -456,10 +500,22 @@ static bool removeRedundantChecks(DominanceInfoNode *CurBB,
 
     // Saw a check for the first time.
     if (!DominatingSafeChecks.count(IndexedArray)) {
+      bool IsCheckIndex = Kind == ArrayCallKind::kCheckIndex;
+      SILValue Index = getBuiltinIndex(ArrayIndex);
+      if (Index && isImpliedByRange(Array.getDef(), IsCheckIndex, Index, Inst,
+                                    DominatingChecks, Ranges)) {
+        DEBUG(llvm::dbgs() << " implied by range: " << *Inst);
+        ArrayCall.removeCall();
+        Changed = true;
+        continue;
+      }
+
       DEBUG(llvm::dbgs() << " first time: " << *Inst
                          << "  with array arg: " << *Array.getDef());
       DominatingSafeChecks.insert(IndexedArray);
       SafeChecksToPop.push_back(IndexedArray);
+      if (Index)
+        DominatingChecks.push_back({Array.getDef(), IsCheckIndex, Index});
       continue;
     }
 
@@ -470,14 +526,15 @@ static bool removeRedundantChecks(DominanceInfoNode *CurBB,
 
   // Traverse the children in the dominator tree inside the loop.
   for (auto Child: *CurBB)
-    Changed |=
-        removeRedundantChecks(Child, ABC, DominatingSafeChecks, Loop);
+    Changed |= removeRedundantChecks(Child, ABC, DominatingSafeChecks,
+                                     DominatingChecks, Ranges, Loop);
 
   // Remove checks we have seen for the first time.
   std::for_each(SafeChecksToPop.begin(), SafeChecksToPop.end(),
                 [&](std::pair<ValueBase *, ArrayAccessDesc> &V) {
     DominatingSafeChecks.erase(V);
   });
+  DominatingChecks.resize(NumDominatingChecks);
 
   return Changed;
 }
@@ -554,14 +611,15 @@ static bool isSignedLessEqual(SILValue Start, SILValue End, SILBasicBlock &BB) {
   return false;
 }
 
-static bool isLessThan(SILValue Start, SILValue End) {
-  auto S = dyn_cast<IntegerLiteralInst>(Start.getDef());
-  if (!S)
+/// Checks whether the ranges of \p Start and \p End at \p At ensure that
+/// "Start < End".
+static bool isLessThan(SILValue Start, SILValue End, SILInstruction *At,
+                       ValueRangeInfo &Ranges) {
+  if (!ValueRangeInfo::hasRange(Start) || !ValueRangeInfo::hasRange(End) ||
+      Start.getType() != End.getType())
     return false;
-  auto E = dyn_cast<IntegerLiteralInst>(End.getDef());
-  if (!E)
-    return false;
-  return S->getValue().slt(E->getValue());
+  return Ranges.getRange(Start, At).getMax().slt(
+      Ranges.getRange(End, At).getMin());
 }
 
 static BuiltinValueKind swapCmpID(BuiltinValueKind ID) {
@@ -662,9 +720,10 @@ static bool isLessThanCheck(SILValue Start, SILValue End,
 /// Checks whether there are checks in the preheader's predecessor that ensure
 /// that "Start < End".
 static bool isRangeChecked(SILValue Start, SILValue End,
-                           SILBasicBlock *Preheader, DominanceInfo *DT) {
-  // Check two constants.
-  if (isLessThan(Start, End))
+                           SILBasicBlock *Preheader, DominanceInfo *DT,
+                           ValueRangeInfo &Ranges) {
+  // Check the ranges of the values, e.g. two constants.
+  if (isLessThan(Start, End, Preheader->getTerminator(), Ranges))
     return true;
 
   // Look for a branch on EQ around the Preheader.
@@ -768,6 +827,7 @@ class InductionAnalysis {
   using InductionInfoMap = llvm::DenseMap<SILArgument *, InductionInfo *>;
 
   DominanceInfo *DT;
+  ValueRangeInfo &Ranges;
   SILBasicBlock *Preheader;
   SILBasicBlock *Header;
   SILBasicBlock *ExitingBlk;
@@ -777,11 +837,11 @@ class InductionAnalysis {
   llvm::SpecificBumpPtrAllocator<InductionInfo> Allocator;
 
 public:
-  InductionAnalysis(DominanceInfo *D, IVInfo &IVs, SILBasicBlock *Preheader,
-                    SILBasicBlock *Header, SILBasicBlock *ExitingBlk,
-                    SILBasicBlock *ExitBlk)
-      : DT(D), Preheader(Preheader), Header(Header), ExitingBlk(ExitingBlk),
-        ExitBlk(ExitBlk), IVs(IVs) {}
+  InductionAnalysis(DominanceInfo *D, ValueRangeInfo &Ranges, IVInfo &IVs,
+                    SILBasicBlock *Preheader, SILBasicBlock *Header,
+                    SILBasicBlock *ExitingBlk, SILBasicBlock *ExitBlk)
+      : DT(D), Ranges(Ranges), Preheader(Preheader), Header(Header),
+        ExitingBlk(ExitingBlk), ExitBlk(ExitBlk), IVs(IVs) {}
 
   InductionAnalysis(const InductionAnalysis &) = delete;
   InductionAnalysis &operator=(const InductionAnalysis &) = delete;
@@ -867,7 +927,7 @@ private:
     // code in the preheader's predecessor ensures that we won't overflow.
     bool IsRangeChecked = false;
     if (!isOverflowChecked(Inc)) {
-      IsRangeChecked = isRangeChecked(Start, End, Preheader, DT);
+      IsRangeChecked = isRangeChecked(Start, End, Preheader, DT, Ranges);
       if (!IsRangeChecked)
         return nullptr;
     }
@@ -1087,13 +1147,19 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
     ABC.analyseBlock(BB);
   }
 
+  // The ranges of the integer values, which prove checks of indices that are
+  // in the range of a dominating check, and loop bounds.
+  ValueRangeInfo Ranges(Header->getParent(), DT);
+
   // Remove redundant checks down the dominator tree inside the loop,
   // starting at the header.
   // We may not go to dominated blocks outside the loop, because we didn't
   // check for safety outside the loop (with ABCAnalysis).
   IndexedArraySet DominatingSafeChecks;
+  SmallVector<DominatingCheck, 8> DominatingChecks;
   bool Changed = removeRedundantChecks(DT->getNode(Header), ABC,
-                                       DominatingSafeChecks, Loop);
+                                       DominatingSafeChecks, DominatingChecks,
+                                       Ranges, Loop);
 
   if (!EnableABCHoisting)
     return Changed;
@@ -1113,7 +1179,8 @@ static bool hoistBoundsChecks(SILLoop *Loop, DominanceInfo *DT, SILLoopInfo *LI,
   DEBUG(Preheader->getParent()->dump());
 
   // Find cannonical induction variables.
-  InductionAnalysis IndVars(DT, IVs, Preheader, Header, ExitingBlk, ExitBlk);
+  InductionAnalysis IndVars(DT, Ranges, IVs, Preheader, Header, ExitingBlk,
+                            ExitBlk);
   bool IVarsFound = IndVars.analyse();
   if (!IVarsFound){
     DEBUG(llvm::dbgs() << "No induction variables found\n");
@@ -467,6 +467,28 @@ SmallPtrSetImpl<SILBasicBlock*> &COWArrayOpt::getReachingBlocks() {
 }
 
 
+/// \return true if the instruction is a semantics call on one of the
+/// copy-on-write collections: Array, Dictionary or Set.
+///
+/// These calls do not capture the collection's storage, so they can not make
+/// it non-unique.
+static bool isCOWCollectionSemanticCall(SILInstruction *Inst) {
+  return ArraySemanticsCall(Inst) ||
+         ArraySemanticsCall(Inst, "dictionary.", true) ||
+         ArraySemanticsCall(Inst, "set.", true);
+}
+
+/// \return the make_mutable call on a copy-on-write collection if \p Inst is
+/// one.
+static ArraySemanticsCall getMakeMutableCall(SILInstruction *Inst) {
+  ArraySemanticsCall Call(Inst, "array.make_mutable");
+  if (!Call)
+    Call = ArraySemanticsCall(Inst, "dictionary.make_mutable");
+  if (!Call)
+    Call = ArraySemanticsCall(Inst, "set.make_mutable");
+  return Call;
+}
+
 // \return true if the instruction is a call to a non-mutating array semantic
 // function.
 static bool isNonMutatingArraySemanticCall(SILInstruction *Inst) {
@@ -571,7 +593,7 @@ bool COWArrayOpt::checkSafeArrayAddressUses(UserList &AddressUsers) {
 
   for (auto *UseInst : AddressUsers) {
     if (auto *AI = dyn_cast<ApplyInst>(UseInst)) {
-      if (ArraySemanticsCall(AI))
+      if (isCOWCollectionSemanticCall(AI))
         continue;
 
       // Check of this escape can reach the current loop.
@@ -647,7 +669,7 @@ static bool isTransitiveSafeUser(SILInstruction *I) {
 bool COWArrayOpt::checkSafeArrayValueUses(UserList &ArrayValueUsers) {
   for (auto *UseInst : ArrayValueUsers) {
     if (auto *AI = dyn_cast<ApplyInst>(UseInst)) {
-      if (ArraySemanticsCall(AI))
+      if (isCOWCollectionSemanticCall(AI))
         continue;
 
       // Found an unsafe or unknown user. The Array may escape here.
@@ -783,6 +805,27 @@ bool COWArrayOpt::checkSafeElementValueUses(UserOperList &ElementValueUsers) {
   }
   return true;
 }
+/// \return true if all given users of an address within the collection struct
+/// are safe to hoist make_mutable across.
+///
+/// Array elements must not be accessed through addresses at all. Dictionary
+/// and Set forward their mutations to the storage enum that is stored in the
+/// collection struct, so we allow their semantic calls on that address.
+static bool checkSafeElementAddressUses(
+    StructUseCollector::UserOperList &ElementAddressUsers) {
+  for (auto &Pair : ElementAddressUsers) {
+    SILInstruction *UseInst = Pair.first;
+    if (ArraySemanticsCall(UseInst, "dictionary.", true) ||
+        ArraySemanticsCall(UseInst, "set.", true))
+      continue;
+
+    DEBUG(llvm::dbgs() << "    Skipping Array: unsafe element address use!\n"
+                       << "    " << *UseInst);
+    return false;
+  }
+  return true;
+}
+
 static bool isArrayEltStore(StoreInst *SI) {
   SILValue Dest = SI->getDest().stripAddressProjections();
   if (auto *MD = dyn_cast<MarkDependenceInst>(Dest))
@@ -1455,7 +1498,7 @@ bool COWArrayOpt::hoistMakeMutable(ArraySemanticsCall MakeMutable) {
       !checkSafeArrayAddressUses(StructUses.StructAddressUsers) ||
       !checkSafeArrayValueUses(StructUses.StructValueUsers) ||
       !checkSafeElementValueUses(StructUses.ElementValueUsers) ||
-      !StructUses.ElementAddressUsers.empty())
+      !checkSafeElementAddressUses(StructUses.ElementAddressUsers))
     return false;
 
   hoistMakeMutableAndSelfProjection(MakeMutable,
@@ -1486,7 +1529,7 @@ bool COWArrayOpt::run() {
       // Inst may be moved by hoistMakeMutable.
       SILInstruction *Inst = &*II;
       ++II;
-      ArraySemanticsCall MakeMutableCall(Inst, "array.make_mutable");
+      ArraySemanticsCall MakeMutableCall = getMakeMutableCall(Inst);
       if (!MakeMutableCall)
         continue;
 
@@ -243,6 +243,23 @@ static bool canHoistInstruction(SILInstruction *Inst, SILLoop *Loop,
   return true;
 }
 
+/// Returns true if \p Inst can be executed in the preheader even if it is only
+/// executed conditionally in the loop.
+///
+/// Type metadata and witness table references don't trap and the runtime
+/// caches them, so computing them speculatively is cheap. Hoisting them out of
+/// conditional code avoids reloading metadata on every iteration of generic
+/// loops.
+static bool isSafeToSpeculate(SILInstruction *Inst) {
+  switch (Inst->getKind()) {
+  case ValueKind::MetatypeInst:
+  case ValueKind::WitnessMethodInst:
+    return true;
+  default:
+    return false;
+  }
+}
+
 static bool hoistInstructions(SILLoop *Loop, DominanceInfo *DT,
                               ReadSet &SafeReads, bool RunsOnHighLevelSil) {
   auto Preheader = Loop->getLoopPreheader();
@@ -264,16 +281,35 @@ static bool hoistInstructions(SILLoop *Loop, DominanceInfo *DT,
        It != E;) {
     auto *CurBB = It->getBlock();
 
-    // Don't decent into control-dependent code. Only traverse into basic blocks
-    // that dominate all exits.
+    // Blocks dominated by the header which are outside of the loop are exit
+    // blocks.
+    if (!Loop->contains(CurBB)) {
+      It.skipChildren();
+      continue;
+    }
+
+    // Control-dependent code is descended into, but only instructions which
+    // are safe to speculate are hoisted out of it. Only basic blocks that
+    // dominate all exits are guaranteed to be executed.
     if (!std::all_of(ExitingBBs.begin(), ExitingBBs.end(),
                      [=](SILBasicBlock *ExitBB) {
           if (DT->dominates(CurBB, ExitBB))
             return true;
           return false;
         })) {
-      DEBUG(llvm::dbgs() << "  skipping conditional block " << *CurBB << "\n");
-      It.skipChildren();
+      DEBUG(llvm::dbgs() << "  speculating in conditional block " << *CurBB
+                         << "\n");
+      for (auto InstIt = CurBB->begin(), E = CurBB->end(); InstIt != E; ) {
+        SILInstruction *Inst = &*InstIt;
+        ++InstIt;
+        if (isSafeToSpeculate(Inst) &&
+            canHoistInstruction(Inst, Loop, SafeReads)) {
+          DEBUG(llvm::dbgs() << "   speculating " << *Inst);
+          Changed = true;
+          Inst->moveBefore(Preheader->getTerminator());
+        }
+      }
+      ++It;
       continue;
     }
 
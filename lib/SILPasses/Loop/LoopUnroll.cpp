@@ -0,0 +1,358 @@
+//===--------- LoopUnroll.cpp - Loop unrolling ------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Fully unroll innermost loops with a small constant trip count.
+//
+// The body of the loop is copied once per iteration and the latch of each copy
+// branches to the header of the next one. Every copy keeps its exit check, so
+// the unrolled code behaves exactly like the loop did. Constant propagation and
+// SimplifyCFG then fold the checks of the induction variable and remove the
+// back edge.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "sil-loopunroll"
+
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILAnalysis/Analysis.h"
+#include "swift/SILAnalysis/LoopAnalysis.h"
+#include "swift/SILPasses/Passes.h"
+#include "swift/SILPasses/Transforms.h"
+#include "swift/SILPasses/Utils/SILSSAUpdater.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumLoopsUnrolled, "Number of loops fully unrolled");
+
+static llvm::cl::opt<unsigned> UnrollThreshold(
+    "sil-loop-unroll-threshold", llvm::cl::init(250),
+    llvm::cl::desc("The maximum number of instructions a loop may have after "
+                   "it is fully unrolled"));
+
+namespace {
+
+/// Clones the blocks of a loop into the same function. Values defined outside
+/// the loop are used as they are, and edges that leave the loop still branch
+/// to the original exit blocks.
+class LoopCloner : public SILCloner<LoopCloner> {
+  SILLoop *Loop;
+
+  friend class SILVisitor<LoopCloner>;
+  friend class SILCloner<LoopCloner>;
+
+public:
+  LoopCloner(SILLoop *Loop)
+      : SILCloner<LoopCloner>(*Loop->getHeader()->getParent()), Loop(Loop) {}
+
+  /// Clone the blocks of the loop.
+  void cloneLoop();
+
+  SILBasicBlock *getMappedBlock(SILBasicBlock *BB) { return BBMap[BB]; }
+
+  SILValue getMappedValue(SILValue V) { return remapValue(V); }
+
+protected:
+  SILValue remapValue(SILValue V) {
+    SILBasicBlock *BB = V.getDef()->getParentBB();
+    if (!BB || !Loop->contains(BB))
+      return V;
+    return SILCloner<LoopCloner>::remapValue(V);
+  }
+};
+
+} // end anonymous namespace
+
+void LoopCloner::cloneLoop() {
+  SILBasicBlock *Header = Loop->getHeader();
+  SILFunction *F = Header->getParent();
+  SILModule &Mod = F->getModule();
+
+  SmallVector<SILBasicBlock *, 16> ExitBlocks;
+  Loop->getExitBlocks(ExitBlocks);
+  for (auto *ExitBB : ExitBlocks)
+    BBMap[ExitBB] = ExitBB;
+
+  auto *ClonedHeader = new (Mod) SILBasicBlock(F);
+  for (auto *Arg : Header->getBBArgs())
+    ValueMap[Arg] = new (Mod) SILArgument(ClonedHeader, Arg->getType());
+  BBMap[Header] = ClonedHeader;
+
+  // Clone the instructions of the header and, recursively, of the other loop
+  // blocks. The latch of the copy branches back to the copy of the header.
+  getBuilder().setInsertionPoint(ClonedHeader);
+  visitSILBasicBlock(Header);
+
+  // Clone the terminators.
+  for (auto &Entry : BBMap) {
+    if (Entry.first == Entry.second)
+      continue;
+    getBuilder().setInsertionPoint(Entry.second);
+    visit(Entry.first->getTerminator());
+  }
+}
+
+/// \return The number of times the body of \p Loop is executed, if it is
+/// controlled by an induction variable that counts up by one from a constant
+/// start to a constant end.
+static Optional<uint64_t> getLoopTripCount(SILLoop *Loop,
+                                           SILBasicBlock *Preheader,
+                                           SILBasicBlock *Header,
+                                           SILBasicBlock *Latch) {
+  // Look through a split back edge.
+  SILBasicBlock *ExitingBlk = Latch;
+  if (!Loop->isLoopExiting(ExitingBlk) &&
+      !(ExitingBlk = ExitingBlk->getSinglePredecessor()))
+    return None;
+  if (!Loop->isLoopExiting(ExitingBlk))
+    return None;
+
+  auto *CondBr = dyn_cast<CondBranchInst>(ExitingBlk->getTerminator());
+  if (!CondBr || Loop->contains(CondBr->getTrueBB()) ||
+      !Loop->contains(CondBr->getFalseBB()))
+    return None;
+
+  // The loop exits when the incremented induction variable reaches the end.
+  auto *Cmp = dyn_cast<BuiltinInst>(CondBr->getCondition());
+  if (!Cmp || Cmp->getBuiltinKind() != BuiltinValueKind::ICMP_EQ)
+    return None;
+  SILValue Next = Cmp->getArgument(0);
+  auto *End = dyn_cast<IntegerLiteralInst>(Cmp->getArgument(1));
+  if (!End) {
+    Next = Cmp->getArgument(1);
+    End = dyn_cast<IntegerLiteralInst>(Cmp->getArgument(0));
+  }
+  if (!End)
+    return None;
+
+  auto *Extract = dyn_cast<TupleExtractInst>(Next);
+  if (!Extract || Extract->getFieldNo() != 0)
+    return None;
+  auto *Inc = dyn_cast<BuiltinInst>(Extract->getOperand());
+  if (!Inc || Inc->getBuiltinKind() != BuiltinValueKind::SAddOver)
+    return None;
+  auto *Step = dyn_cast<IntegerLiteralInst>(Inc->getArgument(1));
+  if (!Step || Step->getValue() != 1)
+    return None;
+
+  // The induction variable is a header argument that starts at a constant
+  // and is updated with the incremented value on the back edge.
+  auto *IndVar = dyn_cast<SILArgument>(Inc->getArgument(0));
+  if (!IndVar || IndVar->getParent() != Header)
+    return None;
+  auto *Start =
+      dyn_cast_or_null<IntegerLiteralInst>(IndVar->getIncomingValue(Preheader));
+  if (!Start || IndVar->getIncomingValue(Latch) != Next)
+    return None;
+
+  APInt StartVal = Start->getValue();
+  APInt EndVal = End->getValue();
+  if (!StartVal.slt(EndVal))
+    return None;
+  APInt TripCount = EndVal - StartVal;
+  if (TripCount.getActiveBits() > 64)
+    return None;
+  return TripCount.getZExtValue();
+}
+
+/// \return True if the blocks of \p Loop can be copied and the loop is small
+/// enough to be fully unrolled \p TripCount times.
+static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
+  if (TripCount < 2 || TripCount > UnrollThreshold)
+    return false;
+
+  uint64_t Cost = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Inst.isTriviallyDuplicatable())
+        return false;
+      if (isa<IntegerLiteralInst>(&Inst) || isa<FunctionRefInst>(&Inst))
+        continue;
+      Cost += TripCount;
+      if (Cost > UnrollThreshold)
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Replace the edge from \p Latch to \p Header by an edge to \p NewHeader,
+/// passing the same arguments.
+static void redirectBackEdge(SILBasicBlock *Latch, SILBasicBlock *Header,
+                             SILBasicBlock *NewHeader) {
+  TermInst *Term = Latch->getTerminator();
+  SILBuilderWithScope B(Term);
+  if (auto *CondBr = dyn_cast<CondBranchInst>(Term)) {
+    SILBasicBlock *TrueBB = CondBr->getTrueBB();
+    SILBasicBlock *FalseBB = CondBr->getFalseBB();
+    B.createCondBranch(CondBr->getLoc(), CondBr->getCondition(),
+                       TrueBB == Header ? NewHeader : TrueBB,
+                       CondBr->getTrueArgs(),
+                       FalseBB == Header ? NewHeader : FalseBB,
+                       CondBr->getFalseArgs());
+  } else {
+    auto *Br = cast<BranchInst>(Term);
+    assert(Br->getDestBB() == Header && "Latch must branch to the header");
+    B.createBranch(Br->getLoc(), NewHeader, Br->getArgs());
+  }
+  Term->eraseFromParent();
+}
+
+/// A value defined in the loop and used outside of it, along with its copies
+/// in the unrolled iterations.
+struct LiveOutValue {
+  SILValue Orig;
+  SmallVector<SILValue, 8> Copies;
+};
+
+/// Collect the values defined in \p Loop that are used outside of it.
+static void collectLiveOutValues(SILLoop *Loop,
+                                 SmallVectorImpl<LiveOutValue> &LiveOut) {
+  auto isUsedOutsideLoop = [&](SILValue V) {
+    for (auto *Use : V.getUses())
+      if (!Loop->contains(Use->getUser()->getParent()))
+        return true;
+    return false;
+  };
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto *Arg : BB->getBBArgs())
+      if (isUsedOutsideLoop(Arg))
+        LiveOut.push_back({Arg, {}});
+    for (auto &Inst : *BB)
+      for (unsigned i = 0, e = Inst.getNumTypes(); i != e; ++i)
+        if (isUsedOutsideLoop(SILValue(&Inst, i)))
+          LiveOut.push_back({SILValue(&Inst, i), {}});
+  }
+}
+
+/// Rewrite the uses outside of \p Loop of the values in \p LiveOut to use the
+/// copy from whichever iteration exited the loop.
+static void updateSSA(SILLoop *Loop, ArrayRef<LiveOutValue> LiveOut) {
+  SILSSAUpdater Updater;
+  for (auto &Value : LiveOut) {
+    Updater.Initialize(Value.Orig.getType());
+    Updater.AddAvailableValue(Value.Orig.getDef()->getParentBB(), Value.Orig);
+    for (SILValue Copy : Value.Copies)
+      Updater.AddAvailableValue(Copy.getDef()->getParentBB(), Copy);
+
+    // Collect the uses first. Rewriting a use in a branch replaces the
+    // branch, which would invalidate a use iterator.
+    SmallVector<UseWrapper, 8> Uses;
+    for (auto *Use : Value.Orig.getUses())
+      if (!Loop->contains(Use->getUser()->getParent()))
+        Uses.push_back(UseWrapper(Use));
+    for (auto U : Uses) {
+      Operand *Use = U;
+      Updater.RewriteUse(*Use);
+    }
+  }
+}
+
+static bool tryToUnrollLoop(SILLoop *Loop) {
+  assert(Loop->getSubLoops().empty() && "Expected an innermost loop");
+
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+  auto *Latch = Loop->getLoopLatch();
+  if (!Latch)
+    return false;
+  auto *Header = Loop->getHeader();
+
+  auto TripCount = getLoopTripCount(Loop, Preheader, Header, Latch);
+  if (!TripCount || !canAndShouldUnrollLoop(Loop, *TripCount))
+    return false;
+
+  // The SSA updater adds arguments to the edges leaving the loop, which only
+  // branches support.
+  SmallVector<SILBasicBlock *, 16> ExitingBlocks;
+  Loop->getExitingBlocks(ExitingBlocks);
+  for (auto *ExitingBB : ExitingBlocks)
+    if (!isa<CondBranchInst>(ExitingBB->getTerminator()))
+      return false;
+
+  DEBUG(llvm::dbgs() << "Unrolling " << *TripCount << " iterations of "
+                     << *Loop << " in " << Header->getParent()->getName()
+                     << "\n");
+
+  SmallVector<LiveOutValue, 8> LiveOut;
+  collectLiveOutValues(Loop, LiveOut);
+
+  // Copy the body once for every iteration after the first. Each copy starts
+  // out as a loop of its own, because its latch branches to its own header.
+  SmallVector<SILBasicBlock *, 8> Headers(1, Header);
+  SmallVector<SILBasicBlock *, 8> Latches(1, Latch);
+  for (uint64_t Iter = 1; Iter < *TripCount; ++Iter) {
+    LoopCloner Cloner(Loop);
+    Cloner.cloneLoop();
+    Headers.push_back(Cloner.getMappedBlock(Header));
+    Latches.push_back(Cloner.getMappedBlock(Latch));
+    for (auto &Value : LiveOut)
+      Value.Copies.push_back(Cloner.getMappedValue(Value.Orig));
+  }
+
+  // Chain each iteration to the next one. The last latch branches back to the
+  // original header. Its exit check keeps that edge from being taken, and
+  // folding the check removes the edge.
+  for (unsigned i = 0, e = Headers.size(); i != e; ++i)
+    redirectBackEdge(Latches[i], Headers[i], Headers[(i + 1) % e]);
+
+  updateSSA(Loop, LiveOut);
+  ++NumLoopsUnrolled;
+  return true;
+}
+
+namespace {
+
+class LoopUnrolling : public SILFunctionTransform {
+
+  StringRef getName() override { return "SIL Loop Unrolling"; }
+
+  void run() override {
+    SILFunction *F = getFunction();
+    SILLoopInfo *LI = PM->getAnalysis<SILLoopAnalysis>()->get(F);
+
+    // Only innermost loops are unrolled. Their blocks don't overlap, so
+    // unrolling one doesn't invalidate what the loop info says about the
+    // others.
+    SmallVector<SILLoop *, 16> InnermostLoops;
+    for (auto *TopLevelLoop : *LI) {
+      SmallVector<SILLoop *, 8> Worklist;
+      Worklist.push_back(TopLevelLoop);
+      while (!Worklist.empty()) {
+        SILLoop *L = Worklist.pop_back_val();
+        if (L->getSubLoops().empty())
+          InnermostLoops.push_back(L);
+        for (auto *SubLoop : *L)
+          Worklist.push_back(SubLoop);
+      }
+    }
+
+    bool Changed = false;
+    for (auto *L : InnermostLoops)
+      Changed |= tryToUnrollLoop(L);
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+  }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createLoopUnroll() {
+  return new LoopUnrolling();
+}
@@ -15,13 +15,24 @@
 #include "swift/SILPasses/PassManager.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
+#include "swift/SILAnalysis/BasicCalleeAnalysis.h"
+#include "swift/SILAnalysis/FunctionOrder.h"
 #include "swift/SILPasses/PrettyStackTrace.h"
 #include "swift/SILPasses/Transforms.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
 
 using namespace swift;
 
@@ -39,6 +50,11 @@ llvm::cl::opt<bool> SILPrintPassTime(
     "sil-print-pass-time", llvm::cl::init(false),
     llvm::cl::desc("Print the execution time of each SIL pass"));
 
+llvm::cl::opt<bool> SILPrintPassTimeSummary(
+    "sil-print-pass-time-summary", llvm::cl::init(false),
+    llvm::cl::desc("Print the total execution time of each SIL pass when "
+                   "the pass manager is destroyed"));
+
 llvm::cl::opt<unsigned> SILNumOptPassesToRun(
     "sil-opt-pass-count", llvm::cl::init(UINT_MAX),
     llvm::cl::desc("Stop optimizing after <N> optimization passes"));
@@ -75,6 +91,155 @@ llvm::cl::opt<bool> SILVerifyWithoutInvalidation(
     "sil-verify-without-invalidation", llvm::cl::init(false),
     llvm::cl::desc("Verify after passes even if the pass has not invalidated"));
 
+llvm::cl::opt<bool> SILVerifyIncremental(
+    "sil-verify-incremental", llvm::cl::init(false),
+    llvm::cl::desc("After a module pass, verify only the functions it "
+                   "invalidated or created, unless it invalidated the "
+                   "whole module"));
+
+llvm::cl::opt<unsigned> SILVerifySamplePercent(
+    "sil-verify-sample-percent", llvm::cl::init(100),
+    llvm::cl::desc("Verify only this percentage of the functions after "
+                   "each pass"));
+
+llvm::cl::opt<unsigned> SILVerifySampleSeed(
+    "sil-verify-sample-seed", llvm::cl::init(0),
+    llvm::cl::desc("Seed for choosing the functions verified by "
+                   "-sil-verify-sample-percent"));
+
+llvm::cl::opt<std::string> SILPassProfile(
+    "sil-pass-profile", llvm::cl::init(""),
+    llvm::cl::desc("Write the time and instruction count changes of each "
+                   "pass on each function as CSV to this file"),
+    llvm::cl::value_desc("filename"));
+
+namespace {
+/// The accumulated profile of one pass on one function.
+struct PassProfileEntry {
+  unsigned Runs = 0;
+  unsigned Invalidations = 0;
+  uint64_t TimeInNanoseconds = 0;
+  int64_t InstCountDelta = 0;
+  uint64_t BytesReused = 0;
+};
+} // end anonymous namespace
+
+/// The pass profile, keyed by stage, pass name and function name. It is
+/// shared by all pass managers in the process so that the file written by
+/// -sil-pass-profile covers all optimization stages.
+typedef std::tuple<std::string, std::string, std::string> PassProfileKey;
+static std::map<PassProfileKey, PassProfileEntry> PassProfile;
+
+static void recordPassProfile(StringRef Stage, StringRef PassName,
+                              StringRef FunctionName, bool Invalidated,
+                              uint64_t TimeInNanoseconds,
+                              int64_t InstCountDelta, uint64_t BytesReused) {
+  PassProfileEntry &Entry =
+      PassProfile[PassProfileKey(Stage, PassName, FunctionName)];
+  ++Entry.Runs;
+  if (Invalidated)
+    ++Entry.Invalidations;
+  Entry.TimeInNanoseconds += TimeInNanoseconds;
+  Entry.InstCountDelta += InstCountDelta;
+  Entry.BytesReused += BytesReused;
+}
+
+/// Write the pass profile collected so far to the -sil-pass-profile file.
+static void writePassProfile() {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(SILPassProfile, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    llvm::errs() << "error: cannot open pass profile file '"
+                 << SILPassProfile << "': " << EC.message() << '\n';
+    return;
+  }
+
+  OS << "stage,pass,function,runs,invalidations,time_ns,inst_delta,"
+        "bytes_reused\n";
+  for (auto &KV : PassProfile) {
+    const PassProfileEntry &Entry = KV.second;
+    OS << std::get<0>(KV.first) << ',' << std::get<1>(KV.first) << ','
+       << std::get<2>(KV.first) << ',' << Entry.Runs << ','
+       << Entry.Invalidations << ',' << Entry.TimeInNanoseconds << ','
+       << Entry.InstCountDelta << ',' << Entry.BytesReused << '\n';
+  }
+}
+
+namespace {
+/// The accumulated time of one pass in one stage.
+struct PassTimeEntry {
+  unsigned Runs = 0;
+  uint64_t TimeInNanoseconds = 0;
+};
+} // end anonymous namespace
+
+/// The pass times for -sil-print-pass-time-summary, keyed by stage and pass
+/// name.
+typedef std::pair<std::string, std::string> PassTimeKey;
+static std::map<PassTimeKey, PassTimeEntry> PassTimes;
+
+static void recordPassTime(StringRef Stage, StringRef PassName,
+                           uint64_t TimeInNanoseconds) {
+  PassTimeEntry &Entry = PassTimes[PassTimeKey(Stage, PassName)];
+  ++Entry.Runs;
+  Entry.TimeInNanoseconds += TimeInNanoseconds;
+}
+
+/// Print the pass times collected so far, the slowest passes of each stage
+/// first, and reset them.
+static void printPassTimeSummary(llvm::raw_ostream &OS) {
+  std::map<std::string, std::vector<std::pair<std::string, PassTimeEntry>>>
+      Stages;
+  for (auto &KV : PassTimes)
+    Stages[KV.first.first].push_back({KV.first.second, KV.second});
+  PassTimes.clear();
+
+  for (auto &Stage : Stages) {
+    auto &Passes = Stage.second;
+    std::sort(Passes.begin(), Passes.end(),
+              [](const std::pair<std::string, PassTimeEntry> &LHS,
+                 const std::pair<std::string, PassTimeEntry> &RHS) {
+      return LHS.second.TimeInNanoseconds > RHS.second.TimeInNanoseconds;
+    });
+    uint64_t Total = 0;
+    for (auto &Pass : Passes)
+      Total += Pass.second.TimeInNanoseconds;
+
+    OS << "*** SIL pass time summary: " << Stage.first << " ***\n";
+    OS << "   Time (ms)      %     Runs  Pass\n";
+    for (auto &Pass : Passes) {
+      const PassTimeEntry &Entry = Pass.second;
+      double Percent = Total ? Entry.TimeInNanoseconds * 100.0 / Total : 0.0;
+      OS << llvm::format("%12.3f %6.1f %8u  ",
+                         Entry.TimeInNanoseconds / 1000000.0, Percent,
+                         Entry.Runs)
+         << Pass.first << '\n';
+    }
+    OS << llvm::format("%12.3f %6.1f %8s  ", Total / 1000000.0, 100.0, "")
+       << "Total\n";
+  }
+}
+
+/// Returns the time elapsed since \p StartTime in nanoseconds.
+static uint64_t getNanosecondsSince(llvm::sys::TimeValue StartTime) {
+  llvm::sys::TimeValue Elapsed = llvm::sys::TimeValue::now() - StartTime;
+  return (uint64_t)Elapsed.seconds() * 1000000000 + Elapsed.nanoseconds();
+}
+
+static unsigned countInstructions(SILFunction &F) {
+  unsigned Count = 0;
+  for (auto &BB : F)
+    Count += BB.size();
+  return Count;
+}
+
+static unsigned countInstructions(SILModule &M) {
+  unsigned Count = 0;
+  for (auto &F : M)
+    Count += countInstructions(F);
+  return Count;
+}
+
 static bool doPrintBefore(SILTransform *T, SILFunction *F) {
   if (!SILPrintOnlyFun.empty() && F && F->getName() != SILPrintOnlyFun)
     return false;
@@ -156,86 +321,202 @@ SILPassManager::SILPassManager(SILModule *M, llvm::StringRef Stage) :
   }
 }
 
-bool SILPassManager::runFunctionPasses(PassList FuncTransforms) {
+bool SILPassManager::runPassesOnFunction(PassList FuncTransforms,
+                                         SILFunction *F) {
   const SILOptions &Options = getOptions();
 
-  for (auto &F : *Mod) {
-    if (F.empty())
+  if (F->empty())
+    return false;
+
+  // Don't optimize functions that are marked with the opt.never attribute.
+  if (!F->shouldOptimize())
+    return false;
+
+  CompletedPasses &completedPasses = CompletedPassesMap[F];
+
+  for (auto SFT : FuncTransforms) {
+    PrettyStackTraceSILFunctionTransform X(SFT);
+    SFT->injectPassManager(this);
+    SFT->injectFunction(F);
+    
+    // If nothing changed since the last run of this pass, we can skip this
+    // pass.
+    if (completedPasses.test((size_t)SFT->getPassKind()))
       continue;
 
-    // Don't optimize functions that are marked with the opt.never attribute.
-    if (!F.shouldOptimize())
+    if (isDisabled(SFT))
       continue;
 
-    CompletedPasses &completedPasses = CompletedPassesMap[&F];
+    currentPassHasInvalidated = false;
 
-    for (auto SFT : FuncTransforms) {
-      PrettyStackTraceSILFunctionTransform X(SFT);
-      SFT->injectPassManager(this);
-      SFT->injectFunction(&F);
-      
-      // If nothing changed since the last run of this pass, we can skip this
-      // pass.
-      if (completedPasses.test((size_t)SFT->getPassKind()))
-        continue;
+    if (SILPrintPassName)
+      llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
+                   << " Pass: " << SFT->getName()
+                   << ", Function: " << F->getName() << "\n";
 
-      if (isDisabled(SFT))
-        continue;
+    if (doPrintBefore(SFT, F)) {
+      llvm::dbgs() << "*** SIL function before " << StageName << " "
+                   << SFT->getName() << " (" << NumOptimizationIterations
+                   << ") ***\n";
+      F->dump(Options.EmitVerboseSIL);
+    }
 
-      currentPassHasInvalidated = false;
+    bool Profile = !SILPassProfile.empty();
+    unsigned InstCountBefore = Profile ? countInstructions(*F) : 0;
+    uint64_t BytesReusedBefore = Mod->getNumInstructionBytesReused();
+
+    llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
+    SFT->run();
+
+    if (SILPrintPassTimeSummary)
+      recordPassTime(StageName, SFT->getName(),
+                     getNanosecondsSince(StartTime));
+    if (SILPrintPassTime || Profile) {
+      auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
+        StartTime.nanoseconds();
+      if (SILPrintPassTime)
+        llvm::dbgs() << Delta << " (" << SFT->getName() << ","
+                     << F->getName() << ")\n";
+      if (Profile)
+        recordPassProfile(StageName, SFT->getName(), F->getName(),
+                          currentPassHasInvalidated,
+                          getNanosecondsSince(StartTime),
+                          (int64_t)countInstructions(*F) -
+                              (int64_t)InstCountBefore,
+                          Mod->getNumInstructionBytesReused() -
+                              BytesReusedBefore);
+    }
 
-      if (SILPrintPassName)
-        llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
-                     << " Pass: " << SFT->getName()
-                     << ", Function: " << F.getName() << "\n";
+    // If this pass invalidated anything, print and verify.
+    if (doPrintAfter(SFT, F,
+                     currentPassHasInvalidated && SILPrintAll)) {
+      llvm::dbgs() << "*** SIL function after " << StageName << " "
+                   << SFT->getName() << " (" << NumOptimizationIterations
+                   << ") ***\n";
+      F->dump(Options.EmitVerboseSIL);
+    }
 
-      if (doPrintBefore(SFT, &F)) {
-        llvm::dbgs() << "*** SIL function before " << StageName << " "
-                     << SFT->getName() << " (" << NumOptimizationIterations
-                     << ") ***\n";
-        F.dump(Options.EmitVerboseSIL);
-      }
+    // Remember if this pass didn't change anything.
+    if (!currentPassHasInvalidated)
+      completedPasses.set((size_t)SFT->getPassKind());
 
-      llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
-      SFT->run();
+    if (Options.VerifyAll &&
+        (currentPassHasInvalidated || SILVerifyWithoutInvalidation) &&
+        isSampledForVerification(*F)) {
+      F->verify();
+      verifyAnalyses(F);
+    }
 
-      if (SILPrintPassTime) {
-        auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
-          StartTime.nanoseconds();
-        llvm::dbgs() << Delta << " (" << SFT->getName() << "," << F.getName()
-                     << ")\n";
-      }
+    // The instructions deleted by this pass are no longer referenced by it or
+    // by any analysis it invalidated, so their memory can be reused.
+    Mod->reclaimDeletedInstructions();
 
-      // If this pass invalidated anything, print and verify.
-      if (doPrintAfter(SFT, &F,
-                       currentPassHasInvalidated && SILPrintAll)) {
-        llvm::dbgs() << "*** SIL function after " << StageName << " "
-                     << SFT->getName() << " (" << NumOptimizationIterations
-                     << ") ***\n";
-        F.dump(Options.EmitVerboseSIL);
-      }
+    ++NumPassesRun;
+    // Request that we stop this optimization phase.
+    if (Mod->getStage() == SILStage::Canonical
+        && NumPassesRun >= SILNumOptPassesToRun)
+      return true;
+  }
 
-      // Remember if this pass didn't change anything.
-      if (!currentPassHasInvalidated)
-        completedPasses.set((size_t)SFT->getPassKind());
+  return false;
+}
 
-      if (Options.VerifyAll &&
-          (currentPassHasInvalidated || SILVerifyWithoutInvalidation)) {
-        F.verify();
-        verifyAnalyses(&F);
-      }
+bool SILPassManager::isSampledForVerification(const SILFunction &F) const {
+  if (SILVerifySamplePercent >= 100)
+    return true;
 
-      ++NumPassesRun;
-      // Request that we stop this optimization phase.
-      if (Mod->getStage() == SILStage::Canonical
-          && NumPassesRun >= SILNumOptPassesToRun)
-        return true;
+  // Hash in the pass number, so that each pass verifies a different sample.
+  size_t Hash = llvm::hash_combine(F.getName(), NumPassesRun,
+                                   unsigned(SILVerifySampleSeed));
+  return Hash % 100 < SILVerifySamplePercent;
+}
+
+void SILPassManager::verifyAfterModulePass(
+    const llvm::SmallPtrSetImpl<SILFunction *> *FunctionsBefore) {
+  if (SILVerifySamplePercent >= 100 &&
+      (!FunctionsBefore || currentPassHasInvalidatedModule)) {
+    Mod->verify();
+    verifyAnalyses();
+    return;
+  }
+
+  // The functions the pass invalidated may have been deleted since, so only
+  // compare their addresses.
+  auto ShouldVerify = [&](const SILFunction &F) -> bool {
+    auto *Fn = const_cast<SILFunction *>(&F);
+    if (FunctionsBefore && !currentPassHasInvalidatedModule &&
+        FunctionsBefore->count(Fn) &&
+        !currentPassInvalidatedFunctions.count(Fn))
+      return false;
+    return isSampledForVerification(F);
+  };
+  Mod->verify(ShouldVerify);
+  for (SILFunction &F : *Mod)
+    if (ShouldVerify(F))
+      verifyAnalyses(&F);
+}
+
+bool SILPassManager::needsToRunPasses(PassList FuncTransforms,
+                                      SILFunction &F) const {
+  if (F.empty() || !F.shouldOptimize())
+    return false;
+
+  // Functions which were never visited or changed since the last visit have
+  // no entry in the completed-passes map.
+  auto Iter = CompletedPassesMap.find(&F);
+  if (Iter == CompletedPassesMap.end())
+    return true;
+
+  for (auto SFT : FuncTransforms)
+    if (!Iter->second.test((size_t)SFT->getPassKind()))
+      return true;
+  return false;
+}
+
+bool SILPassManager::runFunctionPasses(PassList FuncTransforms) {
+  if (FuncTransforms.empty())
+    return false;
+
+  // Late iterations of the pipeline often find that nothing changed since
+  // the last one. Don't compute the function order just to confirm that.
+  bool AnyFunctionChanged = false;
+  for (auto &F : *Mod) {
+    if (needsToRunPasses(FuncTransforms, F)) {
+      AnyFunctionChanged = true;
+      break;
     }
   }
+  if (!AnyFunctionChanged)
+    return false;
+
+  // Visit callees before their callers, so that callers see the already
+  // optimized bodies of the functions they call.
+  BasicCalleeAnalysis *BCA = getAnalysis<BasicCalleeAnalysis>();
+  BottomUpFunctionOrder BottomUpOrder(*Mod, BCA);
+  auto BottomUpFunctions = BottomUpOrder.getFunctions();
+
+  llvm::SmallPtrSet<SILFunction *, 32> Visited;
+  for (auto *F : BottomUpFunctions) {
+    Visited.insert(F);
+    if (!needsToRunPasses(FuncTransforms, *F))
+      continue;
+    if (runPassesOnFunction(FuncTransforms, F))
+      return true;
+  }
+
+  // Functions created by the passes above (e.g. specializations) are not
+  // part of the bottom-up order. Run the passes on them as well.
+  for (auto &F : *Mod) {
+    if (Visited.count(&F) || !needsToRunPasses(FuncTransforms, F))
+      continue;
+    if (runPassesOnFunction(FuncTransforms, &F))
+      return true;
+  }
 
   return false;
 }
 
+
 void SILPassManager::runOneIteration() {
   // Verify that all analysis were properly unlocked.
   for (auto A : Analysis) {
@@ -278,6 +559,11 @@ void SILPassManager::runOneIteration() {
 
       if (isDisabled(SMT))
         continue;
+
+      // If nothing changed since the last run of this pass, we can skip this
+      // pass.
+      if (CompletedModulePasses.test((size_t)SMT->getPassKind()))
+        continue;
       
       PrettyStackTraceSILModuleTransform X(SMT);
 
@@ -285,6 +571,16 @@ void SILPassManager::runOneIteration() {
       SMT->injectModule(Mod);
 
       currentPassHasInvalidated = false;
+      currentPassHasInvalidatedModule = false;
+      currentPassInvalidatedFunctions.clear();
+
+      // Remember the existing functions, so that incremental verification
+      // can tell which functions the pass created.
+      llvm::SmallPtrSet<SILFunction *, 64> FunctionsBefore;
+      bool VerifyIncrementally = Options.VerifyAll && SILVerifyIncremental;
+      if (VerifyIncrementally)
+        for (SILFunction &F : *Mod)
+          FunctionsBefore.insert(&F);
 
       if (SILPrintPassName)
         llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
@@ -297,13 +593,30 @@ void SILPassManager::runOneIteration() {
         printModule(Mod, Options.EmitVerboseSIL);
       }
 
+      bool Profile = !SILPassProfile.empty();
+      unsigned InstCountBefore = Profile ? countInstructions(*Mod) : 0;
+      uint64_t BytesReusedBefore = Mod->getNumInstructionBytesReused();
+
       llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
       SMT->run();
 
-      if (SILPrintPassTime) {
+      if (SILPrintPassTimeSummary)
+        recordPassTime(StageName, SMT->getName(),
+                       getNanosecondsSince(StartTime));
+      if (SILPrintPassTime || Profile) {
         auto Delta = llvm::sys::TimeValue::now().nanoseconds() -
           StartTime.nanoseconds();
-        llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
+        if (SILPrintPassTime)
+          llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
+        // Module passes are recorded with an empty function name.
+        if (Profile)
+          recordPassProfile(StageName, SMT->getName(), "",
+                            currentPassHasInvalidated,
+                          getNanosecondsSince(StartTime),
+                            (int64_t)countInstructions(*Mod) -
+                                (int64_t)InstCountBefore,
+                            Mod->getNumInstructionBytesReused() -
+                                BytesReusedBefore);
       }
 
       // If this pass invalidated anything, print and verify.
@@ -315,11 +628,16 @@ void SILPassManager::runOneIteration() {
         printModule(Mod, Options.EmitVerboseSIL);
       }
 
+      // Remember if this pass didn't change anything.
+      if (!currentPassHasInvalidated)
+        CompletedModulePasses.set((size_t)SMT->getPassKind());
+
       if (Options.VerifyAll &&
-          (currentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
-        Mod->verify();
-        verifyAnalyses();
-      }
+          (currentPassHasInvalidated || SILVerifyWithoutInvalidation))
+        verifyAfterModulePass(VerifyIncrementally ? &FunctionsBefore
+                                                  : nullptr);
+
+      Mod->reclaimDeletedInstructions();
 
       ++NumPassesRun;
       if (Mod->getStage() == SILStage::Canonical
@@ -372,6 +690,13 @@ void SILPassManager::run() {
 
 /// D'tor.
 SILPassManager::~SILPassManager() {
+  // Rewrite the profile file, so that it includes the passes of this stage.
+  if (!SILPassProfile.empty())
+    writePassProfile();
+
+  if (SILPrintPassTimeSummary)
+    printPassTimeSummary(llvm::dbgs());
+
   // Free all transformations.
   for (auto T : Transformations)
     delete T;
@@ -392,6 +717,8 @@ void SILPassManager::resetAndRemoveTransformations() {
 
   Transformations.clear();
   NumOptimizationIterations = 0;
+  // The next pipeline may configure its module passes differently.
+  CompletedModulePasses.reset();
 }
 
 void SILPassManager::setStageName(llvm::StringRef NextStage) {
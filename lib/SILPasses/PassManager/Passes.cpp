@@ -172,6 +172,12 @@ void AddSSAPasses(SILPassManager &PM, OptimizationLevelKind OpLevel) {
   PM.addSROA();
   PM.addMem2Reg();
 
+  // Once everything is inlined, trip counts of loops over small constant
+  // ranges are visible. Unroll them before constant propagation folds the
+  // unrolled exit checks.
+  if (OpLevel == OptimizationLevelKind::LowLevel)
+    PM.addLoopUnroll();
+
   // Perform classsic SSA optimizations.
   PM.addGlobalOpt();
   PM.addLetPropertiesOpt();
@@ -238,6 +244,8 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
 
   // Start by cloning functions from stdlib.
   PM.addSILLinker();
+  if (!Module.getOptions().PrespecializeProfilePath.empty())
+    PM.addProfilePrespecialization();
   PM.run();
   PM.resetAndRemoveTransformations();
 
@@ -288,6 +296,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // take advantage of static dispatch.
   PM.addCapturePropagation();
 
+  // Specialize functions for the concrete types their callers pass for
+  // existential arguments, to devirtualize the witness calls on them.
+  PM.addExistentialSpecializer();
+
   // Specialize closure.
   PM.addClosureSpecializer();
 
@@ -354,6 +366,14 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addDCE();
   // Clean-up after DCE.
   PM.addSimplifyCFG();
+
+  // Use non-atomic reference counting for objects which can't be seen by
+  // other threads. This must run after the last ARC optimization.
+  PM.addUpdateEscapeAnalysis();
+  PM.addNonAtomicRC();
+
+  // Record the effects of public functions for clients of this module.
+  PM.addInferEffects();
   PM.runOneIteration();
 
   // Call the CFG viewer.
@@ -390,6 +410,11 @@ void swift::runSILPassesForOnone(SILModule &Module) {
   // eventually remove unused declarations.
   PM.addExternalDefsToDecls();
 
+  // Without optimizations, only an explicit -assume-single-threaded enables
+  // non-atomic reference counting.
+  if (Module.getOptions().AssumeSingleThreaded)
+    PM.addNonAtomicRC();
+
   PM.runOneIteration();
 
   // Verify the module, if required.
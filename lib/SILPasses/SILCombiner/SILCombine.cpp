@@ -25,6 +25,7 @@
 #include "swift/SIL/SILVisitor.h"
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SILAnalysis/AliasAnalysis.h"
+#include "swift/SILAnalysis/PostOrderAnalysis.h"
 #include "swift/SILAnalysis/SimplifyInstruction.h"
 #include "swift/SILPasses/Transforms.h"
 #include "swift/SILPasses/Utils/Local.h"
@@ -38,30 +39,27 @@ using namespace swift;
 STATISTIC(NumSimplified, "Number of instructions simplified");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
+STATISTIC(NumVisited, "Number of instructions visited");
+STATISTIC(NumRevisited, "Number of instructions visited after being changed "
+                        "or having their operands changed");
+STATISTIC(NumWorklistBatches, "Number of worklist batches after the first");
 
 //===----------------------------------------------------------------------===//
 //                              Utility Methods
 //===----------------------------------------------------------------------===//
 
-/// addReachableCodeToWorklist - Walk the function in depth-first order, adding
-/// all reachable code to the worklist.
+/// addReachableCodeToWorklist - Walk the function in reverse post-order,
+/// adding all reachable code to the worklist.
 ///
 /// This has a couple of tricks to make the code faster and more powerful.  In
 /// particular, we DCE instructions as we go, to avoid adding them to the
 /// worklist (this significantly speeds up SILCombine on code where many
 /// instructions are dead or constant).
-void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
-  llvm::SmallVector<SILBasicBlock*, 256> Worklist;
+void SILCombiner::addReachableCodeToWorklist(SILFunction &F) {
   llvm::SmallVector<SILInstruction*, 128> InstrsForSILCombineWorklist;
-  llvm::SmallPtrSet<SILBasicBlock*, 64> Visited;
-
-  Worklist.push_back(BB);
-  do {
-    BB = Worklist.pop_back_val();
-
-    // We have now visited this block!  If we've already been here, ignore it.
-    if (!Visited.insert(BB).second) continue;
+  PostOrderFunctionInfo PO(&F);
 
+  for (SILBasicBlock *BB : PO.getReversePostOrder()) {
     for (SILBasicBlock::iterator BBI = BB->begin(), E = BB->end(); BBI != E; ) {
       SILInstruction *Inst = &*BBI;
       ++BBI;
@@ -86,17 +84,12 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
 
       InstrsForSILCombineWorklist.push_back(Inst);
     }
+  }
 
-    // Recursively visit successors.
-    for (auto SI = BB->succ_begin(), SE = BB->succ_end(); SI != SE; ++SI)
-      Worklist.push_back(*SI);
-  } while (!Worklist.empty());
-
-  // Once we've found all of the instructions to add to the worklist, add them
-  // in reverse order. This way SILCombine will visit from the top of the
-  // function down. This jives well with the way that it adds all uses of
-  // instructions to the worklist after doing a transformation, thus avoiding
-  // some N^2 behavior in pathological cases.
+  // Visiting the function from the top down, so that definitions are visited
+  // before their uses, jives well with the way that SILCombine adds all uses
+  // of instructions to the worklist after doing a transformation, thus
+  // avoiding some N^2 behavior in pathological cases.
   addInitialGroup(InstrsForSILCombineWorklist);
 }
 
@@ -105,11 +98,38 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
 //===----------------------------------------------------------------------===//
 
 void SILCombineWorklist::add(SILInstruction *I) {
-  if (!WorklistMap.insert(std::make_pair(I, Worklist.size())).second)
+  if (I->getWorklistSlot())
     return;
 
   DEBUG(llvm::dbgs() << "SC: ADD: " << *I << '\n');
   Worklist.push_back(I);
+  I->setWorklistSlot(Worklist.size());
+}
+
+void SILCombineWorklist::startNextBatch() {
+  // Drop the batch we are done with and the slots of removed instructions.
+  Worklist.erase(Worklist.begin(), Worklist.begin() + BatchEnd);
+  Worklist.erase(std::remove(Worklist.begin(), Worklist.end(), nullptr),
+                 Worklist.end());
+
+  // Blocks created after the initial group was added are visited last.
+  auto getBlockOrder = [&](SILInstruction *I) -> unsigned {
+    auto It = BlockOrder.find(I->getParent());
+    return It == BlockOrder.end() ? ~0U : It->second;
+  };
+  std::stable_sort(Worklist.begin(), Worklist.end(),
+                   [&](SILInstruction *LHS, SILInstruction *RHS) {
+                     return getBlockOrder(LHS) < getBlockOrder(RHS);
+                   });
+  for (unsigned i = 0, e = Worklist.size(); i != e; ++i)
+    Worklist[i]->setWorklistSlot(i + 1);
+
+  DEBUG(llvm::dbgs() << "SC: NEXT BATCH: " << Worklist.size()
+        << " instrs\n");
+  NextIndex = 0;
+  BatchEnd = Worklist.size();
+  ++NumBatches;
+  ++NumWorklistBatches;
 }
 
 bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
@@ -119,7 +139,7 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
                      << F.getName() << "\n");
 
   // Add reachable instructions to our worklist.
-  addReachableCodeToWorklist(&*F.begin());
+  addReachableCodeToWorklist(F);
 
   // Process until we run out of items in our worklist.
   while (!Worklist.isEmpty()) {
@@ -133,6 +153,10 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
     if (I == 0)
       continue;
 
+    ++NumVisited;
+    if (Worklist.isRevisiting())
+      ++NumRevisited;
+
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I)) {
       DEBUG(llvm::dbgs() << "SC: DCE: " << *I << '\n');
@@ -225,15 +249,15 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
 void SILCombineWorklist::addInitialGroup(ArrayRef<SILInstruction *> List) {
   assert(Worklist.empty() && "Worklist must be empty to add initial group");
   Worklist.reserve(List.size()+16);
-  WorklistMap.resize(List.size());
   DEBUG(llvm::dbgs() << "SC: ADDING: " << List.size()
         << " instrs to worklist\n");
-  while (!List.empty()) {
-    SILInstruction *I = List.back();
-    List = List.slice(0, List.size()-1);    
-    WorklistMap.insert(std::make_pair(I, Worklist.size()));
+  for (SILInstruction *I : List) {
+    BlockOrder.insert(std::make_pair(I->getParent(), BlockOrder.size()));
     Worklist.push_back(I);
-    }
+    I->setWorklistSlot(Worklist.size());
+  }
+  NextIndex = 0;
+  BatchEnd = Worklist.size();
 }
 
 bool SILCombiner::runOnFunction(SILFunction &F) {
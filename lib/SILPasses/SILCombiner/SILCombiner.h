@@ -34,17 +34,47 @@ namespace swift {
 class AliasAnalysis;
 
 /// This is the worklist management logic for SILCombine.
+///
+/// Instructions are visited in batches. The first batch is the initial group,
+/// in reverse post-order. Instructions added while a batch is visited form the
+/// next batch, which is visited in the reverse post-order of their blocks
+/// once the current one is done. Each instruction records its slot in the
+/// worklist, so it is queued at most once and can be removed in constant
+/// time.
 class SILCombineWorklist {
+  /// The instructions of the current batch, followed by the ones queued for
+  /// the next batch. Removed instructions leave a null slot behind.
   llvm::SmallVector<SILInstruction *, 256> Worklist;
-  llvm::DenseMap<SILInstruction *, unsigned> WorklistMap;
+
+  /// The index of the next instruction of the current batch to visit.
+  unsigned NextIndex = 0;
+
+  /// The end of the current batch in Worklist.
+  unsigned BatchEnd = 0;
+
+  /// The number of batches started since the initial group, i.e. how often
+  /// instructions may have been revisited.
+  unsigned NumBatches = 0;
+
+  /// The reverse post-order numbers of the blocks of the initial group, used
+  /// to order later batches.
+  llvm::DenseMap<SILBasicBlock *, unsigned> BlockOrder;
 
   void operator=(const SILCombineWorklist &RHS) = delete;
   SILCombineWorklist(const SILCombineWorklist &Worklist) = delete;
+
+  /// Make the instructions queued for the next batch the current batch.
+  void startNextBatch();
+
 public:
   SILCombineWorklist() {}
 
   /// Returns true if the worklist is empty.
-  bool isEmpty() const { return Worklist.empty(); }
+  bool isEmpty() const { return NextIndex == Worklist.size(); }
+
+  /// Returns true if the instructions currently being visited were added
+  /// after the initial group.
+  bool isRevisiting() const { return NumBatches != 0; }
 
   /// Add the specified instruction to the worklist if it isn't already in it.
   void add(SILInstruction *I);
@@ -57,27 +87,34 @@ public:
     add(I);
   }
 
-  /// Add the given list of instructions in reverse order to the worklist. This
-  /// routine assumes that the worklist is empty and the given list has no
-  /// duplicates.
+  /// Add the given list of instructions, which must be in reverse post-order,
+  /// as the first batch. This routine assumes that the worklist is empty and
+  /// the given list has no duplicates.
   void addInitialGroup(ArrayRef<SILInstruction *> List);
 
   // If I is in the worklist, remove it.
   void remove(SILInstruction *I) {
-    auto It = WorklistMap.find(I);
-    if (It == WorklistMap.end())
+    unsigned Slot = I->getWorklistSlot();
+    if (Slot == 0)
       return; // Not in worklist.
 
     // Don't bother moving everything down, just null out the slot. We will
     // check before we process any instruction if it is null.
-    Worklist[It->second] = nullptr;
-    WorklistMap.erase(It);
+    Worklist[Slot - 1] = nullptr;
+    I->setWorklistSlot(0);
   }
 
-  /// Remove the top element from the worklist.
+  /// Remove the next element from the worklist. This may return null for the
+  /// slot of a removed instruction.
   SILInstruction *removeOne() {
-    SILInstruction *I = Worklist.pop_back_val();
-    WorklistMap.erase(I);
+    if (NextIndex == BatchEnd) {
+      startNextBatch();
+      if (isEmpty())
+        return nullptr;
+    }
+    SILInstruction *I = Worklist[NextIndex++];
+    if (I)
+      I->setWorklistSlot(0);
     return I;
   }
 
@@ -97,13 +134,12 @@ public:
       add(UI->getUser());
   }
 
-  /// Check that the worklist is empty and nuke the backing store for the map if
-  /// it is large.
+  /// Check that the worklist is empty and nuke its backing store.
   void zap() {
-    assert(WorklistMap.empty() && "Worklist empty, but the map is not?");
-
-    // Do an explicit clear, this shrinks the map if needed.
-    WorklistMap.clear();
+    assert(isEmpty() && "Worklist is not empty?");
+    Worklist.clear();
+    NextIndex = BatchEnd = NumBatches = 0;
+    BlockOrder.clear();
   }
 };
 
@@ -285,7 +321,7 @@ private:
 
   /// Add reachable code to the worklist. Meant to be used when starting to
   /// process a new function.
-  void addReachableCodeToWorklist(SILBasicBlock *BB);
+  void addReachableCodeToWorklist(SILFunction &F);
 
   typedef SmallVector<SILInstruction*, 4> UserListTy;
 
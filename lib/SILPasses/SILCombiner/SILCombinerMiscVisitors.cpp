@@ -175,6 +175,11 @@ namespace {
 /// destroy_addr %0#1 : $*LogicValue
 /// dealloc_stack %0#0 : $*@local_storage LogicValue
 ///
+/// Copies out of such a container into another existential are allowed too.
+/// Since the dynamic type of the container is known, they are rewritten to
+/// initialize the destination with the same concrete type and copy the
+/// concrete value, avoiding the value witness calls of an existential copy.
+///
 /// At the same we time also look for dead alloc_stack live ranges that are only
 /// copied into.
 ///
@@ -204,6 +209,9 @@ struct AllocStackAnalyzer : SILInstructionVisitor<AllocStackAnalyzer> {
   /// Did we see any copies into the alloc stack.
   bool HaveSeenCopyInto = false;
 
+  /// The copies that initialize another existential from the alloc_stack.
+  llvm::SmallVector<CopyAddrInst *, 4> CopiesOut;
+
 public:
   AllocStackAnalyzer(AllocStackInst *ASI) : ASI(ASI) {}
 
@@ -220,6 +228,11 @@ public:
       if (!LegalUsers)
         break;
     }
+
+    // Copies out can only be rewritten if we know the concrete type of the
+    // container.
+    if (!CopiesOut.empty() && (!IEI || OEI))
+      LegalUsers = false;
   }
 
   /// Given an unhandled case, we have an illegal use for our optimization
@@ -264,6 +277,12 @@ public:
   }
 
   void visitCopyAddrInst(CopyAddrInst *I) {
+    if (I->getSrc().getDef() == ASI && I->getDest().getDef() != ASI &&
+        I->isInitializationOfDest()) {
+      CopiesOut.push_back(I);
+      return;
+    }
+
     if (IEI) {
       LegalUsers = false;
       return;
@@ -299,6 +318,21 @@ SILInstruction *SILCombiner::visitAllocStackInst(AllocStackInst *AS) {
   if (IEI && !OEI) {
     auto *ConcAlloc = Builder.createAllocStack(AS->getLoc(),
                                                 IEI->getLoweredConcreteType());
+
+    // Initialize the destination of each copy out with the concrete type and
+    // copy the concrete value into it.
+    for (auto *CA : Analyzer.CopiesOut) {
+      Builder.setInsertionPoint(CA);
+      auto *DestIEI = Builder.createInitExistentialAddr(CA->getLoc(),
+                                                 CA->getDest(),
+                                                 IEI->getFormalConcreteType(),
+                                                 IEI->getLoweredConcreteType(),
+                                                 IEI->getConformances());
+      Builder.createCopyAddr(CA->getLoc(), ConcAlloc->getAddressResult(),
+                             DestIEI, CA->isTakeOfSrc(), IsInitialization);
+      eraseInstFromFunction(*CA);
+    }
+
     SILValue(IEI, 0).replaceAllUsesWith(ConcAlloc->getAddressResult());
     eraseInstFromFunction(*IEI);
 
@@ -353,10 +353,12 @@ static SILInstruction* findUnexpectedBoxUse(SILValue Box,
 
     // For partial_apply, if we've been asked to examine the body, the
     // uses of the argument are okay there, and the partial_apply
-    // itself cannot escape, then everything is fine.
+    // itself cannot escape, then everything is fine. A @noescape closure
+    // cannot escape by definition, whatever it is passed to.
     if (auto *PAI = dyn_cast<PartialApplyInst>(User))
       if (examinePartialApply && checkPartialApplyBody(UI) &&
-          !partialApplyEscapes(PAI, /* examineApply = */ true)) {
+          (isNoEscapeClosure(PAI) ||
+           !partialApplyEscapes(PAI, /* examineApply = */ true))) {
         LocalElidedOperands.push_back(UI);
         continue;
       }
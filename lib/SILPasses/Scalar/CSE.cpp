@@ -13,6 +13,12 @@
 // This pass performs a simple dominator tree walk that eliminates trivially
 // redundant instructions.
 //
+// Instructions which read memory, like loads and calls of read-only functions,
+// are value numbered together with a memory generation. The generation is
+// bumped by every instruction which may write memory, and at every block with
+// more than one predecessor, so a read is only replaced by an identical read
+// of the same generation which dominates it.
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-cse"
@@ -38,6 +44,7 @@
 
 STATISTIC(NumSimplify, "Number of instructions simplified or DCE'd");
 STATISTIC(NumCSE,      "Number of instructions CSE'd");
+STATISTIC(NumCSELoad, "Number of memory reads CSE'd");
 
 using namespace swift;
 
@@ -214,7 +221,7 @@ public:
   }
 
   hash_code visitExistentialMetatypeInst(ExistentialMetatypeInst *X) {
-    return llvm::hash_combine(X->getKind(), X->getType());
+    return llvm::hash_combine(X->getKind(), X->getType(), X->getOperand());
   }
 
   hash_code visitObjCProtocolInst(ObjCProtocolInst *X) {
@@ -234,6 +241,10 @@ public:
     return llvm::hash_combine(X->getKind(), X->getType(), X->getOperand());
   }
 
+  hash_code visitLoadInst(LoadInst *X) {
+    return llvm::hash_combine(X->getKind(), X->getType(), X->getOperand());
+  }
+
   hash_code visitApplyInst(ApplyInst *X) {
     OperandValueArrayRef Operands(X->getAllOperands());
     return llvm::hash_combine(X->getKind(), X->getCallee(),
@@ -396,6 +407,24 @@ public:
   /// their lookup.
   ScopedHTType *AvailableValues;
 
+  typedef std::pair<ValueBase *, unsigned> ReadValueTy;
+  typedef llvm::ScopedHashTableVal<SimpleValue, ReadValueTy> ReadValueHTType;
+  typedef llvm::RecyclingAllocator<llvm::BumpPtrAllocator, ReadValueHTType>
+  ReadAllocatorTy;
+  typedef llvm::ScopedHashTable<SimpleValue, ReadValueTy,
+                                llvm::DenseMapInfo<SimpleValue>,
+                                ReadAllocatorTy> ReadScopedHTType;
+
+  /// AvailableReads - This scoped hash table contains the instructions which
+  /// read memory, together with the memory generation they were seen in. A
+  /// read can only be replaced by an available read of the current
+  /// generation.
+  ReadScopedHTType *AvailableReads;
+
+  /// CurrentGeneration - The generation of memory. It is bumped whenever
+  /// memory may have been written since the last instruction.
+  unsigned CurrentGeneration;
+
   SideEffectAnalysis *SEA;
 
   CSE(bool RunsOnHighLevelSil, SideEffectAnalysis *SEA)
@@ -405,6 +434,10 @@ public:
   
   bool canHandle(SILInstruction *Inst);
 
+  bool canHandleRead(SILInstruction *Inst);
+
+  bool mayWriteToMemory(SILInstruction *Inst);
+
 private:
   
   /// True if CSE is done on high-level SIL, i.e. semantic calls are not inlined
@@ -416,13 +449,15 @@ private:
   // that the scope gets popped when the NodeScope is destroyed.
   class NodeScope {
    public:
-    NodeScope(ScopedHTType *availableValues) : Scope(*availableValues) {}
+    NodeScope(ScopedHTType *availableValues, ReadScopedHTType *availableReads)
+        : Scope(*availableValues), ReadScope(*availableReads) {}
 
    private:
     NodeScope(const NodeScope &) = delete;
     void operator=(const NodeScope &) = delete;
 
     ScopedHTType::ScopeTy Scope;
+    ReadScopedHTType::ScopeTy ReadScope;
   };
 
   // StackNode - contains all the needed information to create a stack for doing
@@ -431,13 +466,18 @@ private:
   // children do not need to be store spearately.
   class StackNode {
    public:
-    StackNode(ScopedHTType *availableValues, DominanceInfoNode *n,
+    StackNode(ScopedHTType *availableValues, ReadScopedHTType *availableReads,
+              unsigned generation, DominanceInfoNode *n,
               DominanceInfoNode::iterator child,
               DominanceInfoNode::iterator end)
-        : Node(n), ChildIter(child), EndIter(end), Scopes(availableValues),
-      Processed(false) {}
+        : CurrentGeneration(generation), ChildGeneration(generation), Node(n),
+          ChildIter(child), EndIter(end),
+          Scopes(availableValues, availableReads), Processed(false) {}
 
     // Accessors.
+    unsigned currentGeneration() { return CurrentGeneration; }
+    unsigned childGeneration() { return ChildGeneration; }
+    void childGeneration(unsigned generation) { ChildGeneration = generation; }
     DominanceInfoNode *node() { return Node; }
     DominanceInfoNode::iterator childIter() { return ChildIter; }
     DominanceInfoNode *nextChild() {
@@ -454,6 +494,8 @@ private:
     void operator=(const StackNode &) = delete;
 
     // Members.
+    unsigned CurrentGeneration;
+    unsigned ChildGeneration;
     DominanceInfoNode *Node;
     DominanceInfoNode::iterator ChildIter;
     DominanceInfoNode::iterator EndIter;
@@ -462,6 +504,8 @@ private:
   };
 
   bool processNode(DominanceInfoNode *Node);
+
+  bool processRead(SILInstruction *Inst);
 };
 }  // end anonymous namespace
 
@@ -475,11 +519,15 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
   // Tables that the pass uses when walking the domtree.
   ScopedHTType AVTable;
   AvailableValues = &AVTable;
+  ReadScopedHTType ReadTable;
+  AvailableReads = &ReadTable;
+  CurrentGeneration = 0;
 
   bool Changed = false;
 
   // Process the root node.
-  nodesToProcess.push_back(new StackNode(AvailableValues, DT->getRootNode(),
+  nodesToProcess.push_back(new StackNode(AvailableValues, AvailableReads,
+                  CurrentGeneration, DT->getRootNode(),
                   DT->getRootNode()->begin(),
                   DT->getRootNode()->end()));
 
@@ -489,17 +537,23 @@ bool CSE::processFunction(SILFunction &Fm, DominanceInfo *DT) {
     // the node from the stack, and process it.
     StackNode *NodeToProcess = nodesToProcess.back();
 
+    // Initialize class members.
+    CurrentGeneration = NodeToProcess->currentGeneration();
+
     // Check if the node needs to be processed.
     if (!NodeToProcess->isProcessed()) {
       // Process the node.
       Changed |= processNode(NodeToProcess->node());
+      NodeToProcess->childGeneration(CurrentGeneration);
       NodeToProcess->process();
 
     } else if (NodeToProcess->childIter() != NodeToProcess->end()) {
       // Push the next child onto the stack.
       DominanceInfoNode *child = NodeToProcess->nextChild();
       nodesToProcess.push_back(
-          new StackNode(AvailableValues, child, child->begin(), child->end()));
+          new StackNode(AvailableValues, AvailableReads,
+                        NodeToProcess->childGeneration(), child,
+                        child->begin(), child->end()));
     } else {
       // It has been processed, and there are no more children to process,
       // so delete it and pop it off the stack.
@@ -515,6 +569,11 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   SILBasicBlock *BB = Node->getBlock();
   bool Changed = false;
 
+  // If the block has more than one predecessor, memory may have been written
+  // on a path which does not go through the dominator.
+  if (!BB->getSinglePredecessor())
+    ++CurrentGeneration;
+
   // See if any instructions in the block can be eliminated.  If so, do it.  If
   // not, add them to AvailableValues.
   for (SILBasicBlock::iterator I = BB->begin(), E = BB->end(); I != E;) {
@@ -544,9 +603,18 @@ bool CSE::processNode(DominanceInfoNode *Node) {
       continue;
     }
 
-    // If this is not a simple instruction that we can value number, skip it.
-    if (!canHandle(Inst))
+    // If this is not a simple instruction that we can value number, see if
+    // it is a read of memory, which can be value numbered until memory is
+    // written.
+    if (!canHandle(Inst)) {
+      if (canHandleRead(Inst)) {
+        Changed |= processRead(Inst);
+        continue;
+      }
+      if (mayWriteToMemory(Inst))
+        ++CurrentGeneration;
       continue;
+    }
 
     // If an instruction can be handled here, then it must also be handled
     // in isIdenticalTo, otherwise looking up a key in the map with fail to
@@ -574,6 +642,27 @@ bool CSE::processNode(DominanceInfoNode *Node) {
   return Changed;
 }
 
+bool CSE::processRead(SILInstruction *Inst) {
+  assert(Inst->isIdenticalTo(Inst) &&
+         "Inst must match itself for map to work");
+
+  // Only a read of the current generation sees the same memory.
+  ReadValueTy Read = AvailableReads->lookup(Inst);
+  if (Read.first && Read.second == CurrentGeneration) {
+    DEBUG(llvm::dbgs() << "SILCSE CSE READ: " << *Inst << "  to: "
+                       << *Read.first << '\n');
+    Inst->replaceAllUsesWith(Read.first);
+    Inst->eraseFromParent();
+    ++NumCSELoad;
+    return true;
+  }
+
+  AvailableReads->insert(Inst, ReadValueTy(Inst, CurrentGeneration));
+  DEBUG(llvm::dbgs() << "SILCSE Adding to read table: " << *Inst
+                     << " in generation " << CurrentGeneration << "\n");
+  return false;
+}
+
 bool CSE::canHandle(SILInstruction *Inst) {
   if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
     if (!AI->mayReadOrWriteMemory())
@@ -673,6 +762,45 @@ bool CSE::canHandle(SILInstruction *Inst) {
   }
 }
 
+/// Returns true if \p Inst only reads memory, and can be replaced by an
+/// identical instruction if memory was not written in between.
+bool CSE::canHandleRead(SILInstruction *Inst) {
+  if (isa<LoadInst>(Inst))
+    return true;
+
+  // The metatype of an existential in memory is loaded from the existential.
+  if (auto *EMI = dyn_cast<ExistentialMetatypeInst>(Inst))
+    return EMI->getOperand().getType().isAddress();
+
+  // Calls of functions which only read memory. As for read-none calls, the
+  // function may not retain anything either.
+  if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
+    if (!AI->mayReadOrWriteMemory())
+      return false;
+    SideEffectAnalysis::FunctionEffects Effects;
+    SEA->getEffects(Effects, AI);
+    auto MB = Effects.getMemBehavior(RetainObserveKind::ObserveRetains);
+    return MB == SILInstruction::MemoryBehavior::MayRead;
+  }
+  return false;
+}
+
+/// Returns true if \p Inst may write memory which an available read observes.
+bool CSE::mayWriteToMemory(SILInstruction *Inst) {
+  // Retains only change reference counts, which no read looks at.
+  if (isa<StrongRetainInst>(Inst) || isa<RetainValueInst>(Inst))
+    return false;
+
+  if (auto *AI = dyn_cast<ApplyInst>(Inst)) {
+    SideEffectAnalysis::FunctionEffects Effects;
+    SEA->getEffects(Effects, AI);
+    auto MB = Effects.getMemBehavior(RetainObserveKind::ObserveRetains);
+    return MB != SILInstruction::MemoryBehavior::None &&
+           MB != SILInstruction::MemoryBehavior::MayRead;
+  }
+  return Inst->mayWriteToMemory();
+}
+
 namespace {
 class SILCSE : public SILFunctionTransform {
   
@@ -55,6 +55,12 @@
 // local. Either:
 // (1) Forward propagate: copy src -> dest; deinit(dest)
 // (2) Backward propagate: init(src); copy src -> dest
+//
+// If neither applies, but the destroy of the source can be hoisted up to a
+// copy, then the copy and the destroy are combined into a [take] copy:
+// (3) Take: copy src -> dest; destroy(src) => copy [take] src -> dest
+// For address-only types this replaces an initializeWithCopy and a destroy
+// value witness call with a single initializeWithTake.
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "copy-forwarding"
@@ -75,6 +81,8 @@ STATISTIC(NumCopyNRVO, "Number of copies removed via named return value opt.");
 STATISTIC(NumCopyForward, "Number of copies removed via forward propagation.");
 STATISTIC(NumCopyBackward,
           "Number of copies removed via backward propagation.");
+STATISTIC(NumCopyTake,
+          "Number of copies and destroys combined into a [take] copy.");
 
 using namespace swift;
 
@@ -408,6 +416,7 @@ protected:
   bool backwardPropagateCopy(CopyAddrInst *CopyInst,
                              SmallPtrSetImpl<SILInstruction*> &DestUserInsts);
   bool hoistDestroy(SILInstruction *DestroyPoint, SILLocation DestroyLoc);
+  void convertCopyToTake(CopyAddrInst *CopyInst);
 
   bool isSourceDeadAtCopy(CopyAddrInst *);
   bool areCopyDestUsersDominatedBy(CopyAddrInst *,
@@ -793,8 +802,18 @@ bool CopyForwarding::backwardPropagateCopy(
   return true;
 }
 
+/// Combine a copy of CurrentDef with the destroy of CurrentDef which has been
+/// hoisted up to it. The caller removes the destroy.
+void CopyForwarding::convertCopyToTake(CopyAddrInst *CopyInst) {
+  DEBUG(llvm::dbgs() << "  Combining destroy into copy:" << *CopyInst);
+  CopyInst->setIsTakeOfSrc(IsTake);
+  HasChanged = true;
+  ++NumCopyTake;
+}
+
 /// Attempt to hoist a destroy point up to the last use. If the last use is a
-/// copy, eliminate both the copy and the destroy.
+/// copy, eliminate both the copy and the destroy, or if the copy cannot be
+/// forwarded, combine the destroy into the copy.
 ///
 /// The copy will be eliminated if the original is not accessed between the
 /// point of copy and the original's destruction.
@@ -805,8 +824,8 @@ bool CopyForwarding::backwardPropagateCopy(
 /// ...                    // no access to Def
 /// destroy_addr Def
 ///
-/// Return true if a destroy was inserted, forwarded from a copy, or the
-/// block was marked dead-in.
+/// Return true if a destroy was inserted, forwarded from a copy, combined into
+/// a copy, or the block was marked dead-in.
 bool CopyForwarding::hoistDestroy(SILInstruction *DestroyPoint,
                                   SILLocation DestroyLoc) {
   if (!EnableDestroyHoisting)
@@ -834,6 +853,10 @@ bool CopyForwarding::hoistDestroy(SILInstruction *DestroyPoint,
         // all uses of the copy's value.
         if (propagateCopy(CopyInst))
           return true;
+        // Otherwise the copy is the last use of CurrentDef, so it can take
+        // the value instead. This is always profitable.
+        convertCopyToTake(CopyInst);
+        return true;
       }
     }
     // We reached a user of CurrentDef. If we haven't seen anything significant,
@@ -21,6 +21,10 @@
 // escape or is used in a way that could cause side effects. If both of those
 // conditions apply, the alloc_ref and its entire use graph is eliminated.
 //
+// Arrays and strings created by semantics calls are removed in the same way if
+// their only uses are stores to their storage, releases, and array queries
+// whose results are not used.
+//
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "dead-object-elim"
@@ -410,6 +414,28 @@ addStore(StoreInst *Store, IndexTrieNode *AddressNode) {
   StoredLocations[AddressNode].push_back(Store);
 }
 
+// Returns true if \p User is an array semantics call which takes the array
+// passed in \p Op as self, only reads the array and has no other effects, and
+// whose result is not used. Such a call does not keep a dead array alive.
+static bool isDeadArrayQuery(SILInstruction *User, Operand *Op) {
+  ArraySemanticsCall Call(User);
+  if (!Call || !Call.hasSelf() || &Call.getSelfOperand() != Op)
+    return false;
+
+  switch (Call.getKind()) {
+  default:
+    // The bounds checks may trap and all other calls may write memory.
+    return false;
+  case ArrayCallKind::kArrayPropsIsNative:
+  case ArrayCallKind::kArrayPropsIsNativeTypeChecked:
+  case ArrayCallKind::kGetCount:
+  case ArrayCallKind::kGetCapacity:
+  case ArrayCallKind::kGetArrayOwner:
+    break;
+  }
+  return User->use_empty();
+}
+
 // Collect instructions that either initialize or release any values at the
 // object defined by defInst.
 //
@@ -491,6 +517,11 @@ recursivelyCollectInteriorUses(ValueBase *DefInst,
       }
       continue;
     }
+    // Queries of a dead array's properties whose results are not used.
+    if (!IsInteriorAddress && isDeadArrayQuery(User, Op)) {
+      AllUsers.insert(User);
+      continue;
+    }
     // Otherwise bail.
     DEBUG(llvm::dbgs() << "        Found an escaping use: " << *User);
     return false;
@@ -651,15 +682,72 @@ static bool removeAndReleaseArray(SILValue NewArrayValue) {
   return true;
 }
 
+// Release the arguments which are passed @owned to the apply \p AI, which is
+// about to be deleted.
+static void releaseOwnedArguments(ApplyInst *AI) {
+  auto Params = AI->getSubstCalleeType()->getParameters();
+  SILBuilder B(AI);
+  for (unsigned i = 0, e = AI->getNumArguments(); i != e; ++i) {
+    SILValue Arg = AI->getArgument(i);
+    if (!Params[i].isConsumed() || Arg.getType().isTrivial(AI->getModule()))
+      continue;
+    if (Arg.getType().isAddress())
+      B.createDestroyAddr(AI->getLoc(), Arg);
+    else
+      B.createReleaseValue(AI->getLoc(), Arg);
+  }
+}
+
+// Attempt to remove the uses of a value which is returned by a side effect free
+// call and is not used other than being retained, released or queried with
+// its result being ignored.
+//
+// This handles the empty or repeated value arrays created by array.init and
+// strings created by the string semantics calls.
+static bool removeDeadValue(SILValue NewValue) {
+  DeadObjectAnalysis DeadValue(NewValue);
+  if (!DeadValue.analyze())
+    return false;
+
+  // A store into the value means that its storage is used, bail.
+  bool HasStores = false;
+  DeadValue.visitStoreLocations([&](ArrayRef<StoreInst*>){ HasStores = true; });
+  if (HasStores)
+    return false;
+
+  removeInstructions(DeadValue.getAllUsers());
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                            Function Processing
 //===----------------------------------------------------------------------===//
 
+/// Is this a call to a string operation which creates a new string and has no
+/// other observable side effect?
+static bool isStringAllocatingApply(SILInstruction *Inst) {
+  auto *AI = dyn_cast<ApplyInst>(Inst);
+  if (!AI || AI->hasIndirectResult())
+    return false;
+  SILFunction *Callee = AI->getCalleeFunction();
+  if (!Callee || !Callee->hasDefinedSemantics())
+    return false;
+  StringRef Semantics = Callee->getSemanticsString();
+  return Semantics == "string.makeUTF8" || Semantics == "string.makeUTF16" ||
+         Semantics == "string.concat";
+}
+
 /// Does this instruction perform object allocation with no other observable
 /// side effect?
 static bool isAllocatingApply(SILInstruction *Inst) {
   ArraySemanticsCall ArrayAlloc(Inst);
-  return ArrayAlloc.getKind() == ArrayCallKind::kArrayUninitialized;
+  switch (ArrayAlloc.getKind()) {
+  case ArrayCallKind::kArrayUninitialized:
+  case ArrayCallKind::kArrayInit:
+    return true;
+  default:
+    return isStringAllocatingApply(Inst);
+  }
 }
 
 namespace {
@@ -775,7 +863,23 @@ bool DeadObjectElimination::processAllocStack(AllocStackInst *ASI) {
 }
 
 bool DeadObjectElimination::processAllocApply(ApplyInst *AI) {
-  // Currently only handle array.uninitialized
+  // Arrays created by array.init and strings don't expose their storage, so
+  // only the uses of the returned value need to be removed.
+  if (ArraySemanticsCall(AI).getKind() == ArrayCallKind::kArrayInit ||
+      isStringAllocatingApply(AI)) {
+    if (!removeDeadValue(AI))
+      return false;
+
+    DEBUG(llvm::dbgs() << "    Success! Eliminating apply of dead value.\n");
+
+    releaseOwnedArguments(AI);
+    assert(AI->use_empty() && "All users should have been removed.");
+    recursivelyDeleteTriviallyDeadInstructions(AI, true);
+    ++DeadAllocApplyEliminated;
+    return true;
+  }
+
+  // Otherwise handle array.uninitialized.
   if (ArraySemanticsCall(AI).getKind() != ArrayCallKind::kArrayUninitialized)
     return false;
 
@@ -89,8 +89,15 @@ using swift::MemLocation;
 static llvm::cl::opt<bool> EnableLocalStoreDSE("enable-local-store-dse",
                                                llvm::cl::init(false));
 
+static llvm::cl::opt<unsigned> MaxDSELocations(
+    "dse-max-locations", llvm::cl::init(8192),
+    llvm::cl::desc("Skip dead store elimination on functions accessing more "
+                   "memory locations than this"));
+
 STATISTIC(NumDeadStores, "Number of dead stores removed");
 STATISTIC(NumPartialDeadStores, "Number of partial dead stores removed");
+STATISTIC(NumFunctionsSkipped,
+          "Number of functions skipped for accessing too many locations");
 
 //===----------------------------------------------------------------------===//
 //                             Utility Functions
@@ -153,24 +160,24 @@ public:
   /// Keep the number of MemLocations in the LocationVault.
   unsigned MemLocationNum;
 
-  /// A bit vector for which the ith bit represents the ith MemLocation in
+  /// A set for which the ith bit represents the ith MemLocation in
   /// MemLocationVault. If the bit is set, then the location currently has an
   /// upward visible store.
-  llvm::BitVector WriteSetOut;
+  MemLocationBitSet WriteSetOut;
 
   /// If WriteSetIn changes while processing a basicblock, then all its
   /// predecessors needs to be rerun.
-  llvm::BitVector WriteSetIn;
+  MemLocationBitSet WriteSetIn;
 
-  /// A bit vector for which the ith bit represents the ith MemLocation in
+  /// A set for which the ith bit represents the ith MemLocation in
   /// MemLocationVault. If the bit is set, then the current basic block
   /// generates an upward visible store.
-  llvm::BitVector BBGenSet;
+  MemLocationBitSet BBGenSet;
 
-  /// A bit vector for which the ith bit represents the ith MemLocation in
+  /// A set for which the ith bit represents the ith MemLocation in
   /// MemLocationVault. If the bit is set, then the current basic block
   /// kills an upward visible store.
-  llvm::BitVector BBKillSet;
+  MemLocationBitSet BBKillSet;
 
   /// The dead stores in the current basic block.
   llvm::DenseSet<SILInstruction *> DeadStores;
@@ -201,12 +208,8 @@ public:
     // However, by doing so, we can only eliminate the dead stores after the
     // data flow stablizes.
     //
-    WriteSetIn.resize(MemLocationNum, true);
-    WriteSetOut.resize(MemLocationNum, false);
-
-    // GenSet and KillSet initially empty.
-    BBGenSet.resize(MemLocationNum, false);
-    BBKillSet.resize(MemLocationNum, false);
+    // WriteSetOut, GenSet and KillSet are initially empty.
+    WriteSetIn = MemLocationBitSet::getAll();
   }
 
   /// Check whether the WriteSetIn has changed. If it does, we need to rerun
@@ -230,7 +233,7 @@ bool BBState::updateWriteSetIn() {
   return Changed;
 }
 
-void BBState::clearMemLocations() { WriteSetOut.reset(); }
+void BBState::clearMemLocations() { WriteSetOut.clear(); }
 
 void BBState::startTrackingMemLocation(unsigned bit) { WriteSetOut.set(bit); }
 
@@ -253,7 +256,9 @@ void BBState::initialize(const BBState &Succ) { WriteSetOut = Succ.WriteSetIn; }
 /// possible that 2 MemLocations with different bases that happen to be the
 /// same object and field. In such case, we would miss a dead store
 /// opportunity. But this happens less often with canonicalization.
-void BBState::intersect(const BBState &Succ) { WriteSetOut &= Succ.WriteSetIn; }
+void BBState::intersect(const BBState &Succ) {
+  WriteSetOut.intersect(Succ.WriteSetIn);
+}
 
 //===----------------------------------------------------------------------===//
 //                          Top Level Implementation
@@ -294,6 +299,9 @@ class DSEContext {
   /// Contains a map between location to their index in the MemLocationVault.
   MemLocationIndexMap LocToBitIndex;
 
+  /// The locations in the MemLocationVault, grouped by base.
+  MemLocationBaseMap BaseToLocIndices;
+
   /// Return the BBState for the basic block this basic block belongs to.
   BBState *getBBLocState(SILBasicBlock *B) { return BBToLocState[B]; }
 
@@ -433,9 +441,8 @@ bool DSEContext::processBasicBlockWithGenKillSet(SILBasicBlock *BB) {
 
   // Compute the WriteSetOut at the beginning of the basic block.
   BBState *S = getBBLocState(BB);
-  llvm::BitVector T = S->BBKillSet;
-  S->WriteSetOut &= T.flip();
-  S->WriteSetOut |= S->BBGenSet;
+  S->WriteSetOut.subtract(S->BBKillSet);
+  S->WriteSetOut.unite(S->BBGenSet);
 
   // If WriteSetIn changes, then keep iterating until reached a fixed
   // point.
@@ -491,22 +498,18 @@ void DSEContext::invalidateMemLocationBase(SILInstruction *I,
   // If this instruction defines the base of a location, then we need to
   // invalidate any locations with the same base.
   BBState *S = getBBLocState(I);
-  if (BuildGenKillSet) {
-    for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-      if (MemLocationVault[i].getBase().getDef() != I)
+  for (unsigned r = 0, e = I->getNumTypes(); r != e; ++r) {
+    auto Iter = BaseToLocIndices.find(SILValue(I, r));
+    if (Iter == BaseToLocIndices.end())
+      continue;
+    for (unsigned i : Iter->second) {
+      if (BuildGenKillSet) {
+        S->BBGenSet.reset(i);
+        S->BBKillSet.set(i);
         continue;
-      S->BBGenSet.reset(i);
-      S->BBKillSet.set(i);
+      }
+      S->stopTrackingMemLocation(i);
     }
-    return;
-  }
-
-  for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-    if (!S->WriteSetOut.test(i))
-      continue;
-    if (MemLocationVault[i].getBase().getDef() != I)
-      continue;
-    S->stopTrackingMemLocation(i);
   }
 }
 
@@ -514,15 +517,24 @@ void DSEContext::updateWriteSetForRead(BBState *S, unsigned bit) {
   // Remove any may/must-aliasing stores to the MemLocation, as they cant be
   // used to kill any upward visible stores due to the intefering load.
   MemLocation &R = MemLocationVault[bit];
-  for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-    if (!S->isTrackingMemLocation(i))
-      continue;
-    MemLocation &L = MemLocationVault[i];
-    if (!L.isMayAliasMemLocation(R, AA))
-      continue;
-    DEBUG(llvm::dbgs() << "Loc Removal: " << MemLocationVault[i].getBase()
-                       << "\n");
-    S->stopTrackingMemLocation(i);
+  for (auto &Group : BaseToLocIndices) {
+    bool BaseMayAlias = false;
+    for (unsigned i : Group.second) {
+      if (!S->isTrackingMemLocation(i))
+        continue;
+      MemLocation &L = MemLocationVault[i];
+      if (L.hasNonEmptySymmetricPathDifference(R))
+        continue;
+      // Only ask alias analysis about bases with a candidate location, and
+      // only once per base.
+      if (!BaseMayAlias) {
+        if (AA->isNoAlias(Group.first, R.getBase()))
+          break;
+        BaseMayAlias = true;
+      }
+      DEBUG(llvm::dbgs() << "Loc Removal: " << L.getBase() << "\n");
+      S->stopTrackingMemLocation(i);
+    }
   }
 }
 
@@ -533,14 +545,17 @@ void DSEContext::updateGenKillSetForRead(BBState *S, unsigned bit) {
   // Even though, MemLocations are canonicalized, we still need to consult
   // alias analysis to determine whether 2 MemLocations are disjointed.
   MemLocation &R = MemLocationVault[bit];
-  for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-    MemLocation &L = MemLocationVault[i];
-    if (!L.isMayAliasMemLocation(R, AA))
+  for (auto &Group : BaseToLocIndices) {
+    if (AA->isNoAlias(Group.first, R.getBase()))
       continue;
-    S->BBGenSet.reset(i);
-    // Update the kill set, we need to be conservative about kill set. Kill set
-    // kills any MemLocation that this currently MemLocation mayalias.
-    S->BBKillSet.set(i);
+    for (unsigned i : Group.second) {
+      if (MemLocationVault[i].hasNonEmptySymmetricPathDifference(R))
+        continue;
+      S->BBGenSet.reset(i);
+      // Update the kill set, we need to be conservative about kill set. Kill
+      // set kills any MemLocation that this currently MemLocation mayalias.
+      S->BBKillSet.set(i);
+    }
   }
 }
 
@@ -548,17 +563,22 @@ bool DSEContext::updateWriteSetForWrite(BBState *S, unsigned bit) {
   // If a tracked store must aliases with this store, then this store is dead.
   bool IsDead = false;
   MemLocation &R = MemLocationVault[bit];
-  for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-    if (!S->isTrackingMemLocation(i))
-      continue;
-    // If 2 locations may alias, we can still keep both stores.
-    MemLocation &L = MemLocationVault[i];
-    if (!L.isMustAliasMemLocation(R, AA))
-      continue;
-    IsDead = true;
+  for (auto &Group : BaseToLocIndices) {
+    for (unsigned i : Group.second) {
+      if (!S->isTrackingMemLocation(i))
+        continue;
+      // If 2 locations may alias, we can still keep both stores.
+      if (!MemLocationVault[i].hasIdenticalProjectionPath(R))
+        continue;
+      // All the locations in the group share the base, so this is the only
+      // candidate in it.
+      IsDead = AA->isMustAlias(Group.first, R.getBase());
+      break;
+    }
     // No need to check the rest of the upward visible stores as this store
     // is dead.
-    break;
+    if (IsDead)
+      break;
   }
 
   // Track this new store.
@@ -753,12 +773,18 @@ void DSEContext::processStoreInst(SILInstruction *I, bool BuildGenKillSet) {
 void DSEContext::processDebugValueAddrInst(SILInstruction *I) {
   BBState *S = getBBLocState(I);
   SILValue Mem = cast<DebugValueAddrInst>(I)->getOperand();
-  for (unsigned i = 0; i < S->WriteSetOut.size(); ++i) {
-    if (!S->isTrackingMemLocation(i))
-      continue;
-    if (AA->isNoAlias(Mem, MemLocationVault[i].getBase()))
-      continue;
-    getBBLocState(I)->stopTrackingMemLocation(i);
+  for (auto &Group : BaseToLocIndices) {
+    bool BaseMayAlias = false;
+    for (unsigned i : Group.second) {
+      if (!S->isTrackingMemLocation(i))
+        continue;
+      if (!BaseMayAlias) {
+        if (AA->isNoAlias(Mem, Group.first))
+          break;
+        BaseMayAlias = true;
+      }
+      S->stopTrackingMemLocation(i);
+    }
   }
 }
 
@@ -767,11 +793,13 @@ void DSEContext::processUnknownReadMemInst(SILInstruction *I,
   BBState *S = getBBLocState(I);
   // Update the gen kill set.
   if (BuildGenKillSet) {
-    for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-      if (!AA->mayReadFromMemory(I, MemLocationVault[i].getBase()))
+    for (auto &Group : BaseToLocIndices) {
+      if (!AA->mayReadFromMemory(I, Group.first))
         continue;
-      S->BBKillSet.set(i);
-      S->BBGenSet.reset(i);
+      for (unsigned i : Group.second) {
+        S->BBKillSet.set(i);
+        S->BBGenSet.reset(i);
+      }
     }
     return;
   }
@@ -779,12 +807,18 @@ void DSEContext::processUnknownReadMemInst(SILInstruction *I,
   // We do not know what this instruction does or the memory that it *may*
   // touch. Hand it to alias analysis to see whether we need to invalidate
   // any MemLocation.
-  for (unsigned i = 0; i < S->MemLocationNum; ++i) {
-    if (!S->isTrackingMemLocation(i))
-      continue;
-    if (!AA->mayReadFromMemory(I, MemLocationVault[i].getBase()))
-      continue;
-    getBBLocState(I)->stopTrackingMemLocation(i);
+  for (auto &Group : BaseToLocIndices) {
+    bool MayRead = false;
+    for (unsigned i : Group.second) {
+      if (!S->isTrackingMemLocation(i))
+        continue;
+      if (!MayRead) {
+        if (!AA->mayReadFromMemory(I, Group.first))
+          break;
+        MayRead = true;
+      }
+      S->stopTrackingMemLocation(i);
+    }
   }
 }
 
@@ -846,6 +880,16 @@ void DSEContext::run() {
   MemLocation::enumerateMemLocations(*F, MemLocationVault, LocToBitIndex,
                                      TypeExpansionVault);
 
+  // The cost of the data flow grows with the number of locations. Rather
+  // than let a huge function dominate compile time, leave it alone.
+  if (MemLocationVault.size() > MaxDSELocations) {
+    DEBUG(llvm::dbgs() << "Too many locations (" << MemLocationVault.size()
+                       << "), skipping " << F->getName() << "\n");
+    ++NumFunctionsSkipped;
+    return;
+  }
+  MemLocation::groupMemLocationsByBase(MemLocationVault, BaseToLocIndices);
+
   // For all basic blocks in the function, initialize a BB state. Since we
   // know all the locations accessed in this function, we can resize the bit
   // vector to the approproate size.
@@ -0,0 +1,114 @@
+//===------- NonAtomicRC.cpp - Use non-atomic reference counting ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nonatomic-rc"
+#include "swift/SILPasses/Passes.h"
+#include "swift/SILPasses/Transforms.h"
+#include "swift/SILAnalysis/EscapeAnalysis.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SIL/SILModule.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumNonAtomicRC, "Number of reference counting operations made "
+                          "non-atomic");
+
+using namespace swift;
+
+/// Returns true if \p I is a reference counting instruction which has a
+/// non-atomic variant.
+static bool hasNonAtomicVariant(SILInstruction *I) {
+  switch (I->getKind()) {
+  case ValueKind::StrongRetainInst:
+  case ValueKind::StrongReleaseInst:
+  case ValueKind::RetainValueInst:
+  case ValueKind::ReleaseValueInst:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Returns true if the object referenced by the operand of \p RCI can only
+/// be reached from the current thread.
+static bool isThreadLocal(RefCountingInst *RCI,
+                          EscapeAnalysis::ConnectionGraph *ConGraph,
+                          EscapeAnalysis *EA) {
+  SILValue Op = RCI->getOperand(0);
+
+  // Only handle single references. Aggregates may contain references which
+  // are not represented by a single node.
+  if (!Op.getType().hasReferenceSemantics())
+    return false;
+
+  auto *Node = ConGraph->getNode(Op, EA);
+  if (!Node)
+    return false;
+  return !Node->escapes();
+}
+
+namespace {
+
+/// Sets the [nonatomic] flag on reference counting instructions of objects
+/// which don't escape from the current function, and therefore cannot be
+/// accessed by another thread.
+///
+/// If the module is compiled with -assume-single-threaded, all reference
+/// counting instructions are made non-atomic.
+class NonAtomicRC : public SILFunctionTransform {
+
+  void run() override {
+    SILFunction *F = getFunction();
+    DEBUG(llvm::dbgs() << "** NonAtomicRC in " << F->getName() << " **\n");
+
+    bool AssumeSingleThreaded =
+        F->getModule().getOptions().AssumeSingleThreaded;
+
+    EscapeAnalysis *EA = nullptr;
+    EscapeAnalysis::ConnectionGraph *ConGraph = nullptr;
+    if (!AssumeSingleThreaded) {
+      EA = PM->getAnalysis<EscapeAnalysis>();
+      ConGraph = EA->getConnectionGraph(F);
+      if (!ConGraph)
+        return;
+    }
+
+    bool Changed = false;
+    for (SILBasicBlock &BB : *F) {
+      for (SILInstruction &I : BB) {
+        if (!hasNonAtomicVariant(&I))
+          continue;
+        auto *RCI = cast<RefCountingInst>(&I);
+        if (RCI->isNonAtomic())
+          continue;
+        if (!AssumeSingleThreaded && !isThreadLocal(RCI, ConGraph, EA))
+          continue;
+
+        DEBUG(llvm::dbgs() << "  Making non-atomic: " << I);
+        RCI->setNonAtomic();
+        NumNonAtomicRC++;
+        Changed = true;
+      }
+    }
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "NonAtomicRC"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createNonAtomicRC() {
+  return new NonAtomicRC();
+}
@@ -87,7 +87,6 @@
 #include "swift/SILPasses/Utils/CFG.h"
 #include "swift/SILPasses/Utils/Local.h"
 #include "swift/SILPasses/Utils/SILSSAUpdater.h"
-#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Statistic.h"
@@ -98,6 +97,13 @@
 using namespace swift;
 
 STATISTIC(NumForwardedLoads, "Number of loads forwarded");
+STATISTIC(NumFunctionsSkipped,
+          "Number of functions skipped for accessing too many locations");
+
+static llvm::cl::opt<unsigned> MaxRLELocations(
+    "rle-max-locations", llvm::cl::init(8192),
+    llvm::cl::desc("Skip redundant load elimination on functions accessing "
+                   "more memory locations than this"));
 
 //===----------------------------------------------------------------------===//
 //                             Utility Functions
@@ -166,14 +172,14 @@ class BBState {
   /// The basic block that we are optimizing.
   SILBasicBlock *BB;
 
-  /// A bit vector for which the ith bit represents the ith MemLocation in
+  /// A set for which the ith bit represents the ith MemLocation in
   /// MemLocationVault. If the bit is set, then the location currently has an
   /// downward visible value.
-  llvm::BitVector ForwardSetIn;
+  MemLocationBitSet ForwardSetIn;
 
   /// If ForwardSetOut changes while processing a basicblock, then all its
   /// successors need to be rerun.
-  llvm::BitVector ForwardSetOut;
+  MemLocationBitSet ForwardSetOut;
 
   /// This is map between MemLocations and their available values at the
   /// beginning of this basic block.
@@ -199,7 +205,7 @@ class BBState {
   }
 
   /// Merge in the state of an individual predecessor.
-  void mergePredecessorState(BBState &OtherState);
+  void mergePredecessorState(RLEContext &Ctx, BBState &OtherState);
 
   /// MemLocation read has been extracted, expanded and mapped to the bit
   /// position in the bitvector. process it using the bit position.
@@ -231,7 +237,7 @@ class BBState {
 public:
   BBState() = default;
 
-  void init(SILBasicBlock *NewBB, unsigned bitcnt, bool reachable) {
+  void init(SILBasicBlock *NewBB, bool reachable) {
     BB = NewBB;
     // The initial state of ForwardSetOut should be all 1's. Otherwise the
     // dataflow solution could be too conservative.
@@ -246,8 +252,8 @@ public:
     // However, by doing so, we can only do the data forwarding after the
     // data flow stablizes.
     //
-    ForwardSetIn.resize(bitcnt, false);
-    ForwardSetOut.resize(bitcnt, reachable);
+    if (reachable)
+      ForwardSetOut = MemLocationBitSet::getAll();
   }
 
   /// Returns the current basic block we are processing.
@@ -318,6 +324,9 @@ class RLEContext {
   /// Use for fast lookup.
   llvm::DenseMap<MemLocation, unsigned> LocToBitIndex;
 
+  /// The locations in the MemLocationVault, grouped by base.
+  MemLocationBaseMap BaseToLocIndices;
+
   /// A map from each BasicBlock to its BBState.
   llvm::SmallDenseMap<SILBasicBlock *, BBState, 4> BBToLocState;
 
@@ -335,6 +344,14 @@ public:
 
   bool run();
 
+  /// Returns the number of locations in the MemLocationVault.
+  unsigned getNumMemLocations() const { return MemLocationVault.size(); }
+
+  /// Returns the locations in the MemLocationVault, grouped by base.
+  const MemLocationBaseMap &getBaseToLocIndices() const {
+    return BaseToLocIndices;
+  }
+
   /// Returns the alias analysis we will use during all computations.
   AliasAnalysis *getAA() const { return AA; }
 
@@ -383,7 +400,7 @@ void BBState::stopTrackingMemLocation(unsigned bit) {
 }
 
 void BBState::clearMemLocations() {
-  ForwardSetIn.reset();
+  ForwardSetIn.clear();
   ForwardValIn.clear();
 }
 
@@ -484,14 +501,24 @@ void BBState::updateForwardSetForWrite(RLEContext &Ctx, unsigned bit,
   // This is a store. Invalidate any Memlocation that this location may
   // alias, as their value can no longer be forwarded.
   MemLocation &R = Ctx.getMemLocation(bit);
-  for (unsigned i = 0; i < ForwardSetIn.size(); ++i) {
-    if (!isTrackingMemLocation(i))
-      continue;
-    MemLocation &L = Ctx.getMemLocation(i);
-    if (!L.isMayAliasMemLocation(R, Ctx.getAA()))
-      continue;
-    // MayAlias, invaliate the MemLocation.
-    stopTrackingMemLocation(i);
+  for (auto &Group : Ctx.getBaseToLocIndices()) {
+    bool BaseMayAlias = false;
+    for (unsigned i : Group.second) {
+      if (!isTrackingMemLocation(i))
+        continue;
+      MemLocation &L = Ctx.getMemLocation(i);
+      if (L.hasNonEmptySymmetricPathDifference(R))
+        continue;
+      // Only ask alias analysis about bases with a candidate location, and
+      // only once per base.
+      if (!BaseMayAlias) {
+        if (Ctx.getAA()->isNoAlias(Group.first, R.getBase()))
+          break;
+        BaseMayAlias = true;
+      }
+      // MayAlias, invaliate the MemLocation.
+      stopTrackingMemLocation(i);
+    }
   }
 
   // Start tracking this MemLocation.
@@ -570,18 +597,23 @@ void BBState::processLoadInst(RLEContext &Ctx, LoadInst *LI, bool PF) {
 
 void BBState::processUnknownWriteInst(RLEContext &Ctx, SILInstruction *I) {
   auto *AA = Ctx.getAA();
-  for (unsigned i = 0; i < ForwardSetIn.size(); ++i) {
-    if (!isTrackingMemLocation(i))
-      continue;
-    // Invalidate any location this instruction may write to.
-    //
-    // TODO: checking may alias with Base is overly conservative,
-    // we should check may alias with base plus projection path.
-    MemLocation &R = Ctx.getMemLocation(i);
-    if (!AA->mayWriteToMemory(I, R.getBase()))
-      continue;
-    // MayAlias.
-    stopTrackingMemLocation(i);
+  for (auto &Group : Ctx.getBaseToLocIndices()) {
+    bool MayWrite = false;
+    for (unsigned i : Group.second) {
+      if (!isTrackingMemLocation(i))
+        continue;
+      // Invalidate any location this instruction may write to.
+      //
+      // TODO: checking may alias with Base is overly conservative,
+      // we should check may alias with base plus projection path.
+      if (!MayWrite) {
+        if (!AA->mayWriteToMemory(I, Group.first))
+          break;
+        MayWrite = true;
+      }
+      // MayAlias.
+      stopTrackingMemLocation(i);
+    }
   }
 }
 
@@ -633,11 +665,12 @@ bool BBState::optimize(RLEContext &Ctx, bool PF) {
   return updateForwardSetOut();
 }
 
-void BBState::mergePredecessorState(BBState &OtherState) {
+void BBState::mergePredecessorState(RLEContext &Ctx, BBState &OtherState) {
   // Merge in the predecessor state.
-  llvm::SmallVector<unsigned, 8> LocDeleteList;
-  for (unsigned i = 0; i < ForwardSetIn.size(); ++i) {
-    if (OtherState.ForwardSetOut[i]) {
+  llvm::SmallVector<unsigned, 8> Tracked;
+  ForwardSetIn.getIndices(Ctx.getNumMemLocations(), Tracked);
+  for (unsigned i : Tracked) {
+    if (OtherState.ForwardSetOut.test(i)) {
       // There are multiple values from multiple predecessors, set this as
       // a covering value. We do not need to track the value itself, as we
       // can always go to the predecessors BBState to find it.
@@ -670,7 +703,7 @@ void BBState::mergePredecessorStates(RLEContext &Ctx) {
       ForwardSetIn = Other.ForwardSetOut;
       ForwardValIn = Other.ForwardValOut;
     } else {
-      mergePredecessorState(Other);
+      mergePredecessorState(Ctx, Other);
     }
     HasAtLeastOnePred = true;
   }
@@ -694,6 +727,7 @@ RLEContext::RLEContext(SILFunction *F, AliasAnalysis *AA,
   // this function.
   MemLocation::enumerateMemLocations(*F, MemLocationVault, LocToBitIndex,
                                      TypeExpansionCache);
+  MemLocation::groupMemLocationsByBase(MemLocationVault, BaseToLocIndices);
 
   // For all basic blocks in the function, initialize a BB state. Since we
   // know all the locations accessed in this function, we can resize the bit
@@ -708,7 +742,7 @@ RLEContext::RLEContext(SILFunction *F, AliasAnalysis *AA,
     // unreachable block.
     //
     // we rely on other passes to clean up unreachable block.
-    BBToLocState[&B].init(&B, MemLocationVault.size(), isReachable(&B));
+    BBToLocState[&B].init(&B, isReachable(&B));
   }
 }
 
@@ -898,6 +932,15 @@ bool RLEContext::gatherValues(SILBasicBlock *BB, MemLocation &L,
 }
 
 bool RLEContext::run() {
+  // The cost of the data flow grows with the number of locations. Rather
+  // than let a huge function dominate compile time, leave it alone.
+  if (MemLocationVault.size() > MaxRLELocations) {
+    DEBUG(llvm::dbgs() << "Too many locations (" << MemLocationVault.size()
+                       << "), skipping function\n");
+    ++NumFunctionsSkipped;
+    return false;
+  }
+
   // Process basic blocks in RPO. After the data flow converges, run last
   // iteration and perform load forwarding.
   bool LastIteration = false;
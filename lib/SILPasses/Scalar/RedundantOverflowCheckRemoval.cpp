@@ -19,6 +19,7 @@
 #include "swift/SILAnalysis/DominanceAnalysis.h"
 #include "swift/SILAnalysis/PostOrderAnalysis.h"
 #include "swift/SILAnalysis/Analysis.h"
+#include "swift/SILAnalysis/ValueRange.h"
 #include "swift/SILPasses/Passes.h"
 #include "swift/SILPasses/Transforms.h"
 #include "swift/SILPasses/Utils/Local.h"
@@ -29,6 +30,8 @@
 using namespace swift;
 
 STATISTIC(NumCondFailRemoved,   "Number of cond_fail instructions removed");
+STATISTIC(NumCondFailRemovedByRange,
+          "Number of cond_fail instructions removed by value ranges");
 
 namespace {
 
@@ -102,6 +105,9 @@ public:
   // Dominators info.
   DominanceInfo *DT;
 
+  /// Value ranges of the function, used by the forward scan.
+  ValueRangeInfo *Ranges;
+
   /// Remove the instructions that were marked as redundant
   /// and return True if and instructions were removed.
   bool removeCollectedRedundantInstructions() {
@@ -125,6 +131,9 @@ public:
     Constraints.clear();
     ToRemove.clear();
 
+    ValueRangeInfo RangeInfo(getFunction(), DT);
+    Ranges = &RangeInfo;
+
     auto ReversePostOrder = PO->getReversePostOrder();
 
     // Perform a forward scan and use control flow and previously detected
@@ -140,7 +149,7 @@ public:
 
           // Handle cond_fail instructions.
         if (auto *CFI = dyn_cast<CondFailInst>(Inst)) {
-          if (tryToRemoveCondFail(CFI)) {
+          if (tryToRemoveCondFail(CFI) || isOverflowImpossibleInRange(CFI)) {
             ToRemove.push_back(CFI);
             continue;
           }
@@ -152,7 +161,10 @@ public:
       }
     }
 
-    // If we've collected redundant cond_fails then remove them now.
+    // If we've collected redundant cond_fails then remove them now. The ranges
+    // refer to the removed cond_fails, and the reverse scan below removes
+    // cond_fails whose facts the ranges rely on, so it doesn't use them.
+    Ranges = nullptr;
     bool Changed = removeCollectedRedundantInstructions();
 
     // Perform another check, this time in reverse and use future overflow
@@ -500,6 +512,19 @@ public:
     return false;
   }
 
+  /// Return True if the overflow checked by \p CFI can't happen because of
+  /// the ranges of the operands.
+  bool isOverflowImpossibleInRange(CondFailInst *CFI) {
+    auto *TEI = dyn_cast<TupleExtractInst>(CFI->getOperand());
+    if (!TEI || TEI->getFieldNo() != 1) return false;
+    auto *BI = dyn_cast<BuiltinInst>(TEI->getOperand());
+    if (!BI || !Ranges->isOverflowImpossible(BI)) return false;
+
+    DEBUG(llvm::dbgs() << "Overflow is impossible in range: " << *BI);
+    NumCondFailRemovedByRange++;
+    return true;
+  }
+
   void registerCondFailFormula(CondFailInst *CFI) {
     // Extract the arithmetic operation from the condfail.
     auto *TEI = dyn_cast<TupleExtractInst>(CFI->getOperand());
@@ -43,6 +43,19 @@ namespace {
 /// The optimization is only done for stack promoted objects because they are
 /// known to have no associated objects (which are not explicitly released
 /// in the deinit method).
+///
+/// A heap allocated object of a native Swift class, which is only used to
+/// access its stored properties, is never retained or passed anywhere. Its only
+/// release is therefore the final one and is replaced by a call to the
+/// deallocating deinit:
+///    %x = alloc_ref $X
+///      ...
+///    strong_release %x
+/// with
+///    %x = alloc_ref $X
+///      ...
+///    %d = function_ref @deallocating_deinit_of_X
+///    %a = apply %d(%x)
 class ReleaseDevirtualizer : public SILFunctionTransform {
 
 public:
@@ -60,10 +73,16 @@ private:
   bool devirtualizeReleaseOfBuffer(SILInstruction *ReleaseInst,
                                    ApplyInst *DeallocCall);
 
+  /// Devirtualize the final release of a heap allocated object.
+  bool devirtualizeFinalRelease(SILInstruction *ReleaseInst);
+
   /// Replace the release-instruction \p ReleaseInst with an explicit call to
-  /// the destructor of \p AllocType for \p object.
+  /// the destructor of \p AllocType for \p object. \p DeinitKind selects
+  /// between the destroying and the deallocating destructor.
   bool createDeinitCall(SILType AllocType, SILInstruction *ReleaseInst,
-                        SILValue object);
+                        SILValue object,
+                        SILDeclRef::Kind DeinitKind =
+                          SILDeclRef::Kind::Destroyer);
 
   StringRef getName() override { return "Release Devirtualizer"; }
 
@@ -103,6 +122,19 @@ void ReleaseDevirtualizer::run() {
       }
     }
   }
+
+  // Collect the remaining releases first, because devirtualizing a release
+  // erases it.
+  llvm::SmallVector<SILInstruction *, 8> Releases;
+  for (SILBasicBlock &BB : *F) {
+    for (SILInstruction &I : BB) {
+      if (isa<ReleaseValueInst>(&I) || isa<StrongReleaseInst>(&I))
+        Releases.push_back(&I);
+    }
+  }
+  for (SILInstruction *ReleaseInst : Releases)
+    Changed |= devirtualizeFinalRelease(ReleaseInst);
+
   if (Changed) {
     invalidateAnalysis(SILAnalysis::InvalidationKind::CallsAndInstructions);
   }
@@ -177,15 +209,67 @@ devirtualizeReleaseOfBuffer(SILInstruction *ReleaseInst,
   return createDeinitCall(SILClType, ReleaseInst, AllocAI);
 }
 
+/// Returns true if the only uses of \p V, looking through casts, are a single
+/// release, which is returned in \p FoundRelease, and accesses to stored
+/// properties.
+static bool isOnlyReleasedOnce(SILValue V, SILInstruction *&FoundRelease) {
+  for (Operand *Use : V.getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (isa<RefElementAddrInst>(User) || isa<DebugValueInst>(User))
+      continue;
+
+    if (isa<UpcastInst>(User) || isa<UncheckedRefCastInst>(User)) {
+      if (!isOnlyReleasedOnce(SILValue(User, 0), FoundRelease))
+        return false;
+      continue;
+    }
+
+    if (isa<ReleaseValueInst>(User) || isa<StrongReleaseInst>(User)) {
+      if (FoundRelease)
+        return false;
+      FoundRelease = User;
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+bool ReleaseDevirtualizer::
+devirtualizeFinalRelease(SILInstruction *ReleaseInst) {
+  // Stack promoted objects are handled together with their dealloc_ref.
+  auto *ARI = dyn_cast<AllocRefInst>(
+                RCIA->getRCIdentityRoot(ReleaseInst->getOperand(0)));
+  if (!ARI || ARI->canAllocOnStack() || ARI->isObjC())
+    return false;
+
+  // Objective-C objects may have associated objects, which the deinit does not
+  // release.
+  ClassDecl *Cl = ARI->getType().getClassOrBoundGenericClass();
+  if (!Cl || Cl->checkObjCAncestry() != ObjCClassKind::NonObjC)
+    return false;
+
+  // If the object is never retained and does not escape, its only release
+  // must be the final one.
+  SILInstruction *FoundRelease = nullptr;
+  if (!isOnlyReleasedOnce(ARI, FoundRelease) || FoundRelease != ReleaseInst)
+    return false;
+
+  return createDeinitCall(ARI->getType(), ReleaseInst, ARI,
+                          SILDeclRef::Kind::Deallocator);
+}
+
 bool ReleaseDevirtualizer::createDeinitCall(SILType AllocType,
                                             SILInstruction *ReleaseInst,
-                                            SILValue object) {
+                                            SILValue object,
+                                            SILDeclRef::Kind DeinitKind) {
   ClassDecl *Cl = AllocType.getClassOrBoundGenericClass();
   assert(Cl && "no class type allocated with alloc_ref");
 
   // Find the destructor of the type.
   DestructorDecl *Destructor = Cl->getDestructor();
-  SILDeclRef DeinitRef(Destructor, SILDeclRef::Kind::Destroyer);
+  SILDeclRef DeinitRef(Destructor, DeinitKind);
   SILModule &M = ReleaseInst->getFunction()->getModule();
   SILFunction *Deinit = M.lookUpFunction(DeinitRef);
   if (!Deinit)
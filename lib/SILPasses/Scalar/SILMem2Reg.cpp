@@ -46,6 +46,7 @@ STATISTIC(NumAllocStackFound,    "Number of AllocStack found");
 STATISTIC(NumAllocStackCaptured, "Number of AllocStack captured");
 STATISTIC(NumInstRemoved,        "Number of Instructions removed");
 STATISTIC(NumPhiPlaced,          "Number of Phi blocks placed");
+STATISTIC(NumEnumAllocRewritten, "Number of enum AllocStack uses rewritten");
 
 namespace {
 
@@ -241,6 +242,157 @@ static bool isCaptured(AllocStackInst *ASI, bool &inSingleBlock) {
   return false;
 }
 
+/// Returns the store which initializes the payload injected by \p IEAI, if it
+/// is a store into an init_enum_data_addr of the same case in the same block
+/// and nothing touches \p ASI in between.
+static StoreInst *findPayloadStore(InjectEnumAddrInst *IEAI,
+                                   AllocStackInst *ASI) {
+  SILBasicBlock::iterator II = IEAI->getIterator();
+  SILBasicBlock::iterator Begin = IEAI->getParent()->begin();
+  while (II != Begin) {
+    --II;
+    if (auto *SI = dyn_cast<StoreInst>(&*II)) {
+      auto *IEDAI = dyn_cast<InitEnumDataAddrInst>(SI->getDest().getDef());
+      if (IEDAI && IEDAI->getOperand().getDef() == ASI) {
+        if (IEDAI->getElement() != IEAI->getElement() || !IEDAI->hasOneUse())
+          return nullptr;
+        return SI;
+      }
+    }
+    for (auto &Op : II->getAllOperands())
+      if (Op.get().getDef() == ASI)
+        return nullptr;
+  }
+  return nullptr;
+}
+
+/// Rewrites the enum-specific uses of an enum AllocStack in terms of whole
+/// enum values, so that it can be promoted like any other AllocStack:
+///
+///   init_enum_data_addr + store + inject_enum_addr -> enum + store
+///   inject_enum_addr (no payload)                  -> enum + store
+///   load (unchecked_take_enum_data_addr)           -> unchecked_enum_data (load)
+///   switch_enum_addr                               -> switch_enum (load)
+///   select_enum_addr                               -> select_enum (load)
+///
+/// Nothing is rewritten unless all uses of \p ASI can be promoted afterwards.
+/// Returns true if the AllocStack was changed.
+static bool canonicalizeEnumAllocation(AllocStackInst *ASI) {
+  SILType EnumTy = ASI->getElementType();
+  if (!EnumTy.getEnumOrBoundGenericEnum() ||
+      !EnumTy.isLoadable(ASI->getModule()))
+    return false;
+
+  SmallVector<std::pair<InjectEnumAddrInst *, StoreInst *>, 4> Injects;
+  SmallVector<UncheckedTakeEnumDataAddrInst *, 4> Takes;
+  SmallVector<SILInstruction *, 4> EnumAddrUsers;
+  unsigned NumInitDataAddrs = 0;
+
+  for (auto *Use : ASI->getUses()) {
+    SILInstruction *II = Use->getUser();
+    if (isa<LoadInst>(II) || isa<DeallocStackInst>(II) ||
+        isa<DebugValueAddrInst>(II) || isa<DestroyAddrInst>(II))
+      continue;
+    if (auto *SI = dyn_cast<StoreInst>(II))
+      if (SI->getDest().getDef() == ASI)
+        continue;
+
+    if (isa<InitEnumDataAddrInst>(II)) {
+      ++NumInitDataAddrs;
+      continue;
+    }
+    if (auto *IEAI = dyn_cast<InjectEnumAddrInst>(II)) {
+      StoreInst *SI = nullptr;
+      if (IEAI->getElement()->hasArgumentType() &&
+          !(SI = findPayloadStore(IEAI, ASI)))
+        return false;
+      Injects.push_back({IEAI, SI});
+      continue;
+    }
+    if (auto *UTEDAI = dyn_cast<UncheckedTakeEnumDataAddrInst>(II)) {
+      for (auto *DataUse : UTEDAI->getUses())
+        if (!isa<LoadInst>(DataUse->getUser()))
+          return false;
+      Takes.push_back(UTEDAI);
+      continue;
+    }
+    if (isa<SwitchEnumAddrInst>(II) || isa<SelectEnumAddrInst>(II)) {
+      EnumAddrUsers.push_back(II);
+      continue;
+    }
+    return false;
+  }
+
+  // Every payload initialization must be paired with its inject_enum_addr.
+  unsigned NumPayloadStores = 0;
+  for (auto &Inject : Injects)
+    if (Inject.second)
+      ++NumPayloadStores;
+  if (NumPayloadStores != NumInitDataAddrs)
+    return false;
+
+  if (Injects.empty() && Takes.empty() && EnumAddrUsers.empty())
+    return false;
+
+  SILValue Addr = ASI->getAddressResult();
+  SILType ObjectTy = EnumTy.getObjectType();
+
+  for (auto &Inject : Injects) {
+    InjectEnumAddrInst *IEAI = Inject.first;
+    SILBuilderWithScope B(IEAI);
+    SILValue Payload;
+    if (StoreInst *SI = Inject.second) {
+      Payload = SI->getSrc();
+      auto *IEDAI = cast<InitEnumDataAddrInst>(SI->getDest().getDef());
+      SI->eraseFromParent();
+      IEDAI->eraseFromParent();
+    }
+    auto *E = B.createEnum(IEAI->getLoc(), Payload, IEAI->getElement(),
+                           ObjectTy);
+    B.createStore(IEAI->getLoc(), E, Addr);
+    IEAI->eraseFromParent();
+  }
+
+  for (auto *UTEDAI : Takes) {
+    while (!UTEDAI->use_empty()) {
+      auto *LI = cast<LoadInst>(UTEDAI->use_begin()->getUser());
+      SILBuilderWithScope B(LI);
+      auto *EnumVal = B.createLoad(LI->getLoc(), Addr);
+      auto *Data = B.createUncheckedEnumData(LI->getLoc(), EnumVal,
+                                             UTEDAI->getElement(),
+                                             LI->getType());
+      SILValue(LI, 0).replaceAllUsesWith(Data);
+      LI->eraseFromParent();
+    }
+    UTEDAI->eraseFromParent();
+  }
+
+  for (auto *II : EnumAddrUsers) {
+    SILBuilderWithScope B(II);
+    auto *EnumVal = B.createLoad(II->getLoc(), Addr);
+    if (auto *SEAI = dyn_cast<SwitchEnumAddrInst>(II)) {
+      SmallVector<std::pair<EnumElementDecl *, SILBasicBlock *>, 8> Cases;
+      for (unsigned i = 0, e = SEAI->getNumCases(); i != e; ++i)
+        Cases.push_back(SEAI->getCase(i));
+      SILBasicBlock *Default =
+          SEAI->hasDefault() ? SEAI->getDefaultBB() : nullptr;
+      B.createSwitchEnum(SEAI->getLoc(), EnumVal, Default, Cases);
+    } else {
+      auto *SEAI = cast<SelectEnumAddrInst>(II);
+      SmallVector<std::pair<EnumElementDecl *, SILValue>, 8> Cases;
+      for (unsigned i = 0, e = SEAI->getNumCases(); i != e; ++i)
+        Cases.push_back(SEAI->getCase(i));
+      SILValue Default =
+          SEAI->hasDefault() ? SEAI->getDefaultResult() : SILValue();
+      auto *SEI = B.createSelectEnum(SEAI->getLoc(), EnumVal, SEAI->getType(),
+                                     Default, Cases);
+      SILValue(SEAI, 0).replaceAllUsesWith(SEI);
+    }
+    II->eraseFromParent();
+  }
+  return true;
+}
+
 /// Returns true if the AllocStack is only stored into.
 bool MemoryToRegisters::isWriteOnlyAllocation(AllocStackInst *ASI,
                                               bool Promoted) {
@@ -838,6 +990,12 @@ bool MemoryToRegisters::run() {
       DEBUG(llvm::dbgs() << "*** Memory to register looking at: " << *I);
       NumAllocStackFound++;
 
+      // Turn enum projections of the allocation into whole-value operations.
+      if (canonicalizeEnumAllocation(ASI)) {
+        NumEnumAllocRewritten++;
+        Changed = true;
+      }
+
       // Don't handle captured AllocStacks.
       bool inSingleBlock = false;
       if (isCaptured(ASI, inSingleBlock)) {
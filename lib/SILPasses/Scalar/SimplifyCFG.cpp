@@ -698,12 +698,9 @@ bool SimplifyCFG::dominatorBasedSimplify(DominanceAnalysis *DA,
         // TODO: handle switch_value
         break;
       case ValueKind::CheckedCastBranchInst:
-        if (trySimplifyCheckedCastBr(BB.getTerminator(), DT)) {
+        // This keeps the dominator tree up to date.
+        if (trySimplifyCheckedCastBr(BB.getTerminator(), DT))
           HasChangedInCurrentIter = true;
-          // FIXME: trySimplifyCheckedCastBr function should preserve the
-          // dominator tree but its code to do so is buggy.
-          DT->recalculate(Fn);
-        }
         break;
       default:
         break;
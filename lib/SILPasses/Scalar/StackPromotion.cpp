@@ -13,6 +13,7 @@
 #define DEBUG_TYPE "stack-promotion"
 #include "swift/SILPasses/Passes.h"
 #include "swift/SILPasses/Transforms.h"
+#include "swift/SILPasses/Utils/Local.h"
 #include "swift/SILAnalysis/EscapeAnalysis.h"
 #include "swift/SILAnalysis/DominanceAnalysis.h"
 #include "swift/SIL/SILArgument.h"
@@ -20,6 +21,8 @@
 #include "llvm/ADT/Statistic.h"
 
 STATISTIC(NumStackPromoted, "Number of objects promoted to the stack");
+STATISTIC(NumClosuresPromoted,
+          "Number of closure contexts promoted to the stack");
 
 using namespace swift;
 
@@ -41,6 +44,10 @@ using namespace swift;
 ///    The solution to this problem is that we need native support for tail-
 ///    allocated arrays in SIL so that we can do the array buffer allocations
 ///    with alloc_ref instructions.
+/// *) Contexts of @noescape closures: if all uses of the partial_apply are in
+///    its own block, the [stack] attribute is set in the partial_apply. This
+///    guarantees that the context is dead before the partial_apply is executed
+///    again, which is preserved by later transformations like inlining.
 class StackPromoter {
 
   // Some analysis we need.
@@ -103,6 +110,9 @@ class StackPromoter {
   /// Tries to promote the allocation \p AI.
   void tryPromoteAlloc(SILInstruction *AI);
 
+  /// Tries to promote the context of the closure \p PAI.
+  void tryPromoteClosure(PartialApplyInst *PAI);
+
   /// Creates the external declaration for swift_bufferAllocateOnStack.
   SILFunction *getBufferAllocFunc(SILFunction *OrigFunc,
                                   SILLocation Loc);
@@ -185,6 +195,8 @@ StackPromoter::ChangeState StackPromoter::promote() {
       SILInstruction *I = &*Iter++;
       if (isPromotableAllocInst(I)) {
         tryPromoteAlloc(I);
+      } else if (auto *PAI = dyn_cast<PartialApplyInst>(I)) {
+        tryPromoteClosure(PAI);
       }
     }
   }
@@ -243,6 +255,52 @@ void StackPromoter::tryPromoteAlloc(SILInstruction *I) {
   llvm_unreachable("unhandled allocation instruction");
 }
 
+/// Returns true if all uses of the closure \p V are in \p BB and none of
+/// them can keep the closure alive beyond the end of the block.
+static bool hasOnlyLocalClosureUses(SILValue V, SILBasicBlock *BB) {
+  for (Operand *Use : V.getUses()) {
+    SILInstruction *User = Use->getUser();
+    if (User->getParent() != BB)
+      return false;
+
+    switch (User->getKind()) {
+    case ValueKind::StrongRetainInst:
+    case ValueKind::StrongReleaseInst:
+    case ValueKind::RetainValueInst:
+    case ValueKind::ReleaseValueInst:
+    case ValueKind::DebugValueInst:
+    case ValueKind::ApplyInst:
+      // A @noescape closure can only be called or passed to a @noescape
+      // parameter, so an apply cannot extend its lifetime.
+      break;
+    case ValueKind::PartialApplyInst:
+    case ValueKind::ConvertFunctionInst:
+      // Reabstraction thunks and function conversions wrap the closure; the
+      // wrapper must not outlive the block either.
+      if (!hasOnlyLocalClosureUses(SILValue(User, 0), BB))
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+void StackPromoter::tryPromoteClosure(PartialApplyInst *PAI) {
+  if (PAI->canAllocOnStack() || !isNoEscapeClosure(PAI))
+    return;
+  if (!hasOnlyLocalClosureUses(PAI, PAI->getParent()))
+    return;
+
+  DEBUG(llvm::dbgs() << "Promoted closure " << *PAI);
+  DEBUG(llvm::dbgs() << "    in " << PAI->getFunction()->getName() << '\n');
+  NumClosuresPromoted++;
+
+  PAI->setStackAllocatable();
+  ChangedInsts = true;
+}
+
 SILFunction *StackPromoter::getBufferAllocFunc(SILFunction *OrigFunc,
                                                SILLocation Loc) {
   if (!BufferAllocFunc) {
@@ -154,6 +154,18 @@ TermInst *swift::changeEdgeValue(TermInst *Branch, SILBasicBlock *Dest,
   llvm_unreachable("Unhandled terminator leading to merge block");
 }
 
+/// Update \p DT after the edge from \p BB to \p OldDest was redirected to
+/// \p NewDest.
+static void updateDominatorsForNewTarget(DominanceInfo *DT, SILBasicBlock *BB,
+                                         SILBasicBlock *OldDest,
+                                         SILBasicBlock *NewDest) {
+  if (!DT || OldDest == NewDest)
+    return;
+  DT->insertEdge(BB, NewDest);
+  if (!BB->isSuccessor(OldDest))
+    DT->deleteEdge(BB, OldDest);
+}
+
 template <class SwitchEnumTy, class SwitchEnumCaseTy>
 SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
                                      SmallVectorImpl<SwitchEnumCaseTy> &Cases,
@@ -169,8 +181,8 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
     return DefaultBB;
 }
 
-void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void changeBranchTargetImpl(TermInst *T, unsigned EdgeIdx,
+                                   SILBasicBlock *NewDest, bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getKind()) {
@@ -306,6 +318,15 @@ void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::changeBranchTarget(TermInst *T, unsigned EdgeIdx,
+                               SILBasicBlock *NewDest, bool PreserveArgs,
+                               DominanceInfo *DT) {
+  SILBasicBlock *BB = T->getParent();
+  SILBasicBlock *OldDest = T->getSuccessors()[EdgeIdx];
+  changeBranchTargetImpl(T, EdgeIdx, NewDest, PreserveArgs);
+  updateDominatorsForNewTarget(DT, BB, OldDest, NewDest);
+}
+
 
 template <class SwitchEnumTy, class SwitchEnumCaseTy>
 SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
@@ -328,8 +349,9 @@ SILBasicBlock *replaceSwitchDest(SwitchEnumTy *S,
 /// \param OldDest The successor block that will be replaced.
 /// \param NewDest The new target block.
 /// \param PreserveArgs If set, preserve arguments on the replaced edge.
-void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
-                               SILBasicBlock *NewDest, bool PreserveArgs) {
+static void replaceBranchTargetImpl(TermInst *T, SILBasicBlock *OldDest,
+                                    SILBasicBlock *NewDest,
+                                    bool PreserveArgs) {
   SILBuilderWithScope B(T);
 
   switch (T->getKind()) {
@@ -449,6 +471,14 @@ void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
   llvm_unreachable("Not yet implemented!");
 }
 
+void swift::replaceBranchTarget(TermInst *T, SILBasicBlock *OldDest,
+                                SILBasicBlock *NewDest, bool PreserveArgs,
+                                DominanceInfo *DT) {
+  SILBasicBlock *BB = T->getParent();
+  replaceBranchTargetImpl(T, OldDest, NewDest, PreserveArgs);
+  updateDominatorsForNewTarget(DT, BB, OldDest, NewDest);
+}
+
 /// \brief Check if the edge from the terminator is critical.
 bool swift::isCriticalEdge(TermInst *T, unsigned EdgeIdx) {
   assert(T->getSuccessors().size() > EdgeIdx && "Not enough successors");
@@ -562,19 +592,8 @@ SILBasicBlock *swift::splitBasicBlockAndBranch(SILBuilder &B,
   B.createBranch(SplitBeforeInst->getLoc(), NewBB);
 
   // Update the dominator tree.
-  if (DT) {
-    auto OrigBBDTNode = DT->getNode(OrigBB);
-    if (OrigBBDTNode) {
-      // Change the immediate dominators of the children of the block we
-      // splitted to the splitted block.
-      SmallVector<DominanceInfoNode *, 16> Adoptees(OrigBBDTNode->begin(),
-                                                    OrigBBDTNode->end());
-
-      auto NewBBDTNode = DT->addNewBlock(NewBB, OrigBB);
-      for (auto *Adoptee : Adoptees)
-        DT->changeImmediateDominator(Adoptee, NewBBDTNode);
-    }
-  }
+  if (DT)
+    DT->splitBlock(OrigBB, NewBB);
 
   // Update loop info.
   if (LI)
@@ -753,17 +772,7 @@ bool swift::mergeBasicBlockWithSuccessor(SILBasicBlock *BB, DominanceInfo *DT,
   BB->spliceAtEnd(SuccBB);
 
   if (DT)
-    if (auto *SuccBBNode = DT->getNode(SuccBB)) {
-      // Change the immediate dominator for children of the successor to be the
-      // current block.
-      auto *BBNode = DT->getNode(BB);
-      SmallVector<DominanceInfoNode *, 8> Children(SuccBBNode->begin(),
-                                                   SuccBBNode->end());
-      for (auto *ChildNode : *SuccBBNode)
-        DT->changeImmediateDominator(ChildNode, BBNode);
-
-      DT->eraseNode(SuccBB);
-    }
+    DT->mergeBlocks(BB, SuccBB);
 
   if (LI)
     LI->removeBlock(SuccBB);
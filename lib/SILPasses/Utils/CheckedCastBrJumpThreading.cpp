@@ -78,7 +78,6 @@ class CheckedCastBrJumpThreading {
   void modifyCFGForUnknownPreds();
   void modifyCFGForFailurePreds();
   void modifyCFGForSuccessPreds();
-  void updateDominatorTree();
   void updateSSA();
   void addBlockToSimplifyCFGWorklist(SILBasicBlock *BB);
   void addBlocksToWorklist();
@@ -109,32 +108,6 @@ public:
 };
 } // end anonymous namespace
 
-/// Find a nearest common dominator for a given set of basic blocks.
-static DominanceInfoNode *findCommonDominator(ArrayRef<SILBasicBlock *> BBs,
-                                              DominanceInfo *DT) {
-  DominanceInfoNode *CommonDom = nullptr;
-  for (auto *BB : BBs) {
-    if (!CommonDom) {
-      CommonDom = DT->getNode(BB);
-    } else {
-      CommonDom = DT->getNode(
-          DT->findNearestCommonDominator(CommonDom->getBlock(), BB));
-    }
-  }
-  return CommonDom;
-}
-
-/// Find a nearest common dominator for all predecessors of
-/// a given basic block.
-static DominanceInfoNode *findCommonDominator(SILBasicBlock *BB,
-                                              DominanceInfo *DT) {
-  SmallVector<SILBasicBlock *, 8> Preds;
-  for (auto *Pred: BB->getPreds())
-    Preds.push_back(Pred);
-
-  return findCommonDominator(Preds, DT);
-}
-
 /// Estimate the cost of inlining a given basic block.
 static unsigned basicBlockInlineCost(SILBasicBlock *BB, unsigned Cutoff) {
   unsigned Cost = 0;
@@ -276,67 +249,6 @@ void CheckedCastBrJumpThreading::updateSSA() {
   }
 }
 
-/// Update the SSA form after all changes.
-void CheckedCastBrJumpThreading::updateDominatorTree() {
-  // Update the dominator tree.
-
-  // If BB was IDom of something, then PredCBBI becomes the IDOM
-  // of this after jump-threading.
-  auto *BBDomNode = DT->getNode(BB);
-  auto &Children = BBDomNode->getChildren();
-  if (Children.size() > 1) {
-    SmallVector<DominanceInfoNode *, 16> ChildrenCopy;
-    std::copy(Children.begin(), Children.end(),
-              std::back_inserter(ChildrenCopy));
-    for (auto *Child : ChildrenCopy) {
-      DT->changeImmediateDominator(Child, Node);
-    }
-  }
-
-  DominanceInfoNode *CommonDom;
-
-  // Find a common dominator for all unknown preds.
-  if (!UnknownPreds.empty()) {
-    // Find a new IDom for FailureBB
-    CommonDom = findCommonDominator(FailureBB, DT);
-    if (CommonDom)
-      DT->changeImmediateDominator(FailureBB, CommonDom->getBlock());
-
-    CommonDom = findCommonDominator(UnknownPreds, DT);
-    // This common dominator dominates the BB now.
-    if (CommonDom) {
-      DT->changeImmediateDominator(BB, CommonDom->getBlock());
-    }
-  }
-
-  // Find a common dominator for all failure preds.
-  CommonDom = findCommonDominator(FailurePreds, DT);
-  // This common dominator dominates the TargetFailureBB now.
-  if (CommonDom) {
-    DT->addNewBlock(TargetFailureBB, CommonDom->getBlock());
-    // Find a new IDom for FailureBB
-    CommonDom = findCommonDominator(FailureBB, DT);
-    if (CommonDom)
-      DT->changeImmediateDominator(FailureBB, CommonDom->getBlock());
-  }
-
-
-  // Find a common dominator for all success preds.
-  CommonDom = findCommonDominator(SuccessPreds, DT);
-  // This common dominator of all success preds dominates the BB now.
-  if (CommonDom) {
-    if (TargetSuccessBB) {
-      DT->addNewBlock(TargetSuccessBB, CommonDom->getBlock());
-    } else {
-      DT->changeImmediateDominator(BB, CommonDom->getBlock());
-    }
-    CommonDom = findCommonDominator(SuccessBB, DT);
-    if (CommonDom)
-      DT->changeImmediateDominator(SuccessBB, CommonDom->getBlock());
-  }
-  // End of dominator tree update.
-}
-
 void CheckedCastBrJumpThreading::modifyCFGForUnknownPreds() {
   if (UnknownPreds.empty())
     return;
@@ -349,6 +261,8 @@ void CheckedCastBrJumpThreading::modifyCFGForUnknownPreds() {
       // Replace checked_cast_br by branch to FailureBB.
       SILBuilder(BB).createBranch(CCBI->getLoc(), FailureBB);
       CCBI->eraseFromParent();
+      if (SuccessBB != FailureBB)
+        DT->deleteEdge(BB, SuccessBB);
     }
   }
 }
@@ -372,7 +286,7 @@ void CheckedCastBrJumpThreading::modifyCFGForFailurePreds() {
   for (auto *Pred : FailurePreds) {
     TermInst *TI = Pred->getTerminator();
     // Replace branch to BB by branch to TargetFailureBB.
-    replaceBranchTarget(TI, BB, TargetFailureBB, /*PreserveArgs=*/true);
+    replaceBranchTarget(TI, BB, TargetFailureBB, /*PreserveArgs=*/true, DT);
     Pred = nullptr;
   }
 }
@@ -400,7 +314,8 @@ void CheckedCastBrJumpThreading::modifyCFGForSuccessPreds() {
       for (auto *Pred : SuccessPreds) {
         TermInst *TI = Pred->getTerminator();
         // Replace branch to BB by branch to TargetSuccessBB.
-        replaceBranchTarget(TI, BB, TargetSuccessBB, /*PreserveArgs=*/true);
+        replaceBranchTarget(TI, BB, TargetSuccessBB, /*PreserveArgs=*/true,
+                            DT);
         SuccessBBArgs.push_back(DomSuccessBB->getBBArg(0));
         Pred = nullptr;
       }
@@ -418,6 +333,8 @@ void CheckedCastBrJumpThreading::modifyCFGForSuccessPreds() {
     SuccessBBArgs.push_back(DomSuccessBB->getBBArg(0));
     SILBuilder(BB).createBranch(CCBI->getLoc(), SuccessBB, SuccessBBArgs);
     CCBI->eraseFromParent();
+    if (SuccessBB != FailureBB)
+      DT->deleteEdge(BB, FailureBB);
   }
 }
 
@@ -717,6 +634,8 @@ bool CheckedCastBrJumpThreading::trySimplify(TermInst *Term) {
     if (InvertSuccess) {
       SILBuilder(BB).createBranch(CCBI->getLoc(), FailureBB);
       CCBI->eraseFromParent();
+      if (SuccessBB != FailureBB)
+        DT->deleteEdge(BB, SuccessBB);
       SuccessPreds.clear();
     } else {
       // Create a copy of the BB or reuse BB as
@@ -726,9 +645,6 @@ bool CheckedCastBrJumpThreading::trySimplify(TermInst *Term) {
     // Handle unknown preds.
     modifyCFGForUnknownPreds();
 
-    // Update the dominator tree after all changes.
-    updateDominatorTree();
-
     // Update the SSA form after all changes.
     updateSSA();
 
@@ -12,6 +12,7 @@
 
 #define DEBUG_TYPE "sil-devirtualize-utility"
 #include "swift/SILPasses/Utils/Devirtualize.h"
+#include "swift/SILAnalysis/ClassHierarchyAnalysis.h"
 #include "swift/AST/Decl.h"
 #include "swift/AST/Types.h"
 #include "swift/SIL/SILDeclRef.h"
@@ -28,6 +29,9 @@ using namespace swift;
 
 STATISTIC(NumClassDevirt, "Number of class_method applies devirtualized");
 STATISTIC(NumWitnessDevirt, "Number of witness_method applies devirtualized");
+STATISTIC(NumEffectivelyFinalDevirt, "Number of class_method applies "
+                                     "devirtualized because no subclass "
+                                     "overrides the method");
 
 //===----------------------------------------------------------------------===//
 //                         Class Method Optimization
@@ -614,9 +618,28 @@ static bool isKnownFinal(SILModule &M, SILDeclRef Member) {
   return true;
 }
 
+/// Return true if the method called by \p CMI is effectively final for the
+/// static type of its operand, according to the class hierarchy.
+static bool isEffectivelyFinal(ClassMethodInst *CMI, SILValue Instance,
+                               ClassHierarchyAnalysis *CHA) {
+  if (CMI->isVolatile())
+    return false;
+
+  auto *Method = CMI->getMember().getFuncDecl();
+  if (!Method || Method->isDynamic() || CMI->getMember().isForeign)
+    return false;
+
+  SILType ClassType = Instance.getType();
+  if (ClassType.is<MetatypeType>())
+    ClassType = ClassType.getMetatypeInstanceType(CMI->getModule());
+  ClassDecl *CD = ClassType.getClassOrBoundGenericClass();
+  return CD && CHA->isEffectivelyFinal(Method, CD);
+}
+
 /// Attempt to devirtualize the given apply if possible, and return a
 /// new instruction in that case, or nullptr otherwise.
-DevirtualizationResult swift::tryDevirtualizeApply(FullApplySite AI) {
+DevirtualizationResult swift::tryDevirtualizeApply(FullApplySite AI,
+                                                   ClassHierarchyAnalysis *CHA) {
   DEBUG(llvm::dbgs() << "    Trying to devirtualize: " << *AI.getInstruction());
 
   // Devirtualize apply instructions that call witness_method instructions:
@@ -652,6 +675,16 @@ DevirtualizationResult swift::tryDevirtualizeApply(FullApplySite AI) {
     // known.
     if (auto Instance = getInstanceWithExactDynamicType(CMI->getOperand()))
       return tryDevirtualizeClassMethod(AI, Instance);
+
+    // Check if no subclass of the instance's static type overrides the
+    // member. Upcasts only hide a more precise static type.
+    SILValue Instance = CMI->getOperand().stripUpCasts();
+    if (CHA && isEffectivelyFinal(CMI, Instance, CHA)) {
+      auto Result = tryDevirtualizeClassMethod(AI, Instance);
+      if (Result.first)
+        ++NumEffectivelyFinalDevirt;
+      return Result;
+    }
   }
 
   return std::make_pair(nullptr, FullApplySite());
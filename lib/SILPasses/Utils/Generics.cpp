@@ -131,15 +131,39 @@ bool swift::isWhitelistedSpecialization(StringRef SpecName) {
   return false;
 }
 
+/// Returns true if \p Specialization of the generic function \p Orig should
+/// be published for clients of the module, because of -share-specializations.
+///
+/// Only the module which defines the generic function publishes its
+/// specializations. Otherwise two modules could define the same public
+/// specialization symbol.
+static bool shouldPublishSpecialization(SILModule &M, SILFunction *Orig,
+                                        SILFunction *Specialization) {
+  if (!M.getOptions().ShareSpecializations ||
+      M.getOptions().Optimization < SILOptions::SILOptMode::Optimize)
+    return false;
+
+  return Orig->getLinkage() == SILLinkage::Public && Orig->isDefinition() &&
+         Specialization->getLinkage() != SILLinkage::Public;
+}
+
 /// Cache a specialization.
-/// For now, it is performed only for specializations in the
-/// standard library. But in the future, one could think of
-/// maintaining a cache of optimized specializations.
+/// This is performed for whitelisted specializations in the standard
+/// library, and with -share-specializations for the specializations of the
+/// module's own public generic functions. But in the future, one could think
+/// of maintaining a cache of optimized specializations.
 ///
 /// Mark specializations as public, so that they can be used
 /// by user applications. These specializations are supposed to be
 /// used only by -Onone compiled code. They should be never inlined.
-static bool cacheSpecialization(SILModule &M, SILFunction *F) {
+static bool cacheSpecialization(SILModule &M, SILFunction *Orig,
+                                SILFunction *F) {
+  if (shouldPublishSpecialization(M, Orig, F)) {
+    DEBUG(llvm::dbgs() << "Publish specialization: " << F->getName() << "\n");
+    F->setKeepAsPublic(true);
+    return true;
+  }
+
   // Do not remove functions from the white-list. Keep them around.
   // Change their linkage to public, so that other applications can refer to it.
 
@@ -176,11 +200,19 @@ static bool cacheSpecialization(SILModule &M, SILFunction *F) {
 /// Try to look up an existing specialization in the specialization cache.
 /// If it is found, it tries to link this specialization.
 ///
-/// For now, it performs a lookup only in the standard library.
+/// It performs a lookup in the standard library and, with
+/// -share-specializations, in all imported modules.
 /// But in the future, one could think of maintaining a cache
 /// of optimized specializations.
 static SILFunction *lookupExistingSpecialization(SILModule &M,
                                                  StringRef FunctionName) {
+  // Published specializations are serialized as declarations only, so linking
+  // does not succeed, but it makes the declaration available.
+  if (M.getOptions().ShareSpecializations) {
+    M.linkFunction(FunctionName, SILOptions::LinkingMode::LinkNormal);
+    return M.lookUpFunction(FunctionName);
+  }
+
   // Try to link existing specialization only in -Onone mode.
   // All other compilation modes perform specialization themselves.
   // TODO: Cache optimized specializations and perform lookup here?
@@ -302,6 +334,14 @@ ApplySite swift::trySpecializeApplyOfGeneric(ApplySite Apply,
     if (M.getOptions().Optimization <= SILOptions::SILOptMode::None)
       return ApplySite();
 
+    // Use the specialization published by the module which defines F, if
+    // there is one.
+    if (M.getOptions().ShareSpecializations &&
+        isAvailableExternally(F->getLinkage())) {
+      if (SILFunction *Existing = getExistingSpecialization(M, ClonedName))
+        return replaceWithSpecializedFunction(Apply, Existing);
+    }
+
     DEBUG(
       if (M.getOptions().Optimization <= SILOptions::SILOptMode::Debug) {
         llvm::dbgs() << "Creating a specialization: " << ClonedName << "\n"; });
@@ -314,7 +354,7 @@ ApplySite swift::trySpecializeApplyOfGeneric(ApplySite Apply,
     NewFunction = NewF;
 
     // Check if this specialization should be cached.
-    cacheSpecialization(M, NewF);
+    cacheSpecialization(M, F, NewF);
   }
   return replaceWithSpecializedFunction(Apply, NewF);
 }
@@ -10,6 +10,7 @@
 //
 //===---------------------------------------------------------------------===//
 #include "swift/SILPasses/Utils/Local.h"
+#include "swift/AST/AnyFunctionRef.h"
 #include "swift/SILAnalysis/Analysis.h"
 #include "swift/SILAnalysis/ARCAnalysis.h"
 #include "swift/SILAnalysis/DominanceAnalysis.h"
@@ -22,9 +23,11 @@
 #include "swift/SIL/DebugUtils.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/IR/Intrinsics.h"
 #include "llvm/Support/CommandLine.h"
+#include <algorithm>
 #include <deque>
 
 using namespace swift;
@@ -875,6 +878,227 @@ SILInstruction *swift::tryToConcatenateStrings(ApplyInst *AI, SILBuilder &B) {
   return StringConcatenationOptimizer(AI, B).optimize();
 }
 
+//===----------------------------------------------------------------------===//
+//                      String Interpolation Folding
+//===----------------------------------------------------------------------===//
+
+/// Returns the semantics string of the function called by \p V, or an empty
+/// string if \p V is not a call of a function with defined semantics.
+static StringRef getCalleeSemantics(SILValue V) {
+  auto *AI = dyn_cast<ApplyInst>(V);
+  if (!AI)
+    return StringRef();
+  auto *Fn = AI->getCalleeFunction();
+  if (!Fn || !Fn->hasDefinedSemantics())
+    return StringRef();
+  return Fn->getSemanticsString();
+}
+
+/// Appends the text of the constant interpolation segment \p Segment to
+/// \p Text and collects the instructions computing it in \p SegmentInsts.
+///
+/// A constant segment is a string literal or a constant integer, optionally
+/// wrapped in a call of the interpolation segment initializer for its type.
+/// On success \p UTF8Literal is set if \p Segment contains a call which
+/// creates a UTF-8 string literal.
+///
+/// Returns false if the segment is not a constant.
+static bool
+collectConstantSegment(SILValue Segment, std::string &Text,
+                       SmallVectorImpl<SILInstruction *> &SegmentInsts,
+                       ApplyInst *&UTF8Literal) {
+  auto *AI = dyn_cast<ApplyInst>(Segment);
+  if (!AI || !hasOneNonDebugUse(*AI))
+    return false;
+
+  StringRef Semantics = getCalleeSemantics(AI);
+  if ((Semantics == "string.makeUTF8" && AI->getNumOperands() == 5) ||
+      (Semantics == "string.makeUTF16" && AI->getNumOperands() == 4)) {
+    auto *SLI = dyn_cast<StringLiteralInst>(AI->getOperand(1));
+    if (!SLI)
+      return false;
+    if (Semantics == "string.makeUTF8")
+      UTF8Literal = AI;
+    Text += SLI->getValue();
+    SegmentInsts.push_back(AI);
+    return true;
+  }
+
+  // Segment initializers take the segment value and the String metatype.
+  if (AI->getNumOperands() != 3)
+    return false;
+
+  if (Semantics == "string.interpolationSegment") {
+    if (!collectConstantSegment(AI->getOperand(1), Text, SegmentInsts,
+                                UTF8Literal))
+      return false;
+    SegmentInsts.push_back(AI);
+    return true;
+  }
+
+  bool IsSigned = Semantics == "string.interpolationSegment.int";
+  if (!IsSigned && Semantics != "string.interpolationSegment.uint")
+    return false;
+
+  // Integers are structs wrapping a builtin integer literal.
+  auto *SI = dyn_cast<StructInst>(AI->getOperand(1));
+  if (!SI || SI->getNumOperands() != 1)
+    return false;
+  auto *ILI = dyn_cast<IntegerLiteralInst>(SI->getOperand(0));
+  if (!ILI)
+    return false;
+
+  llvm::SmallString<32> Digits;
+  ILI->getValue().toString(Digits, 10, IsSigned);
+  Text += Digits.str();
+  SegmentInsts.push_back(AI);
+  return true;
+}
+
+/// Top level entry point
+SILInstruction *
+swift::tryToFoldStringInterpolation(ApplyInst *AI, SILBuilder &B,
+                                    CallbackTy Callback) {
+  // init(stringInterpolation:) takes the array of segments and the String
+  // metatype.
+  if (getCalleeSemantics(AI) != "string.interpolation" ||
+      AI->getNumOperands() != 3)
+    return nullptr;
+
+  // The segments are passed in a varargs array which is only used by the
+  // interpolation.
+  auto *ArrayValue = dyn_cast<TupleExtractInst>(AI->getOperand(1));
+  if (!ArrayValue || ArrayValue->getFieldNo() != 0 ||
+      !hasOneNonDebugUse(*ArrayValue))
+    return nullptr;
+  auto *ArrayAlloc = dyn_cast<ApplyInst>(ArrayValue->getOperand());
+  if (!ArrayAlloc || getCalleeSemantics(ArrayAlloc) != "array.uninitialized" ||
+      ArrayAlloc->getParent() != AI->getParent())
+    return nullptr;
+
+  // Arrays adopting a preallocated buffer are not handled.
+  if (ArrayAlloc->getNumArguments() < 1 ||
+      ArrayAlloc->getArgument(0).getType().isExistentialType())
+    return nullptr;
+
+  TupleExtractInst *Storage = nullptr;
+  for (auto *Op : ArrayAlloc->getUses()) {
+    auto *TEI = dyn_cast<TupleExtractInst>(Op->getUser());
+    if (!TEI)
+      return nullptr;
+    if (TEI == ArrayValue)
+      continue;
+    if (TEI->getFieldNo() != 1 || Storage)
+      return nullptr;
+    Storage = TEI;
+  }
+  if (!Storage || !Storage->hasOneUse())
+    return nullptr;
+  auto *Elements = dyn_cast<PointerToAddressInst>(
+      Storage->use_begin()->getUser());
+  if (!Elements)
+    return nullptr;
+
+  // The array must be allocated with a constant number of segments.
+  SILValue Count = ArrayAlloc->getArgument(0);
+  if (auto *SI = dyn_cast<StructInst>(Count))
+    if (SI->getNumOperands() == 1)
+      Count = SI->getOperand(0);
+  auto *CountLiteral = dyn_cast<IntegerLiteralInst>(Count);
+  if (!CountLiteral)
+    return nullptr;
+  uint64_t NumSegments = CountLiteral->getValue().getLimitedValue();
+  if (NumSegments == 0 ||
+      NumSegments > uint64_t(std::distance(Elements->use_begin(),
+                                           Elements->use_end())))
+    return nullptr;
+
+  // Collect the stores of the segments, indexed by their position.
+  llvm::SmallVector<StoreInst *, 8> Stores(NumSegments, nullptr);
+  llvm::SmallVector<SILInstruction *, 8> ArrayInsts;
+  auto addStore = [&](StoreInst *SI, uint64_t Index) -> bool {
+    if (SI->getParent() != AI->getParent() || Index >= NumSegments)
+      return false;
+    if (Stores[Index])
+      return false;
+    Stores[Index] = SI;
+    return true;
+  };
+  for (auto *Op : Elements->getUses()) {
+    auto *User = Op->getUser();
+    if (auto *SI = dyn_cast<StoreInst>(User)) {
+      if (SI->getDest().getDef() != Elements || !addStore(SI, 0))
+        return nullptr;
+      continue;
+    }
+    auto *IA = dyn_cast<IndexAddrInst>(User);
+    if (!IA || !IA->hasOneUse())
+      return nullptr;
+    auto *Index = dyn_cast<IntegerLiteralInst>(IA->getIndex());
+    auto *SI = dyn_cast<StoreInst>(IA->use_begin()->getUser());
+    if (!Index || !SI || SI->getDest().getDef() != IA ||
+        !addStore(SI, Index->getValue().getZExtValue()))
+      return nullptr;
+    ArrayInsts.push_back(IA);
+  }
+
+  // All segments must be stored before the interpolation.
+  unsigned NumStoresSeen = 0;
+  for (auto II = ArrayAlloc->getIterator(); &*II != AI; ++II)
+    if (auto *SI = dyn_cast<StoreInst>(&*II))
+      if (std::find(Stores.begin(), Stores.end(), SI) != Stores.end())
+        ++NumStoresSeen;
+  if (NumStoresSeen != NumSegments)
+    return nullptr;
+
+  // Concatenate the constant segments.
+  std::string Text;
+  llvm::SmallVector<SILInstruction *, 16> SegmentInsts;
+  ApplyInst *UTF8Literal = nullptr;
+  for (auto *SI : Stores) {
+    if (!SI || !collectConstantSegment(SI->getSrc(), Text, SegmentInsts,
+                                       UTF8Literal))
+      return nullptr;
+  }
+
+  // The folded string is created in the same way as a UTF-8 literal segment.
+  if (!UTF8Literal)
+    return nullptr;
+
+  bool IsASCII = std::all_of(Text.begin(), Text.end(),
+                             [](char C) { return (unsigned char)C < 0x80; });
+
+  B.setCurrentDebugScope(AI->getDebugScope());
+  SILValue Arguments[] = {
+    B.createStringLiteral(AI->getLoc(), Text,
+                          StringLiteralInst::Encoding::UTF8),
+    B.createIntegerLiteral(AI->getLoc(), UTF8Literal->getOperand(2).getType(),
+                           Text.size()),
+    B.createIntegerLiteral(AI->getLoc(), UTF8Literal->getOperand(3).getType(),
+                           intmax_t(IsASCII)),
+    AI->getArgument(1)
+  };
+  SILValue FnRef = UTF8Literal->getCallee();
+  auto FnTy = FnRef.getType();
+  auto STResultType = FnTy.castTo<SILFunctionType>()->getResult().getSILType();
+  auto *NewAI = B.createApply(AI->getLoc(), FnRef, FnTy, STResultType,
+                              ArrayRef<Substitution>(), Arguments, false);
+  SILValue(AI).replaceAllUsesWith(NewAI);
+
+  // Delete the interpolation together with the construction of the array and
+  // its segments. All of them are only used by each other.
+  ArrayInsts.append(Stores.begin(), Stores.end());
+  ArrayInsts.append(SegmentInsts.begin(), SegmentInsts.end());
+  ArrayInsts.push_back(Elements);
+  ArrayInsts.push_back(Storage);
+  ArrayInsts.push_back(AI);
+  ArrayInsts.push_back(ArrayValue);
+  ArrayInsts.push_back(ArrayAlloc);
+  recursivelyDeleteTriviallyDeadInstructions(ArrayInsts, /*force*/ true,
+                                             Callback);
+  return NewAI;
+}
+
 //===----------------------------------------------------------------------===//
 //                              Closure Deletion
 //===----------------------------------------------------------------------===//
@@ -972,6 +1196,29 @@ static void releaseCapturedArgsOfDeadPartialApply(PartialApplyInst *PAI,
   }
 }
 
+bool swift::isNoEscapeClosure(PartialApplyInst *PAI) {
+  auto *FRI = dyn_cast<FunctionRefInst>(PAI->getCallee());
+  if (!FRI)
+    return false;
+  SILFunction *Callee = FRI->getReferencedFunction();
+
+  // A reabstraction thunk only forwards to the closure it captures, so it
+  // inherits the closure's lifetime.
+  if (Callee->isThunk() == IsReabstractionThunk) {
+    for (SILValue Arg : PAI->getArguments()) {
+      if (auto *Inner = dyn_cast<PartialApplyInst>(Arg))
+        if (isNoEscapeClosure(Inner))
+          return true;
+    }
+    return false;
+  }
+
+  if (!Callee->hasLocation())
+    return false;
+  auto *Closure = Callee->getLocation().getAsASTNode<AbstractClosureExpr>();
+  return Closure && AnyFunctionRef(Closure).isKnownNoEscape();
+}
+
 /// TODO: Generalize this to general objects.
 bool swift::tryDeleteDeadClosure(SILInstruction *Closure,
                                  InstModCallbacks Callbacks) {
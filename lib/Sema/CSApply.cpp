@@ -5645,7 +5645,8 @@ namespace {
 
         // If this is a single-expression closure, convert the expression
         // in the body to the result type of the closure.
-        if (closure->hasSingleExpressionBody()) {
+        if (closure->hasSingleExpressionBody() &&
+            !cs.DeferredClosureBodies.count(closure)) {
           // Enter the context of the closure when type-checking the body.
           llvm::SaveAndRestore<DeclContext *> savedDC(Rewriter.dc, closure);
           Expr *body = closure->getSingleExpressionBody()->walk(*this);
@@ -5671,8 +5672,9 @@ namespace {
             }
           }
         } else {
-          // For other closures, type-check the body once we've finished with
-          // the expression.
+          // For other closures, and single-expression closures whose bodies
+          // were left out of the system, type-check the body once we've
+          // finished with the expression.
           closuresToTypeCheck.push_back(closure);
         }
 
@@ -319,6 +319,10 @@ namespace {
         conformance->getWitness(requirement.front(), &CS.TC);
     if (!witness)
       return;
+
+    // An explicit '==' is found by name lookup already.
+    if (!witness.getDecl()->isImplicit())
+      return;
     
     // FIXME: If we ever have derived == for generic types, we may need to
     // revisit this.
@@ -855,6 +859,67 @@ namespace {
   class ConstraintGenerator : public ExprVisitor<ConstraintGenerator, Type> {
     ConstraintSystem &CS;
 
+    /// If every expression in \p exprs is a literal of the same kind whose
+    /// type is still an unbound type variable, merge those type variables
+    /// into one equivalence class.
+    ///
+    /// Homogeneous literals in a collection always end up with the same
+    /// type, so this lets the solver bind one type variable instead of one
+    /// per element, keeping large literal tables linear.
+    ///
+    /// \returns true if the literals now share a single type variable.
+    bool unifyHomogeneousLiterals(ArrayRef<Expr *> exprs) {
+      if (exprs.size() < 2)
+        return false;
+
+      auto kind = exprs.front()->getKind();
+      switch (kind) {
+      case ExprKind::IntegerLiteral:
+      case ExprKind::FloatLiteral:
+      case ExprKind::BooleanLiteral:
+      case ExprKind::StringLiteral:
+        break;
+      default:
+        return false;
+      }
+
+      SmallVector<TypeVariableType *, 16> typeVars;
+      for (auto expr : exprs) {
+        if (expr->getKind() != kind || !expr->getType())
+          return false;
+        auto typeVar = expr->getType()->getAs<TypeVariableType>();
+        if (!typeVar || CS.getFixedType(typeVar))
+          return false;
+        typeVars.push_back(typeVar);
+      }
+
+      for (auto typeVar : makeArrayRef(typeVars).slice(1)) {
+        auto rep1 = CS.getRepresentative(typeVars.front());
+        auto rep2 = CS.getRepresentative(typeVar);
+        if (rep1 != rep2)
+          CS.mergeEquivalenceClasses(rep1, rep2);
+      }
+      return true;
+    }
+
+    /// Add a conversion from each element of a collection literal to
+    /// \p elementTy, or just from the first one if \p unified says that all
+    /// the elements share a type.
+    void addElementConversions(CollectionExpr *expr, Type elementTy,
+                               bool unified) {
+      unsigned index = 0;
+      for (auto element : expr->getElements()) {
+        CS.addConstraint(ConstraintKind::Conversion,
+                         element->getType(),
+                         elementTy,
+                         CS.getConstraintLocator(
+                           expr,
+                           LocatorPathElt::getTupleElement(index++)));
+        if (unified)
+          break;
+      }
+    }
+
     /// \brief Add constraints for a reference to a named member of the given
     /// base type, and return the type of such a reference.
     Type addMemberRefConstraints(Expr *expr, Expr *base, DeclName name) {
@@ -1554,15 +1619,8 @@ namespace {
                          arrayProto->getDeclaredType(),
                          locator);
         
-        unsigned index = 0;
-        for (auto element : expr->getElements()) {
-          CS.addConstraint(ConstraintKind::Conversion,
-                           element->getType(),
-                           contextualArrayElementType,
-                           CS.getConstraintLocator(expr,
-                                                   LocatorPathElt::
-                                                    getTupleElement(index++)));
-        }
+        addElementConversions(expr, contextualArrayElementType,
+                              unifyHomogeneousLiterals(expr->getElements()));
         
         return contextualArrayType;
       }
@@ -1586,15 +1644,8 @@ namespace {
 
       // Introduce conversions from each element to the element type of the
       // array.
-      unsigned index = 0;
-      for (auto element : expr->getElements()) {
-        CS.addConstraint(ConstraintKind::Conversion,
-                         element->getType(),
-                         arrayElementTy,
-                         CS.getConstraintLocator(
-                           expr,
-                           LocatorPathElt::getTupleElement(index++)));
-      }
+      addElementConversions(expr, arrayElementTy,
+                            unifyHomogeneousLiterals(expr->getElements()));
 
       return arrayTy;
     }
@@ -1649,16 +1700,23 @@ namespace {
       Type elementTy = TupleType::get(tupleElts, C);
 
       // Introduce conversions from each element to the element type of the
-      // dictionary.
-      unsigned index = 0;
+      // dictionary. If the keys and the values are each homogeneous literals,
+      // every element has the same tuple type and one conversion will do.
+      SmallVector<Expr *, 16> keys;
+      SmallVector<Expr *, 16> values;
       for (auto element : expr->getElements()) {
-        CS.addConstraint(ConstraintKind::Conversion,
-                         element->getType(),
-                         elementTy,
-                         CS.getConstraintLocator(
-                           expr,
-                           LocatorPathElt::getTupleElement(index++)));
-      }
+        auto tuple = dyn_cast<TupleExpr>(element);
+        if (!tuple || tuple->getNumElements() != 2 ||
+            tuple->getElement(0)->getType().isNull() ||
+            tuple->getElement(1)->getType().isNull())
+          break;
+        keys.push_back(tuple->getElement(0));
+        values.push_back(tuple->getElement(1));
+      }
+      bool unified = keys.size() == expr->getElements().size() &&
+                     unifyHomogeneousLiterals(keys) &&
+                     unifyHomogeneousLiterals(values);
+      addElementConversions(expr, elementTy, unified);
 
       return dictionaryTy;
     }
@@ -2545,6 +2603,14 @@ namespace {
           // Visit the closure itself, which produces a function type.
           auto funcTy = CG.visit(expr)->castTo<FunctionType>();
           expr->setType(funcTy);
+
+          // If closure bodies are deferred, the function type has to be
+          // determined by the context alone.
+          auto &CS = CG.getConstraintSystem();
+          if (CS.Options.contains(ConstraintSystemFlags::DeferClosureBodies)) {
+            CS.DeferredClosureBodies.insert(closure);
+            return { false, expr };
+          }
         }
 
         return { true, expr };
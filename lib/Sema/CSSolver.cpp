@@ -390,6 +390,8 @@ void truncate(SmallVectorImpl<T> &vec, unsigned newSize) {
 } // end anonymous namespace
 
 ConstraintSystem::SolverState::SolverState(ConstraintSystem &cs) : CS(cs) {
+  NumDeferredClosureBodies = cs.DeferredClosureBodies.size();
+
   ++NumSolutionAttempts;
   SolutionAttempt = NumSolutionAttempts;
 
@@ -416,6 +418,12 @@ ConstraintSystem::SolverState::~SolverState() {
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
 
+  // Attribute the work to the expression being timed, if any.
+  if (auto *counters = CS.getTypeChecker().getActiveSolverCounters()) {
+    #define CS_STATISTIC(Name, Description) counters->Name += Name;
+    #include "ConstraintSolverStats.def"
+  }
+
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
   // FIXME: This is not at all thread-safe.
@@ -1032,6 +1040,15 @@ static bool tryTypeVariableBindings(
     return true;
   }
 
+  // Likewise if it has already attempted as many bindings as it is allowed.
+  // Unlike the memory threshold, this doesn't depend on the host.
+  unsigned bindingThreshold = cs.TC.Context.LangOpts.SolverBindingThreshold;
+  if (bindingThreshold &&
+      cs.solverState->NumTypeVariableBindings >= bindingThreshold) {
+    cs.setExpressionTooComplex(true);
+    return true;
+  }
+
   for (unsigned tryCount = 0; !anySolved && !bindings.empty(); ++tryCount) {
     // Try each of the bindings in turn.
     ++cs.solverState->NumTypeVariableBindings;
@@ -1245,6 +1262,7 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
   SmallVector<TypeVariableType *, 16> typeVars(TypeVariables);
   SmallVector<unsigned, 16> components;
   unsigned numComponents = CG.computeConnectedComponents(typeVars, components);
+  ++solverState->NumComponentComputations;
 
   // If we don't have more than one component, just solve the whole
   // system.
@@ -1252,6 +1270,13 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     return solveSimplified(solutions, allowFreeTypeVariables);
   }
 
+  // Every binding and disjunction choice re-enters solveRec, so a component
+  // that falls apart once some of its type variables are bound is split
+  // again here, at whatever depth that happens.
+  ++solverState->NumComponentSplits;
+  if (solverState->depth > 0)
+    ++solverState->NumNestedComponentSplits;
+
   if (TC.Context.LangOpts.DebugConstraintSolver) {
     auto &log = getASTContext().TypeCheckerDebug->getStream();
 
@@ -1507,6 +1532,48 @@ static bool shortCircuitDisjunctionAt(Constraint *constraint,
   return false;
 }
 
+/// Compute the key under which a failure to simplify the given disjunction
+/// term can be remembered across constraint systems.
+///
+/// Only relational constraints whose types are fully resolved qualify: the
+/// outcome of simplifying them depends on nothing but the two types, the
+/// constraint kind and the conversion restriction.
+static Optional<TypeChecker::ConstraintShapeKey>
+getDisjunctionTermShape(ConstraintSystem &cs, Constraint *constraint) {
+  if (cs.shouldAttemptFixes() || constraint->getFix())
+    return None;
+
+  switch (constraint->getKind()) {
+  case ConstraintKind::Bind:
+  case ConstraintKind::Equal:
+  case ConstraintKind::BindParam:
+  case ConstraintKind::Subtype:
+  case ConstraintKind::Conversion:
+  case ConstraintKind::ExplicitConversion:
+  case ConstraintKind::ArgumentConversion:
+  case ConstraintKind::ArgumentTupleConversion:
+  case ConstraintKind::OperatorArgumentTupleConversion:
+  case ConstraintKind::OperatorArgumentConversion:
+  case ConstraintKind::ConformsTo:
+    break;
+  default:
+    return None;
+  }
+
+  Type first = cs.simplifyType(constraint->getFirstType());
+  Type second = cs.simplifyType(constraint->getSecondType());
+  if (!first || !second || first->hasTypeVariable() ||
+      second->hasTypeVariable())
+    return None;
+
+  unsigned shape = static_cast<unsigned>(constraint->getKind());
+  if (auto restriction = constraint->getRestriction())
+    shape |= (static_cast<unsigned>(*restriction) + 1) << 8;
+
+  return TypeChecker::ConstraintShapeKey(
+           { first->getCanonicalType(), second->getCanonicalType() }, shape);
+}
+
 bool ConstraintSystem::solveSimplified(
        SmallVectorImpl<Solution> &solutions,
        FreeTypeVariableBinding allowFreeTypeVariables) {
@@ -1627,6 +1694,20 @@ bool ConstraintSystem::solveSimplified(
     if (getExpressionTooComplex())
       break;
 
+    // If a term of this shape already failed, in this or any earlier
+    // constraint system, don't bother exploring it again.
+    auto termShape = getDisjunctionTermShape(*this, constraint);
+    if (termShape && TC.FailedDisjunctionTerms.count(*termShape)) {
+      ++solverState->NumDisjunctionTermsSkipped;
+      if (TC.getLangOpts().DebugConstraintSolver) {
+        auto &log = getASTContext().TypeCheckerDebug->getStream();
+        log.indent(solverState->depth * 2) << "(skipping known failure ";
+        constraint->print(log, &TC.Context.SourceMgr);
+        log << ")\n";
+      }
+      continue;
+    }
+
     // Try to solve the system with this option in the disjunction.
     SolverScope scope(*this);
     ++solverState->NumDisjunctionTerms;
@@ -1659,6 +1740,8 @@ bool ConstraintSystem::solveSimplified(
       if (!failedConstraint)
         failedConstraint = constraint;
       solverState->retiredConstraints.push_back(constraint);
+      if (termShape)
+        TC.FailedDisjunctionTerms.insert(*termShape);
       break;
 
     case SolutionKind::Solved:
@@ -35,7 +35,7 @@ ConstraintGraph::~ConstraintGraph() {
   assert(Changes.empty() && "Scope stack corrupted");
   for (unsigned i = 0, n = TypeVariables.size(); i != n; ++i) {
     auto &impl = TypeVariables[i]->getImpl();
-    delete impl.getGraphNode();
+    impl.getGraphNode()->~ConstraintGraphNode();
     impl.setGraphNode(0);
   }
 }
@@ -53,8 +53,10 @@ ConstraintGraph::lookupNode(TypeVariableType *typeVar) {
     return { *nodePtr, impl.getGraphIndex() };
   }
 
-  // Allocate the new node.
-  auto nodePtr = new ConstraintGraphNode(typeVar);
+  // Allocate the new node. Its memory lives as long as the constraint system's
+  // allocator, so only its destructor is run when it is removed.
+  void *mem = CS.getAllocator().Allocate<ConstraintGraphNode>();
+  auto nodePtr = new (mem) ConstraintGraphNode(typeVar);
   unsigned index = TypeVariables.size();
   impl.setGraphNode(nodePtr);
   impl.setGraphIndex(index);
@@ -362,7 +364,7 @@ void ConstraintGraph::removeNode(TypeVariableType *typeVar) {
   // Remove this node.
   auto &impl = typeVar->getImpl();
   unsigned index = impl.getGraphIndex();
-  delete impl.getGraphNode();
+  impl.getGraphNode()->~ConstraintGraphNode();
   impl.setGraphNode(0);
 
   // Remove this type variable from the list.
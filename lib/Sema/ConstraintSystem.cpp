@@ -26,6 +26,7 @@ using namespace constraints;
 ConstraintSystem::ConstraintSystem(TypeChecker &tc, DeclContext *dc,
                                    ConstraintSystemOptions options)
   : TC(tc), DC(dc), Options(options),
+    LeasedAllocator(tc), Allocator(LeasedAllocator.get()),
     Arena(tc.Context, Allocator, 
           [&](TypeVariableType *baseTypeVar, AssociatedTypeDecl *assocType) {
             return getMemberType(baseTypeVar, assocType,
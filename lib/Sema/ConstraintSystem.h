@@ -1045,7 +1045,11 @@ typedef llvm::ilist<Constraint> ConstraintList;
 
 enum class ConstraintSystemFlags {
   /// Whether we allow the solver to attempt fixes to the system.
-  AllowFixes = 0x01
+  AllowFixes = 0x01,
+
+  /// Whether the bodies of single-expression closures are left out of the
+  /// system, to be type-checked on their own once it has been solved.
+  DeferClosureBodies = 0x02
 };
 
 /// Options that affect the constraint system as a whole.
@@ -1143,6 +1147,10 @@ public:
 
   class SolverScope;
 
+  /// The single-expression closures whose bodies were left out of the
+  /// system because of DeferClosureBodies.
+  llvm::SmallPtrSet<ClosureExpr *, 4> DeferredClosureBodies;
+
   Constraint *failedConstraint = nullptr;
 
   /// \brief Failures that occured while solving.
@@ -1155,8 +1163,30 @@ public:
 
 private:
 
+  /// \brief Borrows a solver allocator from the type checker for the
+  /// lifetime of the constraint system, and gives it back reset.
+  class AllocatorLease {
+    TypeChecker &TC;
+    std::unique_ptr<llvm::BumpPtrAllocator> Allocator;
+
+  public:
+    explicit AllocatorLease(TypeChecker &tc)
+      : TC(tc), Allocator(tc.takeSolverAllocator()) { }
+
+    AllocatorLease(const AllocatorLease &) = delete;
+    AllocatorLease &operator=(const AllocatorLease &) = delete;
+
+    ~AllocatorLease() {
+      TC.releaseSolverAllocator(std::move(Allocator));
+    }
+
+    llvm::BumpPtrAllocator &get() const { return *Allocator; }
+  };
+
+  AllocatorLease LeasedAllocator;
+
   /// \brief Allocator used for all of the related constraint systems.
-  llvm::BumpPtrAllocator Allocator;
+  llvm::BumpPtrAllocator &Allocator;
 
   /// \brief Arena used for memory management of constraint-checker-related
   /// allocations.
@@ -24,28 +24,112 @@
 #include "swift/AST/Types.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "DerivedConformances.h"
 
 using namespace swift;
 using namespace DerivedConformance;
 
+/// Returns the types of the values which decide whether two values of
+/// \p type are equal: the stored properties of a struct, or the payloads of
+/// an enum.
+static void getMemberTypes(TypeChecker &tc, NominalTypeDecl *type,
+                           SmallVectorImpl<Type> &types) {
+  if (auto structDecl = dyn_cast<StructDecl>(type)) {
+    for (auto prop : structDecl->getStoredProperties()) {
+      tc.validateDecl(prop);
+      types.push_back(prop->getType());
+    }
+    return;
+  }
+
+  for (auto elt : cast<EnumDecl>(type)->getAllElements()) {
+    tc.validateDecl(elt);
+    if (!elt->hasArgumentType())
+      continue;
+    auto argType = elt->getArgumentType();
+    if (auto tupleType = argType->getAs<TupleType>()) {
+      for (auto eltType : tupleType->getElementTypes())
+        types.push_back(eltType);
+    } else {
+      types.push_back(argType);
+    }
+  }
+}
+
 /// Common preconditions for Equatable and Hashable.
-static bool canDeriveConformance(NominalTypeDecl *type) {
-  // The type must be an enum.
-  // TODO: Structs with Equatable/Hashable/Comparable members
+static bool canDeriveConformance(TypeChecker &tc, Decl *parentDecl,
+                                 NominalTypeDecl *type, ProtocolDecl *proto) {
+  // Enums without associated values are compared by case.
   auto enumDecl = dyn_cast<EnumDecl>(type);
-  if (!enumDecl)
+  if (enumDecl && enumDecl->hasOnlyCasesWithoutAssociatedValues())
+    return true;
+
+  // Otherwise, the type must be a struct or an enum whose members all
+  // conform.
+  if (!enumDecl && !isa<StructDecl>(type))
     return false;
-  
-  // The enum must not have associated values.
-  // TODO: Enums with Equatable/Hashable/Comparable payloads
-  if (!enumDecl->hasOnlyCasesWithoutAssociatedValues())
+
+  // The stored properties of a type from another module are none of our
+  // business.
+  if (parentDecl->getModuleContext() != type->getModuleContext()) {
+    tc.diagnose(parentDecl->getLoc(), diag::type_does_not_conform,
+                type->getDeclaredType(), proto->getDeclaredType());
     return false;
-  
+  }
+
+  auto parentDC = cast<DeclContext>(parentDecl);
+  SmallVector<Type, 4> memberTypes;
+  getMemberTypes(tc, type, memberTypes);
+  for (auto memberType : memberTypes) {
+    if (memberType->is<ErrorType>())
+      return false;
+    if (!tc.conformsToProtocol(memberType, proto, parentDC, None)) {
+      tc.diagnose(parentDecl->getLoc(), diag::type_does_not_conform,
+                  type->getDeclaredType(), proto->getDeclaredType());
+      tc.diagnose(parentDecl->getLoc(),
+                  diag::cannot_derive_conformance_member,
+                  proto->getDeclaredType(), memberType);
+      return false;
+    }
+  }
   return true;
 }
 
+/// Returns an implicit integer literal for \p value.
+static IntegerLiteralExpr *getIntegerLiteral(ASTContext &C, unsigned value) {
+  llvm::SmallString<8> valueStr;
+  APInt(32, value).toString(valueStr, 10, /*signed*/ false);
+  auto str = C.AllocateCopy(valueStr);
+  return new (C) IntegerLiteralExpr(StringRef(str.data(), str.size()),
+                                    SourceLoc(), /*implicit*/ true);
+}
+
+/// Declares an uninitialized 'var <name>: Int' in \p funcDecl, appending
+/// the declaration to \p stmts.
+static VarDecl *declareIntVar(SmallVectorImpl<ASTNode> &stmts,
+                              AbstractFunctionDecl *funcDecl,
+                              const char *name) {
+  ASTContext &C = funcDecl->getASTContext();
+  Type intType = C.getIntDecl()->getDeclaredType();
+
+  auto var = new (C) VarDecl(/*static*/false, /*let*/false,
+                             SourceLoc(), C.getIdentifier(name),
+                             intType, funcDecl);
+  var->setImplicit();
+
+  Pattern *pat = new (C) NamedPattern(var, /*implicit*/ true);
+  pat->setType(intType);
+  pat = new (C) TypedPattern(pat, TypeLoc::withoutLoc(intType));
+  pat->setType(intType);
+  stmts.push_back(PatternBindingDecl::create(C, SourceLoc(),
+                                             StaticSpellingKind::None,
+                                             SourceLoc(), pat, nullptr,
+                                             funcDecl));
+  return var;
+}
+
 /// Create AST statements which convert from an enum to an Int with a switch.
 /// \p stmts The generated statements are appended to this vector.
 /// \p parentDC Either an extension or the enum itself.
@@ -64,20 +148,8 @@ static DeclRefExpr *convertEnumToIndex(SmallVectorImpl<ASTNode> &stmts,
   Type enumType = enumVarDecl->getType();
   Type intType = C.getIntDecl()->getDeclaredType();
 
-  auto indexVar = new (C) VarDecl(/*static*/false, /*let*/false,
-                                  SourceLoc(), C.getIdentifier(indexName),
-                                  intType, funcDecl);
-  indexVar->setImplicit();
-  
   // generate: var indexVar
-  Pattern *indexPat = new (C) NamedPattern(indexVar, /*implicit*/ true);
-  indexPat->setType(intType);
-  indexPat = new (C) TypedPattern(indexPat, TypeLoc::withoutLoc(intType));
-  indexPat->setType(intType);
-  auto indexBind = PatternBindingDecl::create(C, SourceLoc(),
-                                              StaticSpellingKind::None,
-                                              SourceLoc(),
-                                              indexPat, nullptr, funcDecl);
+  auto indexVar = declareIntVar(stmts, funcDecl, indexName);
 
   unsigned index = 0;
   SmallVector<CaseStmt*, 4> cases;
@@ -92,13 +164,7 @@ static DeclRefExpr *convertEnumToIndex(SmallVectorImpl<ASTNode> &stmts,
                                    nullptr);
     
     // generate: indexVar = <index>
-    llvm::SmallString<8> indexVal;
-    APInt(32, index++).toString(indexVal, 10, /*signed*/ false);
-    auto indexStr = C.AllocateCopy(indexVal);
-    
-    auto indexExpr = new (C) IntegerLiteralExpr(StringRef(indexStr.data(),
-                                                indexStr.size()), SourceLoc(),
-                                                /*implicit*/ true);
+    auto indexExpr = getIntegerLiteral(C, index++);
     auto indexRef = new (C) DeclRefExpr(indexVar, SourceLoc(),
                                         /*implicit*/true);
     auto assignExpr = new (C) AssignExpr(indexRef, SourceLoc(),
@@ -116,7 +182,6 @@ static DeclRefExpr *convertEnumToIndex(SmallVectorImpl<ASTNode> &stmts,
   auto switchStmt = SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), enumRef,
                                        SourceLoc(), cases, SourceLoc(), C);
   
-  stmts.push_back(indexBind);
   stmts.push_back(switchStmt);
 
   return new (C) DeclRefExpr(indexVar, SourceLoc(), /*implicit*/ true,
@@ -172,9 +237,253 @@ static void deriveBodyEquatable_enum_eq(AbstractFunctionDecl *eqDecl) {
   eqDecl->setBody(body);
 }
 
-/// Derive an '==' operator implementation for an enum.
+/// Returns a rough rank of how expensive comparing two values of \p type is,
+/// so that the derived '==' can compare the cheap members first and bail out
+/// before reaching the expensive ones.
+static unsigned getComparisonCost(ASTContext &C, Type type) {
+  auto nominal = type->getAnyNominal();
+  if (!nominal)
+    return 1;
+
+  // Enums without payloads compare their discriminators.
+  if (auto enumDecl = dyn_cast<EnumDecl>(nominal))
+    return enumDecl->hasOnlyCasesWithoutAssociatedValues() ? 0 : 1;
+
+  // Collections and strings compare element by element.
+  if (nominal == C.getStringDecl() || nominal == C.getArrayDecl() ||
+      nominal == C.getSetDecl() || nominal == C.getDictionaryDecl())
+    return 2;
+
+  // Int, Bool and friends wrap a single builtin value.
+  if (auto structDecl = dyn_cast<StructDecl>(nominal)) {
+    SmallVector<VarDecl *, 2> props(structDecl->getStoredProperties().begin(),
+                                    structDecl->getStoredProperties().end());
+    if (props.size() == 1 && props[0]->hasType() &&
+        props[0]->getType()->is<BuiltinType>())
+      return 0;
+  }
+  return 1;
+}
+
+namespace {
+/// Builds the memberwise comparisons in a derived '==' for a struct or an
+/// enum with payloads.
+class MemberwiseComparisonBuilder {
+  TypeChecker &tc;
+  ASTContext &C;
+  AbstractFunctionDecl *eqDecl;
+  /// The visible '==' overloads, which each comparison picks from.
+  SmallVector<ValueDecl *, 32> eqOperators;
+
+public:
+  MemberwiseComparisonBuilder(TypeChecker &tc, DeclContext *parentDC,
+                              AbstractFunctionDecl *eqDecl)
+    : tc(tc), C(tc.Context), eqDecl(eqDecl) {
+    auto lookup = tc.lookupUnqualified(parentDC->getModuleScopeContext(),
+                                       C.Id_EqualsOperator, SourceLoc());
+    for (auto result : lookup)
+      eqOperators.push_back(result.Decl);
+  }
+
+  /// generate: return <value>
+  Stmt *createReturnBool(bool value) {
+    auto boolExpr = new (C) BooleanLiteralExpr(value, SourceLoc(),
+                                               /*implicit*/ true);
+    return new (C) ReturnStmt(SourceLoc(), boolExpr, /*implicit*/ true);
+  }
+
+  /// Appends the comparisons of \p pairs, cheapest first, to \p stmts,
+  /// followed by 'return true'.
+  ///
+  /// generate: guard <lhs> == <rhs> else { return false }
+  ///           ...
+  ///           return true
+  void addComparisons(SmallVectorImpl<ASTNode> &stmts,
+                      MutableArrayRef<std::pair<Expr *, Expr *>> pairs,
+                      ArrayRef<Type> types) {
+    SmallVector<unsigned, 8> order;
+    for (unsigned i = 0, e = pairs.size(); i != e; ++i)
+      order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](unsigned l, unsigned r) {
+      return getComparisonCost(C, types[l]) < getComparisonCost(C, types[r]);
+    });
+
+    for (unsigned i : order) {
+      auto eqRef = tc.buildRefExpr(eqOperators, eqDecl, SourceLoc(),
+                                   /*implicit*/ true);
+      auto argTuple = TupleExpr::create(C, SourceLoc(),
+                                        { pairs[i].first, pairs[i].second },
+                                        { }, { }, SourceLoc(),
+                                        /*HasTrailingClosure*/ false,
+                                        /*Implicit*/ true);
+      auto cmpExpr = new (C) BinaryExpr(eqRef, argTuple, /*implicit*/ true);
+      auto elseBody = BraceStmt::create(C, SourceLoc(),
+                                        ASTNode(createReturnBool(false)),
+                                        SourceLoc(), /*implicit*/ true);
+      stmts.push_back(new (C) GuardStmt(SourceLoc(), cmpExpr, elseBody,
+                                        /*implicit*/ true, C));
+    }
+    stmts.push_back(createReturnBool(true));
+  }
+};
+} // end anonymous namespace
+
+/// Build the body of an '==' operator for a struct, which compares the
+/// stored properties.
+static BraceStmt *deriveBodyEquatable_struct_eq(TypeChecker &tc,
+                                                DeclContext *parentDC,
+                                                AbstractFunctionDecl *eqDecl,
+                                                StructDecl *structDecl,
+                                                VarDecl *aParam,
+                                                VarDecl *bParam) {
+  ASTContext &C = tc.Context;
+  MemberwiseComparisonBuilder builder(tc, parentDC, eqDecl);
+
+  SmallVector<std::pair<Expr *, Expr *>, 4> pairs;
+  SmallVector<Type, 4> types;
+  for (auto prop : structDecl->getStoredProperties()) {
+    auto getMember = [&](VarDecl *param) -> Expr * {
+      auto paramRef = new (C) DeclRefExpr(param, SourceLoc(),
+                                          /*implicit*/ true);
+      return new (C) MemberRefExpr(paramRef, SourceLoc(), prop, SourceRange(),
+                                   /*implicit*/ true);
+    };
+    pairs.push_back({ getMember(aParam), getMember(bParam) });
+    types.push_back(prop->getType());
+  }
+
+  SmallVector<ASTNode, 8> statements;
+  builder.addComparisons(statements, pairs, types);
+  return BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+}
+
+/// Creates the pattern '.<elt>(let <prefix>0, let <prefix>1, ...)' matching
+/// \p elt, and appends the variables it binds to \p vars.
+static Pattern *createEnumElementPattern(ASTContext &C,
+                                         AbstractFunctionDecl *funcDecl,
+                                         Type enumType, EnumElementDecl *elt,
+                                         StringRef prefix,
+                                         SmallVectorImpl<VarDecl *> &vars) {
+  Pattern *subPattern = nullptr;
+  if (elt->hasArgumentType()) {
+    auto createVar = [&]() -> Pattern * {
+      SmallString<8> name(prefix);
+      name += llvm::utostr(vars.size());
+      auto var = new (C) VarDecl(/*static*/ false, /*let*/ true, SourceLoc(),
+                                 C.getIdentifier(name), Type(), funcDecl);
+      var->setImplicit();
+      vars.push_back(var);
+      auto namedPat = new (C) NamedPattern(var, /*implicit*/ true);
+      return new (C) VarPattern(SourceLoc(), /*isLet*/ true, namedPat,
+                                /*implicit*/ true);
+    };
+
+    auto argType = elt->getArgumentType();
+    if (auto tupleType = argType->getAs<TupleType>()) {
+      SmallVector<TuplePatternElt, 4> elts;
+      for (unsigned i = 0, e = tupleType->getNumElements(); i != e; ++i)
+        elts.push_back(TuplePatternElt(createVar()));
+      subPattern = TuplePattern::create(C, SourceLoc(), elts, SourceLoc(),
+                                        /*implicit*/ true);
+    } else {
+      subPattern = new (C) ParenPattern(SourceLoc(), createVar(), SourceLoc(),
+                                        /*implicit*/ true);
+    }
+  }
+
+  auto pat = new (C) EnumElementPattern(TypeLoc::withoutLoc(enumType),
+                                        SourceLoc(), SourceLoc(),
+                                        Identifier(), elt, subPattern);
+  pat->setImplicit();
+  return pat;
+}
+
+/// Build the body of an '==' operator for an enum with payloads, which
+/// compares the payloads of equal cases.
+static BraceStmt *deriveBodyEquatable_payload_enum_eq(
+                    TypeChecker &tc, DeclContext *parentDC,
+                    AbstractFunctionDecl *eqDecl, EnumDecl *enumDecl,
+                    VarDecl *aParam, VarDecl *bParam) {
+  ASTContext &C = tc.Context;
+  MemberwiseComparisonBuilder builder(tc, parentDC, eqDecl);
+  Type enumType = aParam->getType();
+
+  SmallVector<CaseStmt *, 4> cases;
+  unsigned numElements = 0;
+  for (auto elt : enumDecl->getAllElements()) {
+    ++numElements;
+
+    // generate: case (.<Case>(let l0, ...), .<Case>(let r0, ...)):
+    SmallVector<VarDecl *, 4> lhsVars, rhsVars;
+    TuplePatternElt patElts[] = {
+      TuplePatternElt(createEnumElementPattern(C, eqDecl, enumType, elt, "l",
+                                               lhsVars)),
+      TuplePatternElt(createEnumElementPattern(C, eqDecl, enumType, elt, "r",
+                                               rhsVars)),
+    };
+    auto casePat = TuplePattern::create(C, SourceLoc(), patElts, SourceLoc(),
+                                        /*implicit*/ true);
+    auto labelItem = CaseLabelItem(/*IsDefault=*/false, casePat, SourceLoc(),
+                                   nullptr);
+
+    SmallVector<std::pair<Expr *, Expr *>, 4> pairs;
+    SmallVector<Type, 4> types;
+    if (elt->hasArgumentType()) {
+      auto argType = elt->getArgumentType();
+      if (auto tupleType = argType->getAs<TupleType>())
+        types.append(tupleType->getElementTypes().begin(),
+                     tupleType->getElementTypes().end());
+      else
+        types.push_back(argType);
+    }
+    for (unsigned i = 0, e = lhsVars.size(); i != e; ++i) {
+      pairs.push_back({
+        new (C) DeclRefExpr(lhsVars[i], SourceLoc(), /*implicit*/ true),
+        new (C) DeclRefExpr(rhsVars[i], SourceLoc(), /*implicit*/ true)
+      });
+    }
+
+    SmallVector<ASTNode, 8> statements;
+    builder.addComparisons(statements, pairs, types);
+    auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                     /*HasBoundDecls=*/!lhsVars.empty(),
+                                     SourceLoc(), body));
+  }
+
+  // generate: default: return false
+  // A single-case enum doesn't need it, and would warn that it's unreachable.
+  if (numElements > 1) {
+    auto anyPat = new (C) AnyPattern(SourceLoc());
+    anyPat->setImplicit();
+    auto dfltLabelItem =
+      CaseLabelItem(/*IsDefault=*/true, anyPat, SourceLoc(), nullptr);
+    auto dfltBody = BraceStmt::create(C, SourceLoc(),
+                                      ASTNode(builder.createReturnBool(false)),
+                                      SourceLoc());
+    cases.push_back(CaseStmt::create(C, SourceLoc(), dfltLabelItem,
+                                     /*HasBoundDecls=*/false, SourceLoc(),
+                                     dfltBody));
+  }
+
+  // generate: switch (a, b) { }
+  auto abTuple = TupleExpr::create(C, SourceLoc(),
+                                   { new (C) DeclRefExpr(aParam, SourceLoc(),
+                                                         /*implicit*/ true),
+                                     new (C) DeclRefExpr(bParam, SourceLoc(),
+                                                         /*implicit*/ true) },
+                                   { }, { }, SourceLoc(),
+                                   /*HasTrailingClosure*/ false,
+                                   /*Implicit*/ true);
+  auto switchStmt = SwitchStmt::create(LabeledStmtInfo(), SourceLoc(), abTuple,
+                                       SourceLoc(), cases, SourceLoc(), C);
+  return BraceStmt::create(C, SourceLoc(), ASTNode(switchStmt), SourceLoc());
+}
+
+/// Derive an '==' operator implementation for a struct or an enum.
 static ValueDecl *
-deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
+deriveEquatable_eq(TypeChecker &tc, Decl *parentDecl,
+                   NominalTypeDecl *typeDecl) {
   // enum SomeEnum<T...> {
   //   case A, B, C
   // }
@@ -194,11 +503,33 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   //   }
   //   return index_a == index_b
   // }
+  //
+  // Structs and enums with payloads compare their members instead,
+  // cheapest first:
+  //
+  // @derived
+  // func ==<T...>(a: SomeStruct<T...>, b: SomeStruct<T...>) -> Bool {
+  //   guard a.x == b.x else { return false }
+  //   guard a.y == b.y else { return false }
+  //   return true
+  // }
+  // @derived
+  // func ==<T...>(a: SomeEnum<T...>, b: SomeEnum<T...>) -> Bool {
+  //   switch (a, b) {
+  //   case (.A(let l0), .A(let r0)):
+  //     guard l0 == r0 else { return false }
+  //     return true
+  //   case (.B, .B):
+  //     return true
+  //   default:
+  //     return false
+  //   }
+  // }
   
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
-  auto enumTy = parentDC->getDeclaredTypeInContext();
+  auto selfTy = parentDC->getDeclaredTypeInContext();
   
   auto getParamPattern = [&](StringRef s) -> std::pair<VarDecl*, Pattern*> {
     VarDecl *aDecl = new (C) ParamDecl(/*isLet*/ true,
@@ -206,13 +537,13 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
                                        Identifier(),
                                        SourceLoc(),
                                        C.getIdentifier(s),
-                                       enumTy,
+                                       selfTy,
                                        parentDC);
     aDecl->setImplicit();
     Pattern *aParam = new (C) NamedPattern(aDecl, /*implicit*/ true);
-    aParam->setType(enumTy);
-    aParam = new (C) TypedPattern(aParam, TypeLoc::withoutLoc(enumTy));
-    aParam->setType(enumTy);
+    aParam->setType(selfTy);
+    aParam = new (C) TypedPattern(aParam, TypeLoc::withoutLoc(selfTy));
+    aParam->setType(selfTy);
     aParam->setImplicit();
     return {aDecl, aParam};
   };
@@ -221,8 +552,8 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   auto bParam = getParamPattern("b");
   
   TupleTypeElt typeElts[] = {
-    TupleTypeElt(enumTy),
-    TupleTypeElt(enumTy)
+    TupleTypeElt(selfTy),
+    TupleTypeElt(selfTy)
   };
   auto paramsTy = TupleType::get(typeElts, C);
   
@@ -263,17 +594,31 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   }
 
   eqDecl->setOperatorDecl(op);
-  eqDecl->setDerivedForTypeDecl(enumDecl);
-  eqDecl->setBodySynthesizer(&deriveBodyEquatable_enum_eq);
+  eqDecl->setDerivedForTypeDecl(typeDecl);
+
+  // The memberwise comparisons need to look up '==' for each member, so they
+  // are built right away rather than when the body is needed.
+  auto enumDecl = dyn_cast<EnumDecl>(typeDecl);
+  if (enumDecl && enumDecl->hasOnlyCasesWithoutAssociatedValues())
+    eqDecl->setBodySynthesizer(&deriveBodyEquatable_enum_eq);
+  else if (enumDecl)
+    eqDecl->setBody(deriveBodyEquatable_payload_enum_eq(tc, parentDC, eqDecl,
+                                                        enumDecl, aParam.first,
+                                                        bParam.first));
+  else
+    eqDecl->setBody(deriveBodyEquatable_struct_eq(tc, parentDC, eqDecl,
+                                                  cast<StructDecl>(typeDecl),
+                                                  aParam.first,
+                                                  bParam.first));
 
   // Compute the type and interface type.
   Type fnTy, interfaceTy;
   if (genericParams) {
     fnTy = PolymorphicFunctionType::get(paramsTy, boolTy, genericParams);
     
-    auto enumIfaceTy = parentDC->getDeclaredInterfaceType();
+    auto selfIfaceTy = parentDC->getDeclaredInterfaceType();
     TupleTypeElt ifaceParamElts[] = {
-      enumIfaceTy, enumIfaceTy,
+      selfIfaceTy, selfIfaceTy,
     };
     auto ifaceParamsTy = TupleType::get(ifaceParamElts, C);
     
@@ -287,12 +632,12 @@ deriveEquatable_enum_eq(TypeChecker &tc, Decl *parentDecl, EnumDecl *enumDecl) {
   eqDecl->setType(fnTy);
   eqDecl->setInterfaceType(interfaceTy);
 
-  // Since we can't insert the == operator into the same FileUnit as the enum,
+  // Since we can't insert the == operator into the same FileUnit as the type,
   // itself, we have to give it at least internal access.
-  eqDecl->setAccessibility(std::max(enumDecl->getFormalAccess(),
+  eqDecl->setAccessibility(std::max(typeDecl->getFormalAccess(),
                                     Accessibility::Internal));
 
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.implicitlyDefinedFunctions.push_back(eqDecl);
   
   // Since it's an operator we insert the decl after the type at global scope.
@@ -304,16 +649,13 @@ ValueDecl *DerivedConformance::deriveEquatable(TypeChecker &tc,
                                                NominalTypeDecl *type,
                                                ValueDecl *requirement) {
   // Check that we can actually derive Equatable for this type.
-  if (!canDeriveConformance(type))
+  auto proto = tc.Context.getProtocol(KnownProtocolKind::Equatable);
+  if (!canDeriveConformance(tc, parentDecl, type, proto))
     return nullptr;
 
   // Build the necessary decl.
-  if (requirement->getName().str() == "==") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveEquatable_enum_eq(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
-  }
+  if (requirement->getName().str() == "==")
+    return deriveEquatable_eq(tc, parentDecl, type);
   tc.diagnose(requirement->getLoc(),
               diag::broken_equatable_requirement);
   return nullptr;
@@ -347,10 +689,122 @@ deriveBodyHashable_enum_hashValue(AbstractFunctionDecl *hashValueDecl) {
   hashValueDecl->setBody(body);
 }
 
-/// Derive a 'hashValue' implementation for an enum.
+/// Returns the standard library's '_combineHashValues', or null if it is
+/// missing.
+static FuncDecl *getCombineHashValuesDecl(ASTContext &C) {
+  auto stdlib = C.getStdlibModule();
+  if (!stdlib)
+    return nullptr;
+
+  SmallVector<ValueDecl *, 1> results;
+  stdlib->lookupValue({ }, C.getIdentifier("_combineHashValues"),
+                      NLKind::QualifiedLookup, results);
+  for (auto result : results)
+    if (auto func = dyn_cast<FuncDecl>(result))
+      return func;
+  return nullptr;
+}
+
+/// generate: <var> = <value>
+static Expr *createAssignment(ASTContext &C, VarDecl *var, Expr *value) {
+  auto varRef = new (C) DeclRefExpr(var, SourceLoc(), /*implicit*/ true);
+  return new (C) AssignExpr(varRef, SourceLoc(), value, /*implicit*/ true);
+}
+
+/// generate: result = _combineHashValues(result, <value>.hashValue)
+static Expr *createCombineHashValue(ASTContext &C, FuncDecl *combineFn,
+                                    VarDecl *resultVar, Expr *value) {
+  auto hashValue = new (C) UnresolvedDotExpr(value, SourceLoc(),
+                                             C.Id_hashValue, SourceLoc(),
+                                             /*implicit*/ true);
+  auto resultRef = new (C) DeclRefExpr(resultVar, SourceLoc(),
+                                       /*implicit*/ true);
+  auto argTuple = TupleExpr::create(C, SourceLoc(), { resultRef, hashValue },
+                                    { }, { }, SourceLoc(),
+                                    /*HasTrailingClosure*/ false,
+                                    /*Implicit*/ true);
+  auto combineRef = new (C) DeclRefExpr(combineFn, SourceLoc(),
+                                        /*implicit*/ true);
+  auto call = new (C) CallExpr(combineRef, argTuple, /*implicit*/ true);
+  return createAssignment(C, resultVar, call);
+}
+
+static void
+deriveBodyHashable_memberwise_hashValue(AbstractFunctionDecl *hashValueDecl) {
+  auto parentDC = hashValueDecl->getDeclContext();
+  ASTContext &C = parentDC->getASTContext();
+
+  auto combineFn = getCombineHashValuesDecl(C);
+  assert(combineFn && "should have _combineHashValues as we checked for it");
+
+  Pattern *curriedArgs = hashValueDecl->getBodyParamPatterns().front();
+  auto selfPattern =
+    cast<NamedPattern>(curriedArgs->getSemanticsProvidingPattern());
+  auto selfDecl = selfPattern->getDecl();
+
+  SmallVector<ASTNode, 8> statements;
+  auto resultVar = declareIntVar(statements, hashValueDecl, "result");
+
+  auto nominal = parentDC->isNominalTypeOrNominalTypeExtensionContext();
+  if (auto structDecl = dyn_cast<StructDecl>(nominal)) {
+    statements.push_back(createAssignment(C, resultVar,
+                                          getIntegerLiteral(C, 0)));
+    for (auto prop : structDecl->getStoredProperties()) {
+      auto selfRef = new (C) DeclRefExpr(selfDecl, SourceLoc(),
+                                         /*implicit*/ true);
+      auto propRef = new (C) MemberRefExpr(selfRef, SourceLoc(), prop,
+                                           SourceRange(), /*implicit*/ true);
+      statements.push_back(createCombineHashValue(C, combineFn, resultVar,
+                                                  propRef));
+    }
+  } else {
+    auto enumDecl = cast<EnumDecl>(nominal);
+    unsigned index = 0;
+    SmallVector<CaseStmt *, 4> cases;
+    for (auto elt : enumDecl->getAllElements()) {
+      // generate: case .<Case>(let a0, ...):
+      SmallVector<VarDecl *, 4> vars;
+      auto pat = createEnumElementPattern(C, hashValueDecl, selfDecl->getType(),
+                                          elt, "a", vars);
+      auto labelItem = CaseLabelItem(/*IsDefault=*/false, pat, SourceLoc(),
+                                     nullptr);
+
+      // The case index seeds the hash, so that cases with equal payloads
+      // don't collide.
+      SmallVector<ASTNode, 4> caseStmts;
+      caseStmts.push_back(createAssignment(C, resultVar,
+                                           getIntegerLiteral(C, index++)));
+      for (auto var : vars) {
+        auto varRef = new (C) DeclRefExpr(var, SourceLoc(), /*implicit*/ true);
+        caseStmts.push_back(createCombineHashValue(C, combineFn, resultVar,
+                                                   varRef));
+      }
+      auto body = BraceStmt::create(C, SourceLoc(), caseStmts, SourceLoc());
+      cases.push_back(CaseStmt::create(C, SourceLoc(), labelItem,
+                                       /*HasBoundDecls=*/!vars.empty(),
+                                       SourceLoc(), body));
+    }
+
+    // generate: switch self { }
+    auto selfRef = new (C) DeclRefExpr(selfDecl, SourceLoc(),
+                                       /*implicit*/ true);
+    statements.push_back(SwitchStmt::create(LabeledStmtInfo(), SourceLoc(),
+                                            selfRef, SourceLoc(), cases,
+                                            SourceLoc(), C));
+  }
+
+  auto resultRef = new (C) DeclRefExpr(resultVar, SourceLoc(),
+                                       /*implicit*/ true);
+  statements.push_back(new (C) ReturnStmt(SourceLoc(), resultRef));
+
+  auto body = BraceStmt::create(C, SourceLoc(), statements, SourceLoc());
+  hashValueDecl->setBody(body);
+}
+
+/// Derive a 'hashValue' implementation for a struct or an enum.
 static ValueDecl *
-deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
-                              EnumDecl *enumDecl) {
+deriveHashable_hashValue(TypeChecker &tc, Decl *parentDecl,
+                         NominalTypeDecl *typeDecl) {
   // enum SomeEnum {
   //   case A, B, C
   //   @derived var hashValue: Int {
@@ -366,41 +820,78 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   //     return index.hashValue
   //   }
   // }
+  //
+  // Structs and enums with payloads mix the hash values of their members:
+  //
+  // struct SomeStruct {
+  //   var x: X, y: Y
+  //   @derived var hashValue: Int {
+  //     var result: Int
+  //     result = 0
+  //     result = _combineHashValues(result, self.x.hashValue)
+  //     result = _combineHashValues(result, self.y.hashValue)
+  //     return result
+  //   }
+  // }
+  // enum SomeEnum {
+  //   case A(X), B
+  //   @derived var hashValue: Int {
+  //     var result: Int
+  //     switch self {
+  //     case .A(let a0):
+  //       result = 0
+  //       result = _combineHashValues(result, a0.hashValue)
+  //     case .B:
+  //       result = 1
+  //     }
+  //     return result
+  //   }
+  // }
   ASTContext &C = tc.Context;
   
   auto parentDC = cast<DeclContext>(parentDecl);
 
-  Type enumType = parentDC->getDeclaredTypeInContext();
+  Type selfType = parentDC->getDeclaredTypeInContext();
   Type intType = C.getIntDecl()->getDeclaredType();
   
   // We can't form a Hashable conformance if Int isn't Hashable or
   // IntegerLiteralConvertible.
   if (!tc.conformsToProtocol(intType,C.getProtocol(KnownProtocolKind::Hashable),
-                             enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(), diag::broken_int_hashable_conformance);
+                             typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(), diag::broken_int_hashable_conformance);
     return nullptr;
   }
 
   ProtocolDecl *intLiteralProto =
       C.getProtocol(KnownProtocolKind::IntegerLiteralConvertible);
-  if (!tc.conformsToProtocol(intType, intLiteralProto, enumDecl, None)) {
-    tc.diagnose(enumDecl->getLoc(),
+  if (!tc.conformsToProtocol(intType, intLiteralProto, typeDecl, None)) {
+    tc.diagnose(typeDecl->getLoc(),
                 diag::broken_int_integer_literal_convertible_conformance);
     return nullptr;
   }
+
+  // Enums without payloads hash their case index; everything else mixes the
+  // hash values of its members.
+  auto enumDecl = dyn_cast<EnumDecl>(typeDecl);
+  bool isMemberwise = !enumDecl ||
+                      !enumDecl->hasOnlyCasesWithoutAssociatedValues();
+  if (isMemberwise && !getCombineHashValuesDecl(C)) {
+    tc.diagnose(typeDecl->getLoc(), diag::broken_combine_hash_values);
+    return nullptr;
+  }
   
   VarDecl *selfDecl = new (C) ParamDecl(/*IsLet*/true,
                                         SourceLoc(),
                                         Identifier(),
                                         SourceLoc(),
                                         C.Id_self,
-                                        enumType,
+                                        selfType,
                                         parentDC);
   selfDecl->setImplicit();
   Pattern *selfParam = new (C) NamedPattern(selfDecl, /*implicit*/ true);
-  selfParam->setType(enumType);
-  selfParam = new (C) TypedPattern(selfParam, TypeLoc::withoutLoc(enumType));
-  selfParam->setType(enumType);
+  selfParam->setType(selfType);
+  selfParam = new (C) TypedPattern(selfParam, TypeLoc::withoutLoc(selfType));
+  selfParam->setType(selfType);
   Pattern *methodParam = TuplePattern::create(C, SourceLoc(),{},SourceLoc());
   methodParam->setType(TupleType::getEmpty(tc.Context));
   Pattern *params[] = {selfParam, methodParam};
@@ -411,17 +902,21 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
                        nullptr, Type(), params, TypeLoc::withoutLoc(intType),
                        parentDC);
   getterDecl->setImplicit();
-  getterDecl->setBodySynthesizer(deriveBodyHashable_enum_hashValue);
+  if (isMemberwise)
+    getterDecl->setBodySynthesizer(deriveBodyHashable_memberwise_hashValue);
+  else
+    getterDecl->setBodySynthesizer(deriveBodyHashable_enum_hashValue);
 
   // Compute the type of hashValue().
   GenericParamList *genericParams = nullptr;
   Type methodType = FunctionType::get(TupleType::getEmpty(tc.Context), intType);
-  Type selfType = getterDecl->computeSelfType(&genericParams);
+  Type getterSelfType = getterDecl->computeSelfType(&genericParams);
   Type type;
   if (genericParams)
-    type = PolymorphicFunctionType::get(selfType, methodType, genericParams);
+    type = PolymorphicFunctionType::get(getterSelfType, methodType,
+                                        genericParams);
   else
-    type = FunctionType::get(selfType, methodType);
+    type = FunctionType::get(getterSelfType, methodType);
   getterDecl->setType(type);
   getterDecl->setBodyResultType(intType);
   
@@ -435,9 +930,9 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
     interfaceType = type;
   
   getterDecl->setInterfaceType(interfaceType);
-  getterDecl->setAccessibility(enumDecl->getFormalAccess());
+  getterDecl->setAccessibility(typeDecl->getFormalAccess());
 
-  if (enumDecl->hasClangNode())
+  if (typeDecl->hasClangNode())
     tc.implicitlyDefinedFunctions.push_back(getterDecl);
   
   // Create the property.
@@ -448,7 +943,7 @@ deriveHashable_enum_hashValue(TypeChecker &tc, Decl *parentDecl,
   hashValueDecl->setImplicit();
   hashValueDecl->makeComputed(SourceLoc(), getterDecl,
                               nullptr, nullptr, SourceLoc());
-  hashValueDecl->setAccessibility(enumDecl->getFormalAccess());
+  hashValueDecl->setAccessibility(typeDecl->getFormalAccess());
 
   Pattern *hashValuePat = new (C) NamedPattern(hashValueDecl, /*implicit*/true);
   hashValuePat->setType(intType);
@@ -475,16 +970,13 @@ ValueDecl *DerivedConformance::deriveHashable(TypeChecker &tc,
                                               NominalTypeDecl *type,
                                               ValueDecl *requirement) {
   // Check that we can actually derive Hashable for this type.
-  if (!canDeriveConformance(type))
+  auto proto = tc.Context.getProtocol(KnownProtocolKind::Hashable);
+  if (!canDeriveConformance(tc, parentDecl, type, proto))
     return nullptr;
   
   // Build the necessary decl.
-  if (requirement->getName().str() == "hashValue") {
-    if (auto theEnum = dyn_cast<EnumDecl>(type))
-      return deriveHashable_enum_hashValue(tc, parentDecl, theEnum);
-    else
-      llvm_unreachable("todo");
-  }
+  if (requirement->getName().str() == "hashValue")
+    return deriveHashable_hashValue(tc, parentDecl, type);
   tc.diagnose(requirement->getLoc(),
               diag::broken_hashable_requirement);
   return nullptr;
@@ -61,6 +61,7 @@ private:
   DeclContext *TypeCheckDC;
   unsigned TmpNameIndex = 0;
   bool HighPerformance;
+  bool TopLevelOnly;
 
   struct BracePair {
   public:
@@ -171,8 +172,9 @@ private:
 
 public:
   Instrumenter (ASTContext &C, DeclContext *DC, std::mt19937_64 &RNG,
-                bool HP) :
-    RNG(RNG), Context(C), TypeCheckDC(DC), HighPerformance(HP), CF(*this) { }
+                bool HP, bool TLO) :
+    RNG(RNG), Context(C), TypeCheckDC(DC), HighPerformance(HP),
+    TopLevelOnly(TLO), CF(*this) { }
     
   Stmt *transformStmt(Stmt *S) { 
     switch (S->getKind()) {
@@ -509,7 +511,8 @@ public:
          ++EI) {
       swift::ASTNode &Element = Elements[EI];
       if (Expr *E = Element.dyn_cast<Expr*>()) {
-        E->walk(CF);
+        if (!TopLevelOnly)
+          E->walk(CF);
         if (AssignExpr *AE = dyn_cast<AssignExpr>(E)) {
           if (auto *MRE = dyn_cast<MemberRefExpr>(AE->getDest())) {
             // an assignment to a property of an object counts as a mutation of
@@ -659,7 +662,8 @@ public:
           }
         }
       } else if (Stmt *S = Element.dyn_cast<Stmt*>()) {
-        S->walk(CF);
+        if (!TopLevelOnly)
+          S->walk(CF);
         if (ReturnStmt *RS = dyn_cast<ReturnStmt>(S)) {
           if (RS->hasResult()) {
             std::pair<PatternBindingDecl *, VarDecl *> PV =
@@ -695,6 +699,8 @@ public:
           } else if (isa<FallthroughStmt>(S)) {
             EI = escapeToTarget(BracePair::TargetKinds::Fallthrough, Elements,
                                 EI);
+          } else if (TopLevelOnly && countLoopIterations(S, Elements, EI)) {
+            continue;
           }
           Stmt *NS = transformStmt(S);
           if (NS != S) {
@@ -702,7 +708,8 @@ public:
           }
         }
       } else if (Decl *D = Element.dyn_cast<Decl*>()) {
-        D->walk(CF);
+        if (!TopLevelOnly)
+          D->walk(CF);
         if (auto *PBD = dyn_cast<PatternBindingDecl>(D)) {
           if (VarDecl *VD = PBD->getSingleVar()) {
             if (VD->getParentInitializer()) {
@@ -713,7 +720,7 @@ public:
               }
             }
           }
-        } else {
+        } else if (!TopLevelOnly) {
           transformDecl(D);
         }
       }
@@ -739,6 +746,93 @@ public:
                                     BS->getRBraceLoc());
   }
 
+  // In top-level-only mode, loop bodies are not instrumented. Instead, a
+  // counter is incremented at the start of the body and logged once after
+  // the loop. Returns false if S is not a loop or the counter could not be
+  // built; otherwise updates EI to the last element inserted.
+  bool countLoopIterations(Stmt *S, ElementVector &Elements, size_t &EI) {
+    switch (S->getKind()) {
+    default:
+      return false;
+    case StmtKind::While:
+      return countLoopIterations(cast<WhileStmt>(S), Elements, EI);
+    case StmtKind::RepeatWhile:
+      return countLoopIterations(cast<RepeatWhileStmt>(S), Elements, EI);
+    case StmtKind::For:
+      return countLoopIterations(cast<ForStmt>(S), Elements, EI);
+    case StmtKind::ForEach:
+      return countLoopIterations(cast<ForEachStmt>(S), Elements, EI);
+    }
+  }
+
+  template <class LoopStmt>
+  bool countLoopIterations(LoopStmt *Loop, ElementVector &Elements,
+                           size_t &EI) {
+    BraceStmt *Body = dyn_cast_or_null<BraceStmt>(Loop->getBody());
+    if (!Body)
+      return false;
+
+    Added<Expr *> Zero(new (Context) IntegerLiteralExpr("0", SourceLoc(),
+                                                        true));
+    if (!doTypeCheck(Context, TypeCheckDC, Zero))
+      return false;
+
+    std::pair<PatternBindingDecl *, VarDecl *> PV =
+      buildPatternAndVariable(*Zero, /*IsLet=*/false);
+
+    Expr *IncrementArgExprs[] = {
+        new (Context) InOutExpr(SourceLoc(),
+                                new (Context) DeclRefExpr(
+                                  ConcreteDeclRef(PV.second),
+                                  SourceLoc(),
+                                  true, // implicit
+                                  AccessSemantics::Ordinary,
+                                  Type()),
+                                Type(), true),
+        new (Context) IntegerLiteralExpr("1", SourceLoc(), true)
+      };
+
+    UnresolvedDeclRefExpr *IncrementRef =
+      new (Context) UnresolvedDeclRefExpr(Context.getIdentifier("+="),
+                                          DeclRefKind::BinaryOperator,
+                                          SourceLoc());
+    IncrementRef->setImplicit(true);
+
+    Added<Expr *> Increment(
+      new (Context) CallExpr(IncrementRef,
+                             TupleExpr::createImplicit(Context,
+                                                       IncrementArgExprs,
+                                                       { }),
+                             true, Type()));
+    if (!doTypeCheck(Context, TypeCheckDC, Increment))
+      return false;
+
+    Added<Stmt *> Log = buildLoggerCall(
+      new (Context) DeclRefExpr(ConcreteDeclRef(PV.second),
+                                SourceLoc(),
+                                true, // implicit
+                                AccessSemantics::Ordinary,
+                                Type()),
+      Loop->getSourceRange(), "");
+    if (!*Log)
+      return false;
+
+    ElementVector BodyElements;
+    BodyElements.push_back(*Increment);
+    BodyElements.append(Body->getElements().begin(),
+                        Body->getElements().end());
+    Loop->setBody(BraceStmt::create(Context, Body->getLBraceLoc(),
+                                    Context.AllocateCopy(BodyElements),
+                                    Body->getRBraceLoc()));
+
+    Elements[EI] = PV.first;
+    Elements.insert(Elements.begin() + (EI + 1), PV.second);
+    Elements.insert(Elements.begin() + (EI + 2), Loop);
+    Elements.insert(Elements.begin() + (EI + 3), *Log);
+    EI += 3;
+    return true;
+  }
+
   // log*() functions return a newly-created log expression to be inserted
   // after or instead of the expression they're looking at.  Only call this
   // if the variable has an initializer.
@@ -886,7 +980,7 @@ public:
   }
 
   std::pair<PatternBindingDecl*, VarDecl*>
-    buildPatternAndVariable(Expr *InitExpr) {
+    buildPatternAndVariable(Expr *InitExpr, bool IsLet = true) {
     char NameBuf[11] = { 0 };
     snprintf(NameBuf, 11, "tmp%u", TmpNameIndex);
     TmpNameIndex++;
@@ -903,7 +997,7 @@ public:
     }
 
     VarDecl *VD = new (Context) VarDecl(false, // static
-                                        true, // let
+                                        IsLet,
                                         SourceLoc(),
                                         Context.getIdentifier(NameBuf),
                                         MaybeLoadInitExpr->getType(),
@@ -1082,20 +1176,25 @@ public:
 } // end anonymous namespace
 
 void swift::performPlaygroundTransform(SourceFile &SF,
-                                       bool HighPerformance) {
+                                       bool HighPerformance,
+                                       bool TopLevelOnly) {
   class ExpressionFinder : public ASTWalker {
   private:
     std::mt19937_64 RNG;
     bool HighPerformance;
+    bool TopLevelOnly;
   public:
-    ExpressionFinder(bool HP) : HighPerformance(HP) { }
+    ExpressionFinder(bool HP, bool TLO)
+      : HighPerformance(HP), TopLevelOnly(TLO) { }
 
     virtual bool walkToDeclPre(Decl *D) {
       if (AbstractFunctionDecl *FD = dyn_cast<AbstractFunctionDecl>(D)) {
+        if (TopLevelOnly)
+          return false;
         if (!FD->isImplicit()) {
           if (BraceStmt *Body = FD->getBody()) {
             ASTContext &ctx = FD->getASTContext();
-            Instrumenter I(ctx, FD, RNG, HighPerformance);
+            Instrumenter I(ctx, FD, RNG, HighPerformance, TopLevelOnly);
             BraceStmt *NewBody = I.transformBraceStmt(Body);
             if (NewBody != Body) {
               FD->setBody(NewBody);
@@ -1108,7 +1207,7 @@ void swift::performPlaygroundTransform(SourceFile &SF,
         if (!TLCD->isImplicit()) {
           if (BraceStmt *Body = TLCD->getBody()) {
             ASTContext &ctx = static_cast<Decl*>(TLCD)->getASTContext();
-            Instrumenter I(ctx, TLCD, RNG, HighPerformance);
+            Instrumenter I(ctx, TLCD, RNG, HighPerformance, TopLevelOnly);
             BraceStmt *NewBody = I.transformBraceStmt(Body, true);
             if (NewBody != Body) {
               TLCD->setBody(NewBody);
@@ -1122,7 +1221,7 @@ void swift::performPlaygroundTransform(SourceFile &SF,
     }
   };
 
-  ExpressionFinder EF(HighPerformance);
+  ExpressionFinder EF(HighPerformance, TopLevelOnly);
   for (Decl* D : SF.Decls) {
     D->walk(EF);
   }
@@ -33,6 +33,7 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
@@ -46,6 +47,10 @@
 using namespace swift;
 using namespace constraints;
 
+#define DEBUG_TYPE "TypeCheckConstraints"
+STATISTIC(NumDeferredClosureFallbacks,
+          "# of expressions solved again with their closure bodies");
+
 //===--------------------------------------------------------------------===//
 // Type variable implementation.
 //===--------------------------------------------------------------------===//
@@ -1122,6 +1127,67 @@ namespace {
 
 
 
+/// Returns true if \p expr should first be solved with the bodies of its
+/// single-expression closures left out of the constraint system.
+static bool shouldDeferClosureBodies(TypeChecker &tc, Expr *expr,
+                                     TypeCheckExprOptions options) {
+  if (!tc.getLangOpts().SolveClosureBodiesSeparately)
+    return false;
+
+  // Clients which inspect the solution, or re-check subexpressions to
+  // diagnose failures, expect the bodies to be part of the system.
+  if (options.contains(TypeCheckExprFlags::SuppressDiagnostics) ||
+      options.contains(TypeCheckExprFlags::AllowUnresolvedTypeVariables))
+    return false;
+
+  class FindSingleExpressionClosure : public ASTWalker {
+  public:
+    bool Found = false;
+
+    std::pair<bool, Expr *> walkToExprPre(Expr *expr) override {
+      if (auto closure = dyn_cast<ClosureExpr>(expr)) {
+        if (closure->hasSingleExpressionBody())
+          Found = true;
+        return { false, expr };
+      }
+      return { !Found, expr };
+    }
+
+    std::pair<bool, Stmt *> walkToStmtPre(Stmt *stmt) override {
+      return { false, stmt };
+    }
+
+    bool walkToDeclPre(Decl *decl) override { return false; }
+  };
+
+  FindSingleExpressionClosure finder;
+  expr->walk(finder);
+  return finder.Found;
+}
+
+/// Returns true if the only solution of a system with deferred closure
+/// bodies determines the types of those closures, so that each body can be
+/// type-checked on its own.
+static bool determinesDeferredClosureTypes(ConstraintSystem &cs,
+                                           ArrayRef<Solution> viable) {
+  if (viable.size() != 1 || !viable[0].Fixes.empty())
+    return false;
+
+  for (auto closure : cs.DeferredClosureBodies) {
+    Type closureType = viable[0].simplifyType(cs.getTypeChecker(),
+                                              closure->getType());
+    if (closureType->hasTypeVariable() || closureType->hasUnresolvedType() ||
+        closureType->is<ErrorType>())
+      return false;
+
+    // A single-expression closure can be converted to one returning (),
+    // which requires the type of the body.
+    if (closureType->castTo<AnyFunctionType>()->getResult()->isVoid())
+      return false;
+  }
+  return true;
+}
+
 #pragma mark High-level entry points
 bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       Type convertType,
@@ -1130,8 +1196,10 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
                                       ExprTypeCheckListener *listener) {
   PrettyStackTraceExpr stackTrace(Context, "type-checking", expr);
 
-  // Construct a constraint system from this expression.
-  ConstraintSystem cs(*this, dc, ConstraintSystemFlags::AllowFixes);
+  Optional<TypeCheckTimer> timer;
+  if (DebugTimeExpressions || hasExpressionBudget())
+    timer.emplace(*this, expr->getLoc(), /*IsFunctionBody=*/false);
+
   CleanupIllFormedExpressionRAII cleanup(Context, expr);
   ExprCleanser cleanup2(expr);
 
@@ -1152,9 +1220,9 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
     }
   }
 
-  // Tell the constraint system what the contextual type is.  This informs
-  // diagnostics and is a hint for various performance optimizations.
-  cs.setContextualType(expr, convertType.getPointer(), convertTypePurpose);
+  // Remember the contextual type to tell the constraint system about.  This
+  // informs diagnostics and is a hint for various performance optimizations.
+  Type contextualType = convertType;
 
   // If the convertType is *only* provided for that hint, then null it out so
   // that we don't later treat it as an actual conversion constraint.
@@ -1170,11 +1238,41 @@ bool TypeChecker::typeCheckExpression(Expr *&expr, DeclContext *dc,
   if (options.contains(TypeCheckExprFlags::AllowUnresolvedTypeVariables))
     allowFreeTypeVariables = FreeTypeVariableBinding::UnresolvedType;
 
-  // Attempt to solve the constraint system.
+  // Construct a constraint system from this expression.
+  Optional<ConstraintSystem> csStorage;
   SmallVector<Solution, 4> viable;
-  if (solveForExpression(expr, dc, convertType, allowFreeTypeVariables,
-                         listener, cs, viable, options))
-    return true;
+
+  // Closure-heavy expressions are first solved without the bodies of their
+  // single-expression closures. If the context determines the closure types,
+  // each body is type-checked as its own expression when the solution is
+  // applied; otherwise, the expression is solved again with the bodies.
+  if (shouldDeferClosureBodies(*this, expr, options)) {
+    ConstraintSystemOptions csOptions = ConstraintSystemFlags::AllowFixes;
+    csOptions |= ConstraintSystemFlags::DeferClosureBodies;
+    csStorage.emplace(*this, dc, csOptions);
+    csStorage->setContextualType(expr, contextualType.getPointer(),
+                                 convertTypePurpose);
+    if (solveForExpression(expr, dc, convertType, allowFreeTypeVariables,
+                           listener, *csStorage, viable,
+                           options | TypeCheckExprFlags::SuppressDiagnostics) ||
+        !determinesDeferredClosureTypes(*csStorage, viable)) {
+      ++NumDeferredClosureFallbacks;
+      viable.clear();
+      csStorage.reset();
+    }
+  }
+
+  if (!csStorage) {
+    csStorage.emplace(*this, dc, ConstraintSystemFlags::AllowFixes);
+    csStorage->setContextualType(expr, contextualType.getPointer(),
+                                 convertTypePurpose);
+
+    // Attempt to solve the constraint system.
+    if (solveForExpression(expr, dc, convertType, allowFreeTypeVariables,
+                           listener, *csStorage, viable, options))
+      return true;
+  }
+  ConstraintSystem &cs = *csStorage;
 
   // If the client allows the solution to have unresolved type expressions,
   // check for them now.  We cannot apply the solution with unresolved TypeVars,
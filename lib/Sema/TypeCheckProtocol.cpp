@@ -2002,7 +2002,12 @@ static SelfReferenceKind findSelfReferences(ValueDecl *value) {
 SmallVector<ValueDecl *, 4> 
 ConformanceChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
   assert(!isa<AssociatedTypeDecl>(req) && "Not for lookup for type witnesses*");
-  
+
+  auto known = TC.ValueWitnessCandidates.find({Conformance, req});
+  if (known != TC.ValueWitnessCandidates.end() &&
+      !(known->second.empty() && ignoringNames))
+    return known->second;
+
   SmallVector<ValueDecl *, 4> witnesses;
   if (req->getName().isOperator()) {
     // Operator lookup is always global.
@@ -2022,10 +2027,15 @@ ConformanceChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
     auto candidates = TC.lookupMember(DC, metaType, req->getFullName());
 
     // If we didn't find anything with the appropriate name, look
-    // again using only the base name.
+    // again using only the base name. These candidates are only used for
+    // diagnostics, so they aren't cached.
     if (candidates.empty() && ignoringNames) {
+      TC.ValueWitnessCandidates[{Conformance, req}];
       candidates = TC.lookupMember(DC, metaType, req->getName());
       *ignoringNames = true;
+      for (auto candidate : candidates)
+        witnesses.push_back(candidate);
+      return witnesses;
     }
 
     for (auto candidate : candidates) {
@@ -2033,6 +2043,7 @@ ConformanceChecker::lookupValueWitnesses(ValueDecl *req, bool *ignoringNames) {
     }
   }
 
+  TC.ValueWitnessCandidates[{Conformance, req}] = witnesses;
   return witnesses;
 }
 
@@ -30,7 +30,9 @@
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/LocalContext.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/PointerUnion.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Twine.h"
@@ -1065,9 +1067,101 @@ void TypeChecker::checkIgnoredExpr(Expr *E) {
   }
 }
 
+namespace {
+/// Collects the names of the values referenced by an AST node.
+class ReferencedNameCollector : public ASTWalker {
+  llvm::SmallDenseSet<Identifier, 16> &Names;
+
+public:
+  ReferencedNameCollector(llvm::SmallDenseSet<Identifier, 16> &Names)
+    : Names(Names) {}
+
+  std::pair<bool, Expr *> walkToExprPre(Expr *E) override {
+    if (auto *DRE = dyn_cast<DeclRefExpr>(E))
+      Names.insert(DRE->getDecl()->getName());
+    else if (auto *UDRE = dyn_cast<UnresolvedDeclRefExpr>(E))
+      Names.insert(UDRE->getName());
+    return { true, E };
+  }
+};
+} // end anonymous namespace
+
+/// Finds the elements of \p BS before the code completion location \p Loc
+/// which the code completion does not depend on.
+///
+/// The completion depends on the bindings of the locals it references, on
+/// the bindings of the locals referenced by their initializers, and so on.
+/// Statements and expressions before the completion point can't change the
+/// types of those locals, so they don't need to be type checked. Guards and
+/// declarations other than variable bindings are always kept.
+static void findIndependentElements(BraceStmt *BS, SourceLoc Loc,
+                                    const SourceManager &SM,
+                                    llvm::SmallPtrSetImpl<void *> &Skipped) {
+  auto Elements = BS->getElements();
+
+  // Find the element which contains the completion point. If the completion
+  // expression is not part of this brace, we can't tell what it depends on.
+  unsigned RootIdx = 0;
+  while (RootIdx != Elements.size() &&
+         Elements[RootIdx].getEndLoc().isValid() &&
+         SM.isBeforeInBuffer(Elements[RootIdx].getEndLoc(), Loc))
+    ++RootIdx;
+  if (RootIdx == Elements.size())
+    return;
+  SourceLoc RootStart = Elements[RootIdx].getStartLoc();
+  if (RootStart.isInvalid() || RootStart == Loc ||
+      SM.isBeforeInBuffer(Loc, RootStart))
+    return;
+
+  llvm::SmallDenseSet<Identifier, 16> Needed;
+  ReferencedNameCollector Collector(Needed);
+  Elements[RootIdx].walk(Collector);
+
+  for (unsigned Idx = RootIdx; Idx != 0; --Idx) {
+    ASTNode Elem = Elements[Idx - 1];
+    if (auto *D = Elem.dyn_cast<Decl *>()) {
+      bool IsNeeded = true;
+      if (auto *PBD = dyn_cast<PatternBindingDecl>(D)) {
+        IsNeeded = false;
+        for (unsigned i = 0, e = PBD->getNumPatternEntries(); i != e; ++i)
+          PBD->getPattern(i)->forEachVariable([&](VarDecl *VD) {
+            if (Needed.count(VD->getName()))
+              IsNeeded = true;
+          });
+      } else if (auto *VD = dyn_cast<VarDecl>(D)) {
+        IsNeeded = Needed.count(VD->getName());
+      }
+      if (!IsNeeded) {
+        Skipped.insert(Elem.getOpaqueValue());
+        continue;
+      }
+      D->walk(Collector);
+      continue;
+    }
+    if (auto *S = Elem.dyn_cast<Stmt *>()) {
+      if (isa<GuardStmt>(S)) {
+        S->walk(Collector);
+        continue;
+      }
+    }
+    Skipped.insert(Elem.getOpaqueValue());
+  }
+}
+
 Stmt *StmtChecker::visitBraceStmt(BraceStmt *BS) {
   const SourceManager &SM = TC.Context.SourceMgr;
+
+  // When completing a member access, only the statements the completion
+  // depends on have to be type checked.
+  llvm::SmallPtrSet<void *, 16> Skipped;
+  if (EndTypeCheckLoc.isValid() &&
+      TC.Context.LangOpts.CodeCompleteOnlyDependencies)
+    findIndependentElements(BS, EndTypeCheckLoc, SM, Skipped);
+
   for (auto &elem : BS->getElements()) {
+    if (!Skipped.empty() && Skipped.count(elem.getOpaqueValue()))
+      continue;
+
     if (Expr *SubExpr = elem.dyn_cast<Expr*>()) {
       SourceLoc Loc = SubExpr->getStartLoc();
       if (EndTypeCheckLoc.isValid() &&
@@ -1209,6 +1303,10 @@ bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (DebugTimeFunctionBodies)
     timer.emplace(AFD);
 
+  Optional<TypeCheckTimer> exprTimer;
+  if (DebugTimeExpressions)
+    exprTimer.emplace(*this, AFD->getLoc(), /*IsFunctionBody=*/true);
+
   if (typeCheckAbstractFunctionBodyUntil(AFD, SourceLoc()))
     return true;
   
@@ -1453,6 +1551,10 @@ void TypeChecker::typeCheckClosureBody(ClosureExpr *closure) {
   if (DebugTimeFunctionBodies)
     timer.emplace(closure);
 
+  Optional<TypeCheckTimer> exprTimer;
+  if (DebugTimeExpressions)
+    exprTimer.emplace(*this, closure->getLoc(), /*IsFunctionBody=*/true);
+
   StmtChecker(*this, closure).typeCheckBody(body);
   if (body) {
     closure->setBody(body, closure->hasSingleExpressionBody());
@@ -35,13 +35,21 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/Format.h"
 #include <algorithm>
 
 using namespace swift;
 
+#define DEBUG_TYPE "TypeChecker"
+STATISTIC(NumDeferredMemberValidations,
+          "# of members of other files' types not validated eagerly");
+STATISTIC(LargestSolverMemory,
+          "# of bytes allocated by the largest constraint system");
+
 TypeChecker::TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags)
   : Context(Ctx), Diags(Diags)
 {
@@ -52,6 +60,109 @@ TypeChecker::TypeChecker(ASTContext &Ctx, DiagnosticEngine &Diags)
   Context.setLazyResolver(this);
 }
 
+TypeCheckTimer::TypeCheckTimer(TypeChecker &TC, SourceLoc Loc,
+                               bool IsFunctionBody)
+  : TC(TC), Outer(TC.ActiveTimer), Loc(Loc), IsFunctionBody(IsFunctionBody),
+    Enabled(TC.DebugTimeExpressions || TC.hasExpressionBudget()) {
+  if (!Enabled)
+    return;
+
+  // Expressions nested in a timed expression are part of the outer one.
+  if (!IsFunctionBody && Outer && !Outer->IsFunctionBody) {
+    Enabled = false;
+    return;
+  }
+
+  TC.ActiveTimer = this;
+  StartTime = llvm::TimeRecord::getCurrentTime(true);
+}
+
+TypeCheckTimer::~TypeCheckTimer() {
+  if (!Enabled)
+    return;
+
+  llvm::TimeRecord EndTime = llvm::TimeRecord::getCurrentTime(false);
+  double wallTime = EndTime.getWallTime() - StartTime.getWallTime();
+  TC.ActiveTimer = Outer;
+  if (Outer)
+    Outer->Counters.add(Counters);
+
+  if (TC.DebugTimeExpressions)
+    TC.TimingRecords.push_back({Loc, IsFunctionBody, wallTime, Counters});
+
+  if (IsFunctionBody || Loc.isInvalid())
+    return;
+
+  const LangOptions &opts = TC.getLangOpts();
+  unsigned milliseconds = static_cast<unsigned>(wallTime * 1000);
+  if (opts.WarnLongExpressionTypeChecking &&
+      milliseconds > opts.WarnLongExpressionTypeChecking) {
+    TC.diagnose(Loc, diag::expression_type_check_slow, milliseconds,
+                opts.WarnLongExpressionTypeChecking);
+  }
+  if (opts.WarnExpressionTypeVariableBindings &&
+      Counters.NumTypeVariableBindings >
+        opts.WarnExpressionTypeVariableBindings) {
+    TC.diagnose(Loc, diag::expression_type_check_too_many_bindings,
+                Counters.NumTypeVariableBindings,
+                opts.WarnExpressionTypeVariableBindings);
+  }
+}
+
+ConstraintSolverCounters *TypeChecker::getActiveSolverCounters() const {
+  if (!ActiveTimer)
+    return nullptr;
+  return &ActiveTimer->getCounters();
+}
+
+std::unique_ptr<llvm::BumpPtrAllocator> TypeChecker::takeSolverAllocator() {
+  if (FreeSolverAllocators.empty())
+    return llvm::make_unique<llvm::BumpPtrAllocator>();
+
+  auto allocator = std::move(FreeSolverAllocators.back());
+  FreeSolverAllocators.pop_back();
+  return allocator;
+}
+
+void TypeChecker::releaseSolverAllocator(
+    std::unique_ptr<llvm::BumpPtrAllocator> allocator) {
+  size_t used = allocator->getTotalMemory();
+  if (auto *counters = getActiveSolverCounters())
+    counters->PeakSolverMemory = std::max(counters->PeakSolverMemory, used);
+  if (used > LargestSolverMemory)
+    LargestSolverMemory = used;
+
+  allocator->Reset();
+  FreeSolverAllocators.push_back(std::move(allocator));
+}
+
+void TypeChecker::dumpTypeCheckTimingReport(raw_ostream &OS) const {
+  std::vector<const TypeCheckTimingRecord *> Sorted;
+  for (auto &Record : TimingRecords)
+    Sorted.push_back(&Record);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const TypeCheckTimingRecord *LHS,
+                      const TypeCheckTimingRecord *RHS) {
+    return LHS->WallTime > RHS->WallTime;
+  });
+
+  for (auto *Record : Sorted) {
+    OS << llvm::format("%0.2f", Record->WallTime * 1000) << "ms\t";
+    if (Record->Loc.isValid())
+      Record->Loc.print(OS, Context.SourceMgr);
+    else
+      OS << "<unknown>";
+    OS << (Record->IsFunctionBody ? "\tfunction body" : "\texpression");
+#define CS_STATISTIC(Name, Description) \
+    if (Record->Counters.Name) \
+      OS << "\t" #Name "=" << Record->Counters.Name;
+#include "ConstraintSolverStats.def"
+    if (Record->Counters.PeakSolverMemory)
+      OS << "\tPeakSolverMemory=" << Record->Counters.PeakSolverMemory;
+    OS << "\n";
+  }
+}
+
 TypeChecker::~TypeChecker() {
   auto clangImporter =
     static_cast<ClangImporter *>(Context.getClangModuleLoader());
@@ -411,10 +522,24 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
 
       Optional<bool> lazyVarsAlreadyHaveImplementation;
 
+      // Types declared in the files being checked have been removed from the
+      // list, so these come from other files.  The layout of a struct or enum
+      // only depends on its properties and cases; its other members are
+      // validated when name lookup from this file reaches them.  Classes
+      // still need every member for vtable layout.
+      bool onlyValidateLayout =
+        (isa<StructDecl>(nominal) || isa<EnumDecl>(nominal)) &&
+        nominal->getParentSourceFile();
+
       for (auto *D : nominal->getMembers()) {
         auto VD = dyn_cast<ValueDecl>(D);
         if (!VD)
           continue;
+        if (onlyValidateLayout && !isa<VarDecl>(VD) &&
+            !isa<EnumElementDecl>(VD)) {
+          ++NumDeferredMemberValidations;
+          continue;
+        }
         TC.validateDecl(VD);
 
         // The only thing left to do is synthesize storage for lazy variables.
@@ -521,6 +646,8 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     auto &DefinedFunctions = TC.definedFunctions;
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
+    if (Options.contains(TypeCheckingFlags::DebugTimeExpressions))
+      TC.enableDebugTimeExpressions();
 
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
@@ -599,6 +726,9 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
       TC.processREPLTopLevel(SF, TLC, StartElem);
 
     typeCheckFunctionsAndExternalDecls(TC);
+
+    if (TC.getDebugTimeExpressions())
+      TC.dumpTypeCheckTimingReport(llvm::errs());
   }
 
   // Checking that benefits from having the whole module available.
@@ -1433,18 +1563,61 @@ TypeChecker::overApproximateOSVersionsAtLocation(SourceLoc loc,
 bool TypeChecker::isDeclAvailable(const Decl *D, SourceLoc referenceLoc,
                                   const DeclContext *referenceDC,
                                   VersionRange &OutAvailableRange) {
+  // The running OS version is always at least the minimum deployment target,
+  // so a declaration from another module which is available there is
+  // available at every reference. Decide this once per declaration.
+  bool isImported = D->getModuleContext() != referenceDC->getParentModule();
+  if (isImported) {
+    auto known = ImportedDeclAvailableAtDeploymentTarget.find(D);
+    if (known == ImportedDeclAvailableAtDeploymentTarget.end()) {
+      VersionRange deploymentTarget =
+          VersionRange::allGTE(getLangOpts().getMinPlatformVersion());
+      bool available = deploymentTarget.isContainedIn(
+          AvailabilityInference::availableRange(D, Context));
+      known = ImportedDeclAvailableAtDeploymentTarget.insert({D, available})
+                  .first;
+    }
+    if (known->second)
+      return true;
+  }
+
+  // References with a valid location are checked against the most refined
+  // context containing them, so the answer only depends on the declaration
+  // and that context.
+  const TypeRefinementContext *TRC = nullptr;
+  SourceFile *SF = referenceDC->getParentSourceFile();
+  if (SF && referenceLoc.isValid()) {
+    TRC = getOrBuildTypeRefinementContext(SF)
+              ->findMostRefinedSubContext(referenceLoc, Context.SourceMgr);
+    auto known = DeclAvailableInContext.find({D, TRC});
+    if (known != DeclAvailableInContext.end()) {
+      if (!known->second)
+        OutAvailableRange = AvailabilityInference::availableRange(D, Context);
+      return known->second;
+    }
+  }
 
   VersionRange safeRangeUnderApprox =
       AvailabilityInference::availableRange(D, Context);
-  VersionRange runningOSOverApprox = overApproximateOSVersionsAtLocation(
-      referenceLoc, referenceDC);
-  
+
+  VersionRange runningOSOverApprox =
+      VersionRange::allGTE(getLangOpts().getMinPlatformVersion());
+  if (TRC)
+    runningOSOverApprox.constrainWith(TRC->getPotentialVersions());
+  else
+    runningOSOverApprox = overApproximateOSVersionsAtLocation(referenceLoc,
+                                                              referenceDC);
+
   // The reference is safe if an over-approximation of the running OS
   // versions is fully contained within an under-approximation
   // of the versions on which the declaration is available. If this
   // containment cannot be guaranteed, we say the reference is
   // not available.
-  if (!(runningOSOverApprox.isContainedIn(safeRangeUnderApprox))) {
+  bool available = runningOSOverApprox.isContainedIn(safeRangeUnderApprox);
+  if (TRC)
+    DeclAvailableInContext[{D, TRC}] = available;
+
+  if (!available) {
     OutAvailableRange = safeRangeUnderApprox;
     return false;
   }
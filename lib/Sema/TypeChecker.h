@@ -30,6 +30,8 @@
 #include "swift/Basic/OptionSet.h"
 #include "swift/Config.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Timer.h"
 #include <functional>
 
 namespace swift {
@@ -425,6 +427,22 @@ inline ConformanceCheckOptions operator|(ConformanceCheckFlags lhs,
   return ConformanceCheckOptions(lhs) | rhs;
 }
 
+/// Counters for the work done by the constraint solver, as listed in
+/// ConstraintSolverStats.def.
+struct ConstraintSolverCounters {
+#define CS_STATISTIC(Name, Description) unsigned Name = 0;
+#include "ConstraintSolverStats.def"
+
+  /// The most memory any single constraint system allocated, in bytes.
+  size_t PeakSolverMemory = 0;
+
+  void add(const ConstraintSolverCounters &other) {
+#define CS_STATISTIC(Name, Description) Name += other.Name;
+#include "ConstraintSolverStats.def"
+    PeakSolverMemory = std::max(PeakSolverMemory, other.PeakSolverMemory);
+  }
+};
+
 /// The Swift type checker, which takes a parsed AST and performs name binding,
 /// type checking, and semantic analysis to produce a type-annotated AST.
 class TypeChecker final : public LazyResolver {
@@ -453,6 +471,41 @@ public:
   /// This can't use CanTypes because typealiases may have more limited types
   /// than their underlying types.
   llvm::DenseMap<Type, Accessibility> TypeAccessibilityCache;
+
+  /// Caches whether a declaration from another module is available on every
+  /// OS version at or above the minimum deployment target.
+  ///
+  /// Imported declarations almost all carry availability attributes, and
+  /// those attributes cannot change while this module is type-checked.
+  llvm::DenseMap<const Decl *, bool> ImportedDeclAvailableAtDeploymentTarget;
+
+  /// Caches whether a declaration is available when referenced inside a
+  /// particular type refinement context.
+  llvm::DenseMap<std::pair<const Decl *, const TypeRefinementContext *>, bool>
+    DeclAvailableInContext;
+
+  /// The candidate value witnesses that name lookup finds for each
+  /// requirement of a conformance.
+  ///
+  /// Associated type inference and witness resolution both look at the
+  /// candidates for each requirement, and each lazily resolved witness gets a
+  /// new ConformanceChecker, so the candidates are looked up once here.
+  llvm::DenseMap<std::pair<NormalProtocolConformance *, ValueDecl *>,
+                 SmallVector<ValueDecl *, 4>> ValueWitnessCandidates;
+
+  /// Describes the shape of a relational constraint between two types that
+  /// contain no type variables: the canonical types, and the constraint kind
+  /// combined with its conversion restriction.
+  typedef std::pair<std::pair<CanType, CanType>, unsigned>
+    ConstraintShapeKey;
+
+  /// Disjunction terms of a given shape that are known to fail.
+  ///
+  /// This is shared by all constraint systems, so that structurally identical
+  /// subexpressions (such as the elements of a large literal or the operands
+  /// of a long operator chain) don't re-attempt choices that cannot work once
+  /// their argument types have been resolved.
+  llvm::DenseSet<ConstraintShapeKey> FailedDisjunctionTerms;
   
   // We delay validation of C and Objective-C type-bridging functions in the
   // standard library until we encounter a declaration that requires one. This
@@ -542,6 +595,31 @@ private:
   /// to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If true, the time and solver work it takes to type-check each expression
+  /// and function body is recorded, and reported by
+  /// dumpTypeCheckTimingReport().
+  bool DebugTimeExpressions = false;
+
+  /// The time and solver work spent on one expression or function body.
+  struct TypeCheckTimingRecord {
+    SourceLoc Loc;
+    bool IsFunctionBody;
+    double WallTime;
+    ConstraintSolverCounters Counters;
+  };
+
+  /// The records collected while DebugTimeExpressions is set.
+  std::vector<TypeCheckTimingRecord> TimingRecords;
+
+  /// The innermost active timer, if any.
+  class TypeCheckTimer *ActiveTimer = nullptr;
+
+  /// Constraint solver allocators that are not in use. Each has been reset,
+  /// keeping only its first slab.
+  std::vector<std::unique_ptr<llvm::BumpPtrAllocator>> FreeSolverAllocators;
+
+  friend class TypeCheckTimer;
+
   /// Indicate that the type checker is checking code that will be
   /// immediately executed. This will suppress certain warnings
   /// when executing scripts.
@@ -564,6 +642,40 @@ public:
     DebugTimeFunctionBodies = true;
   }
 
+  /// Record the time and solver work it takes to type-check each expression
+  /// and function body.
+  void enableDebugTimeExpressions() {
+    DebugTimeExpressions = true;
+  }
+
+  bool getDebugTimeExpressions() const {
+    return DebugTimeExpressions;
+  }
+
+  /// Whether expressions should be timed so that the ones over budget can
+  /// be diagnosed.
+  bool hasExpressionBudget() const {
+    return getLangOpts().WarnLongExpressionTypeChecking ||
+           getLangOpts().WarnExpressionTypeVariableBindings;
+  }
+
+  /// Print the records collected with DebugTimeExpressions, slowest first.
+  void dumpTypeCheckTimingReport(raw_ostream &OS) const;
+
+  /// The solver counters of the innermost timed expression or function body,
+  /// which the constraint solver adds its work to. Null if nothing is being
+  /// timed.
+  ConstraintSolverCounters *getActiveSolverCounters() const;
+
+  /// Take an allocator for a new constraint system, reusing one released by
+  /// an earlier constraint system if possible.
+  std::unique_ptr<llvm::BumpPtrAllocator> takeSolverAllocator();
+
+  /// Record how much memory a finished constraint system allocated, then
+  /// reset its allocator and keep it for the next constraint system.
+  void
+  releaseSolverAllocator(std::unique_ptr<llvm::BumpPtrAllocator> allocator);
+
   bool getInImmediateMode() {
     return InImmediateMode;
   }
@@ -1762,6 +1874,32 @@ public:
   }
 };
 
+/// RAII object that records the wall time and constraint solver work spent
+/// type-checking an expression or function body, if the type checker was
+/// asked to time expressions, and warns about expressions that go over
+/// budget.
+///
+/// Nested expressions are folded into the outermost timed expression, and the
+/// work of every expression is also added to the enclosing function body.
+class TypeCheckTimer {
+  TypeChecker &TC;
+  TypeCheckTimer *Outer;
+  SourceLoc Loc;
+  bool IsFunctionBody;
+  bool Enabled;
+  llvm::TimeRecord StartTime;
+  ConstraintSolverCounters Counters;
+
+  TypeCheckTimer(const TypeCheckTimer &) = delete;
+  TypeCheckTimer &operator=(const TypeCheckTimer &) = delete;
+
+public:
+  TypeCheckTimer(TypeChecker &TC, SourceLoc Loc, bool IsFunctionBody);
+  ~TypeCheckTimer();
+
+  ConstraintSolverCounters &getCounters() { return Counters; }
+};
+
 /// Temporary on-stack storage and unescaping for encoded diagnostic
 /// messages.
 ///
@@ -16,6 +16,7 @@
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Serialization/BCReadingExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -490,6 +491,7 @@ NormalProtocolConformance *ModuleFile::readNormalConformance(
   if (conformanceEntry.isComplete()) {
     return conformanceEntry.get();
   }
+  ++Stats.NumConformances;
 
   using namespace decls_block;
 
@@ -1715,6 +1717,9 @@ Decl *ModuleFile::getDecl(DeclID DID, Optional<DeclContext *> ForcedContext) {
   }
 
   ASTContext &ctx = getContext();
+  noteDeserializedDecl();
+  if (ctx.Stats)
+    ++ctx.Stats->NumDeclsDeserialized;
   SmallVector<uint64_t, 64> scratch;
   StringRef blobData;
 
@@ -3199,6 +3204,7 @@ Type ModuleFile::getType(TypeID TID) {
   }
 
   ASTContext &ctx = getContext();
+  ++Stats.NumTypes;
 
   SmallVector<uint64_t, 64> scratch;
   StringRef blobData;
@@ -3892,10 +3898,21 @@ Type ModuleFile::getType(TypeID TID) {
   return typeOrOffset;
 }
 
+/// Returns the name to use for \p D in -print-deserialization-stats.
+static StringRef getTriggerName(const Decl *D) {
+  if (auto value = dyn_cast<ValueDecl>(D))
+    return value->getName().str();
+  if (auto ext = dyn_cast<ExtensionDecl>(D))
+    if (auto nominal = ext->getExtendedType()->getAnyNominal())
+      return nominal->getName().str();
+  return StringRef();
+}
+
 void ModuleFile::loadAllMembers(Decl *D,
                                 uint64_t contextData,
                                 bool *) {
   PrettyStackTraceDecl trace("loading members for", D);
+  DeserializationTriggerRAII trigger(*this, "members of", getTriggerName(D));
 
   BCOffsetRAII restoreOffset(DeclTypeCursor);
   DeclTypeCursor.JumpToBit(contextData);
@@ -3914,10 +3931,40 @@ void ModuleFile::loadAllMembers(Decl *D,
     IDC->addMember(member);
 }
 
+bool ModuleFile::loadNamedMembers(const Decl *D, Identifier baseName,
+                                  uint64_t contextData,
+                                  SmallVectorImpl<ValueDecl *> &members) {
+  // Modules without a member name table can only be loaded in full.
+  if (!DeclMemberNames)
+    return false;
+
+  PrettyStackTraceDecl trace("loading members by name for", D);
+  DeserializationTriggerRAII trigger(*this, "lookup of member",
+                                     baseName.str());
+
+  auto iter = DeclMemberNames->find(baseName);
+  if (iter == DeclMemberNames->end())
+    return true;
+
+  for (auto entry : *iter) {
+    // The table covers the members of every decl in the module; only take
+    // the ones from this decl's member list.
+    if (entry.first != contextData)
+      continue;
+
+    Decl *member = getDecl(entry.second);
+    assert(member && "unable to deserialize member");
+    members.push_back(cast<ValueDecl>(member));
+  }
+  return true;
+}
+
 void
 ModuleFile::loadAllConformances(const Decl *D, uint64_t contextData,
                          SmallVectorImpl<ProtocolConformance *> &conformances) {
   PrettyStackTraceDecl trace("loading conformances for", D);
+  DeserializationTriggerRAII trigger(*this, "conformances of",
+                                     getTriggerName(D));
 
   uint64_t numConformances;
   uint64_t bitPosition;
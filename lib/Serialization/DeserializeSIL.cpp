@@ -24,6 +24,7 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/OnDiskHashTable.h"
 
 using namespace swift;
@@ -111,10 +112,11 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
 
   llvm::BitstreamCursor cursor = SILIndexCursor;
   // We expect SIL_FUNC_NAMES first, then SIL_VTABLE_NAMES, then
-  // SIL_GLOBALVAR_NAMES, and SIL_WITNESSTABLE_NAMES. But each one can be
-  // omitted if no entries exist in the module file.
+  // SIL_GLOBALVAR_NAMES, SIL_WITNESSTABLE_NAMES, SIL_FUNC_SUMMARIES and
+  // SIL_TYPE_LOWERING_NAMES. But each one can be omitted if no entries exist
+  // in the module file.
   unsigned kind = 0;
-  while (kind != sil_index_block::SIL_WITNESSTABLE_NAMES) {
+  while (true) {
     auto next = cursor.advance();
     if (next.Kind == llvm::BitstreamEntry::EndBlock)
       return;
@@ -128,11 +130,35 @@ SILDeserializer::SILDeserializer(ModuleFile *MF, SILModule &M,
             (kind == sil_index_block::SIL_FUNC_NAMES ||
              kind == sil_index_block::SIL_VTABLE_NAMES ||
              kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
-             kind == sil_index_block::SIL_WITNESSTABLE_NAMES)) &&
-         "Expect SIL_FUNC_NAMES, SIL_VTABLE_NAMES, SIL_GLOBALVAR_NAMES or \
-          SIL_WITNESSTABLE_NAMES.");
+             kind == sil_index_block::SIL_WITNESSTABLE_NAMES ||
+             kind == sil_index_block::SIL_FUNC_SUMMARIES ||
+             kind == sil_index_block::SIL_TYPE_LOWERING_NAMES)) &&
+         "Expect SIL_FUNC_NAMES, SIL_VTABLE_NAMES, SIL_GLOBALVAR_NAMES, \
+          SIL_WITNESSTABLE_NAMES, SIL_FUNC_SUMMARIES or \
+          SIL_TYPE_LOWERING_NAMES.");
     (void)prevKind;
 
+    // The summaries don't have an offsets record.
+    if (kind == sil_index_block::SIL_FUNC_SUMMARIES) {
+      FuncSummaries = blobData;
+      continue;
+    }
+
+    // The type lowering names are followed by the lowerings they index.
+    if (kind == sil_index_block::SIL_TYPE_LOWERING_NAMES) {
+      TypeLoweringTable = readFuncTable(scratch, blobData);
+      next = cursor.advance();
+      scratch.clear();
+      unsigned loweringsKind = cursor.readRecord(next.ID, scratch, &blobData);
+      assert((next.Kind == llvm::BitstreamEntry::Record &&
+              loweringsKind == sil_index_block::SIL_TYPE_LOWERINGS) &&
+             "Expect a SIL_TYPE_LOWERINGS record.");
+      (void)loweringsKind;
+      TypeLowerings = blobData;
+      kind = sil_index_block::SIL_TYPE_LOWERINGS;
+      continue;
+    }
+
     if (kind == sil_index_block::SIL_FUNC_NAMES)
       FuncTable = readFuncTable(scratch, blobData);
     else if (kind == sil_index_block::SIL_VTABLE_NAMES)
@@ -430,6 +456,11 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
     if (isFragile)
       fn->setFragile(IsFragile);
 
+    // Take over the effects the defining module recorded for the function,
+    // unless the declaration already has its own.
+    if (fn->getEffectsKind() == EffectsKind::Unspecified)
+      fn->setEffectsKind((EffectsKind)effect);
+
     // Don't override the transparency or linkage of a function with
     // an existing declaration.
 
@@ -507,6 +538,7 @@ SILFunction *SILDeserializer::readSILFunction(DeclID FID,
   }
 
   NumDeserializedFunc++;
+  MF->noteDeserializedSILFunction();
   scratch.clear();
 
   assert(!(fn->getContextGenericParams() && !fn->empty())
@@ -633,7 +665,8 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   Builder.setCurrentDebugScope(Fn->getDebugScope());
   unsigned OpCode = 0, TyCategory = 0, TyCategory2 = 0, TyCategory3 = 0,
            ValResNum = 0, ValResNum2 = 0, Attr = 0,
-           NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0;
+           NumSubs = 0, NumConformances = 0, IsNonThrowingApply = 0,
+           IsPartialApplyOnStack = 0;
   ValueID ValID, ValID2, ValID3;
   TypeID TyID, TyID2, TyID3;
   TypeID ConcreteTyID;
@@ -698,6 +731,10 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
     case SIL_PARTIAL_APPLY:
       OpCode = (unsigned)ValueKind::PartialApplyInst;
       break;
+    case SIL_PARTIAL_APPLY_ON_STACK:
+      OpCode = (unsigned)ValueKind::PartialApplyInst;
+      IsPartialApplyOnStack = true;
+      break;
     case SIL_BUILTIN:
       OpCode = (unsigned)ValueKind::BuiltinInst;
       break;
@@ -1007,9 +1044,12 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
     }
 
     // FIXME: Why the arbitrary order difference in IRBuilder type argument?
-    ResultVal = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
+    auto *PAI = Builder.createPartialApply(Loc, FnVal, SubstFnTy,
                                            Substitutions, Args,
                                            closureTy);
+    if (IsPartialApplyOnStack)
+      PAI->setStackAllocatable();
+    ResultVal = PAI;
     break;
   }
   case ValueKind::BuiltinInst: {
@@ -1180,8 +1220,6 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
                                (SILValueCategory)TyCategory)));          \
     break;
   UNARY_INSTRUCTION(CondFail)
-  UNARY_INSTRUCTION(RetainValue)
-  UNARY_INSTRUCTION(ReleaseValue)
   UNARY_INSTRUCTION(AutoreleaseValue)
   UNARY_INSTRUCTION(DeinitExistentialAddr)
   UNARY_INSTRUCTION(DestroyAddr)
@@ -1193,8 +1231,6 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   UNARY_INSTRUCTION(CopyBlock)
   UNARY_INSTRUCTION(StrongPin)
   UNARY_INSTRUCTION(StrongUnpin)
-  UNARY_INSTRUCTION(StrongRetain)
-  UNARY_INSTRUCTION(StrongRelease)
   UNARY_INSTRUCTION(StrongRetainAutoreleased)
   UNARY_INSTRUCTION(AutoreleaseReturn)
   UNARY_INSTRUCTION(StrongRetainUnowned)
@@ -1206,6 +1242,23 @@ bool SILDeserializer::readSILInstruction(SILFunction *Fn, SILBasicBlock *BB,
   UNARY_INSTRUCTION(DebugValueAddr)
 #undef UNARY_INSTRUCTION
 
+#define REFCOUNTING_INSTRUCTION(ID) \
+  case ValueKind::ID##Inst: {                 \
+    assert(RecordKind == SIL_ONE_OPERAND &&            \
+           "Layout should be OneOperand.");            \
+    auto *RCI = Builder.create##ID(Loc, getLocalValue(ValID, ValResNum,  \
+                    getSILType(MF->getType(TyID),                        \
+                               (SILValueCategory)TyCategory)));          \
+    RCI->setNonAtomic(Attr != 0);                      \
+    ResultVal = RCI;                                   \
+    break;                                             \
+  }
+  REFCOUNTING_INSTRUCTION(RetainValue)
+  REFCOUNTING_INSTRUCTION(ReleaseValue)
+  REFCOUNTING_INSTRUCTION(StrongRetain)
+  REFCOUNTING_INSTRUCTION(StrongRelease)
+#undef REFCOUNTING_INSTRUCTION
+
   case ValueKind::LoadWeakInst: {
     auto Ty = MF->getType(TyID);
     bool isTake = (Attr > 0);
@@ -1769,6 +1822,72 @@ SILFunction *SILDeserializer::lookupSILFunction(StringRef name) {
   return Func;
 }
 
+Optional<SILFunctionSummary>
+SILDeserializer::lookupFunctionSummary(StringRef name) {
+  if (!FuncTable || FuncSummaries.empty())
+    return None;
+  auto iter = FuncTable->find(name);
+  if (iter == FuncTable->end())
+    return None;
+
+  // Each summary is an instruction count followed by flags.
+  const size_t entrySize = 2 * sizeof(uint32_t);
+  DeclID FID = *iter;
+  if (FID == 0 || FID * entrySize > FuncSummaries.size())
+    return None;
+
+  using namespace llvm::support;
+  using namespace sil_index_block;
+  const char *entry = FuncSummaries.data() + (FID - 1) * entrySize;
+  uint32_t flags = endian::read<uint32_t, little, unaligned>(
+      entry + sizeof(uint32_t));
+
+  SILFunctionSummary summary;
+  summary.NumInstructions = endian::read<uint32_t, little, unaligned>(entry);
+  summary.HasBody = flags & FuncSummaryHasBody;
+  summary.IsGeneric = flags & FuncSummaryIsGeneric;
+  summary.IsTransparent = flags & FuncSummaryIsTransparent;
+  summary.IsAlwaysInline = flags & FuncSummaryIsAlwaysInline;
+  summary.IsNoInline = flags & FuncSummaryIsNoInline;
+  summary.HasSemantics = flags & FuncSummaryHasSemantics;
+  return summary;
+}
+
+Optional<Lowering::NominalLoweringKind>
+SILDeserializer::lookupNominalLoweringKind(const NominalTypeDecl *D) {
+  if (!TypeLoweringTable)
+    return None;
+  auto iter = TypeLoweringTable->find(D->getName().str());
+  if (iter == TypeLoweringTable->end())
+    return None;
+
+  // Each entry is the type's DeclID followed by its lowering kind.
+  const size_t entrySize = 2 * sizeof(uint32_t);
+  DeclID TID = *iter;
+  if (TID == 0 || TID * entrySize > TypeLowerings.size())
+    return None;
+
+  using namespace llvm::support;
+  const char *entry = TypeLowerings.data() + (TID - 1) * entrySize;
+  DeclID typeID = endian::read<uint32_t, little, unaligned>(entry);
+  uint32_t kind = endian::read<uint32_t, little, unaligned>(
+      entry + sizeof(uint32_t));
+
+  // Only one type of each name is indexed; make sure this is the one.
+  if (MF->getDecl(typeID) != D)
+    return None;
+
+  switch (kind) {
+  case SIL_TYPE_LOWERING_TRIVIAL:
+    return Lowering::NominalLoweringKind::Trivial;
+  case SIL_TYPE_LOWERING_LOADABLE:
+    return Lowering::NominalLoweringKind::Loadable;
+  case SIL_TYPE_LOWERING_ADDRESS_ONLY:
+    return Lowering::NominalLoweringKind::AddressOnly;
+  }
+  return None;
+}
+
 SILGlobalVariable *SILDeserializer::readGlobalVar(StringRef Name) {
   if (!GlobalVarList)
     return nullptr;
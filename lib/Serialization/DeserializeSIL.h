@@ -39,6 +39,15 @@ namespace swift {
     std::unique_ptr<SerializedFuncTable> FuncTable;
     std::vector<ModuleFile::PartiallySerialized<SILFunction*>> Funcs;
 
+    /// The SIL_FUNC_SUMMARIES blob, or empty if the module doesn't have one.
+    StringRef FuncSummaries;
+
+    /// Maps type names to indices into TypeLowerings.
+    std::unique_ptr<SerializedFuncTable> TypeLoweringTable;
+
+    /// The SIL_TYPE_LOWERINGS blob, or empty if the module doesn't have one.
+    StringRef TypeLowerings;
+
     std::unique_ptr<SerializedFuncTable> VTableList;
     std::vector<ModuleFile::Serialized<SILVTable*>> VTables;
 
@@ -110,6 +119,15 @@ public:
     }
     SILFunction *lookupSILFunction(SILFunction *InFunc);
     SILFunction *lookupSILFunction(StringRef Name);
+
+    /// Returns the summary of the function named \p Name without
+    /// deserializing it, or None if the module has no summary for it.
+    Optional<SILFunctionSummary> lookupFunctionSummary(StringRef Name);
+
+    /// Returns how the module recorded that \p D lowers, or None if it
+    /// didn't.
+    Optional<Lowering::NominalLoweringKind>
+    lookupNominalLoweringKind(const NominalTypeDecl *D);
     SILVTable *lookupVTable(Identifier Name);
     SILWitnessTable *lookupWitnessTable(SILWitnessTable *wt);
 
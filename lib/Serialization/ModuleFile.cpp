@@ -22,6 +22,7 @@
 #include "swift/Serialization/BCReadingExtras.h"
 #include "swift/Serialization/SerializedModuleLoader.h"
 
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
@@ -109,6 +110,9 @@ static bool readOptionsBlock(llvm::BitstreamCursor &cursor,
     case options_block::IS_TESTABLE:
       extendedInfo.setIsTestable(true);
       break;
+    case options_block::IS_CANONICAL_SIL:
+      extendedInfo.setIsCanonicalSIL(true);
+      break;
     default:
       // Unknown options record, possibly for use by a future version of the
       // module format.
@@ -194,6 +198,9 @@ validateControlBlock(llvm::BitstreamCursor &cursor,
     case control_block::TARGET:
       result.targetTriple = blobData;
       break;
+    case control_block::INTERFACE_HASH:
+      result.interfaceHash = blobData;
+      break;
     default:
       // Unknown metadata record, possibly for use by a future version of the
       // module format.
@@ -329,6 +336,52 @@ public:
   }
 };
 
+/// Used to deserialize entries in the on-disk member name table.
+class ModuleFile::DeclMemberNamesTableInfo {
+public:
+  using internal_key_type = StringRef;
+  using external_key_type = Identifier;
+  using data_type = SmallVector<std::pair<uint64_t, DeclID>, 2>;
+  using hash_value_type = uint32_t;
+  using offset_type = unsigned;
+
+  internal_key_type GetInternalKey(external_key_type ID) {
+    return ID.str();
+  }
+
+  hash_value_type ComputeHash(internal_key_type key) {
+    return llvm::HashString(key);
+  }
+
+  static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+    return lhs == rhs;
+  }
+
+  static std::pair<unsigned, unsigned> ReadKeyDataLength(const uint8_t *&data) {
+    unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+    unsigned dataLength = endian::readNext<uint32_t, little, unaligned>(data);
+    return { keyLength, dataLength };
+  }
+
+  static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+    return StringRef(reinterpret_cast<const char *>(data), length);
+  }
+
+  static data_type ReadData(internal_key_type key, const uint8_t *data,
+                            unsigned length) {
+    data_type result;
+    while (length > 0) {
+      uint64_t membersOffset =
+          endian::readNext<uint64_t, little, unaligned>(data);
+      DeclID memberID = endian::readNext<uint32_t, little, unaligned>(data);
+      result.push_back({ membersOffset, memberID });
+      length -= sizeof(uint64_t) + sizeof(uint32_t);
+    }
+
+    return result;
+  }
+};
+
 /// Used to deserialize entries in the on-disk decl hash table.
 class ModuleFile::LocalDeclTableInfo {
 public:
@@ -378,6 +431,18 @@ ModuleFile::readDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
                                                 base + sizeof(uint32_t), base));
 }
 
+std::unique_ptr<ModuleFile::SerializedDeclMemberNamesTable>
+ModuleFile::readDeclMemberNamesTable(ArrayRef<uint64_t> fields,
+                                     StringRef blobData) {
+  uint32_t tableOffset;
+  index_block::DeclListLayout::readRecord(fields, tableOffset);
+  auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+  using OwnedTable = std::unique_ptr<SerializedDeclMemberNamesTable>;
+  return OwnedTable(SerializedDeclMemberNamesTable::Create(
+      base + tableOffset, base + sizeof(uint32_t), base));
+}
+
 std::unique_ptr<ModuleFile::SerializedLocalDeclTable>
 ModuleFile::readLocalDeclTable(ArrayRef<uint64_t> fields, StringRef blobData) {
   uint32_t tableOffset;
@@ -476,20 +541,16 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
 
       switch (kind) {
       case index_block::DECL_OFFSETS:
-        assert(blobData.empty());
-        Decls.assign(scratch.begin(), scratch.end());
+        Decls.assign(blobData);
         break;
       case index_block::DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        DeclContexts.assign(scratch.begin(), scratch.end());
+        DeclContexts.assign(blobData);
         break;
       case index_block::TYPE_OFFSETS:
-        assert(blobData.empty());
-        Types.assign(scratch.begin(), scratch.end());
+        Types.assign(blobData);
         break;
       case index_block::IDENTIFIER_OFFSETS:
-        assert(blobData.empty());
-        Identifiers.assign(scratch.begin(), scratch.end());
+        Identifiers.assign(blobData);
         break;
       case index_block::TOP_LEVEL_DECLS:
         TopLevelDecls = readDeclTable(scratch, blobData);
@@ -517,12 +578,13 @@ bool ModuleFile::readIndexBlock(llvm::BitstreamCursor &cursor) {
         LocalTypeDecls = readLocalDeclTable(scratch, blobData);
         break;
       case index_block::LOCAL_DECL_CONTEXT_OFFSETS:
-        assert(blobData.empty());
-        LocalDeclContexts.assign(scratch.begin(), scratch.end());
+        LocalDeclContexts.assign(blobData);
         break;
       case index_block::NORMAL_CONFORMANCE_OFFSETS:
-        assert(blobData.empty());
-        NormalConformances.assign(scratch.begin(), scratch.end());
+        NormalConformances.assign(blobData);
+        break;
+      case index_block::DECL_MEMBER_NAMES:
+        DeclMemberNames = readDeclMemberNamesTable(scratch, blobData);
         break;
 
       default:
@@ -757,6 +819,7 @@ ModuleFile::ModuleFile(
       }
       Name = info.name;
       TargetTriple = info.targetTriple;
+      InterfaceHash = info.interfaceHash;
 
       hasValidControlBlock = true;
       break;
@@ -1106,6 +1169,8 @@ ModuleFile::~ModuleFile() = default;
 void ModuleFile::lookupValue(DeclName name,
                              SmallVectorImpl<ValueDecl*> &results) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of",
+                                     name.getBaseName().str());
 
   if (TopLevelDecls) {
     // Find top-level declarations with the given name.
@@ -1143,6 +1208,8 @@ void ModuleFile::lookupValue(DeclName name,
 
 TypeDecl *ModuleFile::lookupLocalType(StringRef MangledName) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of local type",
+                                     MangledName);
 
   if (!LocalTypeDecls)
     return nullptr;
@@ -1156,6 +1223,7 @@ TypeDecl *ModuleFile::lookupLocalType(StringRef MangledName) {
 
 OperatorDecl *ModuleFile::lookupOperator(Identifier name, DeclKind fixity) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of operator", name.str());
 
   if (!OperatorDecls)
     return nullptr;
@@ -1253,6 +1321,7 @@ void ModuleFile::lookupVisibleDecls(Module::AccessPathTy accessPath,
                                     VisibleDeclConsumer &consumer,
                                     NLKind lookupKind) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of visible decls");
   assert(accessPath.size() <= 1 && "can only refer to top-level decls");
 
   if (!TopLevelDecls)
@@ -1278,6 +1347,8 @@ void ModuleFile::lookupVisibleDecls(Module::AccessPathTy accessPath,
 
 void ModuleFile::loadExtensions(NominalTypeDecl *nominal) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "extensions of",
+                                     nominal->getName().str());
   if (!ExtensionDecls)
     return;
 
@@ -1300,6 +1371,10 @@ void ModuleFile::loadObjCMethods(
   if (!ObjCMethods)
     return;
 
+  llvm::SmallString<32> selectorScratch;
+  DeserializationTriggerRAII trigger(*this, "Objective-C methods named",
+                                     selector.getString(selectorScratch));
+
   // Look for all methods in the module file with this selector.
   auto known = ObjCMethods->find(selector);
   if (known == ObjCMethods->end()) {
@@ -1329,6 +1404,8 @@ void ModuleFile::lookupClassMember(Module::AccessPathTy accessPath,
                                    DeclName name,
                                    SmallVectorImpl<ValueDecl*> &results) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of class member",
+                                     name.getBaseName().str());
   assert(accessPath.size() <= 1 && "can only refer to top-level decls");
 
   if (!ClassMembersByName)
@@ -1378,6 +1455,7 @@ void ModuleFile::lookupClassMember(Module::AccessPathTy accessPath,
 void ModuleFile::lookupClassMembers(Module::AccessPathTy accessPath,
                                     VisibleDeclConsumer &consumer) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "lookup of class members");
   assert(accessPath.size() <= 1 && "can only refer to top-level decls");
 
   if (!ClassMembersByName)
@@ -1415,6 +1493,7 @@ ModuleFile::collectLinkLibraries(Module::LinkLibraryCallback callback) const {
 
 void ModuleFile::getTopLevelDecls(SmallVectorImpl<Decl *> &results) {
   PrettyModuleFileDeserialization stackEntry(*this);
+  DeserializationTriggerRAII trigger(*this, "all top-level decls");
   if (OperatorDecls) {
     for (auto entry : OperatorDecls->data()) {
       for (auto item : entry)
@@ -1508,12 +1587,65 @@ Identifier ModuleFile::getDiscriminatorForPrivateValue(const ValueDecl *D) {
   return discriminator;
 }
 
+ModuleFile::DeserializationTriggerRAII::DeserializationTriggerRAII(
+    ModuleFile &file, StringRef kind, StringRef name) : File(file) {
+  if (!File.CurrentTrigger.empty() || !File.isTracingDeserialization())
+    return;
+
+  IsOutermost = true;
+  File.CurrentTrigger = kind;
+  if (!name.empty()) {
+    File.CurrentTrigger += " '";
+    File.CurrentTrigger += name;
+    File.CurrentTrigger += "'";
+  }
+}
+
+bool ModuleFile::isTracingDeserialization() const {
+  return FileContext && getContext().LangOpts.TraceDeserialization;
+}
+
+void ModuleFile::noteDeserializedDecl() {
+  ++Stats.NumDecls;
+  if (isTracingDeserialization())
+    ++DeclsByTrigger[CurrentTrigger.empty() ? "(no request)" : CurrentTrigger];
+}
+
+void ModuleFile::printDeserializationStats(raw_ostream &os) const {
+  os << Name << ": " << Stats.NumDecls << " decls, " << Stats.NumTypes
+     << " types, " << Stats.NumConformances << " conformances, "
+     << Stats.NumSILFunctions << " SIL functions\n";
+
+  if (DeclsByTrigger.empty())
+    return;
+
+  // List the requests that caused the most decls to be deserialized first.
+  using TriggerAndCount = std::pair<StringRef, unsigned>;
+  SmallVector<TriggerAndCount, 32> triggers;
+  for (auto &entry : DeclsByTrigger)
+    triggers.push_back({ entry.getKey(), entry.getValue() });
+  std::sort(triggers.begin(), triggers.end(),
+            [](const TriggerAndCount &lhs, const TriggerAndCount &rhs) {
+    if (lhs.second != rhs.second)
+      return lhs.second > rhs.second;
+    return lhs.first < rhs.first;
+  });
+
+  const size_t maxTriggers = 20;
+  for (size_t i = 0, e = std::min(triggers.size(), maxTriggers); i != e; ++i)
+    os << "  " << triggers[i].second << " decls for " << triggers[i].first
+       << "\n";
+  if (triggers.size() > maxTriggers)
+    os << "  (" << triggers.size() - maxTriggers << " more requests)\n";
+}
+
 void ModuleFile::verify() const {
 #ifndef NDEBUG
   const auto &Context = getContext();
-  for (const Serialized<Decl*> &next : Decls)
-    if (next.isComplete() && swift::shouldVerify(next, Context))
-      swift::verify(next);
+  for (size_t i = 0, e = Decls.size(); i != e; ++i)
+    if (auto next = Decls.getIfLoaded(i))
+      if (next->isComplete() && swift::shouldVerify(*next, Context))
+        swift::verify(*next);
 #endif
 }
 
@@ -69,6 +69,12 @@ enum CastConsumptionKindEncoding : uint8_t {
   SIL_CAST_CONSUMPTION_COPY_ON_SUCCESS,
 };
 
+enum TypeLoweringKindEncoding : uint8_t {
+  SIL_TYPE_LOWERING_TRIVIAL,
+  SIL_TYPE_LOWERING_LOADABLE,
+  SIL_TYPE_LOWERING_ADDRESS_ONLY,
+};
+
 // Constants for packing an encoded CheckedCastKind and
 // CastConsumptionKind together.
 enum {
@@ -92,7 +98,26 @@ namespace sil_index_block {
     SIL_GLOBALVAR_NAMES,
     SIL_GLOBALVAR_OFFSETS,
     SIL_WITNESSTABLE_NAMES,
-    SIL_WITNESSTABLE_OFFSETS
+    SIL_WITNESSTABLE_OFFSETS,
+
+    /// A summary of each function in SIL_FUNC_OFFSETS, so that clients can
+    /// decide whether a body is worth deserializing.
+    SIL_FUNC_SUMMARIES,
+
+    /// A map from the names of public, non-generic structs and enums to an
+    /// index into SIL_TYPE_LOWERINGS.
+    SIL_TYPE_LOWERING_NAMES,
+    SIL_TYPE_LOWERINGS
+  };
+
+  /// The flags of a function summary.
+  enum FuncSummaryFlags : uint32_t {
+    FuncSummaryHasBody = 1 << 0,
+    FuncSummaryIsGeneric = 1 << 1,
+    FuncSummaryIsTransparent = 1 << 2,
+    FuncSummaryIsAlwaysInline = 1 << 3,
+    FuncSummaryIsNoInline = 1 << 4,
+    FuncSummaryHasSemantics = 1 << 5,
   };
 
   using ListLayout = BCGenericRecordLayout<
@@ -105,6 +130,21 @@ namespace sil_index_block {
     BCFixed<4>,  // record ID
     BCArray<BitOffsetField>
   >;
+
+  /// One entry per function, in function ID order: a 32-bit instruction
+  /// count followed by 32 bits of FuncSummaryFlags, both little-endian.
+  using FuncSummariesLayout = BCRecordLayout<
+    SIL_FUNC_SUMMARIES,
+    BCBlob
+  >;
+
+  /// One entry per type in SIL_TYPE_LOWERING_NAMES, in ID order: the 32-bit
+  /// DeclID of the type followed by 32 bits of TypeLoweringKindEncoding,
+  /// both little-endian.
+  using TypeLoweringsLayout = BCRecordLayout<
+    SIL_TYPE_LOWERINGS,
+    BCBlob
+  >;
 }
 
 /// The record types within the "sil" block.
@@ -305,7 +345,8 @@ namespace sil_block {
     SIL_PARTIAL_APPLY,
     SIL_BUILTIN,
     SIL_TRY_APPLY,
-    SIL_NON_THROWING_APPLY
+    SIL_NON_THROWING_APPLY,
+    SIL_PARTIAL_APPLY_ON_STACK
   };
   
   using SILInstApplyLayout = BCRecordLayout<
@@ -18,6 +18,7 @@
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/AST/LinkLibrary.h"
 #include "swift/AST/Mangle.h"
+#include "swift/AST/PrintOptions.h"
 #include "swift/AST/RawComment.h"
 #include "swift/AST/USRGeneration.h"
 #include "swift/Basic/Dwarf.h"
@@ -27,6 +28,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/ClangImporter/ClangModule.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/Serialization/SerializationOptions.h"
 
 #include "clang/Basic/Module.h"
@@ -42,11 +44,14 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <atomic>
+#include <thread>
 #include <vector>
 
 using namespace swift;
@@ -96,6 +101,48 @@ namespace {
     }
   };
 
+  class DeclMemberNamesTableInfo {
+  public:
+    using key_type = Identifier;
+    using key_type_ref = key_type;
+    using data_type = Serializer::DeclMemberNamesData;
+    using data_type_ref = const data_type &;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      assert(!key.empty());
+      return llvm::HashString(key.str());
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = key.str().size();
+      // Common names like 'init' can appear in thousands of member lists, so
+      // use a wider data length than the other decl tables.
+      uint32_t dataLength = (sizeof(uint64_t) + sizeof(DeclID)) * data.size();
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint32_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      out << key.str();
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      static_assert(sizeof(DeclID) <= 4, "DeclID too large");
+      endian::Writer<little> writer(out);
+      for (auto entry : data) {
+        writer.write<uint64_t>(entry.first);
+        writer.write<uint32_t>(entry.second);
+      }
+    }
+  };
+
   class LocalDeclTableInfo {
   public:
     using key_type = std::string;
@@ -419,6 +466,7 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(control_block, METADATA);
   BLOCK_RECORD(control_block, MODULE_NAME);
   BLOCK_RECORD(control_block, TARGET);
+  BLOCK_RECORD(control_block, INTERFACE_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   BLOCK_RECORD(options_block, SDK_PATH);
@@ -515,6 +563,9 @@ void Serializer::writeBlockInfoBlock() {
   BLOCK_RECORD(sil_index_block, SIL_GLOBALVAR_OFFSETS);
   BLOCK_RECORD(sil_index_block, SIL_WITNESSTABLE_NAMES);
   BLOCK_RECORD(sil_index_block, SIL_WITNESSTABLE_OFFSETS);
+  BLOCK_RECORD(sil_index_block, SIL_FUNC_SUMMARIES);
+  BLOCK_RECORD(sil_index_block, SIL_TYPE_LOWERING_NAMES);
+  BLOCK_RECORD(sil_index_block, SIL_TYPE_LOWERINGS);
 
 #undef BLOCK
 #undef BLOCK_RECORD
@@ -541,7 +592,96 @@ void Serializer::writeDocBlockInfoBlock() {
 #undef BLOCK_RECORD
 }
 
-void Serializer::writeHeader(const SerializationOptions &options) {
+/// Adds the layout of \p nominal, and of the types nested in it, to
+/// \p entries.
+///
+/// Clients compile in the layout of the types they use, including stored
+/// properties they can't access, so it's part of the interface even for
+/// types that aren't public.
+static void collectLayout(const NominalTypeDecl *nominal,
+                          std::vector<std::string> &entries) {
+  std::string entry;
+  llvm::raw_string_ostream os(entry);
+  os << "layout " << nominal->getName() << " " << nominal->getDeclaredType();
+  for (const Decl *member : nominal->getMembers()) {
+    if (auto *var = dyn_cast<VarDecl>(member)) {
+      if (var->hasStorage() && !var->isStatic())
+        os << "\n" << var->getName() << ": " << var->getType();
+    } else if (auto *elt = dyn_cast<EnumElementDecl>(member)) {
+      os << "\ncase " << elt->getName();
+      if (elt->hasArgumentType())
+        os << elt->getArgumentType();
+    } else if (auto *nested = dyn_cast<NominalTypeDecl>(member)) {
+      collectLayout(nested, entries);
+    }
+  }
+  entries.push_back(std::move(os.str()));
+}
+
+/// Computes a hash of everything that modules importing \p M depend on: the
+/// interface of its public declarations (and internal ones, if it's built for
+/// testing), the layout of its types, and the SIL of functions that can be
+/// inlined into clients.
+///
+/// Changes that only affect the implementation of the module don't change
+/// the hash, so the build system can avoid rebuilding its clients.
+static void computeInterfaceHash(const ModuleDecl *M, const SourceFile *SF,
+                                 const SILModule *SILMod,
+                                 SmallVectorImpl<char> &hash) {
+  SmallVector<Decl *, 32> topLevelDecls;
+  if (SF)
+    topLevelDecls.append(SF->Decls.begin(), SF->Decls.end());
+  else
+    M->getTopLevelDecls(topLevelDecls);
+
+  PrintOptions options = M->isTestingEnabled()
+    ? PrintOptions::printTestableInterface()
+    : PrintOptions::printInterface();
+  options.PrintDocumentationComments = false;
+  options.PrintRegularClangComments = false;
+
+  // Print each piece separately and sort them, so that moving declarations
+  // around doesn't change the hash.
+  std::vector<std::string> entries;
+  for (const Decl *D : topLevelDecls) {
+    std::string entry;
+    llvm::raw_string_ostream os(entry);
+    D->print(os, options);
+    if (!os.str().empty())
+      entries.push_back(std::move(os.str()));
+
+    if (auto *nominal = dyn_cast<NominalTypeDecl>(D))
+      collectLayout(nominal, entries);
+  }
+
+  if (SILMod) {
+    for (const SILFunction &F : SILMod->getFunctions()) {
+      if (!F.isFragile() || !F.isDefinition())
+        continue;
+      std::string entry;
+      llvm::raw_string_ostream os(entry);
+      F.print(os);
+      entries.push_back(std::move(os.str()));
+    }
+  }
+
+  std::sort(entries.begin(), entries.end());
+
+  llvm::MD5 hasher;
+  for (const std::string &entry : entries) {
+    hasher.update(entry);
+    // Keep adjacent entries from running together.
+    hasher.update(StringRef("\0", 1));
+  }
+  llvm::MD5::MD5Result result;
+  hasher.final(result);
+  SmallString<32> str;
+  llvm::MD5::stringifyResult(result, str);
+  hash.append(str.begin(), str.end());
+}
+
+void Serializer::writeHeader(const SerializationOptions &options,
+                             const SILModule *SILMod) {
   {
     BCBlockRAII restoreBlock(Out, CONTROL_BLOCK_ID, 3);
     control_block::ModuleNameLayout ModuleName(Out);
@@ -562,6 +702,13 @@ void Serializer::writeHeader(const SerializationOptions &options) {
 
     Target.emit(ScratchRecord, M->getASTContext().LangOpts.Target.str());
 
+    if (SILMod) {
+      control_block::InterfaceHashLayout InterfaceHash(Out);
+      SmallString<32> hash;
+      computeInterfaceHash(M, SF, SILMod, hash);
+      InterfaceHash.emit(ScratchRecord, hash);
+    }
+
     {
       llvm::BCBlockRAII restoreBlock(Out, OPTIONS_BLOCK_ID, 3);
 
@@ -573,6 +720,14 @@ void Serializer::writeHeader(const SerializationOptions &options) {
         IsTestable.emit(ScratchRecord);
       }
 
+      // An intermediate file remembers the stage of its SIL, so that it can
+      // be loaded in place of a textual SIL dump.
+      if (options.IsSIB && SILMod &&
+          SILMod->getStage() == SILStage::Canonical) {
+        options_block::IsCanonicalSILLayout IsCanonicalSIL(Out);
+        IsCanonicalSIL.emit(ScratchRecord);
+      }
+
       if (options.SerializeOptionsForDebugging) {
         options_block::SDKPathLayout SDKPath(Out);
         options_block::XCCLayout XCC(Out);
@@ -1220,6 +1375,11 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
 
   unsigned abbrCode = DeclTypeAbbrCodes[MembersLayout::Code];
   SmallVector<DeclID, 16> memberIDs;
+
+  // This is where the members record will start, which is also the context
+  // data the deserializer gives the member loader of the parent decl.
+  uint64_t membersOffset = Out.GetCurrentBitNo();
+
   for (auto member : members) {
     if (!shouldSerializeMember(member))
       continue;
@@ -1227,6 +1387,11 @@ void Serializer::writeMembers(DeclRange members, bool isClass) {
     DeclID memberID = addDeclRef(member);
     memberIDs.push_back(memberID);
 
+    if (auto VD = dyn_cast<ValueDecl>(member)) {
+      if (VD->hasName())
+        DeclMemberNames[VD->getName()].push_back({membersOffset, memberID});
+    }
+
     if (isClass) {
       if (auto VD = dyn_cast<ValueDecl>(member)) {
         if (VD->canBeAccessedByDynamicLookup()) {
@@ -3283,48 +3448,75 @@ void Serializer::writeAllIdentifiers() {
 
 void Serializer::writeOffsets(const index_block::OffsetsLayout &Offsets,
                               const std::vector<BitOffset> &values) {
-  Offsets.emit(ScratchRecord, getOffsetRecordCode(values), values);
+  llvm::SmallString<4096> blob;
+  {
+    llvm::raw_svector_ostream blobStream(blob);
+    endian::Writer<little> writer(blobStream);
+    for (BitOffset offset : values)
+      writer.write<uint32_t>(offset);
+  }
+  Offsets.emit(ScratchRecord, getOffsetRecordCode(values), blob);
 }
 
-/// Writes an in-memory decl table to an on-disk representation, using the
-/// given layout.
-static void writeDeclTable(const index_block::DeclListLayout &DeclList,
-                           index_block::RecordKind kind,
-                           const Serializer::DeclTable &table) {
+void serialization::runConcurrently(ArrayRef<std::function<void()>> tasks,
+                                    unsigned numThreads) {
+  if (numThreads < 2 || tasks.size() < 2) {
+    for (auto &task : tasks)
+      task();
+    return;
+  }
+
+  std::atomic<size_t> nextTask{0};
+  auto runTasks = [&] {
+    for (size_t i = nextTask++; i < tasks.size(); i = nextTask++)
+      tasks[i]();
+  };
+
+  std::vector<std::thread> threads;
+  size_t numWorkers = std::min<size_t>(numThreads, tasks.size());
+  for (size_t i = 1; i < numWorkers; ++i)
+    threads.push_back(std::thread(runTasks));
+  runTasks();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+/// Builds the on-disk representation of an in-memory decl table.
+///
+/// Leaves \p blob empty if the table is.
+static void buildDeclTable(const Serializer::DeclTable &table,
+                           HashTableBlob &blob) {
   if (table.empty())
     return;
 
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
-    for (auto &entry : table)
-      generator.insert(entry.first, entry.second);
+  llvm::OnDiskChainedHashTableGenerator<DeclTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  blob.build(generator);
+}
 
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+static void
+buildDeclMemberNamesTable(const Serializer::DeclMemberNamesTable &table,
+                          HashTableBlob &blob) {
+  if (table.empty())
+    return;
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  llvm::OnDiskChainedHashTableGenerator<DeclMemberNamesTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  blob.build(generator);
 }
 
-static void writeLocalDeclTable(const index_block::DeclListLayout &DeclList,
-                                index_block::RecordKind kind,
-                                LocalTypeHashTableGenerator &generator) {
-  SmallVector<uint64_t, 8> scratch;
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+/// Writes a decl table built by one of the functions above, using the given
+/// layout, unless it is empty.
+static void writeDeclTable(const index_block::DeclListLayout &DeclList,
+                           index_block::RecordKind kind,
+                           const HashTableBlob &blob) {
+  if (blob.Data.empty())
+    return;
 
-  DeclList.emit(scratch, kind, tableOffset, hashTableBlob);
+  SmallVector<uint64_t, 8> scratch;
+  DeclList.emit(scratch, kind, blob.Offset, blob.Data);
 }
 
 namespace {
@@ -3491,8 +3683,8 @@ namespace {
   };
 } // end anonymous namespace
 
-static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
-                                 Serializer::ObjCMethodTable &objcMethods) {
+static void buildObjCMethodTable(Serializer::ObjCMethodTable &objcMethods,
+                                 HashTableBlob &blob) {
   // Collect all of the Objective-C selectors in the method table.
   std::vector<ObjCSelector> selectors;
   for (const auto &entry : objcMethods) {
@@ -3504,21 +3696,10 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
 
   // Create the on-disk hash table.
   llvm::OnDiskChainedHashTableGenerator<ObjCMethodTableInfo> generator;
-  llvm::SmallString<32> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    for (auto selector : selectors) {
-      generator.insert(selector, objcMethods[selector]);
-    }
-
-    // Make sure that no bucket is at offset 0
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
+  for (auto selector : selectors) {
+    generator.insert(selector, objcMethods[selector]);
   }
-
-  SmallVector<uint64_t, 8> scratch;
-  out.emit(scratch, tableOffset, hashTableBlob);
+  blob.build(generator);
 }
 
 /// Add operator methods from the given declaration type.
@@ -3655,6 +3836,26 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
   writeAllDeclsAndTypes();
   writeAllIdentifiers();
 
+  // The lookup tables only refer to decls and identifiers that have been
+  // assigned IDs already, so they can be built independently of each other,
+  // and then written out in a fixed order.
+  HashTableBlob topLevelBlob, operatorBlob, extensionBlob, classMembersBlob,
+                operatorMethodBlob, memberNamesBlob, localTypeBlob, objcBlob;
+  std::function<void()> tableBuilders[] = {
+    [&]{ buildDeclTable(topLevelDecls, topLevelBlob); },
+    [&]{ buildDeclTable(operatorDecls, operatorBlob); },
+    [&]{ buildDeclTable(extensionDecls, extensionBlob); },
+    [&]{ buildDeclTable(ClassMembersByName, classMembersBlob); },
+    [&]{ buildDeclTable(operatorMethodDecls, operatorMethodBlob); },
+    [&]{ buildDeclMemberNamesTable(DeclMemberNames, memberNamesBlob); },
+    [&]{
+      if (hasLocalTypes)
+        localTypeBlob.build(localTypeGenerator);
+    },
+    [&]{ buildObjCMethodTable(objcMethods, objcBlob); },
+  };
+  runConcurrently(tableBuilders, NumThreads);
+
   {
     BCBlockRAII restoreBlock(Out, INDEX_BLOCK_ID, 4);
 
@@ -3667,17 +3868,17 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     writeOffsets(Offsets, NormalConformanceOffsets);
 
     index_block::DeclListLayout DeclList(Out);
-    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelDecls);
-    writeDeclTable(DeclList, index_block::OPERATORS, operatorDecls);
-    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionDecls);
-    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, ClassMembersByName);
-    writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodDecls);
-    if (hasLocalTypes)
-      writeLocalDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS,
-                          localTypeGenerator);
+    writeDeclTable(DeclList, index_block::TOP_LEVEL_DECLS, topLevelBlob);
+    writeDeclTable(DeclList, index_block::OPERATORS, operatorBlob);
+    writeDeclTable(DeclList, index_block::EXTENSIONS, extensionBlob);
+    writeDeclTable(DeclList, index_block::CLASS_MEMBERS, classMembersBlob);
+    writeDeclTable(DeclList, index_block::OPERATOR_METHODS, operatorMethodBlob);
+    writeDeclTable(DeclList, index_block::DECL_MEMBER_NAMES, memberNamesBlob);
+    writeDeclTable(DeclList, index_block::LOCAL_TYPE_DECLS, localTypeBlob);
 
     index_block::ObjCMethodTableLayout ObjCMethodTable(Out);
-    writeObjCMethodTable(ObjCMethodTable, objcMethods);
+    SmallVector<uint64_t, 8> scratch;
+    ObjCMethodTable.emit(scratch, objcBlob.Offset, objcBlob.Data);
 
     if (entryPointClassID.hasValue()) {
       index_block::EntryPointLayout EntryPoint(Out);
@@ -3706,13 +3907,14 @@ void Serializer::writeToStream(raw_ostream &os, ModuleOrSourceFile DC,
                                const SILModule *SILMod,
                                const SerializationOptions &options) {
   Serializer S{MODULE_SIGNATURE, DC};
+  S.NumThreads = options.NumThreads;
 
   // FIXME: This is only really needed for debugging. We don't actually use it.
   S.writeBlockInfoBlock();
 
   {
     BCBlockRAII moduleBlock(S.Out, MODULE_BLOCK_ID, 2);
-    S.writeHeader(options);
+    S.writeHeader(options, SILMod);
     S.writeInputBlock(options);
     S.writeSIL(SILMod, options.SerializeAllSIL);
     S.writeAST(DC);
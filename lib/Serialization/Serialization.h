@@ -23,7 +23,10 @@
 #include "swift/AST/Identifier.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/EndianStream.h"
 #include <array>
+#include <functional>
 #include <queue>
 #include <tuple>
 
@@ -34,6 +37,32 @@ namespace serialization {
 
 typedef ArrayRef<std::string> FilenamesTy;
 
+/// An on-disk hash table that has been built but not yet written out.
+struct HashTableBlob {
+  /// The contents of the table, or empty if there is no table to write.
+  llvm::SmallString<4096> Data;
+
+  /// The offset of the table's buckets within \c Data.
+  uint32_t Offset = 0;
+
+  template <typename Generator>
+  void build(Generator &generator) {
+    using namespace llvm::support;
+    llvm::raw_svector_ostream blobStream(Data);
+    // Make sure that no bucket is at offset 0
+    endian::Writer<little>(blobStream).write<uint32_t>(0);
+    Offset = generator.Emit(blobStream);
+  }
+};
+
+/// Runs each of \p tasks once, spreading them over up to \p numThreads
+/// threads, and returns once they have all finished.
+///
+/// With fewer than two threads, the tasks are run in order on the calling
+/// thread.
+void runConcurrently(ArrayRef<std::function<void()>> tasks,
+                     unsigned numThreads);
+
 class Serializer {
   SmallVector<char, 0> Buffer;
   llvm::BitstreamWriter Out{Buffer};
@@ -50,6 +79,9 @@ class Serializer {
   /// serialized. Any other decls will be cross-referenced instead.
   const SourceFile *SF = nullptr;
 
+  /// The number of threads to use to build lookup tables.
+  unsigned NumThreads = 0;
+
 public:
   /// Stores a declaration or a type to be written to the AST file.
   ///
@@ -123,12 +155,25 @@ public:
   // hash table of all defined Objective-C methods.
   using ObjCMethodTable = llvm::DenseMap<ObjCSelector, ObjCMethodTableData>;
 
+  /// Bit offsets of member lists paired with the ID of a member in each.
+  using DeclMemberNamesData = SmallVector<std::pair<uint64_t, DeclID>, 2>;
+
+  /// The in-memory representation of what will eventually be an on-disk
+  /// hash table of members by name.
+  using DeclMemberNamesTable = llvm::MapVector<Identifier, DeclMemberNamesData>;
+
 private:
   /// A map from identifiers to methods and properties with the given name.
   ///
   /// This is used for id-style lookup.
   DeclTable ClassMembersByName;
 
+  /// A map from identifiers to the members of nominal types and extensions
+  /// with the given base name.
+  ///
+  /// This lets clients deserialize only the members they look up by name.
+  DeclMemberNamesTable DeclMemberNames;
+
   /// The queue of types and decls that need to be serialized.
   ///
   /// This is a queue and not simply a vector because serializing one
@@ -226,7 +271,10 @@ private:
 
   /// Writes the Swift module file header and name, plus metadata determining
   /// if the module can be loaded.
-  void writeHeader(const SerializationOptions &options = {});
+  ///
+  /// If \p SILMod is given, the header includes the module's interface hash.
+  void writeHeader(const SerializationOptions &options = {},
+                   const SILModule *SILMod = nullptr);
 
   /// Writes the Swift doc module file header and name.
   void writeDocHeader();
@@ -333,6 +381,11 @@ public:
   /// Serialize module documentation to the given stream.
   static void writeDocToStream(raw_ostream &os, ModuleOrSourceFile DC);
 
+  /// Returns the number of threads to use to build lookup tables.
+  unsigned getNumThreads() const {
+    return NumThreads;
+  }
+
   /// Records the use of the given Type.
   ///
   /// The Type will be scheduled for serialization if necessary.
@@ -129,6 +129,8 @@ namespace {
     /// FuncTable maps function name to an ID.
     Table FuncTable;
     std::vector<BitOffset> Funcs;
+    /// The contents of the SIL_FUNC_SUMMARIES record, in function ID order.
+    llvm::SmallString<1024> FuncSummaries;
     /// The current function ID.
     DeclID FuncID = 1;
 
@@ -150,6 +152,12 @@ namespace {
     std::vector<BitOffset> WitnessTableOffset;
     DeclID WitnessTableID = 1;
 
+    /// Maps type name to an index into TypeLowerings.
+    Table TypeLoweringList;
+    /// The contents of the SIL_TYPE_LOWERINGS record, in index order.
+    llvm::SmallString<256> TypeLowerings;
+    DeclID TypeLoweringID = 1;
+
     /// Give each SILBasicBlock a unique ID.
     llvm::DenseMap<const SILBasicBlock*, unsigned> BasicBlockMap;
 
@@ -176,6 +184,8 @@ namespace {
                           SmallVectorImpl<ValueID> &ListOfValues);
 
     void writeSILFunction(const SILFunction &F, bool DeclOnly = false);
+    /// Appends the summary of \p F to FuncSummaries.
+    void writeFuncSummary(const SILFunction &F, bool NoBody);
     void writeSILBasicBlock(const SILBasicBlock &BB);
     void writeSILInstruction(const SILInstruction &SI);
     void writeSILVTable(const SILVTable &vt);
@@ -183,6 +193,11 @@ namespace {
     void writeSILWitnessTable(const SILWitnessTable &wt);
 
     void writeSILBlock(const SILModule *SILMod);
+    /// Appends how the public, non-generic structs and enums of the module
+    /// lower to TypeLowerings.
+    void writeTypeLowerings(const SILModule *SILMod);
+    void writeTypeLowering(NominalTypeDecl *D,
+                           Lowering::NominalLoweringKind Kind);
     void writeIndexTables();
 
     void writeConversionLikeInstruction(const SILInstruction *I);
@@ -223,6 +238,95 @@ ValueID SILSerializer::addValueRef(const ValueBase *Val) {
   return id;
 }
 
+void SILSerializer::writeFuncSummary(const SILFunction &F, bool NoBody) {
+  using namespace sil_index_block;
+
+  uint32_t NumInstructions = 0;
+  uint32_t Flags = 0;
+  if (!NoBody) {
+    Flags |= FuncSummaryHasBody;
+    for (const SILBasicBlock &BB : F)
+      NumInstructions += std::distance(BB.begin(), BB.end());
+  }
+  if (F.getLoweredFunctionType()->isPolymorphic())
+    Flags |= FuncSummaryIsGeneric;
+  if (F.isTransparent())
+    Flags |= FuncSummaryIsTransparent;
+  if (F.getInlineStrategy() == AlwaysInline)
+    Flags |= FuncSummaryIsAlwaysInline;
+  if (F.getInlineStrategy() == NoInline)
+    Flags |= FuncSummaryIsNoInline;
+  if (!F.getSemanticsAttr().empty())
+    Flags |= FuncSummaryHasSemantics;
+
+  llvm::raw_svector_ostream SummaryStream(FuncSummaries);
+  endian::Writer<little> Writer(SummaryStream);
+  Writer.write<uint32_t>(NumInstructions);
+  Writer.write<uint32_t>(Flags);
+}
+
+void SILSerializer::writeTypeLowerings(const SILModule *SILMod) {
+  SmallVector<Decl *, 64> Decls;
+  const DeclContext *AssocDC = SILMod->getAssociatedContext();
+  if (auto *File = dyn_cast<FileUnit>(AssocDC))
+    File->getTopLevelDecls(Decls);
+  else
+    cast<ModuleDecl>(AssocDC)->getTopLevelDecls(Decls);
+
+  // Nested types are appended as their parents are visited.
+  for (unsigned i = 0; i != Decls.size(); ++i) {
+    Decl *D = Decls[i];
+    if (auto *Ext = dyn_cast<ExtensionDecl>(D)) {
+      for (Decl *Member : Ext->getMembers())
+        if (isa<NominalTypeDecl>(Member))
+          Decls.push_back(Member);
+      continue;
+    }
+
+    auto *NTD = dyn_cast<NominalTypeDecl>(D);
+    if (!NTD || NTD->isInvalid())
+      continue;
+    for (Decl *Member : NTD->getMembers())
+      if (isa<NominalTypeDecl>(Member))
+        Decls.push_back(Member);
+
+    if (!isa<StructDecl>(NTD) && !isa<EnumDecl>(NTD))
+      continue;
+    if (NTD->isGenericContext() || !NTD->hasAccessibility() ||
+        NTD->getFormalAccess() != Accessibility::Public)
+      continue;
+    writeTypeLowering(NTD, SILMod->Types.getNominalLoweringKind(NTD));
+  }
+}
+
+void SILSerializer::writeTypeLowering(NominalTypeDecl *D,
+                                      Lowering::NominalLoweringKind Kind) {
+  // The table is keyed by name, so only the first type of each name can be
+  // looked up. Clients lower any others themselves.
+  DeclID &ID = TypeLoweringList[D->getName()];
+  if (ID)
+    return;
+  ID = TypeLoweringID++;
+
+  TypeLoweringKindEncoding Encoding;
+  switch (Kind) {
+  case Lowering::NominalLoweringKind::Trivial:
+    Encoding = SIL_TYPE_LOWERING_TRIVIAL;
+    break;
+  case Lowering::NominalLoweringKind::Loadable:
+    Encoding = SIL_TYPE_LOWERING_LOADABLE;
+    break;
+  case Lowering::NominalLoweringKind::AddressOnly:
+    Encoding = SIL_TYPE_LOWERING_ADDRESS_ONLY;
+    break;
+  }
+
+  llvm::raw_svector_ostream LoweringStream(TypeLowerings);
+  endian::Writer<little> Writer(LoweringStream);
+  Writer.write<uint32_t>(S.addDeclRef(D));
+  Writer.write<uint32_t>(Encoding);
+}
+
 void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
   ValueIDs.clear();
   InstID = 0;
@@ -265,6 +369,8 @@ void SILSerializer::writeSILFunction(const SILFunction &F, bool DeclOnly) {
     Linkage = addExternalToLinkage(Linkage);
   }
 
+  writeFuncSummary(F, NoBody);
+
   SILFunctionLayout::emitRecord(
       Out, ScratchRecord, abbrCode, toStableSILLinkage(Linkage),
       (unsigned)F.isTransparent(), (unsigned)F.isFragile(),
@@ -670,7 +776,8 @@ void SILSerializer::writeSILInstruction(const SILInstruction &SI) {
       Args.push_back(Arg.getResultNumber());
     }
     SILInstApplyLayout::emitRecord(Out, ScratchRecord,
-        SILAbbrCodes[SILInstApplyLayout::Code], SIL_PARTIAL_APPLY,
+        SILAbbrCodes[SILInstApplyLayout::Code],
+        PAI->canAllocOnStack() ? SIL_PARTIAL_APPLY_ON_STACK : SIL_PARTIAL_APPLY,
         PAI->getSubstitutions().size(),
         S.addTypeRef(PAI->getCallee().getType().getSwiftRValueType()),
         S.addTypeRef(PAI->getSubstCalleeType()),
@@ -916,6 +1023,8 @@ void SILSerializer::writeSILInstruction(const SILInstruction &SI) {
       Attr = (unsigned)MUI->getKind();
     else if (auto *DRI = dyn_cast<DeallocRefInst>(&SI))
       Attr = (unsigned)DRI->canAllocOnStack();
+    else if (auto *RCI = dyn_cast<RefCountingInst>(&SI))
+      Attr = (unsigned)RCI->isNonAtomic();
     writeOneOperandLayout(SI.getKind(), Attr, SI.getOperand(0));
     break;
   }
@@ -1471,59 +1580,88 @@ void SILSerializer::writeSILInstruction(const SILInstruction &SI) {
   }
 }
 
+/// Builds the on-disk hash table for the SILFunction table, the global
+/// variable table, the table for SILVTable, or the table for SILWitnessTable.
+static void buildIndexTable(const SILSerializer::Table &table,
+                            HashTableBlob &blob) {
+  if (table.empty())
+    return;
+
+  llvm::OnDiskChainedHashTableGenerator<FuncTableInfo> generator;
+  for (auto &entry : table)
+    generator.insert(entry.first, entry.second);
+  blob.build(generator);
+}
+
 /// Depending on the RecordKind, we write the SILFunction table, the global
 /// variable table, the table for SILVTable, or the table for SILWitnessTable.
 static void writeIndexTable(const sil_index_block::ListLayout &List,
                             sil_index_block::RecordKind kind,
-                            const SILSerializer::Table &table) {
+                            const HashTableBlob &blob) {
   assert((kind == sil_index_block::SIL_FUNC_NAMES ||
           kind == sil_index_block::SIL_VTABLE_NAMES ||
           kind == sil_index_block::SIL_GLOBALVAR_NAMES ||
-          kind == sil_index_block::SIL_WITNESSTABLE_NAMES) &&
-         "SIL function table, global, vtable and witness table are supported");
-  llvm::SmallString<4096> hashTableBlob;
-  uint32_t tableOffset;
-  {
-    llvm::OnDiskChainedHashTableGenerator<FuncTableInfo> generator;
-    for (auto &entry : table)
-      generator.insert(entry.first, entry.second);
-
-    llvm::raw_svector_ostream blobStream(hashTableBlob);
-    // Make sure that no bucket is at offset 0.
-    endian::Writer<little>(blobStream).write<uint32_t>(0);
-    tableOffset = generator.Emit(blobStream);
-  }
+          kind == sil_index_block::SIL_WITNESSTABLE_NAMES ||
+          kind == sil_index_block::SIL_TYPE_LOWERING_NAMES) &&
+         "SIL function table, global, vtable, witness table and type lowering "
+         "table are supported");
   SmallVector<uint64_t, 8> scratch;
-  List.emit(scratch, kind, tableOffset, hashTableBlob);
+  List.emit(scratch, kind, blob.Offset, blob.Data);
 }
 
 void SILSerializer::writeIndexTables() {
+  // The name tables are independent of each other, so build them
+  // concurrently before writing any of them out.
+  HashTableBlob funcBlob, vtableBlob, globalVarBlob, witnessTableBlob,
+      typeLoweringBlob;
+  std::function<void()> tableBuilders[] = {
+    [&]{ buildIndexTable(FuncTable, funcBlob); },
+    [&]{ buildIndexTable(VTableList, vtableBlob); },
+    [&]{ buildIndexTable(GlobalVarList, globalVarBlob); },
+    [&]{ buildIndexTable(WitnessTableList, witnessTableBlob); },
+    [&]{ buildIndexTable(TypeLoweringList, typeLoweringBlob); },
+  };
+  runConcurrently(tableBuilders, S.getNumThreads());
+
   BCBlockRAII restoreBlock(Out, SIL_INDEX_BLOCK_ID, 4);
 
   sil_index_block::ListLayout List(Out);
   sil_index_block::OffsetLayout Offset(Out);
   if (!FuncTable.empty()) {
-    writeIndexTable(List, sil_index_block::SIL_FUNC_NAMES, FuncTable);
+    writeIndexTable(List, sil_index_block::SIL_FUNC_NAMES, funcBlob);
     Offset.emit(ScratchRecord, sil_index_block::SIL_FUNC_OFFSETS, Funcs);
   }
 
   if (!VTableList.empty()) {
-    writeIndexTable(List, sil_index_block::SIL_VTABLE_NAMES, VTableList);
+    writeIndexTable(List, sil_index_block::SIL_VTABLE_NAMES, vtableBlob);
     Offset.emit(ScratchRecord, sil_index_block::SIL_VTABLE_OFFSETS,
                 VTableOffset);
   }
 
   if (!GlobalVarList.empty()) {
-    writeIndexTable(List, sil_index_block::SIL_GLOBALVAR_NAMES, GlobalVarList);
+    writeIndexTable(List, sil_index_block::SIL_GLOBALVAR_NAMES, globalVarBlob);
     Offset.emit(ScratchRecord, sil_index_block::SIL_GLOBALVAR_OFFSETS,
                 GlobalVarOffset);
   }
 
   if (!WitnessTableList.empty()) {
-    writeIndexTable(List, sil_index_block::SIL_WITNESSTABLE_NAMES, WitnessTableList);
+    writeIndexTable(List, sil_index_block::SIL_WITNESSTABLE_NAMES,
+                    witnessTableBlob);
     Offset.emit(ScratchRecord, sil_index_block::SIL_WITNESSTABLE_OFFSETS,
                 WitnessTableOffset);
   }
+
+  if (!FuncTable.empty()) {
+    sil_index_block::FuncSummariesLayout Summaries(Out);
+    Summaries.emit(ScratchRecord, FuncSummaries);
+  }
+
+  if (!TypeLoweringList.empty()) {
+    writeIndexTable(List, sil_index_block::SIL_TYPE_LOWERING_NAMES,
+                    typeLoweringBlob);
+    sil_index_block::TypeLoweringsLayout Lowerings(Out);
+    Lowerings.emit(ScratchRecord, TypeLowerings);
+  }
 }
 
 void SILSerializer::writeSILGlobalVar(const SILGlobalVariable &g) {
@@ -1715,14 +1853,25 @@ void SILSerializer::writeSILBlock(const SILModule *SILMod) {
 
   // Now write function declarations for every function we've
   // emitted a reference to without emitting a function body for.
+  // Public functions with known effects are declared as well, so that
+  // clients can use their effects without seeing their bodies. So are
+  // published specializations, so that clients can call them instead of
+  // specializing again.
   for (const SILFunction &F : *SILMod) {
-    if (!shouldEmitFunctionBody(F) && FuncsToDeclare.count(&F))
+    if (shouldEmitFunctionBody(F))
+      continue;
+    bool IsPublicDefinition = F.getLinkage() == SILLinkage::Public &&
+                              F.isDefinition();
+    bool HasKnownEffects = F.getEffectsKind() < EffectsKind::ReadWrite;
+    if (FuncsToDeclare.count(&F) ||
+        (IsPublicDefinition && (HasKnownEffects || F.isKeepAsPublic())))
       writeSILFunction(F, true);
   }
 }
 
 void SILSerializer::writeSILModule(const SILModule *SILMod) {
   writeSILBlock(SILMod);
+  writeTypeLowerings(SILMod);
   writeIndexTables();
 }
 
@@ -18,9 +18,13 @@
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
+#include <mutex>
 #include <system_error>
 
 using namespace swift;
@@ -35,6 +39,95 @@ SerializedModuleLoader::SerializedModuleLoader(ASTContext &ctx,
   : ModuleLoader(tracker), Ctx(ctx) {}
 SerializedModuleLoader::~SerializedModuleLoader() = default;
 
+namespace {
+/// A reference to a buffer owned by the ModuleBufferCache.
+///
+/// Each ModuleFile holding one of these keeps the contents alive, so the cache
+/// entry can be replaced while existing ASTContexts still use the old data.
+class SharedModuleBuffer : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Underlying;
+
+public:
+  explicit SharedModuleBuffer(std::shared_ptr<llvm::MemoryBuffer> buffer)
+      : Underlying(std::move(buffer)) {
+    init(Underlying->getBufferStart(), Underlying->getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  const char *getBufferIdentifier() const override {
+    return Underlying->getBufferIdentifier();
+  }
+
+  BufferKind getBufferKind() const override {
+    return Underlying->getBufferKind();
+  }
+};
+
+/// Module file contents shared by every ASTContext in the process.
+///
+/// An entry is reused only while the file on disk has the same size and
+/// modification time as when it was read, so rebuilt modules are picked up.
+class ModuleBufferCache {
+  struct Entry {
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+    llvm::sys::TimeValue ModTime;
+    uint64_t Size;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+
+public:
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getFile(StringRef Path) {
+    llvm::sys::fs::file_status Status;
+    if (std::error_code EC = llvm::sys::fs::status(Path, Status))
+      return EC;
+    if (llvm::sys::fs::is_directory(Status))
+      return std::make_error_code(std::errc::is_a_directory);
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Entry &E = Entries[Path];
+    if (!E.Buffer || E.ModTime != Status.getLastModificationTime() ||
+        E.Size != Status.getSize()) {
+      // Read the file rather than mapping it, since it may be overwritten in
+      // place while we still hold on to it.
+      auto BufferOrErr = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                                     /*NullTerminate=*/true,
+                                                     /*IsVolatile=*/true);
+      if (!BufferOrErr) {
+        Entries.erase(Path);
+        return BufferOrErr.getError();
+      }
+      E.Buffer = std::move(BufferOrErr.get());
+      E.ModTime = Status.getLastModificationTime();
+      E.Size = Status.getSize();
+    }
+
+    return std::unique_ptr<llvm::MemoryBuffer>(
+        new SharedModuleBuffer(E.Buffer));
+  }
+};
+} // end anonymous namespace
+
+static bool ProcessWideBufferCacheEnabled = false;
+static llvm::ManagedStatic<ModuleBufferCache> ProcessWideBufferCache;
+
+void SerializedModuleLoader::enableProcessWideBufferCache() {
+  ProcessWideBufferCacheEnabled = true;
+}
+
+static llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+getModuleFileBuffer(StringRef Path) {
+  if (ProcessWideBufferCacheEnabled)
+    return ProcessWideBufferCache->getFile(Path);
+  // Module files are read through the bitstream cursor, which doesn't need a
+  // null terminator. Leaving it off lets large modules be mapped rather than
+  // read, so their pages are shared between concurrent compiler processes and
+  // only the parts of the module that are used are faulted in.
+  return llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
+}
+
 static std::error_code
 openModuleFiles(StringRef DirName, StringRef ModuleFilename,
                 StringRef ModuleDocFilename,
@@ -46,7 +139,7 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    getModuleFileBuffer(StringRef(Scratch.data(), Scratch.size()));
   if (!ModuleOrErr)
     return ModuleOrErr.getError();
 
@@ -55,7 +148,7 @@ openModuleFiles(StringRef DirName, StringRef ModuleFilename,
   Scratch.clear();
   llvm::sys::path::append(Scratch, DirName, ModuleDocFilename);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> ModuleDocOrErr =
-    llvm::MemoryBuffer::getFile(StringRef(Scratch.data(), Scratch.size()));
+    getModuleFileBuffer(StringRef(Scratch.data(), Scratch.size()));
   if (!ModuleDocOrErr &&
       ModuleDocOrErr.getError() != std::errc::no_such_file_or_directory) {
     return ModuleDocOrErr.getError();
@@ -499,6 +592,18 @@ StringRef SerializedASTFile::getFilename() const {
   return File.getModuleFilename();
 }
 
+StringRef SerializedASTFile::getInterfaceHash() const {
+  return File.getInterfaceHash();
+}
+
+void SerializedASTFile::printDeserializationStats(raw_ostream &os) const {
+  File.printDeserializationStats(os);
+}
+
+size_t SerializedASTFile::getBufferMemory() const {
+  return File.getBufferMemory();
+}
+
 const clang::Module *SerializedASTFile::getUnderlyingClangModule() {
   if (auto *ShadowedModule = File.getShadowedModule())
     return ShadowedModule->findUnderlyingClangModule();
@@ -91,6 +91,28 @@ SILFunction *SerializedSILLoader::lookupSILFunction(StringRef Name) {
   return retVal;
 }
 
+Optional<SILFunctionSummary>
+SerializedSILLoader::lookupFunctionSummary(StringRef Name) {
+  Optional<SILFunctionSummary> retVal;
+  for (auto &Des : LoadedSILSections) {
+    if (auto Summary = Des->lookupFunctionSummary(Name)) {
+      if (Summary->HasBody)
+        return Summary;
+      retVal = Summary;
+    }
+  }
+  return retVal;
+}
+
+Optional<Lowering::NominalLoweringKind>
+SerializedSILLoader::lookupNominalLoweringKind(const NominalTypeDecl *D) {
+  const DeclContext *File = D->getModuleScopeContext();
+  for (auto &Des : LoadedSILSections)
+    if (Des->getFile() == File)
+      return Des->lookupNominalLoweringKind(D);
+  return None;
+}
+
 SILVTable *SerializedSILLoader::lookupVTable(Identifier Name) {
   for (auto &Des : LoadedSILSections) {
     if (auto VT = Des->lookupVTable(Name))
@@ -17,6 +17,8 @@
 
 #include "swift/Basic/DemangleWrappers.h"
 #include "swift/SwiftDemangle/SwiftDemangle.h"
+#include <cstdint>
+#include <cstring>
 
 /// \returns true if \p MangledName starts with Swift prefix, "_T".
 static bool isSwiftPrefixed(const char *MangledName) {
@@ -59,6 +61,38 @@ size_t swift_demangle_getSimplifiedDemangledName(const char *MangledName,
                                                  Length, Opts);
 }
 
+size_t swift_demangle_getDemangledNames(const char *const *MangledNames,
+                                        size_t Count, char *OutputBuffer,
+                                        size_t Length, size_t *Offsets) {
+  assert(MangledNames != nullptr && Offsets != nullptr && "null input");
+  assert(OutputBuffer != nullptr || Length == 0);
+
+  swift::Demangle::DemangleOptions DemangleOptions;
+  DemangleOptions.SynthesizeSugarOnTypes = true;
+
+  size_t Needed = 0;
+  for (size_t i = 0; i != Count; ++i) {
+    const char *MangledName = MangledNames[i];
+    Offsets[i] = SIZE_MAX;
+    if (!isSwiftPrefixed(MangledName))
+      continue; // Not a mangled name
+
+    std::string Result = swift::demangle_wrappers::demangleSymbolAsString(
+        MangledName, DemangleOptions);
+    if (Result == MangledName)
+      continue; // Not a mangled name
+
+    // Copy the result including the terminating null character, if it fits.
+    size_t Size = Result.size() + 1;
+    if (Needed + Size <= Length) {
+      memcpy(OutputBuffer + Needed, Result.c_str(), Size);
+      Offsets[i] = Needed;
+    }
+    Needed += Size;
+  }
+  return Needed;
+}
+
 size_t fnd_get_demangled_name(const char *MangledName, char *OutputBuffer,
                               size_t Length) {
   return swift_demangle_getDemangledName(MangledName, OutputBuffer, Length);
@@ -0,0 +1,26 @@
+//===--- Benchmark.cpp ----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Heap.h"
+#include <chrono>
+#include <cstdint>
+
+extern "C" uint64_t swift_stdlib_getMonotonicNanoseconds() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(
+      steady_clock::now().time_since_epoch()).count();
+}
+
+extern "C" intptr_t swift_stdlib_getAllocationCounts(size_t *allocations,
+                                                     size_t *bytes) {
+  return swift::swift_slowAllocGetStatistics(allocations, bytes);
+}
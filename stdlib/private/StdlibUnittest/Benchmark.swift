@@ -0,0 +1,189 @@
+//===--- Benchmark.swift --------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+@_silgen_name("swift_stdlib_getMonotonicNanoseconds")
+func _stdlib_getMonotonicNanoseconds() -> UInt64
+
+@_silgen_name("swift_stdlib_getAllocationCounts")
+func _stdlib_getAllocationCounts(
+  allocations: UnsafeMutablePointer<UInt>, _ bytes: UnsafeMutablePointer<UInt>
+) -> Int
+
+/// Consumes `x` in a way the optimizer can't see through, so that the code
+/// computing it is not removed as dead.
+@inline(never)
+public func blackHole<T>(x: T) {
+  _blackHole(x)
+}
+
+/// Returns `x` in a way the optimizer can't see through, so that the inputs
+/// of a benchmark are not constant-folded into its body.
+@inline(never)
+public func identity<T>(x: T) -> T {
+  return _opaqueIdentity(x)
+}
+
+/// The result of a benchmark. Times are in microseconds per iteration.
+public struct BenchmarkResult : CustomStringConvertible {
+  public let name: String
+
+  /// The number of iterations of each sample.
+  public let iterations: Int
+
+  /// The number of recorded samples, including outliers.
+  public let samples: Int
+
+  /// The number of samples which were discarded because they were further
+  /// than three scaled median absolute deviations from the median.
+  public let outliers: Int
+
+  public let min: Double
+  public let median: Double
+
+  /// The median absolute deviation of the samples which are not outliers.
+  public let mad: Double
+
+  /// The number of heap allocations per iteration, or nil if the runtime does
+  /// not count allocations.  Counting is enabled by running the process with
+  /// SWIFT_RUNTIME_ALLOCATION_STATS=1.
+  public let allocations: Double?
+
+  /// The number of allocated bytes per iteration, or nil if the runtime does
+  /// not count allocations.
+  public let allocatedBytes: Double?
+
+  /// A JSON object with the same keys that scripts/Benchmark_Driver writes
+  /// for each benchmark.
+  public var description: String {
+    var escapedName = ""
+    for c in name.characters {
+      if c == "\"" || c == "\\" {
+        escapedName.append(Character("\\"))
+      }
+      escapedName.append(c)
+    }
+    var result = "{\"name\": \"\(escapedName)\", "
+    result += "\"iterations\": \(iterations), "
+    result += "\"samples\": \(samples), \"outliers\": \(outliers), "
+    result += "\"min\": \(min), \"median\": \(median), \"mad\": \(mad)"
+    if let allocations = allocations, allocatedBytes = allocatedBytes {
+      result += ", \"allocations\": \(allocations)"
+      result += ", \"allocated_bytes\": \(allocatedBytes)"
+    }
+    return result + "}"
+  }
+}
+
+func _median(sortedValues: [Double]) -> Double {
+  let mid = sortedValues.count / 2
+  if sortedValues.count % 2 != 0 {
+    return sortedValues[mid]
+  }
+  return (sortedValues[mid - 1] + sortedValues[mid]) / 2
+}
+
+func _medianAbsoluteDeviation(sortedValues: [Double]) -> Double {
+  let m = _median(sortedValues)
+  return _median(sortedValues.map { abs($0 - m) }.sort())
+}
+
+/// Runs `body` `iterations` times and returns the elapsed time in nanoseconds.
+func _runBenchmarkSample(iterations: Int, _ body: () -> Void) -> UInt64 {
+  let start = _stdlib_getMonotonicNanoseconds()
+  for _ in 0..<iterations {
+    body()
+  }
+  return _stdlib_getMonotonicNanoseconds() - start
+}
+
+/// Returns the number of iterations of `body` which take at least
+/// `minimumNanoseconds`.
+func _calibrateBenchmark(
+  minimumNanoseconds: UInt64, _ body: () -> Void
+) -> Int {
+  let maxIterations = 1 << 30
+  var iterations = 1
+  while true {
+    let elapsed = _runBenchmarkSample(iterations, body)
+    if elapsed >= minimumNanoseconds || iterations >= maxIterations {
+      return iterations
+    }
+    if elapsed == 0 {
+      iterations *= 10
+    } else {
+      let scale = Double(minimumNanoseconds) / Double(elapsed)
+      iterations = max(iterations * 2, Int(Double(iterations) * scale * 1.1))
+    }
+    iterations = Swift.min(iterations, maxIterations)
+  }
+}
+
+/// Measures how long one execution of `body` takes.
+///
+/// The number of iterations per sample is scaled until a sample takes at
+/// least `minimumSampleTime` seconds.  After `warmupSamples` unrecorded
+/// samples, `samples` samples are recorded.  The result is printed on a line
+/// starting with "[ BENCH    ] ", followed by the JSON form of the result.
+///
+/// Use `blackHole` on the results computed by `body` and `identity` on its
+/// inputs, so that the optimizer neither removes nor precomputes the work.
+public func benchmark(
+  name: String, samples: Int = 20, warmupSamples: Int = 2,
+  minimumSampleTime: Double = 0.01, _ body: () -> Void
+) -> BenchmarkResult {
+  precondition(samples > 0, "a benchmark needs at least one sample")
+
+  let iterations =
+    _calibrateBenchmark(UInt64(minimumSampleTime * 1e9), body)
+  for _ in 0..<warmupSamples {
+    _runBenchmarkSample(iterations, body)
+  }
+
+  var times: [Double] = []
+  times.reserveCapacity(samples)
+
+  var allocationsBefore: UInt = 0
+  var bytesBefore: UInt = 0
+  let countsAllocations =
+    _stdlib_getAllocationCounts(&allocationsBefore, &bytesBefore) != 0
+
+  for _ in 0..<samples {
+    let elapsed = _runBenchmarkSample(iterations, body)
+    times.append(Double(elapsed) / 1000 / Double(iterations))
+  }
+
+  var allocations: Double? = nil
+  var allocatedBytes: Double? = nil
+  if countsAllocations {
+    var allocationsAfter: UInt = 0
+    var bytesAfter: UInt = 0
+    _stdlib_getAllocationCounts(&allocationsAfter, &bytesAfter)
+    let totalIterations = Double(iterations * samples)
+    allocations = Double(allocationsAfter - allocationsBefore) / totalIterations
+    allocatedBytes = Double(bytesAfter - bytesBefore) / totalIterations
+  }
+
+  // Discard the samples which are disturbed by other activity on the machine,
+  // the same way scripts/benchmark_stats.py does.
+  let sorted = times.sort()
+  let m = _median(sorted)
+  let limit = 3 * 1.4826 * _medianAbsoluteDeviation(sorted)
+  let kept = limit == 0 ? sorted : sorted.filter { abs($0 - m) <= limit }
+
+  let result = BenchmarkResult(
+    name: name, iterations: iterations, samples: samples,
+    outliers: samples - kept.count, min: kept[0], median: _median(kept),
+    mad: _medianAbsoluteDeviation(kept), allocations: allocations,
+    allocatedBytes: allocatedBytes)
+  print("[ BENCH    ] \(result)")
+  return result
+}
@@ -37,6 +37,11 @@ struct _SwiftEmptyArrayStorage {
 
 extern struct _SwiftEmptyArrayStorage _swiftEmptyArrayStorage;
 
+/// The code units of every string consisting of a single ASCII character.
+/// The string for the character `c` starts at offset `2 * c` and is
+/// followed by a null terminator.
+extern __swift_uint8_t _swiftSingleASCIIStringStorage[256];
+
 extern __swift_uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride;
 
 #ifdef __cplusplus
@@ -100,6 +100,13 @@ class StrongRefCount {
     __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
   }
 
+  // Increment the reference count by n, without an atomic read-modify-write.
+  // Only valid if no other thread can reach the object.
+  void incrementNonAtomic(uint32_t n = 1) {
+    uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    __atomic_store_n(&refCount, val + (n << RC_FLAGS_COUNT), __ATOMIC_RELAXED);
+  }
+
   // Try to simultaneously set the pinned flag and increment the
   // reference count.  If the flag is already set, don't increment the
   // reference count.
@@ -140,6 +147,18 @@ class StrongRefCount {
     }
   }
 
+  // Increment the reference count by n, unless the object is deallocating.
+  bool tryIncrementN(uint32_t n) {
+    uint32_t delta = n << RC_FLAGS_COUNT;
+    uint32_t oldval = __atomic_fetch_add(&refCount, delta, __ATOMIC_RELAXED);
+    if (oldval & RC_DEALLOCATING_FLAG) {
+      __atomic_fetch_sub(&refCount, delta, __ATOMIC_RELAXED);
+      return false;
+    } else {
+      return true;
+    }
+  }
+
   // Simultaneously clear the pinned flag and decrement the reference
   // count.
   //
@@ -158,6 +177,30 @@ class StrongRefCount {
     return doDecrementShouldDeallocateN<false>(n);
   }
 
+  // Decrement the reference count by n, without an atomic read-modify-write.
+  // Only valid if no other thread can reach the object.
+  // Return true if the caller should now deallocate the object.
+  bool decrementShouldDeallocateNNonAtomic(uint32_t n = 1) {
+    uint32_t delta = n << RC_FLAGS_COUNT;
+    uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+    assert((oldval & RC_COUNT_MASK) >= delta &&
+           "releasing reference with a refcount of zero");
+    uint32_t newval = oldval - delta;
+
+    // As in doDecrementShouldDeallocate, keep going only if the count
+    // dropped to zero and the object isn't already deallocating.
+    if ((newval & (RC_COUNT_MASK | RC_PINNED_FLAG | RC_DEALLOCATING_FLAG))
+          != 0) {
+      __atomic_store_n(&refCount, newval, __ATOMIC_RELAXED);
+      return false;
+    }
+
+    // Nobody else can see the object, so setting the deallocating flag
+    // doesn't need to race with anything.
+    __atomic_store_n(&refCount, RC_DEALLOCATING_FLAG, __ATOMIC_RELAXED);
+    return true;
+  }
+
   // Return the reference count.
   // During deallocation the reference count is undefined.
   uint32_t getCount() const {
@@ -274,10 +317,10 @@ class WeakRefCount {
   uint32_t refCount;
 
   enum : uint32_t {
-    // There isn't really a flag here.
-    // Making weak RC_ONE == strong RC_ONE saves an
-    // instruction in allocation on arm64.
-    RC_UNUSED_FLAG = 1,
+    // Set once a weak reference side table entry has been created for the
+    // object. Having a flag here also makes weak RC_ONE == strong RC_ONE,
+    // which saves an instruction in allocation on arm64.
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -354,6 +397,16 @@ class WeakRefCount {
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
+
+  // Record that a weak reference side table entry exists for the object.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
+
+  // Return true if a weak reference side table entry exists for the object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
 };
 
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
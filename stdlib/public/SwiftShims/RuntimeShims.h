@@ -61,6 +61,14 @@ int _swift_stdlib_putc_stderr(int C);
 
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// Call \p body with disjoint subranges of [0, \p iterations), of at most
+/// \p grainSize iterations each, on the runtime's worker threads.  Returns
+/// once all iterations have been executed.
+void _swift_stdlib_parallelFor(
+  __swift_size_t iterations, __swift_size_t grainSize,
+  void (*body)(void *context, __swift_size_t begin, __swift_size_t end),
+  void *context);
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
@@ -17,6 +17,12 @@
 #ifndef SWIFT_STDLIB_SHIMS_UNICODESHIMS_H_
 #define SWIFT_STDLIB_SHIMS_UNICODESHIMS_H_
 
+#include "SwiftStdint.h"
+
+#ifdef __cplusplus
+namespace swift { extern "C" {
+#endif
+
 extern const __swift_uint8_t *_swift_stdlib_GraphemeClusterBreakPropertyTrie;
 
 struct _swift_stdlib_GraphemeClusterBreakPropertyTrieMetadataTy {
@@ -59,6 +65,26 @@ __swift_int32_t _swift_stdlib_unicode_compare_utf8_utf8(
   const char *Left, __swift_int32_t LeftLength,
   const char *Right, __swift_int32_t RightLength);
 
+/// A string passed to _swift_stdlib_unicode_compare_many, in the storage of
+/// a _StringCore.
+struct _swift_stdlib_CollationString {
+  /// The first code unit.
+  const void *Start;
+  /// The number of code units.
+  __swift_int32_t Length;
+  /// Nonzero if the code units are ASCII bytes, zero if they are UTF-16.
+  __swift_int32_t IsASCII;
+};
+
+/// Compares \p String to each of the \p Count strings at \p Candidates with
+/// the Unicode Collation Algorithm, and stores the results at \p Results as
+/// _swift_stdlib_unicode_compare_utf16_utf16 would return them. The collation
+/// key of \p String is only computed once.
+void _swift_stdlib_unicode_compare_many(
+  const struct _swift_stdlib_CollationString *String,
+  const struct _swift_stdlib_CollationString *Candidates,
+  __swift_int32_t Count, __swift_int32_t *Results);
+
 __swift_intptr_t _swift_stdlib_unicode_hash(
   const __swift_uint16_t *Str, __swift_int32_t Length);
 
@@ -73,5 +99,8 @@ __swift_int32_t _swift_stdlib_unicode_strToLower(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
   const __swift_uint16_t *Source, __swift_int32_t SourceLength);
 
+#ifdef __cplusplus
+}} // extern "C", namespace swift
+#endif
 
 #endif
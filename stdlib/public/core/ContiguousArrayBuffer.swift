@@ -151,6 +151,23 @@ final class _ContiguousArrayStorage<Element> : _ContiguousArrayStorage1 {
     _fixLifetime(__manager)
     return result
   }
+
+  /// Bridge the element at `index` and return the result.
+  ///
+  /// - Precondition: `Element` is bridged non-verbatim, and `index` is a
+  ///   valid subscript.
+  @warn_unused_result
+  override internal func _getNonVerbatimBridgedElement(
+    index: Int
+  ) -> AnyObject {
+    _sanityCheck(
+      !_isBridgedVerbatimToObjectiveC(Element.self),
+      "Verbatim bridging should be handled separately")
+    let result = _bridgeToObjectiveCUnconditional(
+      __manager._elementPointer[index])
+    _fixLifetime(__manager)
+    return result
+  }
 #endif
 
   /// Return true if the `proposedElementType` is `Element` or a subclass of
@@ -132,6 +132,16 @@ func _mixInt(value: Int) -> Int {
 #endif
 }
 
+/// Returns a hash value mixing `value` into `seed`, for combining the hash
+/// values of the members of an aggregate. The result depends on the order in
+/// which the values are combined.
+@_transparent
+@warn_unused_result
+public // @testable
+func _combineHashValues(seed: Int, _ value: Int) -> Int {
+  return _mixInt(seed ^ _mixInt(value))
+}
+
 /// Given a hash value, returns an integer value within the given range that
 /// corresponds to a hash value.
 ///
@@ -0,0 +1,252 @@
+//===--- Parallel.swift - Parallel collection algorithms ------*- swift -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Algorithms that split their work across the runtime's pool of worker
+// threads.  The closures passed to them are called concurrently, and must be
+// safe to call from several threads at once.
+//
+// Each algorithm takes a `grainSize`: the number of elements a worker
+// processes before it looks for more work.  Larger grains lower the
+// scheduling overhead, smaller grains balance uneven work better.  A
+// `grainSize` of zero picks one based on the number of processors.
+//
+//===----------------------------------------------------------------------===//
+
+import SwiftShims
+
+/// Return the grain size to use for `count` iterations when `grainSize` was
+/// requested.
+@warn_unused_result
+internal func _parallelGrainSize(count: Int, _ grainSize: Int) -> Int {
+  _precondition(grainSize >= 0, "grain size can't be negative")
+  if grainSize > 0 {
+    return grainSize
+  }
+  // Aim for a few chunks per processor, so that work can be rebalanced.
+  let chunks = 4 * max(1, _swift_stdlib_getHardwareConcurrency())
+  return max(1, count / chunks)
+}
+
+internal struct _ParallelForContext {
+  let body: (Int, Int) -> Void
+}
+
+/// Call `body(begin, end)` on disjoint subranges covering `0..<count`, of
+/// at most `grainSize` iterations each, concurrently.
+internal func _parallelFor(
+  count: Int, grainSize: Int, @noescape _ body: (Int, Int) -> Void
+) {
+  if count == 0 {
+    return
+  }
+  typealias EscapingBody = (Int, Int) -> Void
+  // `_swift_stdlib_parallelFor` returns only after all calls to `body`.
+  var context = _ParallelForContext(
+    body: unsafeBitCast(body, EscapingBody.self))
+  withUnsafeMutablePointer(&context) {
+    _swift_stdlib_parallelFor(count, grainSize, {
+      (context, begin, end) -> Void in
+      UnsafeMutablePointer<_ParallelForContext>(context).memory.body(
+        begin, end)
+    }, $0)
+  }
+}
+
+extension CollectionType where Index : RandomAccessIndexType {
+  /// Call `body` on each element in `self`, concurrently and in no
+  /// particular order.
+  public func concurrentForEach(
+    grainSize grainSize: Int = 0,
+    @noescape _ body: (Generator.Element) -> Void
+  ) {
+    let count: Int = numericCast(self.count)
+    let start = startIndex
+    _parallelFor(count, grainSize: _parallelGrainSize(count, grainSize)) {
+      (begin, end) in
+      var i = start.advancedBy(numericCast(begin))
+      for _ in begin..<end {
+        body(self[i])
+        i = i.successor()
+      }
+    }
+  }
+
+  /// Return an `Array` containing the results of mapping `transform`
+  /// over `self`, evaluating `transform` on the elements concurrently.
+  @warn_unused_result
+  public func parallelMap<T>(
+    grainSize grainSize: Int = 0,
+    @noescape _ transform: (Generator.Element) -> T
+  ) -> [T] {
+    let count: Int = numericCast(self.count)
+    let (result, base) = Array<T>._allocateUninitialized(count)
+    let start = startIndex
+    _parallelFor(count, grainSize: _parallelGrainSize(count, grainSize)) {
+      (begin, end) in
+      var i = start.advancedBy(numericCast(begin))
+      for offset in begin..<end {
+        (base + offset).initialize(transform(self[i]))
+        i = i.successor()
+      }
+    }
+    return result
+  }
+
+  /// Return the result of folding the elements of `self` into `identity`
+  /// with `combine`.
+  ///
+  /// Chunks of `self` are folded concurrently, each starting from
+  /// `identity`, and the results of adjacent chunks are then folded in
+  /// order with `merge`. `merge` must be associative, and `identity` must
+  /// be its identity, for the result to match a sequential `reduce`.
+  @warn_unused_result
+  public func parallelReduce<T>(
+    identity: T,
+    grainSize grainSize: Int = 0,
+    @noescape combine: (T, Generator.Element) -> T,
+    @noescape merge: (T, T) -> T
+  ) -> T {
+    let count: Int = numericCast(self.count)
+    let grain = _parallelGrainSize(count, grainSize)
+    let chunkCount = count / grain + (count % grain == 0 ? 0 : 1)
+    let (partials, base) = Array<T>._allocateUninitialized(chunkCount)
+    let start = startIndex
+    _parallelFor(chunkCount, grainSize: 1) {
+      (begin, end) in
+      for chunk in begin..<end {
+        let chunkStart = chunk * grain
+        let chunkEnd = min(chunkStart + grain, count)
+        var i = start.advancedBy(numericCast(chunkStart))
+        var partial = identity
+        for _ in chunkStart..<chunkEnd {
+          partial = combine(partial, self[i])
+          i = i.successor()
+        }
+        (base + chunk).initialize(partial)
+      }
+    }
+    var result = identity
+    for partial in partials {
+      result = merge(result, partial)
+    }
+    return result
+  }
+}
+
+extension MutableCollectionType
+  where
+  Self.Index : RandomAccessIndexType,
+  Self.Generator.Element : Comparable {
+
+  /// Sort `self` in-place, sorting chunks of it concurrently.
+  ///
+  /// The sorting algorithm is not stable (can change the relative order of
+  /// elements that compare equal).
+  ///
+  /// Collections that don't provide contiguous storage are sorted
+  /// sequentially.
+  public mutating func parallelSortInPlace(grainSize grainSize: Int = 0) {
+    let didSortUnsafeBuffer: Void? =
+      _withUnsafeMutableBufferPointerIfSupported {
+      (baseAddress, count) -> Void in
+      let bufferPointer =
+        UnsafeMutableBufferPointer(start: baseAddress, count: count)
+      _parallelSort(bufferPointer, _parallelGrainSize(count, grainSize))
+      return ()
+    }
+    if didSortUnsafeBuffer == nil {
+      sortInPlace()
+    }
+  }
+}
+
+extension MutableCollectionType where Self.Index : RandomAccessIndexType {
+  /// Sort `self` in-place according to `isOrderedBefore`, sorting chunks
+  /// of it concurrently.
+  ///
+  /// The sorting algorithm is not stable (can change the relative order of
+  /// elements for which `isOrderedBefore` does not establish an order).
+  ///
+  /// Collections that don't provide contiguous storage are sorted
+  /// sequentially.
+  public mutating func parallelSortInPlace(
+    grainSize grainSize: Int = 0,
+    @noescape isOrderedBefore: (Generator.Element, Generator.Element) -> Bool
+  ) {
+    typealias EscapingBinaryPredicate =
+      (Generator.Element, Generator.Element) -> Bool
+    let escapableIsOrderedBefore =
+      unsafeBitCast(isOrderedBefore, EscapingBinaryPredicate.self)
+
+    let didSortUnsafeBuffer: Void? =
+      _withUnsafeMutableBufferPointerIfSupported {
+      (baseAddress, count) -> Void in
+      let bufferPointer =
+        UnsafeMutableBufferPointer(start: baseAddress, count: count)
+      _parallelSort(
+        bufferPointer, _parallelGrainSize(count, grainSize),
+        escapableIsOrderedBefore)
+      return ()
+    }
+    if didSortUnsafeBuffer == nil {
+      sortInPlace(escapableIsOrderedBefore)
+    }
+  }
+}
+
+/// Sort `elements` by sorting runs of `grainSize` elements concurrently,
+/// then merging adjacent runs of doubling width, concurrently.
+///
+/// Concurrent writes are safe because each task only writes to its own,
+/// disjoint part of the buffer.
+internal func _parallelSort<Element : Comparable>(
+  elements: UnsafeMutableBufferPointer<Element>, _ grainSize: Int
+) {
+  _parallelSort(elements, grainSize) { $0 < $1 }
+}
+
+internal func _parallelSort<Element>(
+  elements: UnsafeMutableBufferPointer<Element>, _ grainSize: Int,
+  _ isOrderedBefore: (Element, Element) -> Bool
+) {
+  let count = elements.count
+  let runCount = count / grainSize + (count % grainSize == 0 ? 0 : 1)
+  _parallelFor(runCount, grainSize: 1) {
+    (begin, end) in
+    var buffer = elements
+    for run in begin..<end {
+      let lo = run * grainSize
+      _introSort(&buffer, lo..<min(lo + grainSize, count), isOrderedBefore)
+    }
+  }
+
+  var width = grainSize
+  while width < count {
+    // The number of runs that have a run after them to be merged with.
+    let pairCount = (count + width - 1) / (2 * width)
+    _parallelFor(pairCount, grainSize: 1) {
+      (begin, end) in
+      var buffer = elements
+      var scratch: [Element] = []
+      var comp = isOrderedBefore
+      for pair in begin..<end {
+        let lo = pair * 2 * width
+        let mid = lo + width
+        let hi = min(mid + width, count)
+        if isOrderedBefore(buffer[mid], buffer[mid - 1]) {
+          _merge(&buffer, lo, mid, hi, &scratch, &comp)
+        }
+      }
+    }
+    width = width > count / 2 ? count : width * 2
+  }
+}
@@ -144,6 +144,53 @@ func _getSummary<T>(out: UnsafeMutablePointer<String>, x: T) {
 @_silgen_name("swift_reflectAny")
 public func _reflect<T>(x: T) -> _MirrorType
 
+@warn_unused_result
+@_silgen_name("swift_reflectionFieldCount")
+internal func _reflectionFieldCount(
+  value: UnsafePointer<Void>, _ type: Any.Type) -> Int
+
+@warn_unused_result
+@_silgen_name("swift_reflectionField")
+internal func _reflectionField(
+  i: Int, _ value: UnsafePointer<Void>, _ type: Any.Type,
+  _ name: UnsafeMutablePointer<UnsafePointer<CChar>>,
+  _ fieldType: UnsafeMutablePointer<Any.Type>
+) -> UnsafePointer<Void>
+
+/// Call `body` with the name, type and address of each stored property of
+/// `instance`, without boxing the properties or copying their names.
+///
+/// The stored properties of structs and of native Swift class instances are
+/// visited; for a class instance, the properties declared by its superclasses
+/// are not.  The names live as long as the types; the addresses are only
+/// valid during the call to `body`.
+///
+/// - Returns: `false`, without calling `body`, if the stored properties of
+///   `instance` can't be enumerated.
+public func _forEachStoredProperty<T>(
+  instance: T,
+  @noescape _ body: (
+    name: UnsafePointer<CChar>, type: Any.Type, address: UnsafePointer<Void>
+  ) throws -> Void
+) rethrows -> Bool {
+  var instance = instance
+  return try withUnsafePointer(&instance) {
+    (pointer) -> Bool in
+    let value = UnsafePointer<Void>(pointer)
+    let count = _reflectionFieldCount(value, T.self)
+    if count < 0 {
+      return false
+    }
+    var name = UnsafePointer<CChar>()
+    var fieldType: Any.Type = Int.self
+    for i in 0..<count {
+      let address = _reflectionField(i, value, T.self, &name, &fieldType)
+      try body(name: name, type: fieldType, address: address)
+    }
+    return true
+  }
+}
+
 /// Dump an object's contents using its mirror to the specified output stream.
 public func dump<T, TargetStream : OutputStreamType>(
     x: T, inout _ targetStream: TargetStream,
@@ -322,10 +322,24 @@ public func ==(lhs: String, rhs: String) -> Bool {
     if lhs._core.count != rhs._core.count {
       return false
     }
+    if lhs._core._baseAddress == rhs._core._baseAddress {
+      return true
+    }
     return _swift_stdlib_memcmp(
       lhs._core.startASCII, rhs._core.startASCII,
       rhs._core.count) == 0
   }
+  if lhs._core.elementWidth == rhs._core.elementWidth &&
+     lhs._core.count == rhs._core.count &&
+     lhs._core.hasContiguousStorage && rhs._core.hasContiguousStorage &&
+     _swift_stdlib_memcmp(
+       UnsafePointer(lhs._core._baseAddress),
+       UnsafePointer(rhs._core._baseAddress),
+       lhs._core.count << lhs._core.elementShift) == 0 {
+    // Identical code units are always equal; only strings that differ need
+    // Unicode normalization.
+    return true
+  }
   return lhs._compareString(rhs) == 0
 }
 
@@ -400,6 +414,42 @@ extension String {
 #endif
   }
 
+#if !_runtime(_ObjC)
+  /// The storage of `self`, as the runtime's collation functions take it.
+  internal var _collationString: _swift_stdlib_CollationString {
+    return _swift_stdlib_CollationString(
+      Start: UnsafePointer(_core._baseAddress),
+      Length: Int32(_core.count),
+      IsASCII: _core.isASCII ? 1 : 0)
+  }
+#endif
+
+  /// Compares `self` to each of `candidates` with the Unicode Collation
+  /// Algorithm, and returns the results in the order of `candidates`.
+  ///
+  /// This is cheaper than comparing `self` to each candidate in turn, because
+  /// `self` is only normalized once.
+  @warn_unused_result
+  @inline(never)
+  @_semantics("stdlib_binary_only") // Hide the CF/ICU dependency
+  public  // @testable
+  func _compareDeterministicUnicodeCollation(
+    candidates candidates: [String]
+  ) -> [Int] {
+#if _runtime(_ObjC)
+    return candidates.map { self._compareDeterministicUnicodeCollation($0) }
+#else
+    let strings = candidates.map { $0._collationString }
+    var results = [Int32](count: candidates.count, repeatedValue: 0)
+    withExtendedLifetime((self, candidates)) {
+      var string = self._collationString
+      _swift_stdlib_unicode_compare_many(
+        &string, strings, Int32(strings.count), &results)
+    }
+    return results.map { Int($0) }
+#endif
+  }
+
   @warn_unused_result
   public  // @testable
   func _compareString(rhs: String) -> Int {
@@ -533,6 +583,27 @@ extension String {
         String._fromWellFormedCodeUnitSequence(UTF8.self,
             input: UnsafeBufferPointer(start: start, count: utf8Count)))
   }
+
+  /// Constructs a `String` in `resultStorage` referring to the given ASCII,
+  /// which must never be deallocated, without copying it.
+  ///
+  /// Low-level construction interface used by introspection
+  /// implementation in the runtime library.
+  @_silgen_name("swift_stringFromImmortalASCIIInRawMemory")
+  public // COMPILER_INTRINSIC
+  static func _fromImmortalASCIIInRawMemory(
+    resultStorage: UnsafeMutablePointer<String>,
+    start: UnsafeMutablePointer<UTF8.CodeUnit>, utf8Count: Int
+  ) {
+    resultStorage.initialize(
+      String(
+        _StringCore(
+          baseAddress: COpaquePointer(start),
+          count: utf8Count,
+          elementShift: 0,
+          hasCocoaBuffer: false,
+          owner: nil)))
+  }
 }
 
 extension String {
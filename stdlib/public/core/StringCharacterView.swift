@@ -123,6 +123,24 @@ extension String.CharacterView : CollectionType {
           _utf16Index + _lengthUTF16, _base._core)
     }
 
+    /// Returns true if there is always a grapheme cluster boundary between
+    /// the UTF-16 code units `first` and `second`, where `second` is the
+    /// first code unit of a scalar, without consulting the grapheme cluster
+    /// break property trie.
+    ///
+    /// An ASCII scalar other than LF never extends the grapheme cluster
+    /// before it, since none of them is Extend, SpacingMark, Hangul or a
+    /// regional indicator, and the Unicode 8.0 data has no Prepend scalars.
+    /// LF only extends a preceding CR.
+    @warn_unused_result
+    internal static func _isBoundaryBeforeASCII(
+      first: UTF16.CodeUnit, _ second: UTF16.CodeUnit
+    ) -> Bool {
+      let CR: UTF16.CodeUnit = 0x0d
+      let LF: UTF16.CodeUnit = 0x0a
+      return second < 0x80 && (second != LF || first != CR)
+    }
+
     /// Returns the length of the first extended grapheme cluster in UTF-16
     /// code units.
     @warn_unused_result
@@ -135,6 +153,16 @@ extension String.CharacterView : CollectionType {
         return 0
       }
 
+      // Fast path: a single code unit followed by the end or by ASCII is a
+      // grapheme cluster of its own, which covers most of ASCII text and
+      // text that mixes ASCII with other scripts.
+      let core = start._core
+      let position = start._position
+      if position + 1 == end._position ||
+         _isBoundaryBeforeASCII(core[position], core[position + 1]) {
+        return 1
+      }
+
       let startIndexUTF16 = start._position
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
@@ -174,6 +202,16 @@ extension String.CharacterView : CollectionType {
         return 0
       }
 
+      // Fast path: an ASCII code unit at the start, or preceded by a
+      // boundary, is a grapheme cluster of its own.
+      let core = end._core
+      let last = end._position - 1
+      if core[last] < 0x80 &&
+         (last == start._position ||
+          _isBoundaryBeforeASCII(core[last - 1], core[last])) {
+        return 1
+      }
+
       let endIndexUTF16 = end._position
       let unicodeScalars = UnicodeScalarView(start._core)
       let graphemeClusterBreakProperty =
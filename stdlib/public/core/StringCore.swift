@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+import SwiftShims
+
 /// The core implementation of a highly-optimizable String that
 /// can store both ASCII and UTF-16, and can wrap native Swift
 /// _StringBuffer or NSString instances.
@@ -178,6 +180,22 @@ public struct _StringCore {
     _invariantCheck()
   }
 
+  /// Create the implementation of a string consisting of the single ASCII
+  /// code unit `codeUnit`.
+  ///
+  /// The code unit is stored in statically allocated storage, so the string
+  /// needs neither an allocation nor reference counting.
+  init(_singleASCII codeUnit: UTF8.CodeUnit) {
+    _sanityCheck(codeUnit <= 0x7f)
+    self._baseAddress = COpaquePointer(
+      UnsafeMutablePointer<UTF8.CodeUnit>(
+        Builtin.addressof(&_swiftSingleASCIIStringStorage))
+      + (Int(codeUnit) << 1))
+    self._countAndFlags = 1
+    self._owner = .None
+    _invariantCheck()
+  }
+
   //===--------------------------------------------------------------------===//
   // Properties
 
@@ -117,6 +117,10 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
 /// An `NSArray` whose contiguous storage is created and filled, upon
 /// first access, by bridging the elements of a Swift `Array`.
 ///
+/// `objectAtIndex` bridges only the element it returns, so that Cocoa code
+/// which looks at a few elements of a large array doesn't pay for bridging
+/// all of them.
+///
 /// Ideally instances of this class would be allocated in-line in the
 /// buffers used for Array storage.
 @objc internal final class _SwiftDeferredNSArray
@@ -128,6 +132,13 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
   // Do not access this property directly.
   internal var _heapBufferBridged_DoNotUse: AnyObject? = nil
 
+  // The elements bridged one at a time by objectAtIndex, before all of the
+  // elements are bridged. This stored property should directly follow
+  // _heapBufferBridged_DoNotUse.  We perform atomic operations on it.
+  //
+  // Do not access this property directly.
+  internal var _elementCache_DoNotUse: AnyObject? = nil
+
   // When this class is allocated inline, this property can become a
   // computed one.
   internal let _nativeStorage: _ContiguousArrayStorageBase
@@ -136,7 +147,12 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
     return UnsafeMutablePointer(_getUnsafePointerToStoredProperties(self))
   }
 
+  internal var _elementCachePtr: UnsafeMutablePointer<AnyObject?> {
+    return _heapBufferBridgedPtr + 1
+  }
+
   internal typealias HeapBufferStorage = _HeapBufferStorage<Int, AnyObject>
+  internal typealias ElementCacheStorage = _HeapBufferStorage<Int, AnyObject?>
   
   internal var _heapBufferBridged: HeapBufferStorage? {
     if let ref =
@@ -146,6 +162,13 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
     return nil
   }
 
+  internal var _elementCache: ElementCacheStorage? {
+    if let ref = _stdlib_atomicLoadARCRef(object: _elementCachePtr) {
+      return unsafeBitCast(ref, ElementCacheStorage.self)
+    }
+    return nil
+  }
+
   internal init(_nativeStorage: _ContiguousArrayStorageBase) {
     self._nativeStorage = _nativeStorage
   }
@@ -158,8 +181,65 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
     }
   }
 
+  internal func _destroyElementCache(cache: ElementCacheStorage?) {
+    if let cacheStorage = cache {
+      let heapBuffer = _HeapBuffer(cacheStorage)
+      let count = heapBuffer.value
+      heapBuffer.baseAddress.destroy(count)
+    }
+  }
+
   deinit {
     _destroyBridgedStorage(_heapBufferBridged)
+    _destroyElementCache(_elementCache)
+  }
+
+  /// Returns the slots for the elements bridged one at a time, creating
+  /// them if necessary.
+  ///
+  /// - Precondition: The elements are bridged non-verbatim.
+  internal func _getElementCache(count: Int) -> _HeapBuffer<Int, AnyObject?> {
+    repeat {
+      if let cacheStorage = _elementCache {
+        return _HeapBuffer(cacheStorage)
+      }
+
+      let cache = _HeapBuffer<Int, AnyObject?>(
+        ElementCacheStorage.self, count, count)
+      for i in 0..<count {
+        (cache.baseAddress + i).initialize(nil)
+      }
+
+      // Atomically store a reference to the slots in self.
+      if !_stdlib_atomicInitializeARCRef(
+        object: _elementCachePtr, desired: cache.storage!) {
+
+        // Another thread won the race.  Throw out our slots
+        let storage: ElementCacheStorage = unsafeDowncast(cache.storage!)
+        _destroyElementCache(storage)
+      }
+    }
+    while true
+  }
+
+  /// Bridge all elements and return a new buffer that owns them, reusing
+  /// the elements which were already bridged one at a time.
+  ///
+  /// - Precondition: The elements are bridged non-verbatim.
+  internal func _createBridgedHeapBuffer() -> _HeapBuffer<Int, AnyObject> {
+    guard let cacheStorage = _elementCache else {
+      return _nativeStorage._getNonVerbatimBridgedHeapBuffer()
+    }
+    let cache = _HeapBuffer(cacheStorage)
+    let count = cache.value
+    let result = _HeapBuffer<Int, AnyObject>(
+      HeapBufferStorage.self, count, count)
+    for i in 0..<count {
+      let object = _stdlib_atomicLoadARCRef(object: cache.baseAddress + i)
+        ?? _nativeStorage._getNonVerbatimBridgedElement(i)
+      (result.baseAddress + i).initialize(object)
+    }
+    return result
   }
 
   internal override func withUnsafeBufferOfObjects<R>(
@@ -184,7 +264,7 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
       }
       else {
         // Create buffer of bridged objects.
-        let objects = _nativeStorage._getNonVerbatimBridgedHeapBuffer()
+        let objects = _createBridgedHeapBuffer()
         
         // Atomically store a reference to that buffer in self.
         if !_stdlib_atomicInitializeARCRef(
@@ -217,6 +297,47 @@ extension _SwiftNativeNSArrayWithContiguousStorage: _NSArrayCoreType {
     return _nativeStorage._withVerbatimBridgedUnsafeBuffer { $0.count }
       ?? _nativeStorage._getNonVerbatimBridgedCount()
   }
+
+  /// Returns the element at `index`.
+  ///
+  /// This override bridges only the requested element, unless all elements
+  /// have been bridged already.
+  @objc
+  internal override func objectAtIndex(index: Int) -> AnyObject {
+    if let bridgedStorage = _heapBufferBridged {
+      let heapBuffer = _HeapBuffer(bridgedStorage)
+      _precondition(
+        _isValidArraySubscript(index, heapBuffer.value),
+        "Array index out of range")
+      return heapBuffer.baseAddress[index]
+    }
+
+    // Check if elements are bridged verbatim.
+    if let object = _nativeStorage._withVerbatimBridgedUnsafeBuffer({
+      (objects: UnsafeBufferPointer<AnyObject>) -> AnyObject in
+      _precondition(
+        _isValidArraySubscript(index, objects.count),
+        "Array index out of range")
+      return objects[index]
+    }) {
+      return object
+    }
+
+    let count = _nativeStorage._getNonVerbatimBridgedCount()
+    _precondition(
+      _isValidArraySubscript(index, count), "Array index out of range")
+    let slot = _getElementCache(count).baseAddress + index
+    if let object = _stdlib_atomicLoadARCRef(object: slot) {
+      return object
+    }
+
+    // Bridge the element, unless another thread wins the race to do so.
+    let object = _nativeStorage._getNonVerbatimBridgedElement(index)
+    if _stdlib_atomicInitializeARCRef(object: slot, desired: object) {
+      return object
+    }
+    return _stdlib_atomicLoadARCRef(object: slot)!
+  }
 }
 #else
 // Empty shim version for non-objc platforms.
@@ -258,6 +379,11 @@ internal class _ContiguousArrayStorageBase
     _sanityCheckFailure(
       "Concrete subclasses must implement _getNonVerbatimBridgedHeapBuffer")
   }
+
+  internal func _getNonVerbatimBridgedElement(index: Int) -> AnyObject {
+    _sanityCheckFailure(
+      "Concrete subclasses must implement _getNonVerbatimBridgedElement")
+  }
 #endif
 
   func canStoreElementsOfDynamicType(_: Any.Type) -> Bool {
@@ -23,8 +23,6 @@
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PointerIntPair.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
@@ -43,8 +41,10 @@
 #include <dlfcn.h>
 #include <cstring>
 #include <mutex>
+#include <algorithm>
 #include <atomic>
 #include <type_traits>
+#include <vector>
 
 // FIXME: Clang defines max_align_t in stddef.h since 3.6.
 // Remove this hack when we don't care about older Clangs on all platforms.
@@ -351,37 +351,57 @@ std::string swift::nameForMetadata(const Metadata *type,
   return result;
 }
 
+namespace {
+  /// A cached name of a type metadata.
+  struct TypeNameCacheEntry {
+    const Metadata *Type;
+    const char *Name;
+    size_t Length;
+  };
+
+  /// The type name caches are read without taking any lock, so repeated
+  /// swift_getTypeName queries on a warm cache are one bucket walk. The
+  /// names are allocated once and never freed, so the returned pointers
+  /// stay valid forever. InsertLock keeps names from being inserted twice.
+  struct TypeNameCacheState {
+    ConcurrentHashTable<TypeNameCacheEntry, 10> QualifiedNames;
+    ConcurrentHashTable<TypeNameCacheEntry, 10> UnqualifiedNames;
+    std::mutex InsertLock;
+
+    ConcurrentList<TypeNameCacheEntry> &getBucket(const Metadata *type,
+                                                  bool qualified) {
+      auto &cache = qualified ? QualifiedNames : UnqualifiedNames;
+      return cache.getBucket(reinterpret_cast<size_t>(type));
+    }
+  };
+}
+
+static Lazy<TypeNameCacheState> TypeNameCache;
+
+static const TypeNameCacheEntry *
+findTypeName(ConcurrentList<TypeNameCacheEntry> &bucket,
+             const Metadata *type) {
+  for (auto &entry : bucket)
+    if (entry.Type == type)
+      return &entry;
+  return nullptr;
+}
+
 extern "C"
 TwoWordPair<const char *, uintptr_t>::Return
 swift_getTypeName(const Metadata *type, bool qualified) {
   using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
-  
-  static pthread_rwlock_t TypeNameCacheLock = PTHREAD_RWLOCK_INITIALIZER;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
-  auto &cache = TypeNameCache.get();
-  
-  pthread_rwlock_rdlock(&TypeNameCacheLock);
-  auto found = cache.find(key);
-  if (found != cache.end()) {
-    auto result = found->second;
-    pthread_rwlock_unlock(&TypeNameCacheLock);
-    return Pair{result.first, result.second};
-  }
-  
-  pthread_rwlock_unlock(&TypeNameCacheLock);
-  pthread_rwlock_wrlock(&TypeNameCacheLock);
-  // Someone may have beaten us to the write lock.
-  found = cache.find(key);
-  if (found != cache.end()) {
-    auto result = found->second;
-    pthread_rwlock_unlock(&TypeNameCacheLock);
-    return Pair{result.first, result.second};
-  }
-  
+
+  auto &C = TypeNameCache.get();
+  auto &bucket = C.getBucket(type, qualified);
+  if (auto entry = findTypeName(bucket, type))
+    return Pair{entry->Name, entry->Length};
+
+  std::lock_guard<std::mutex> guard(C.InsertLock);
+  // Someone may have inserted the name while we were waiting for the lock.
+  if (auto entry = findTypeName(bucket, type))
+    return Pair{entry->Name, entry->Length};
+
   // Build the metadata name.
   auto name = nameForMetadata(type, qualified);
   // Copy it to memory we can reference forever.
@@ -389,8 +409,7 @@ swift_getTypeName(const Metadata *type, bool qualified) {
   auto result = (char*)malloc(size + 1);
   memcpy(result, name.data(), size);
   result[size] = 0;
-  cache.insert({key, {result, size}});
-  pthread_rwlock_unlock(&TypeNameCacheLock);
+  bucket.push_front(TypeNameCacheEntry{type, result, size});
   return Pair{result, size};
 }
 
@@ -1975,6 +1994,12 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *srcType,
                               const Metadata *targetType,
                               DynamicCastFlags flags) {
+  // A value can always be cast to its own type. This is also the common
+  // case reached after opening an existential whose dynamic type is exactly
+  // the target type.
+  if (srcType == targetType)
+    return _succeed(dest, src, srcType, flags);
+
   switch (targetType->getKind()) {
 
   // Casts to class type.
@@ -2147,7 +2172,7 @@ void ProtocolConformanceRecord::dump() const {
              kind == ProtocolConformanceTypeKind::UniqueDirectType
              ? "unique" : "nonunique");
       if (auto ntd = getDirectType()->getNominalTypeDescriptor()) {
-        printf("%s", ntd->Name);
+        printf("%s", (const char *)ntd->Name);
       } else {
         printf("<structural type>");
       }
@@ -2238,12 +2263,62 @@ static std::once_flag InstallProtocolConformanceAddImageCallbackOnce;
 namespace {
   struct ConformanceSection {
     const ProtocolConformanceRecord *Begin, *End;
+
+    /// The records of the section sorted by protocol, so that a scan for one
+    /// protocol only visits the records of that protocol. Built the first
+    /// time the section is scanned.
+    std::vector<const ProtocolConformanceRecord *> ByProtocol;
+    bool Indexed = false;
+
+    ConformanceSection(const ProtocolConformanceRecord *Begin,
+                       const ProtocolConformanceRecord *End)
+      : Begin(Begin), End(End) {}
+
     const ProtocolConformanceRecord *begin() const {
       return Begin;
     }
     const ProtocolConformanceRecord *end() const {
       return End;
     }
+    size_t size() const {
+      return End - Begin;
+    }
+
+    /// Orders records by their protocol.
+    struct ProtocolOrder {
+      static const ProtocolDescriptor *
+      key(const ProtocolConformanceRecord *record) {
+        return record->getProtocol();
+      }
+      static const ProtocolDescriptor *key(const ProtocolDescriptor *protocol) {
+        return protocol;
+      }
+      template <class L, class R>
+      bool operator()(const L &lhs, const R &rhs) const {
+        return std::less<const ProtocolDescriptor *>()(key(lhs), key(rhs));
+      }
+    };
+
+    void buildIndex() {
+      ByProtocol.reserve(size());
+      for (const auto &record : *this)
+        ByProtocol.push_back(&record);
+      // Keep the records of a protocol in section order, which is the order
+      // in which a linear scan would cache them.
+      std::stable_sort(ByProtocol.begin(), ByProtocol.end(), ProtocolOrder());
+      Indexed = true;
+    }
+
+    using RecordIterator =
+      std::vector<const ProtocolConformanceRecord *>::const_iterator;
+
+    /// Returns the records for \p protocol. The section must be indexed.
+    std::pair<RecordIterator, RecordIterator>
+    getRecords(const ProtocolDescriptor *protocol) const {
+      assert(Indexed && "conformance section was not indexed yet");
+      return std::equal_range(ByProtocol.begin(), ByProtocol.end(), protocol,
+                              ProtocolOrder());
+    }
   };
 
   struct ConformanceCacheEntry {
@@ -2332,23 +2407,43 @@ namespace {
 
 // Conformance Cache.
 
+/// The conformance cache is read without taking any lock: cache hits, and
+/// negative entries that are still up to date, are answered by walking a
+/// bucket of the concurrent hash table. SectionsToScanLock is only taken to
+/// register a new image's conformances and to insert new cache entries after
+/// a scan, so cast throughput scales with the number of threads. A scan only
+/// visits the records of the requested protocol, using the per-section index
+/// built by the first scan that reaches a section.
 struct ConformanceState {
-  ConcurrentMap<size_t, ConformanceCacheEntry> Cache;
+  ConcurrentHashTable<ConformanceCacheEntry, 12> Cache;
   std::vector<ConformanceSection> SectionsToScan;
   pthread_mutex_t SectionsToScanLock;
-  
-  ConformanceState() {
+
+  /// The number of entries in SectionsToScan, published with release
+  /// semantics so that lock-free readers can validate negative cache entries
+  /// without racing with a push_back on the vector.
+  std::atomic<size_t> NumSectionsToScan;
+
+  /// Incremented every time a scan populated the cache. This is used to
+  /// signal when a cache was generated and it is correct to avoid a new scan.
+  std::atomic<unsigned> CacheGeneration;
+
+  ConformanceState() : NumSectionsToScan(0), CacheGeneration(0) {
     SectionsToScan.reserve(16);
     pthread_mutex_init(&SectionsToScanLock, nullptr);
   }
+
+  size_t getNumSectionsToScan() const {
+    return NumSectionsToScan.load(std::memory_order_acquire);
+  }
+
+  ConcurrentList<ConformanceCacheEntry> &getBucket(size_t hash) {
+    return Cache.getBucket(hash);
+  }
 };
 
 static Lazy<ConformanceState> Conformances;
 
-// This variable is used to signal when a cache was generated and
-// it is correct to avoid a new scan.
-static unsigned ConformanceCacheGeneration = 0;
-
 void
 swift::swift_registerProtocolConformances(const ProtocolConformanceRecord *begin,
                                           const ProtocolConformanceRecord *end){
@@ -2356,7 +2451,8 @@ swift::swift_registerProtocolConformances(const ProtocolConformanceRecord *begin
 
   pthread_mutex_lock(&C.SectionsToScanLock);
 
-  C.SectionsToScan.push_back(ConformanceSection{begin, end});
+  C.SectionsToScan.push_back(ConformanceSection(begin, end));
+  C.NumSectionsToScan.store(C.SectionsToScan.size(), std::memory_order_release);
 
   pthread_mutex_unlock(&C.SectionsToScanLock);
 }
@@ -2447,6 +2543,42 @@ static void installCallbacksToInspectDylib() {
   SWIFT_ONCE_F(token, callback, nullptr);
 }
 
+/// If the sections to index hold at least this many records in total, they
+/// are indexed on the runtime's worker threads.
+static const size_t ParallelIndexingThreshold = 8192;
+
+/// Index the conformance sections in [beginIdx, endIdx) which were not indexed
+/// yet. Must be called with SectionsToScanLock held.
+static void indexConformanceSections(ConformanceState &C, size_t beginIdx,
+                                     size_t endIdx) {
+  std::vector<ConformanceSection *> toIndex;
+  size_t numRecords = 0;
+  for (size_t idx = beginIdx; idx < endIdx; ++idx) {
+    auto &section = C.SectionsToScan[idx];
+    if (section.Indexed)
+      continue;
+    toIndex.push_back(&section);
+    numRecords += section.size();
+  }
+
+  // After the launch of a program with many dynamic libraries this is every
+  // section of the process. Each section is indexed independently, so they
+  // can be sorted in parallel.
+  if (toIndex.size() > 1 && numRecords >= ParallelIndexingThreshold) {
+    _swift_stdlib_parallelFor(toIndex.size(), 1,
+                              [](void *context, size_t begin, size_t end) {
+      auto &sections = *static_cast<std::vector<ConformanceSection *> *>(
+                                                                     context);
+      for (size_t idx = begin; idx < end; ++idx)
+        sections[idx]->buildIndex();
+    }, &toIndex);
+    return;
+  }
+
+  for (auto *section : toIndex)
+    section->buildIndex();
+}
+
 static size_t hashTypeProtocolPair(const void *type,
                                    const ProtocolDescriptor *protocol) {
   // A simple hash function for the conformance pair.
@@ -2467,6 +2599,10 @@ searchInConformanceCache(const Metadata *type,
 
   foundEntry = nullptr;
 
+  // Negative entries are only valid if no image was registered since they
+  // were created.
+  size_t numSections = C.getNumSectionsToScan();
+
 recur_inside_cache_lock:
 
   // See if we have a cached conformance. Try the specific type first.
@@ -2474,7 +2610,7 @@ recur_inside_cache_lock:
   // Hash and lookup the type-protocol pair in the cache.
   size_t hash = hashTypeProtocolPair(type, protocol);
   ConcurrentList<ConformanceCacheEntry> &Bucket =
-    C.Cache.findOrAllocateNode(hash);
+    C.getBucket(hash);
 
   // Check if the type-protocol entry exists in the cache entry that we found.
   for (auto &Entry : Bucket) {
@@ -2488,7 +2624,7 @@ recur_inside_cache_lock:
       foundEntry = &Entry;
 
     // If we got a cached negative response, check the generation number.
-    if (Entry.getFailureGeneration() == C.SectionsToScan.size()) {
+    if (Entry.getFailureGeneration() == numSections) {
       // We found an entry with a negative value.
       return std::make_pair(nullptr, true);
     }
@@ -2500,7 +2636,7 @@ recur_inside_cache_lock:
     // Hash and lookup the type-protocol pair in the cache.
     size_t hash = hashTypeProtocolPair(generic, protocol);
     ConcurrentList<ConformanceCacheEntry> &Bucket =
-      C.Cache.findOrAllocateNode(hash);
+      C.getBucket(hash);
 
     for (auto &Entry : Bucket) {
       if (!Entry.matches(generic, protocol)) continue;
@@ -2577,10 +2713,10 @@ swift::swift_conformsToProtocol(const Metadata *type,
   ConformanceCacheEntry *foundEntry;
 
 recur:
-  // See if we have a cached conformance. The ConcurrentMap data structure
-  // allows us to insert and search the map concurrently without locking.
+  // See if we have a cached conformance. The ConcurrentHashTable data
+  // structure allows us to search the cache concurrently without locking.
   // We do lock the slow path because the SectionsToScan data structure is not
-  // concurrent.
+  // concurrent, and so that only one thread populates the cache at a time.
   auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
   // The negative answer does not always mean that there is no conformance,
   // unless it is an exact match on the type. If it is not an exact match,
@@ -2591,7 +2727,8 @@ recur:
       return FoundConformance.first;
   }
 
-  unsigned failedGeneration = ConformanceCacheGeneration;
+  unsigned failedGeneration =
+    C.CacheGeneration.load(std::memory_order_acquire);
 
   // If we didn't have an up-to-date cache entry, scan the conformance records.
   pthread_mutex_lock(&C.SectionsToScanLock);
@@ -2599,7 +2736,7 @@ recur:
   // If we have no new information to pull in (and nobody else pulled in
   // new information while we waited on the lock), we're done.
   if (C.SectionsToScan.size() == numSections) {
-    if (failedGeneration != ConformanceCacheGeneration) {
+    if (failedGeneration != C.CacheGeneration.load(std::memory_order_relaxed)) {
       // Someone else pulled in new conformances while we were waiting.
       // Start over with our newly-populated cache.
       pthread_mutex_unlock(&C.SectionsToScanLock);
@@ -2611,7 +2748,7 @@ recur:
     // Hash and lookup the type-protocol pair in the cache.
     size_t hash = hashTypeProtocolPair(type, protocol);
     ConcurrentList<ConformanceCacheEntry> &Bucket =
-      C.Cache.findOrAllocateNode(hash);
+      C.getBucket(hash);
     Bucket.push_front(ConformanceCacheEntry::createFailure(
         type, protocol, C.SectionsToScan.size()));
     pthread_mutex_unlock(&C.SectionsToScanLock);
@@ -2624,11 +2761,15 @@ recur:
   // Scan only sections that were not scanned yet.
   unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
   unsigned endSectionIdx = C.SectionsToScan.size();
+  indexConformanceSections(C, sectionIdx, endSectionIdx);
 
   for (; sectionIdx < endSectionIdx; ++sectionIdx) {
     auto &section = C.SectionsToScan[sectionIdx];
+    auto records = section.getRecords(protocol);
     // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
+    for (auto recordPtr = records.first; recordPtr != records.second;
+         ++recordPtr) {
+      const auto &record = **recordPtr;
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
         auto P = record.getProtocol();
@@ -2643,7 +2784,7 @@ recur:
         // Hash and lookup the type-protocol pair in the cache.
         size_t hash = hashTypeProtocolPair(metadata, P);
         ConcurrentList<ConformanceCacheEntry> &Bucket =
-          C.Cache.findOrAllocateNode(hash);
+          C.getBucket(hash);
 
         auto witness = record.getWitnessTable(metadata);
         if (witness)
@@ -2676,13 +2817,13 @@ recur:
         // Hash and lookup the type-protocol pair in the cache.
         size_t hash = hashTypeProtocolPair(R, P);
         ConcurrentList<ConformanceCacheEntry> &Bucket =
-          C.Cache.findOrAllocateNode(hash);
+          C.getBucket(hash);
           Bucket.push_front(ConformanceCacheEntry::createSuccess(
               R, P, record.getStaticWitnessTable()));
       }
     }
   }
-  ++ConformanceCacheGeneration;
+  C.CacheGeneration.fetch_add(1, std::memory_order_release);
 
   pthread_mutex_unlock(&C.SectionsToScanLock);
   // Start over with our newly-populated cache.
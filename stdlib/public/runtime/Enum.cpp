@@ -249,64 +249,30 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
   memcpy(extraTagBitAddr, &extraTagIndex, numExtraTagBytes);
 }
 
-void
-swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
-                                     EnumMetadata *enumType,
-                                     unsigned numPayloads,
-                                     const TypeLayout * const *payloadLayouts) {
-  // Accumulate the layout requirements of the payloads.
-  size_t payloadSize = 0, alignMask = 0;
-  bool isPOD = true, isBT = true;
-  for (unsigned i = 0; i < numPayloads; ++i) {
-    const TypeLayout *payloadLayout = payloadLayouts[i];
-    payloadSize
-      = std::max(payloadSize, (size_t)payloadLayout->size);
-    alignMask |= payloadLayout->flags.getAlignmentMask();
-    isPOD &= payloadLayout->flags.isPOD();
-    isBT &= payloadLayout->flags.isBitwiseTakable();
-  }
-  
-  // Store the max payload size in the metadata.
-  enumType->getPayloadSize() = payloadSize;
-  
-  // The total size includes space for the tag.
-  unsigned totalSize = payloadSize + getNumTagBytes(payloadSize,
-                                enumType->Description->Enum.getNumEmptyCases(),
-                                numPayloads);
-  
-  // Set up the layout info in the vwtable.
-  vwtable->size = totalSize;
-  vwtable->flags = ValueWitnessFlags()
-    .withAlignmentMask(alignMask)
-    .withPOD(isPOD)
-    .withBitwiseTakable(isBT)
-    // TODO: Extra inhabitants
-    .withExtraInhabitants(false)
-    .withEnumWitnesses(true)
-    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
-    ;
-  vwtable->stride = (totalSize + alignMask) & ~alignMask;
-  
-  installCommonValueWitnesses(vwtable);
-}
-
 namespace {
 struct MultiPayloadLayout {
   size_t payloadSize;
   size_t numTagBytes;
+  unsigned numPayloads;
 };
 }
 
 static MultiPayloadLayout getMultiPayloadLayout(const EnumMetadata *enumType) {
   size_t payloadSize = enumType->getPayloadSize();
   size_t totalSize = enumType->getValueWitnesses()->size;
-  return {payloadSize, totalSize - payloadSize};
+  return {payloadSize, totalSize - payloadSize,
+          enumType->Description->Enum.getNumPayloadCases()};
 }
 
 static void storeMultiPayloadTag(OpaqueValue *value,
                                  MultiPayloadLayout layout,
                                  unsigned tag) {
   auto tagBytes = reinterpret_cast<char *>(value) + layout.payloadSize;
+  // The tag of almost every enum fits in a single byte.
+  if (layout.numTagBytes == 1) {
+    *reinterpret_cast<uint8_t *>(tagBytes) = tag;
+    return;
+  }
   small_memcpy(tagBytes, &tag, layout.numTagBytes);
 }
 
@@ -314,7 +280,16 @@ static void storeMultiPayloadValue(OpaqueValue *value,
                                    MultiPayloadLayout layout,
                                    unsigned payloadValue) {
   auto bytes = reinterpret_cast<char *>(value);
-  
+
+  // Specialize for pointer-sized payloads, which are the most common, so that
+  // the copies have constant sizes and become plain stores.
+  if (layout.payloadSize == sizeof(void *)) {
+    memcpy(bytes, &payloadValue, sizeof(payloadValue));
+    memset(bytes + sizeof(payloadValue), 0,
+           sizeof(void *) - sizeof(payloadValue));
+    return;
+  }
+
   memcpy(bytes, &payloadValue,
          std::min(layout.payloadSize, sizeof(payloadValue)));
   
@@ -328,6 +303,10 @@ static unsigned loadMultiPayloadTag(const OpaqueValue *value,
                                     MultiPayloadLayout layout) {
   auto tagBytes = reinterpret_cast<const char *>(value) + layout.payloadSize;
 
+  // The tag of almost every enum fits in a single byte.
+  if (layout.numTagBytes == 1)
+    return *reinterpret_cast<const uint8_t *>(tagBytes);
+
   unsigned tag = 0;
   small_memcpy(&tag, tagBytes, layout.numTagBytes);
 
@@ -343,12 +322,101 @@ static unsigned loadMultiPayloadValue(const OpaqueValue *value,
   return payloadValue;
 }
 
+static unsigned getMultiPayloadCase(const OpaqueValue *value,
+                                    MultiPayloadLayout layout) {
+  unsigned tag = loadMultiPayloadTag(value, layout);
+  if (tag < layout.numPayloads) {
+    // If the tag indicates a payload, then we're done.
+    return tag;
+  } else {
+    // Otherwise, the other part of the discriminator is in the payload.
+    unsigned payloadValue = loadMultiPayloadValue(value, layout);
+    
+    if (layout.payloadSize >= 4) {
+      return layout.numPayloads + payloadValue;
+    } else {
+      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
+      return (payloadValue | (tag - layout.numPayloads) << numPayloadBits)
+             + layout.numPayloads;
+    }
+  }
+}
+
+/// The getEnumTag witness of a generic multi-payload enum whose tag is
+/// NumTagBytes wide. swift_initEnumMetadataMultiPayload installs the one
+/// matching the instantiated layout, so the tag load has a constant size and
+/// the witness does not go through the compiler-emitted thunk.
+template <size_t NumTagBytes>
+static unsigned getEnumTagMultiPayload(const OpaqueValue *value,
+                                       const Metadata *self) {
+  auto enumType = static_cast<const EnumMetadata *>(self);
+  MultiPayloadLayout layout{enumType->getPayloadSize(), NumTagBytes,
+                            enumType->Description->Enum.getNumPayloadCases()};
+  return getMultiPayloadCase(value, layout);
+}
+
+void
+swift::swift_initEnumMetadataMultiPayload(ValueWitnessTable *vwtable,
+                                     EnumMetadata *enumType,
+                                     unsigned numPayloads,
+                                     const TypeLayout * const *payloadLayouts) {
+  // Accumulate the layout requirements of the payloads.
+  size_t payloadSize = 0, alignMask = 0;
+  bool isPOD = true, isBT = true;
+  for (unsigned i = 0; i < numPayloads; ++i) {
+    const TypeLayout *payloadLayout = payloadLayouts[i];
+    payloadSize
+      = std::max(payloadSize, (size_t)payloadLayout->size);
+    alignMask |= payloadLayout->flags.getAlignmentMask();
+    isPOD &= payloadLayout->flags.isPOD();
+    isBT &= payloadLayout->flags.isBitwiseTakable();
+  }
+  
+  // Store the max payload size in the metadata.
+  enumType->getPayloadSize() = payloadSize;
+  
+  // The total size includes space for the tag.
+  unsigned numTagBytes = getNumTagBytes(payloadSize,
+                                enumType->Description->Enum.getNumEmptyCases(),
+                                numPayloads);
+  unsigned totalSize = payloadSize + numTagBytes;
+  
+  // Set up the layout info in the vwtable.
+  vwtable->size = totalSize;
+  vwtable->flags = ValueWitnessFlags()
+    .withAlignmentMask(alignMask)
+    .withPOD(isPOD)
+    .withBitwiseTakable(isBT)
+    // TODO: Extra inhabitants
+    .withExtraInhabitants(false)
+    .withEnumWitnesses(true)
+    .withInlineStorage(ValueWitnessTable::isValueInline(totalSize, alignMask+1))
+    ;
+  vwtable->stride = (totalSize + alignMask) & ~alignMask;
+  
+  installCommonValueWitnesses(vwtable);
+
+  // Replace the getEnumTag witness with one specialized for the tag size.
+  auto enumWitnesses = static_cast<EnumValueWitnessTable *>(vwtable);
+  switch (numTagBytes) {
+  case 1:
+    enumWitnesses->getEnumTag = getEnumTagMultiPayload<1>;
+    break;
+  case 2:
+    enumWitnesses->getEnumTag = getEnumTagMultiPayload<2>;
+    break;
+  case 4:
+    enumWitnesses->getEnumTag = getEnumTagMultiPayload<4>;
+    break;
+  }
+}
+
 void
 swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
                                       const EnumMetadata *enumType,
                                       unsigned whichCase) {
   auto layout = getMultiPayloadLayout(enumType);
-  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
+  unsigned numPayloads = layout.numPayloads;
   if (whichCase < numPayloads) {
     // For a payload case, store the tag after the payload area.
     storeMultiPayloadTag(value, layout, whichCase);
@@ -363,7 +431,7 @@ swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
     } else {
       unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
       whichTag = numPayloads + (whichEmptyCase >> numPayloadBits);
-      whichPayloadValue = whichEmptyCase & ((1U << numPayloads) - 1U);
+      whichPayloadValue = whichEmptyCase & ((1U << numPayloadBits) - 1U);
     }
     storeMultiPayloadTag(value, layout, whichTag);
     storeMultiPayloadValue(value, layout, whichPayloadValue);
@@ -373,23 +441,5 @@ swift::swift_storeEnumTagMultiPayload(OpaqueValue *value,
 unsigned
 swift::swift_getEnumCaseMultiPayload(const OpaqueValue *value,
                                      const EnumMetadata *enumType) {
-  auto layout = getMultiPayloadLayout(enumType);
-  unsigned numPayloads = enumType->Description->Enum.getNumPayloadCases();
-
-  unsigned tag = loadMultiPayloadTag(value, layout);
-  if (tag < numPayloads) {
-    // If the tag indicates a payload, then we're done.
-    return tag;
-  } else {
-    // Otherwise, the other part of the discriminator is in the payload.
-    unsigned payloadValue = loadMultiPayloadValue(value, layout);
-    
-    if (layout.payloadSize >= 4) {
-      return numPayloads + payloadValue;
-    } else {
-      unsigned numPayloadBits = layout.payloadSize * CHAR_BIT;
-      return (payloadValue | (tag - numPayloads) << numPayloadBits)
-             + numPayloads;
-    }
-  }
+  return getMultiPayloadCase(value, getMultiPayloadLayout(enumType));
 }
@@ -18,18 +18,38 @@
 //===----------------------------------------------------------------------===//
 
 #include <stdio.h>
+#include <mutex>
+#include <pthread.h>
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
+#include "Leaks.h"
 #include "Private.h"
 
 #if !SWIFT_OBJC_INTEROP
 
 using namespace swift;
 
+/// Values of trivially copyable error types up to this size are stored in
+/// boxes of one fixed size, which can be reused for any of these types.
+static constexpr size_t SmallErrorCapacity = 3 * sizeof(void *);
+static constexpr size_t SmallErrorBoxSize =
+  sizeof(SwiftError) + SmallErrorCapacity;
+
+/// Determine whether the box for a value of the given type is a small error
+/// box.
+static bool _isSmallErrorType(const Metadata *type) {
+  auto vw = type->getValueWitnesses();
+  return vw->isPOD() && vw->getSize() <= SmallErrorCapacity &&
+         vw->getAlignmentMask() < alignof(SwiftError);
+}
+
 /// Determine the size and alignment of an ErrorType box containing the given
 /// type.
 static std::pair<size_t, size_t>
 _getErrorAllocatedSizeAndAlignmentMask(const Metadata *type) {
+  if (_isSmallErrorType(type))
+    return {SmallErrorBoxSize, alignof(SwiftError) - 1};
+
   // The value is tail-allocated after the SwiftError record with the
   // appropriate alignment.
   auto vw = type->getValueWitnesses();
@@ -43,6 +63,67 @@ _getErrorAllocatedSizeAndAlignmentMask(const Metadata *type) {
   return {size, alignMask};
 }
 
+//===----------------------------------------------------------------------===//
+//                           Small error box cache
+//===----------------------------------------------------------------------===//
+//
+// Code which throws and catches errors in a loop allocates and frees an error
+// box per iteration. Each thread keeps the last small error box it freed and
+// hands it out again to the next swift_allocError of a small type, so that a
+// throw of a simple error enum doesn't have to go to the allocator.
+//
+//===----------------------------------------------------------------------===//
+
+static __thread SwiftError *CachedSmallErrorBox = nullptr;
+static pthread_key_t SmallErrorBoxKey;
+static std::once_flag SmallErrorBoxKeyOnce;
+
+/// Free the box cached by an exiting thread.
+static void _freeCachedSmallErrorBox(void *box) {
+  CachedSmallErrorBox = nullptr;
+  swift_slowDealloc(box, SmallErrorBoxSize, alignof(SwiftError) - 1);
+}
+
+/// Take the current thread's cached box, or return null if there is none.
+static SwiftError *_takeCachedSmallErrorBox() {
+  SwiftError *box = CachedSmallErrorBox;
+  if (!box)
+    return nullptr;
+  CachedSmallErrorBox = nullptr;
+  pthread_setspecific(SmallErrorBoxKey, nullptr);
+
+  // Revive the box as a fresh object.
+  box->refCount.init();
+  box->weakRefCount.init();
+  SWIFT_LEAKS_START_TRACKING_OBJECT(box);
+  return box;
+}
+
+/// Deallocate a small error box, or keep it in the current thread's cache if
+/// the cache is empty.
+static void _deallocSmallErrorBox(SwiftError *box) {
+  if (CachedSmallErrorBox || box->weakRefCount.hasSideTable()) {
+    swift_deallocObject(box, SmallErrorBoxSize, alignof(SwiftError) - 1);
+    return;
+  }
+
+  std::call_once(SmallErrorBoxKeyOnce, [] {
+    pthread_key_create(&SmallErrorBoxKey, _freeCachedSmallErrorBox);
+  });
+  SWIFT_LEAKS_STOP_TRACKING_OBJECT(box);
+  CachedSmallErrorBox = box;
+  pthread_setspecific(SmallErrorBoxKey, box);
+}
+
+/// Deallocate an ErrorType box of the given type.
+static void _deallocErrorObject(SwiftError *error, const Metadata *type) {
+  if (_isSmallErrorType(type))
+    return _deallocSmallErrorBox(error);
+
+  auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+  swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
+}
+
 /// Destructor for an ErrorType box.
 static void _destroyErrorObject(HeapObject *obj) {
   auto error = static_cast<SwiftError *>(obj);
@@ -52,8 +133,7 @@ static void _destroyErrorObject(HeapObject *obj) {
   type->vw_destroy(error->getValue());
   
   // Deallocate the buffer.
-  auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
-  swift_deallocObject(obj, sizeAndAlign.first, sizeAndAlign.second);
+  _deallocErrorObject(error, type);
 }
 
 /// Heap metadata for ErrorType boxes.
@@ -67,12 +147,15 @@ swift::swift_allocError(const swift::Metadata *type,
                         const swift::WitnessTable *errorConformance,
                         OpaqueValue *initialValue,
                         bool isTake) {
-  auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
-  
-  auto allocated = swift_allocObject(&ErrorTypeMetadata,
-                                     sizeAndAlign.first, sizeAndAlign.second);
-  
-  auto error = reinterpret_cast<SwiftError*>(allocated);
+  SwiftError *error = nullptr;
+  if (_isSmallErrorType(type))
+    error = _takeCachedSmallErrorBox();
+  if (!error) {
+    auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
+    auto allocated = swift_allocObject(&ErrorTypeMetadata, sizeAndAlign.first,
+                                       sizeAndAlign.second);
+    error = reinterpret_cast<SwiftError*>(allocated);
+  }
   
   error->type = type;
   error->errorConformance = errorConformance;
@@ -86,13 +169,12 @@ swift::swift_allocError(const swift::Metadata *type,
       type->vw_initializeWithCopy(valuePtr, initialValue);
   }
   
-  return BoxPair{allocated, valuePtr};
+  return BoxPair{error, valuePtr};
 }
 
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
-  auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
-  swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
+  _deallocErrorObject(error, type);
 }
 
 void
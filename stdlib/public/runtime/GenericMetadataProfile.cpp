@@ -0,0 +1,121 @@
+//===--- GenericMetadataProfile.cpp - Generic metadata request profile ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counts the requests for each instantiation of generic type metadata.
+//
+// Specialized code asks for the metadata of a generic type once and caches
+// it, while unspecialized generic code asks the runtime every time it needs
+// the metadata of a type that depends on its type arguments. The number of
+// requests for a type is therefore a good measure of how much unspecialized
+// code runs with that type. The compiler reads the profile back with
+// -prespecialize-from-profile.
+//
+// Profiling is enabled by starting the process with
+// SWIFT_RUNTIME_GENERIC_METADATA_PROFILE set to a file path, or to "-" for
+// stderr. The profile is written there when the process exits, or whenever
+// swift_genericMetadataProfileWrite is called. Each line holds the number of
+// requests and the name of the type, separated by a tab, most requested
+// first.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Metadata.h"
+#include "Private.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace swift;
+
+std::atomic<bool> swift::_swift_genericMetadataProfileActive(true);
+
+static std::once_flag GenericMetadataProfileInitOnce;
+static bool GenericMetadataProfileEnabled = false;
+static const char *GenericMetadataProfilePath = nullptr;
+static std::mutex GenericMetadataProfileLock;
+static std::unordered_map<const Metadata *, size_t>
+  *GenericMetadataProfileTable = nullptr;
+
+static void writeGenericMetadataProfileAtExit() {
+  swift_genericMetadataProfileWrite(nullptr);
+}
+
+static void initializeGenericMetadataProfile() {
+  const char *path = getenv("SWIFT_RUNTIME_GENERIC_METADATA_PROFILE");
+  if (!path || !path[0]) {
+    _swift_genericMetadataProfileActive.store(false,
+                                              std::memory_order_relaxed);
+    return;
+  }
+
+  GenericMetadataProfilePath = path;
+  GenericMetadataProfileTable =
+    new std::unordered_map<const Metadata *, size_t>();
+  GenericMetadataProfileEnabled = true;
+  atexit(writeGenericMetadataProfileAtExit);
+}
+
+void swift::_swift_genericMetadataProfileRequest(const Metadata *metadata) {
+  std::call_once(GenericMetadataProfileInitOnce,
+                 initializeGenericMetadataProfile);
+  if (!GenericMetadataProfileEnabled)
+    return;
+
+  std::lock_guard<std::mutex> guard(GenericMetadataProfileLock);
+  ++(*GenericMetadataProfileTable)[metadata];
+}
+
+void swift::swift_genericMetadataProfileWrite(const char *path) {
+  std::call_once(GenericMetadataProfileInitOnce,
+                 initializeGenericMetadataProfile);
+  if (!GenericMetadataProfileEnabled)
+    return;
+
+  // Take a snapshot, so that computing names (which may request generic
+  // metadata itself) happens without holding the lock.
+  std::vector<std::pair<const Metadata *, size_t>> entries;
+  {
+    std::lock_guard<std::mutex> guard(GenericMetadataProfileLock);
+    entries.assign(GenericMetadataProfileTable->begin(),
+                   GenericMetadataProfileTable->end());
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const std::pair<const Metadata *, size_t> &lhs,
+               const std::pair<const Metadata *, size_t> &rhs) {
+    return lhs.second > rhs.second;
+  });
+
+  if (!path)
+    path = GenericMetadataProfilePath;
+  bool toStderr = strcmp(path, "-") == 0;
+  FILE *out = toStderr ? stderr : fopen(path, "w");
+  if (!out) {
+    fprintf(stderr,
+            "swift runtime: unable to write generic metadata profile to %s\n",
+            path);
+    return;
+  }
+
+  for (const auto &entry : entries)
+    fprintf(out, "%zu\t%s\n", entry.second,
+            nameForMetadata(entry.first).c_str());
+
+  if (!toStderr)
+    fclose(out);
+}
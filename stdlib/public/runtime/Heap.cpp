@@ -18,17 +18,377 @@
 #include "swift/Runtime/Heap.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
+#include <mutex>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 
 using namespace swift;
 
+//===----------------------------------------------------------------------===//
+//                            Slab allocator
+//===----------------------------------------------------------------------===//
+//
+// Most runtime allocations are small class instances and boxes of a handful of
+// fixed sizes. When enabled with SWIFT_RUNTIME_SLAB_ALLOCATOR=1, those are
+// served from per-thread free lists segregated by size class, and everything
+// else goes to malloc.
+//
+// Each size class owns a fixed region of reserved address space, so the size
+// class of a block is computed from its address on deallocation; no header
+// or size lookup is needed. Blocks freed by a thread are cached by that
+// thread; caches that grow too large spill half of their blocks to a
+// per-class global list, from which other threads refill.
+//
+// SWIFT_RUNTIME_ALLOCATION_STATS=1 counts allocations per size class and
+// prints them to stderr at exit, for both the slab and the system allocator.
+//
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// The granularity and alignment of slab blocks.
+constexpr size_t SlabQuantum = 16;
+
+/// Blocks of 16, 32, ..., 256 bytes are served by the slab allocator.
+constexpr unsigned NumSizeClasses = 16;
+constexpr size_t MaxSlabBlockSize = SlabQuantum * NumSizeClasses;
+
+/// The amount of address space reserved for each size class.
+constexpr unsigned RegionShift = 28;
+constexpr size_t RegionSize = size_t(1) << RegionShift;
+
+/// Regions are carved into blocks a chunk at a time.
+constexpr size_t ChunkSize = 64 * 1024;
+
+/// The number of free blocks a thread may cache per size class before it
+/// returns half of them to the global list.
+constexpr unsigned MaxThreadCachedBlocks = 512;
+
+/// The alignment malloc guarantees.
+constexpr size_t MallocAlignMask = 2 * sizeof(void *) - 1;
+
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+struct SizeClassState {
+  /// The next unused byte in this class's region.
+  std::atomic<char *> Next;
+  /// The end of this class's region.
+  char *End;
+
+  /// Blocks spilled by thread caches, guarded by Lock.
+  std::mutex Lock;
+  FreeBlock *GlobalFree;
+  unsigned NumGlobalFree;
+};
+
+struct ThreadCache {
+  FreeBlock *Free[NumSizeClasses];
+  unsigned Count[NumSizeClasses];
+  bool Registered;
+};
+
+/// Allocation counters. They are only updated if statistics were requested,
+/// so that the counters don't become a contention point.
+struct AllocatorStatistics {
+  std::atomic<size_t> SlabAllocs[NumSizeClasses];
+  std::atomic<size_t> SlabDeallocs[NumSizeClasses];
+  std::atomic<size_t> SlabFallbacks;
+  std::atomic<size_t> MallocAllocs;
+  std::atomic<size_t> MallocDeallocs;
+  std::atomic<size_t> MallocBytes;
+};
+
+} // end anonymous namespace
+
+static bool SlabAllocatorEnabled = false;
+static bool AllocationStatsEnabled = false;
+static char *SlabBase = nullptr;
+static SizeClassState *SizeClasses = nullptr;
+static AllocatorStatistics Stats;
+static pthread_key_t ThreadCacheKey;
+static std::once_flag AllocatorInitOnce;
+static std::atomic<bool> AllocatorInitialized(false);
+
+static __thread ThreadCache LocalCache;
+
+static unsigned getSizeClass(size_t size) {
+  return size ? (size - 1) / SlabQuantum : 0;
+}
+
+static size_t getSizeClassBlockSize(unsigned sizeClass) {
+  return (sizeClass + 1) * SlabQuantum;
+}
+
+static bool isSlabPointer(const void *ptr) {
+  return SlabBase && (uintptr_t)ptr - (uintptr_t)SlabBase
+                       < NumSizeClasses * RegionSize;
+}
+
+static unsigned getSizeClassOfSlabPointer(const void *ptr) {
+  return ((uintptr_t)ptr - (uintptr_t)SlabBase) >> RegionShift;
+}
+
+static bool isEnvironmentFlagSet(const char *name) {
+  const char *value = getenv(name);
+  return value && value[0] && strcmp(value, "0") != 0;
+}
+
+static void dumpAllocatorStatistics() {
+  swift_slowAllocDumpStatistics();
+}
+
+/// Return all of the blocks cached by an exiting thread to the global lists.
+static void flushThreadCache(void *cacheAddr) {
+  auto cache = static_cast<ThreadCache *>(cacheAddr);
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass) {
+    FreeBlock *head = cache->Free[sizeClass];
+    if (!head)
+      continue;
+    FreeBlock *tail = head;
+    while (tail->Next)
+      tail = tail->Next;
+
+    auto &state = SizeClasses[sizeClass];
+    std::lock_guard<std::mutex> guard(state.Lock);
+    tail->Next = state.GlobalFree;
+    state.GlobalFree = head;
+    state.NumGlobalFree += cache->Count[sizeClass];
+    cache->Free[sizeClass] = nullptr;
+    cache->Count[sizeClass] = 0;
+  }
+  cache->Registered = false;
+}
+
+static void initializeAllocator() {
+  AllocationStatsEnabled =
+    isEnvironmentFlagSet("SWIFT_RUNTIME_ALLOCATION_STATS");
+  if (AllocationStatsEnabled)
+    atexit(dumpAllocatorStatistics);
+
+#if __LP64__
+  if (!isEnvironmentFlagSet("SWIFT_RUNTIME_SLAB_ALLOCATOR"))
+    return;
+
+  // Reserve the address space for all size classes up front. Pages are only
+  // committed when they are first touched.
+  int flags = MAP_ANON | MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  void *base = mmap(nullptr, NumSizeClasses * RegionSize,
+                    PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (base == MAP_FAILED)
+    return;
+
+  if (pthread_key_create(&ThreadCacheKey, flushThreadCache) != 0) {
+    munmap(base, NumSizeClasses * RegionSize);
+    return;
+  }
+
+  SizeClasses = new SizeClassState[NumSizeClasses];
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass) {
+    auto &state = SizeClasses[sizeClass];
+    char *region = (char *)base + sizeClass * RegionSize;
+    state.Next.store(region, std::memory_order_relaxed);
+    state.End = region + RegionSize;
+    state.GlobalFree = nullptr;
+    state.NumGlobalFree = 0;
+  }
+  SlabBase = (char *)base;
+  SlabAllocatorEnabled = true;
+#endif
+}
+
+static void ensureAllocatorInitialized() {
+  if (LLVM_LIKELY(AllocatorInitialized.load(std::memory_order_acquire)))
+    return;
+  std::call_once(AllocatorInitOnce, [] {
+    initializeAllocator();
+    AllocatorInitialized.store(true, std::memory_order_release);
+  });
+}
+
+/// Make sure the blocks cached by the current thread are returned when it
+/// exits. This is re-done if the thread frees blocks after its cache was
+/// already flushed by another thread-exit destructor.
+static void registerThreadCache(ThreadCache &cache) {
+  if (LLVM_LIKELY(cache.Registered))
+    return;
+  pthread_setspecific(ThreadCacheKey, &cache);
+  cache.Registered = true;
+}
+
+/// Refill the current thread's cache for \p sizeClass, first from the global
+/// list and then from the class's region. \returns false if the region is
+/// exhausted.
+LLVM_ATTRIBUTE_NOINLINE
+static bool refillThreadCache(unsigned sizeClass) {
+  auto &cache = LocalCache;
+  registerThreadCache(cache);
+
+  auto &state = SizeClasses[sizeClass];
+  {
+    std::lock_guard<std::mutex> guard(state.Lock);
+    if (state.GlobalFree) {
+      // Take the whole list; a thread that keeps allocating from this class
+      // will keep using it.
+      cache.Free[sizeClass] = state.GlobalFree;
+      cache.Count[sizeClass] = state.NumGlobalFree;
+      state.GlobalFree = nullptr;
+      state.NumGlobalFree = 0;
+      return true;
+    }
+  }
+
+  // Carve a new chunk out of the region.
+  char *chunk = state.Next.fetch_add(ChunkSize, std::memory_order_relaxed);
+  if (chunk + ChunkSize > state.End)
+    return false;
+
+  size_t blockSize = getSizeClassBlockSize(sizeClass);
+  unsigned count = ChunkSize / blockSize;
+  FreeBlock *head = nullptr;
+  for (unsigned i = count; i != 0; --i) {
+    auto freeBlock = reinterpret_cast<FreeBlock *>(chunk + (i-1) * blockSize);
+    freeBlock->Next = head;
+    head = freeBlock;
+  }
+  cache.Free[sizeClass] = head;
+  cache.Count[sizeClass] = count;
+  return true;
+}
+
+static void *slabAlloc(unsigned sizeClass) {
+  auto &cache = LocalCache;
+  FreeBlock *block = cache.Free[sizeClass];
+  if (LLVM_UNLIKELY(!block)) {
+    if (!refillThreadCache(sizeClass))
+      return nullptr;
+    block = cache.Free[sizeClass];
+  }
+  cache.Free[sizeClass] = block->Next;
+  --cache.Count[sizeClass];
+  return block;
+}
+
+static void slabDealloc(void *ptr, unsigned sizeClass) {
+  auto &cache = LocalCache;
+  registerThreadCache(cache);
+  auto block = static_cast<FreeBlock *>(ptr);
+  block->Next = cache.Free[sizeClass];
+  cache.Free[sizeClass] = block;
+  if (LLVM_LIKELY(++cache.Count[sizeClass] <= MaxThreadCachedBlocks))
+    return;
+
+  // Spill half of the cached blocks to the global list.
+  FreeBlock *head = cache.Free[sizeClass];
+  FreeBlock *tail = head;
+  unsigned numSpilled = MaxThreadCachedBlocks / 2;
+  for (unsigned i = 1; i < numSpilled; ++i)
+    tail = tail->Next;
+  cache.Free[sizeClass] = tail->Next;
+  cache.Count[sizeClass] -= numSpilled;
+
+  auto &state = SizeClasses[sizeClass];
+  std::lock_guard<std::mutex> guard(state.Lock);
+  tail->Next = state.GlobalFree;
+  state.GlobalFree = head;
+  state.NumGlobalFree += numSpilled;
+}
+
 void *swift::swift_slowAlloc(size_t size, size_t alignMask) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
+  ensureAllocatorInitialized();
+
+  if (SlabAllocatorEnabled && size <= MaxSlabBlockSize &&
+      alignMask < SlabQuantum) {
+    unsigned sizeClass = getSizeClass(size);
+    if (void *p = slabAlloc(sizeClass)) {
+      if (AllocationStatsEnabled)
+        Stats.SlabAllocs[sizeClass].fetch_add(1, std::memory_order_relaxed);
+      return p;
+    }
+    if (AllocationStatsEnabled)
+      Stats.SlabFallbacks.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void *p;
+  if (alignMask <= MallocAlignMask) {
+    p = malloc(size);
+  } else if (posix_memalign(&p, alignMask + 1, size) != 0) {
+    p = nullptr;
+  }
   if (!p) swift::crash("Could not allocate memory.");
+
+  if (AllocationStatsEnabled) {
+    Stats.MallocAllocs.fetch_add(1, std::memory_order_relaxed);
+    Stats.MallocBytes.fetch_add(size, std::memory_order_relaxed);
+  }
   return p;
 }
 
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask) {
+  // The size class is implied by the address, so the size hint is not needed
+  // to find it.
+  if (isSlabPointer(ptr)) {
+    unsigned sizeClass = getSizeClassOfSlabPointer(ptr);
+    assert((bytes == 0 || getSizeClass(bytes) <= sizeClass) &&
+           "deallocating slab block with a larger size than allocated");
+    if (AllocationStatsEnabled)
+      Stats.SlabDeallocs[sizeClass].fetch_add(1, std::memory_order_relaxed);
+    slabDealloc(ptr, sizeClass);
+    return;
+  }
+
+  if (AllocationStatsEnabled)
+    Stats.MallocDeallocs.fetch_add(1, std::memory_order_relaxed);
   free(ptr);
 }
+
+size_t swift::swift_slowAllocSize(const void *ptr) {
+  if (!isSlabPointer(ptr))
+    return 0;
+  return getSizeClassBlockSize(getSizeClassOfSlabPointer(ptr));
+}
+
+bool swift::swift_slowAllocGetStatistics(size_t *allocations, size_t *bytes) {
+  ensureAllocatorInitialized();
+  if (!AllocationStatsEnabled)
+    return false;
+
+  size_t numAllocs = Stats.MallocAllocs.load(std::memory_order_relaxed);
+  size_t numBytes = Stats.MallocBytes.load(std::memory_order_relaxed);
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass) {
+    size_t allocs = Stats.SlabAllocs[sizeClass].load(std::memory_order_relaxed);
+    numAllocs += allocs;
+    numBytes += allocs * getSizeClassBlockSize(sizeClass);
+  }
+  *allocations = numAllocs;
+  *bytes = numBytes;
+  return true;
+}
+
+void swift::swift_slowAllocDumpStatistics() {
+  fprintf(stderr, "swift runtime allocator: slab allocator %s\n",
+          SlabAllocatorEnabled ? "enabled" : "disabled");
+  for (unsigned sizeClass = 0; sizeClass < NumSizeClasses; ++sizeClass) {
+    size_t allocs = Stats.SlabAllocs[sizeClass].load(std::memory_order_relaxed);
+    size_t deallocs =
+      Stats.SlabDeallocs[sizeClass].load(std::memory_order_relaxed);
+    if (!allocs && !deallocs)
+      continue;
+    fprintf(stderr, "  slab %4zu bytes: %zu allocs, %zu deallocs\n",
+            getSizeClassBlockSize(sizeClass), allocs, deallocs);
+  }
+  fprintf(stderr, "  slab fallbacks to malloc: %zu\n",
+          Stats.SlabFallbacks.load(std::memory_order_relaxed));
+  fprintf(stderr, "  malloc: %zu allocs (%zu bytes), %zu deallocs\n",
+          Stats.MallocAllocs.load(std::memory_order_relaxed),
+          Stats.MallocBytes.load(std::memory_order_relaxed),
+          Stats.MallocDeallocs.load(std::memory_order_relaxed));
+}
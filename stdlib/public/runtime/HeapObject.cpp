@@ -29,6 +29,8 @@
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
+#include <mutex>
+#include <unordered_map>
 #include <unistd.h>
 #include "../SwiftShims/RuntimeShims.h"
 #if SWIFT_OBJC_INTEROP
@@ -48,6 +50,34 @@
 #endif
 #include "Leaks.h"
 
+#define SWIFT_PROFILE_ALLOCATION(metadata, size)                               \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(                                                         \
+          _swift_objectProfileActive.load(std::memory_order_relaxed)))         \
+      _swift_objectProfileAllocation(metadata, size);                          \
+  } while (0)
+
+#define SWIFT_PROFILE_LIFETIME_ALLOCATION(object, metadata, size)              \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(                                                         \
+          _swift_lifetimeProfileActive.load(std::memory_order_relaxed)))       \
+      _swift_lifetimeProfileAllocation(object, metadata, size);                \
+  } while (0)
+
+#define SWIFT_PROFILE_LIFETIME_DEALLOCATION(object)                            \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(                                                         \
+          _swift_lifetimeProfileActive.load(std::memory_order_relaxed)))       \
+      _swift_lifetimeProfileDeallocation(object);                              \
+  } while (0)
+
+#define SWIFT_PROFILE_REFCOUNT(object, isRetain, n)                            \
+  do {                                                                         \
+    if (LLVM_UNLIKELY(                                                         \
+          _swift_objectProfileActive.load(std::memory_order_relaxed)))         \
+      _swift_objectProfileRefcount(object, isRetain, n);                       \
+  } while (0)
+
 using namespace swift;
 
 HeapObject *
@@ -55,7 +85,11 @@ swift::swift_allocObject(HeapMetadata const *metadata,
                          size_t requiredSize,
                          size_t requiredAlignmentMask) {
   SWIFT_ALLOCATEOBJECT();
-  return _swift_allocObject(metadata, requiredSize, requiredAlignmentMask);
+  SWIFT_PROFILE_ALLOCATION(metadata, requiredSize);
+  auto object = _swift_allocObject(metadata, requiredSize,
+                                   requiredAlignmentMask);
+  SWIFT_PROFILE_LIFETIME_ALLOCATION(object, metadata, requiredSize);
+  return object;
 }
 static HeapObject *
 _swift_allocObject_(HeapMetadata const *metadata, size_t requiredSize,
@@ -318,6 +352,7 @@ void _swift_release_dealloc(HeapObject *object)
 
 void swift::swift_retain(HeapObject *object) {
   SWIFT_RETAIN();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/true, 1);
   _swift_retain(object);
 }
 static void _swift_retain_(HeapObject *object) {
@@ -327,6 +362,7 @@ auto swift::_swift_retain = _swift_retain_;
 
 void swift::swift_retain_n(HeapObject *object, uint32_t n) {
   SWIFT_RETAIN();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/true, n);
   _swift_retain_n(object, n);
 }
 static void _swift_retain_n_(HeapObject *object, uint32_t n) {
@@ -338,6 +374,7 @@ auto swift::_swift_retain_n = _swift_retain_n_;
 
 void swift::swift_release(HeapObject *object) {
   SWIFT_RELEASE();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/false, 1);
   return _swift_release(object);
 }
 static void _swift_release_(HeapObject *object) {
@@ -349,6 +386,7 @@ auto swift::_swift_release = _swift_release_;
 
 void swift::swift_release_n(HeapObject *object, uint32_t n) {
   SWIFT_RELEASE();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/false, n);
   return _swift_release_n(object, n);
 }
 static void _swift_release_n_(HeapObject *object, uint32_t n) {
@@ -358,6 +396,36 @@ static void _swift_release_n_(HeapObject *object, uint32_t n) {
 }
 auto swift::_swift_release_n = _swift_release_n_;
 
+void swift::swift_nonatomic_retain(HeapObject *object) {
+  SWIFT_RETAIN();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/true, 1);
+  if (object)
+    object->refCount.incrementNonAtomic();
+}
+
+void swift::swift_nonatomic_retain_n(HeapObject *object, uint32_t n) {
+  SWIFT_RETAIN();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/true, n);
+  if (object)
+    object->refCount.incrementNonAtomic(n);
+}
+
+void swift::swift_nonatomic_release(HeapObject *object) {
+  SWIFT_RELEASE();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/false, 1);
+  if (object && object->refCount.decrementShouldDeallocateNNonAtomic()) {
+    _swift_release_dealloc(object);
+  }
+}
+
+void swift::swift_nonatomic_release_n(HeapObject *object, uint32_t n) {
+  SWIFT_RELEASE();
+  SWIFT_PROFILE_REFCOUNT(object, /*isRetain=*/false, n);
+  if (object && object->refCount.decrementShouldDeallocateNNonAtomic(n)) {
+    _swift_release_dealloc(object);
+  }
+}
+
 size_t swift::swift_retainCount(HeapObject *object) {
   return object->refCount.getCount();
 }
@@ -455,6 +523,15 @@ void swift::swift_retainUnowned(HeapObject *object) {
     _swift_abortRetainUnowned(object);
 }
 
+void swift::swift_retainUnowned_n(HeapObject *object, uint32_t n) {
+  if (!object) return;
+  assert(object->weakRefCount.getCount() &&
+         "object is not currently weakly retained");
+
+  if (! object->refCount.tryIncrementN(n))
+    _swift_abortRetainUnowned(object);
+}
+
 void swift::swift_checkUnowned(HeapObject *object) {
   if (!object) return;
   assert(object->weakRefCount.getCount() &&
@@ -518,6 +595,119 @@ extern "C" void swift_deallocPartialClassInstance(HeapObject *object,
   swift_deallocClassInstance(object, allocatedSize, allocatedAlignMask);
 }
 
+namespace {
+
+/// The out-of-line entry which native weak references point to.
+///
+/// An entry is created the first time a weak reference to an object is
+/// formed. It holds one reference on behalf of the object, which is dropped
+/// when the object is deallocated, plus one for every weak reference to it.
+/// Thus only the entry, and not the object's memory, outlives the object's
+/// last strong and unowned references.
+struct alignas(16) WeakReferenceSideTable {
+  /// Serializes accesses to Object against the deallocation of the object.
+  std::mutex Lock;
+
+  /// The referenced object, or null once it has been deallocated.
+  HeapObject *Object;
+
+  std::atomic<size_t> RefCount;
+
+  explicit WeakReferenceSideTable(HeapObject *object)
+    : Object(object), RefCount(1) {}
+
+  void retain() {
+    RefCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void release() {
+    if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  /// Returns true if the object has not begun deallocation.
+  bool isLive() {
+    std::lock_guard<std::mutex> guard(Lock);
+    return Object && !Object->refCount.isDeallocating();
+  }
+
+  /// Retain and return the object if it has not begun deallocation.
+  HeapObject *tryRetainObject() {
+    std::lock_guard<std::mutex> guard(Lock);
+    return Object ? swift_tryRetain(Object) : nullptr;
+  }
+};
+
+} // end anonymous namespace
+
+/// The side table entries of all live objects that have ever been weakly
+/// referenced.
+static std::mutex WeakReferenceSideTablesLock;
+static std::unordered_map<const HeapObject *, WeakReferenceSideTable *>
+  *WeakReferenceSideTables = nullptr;
+
+/// Return a retained side table entry for the given object, creating one if
+/// needed.
+static WeakReferenceSideTable *getWeakReferenceSideTable(HeapObject *object) {
+  std::lock_guard<std::mutex> guard(WeakReferenceSideTablesLock);
+  if (!WeakReferenceSideTables)
+    WeakReferenceSideTables =
+      new std::unordered_map<const HeapObject *, WeakReferenceSideTable *>();
+
+  auto &entry = (*WeakReferenceSideTables)[object];
+  if (!entry) {
+    entry = new WeakReferenceSideTable(object);
+    object->weakRefCount.setHasSideTable();
+  }
+  entry->retain();
+  return entry;
+}
+
+/// Detach the given object, which is being deallocated, from its side table
+/// entry, so that weak references to it read as null from now on.
+static void clearWeakReferenceSideTable(HeapObject *object) {
+  WeakReferenceSideTable *entry;
+  {
+    std::lock_guard<std::mutex> guard(WeakReferenceSideTablesLock);
+    auto found = WeakReferenceSideTables->find(object);
+    assert(found != WeakReferenceSideTables->end() &&
+           "object flagged as having a side table has none");
+    entry = found->second;
+    WeakReferenceSideTables->erase(found);
+  }
+  {
+    std::lock_guard<std::mutex> guard(entry->Lock);
+    entry->Object = nullptr;
+  }
+  entry->release();
+}
+
+static WeakReferenceSideTable *getSideTable(WeakReference *ref) {
+  auto bits = reinterpret_cast<uintptr_t>(ref->Value);
+  assert((!bits || (bits & WeakReferenceSideTableTag)) &&
+         "native weak reference does not refer to a side table");
+  return reinterpret_cast<WeakReferenceSideTable *>(
+                                          bits & ~WeakReferenceSideTableTag);
+}
+
+static void setSideTable(WeakReference *ref, WeakReferenceSideTable *entry) {
+  if (!entry) {
+    ref->Value = nullptr;
+    return;
+  }
+  auto bits = reinterpret_cast<uintptr_t>(entry) | WeakReferenceSideTableTag;
+  ref->Value = reinterpret_cast<HeapObject *>(bits);
+}
+
+/// Return a retained side table entry to store in a new weak reference to
+/// the given object.  Weak references to objects which have begun
+/// deallocation are null.
+static WeakReferenceSideTable *formWeakReference(HeapObject *object) {
+  if (!object || object->refCount.isDeallocating())
+    return nullptr;
+  return getWeakReferenceSideTable(object);
+}
+
 #if !defined(__APPLE__)
 static inline void memset_pattern8(void *b, const void *pattern8, size_t len) {
   char *ptr = static_cast<char *>(b);
@@ -543,6 +733,12 @@ void swift::swift_deallocObject(HeapObject *object, size_t allocatedSize,
 
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
+  SWIFT_PROFILE_LIFETIME_DEALLOCATION(object);
+
+  // Weak references to the object must observe that it is gone before its
+  // memory can be reused.
+  if (object->weakRefCount.hasSideTable())
+    clearWeakReferenceSideTable(object);
 
   // Drop the initial weak retain of the object.
   //
@@ -622,26 +818,26 @@ extern "C" void swift_fixLifetime(OpaqueValue *value) {
 }
 
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = value;
-  swift_weakRetain(value);
+  setSideTable(ref, formWeakReference(value));
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  swift_weakRetain(newValue);
-  auto oldValue = ref->Value;
-  ref->Value = newValue;
-  swift_weakRelease(oldValue);
+  auto newEntry = formWeakReference(newValue);
+  auto oldEntry = getSideTable(ref);
+  setSideTable(ref, newEntry);
+  if (oldEntry)
+    oldEntry->release();
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  auto object = ref->Value;
-  if (object == nullptr) return nullptr;
-  if (object->refCount.isDeallocating()) {
-    swift_weakRelease(object);
-    ref->Value = nullptr;
-    return nullptr;
-  }
-  return swift_tryRetain(object);
+  auto entry = getSideTable(ref);
+  if (entry == nullptr) return nullptr;
+  if (auto object = entry->tryRetainObject())
+    return object;
+  // The object is gone; there is no need to keep the entry alive.
+  setSideTable(ref, nullptr);
+  entry->release();
+  return nullptr;
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
@@ -651,44 +847,46 @@ HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = ref->Value;
+  auto entry = getSideTable(ref);
   ref->Value = nullptr;
-  swift_weakRelease(tmp);
+  if (entry)
+    entry->release();
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  if (object == nullptr) {
+  auto entry = getSideTable(src);
+  if (entry == nullptr) {
     dest->Value = nullptr;
-  } else if (object->refCount.isDeallocating()) {
+  } else if (!entry->isLive()) {
     src->Value = nullptr;
     dest->Value = nullptr;
-    swift_weakRelease(object);
+    entry->release();
   } else {
-    dest->Value = object;
-    swift_weakRetain(object);
+    setSideTable(dest, entry);
+    entry->retain();
   }
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = src->Value;
-  dest->Value = object;
-  if (object != nullptr && object->refCount.isDeallocating()) {
+  auto entry = getSideTable(src);
+  setSideTable(dest, entry);
+  if (entry != nullptr && !entry->isLive()) {
     dest->Value = nullptr;
-    swift_weakRelease(object);
+    entry->release();
   }
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    swift_weakRelease(object);
+  if (dest == src) return;
+  if (auto entry = getSideTable(dest)) {
+    entry->release();
   }
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (auto object = dest->Value) {
-    swift_weakRelease(object);
+  if (auto entry = getSideTable(dest)) {
+    entry->release();
   }
   swift_weakTakeInit(dest, src);
 }
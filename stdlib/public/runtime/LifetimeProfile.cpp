@@ -0,0 +1,352 @@
+//===--- LifetimeProfile.cpp - Sampled heap object lifetime profile -------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Tracks a sample of heap objects from allocation to deallocation and reports
+// the ones which are still alive, grouped by type and allocation site. Objects
+// kept alive by retain cycles show up as survivors which accumulate over time.
+//
+// Profiling is enabled by starting the process with
+// SWIFT_RUNTIME_LIFETIME_PROFILE set to a file path, or to "-" for stderr. The
+// surviving objects are written there as JSON when the process exits, or
+// whenever swift_lifetimeProfileWrite is called.
+//
+// SWIFT_RUNTIME_LIFETIME_PROFILE_SAMPLE=<n> tracks one in every n allocations
+// on each thread (1024 by default, 1 to track everything); the reported
+// counts are scaled back up by n.
+//
+// SWIFT_RUNTIME_LIFETIME_PROFILE_SIGNAL=<signal number> also writes the
+// profile whenever the process receives that signal, e.g. 12 for SIGUSR2 on
+// Linux. The signal handler only wakes up a reporting thread, so this is safe
+// to use in a running service.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "Private.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+using namespace swift;
+
+std::atomic<bool> swift::_swift_lifetimeProfileActive(true);
+
+namespace {
+
+/// The number of return addresses recorded for each sampled allocation.
+enum { LifetimeProfileMaxFrames = 16 };
+
+/// The frames of the profiler itself and of swift_allocObject, which are
+/// dropped from the recorded allocation site.
+enum { LifetimeProfileSkippedFrames = 2 };
+
+/// A sampled object which has not been deallocated yet.
+struct LiveAllocation {
+  const HeapMetadata *Metadata;
+  size_t Size;
+  unsigned NumFrames;
+  void *Frames[LifetimeProfileMaxFrames];
+};
+
+/// The live sampled objects whose addresses hash to this shard.
+///
+/// Every deallocation has to check whether the object was sampled, so the
+/// table is split up to keep threads from contending on a single lock.
+struct LifetimeProfileShard {
+  std::mutex Lock;
+  std::unordered_map<const HeapObject *, LiveAllocation> Live;
+};
+
+enum { LifetimeProfileNumShards = 64 };
+
+/// The surviving objects of one type allocated at one site.
+struct SurvivorGroup {
+  size_t Objects = 0;
+  size_t Bytes = 0;
+};
+
+} // end anonymous namespace
+
+static std::once_flag LifetimeProfileInitOnce;
+static bool LifetimeProfileEnabled = false;
+static unsigned LifetimeProfileSampleInterval = 1024;
+static const char *LifetimeProfilePath = nullptr;
+static LifetimeProfileShard *LifetimeProfileShards = nullptr;
+
+/// The pipe through which the signal handler wakes up the reporting thread.
+static int LifetimeProfileSignalPipe[2] = { -1, -1 };
+
+static __thread unsigned LifetimeProfileNextSample = 0;
+
+static LifetimeProfileShard &shardForObject(const HeapObject *object) {
+  // The low bits of heap object addresses are always zero.
+  uintptr_t key = reinterpret_cast<uintptr_t>(object) >> 4;
+  return LifetimeProfileShards[(key ^ (key >> 8)) % LifetimeProfileNumShards];
+}
+
+static void writeLifetimeProfileAtExit() {
+  swift_lifetimeProfileWrite(nullptr);
+}
+
+static void handleLifetimeProfileSignal(int) {
+  int savedErrno = errno;
+  char byte = 0;
+  // write() is async-signal-safe. If the pipe is full, a report is already
+  // pending.
+  (void)write(LifetimeProfileSignalPipe[1], &byte, 1);
+  errno = savedErrno;
+}
+
+static void runLifetimeProfileReporter() {
+  char byte;
+  while (true) {
+    ssize_t result = read(LifetimeProfileSignalPipe[0], &byte, 1);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      return;
+    swift_lifetimeProfileWrite(nullptr);
+  }
+}
+
+static void installLifetimeProfileSignalHandler(int signo) {
+  if (pipe(LifetimeProfileSignalPipe) != 0) {
+    fprintf(stderr, "swift runtime: unable to create the lifetime profile "
+                    "signal pipe\n");
+    return;
+  }
+  // Never block in the signal handler.
+  fcntl(LifetimeProfileSignalPipe[1], F_SETFL, O_NONBLOCK);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handleLifetimeProfileSignal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(signo, &action, nullptr) != 0) {
+    fprintf(stderr, "swift runtime: unable to install the lifetime profile "
+                    "handler for signal %d\n", signo);
+    return;
+  }
+
+  std::thread(runLifetimeProfileReporter).detach();
+}
+
+static void initializeLifetimeProfile() {
+  const char *path = getenv("SWIFT_RUNTIME_LIFETIME_PROFILE");
+  if (!path || !path[0]) {
+    _swift_lifetimeProfileActive.store(false, std::memory_order_relaxed);
+    return;
+  }
+
+  if (const char *interval = getenv("SWIFT_RUNTIME_LIFETIME_PROFILE_SAMPLE")) {
+    unsigned long parsed = strtoul(interval, nullptr, 10);
+    if (parsed > 0)
+      LifetimeProfileSampleInterval = parsed;
+  }
+
+  LifetimeProfilePath = path;
+  LifetimeProfileShards = new LifetimeProfileShard[LifetimeProfileNumShards];
+  LifetimeProfileEnabled = true;
+  atexit(writeLifetimeProfileAtExit);
+
+  if (const char *signal = getenv("SWIFT_RUNTIME_LIFETIME_PROFILE_SIGNAL")) {
+    int signo = atoi(signal);
+    if (signo > 0)
+      installLifetimeProfileSignalHandler(signo);
+  }
+}
+
+/// Decide whether the current allocation should be sampled.
+static bool shouldSample() {
+  if (LifetimeProfileNextSample) {
+    --LifetimeProfileNextSample;
+    return false;
+  }
+  LifetimeProfileNextSample = LifetimeProfileSampleInterval - 1;
+  return true;
+}
+
+LLVM_ATTRIBUTE_NOINLINE
+void swift::_swift_lifetimeProfileAllocation(HeapObject *object,
+                                             const HeapMetadata *metadata,
+                                             size_t size) {
+  std::call_once(LifetimeProfileInitOnce, initializeLifetimeProfile);
+  if (!LifetimeProfileEnabled || !shouldSample())
+    return;
+
+  LiveAllocation allocation;
+  allocation.Metadata = metadata;
+  allocation.Size = size;
+
+  // Capture the stack before taking the lock.
+  void *frames[LifetimeProfileMaxFrames + LifetimeProfileSkippedFrames];
+  int numFrames = backtrace(frames, LifetimeProfileMaxFrames +
+                                    LifetimeProfileSkippedFrames);
+  int skipped = std::min(numFrames, int(LifetimeProfileSkippedFrames));
+  allocation.NumFrames = numFrames - skipped;
+  std::copy(frames + skipped, frames + numFrames, allocation.Frames);
+
+  auto &shard = shardForObject(object);
+  std::lock_guard<std::mutex> guard(shard.Lock);
+  shard.Live[object] = allocation;
+}
+
+void swift::_swift_lifetimeProfileDeallocation(HeapObject *object) {
+  std::call_once(LifetimeProfileInitOnce, initializeLifetimeProfile);
+  if (!LifetimeProfileEnabled)
+    return;
+
+  auto &shard = shardForObject(object);
+  std::lock_guard<std::mutex> guard(shard.Lock);
+  shard.Live.erase(object);
+}
+
+/// Return a printable name for the objects described by the given heap
+/// metadata.
+static std::string nameForHeapMetadata(const HeapMetadata *metadata) {
+  switch (metadata->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+    return "<<<box>>>";
+  case MetadataKind::HeapGenericLocalVariable:
+    return "<<<generic box>>>";
+  case MetadataKind::ErrorObject:
+    return "<<<error object>>>";
+  default:
+    return nameForMetadata(metadata);
+  }
+}
+
+/// Return a printable description of a return address.
+static std::string describeFrame(void *address) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%p", address);
+  std::string result = buffer;
+
+  Dl_info info;
+  if (dladdr(address, &info) && info.dli_sname) {
+    snprintf(buffer, sizeof(buffer), "+%zu",
+             size_t((const char *)address - (const char *)info.dli_saddr));
+    result += " ";
+    result += info.dli_sname;
+    result += buffer;
+  }
+  return result;
+}
+
+/// Write \p str to \p out as a JSON string literal.
+static void writeJSONString(FILE *out, const std::string &str) {
+  fputc('"', out);
+  for (char c : str) {
+    switch (c) {
+    case '"': fputs("\\\"", out); break;
+    case '\\': fputs("\\\\", out); break;
+    case '\n': fputs("\\n", out); break;
+    case '\t': fputs("\\t", out); break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        fprintf(out, "\\u%04x", c);
+      else
+        fputc(c, out);
+      break;
+    }
+  }
+  fputc('"', out);
+}
+
+void swift::swift_lifetimeProfileWrite(const char *path) {
+  std::call_once(LifetimeProfileInitOnce, initializeLifetimeProfile);
+  if (!LifetimeProfileEnabled)
+    return;
+
+  // Group the survivors one shard at a time, so that allocation and
+  // deallocation are never blocked for long. Computing names (which may
+  // allocate and retain) happens without holding any lock.
+  using SiteKey = std::pair<const HeapMetadata *, std::vector<void *>>;
+  std::map<SiteKey, SurvivorGroup> groups;
+  for (unsigned i = 0; i != LifetimeProfileNumShards; ++i) {
+    auto &shard = LifetimeProfileShards[i];
+    std::lock_guard<std::mutex> guard(shard.Lock);
+    for (const auto &entry : shard.Live) {
+      const LiveAllocation &allocation = entry.second;
+      SiteKey key(allocation.Metadata,
+                  std::vector<void *>(allocation.Frames,
+                                      allocation.Frames +
+                                        allocation.NumFrames));
+      auto &group = groups[key];
+      group.Objects += LifetimeProfileSampleInterval;
+      group.Bytes += allocation.Size * LifetimeProfileSampleInterval;
+    }
+  }
+
+  // Report the sites responsible for the most surviving memory first.
+  std::vector<std::pair<SiteKey, SurvivorGroup>> entries(groups.begin(),
+                                                         groups.end());
+  std::sort(entries.begin(), entries.end(),
+            [](const std::pair<SiteKey, SurvivorGroup> &lhs,
+               const std::pair<SiteKey, SurvivorGroup> &rhs) {
+    if (lhs.second.Bytes != rhs.second.Bytes)
+      return lhs.second.Bytes > rhs.second.Bytes;
+    return lhs.second.Objects > rhs.second.Objects;
+  });
+
+  if (!path)
+    path = LifetimeProfilePath;
+  bool toStderr = strcmp(path, "-") == 0;
+  FILE *out = toStderr ? stderr : fopen(path, "w");
+  if (!out) {
+    fprintf(stderr, "swift runtime: unable to write lifetime profile to %s\n",
+            path);
+    return;
+  }
+
+  fprintf(out, "{\n  \"sampleInterval\": %u,\n  \"survivors\": [",
+          LifetimeProfileSampleInterval);
+  bool first = true;
+  for (const auto &entry : entries) {
+    fputs(first ? "\n    {\"name\": " : ",\n    {\"name\": ", out);
+    first = false;
+    writeJSONString(out, nameForHeapMetadata(entry.first.first));
+    fprintf(out, ", \"objects\": %zu, \"bytes\": %zu, \"allocationSite\": [",
+            entry.second.Objects, entry.second.Bytes);
+    bool firstFrame = true;
+    for (void *frame : entry.first.second) {
+      if (!firstFrame)
+        fputs(", ", out);
+      firstFrame = false;
+      writeJSONString(out, describeFrame(frame));
+    }
+    fputs("]}", out);
+  }
+  fputs("\n  ]\n}\n", out);
+
+  if (toStderr)
+    fflush(out);
+  else
+    fclose(out);
+}
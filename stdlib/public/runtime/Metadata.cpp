@@ -71,23 +71,33 @@ void *MetadataAllocator::alloc(size_t size) {
     return mem;
   }
   
-  char *end = next + size;
-  
-  // Allocate a new page if we need one.
-  if (LLVM_UNLIKELY(((uintptr_t)next & ~pagesizeMask)
-                      != (((uintptr_t)end & ~pagesizeMask)))){
-    next = (char*)
-      mmap(nullptr, pagesizeMask+1, PROT_READ|PROT_WRITE,
-           MAP_ANON|MAP_PRIVATE, VM_TAG_FOR_SWIFT_METADATA, 0);
-
-    if (next == MAP_FAILED)
-      crash("unable to allocate memory for metadata cache");
-    end = next + size;
+  char *curr = next.load(std::memory_order_relaxed);
+  while (true) {
+    char *end = curr + size;
+
+    // Allocate a new page if we need one.
+    if (LLVM_UNLIKELY(((uintptr_t)curr & ~pagesizeMask)
+                        != (((uintptr_t)end & ~pagesizeMask)))){
+      char *page = (char*)
+        mmap(nullptr, pagesizeMask+1, PROT_READ|PROT_WRITE,
+             MAP_ANON|MAP_PRIVATE, VM_TAG_FOR_SWIFT_METADATA, 0);
+
+      if (page == MAP_FAILED)
+        crash("unable to allocate memory for metadata cache");
+
+      // If another thread replaced the page first, give ours back and retry
+      // in the page it installed.
+      if (!next.compare_exchange_strong(curr, page + size,
+                                        std::memory_order_relaxed)) {
+        munmap(page, pagesizeMask+1);
+        continue;
+      }
+      return page;
+    }
+
+    if (next.compare_exchange_weak(curr, end, std::memory_order_relaxed))
+      return curr;
   }
-  
-  char *addr = next;
-  next = end;
-  return addr;
 }
 
 namespace {
@@ -261,6 +271,10 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
       return entry;
     });
 
+  if (LLVM_UNLIKELY(
+        _swift_genericMetadataProfileActive.load(std::memory_order_relaxed)))
+    _swift_genericMetadataProfileRequest(entry->Value);
+
   return entry->Value;
 }
 
@@ -16,8 +16,10 @@
 #include "llvm/ADT/STLExtras.h"
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
-#include <mutex>
+#include <atomic>
 #include <condition_variable>
+#include <cstring>
+#include <mutex>
 
 #ifndef SWIFT_DEBUG_RUNTIME
 #define SWIFT_DEBUG_RUNTIME 0
@@ -140,23 +142,42 @@ public:
 
 /// The implementation of a metadata cache.  Note that all-zero must
 /// be a valid state for the cache.
+///
+/// Lookups that hit the cache never take a lock: they find the bucket with a
+/// read-only search of the concurrent map and walk it. On a miss, the
+/// construction lock is only held long enough to claim the key by inserting
+/// an entry in the "being constructed" state; the entry itself is built
+/// without the lock, so unrelated instantiations do not block each other.
+/// Threads that race to instantiate the same key wait for the first one to
+/// publish its result.
 template <class Entry> class MetadataCache {
 
-  /// This pair ties an EntryRef Key and an Entry Value.
+  /// This pair ties an EntryRef Key and an Entry Value. A null Value means
+  /// that the entry is still being constructed by some thread.
   struct EntryPair {
     EntryPair(EntryRef<Entry> K, Entry* V) : Key(K), Value(V) {}
+    EntryPair(const EntryPair &other)
+      : Key(other.Key), Value(other.Value.load(std::memory_order_acquire)) {}
     EntryRef<Entry> Key;
-    Entry* Value;
+    std::atomic<Entry*> Value;
   };
 
   /// This collection maps hash codes to a list of entry pairs.
   typedef ConcurrentMap<size_t, EntryPair> MDMapTy;
 
+  /// Synchronization of metadata creation.
+  struct ConstructionState {
+    /// Guards claiming keys, publishing entries and the Head list.
+    std::mutex Lock;
+    /// Signalled whenever an entry finishes construction.
+    std::condition_variable Published;
+  };
+
   /// This map hash codes of entry refs to a list of entry pairs.
   MDMapTy *Map;
 
   /// Synchronization of metadata creation.
-  std::mutex *Lock;
+  ConstructionState *Construction;
   
   /// The head of a linked list connecting all the metadata cache entries.
   /// TODO: Remove this when LLDB is able to understand the final data
@@ -167,16 +188,15 @@ template <class Entry> class MetadataCache {
   MetadataAllocator Allocator;
   
 public:
-  MetadataCache() : Map(new MDMapTy()), Lock(new std::mutex()) {}
-  ~MetadataCache() { delete Map; delete Lock; }
+  MetadataCache() : Map(new MDMapTy()), Construction(new ConstructionState()) {}
+  ~MetadataCache() { delete Map; delete Construction; }
 
   /// Caches are not copyable.
   MetadataCache(const MetadataCache &other) = delete;
   MetadataCache &operator=(const MetadataCache &other) = delete;
 
   /// Get the allocator for metadata in this cache.
-  /// The allocator can only be safely used while the cache is locked during
-  /// an addMetadataEntry call.
+  /// The allocator is thread-safe, so entry builders may use it concurrently.
   MetadataAllocator &getAllocator() { return Allocator; }
 
   /// Call entryBuilder() and add the generated metadata to the cache.
@@ -189,36 +209,59 @@ public:
   const Entry *addMetadataEntry(EntryRef<Entry> key,
                                 ConcurrentList<EntryPair> &Bucket,
                                 llvm::function_ref<Entry *()> entryBuilder) {
-    // Hold a lock to prevent the modification of the cache by multiple threads.
-    std::unique_lock<std::mutex> ConstructionGuard(*Lock);
-
-    // Some other thread may have setup the value we are about to construct
-    // while we were asleep so do a search before constructing a new value.
-    for (auto &A : Bucket) {
-      if (A.Key == key) return A.Value;
+    EntryPair *claimed = nullptr;
+    {
+      std::unique_lock<std::mutex> guard(Construction->Lock);
+
+      // Some other thread may have setup or claimed the value we are about to
+      // construct while we were asleep so do a search before claiming it.
+      // Claims are only made under the lock, so there are no duplicates.
+      for (auto &A : Bucket) {
+        if (!(A.Key == key)) continue;
+
+        // Wait for the thread constructing the entry to publish it.
+        Entry *value;
+        Construction->Published.wait(guard, [&] {
+          value = A.Value.load(std::memory_order_acquire);
+          return value != nullptr;
+        });
+        return value;
+      }
+
+      // Claim the key. The arguments are copied because the caller's buffer
+      // does not outlive this call, but other threads compare against the key
+      // until the entry is published.
+      size_t argsSize = key.size() * sizeof(void*);
+      auto args = reinterpret_cast<const void **>(Allocator.alloc(argsSize));
+      memcpy(args, key.begin(), argsSize);
+      Bucket.push_front(
+          EntryPair(EntryRef<Entry>::forArguments(args, key.size()), nullptr));
+      claimed = &*Bucket.begin();
     }
 
-    // Build the new cache entry.
+    // Build the new cache entry without holding the lock.
     // For some cache types this call may re-entrantly perform additional
     // cache lookups.
-    // Notice that the entry is completly constructed before it is inserted
-    // into the map, and that only one entry can be constructed at once
-    // because of the lock above.
+    // Notice that the entry is completly constructed before it is published.
     Entry *entry = entryBuilder();
     assert(entry);
 
-    // Update the linked list.
-    entry->Next = Head;
-    Head = entry;
+    {
+      std::lock_guard<std::mutex> guard(Construction->Lock);
+
+      // Update the linked list.
+      entry->Next = Head;
+      Head = entry;
 
-    key = EntryRef<Entry>::forEntry(entry, entry->getNumArguments());
-    Bucket.push_front(EntryPair(key, entry));
+      claimed->Value.store(entry, std::memory_order_release);
+    }
+    Construction->Published.notify_all();
 
 #if SWIFT_DEBUG_RUNTIME
     printf("%s(%p): created %p\n",
            Entry::getName(), this, entry);
 #endif
-    return key.getEntry();
+    return entry;
   }
 
   /// Look up a cached metadata entry. If a cache match exists, return it.
@@ -242,15 +285,20 @@ public:
            Entry::getName(), this, hash);
 #endif
 
-    // Look for an existing entry.
-    // Find the bucket for the metadata entry.
-    ConcurrentList<EntryPair> &Bucket = Map->findOrAllocateNode(hash);
-    // Scan the bucket and return the value if we found the key.
-    for (auto &A : Bucket) {
-      if (A.Key == key) return A.Value;
+    // Look for an existing, fully constructed entry without writing to the
+    // map.
+    if (ConcurrentList<EntryPair> *Bucket = Map->find(hash)) {
+      for (auto &A : *Bucket) {
+        if (!(A.Key == key)) continue;
+        if (Entry *value = A.Value.load(std::memory_order_acquire))
+          return value;
+        // The entry is being constructed by another thread.
+        return addMetadataEntry(key, *Bucket, entryBuilder);
+      }
     }
 
     // We did not find a key so we will need to create one and store it.
+    ConcurrentList<EntryPair> &Bucket = Map->findOrAllocateNode(hash);
     return addMetadataEntry(key, Bucket, entryBuilder);
   }
 };
@@ -0,0 +1,90 @@
+//===--- MetadataPrefetch.cpp - Eager generic metadata instantiation ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Instantiates the generic type metadata used by an image before the program
+// asks for it.
+//
+// Modules compiled with -emit-metadata-prefetch-table register a table of the
+// accessors of the generic type metadata they use from a global constructor.
+// A background thread calls the accessors, which fills both the runtime's
+// metadata caches and the accessors' own cache variables, so that the first
+// request for e.g. Array<String> on a program thread is usually a cache hit.
+// The thread exits once all registered tables are processed, and is started
+// again if another image registers a table later.
+//
+// Prefetching is turned off by starting the process with
+// SWIFT_RUNTIME_DISABLE_METADATA_PREFETCH set.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Metadata.h"
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+
+struct MetadataPrefetchState {
+  std::mutex Lock;
+
+  /// The tables which are not processed yet.
+  std::vector<std::pair<const MetadataAccessor *, const MetadataAccessor *>>
+    Pending;
+
+  /// Whether the background thread is running.
+  bool WorkerRunning = false;
+
+  bool Disabled;
+
+  MetadataPrefetchState()
+    : Disabled(getenv("SWIFT_RUNTIME_DISABLE_METADATA_PREFETCH") != nullptr) {}
+
+  void runWorker() {
+    std::unique_lock<std::mutex> guard(Lock);
+    while (!Pending.empty()) {
+      auto table = Pending.back();
+      Pending.pop_back();
+
+      // Instantiating metadata can take the metadata cache locks and call
+      // back into the runtime, so don't hold our lock meanwhile.
+      guard.unlock();
+      for (auto accessor = table.first; accessor != table.second; ++accessor)
+        (void) (*accessor)();
+      guard.lock();
+    }
+    WorkerRunning = false;
+  }
+};
+
+} // end anonymous namespace
+
+static Lazy<MetadataPrefetchState> MetadataPrefetch;
+
+void swift::swift_prefetchGenericMetadata(const MetadataAccessor *begin,
+                                          const MetadataAccessor *end) {
+  auto &state = MetadataPrefetch.get();
+  if (state.Disabled || begin == end)
+    return;
+
+  std::lock_guard<std::mutex> guard(state.Lock);
+  state.Pending.push_back({begin, end});
+  if (state.WorkerRunning)
+    return;
+
+  state.WorkerRunning = true;
+  std::thread([&state] { state.runWorker(); }).detach();
+}
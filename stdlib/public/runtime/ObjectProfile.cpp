@@ -0,0 +1,219 @@
+//===--- ObjectProfile.cpp - Sampled per-type heap object profile ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Attributes heap allocations and reference counting traffic to the heap
+// metadata of the objects involved.
+//
+// Profiling is enabled by starting the process with
+// SWIFT_RUNTIME_OBJECT_PROFILE set to a file path, or to "-" for stderr. The
+// profile is written there as JSON when the process exits, or whenever
+// swift_objectProfileWrite is called.
+//
+// SWIFT_RUNTIME_OBJECT_PROFILE_SAMPLE=<n> records one in every n allocations
+// and one in every n retains or releases on each thread (64 by default, 1 to
+// record everything); the reported counts are scaled back up by n.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "Private.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace swift;
+
+std::atomic<bool> swift::_swift_objectProfileActive(true);
+
+namespace {
+
+/// The sampled events recorded for one kind of heap object.
+struct ObjectProfileCounters {
+  size_t Allocations = 0;
+  size_t AllocatedBytes = 0;
+  size_t Retains = 0;
+  size_t Releases = 0;
+};
+
+/// Countdowns to the next sampled event on the current thread.
+struct ObjectProfileThreadState {
+  unsigned NextAllocationSample = 0;
+  unsigned NextRefcountSample = 0;
+};
+
+} // end anonymous namespace
+
+static std::once_flag ObjectProfileInitOnce;
+static bool ObjectProfileEnabled = false;
+static unsigned ObjectProfileSampleInterval = 64;
+static const char *ObjectProfilePath = nullptr;
+static std::mutex ObjectProfileLock;
+static std::unordered_map<const HeapMetadata *, ObjectProfileCounters>
+  *ObjectProfileTable = nullptr;
+
+static __thread ObjectProfileThreadState ObjectProfileLocalState;
+
+static void writeObjectProfileAtExit() {
+  swift_objectProfileWrite(nullptr);
+}
+
+static void initializeObjectProfile() {
+  const char *path = getenv("SWIFT_RUNTIME_OBJECT_PROFILE");
+  if (!path || !path[0]) {
+    _swift_objectProfileActive.store(false, std::memory_order_relaxed);
+    return;
+  }
+
+  if (const char *interval = getenv("SWIFT_RUNTIME_OBJECT_PROFILE_SAMPLE")) {
+    unsigned long parsed = strtoul(interval, nullptr, 10);
+    if (parsed > 0)
+      ObjectProfileSampleInterval = parsed;
+  }
+
+  ObjectProfilePath = path;
+  ObjectProfileTable =
+    new std::unordered_map<const HeapMetadata *, ObjectProfileCounters>();
+  ObjectProfileEnabled = true;
+  atexit(writeObjectProfileAtExit);
+}
+
+/// Decide whether the current event should be sampled, using the given
+/// per-thread countdown.
+static bool shouldSample(unsigned &countdown) {
+  if (countdown) {
+    --countdown;
+    return false;
+  }
+  countdown = ObjectProfileSampleInterval - 1;
+  return true;
+}
+
+void swift::_swift_objectProfileAllocation(const HeapMetadata *metadata,
+                                           size_t size) {
+  std::call_once(ObjectProfileInitOnce, initializeObjectProfile);
+  if (!ObjectProfileEnabled ||
+      !shouldSample(ObjectProfileLocalState.NextAllocationSample))
+    return;
+
+  std::lock_guard<std::mutex> guard(ObjectProfileLock);
+  auto &counters = (*ObjectProfileTable)[metadata];
+  counters.Allocations += ObjectProfileSampleInterval;
+  counters.AllocatedBytes += size * ObjectProfileSampleInterval;
+}
+
+void swift::_swift_objectProfileRefcount(HeapObject *object, bool isRetain,
+                                         uint32_t n) {
+  std::call_once(ObjectProfileInitOnce, initializeObjectProfile);
+  if (!ObjectProfileEnabled || !object ||
+      !shouldSample(ObjectProfileLocalState.NextRefcountSample))
+    return;
+
+  std::lock_guard<std::mutex> guard(ObjectProfileLock);
+  auto &counters = (*ObjectProfileTable)[object->metadata];
+  if (isRetain)
+    counters.Retains += size_t(n) * ObjectProfileSampleInterval;
+  else
+    counters.Releases += size_t(n) * ObjectProfileSampleInterval;
+}
+
+/// Return a printable name for the objects described by the given heap
+/// metadata.
+static std::string nameForHeapMetadata(const HeapMetadata *metadata) {
+  switch (metadata->getKind()) {
+  case MetadataKind::HeapLocalVariable:
+    return "<<<box>>>";
+  case MetadataKind::HeapGenericLocalVariable:
+    return "<<<generic box>>>";
+  case MetadataKind::ErrorObject:
+    return "<<<error object>>>";
+  default:
+    return nameForMetadata(metadata);
+  }
+}
+
+/// Write \p str to \p out as a JSON string literal.
+static void writeJSONString(FILE *out, const std::string &str) {
+  fputc('"', out);
+  for (char c : str) {
+    switch (c) {
+    case '"': fputs("\\\"", out); break;
+    case '\\': fputs("\\\\", out); break;
+    case '\n': fputs("\\n", out); break;
+    case '\t': fputs("\\t", out); break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20)
+        fprintf(out, "\\u%04x", c);
+      else
+        fputc(c, out);
+      break;
+    }
+  }
+  fputc('"', out);
+}
+
+void swift::swift_objectProfileWrite(const char *path) {
+  std::call_once(ObjectProfileInitOnce, initializeObjectProfile);
+  if (!ObjectProfileEnabled)
+    return;
+
+  // Take a snapshot, so that computing names (which may allocate and
+  // retain) happens without holding the lock.
+  std::vector<std::pair<const HeapMetadata *, ObjectProfileCounters>> entries;
+  {
+    std::lock_guard<std::mutex> guard(ObjectProfileLock);
+    entries.assign(ObjectProfileTable->begin(), ObjectProfileTable->end());
+  }
+
+  // Report the types responsible for the most traffic first.
+  std::sort(entries.begin(), entries.end(),
+            [](const std::pair<const HeapMetadata *, ObjectProfileCounters> &lhs,
+               const std::pair<const HeapMetadata *, ObjectProfileCounters> &rhs) {
+    if (lhs.second.AllocatedBytes != rhs.second.AllocatedBytes)
+      return lhs.second.AllocatedBytes > rhs.second.AllocatedBytes;
+    return lhs.second.Retains + lhs.second.Releases
+             > rhs.second.Retains + rhs.second.Releases;
+  });
+
+  if (!path)
+    path = ObjectProfilePath;
+  bool toStderr = strcmp(path, "-") == 0;
+  FILE *out = toStderr ? stderr : fopen(path, "w");
+  if (!out) {
+    fprintf(stderr, "swift runtime: unable to write object profile to %s\n",
+            path);
+    return;
+  }
+
+  fprintf(out, "{\n  \"sampleInterval\": %u,\n  \"types\": [",
+          ObjectProfileSampleInterval);
+  bool first = true;
+  for (const auto &entry : entries) {
+    fputs(first ? "\n    {\"name\": " : ",\n    {\"name\": ", out);
+    first = false;
+    writeJSONString(out, nameForHeapMetadata(entry.first));
+    fprintf(out, ", \"allocations\": %zu, \"allocatedBytes\": %zu, "
+                 "\"retains\": %zu, \"releases\": %zu}",
+            entry.second.Allocations, entry.second.AllocatedBytes,
+            entry.second.Retains, entry.second.Releases);
+  }
+  fputs("\n  ]\n}\n", out);
+
+  if (!toStderr)
+    fclose(out);
+}
@@ -16,6 +16,9 @@
 
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <type_traits>
 
 using namespace swift;
@@ -27,6 +30,26 @@ using namespace swift;
 #include <dispatch/dispatch.h>
 static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
               "swift_once_t and dispatch_once_t must stay in sync");
+#else
+
+// Elsewhere, the predicate goes from 0 (not started) to 1 (running) to -1
+// (done). The compiler checks for -1 with an acquire load before calling
+// swift_once, so the done state must be published with release semantics.
+
+enum : swift_once_t {
+  OnceNotStarted = 0,
+  OnceRunning = 1,
+  OnceDone = -1
+};
+
+static_assert(sizeof(std::atomic<swift_once_t>) == sizeof(swift_once_t),
+              "swift_once_t must be usable as an atomic");
+
+/// Threads which find an initialization running wait on OnceDoneCondition.
+/// Completing an initialization is rare, so all predicates share one lock.
+static std::mutex OnceLock;
+static std::condition_variable OnceDoneCondition;
+
 #endif
 // The compiler generates the swift_once_t values as word-sized zero-initialized
 // variables, so we want to make sure swift_once_t isn't larger than the
@@ -41,12 +64,28 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #if defined(__APPLE__)
   dispatch_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  auto *state = reinterpret_cast<std::atomic<swift_once_t> *>(predicate);
+  if (state->load(std::memory_order_acquire) == OnceDone)
+    return;
+
+  swift_once_t expected = OnceNotStarted;
+  if (state->compare_exchange_strong(expected, OnceRunning,
+                                     std::memory_order_acquire)) {
+    // Run the initializer without holding the lock, since it may initialize
+    // other globals.
+    fn(nullptr);
+    {
+      std::lock_guard<std::mutex> guard(OnceLock);
+      state->store(OnceDone, std::memory_order_release);
+    }
+    OnceDoneCondition.notify_all();
+    return;
+  }
+
+  // Another thread is running the initializer.
+  std::unique_lock<std::mutex> guard(OnceLock);
+  OnceDoneCondition.wait(guard, [state] {
+    return state->load(std::memory_order_acquire) == OnceDone;
+  });
 #endif
 }
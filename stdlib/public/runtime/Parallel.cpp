@@ -0,0 +1,210 @@
+//===--- Parallel.cpp - Work-stealing pool for the parallel algorithms ----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// A small pool of worker threads used by the parallel collection algorithms
+// of the standard library.
+//
+// A job is a range of iterations.  It is split evenly between the calling
+// thread and the workers; each participant executes grain-sized chunks from
+// the front of its own range, and once that is exhausted steals the back half
+// of another participant's range.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "../SwiftShims/RuntimeShims.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+
+using ParallelForBody = void (*)(void *context, size_t begin, size_t end);
+
+/// The part of a job's iterations that one participant works on.
+struct alignas(64) ParallelForSlot {
+  std::mutex Lock;
+  size_t Begin = 0;
+  size_t End = 0;
+};
+
+/// A range of iterations being executed by the pool.
+struct ParallelForJob {
+  ParallelForBody Body;
+  void *Context;
+  size_t GrainSize;
+  unsigned NumSlots;
+  std::unique_ptr<ParallelForSlot[]> Slots;
+
+  /// The number of slots handed out to participants so far.  Protected by
+  /// the pool lock.
+  unsigned NextSlot = 0;
+
+  /// The number of workers that joined the job and have not finished yet.
+  /// Protected by the pool lock.
+  unsigned ActiveWorkers = 0;
+
+  /// Take the next chunk from the front of the given slot.
+  bool takeChunk(ParallelForSlot &slot, size_t &begin, size_t &end) {
+    std::lock_guard<std::mutex> guard(slot.Lock);
+    if (slot.Begin == slot.End)
+      return false;
+    begin = slot.Begin;
+    end = begin + std::min(GrainSize, slot.End - begin);
+    slot.Begin = end;
+    return true;
+  }
+
+  /// Steal the back half of some other participant's range into \p own.
+  bool steal(unsigned own) {
+    for (unsigned i = 1; i != NumSlots; ++i) {
+      ParallelForSlot &victim = Slots[(own + i) % NumSlots];
+      size_t begin, end;
+      {
+        std::lock_guard<std::mutex> guard(victim.Lock);
+        size_t remaining = victim.End - victim.Begin;
+        if (remaining == 0)
+          continue;
+        // A range no larger than a chunk is taken whole.
+        begin = remaining <= GrainSize
+          ? victim.Begin : victim.Begin + remaining / 2;
+        end = victim.End;
+        victim.End = begin;
+      }
+      std::lock_guard<std::mutex> guard(Slots[own].Lock);
+      Slots[own].Begin = begin;
+      Slots[own].End = end;
+      return true;
+    }
+    return false;
+  }
+
+  /// Execute chunks until no participant has any iterations left.
+  void run(unsigned own) {
+    do {
+      size_t begin, end;
+      while (takeChunk(Slots[own], begin, end))
+        Body(Context, begin, end);
+    } while (steal(own));
+  }
+};
+
+class ParallelForPool {
+  std::mutex Lock;
+  std::condition_variable JobAvailable;
+  std::condition_variable WorkersFinished;
+  ParallelForJob *CurrentJob = nullptr;
+  unsigned NumWorkers = 0;
+
+  /// Serializes jobs; a job submitted while another one runs is executed
+  /// serially by the submitting thread instead.
+  std::mutex SubmitLock;
+
+  void workerMain();
+
+public:
+  ParallelForPool();
+
+  void parallelFor(size_t iterations, size_t grainSize,
+                   ParallelForBody body, void *context);
+};
+
+} // end anonymous namespace
+
+/// Set on the pool's worker threads, and on a thread while it submits a job,
+/// so that nested parallel loops run serially instead of deadlocking.
+static __thread bool InsideParallelFor = false;
+
+ParallelForPool::ParallelForPool() {
+  unsigned concurrency = std::thread::hardware_concurrency();
+  if (concurrency <= 1)
+    return;
+  NumWorkers = concurrency - 1;
+  for (unsigned i = 0; i != NumWorkers; ++i)
+    std::thread([this] { workerMain(); }).detach();
+}
+
+void ParallelForPool::workerMain() {
+  InsideParallelFor = true;
+  std::unique_lock<std::mutex> guard(Lock);
+  while (true) {
+    JobAvailable.wait(guard, [&] {
+      return CurrentJob && CurrentJob->NextSlot != CurrentJob->NumSlots;
+    });
+    ParallelForJob *job = CurrentJob;
+    unsigned slot = job->NextSlot++;
+    ++job->ActiveWorkers;
+
+    guard.unlock();
+    job->run(slot);
+    guard.lock();
+
+    if (--job->ActiveWorkers == 0)
+      WorkersFinished.notify_all();
+  }
+}
+
+void ParallelForPool::parallelFor(size_t iterations, size_t grainSize,
+                                  ParallelForBody body, void *context) {
+  if (grainSize == 0)
+    grainSize = 1;
+
+  std::unique_lock<std::mutex> submitGuard(SubmitLock, std::defer_lock);
+  if (NumWorkers == 0 || iterations <= grainSize || InsideParallelFor ||
+      !submitGuard.try_lock()) {
+    body(context, 0, iterations);
+    return;
+  }
+
+  ParallelForJob job;
+  job.Body = body;
+  job.Context = context;
+  job.GrainSize = grainSize;
+  job.NumSlots = std::min<size_t>(NumWorkers + 1,
+                                  (iterations + grainSize - 1) / grainSize);
+  job.Slots.reset(new ParallelForSlot[job.NumSlots]);
+  for (unsigned i = 0; i != job.NumSlots; ++i) {
+    job.Slots[i].Begin = iterations * i / job.NumSlots;
+    job.Slots[i].End = iterations * (i + 1) / job.NumSlots;
+  }
+  // The calling thread works on the first slot.
+  job.NextSlot = 1;
+
+  {
+    std::lock_guard<std::mutex> guard(Lock);
+    CurrentJob = &job;
+  }
+  JobAvailable.notify_all();
+
+  InsideParallelFor = true;
+  job.run(0);
+  InsideParallelFor = false;
+
+  // Workers that have not joined yet won't find any work; retract the job
+  // and wait for the ones that did.
+  std::unique_lock<std::mutex> guard(Lock);
+  CurrentJob = nullptr;
+  WorkersFinished.wait(guard, [&] { return job.ActiveWorkers == 0; });
+}
+
+static Lazy<ParallelForPool> Pool;
+
+extern "C" void _swift_stdlib_parallelFor(size_t iterations, size_t grainSize,
+                                          ParallelForBody body,
+                                          void *context) {
+  Pool->parallelFor(iterations, grainSize, body, context);
+}
@@ -20,6 +20,7 @@
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
 #include "llvm/Support/Compiler.h"
+#include <atomic>
 
 namespace swift {
   struct ProtocolDescriptor;
@@ -41,6 +42,46 @@ namespace swift {
   extern "C" LLVM_LIBRARY_VISIBILITY LLVM_ATTRIBUTE_NORETURN
   void _swift_abortRetainUnowned(const void *object);
 
+  /// False once the object profiler is known to be disabled, so that the
+  /// heap entry points can skip it with a single load.
+  LLVM_LIBRARY_VISIBILITY
+  extern std::atomic<bool> _swift_objectProfileActive;
+
+  /// Record an allocation of \p size bytes for the object profiler.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_objectProfileAllocation(const HeapMetadata *metadata,
+                                      size_t size);
+
+  /// Record \p n retains or releases of \p object for the object profiler.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_objectProfileRefcount(HeapObject *object, bool isRetain,
+                                    uint32_t n);
+
+  /// False once the lifetime profiler is known to be disabled, so that the
+  /// heap entry points can skip it with a single load.
+  LLVM_LIBRARY_VISIBILITY
+  extern std::atomic<bool> _swift_lifetimeProfileActive;
+
+  /// Record the allocation of \p object for the lifetime profiler.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_lifetimeProfileAllocation(HeapObject *object,
+                                        const HeapMetadata *metadata,
+                                        size_t size);
+
+  /// Record the deallocation of \p object for the lifetime profiler.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_lifetimeProfileDeallocation(HeapObject *object);
+
+  /// False once the generic metadata profiler is known to be disabled, so
+  /// that swift_getGenericMetadata can skip it with a single load.
+  LLVM_LIBRARY_VISIBILITY
+  extern std::atomic<bool> _swift_genericMetadataProfileActive;
+
+  /// Record a request for the generic type metadata \p metadata for the
+  /// generic metadata profiler.
+  LLVM_LIBRARY_VISIBILITY
+  void _swift_genericMetadataProfileRequest(const Metadata *metadata);
+
   /// Is the given value a valid alignment mask?
   static inline bool isAlignmentMask(size_t mask) {
     // mask          == xyz01111...
@@ -80,6 +121,18 @@ namespace swift {
     return object == nullptr || isObjCTaggedPointer(object);
   }
 
+  /// The bit set in WeakReference::Value when it refers to the weak
+  /// reference side table entry of a native Swift object.  Side table
+  /// entries and Objective-C objects are at least 16-byte aligned, so the bit
+  /// is never set in a non-tagged object pointer.
+  enum : uintptr_t { WeakReferenceSideTableTag = 2 };
+
+  /// Is the given value, loaded from a WeakReference which does not hold
+  /// null or an Objective-C tagged pointer, a native Swift weak reference?
+  static inline bool isNativeWeakReferenceValue(const void *value) {
+    return ((uintptr_t) value) & WeakReferenceSideTableTag;
+  }
+
   LLVM_LIBRARY_VISIBILITY
   const ClassMetadata *_swift_getClass(const void *object);
 
@@ -0,0 +1,90 @@
+//===--- ProfileCounters.cpp - Per-thread profile counters ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Code compiled with -profile-thread-local-counters increments a per-thread
+// copy of its profile counters, so that threads running the same code don't
+// contend for the counters' cache lines. The first time a thread enters an
+// instrumented function of a module, it registers the module's merge function
+// here, which adds the thread's counts to the module's counters when the
+// thread exits.
+//
+// The main thread usually doesn't exit before the process does, so the merge
+// functions of the thread which calls exit() run from an atexit handler. That
+// handler is installed after the profile runtime's own, so it runs before the
+// profile is written. Counts of threads which are still running at that point
+// are lost.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/ProfileCounters.h"
+#include "swift/Runtime/Debug.h"
+#include <cstdlib>
+#include <mutex>
+#include <pthread.h>
+
+using namespace swift;
+
+namespace {
+
+/// A merge function registered by the current thread.
+struct RegisteredMergeFunction {
+  void (*Merge)(void);
+  RegisteredMergeFunction *Next;
+};
+
+} // end anonymous namespace
+
+static __thread RegisteredMergeFunction *ThreadMergeFunctions = nullptr;
+static pthread_key_t MergeFunctionsKey;
+static std::once_flag MergeFunctionsKeyOnce;
+
+/// Run and forget the merge functions registered by the current thread.
+static void runThreadMergeFunctions(void *) {
+  while (auto *Entry = ThreadMergeFunctions) {
+    ThreadMergeFunctions = Entry->Next;
+    Entry->Merge();
+    free(Entry);
+  }
+}
+
+static void runExitingThreadMergeFunctions() {
+  runThreadMergeFunctions(nullptr);
+}
+
+void swift::swift_registerThreadLocalProfileCounters(void (*merge)(void)) {
+  std::call_once(MergeFunctionsKeyOnce, [] {
+    pthread_key_create(&MergeFunctionsKey, runThreadMergeFunctions);
+    atexit(runExitingThreadMergeFunctions);
+  });
+
+  auto *Entry = static_cast<RegisteredMergeFunction *>(
+    malloc(sizeof(RegisteredMergeFunction)));
+  if (!Entry) swift::crash("Could not allocate memory.");
+  Entry->Merge = merge;
+  Entry->Next = ThreadMergeFunctions;
+  ThreadMergeFunctions = Entry;
+
+  // The key's value only has to be non-null for the destructor to run.
+  pthread_setspecific(MergeFunctionsKey, Entry);
+}
+
+void swift::swift_mergeProfileCounters(uint64_t *counters,
+                                       uint64_t *threadCounters,
+                                       size_t count) {
+  for (size_t i = 0; i != count; ++i) {
+    if (!threadCounters[i])
+      continue;
+    // Other threads may be merging into the same counters.
+    __atomic_fetch_add(&counters[i], threadCounters[i], __ATOMIC_RELAXED);
+    threadCounters[i] = 0;
+  }
+}
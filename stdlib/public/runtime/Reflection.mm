@@ -72,6 +72,9 @@ struct String;
 extern "C" void swift_stringFromUTF8InRawMemory(String *out,
                                                 const char *start,
                                                 intptr_t len);
+extern "C" void swift_stringFromImmortalASCIIInRawMemory(String *out,
+                                                         const char *start,
+                                                         intptr_t len);
   
 struct String {
   // Keep the details of String's implementation opaque to the runtime.
@@ -95,6 +98,22 @@ struct String {
     : String(ptr, strlen(ptr))
   {}
 
+  /// Wrap a nul-terminated string that outlives the process, such as a field
+  /// name in type metadata. ASCII strings are referenced in place rather than
+  /// copied to the heap.
+  static String fromImmortal(const char *ptr) {
+    String result;
+    size_t len = 0;
+    bool isASCII = true;
+    for (; ptr[len] != 0; ++len)
+      isASCII &= (static_cast<unsigned char>(ptr[len]) < 0x80);
+    if (isASCII)
+      swift_stringFromImmortalASCIIInRawMemory(&result, ptr, len);
+    else
+      swift_stringFromUTF8InRawMemory(&result, ptr, len);
+    return result;
+  }
+
   /// Create a Swift String from two concatenated nul-terminated strings.
   explicit String(const char *ptr1, const char *ptr2) {
     size_t len1 = strlen(ptr1);
@@ -537,7 +556,8 @@ StringMirrorTuple swift_StructMirror_subscript(intptr_t i,
   auto bytes = reinterpret_cast<const char*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
 
-  result.first = String(getFieldName(Struct->Description->Struct.FieldNames, i));
+  result.first =
+    String::fromImmortal(getFieldName(Struct->Description->Struct.FieldNames, i));
 
   // This matches the -1 in reflect.
   swift_retain(owner);
@@ -651,7 +671,7 @@ StringMirrorTuple swift_EnumMirror_subscript(intptr_t i,
   // This matches the -1 in reflect.
   swift_retain(owner);
 
-  result.first = String(getFieldName(Description.CaseNames, tag));
+  result.first = String::fromImmortal(getFieldName(Description.CaseNames, tag));
   result.second = reflect(owner, value, payloadType);
 
   return result;
@@ -742,12 +762,90 @@ StringMirrorTuple swift_ClassMirror_subscript(intptr_t i,
   auto bytes = *reinterpret_cast<const char * const*>(value);
   auto fieldData = reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
   
-  result.first = String(getFieldName(Clas->getDescription()->Class.FieldNames, i));
+  result.first = String::fromImmortal(
+    getFieldName(Clas->getDescription()->Class.FieldNames, i));
   // 'owner' is consumed by this call.
   result.second = reflect(owner, fieldData, fieldType.getType());
   return result;
 }
   
+// -- Allocation-free field enumeration.
+
+/// Returns the dynamic type of a value of static type \p type whose fields
+/// swift_reflectionField can enumerate, or null.
+static const Metadata *getFieldEnumerationType(const OpaqueValue *value,
+                                               const Metadata *type) {
+  switch (type->getKind()) {
+  case MetadataKind::Struct:
+    return type;
+
+  case MetadataKind::Class: {
+    auto object = *reinterpret_cast<HeapObject * const *>(value);
+    auto dynamicType = dyn_cast<ClassMetadata>(swift_getObjectType(object));
+    // The field offsets of classes with ObjC heritage may be stale.
+    if (!dynamicType || !dynamicType->isTypeMetadata() ||
+        !usesNativeSwiftReferenceCounting(dynamicType))
+      return nullptr;
+    return dynamicType;
+  }
+
+  default:
+    return nullptr;
+  }
+}
+
+extern "C"
+intptr_t swift_reflectionFieldCount(const OpaqueValue *value,
+                                    const Metadata *type) {
+  auto enumerationType = getFieldEnumerationType(value, type);
+  if (!enumerationType)
+    return -1;
+  if (auto Struct = dyn_cast<StructMetadata>(enumerationType))
+    return Struct->Description->Struct.NumFields;
+  return cast<ClassMetadata>(enumerationType)->getDescription()
+    ->Class.NumFields;
+}
+
+extern "C"
+const OpaqueValue *swift_reflectionField(intptr_t i,
+                                         const OpaqueValue *value,
+                                         const Metadata *type,
+                                         const char **outName,
+                                         const Metadata **outType) {
+  auto enumerationType = getFieldEnumerationType(value, type);
+  if (!enumerationType)
+    swift::crash("Swift reflection field of a type without field metadata");
+
+  const char *fieldNames;
+  FieldType fieldType;
+  uintptr_t fieldOffset;
+  const char *bytes;
+  size_t numFields;
+  if (auto Struct = dyn_cast<StructMetadata>(enumerationType)) {
+    numFields = Struct->Description->Struct.NumFields;
+    if (i < 0 || (size_t)i >= numFields)
+      swift::crash("Swift reflection field index out of range");
+    fieldNames = Struct->Description->Struct.FieldNames;
+    fieldType = Struct->getFieldTypes()[i];
+    fieldOffset = Struct->getFieldOffsets()[i];
+    bytes = reinterpret_cast<const char *>(value);
+  } else {
+    auto Clas = cast<ClassMetadata>(enumerationType);
+    numFields = Clas->getDescription()->Class.NumFields;
+    if (i < 0 || (size_t)i >= numFields)
+      swift::crash("Swift reflection field index out of range");
+    fieldNames = Clas->getDescription()->Class.FieldNames;
+    fieldType = Clas->getFieldTypes()[i];
+    fieldOffset = Clas->getFieldOffsets()[i];
+    bytes = *reinterpret_cast<const char * const *>(value);
+  }
+  assert(!fieldType.isIndirect() && "indirect fields not implemented");
+
+  *outName = getFieldName(fieldNames, i);
+  *outType = fieldType.getType();
+  return reinterpret_cast<const OpaqueValue *>(bytes + fieldOffset);
+}
+
 // -- Mirror witnesses for ObjC classes.
 
 #if SWIFT_OBJC_INTEROP  
@@ -723,6 +723,10 @@ void swift::swift_unknownWeakRelease(void *object) {
 // FIXME: these are not really valid implementations; they assume too
 // much about the implementation of ObjC weak references, and the
 // loads from ->Value can race with clears by the runtime.
+//
+// A weak reference to a native object holds a tagged pointer to the
+// object's side table entry rather than the object itself; see
+// isNativeWeakReferenceValue.
 
 static void doWeakInit(WeakReference *addr, void *value, bool valueIsNative) {
   assert(value != nullptr);
@@ -765,7 +769,7 @@ void swift::swift_unknownWeakAssign(WeakReference *addr, void *newValue) {
   if (isObjCTaggedPointerOrNull(oldValue))
     return doWeakInit(addr, newValue, newIsNative);
 
-  bool oldIsNative = usesNativeSwiftReferenceCounting_allocated(oldValue);
+  bool oldIsNative = isNativeWeakReferenceValue(oldValue);
 
   // If they're both native, we can use the native function.
   if (oldIsNative && newIsNative)
@@ -785,7 +789,7 @@ void *swift::swift_unknownWeakLoadStrong(WeakReference *addr) {
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
 
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
+  if (isNativeWeakReferenceValue(value)) {
     return swift_weakLoadStrong(addr);
   } else {
     return (void*) objc_loadWeakRetained((id*) &addr->Value);
@@ -796,7 +800,7 @@ void *swift::swift_unknownWeakTakeStrong(WeakReference *addr) {
   void *value = addr->Value;
   if (isObjCTaggedPointerOrNull(value)) return value;
 
-  if (usesNativeSwiftReferenceCounting_allocated(value)) {
+  if (isNativeWeakReferenceValue(value)) {
     return swift_weakTakeStrong(addr);
   } else {
     void *result = (void*) objc_loadWeakRetained((id*) &addr->Value);
@@ -808,7 +812,7 @@ void *swift::swift_unknownWeakTakeStrong(WeakReference *addr) {
 void swift::swift_unknownWeakDestroy(WeakReference *addr) {
   id object = (id) addr->Value;
   if (isObjCTaggedPointerOrNull(object)) return;
-  doWeakDestroy(addr, usesNativeSwiftReferenceCounting_allocated(object));
+  doWeakDestroy(addr, isNativeWeakReferenceValue(object));
 }
 void swift::swift_unknownWeakCopyInit(WeakReference *dest, WeakReference *src) {
   id object = (id) src->Value;
@@ -816,7 +820,7 @@ void swift::swift_unknownWeakCopyInit(WeakReference *dest, WeakReference *src) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
+  if (isNativeWeakReferenceValue(object))
     return swift_weakCopyInit(dest, src);
   objc_copyWeak((id*) &dest->Value, (id*) src);
 }
@@ -826,7 +830,7 @@ void swift::swift_unknownWeakTakeInit(WeakReference *dest, WeakReference *src) {
     dest->Value = (HeapObject*) object;
     return;
   }
-  if (usesNativeSwiftReferenceCounting_allocated(object))
+  if (isNativeWeakReferenceValue(object))
     return swift_weakTakeInit(dest, src);
   objc_moveWeak((id*) &dest->Value, (id*) &src->Value);
 }
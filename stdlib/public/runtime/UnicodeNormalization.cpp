@@ -16,15 +16,21 @@
 
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Debug.h"
+#include "../SwiftShims/UnicodeShims.h"
 
 #include <algorithm>
 #include <mutex>
+#include <vector>
 #include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <unicode/ustring.h>
 #include <unicode/ucol.h>
 #include <unicode/ucoleitr.h>
 #include <unicode/uiter.h>
+#include <unicode/unorm2.h>
 
 /// Zero weight 0-8, 14-31, 127.
 const int8_t _swift_stdlib_unicode_ascii_collation_table_impl[128] = {
@@ -39,13 +45,14 @@ const int8_t _swift_stdlib_unicode_ascii_collation_table_impl[128] = {
 const int8_t *_swift_stdlib_unicode_ascii_collation_table =
     _swift_stdlib_unicode_ascii_collation_table_impl;
 
-static const UCollator *MakeRootCollator() {
+static const UCollator *MakeRootCollator(bool Normalize) {
   UErrorCode ErrorCode = U_ZERO_ERROR;
   UCollator *root = ucol_open("", &ErrorCode);
   if (U_FAILURE(ErrorCode)) {
     swift::crash("ucol_open: Failure setting up default collation.");
   }
-  ucol_setAttribute(root, UCOL_NORMALIZATION_MODE, UCOL_ON, &ErrorCode);
+  ucol_setAttribute(root, UCOL_NORMALIZATION_MODE,
+                    Normalize ? UCOL_ON : UCOL_OFF, &ErrorCode);
   ucol_setAttribute(root, UCOL_STRENGTH, UCOL_TERTIARY, &ErrorCode);
   ucol_setAttribute(root, UCOL_NUMERIC_COLLATION, UCOL_OFF, &ErrorCode);
   ucol_setAttribute(root, UCOL_CASE_LEVEL, UCOL_OFF, &ErrorCode);
@@ -61,7 +68,15 @@ static const UCollator *MakeRootCollator() {
 // const here to make sure we don't misuse it.
 // http://sourceforge.net/p/icu/mailman/message/27427062/
 static const UCollator *GetRootCollator() {
-  static const UCollator *RootCollator = MakeRootCollator();
+  static const UCollator *RootCollator = MakeRootCollator(true);
+  return RootCollator;
+}
+
+/// Returns a root collator which does not normalize its input. It gives the
+/// same results as the normalizing one, but only for strings in FCD form (see
+/// isFCD).
+static const UCollator *GetNonNormalizingRootCollator() {
+  static const UCollator *RootCollator = MakeRootCollator(false);
   return RootCollator;
 }
 
@@ -84,6 +99,12 @@ public:
     return CollationTable[c];
   }
 
+  /// Returns the primary weight of an ASCII character, or 0 if it is ignorable
+  /// at the primary level.
+  uint32_t primary(unsigned char c) const {
+    return uint32_t(CollationTable[c]) >> 16;
+  }
+
 private:
   /// Construct the ASCII collation table.
   ASCIICollation() {
@@ -118,6 +139,260 @@ private:
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// Returns true if all code units of the UTF-16 string are ASCII.
+static bool isASCII(const uint16_t *Str, int32_t Length) {
+  int32_t Pos = 0;
+  // Check four code units at a time.
+  for (; Pos + 4 <= Length; Pos += 4) {
+    uint64_t Chunk;
+    memcpy(&Chunk, Str + Pos, sizeof(Chunk));
+    if (Chunk & 0xFF80FF80FF80FF80ULL)
+      return false;
+  }
+  for (; Pos < Length; ++Pos) {
+    if (Str[Pos] & 0xFF80)
+      return false;
+  }
+  return true;
+}
+
+/// Returns true if all bytes of the UTF-8 string are ASCII.
+static bool isASCII(const char *Str, int32_t Length) {
+  int32_t Pos = 0;
+  // Check eight bytes at a time.
+  for (; Pos + 8 <= Length; Pos += 8) {
+    uint64_t Chunk;
+    memcpy(&Chunk, Str + Pos, sizeof(Chunk));
+    if (Chunk & 0x8080808080808080ULL)
+      return false;
+  }
+  for (; Pos < Length; ++Pos) {
+    if (Str[Pos] & 0x80)
+      return false;
+  }
+  return true;
+}
+
+/// Compares two ASCII strings by the primary weights of their collation
+/// elements, using the cached elements of the ASCII subset. Returns 0 if the
+/// strings are equal at the primary level; only a comparison of the secondary
+/// and tertiary weights, which ICU has to do, can order them then.
+template <typename LeftCodeUnit, typename RightCodeUnit>
+static int32_t compareASCIIPrimary(const LeftCodeUnit *LeftString,
+                                   int32_t LeftLength,
+                                   const RightCodeUnit *RightString,
+                                   int32_t RightLength) {
+  const ASCIICollation *Table = ASCIICollation::getTable();
+  int32_t LeftPos = 0, RightPos = 0;
+  while (true) {
+    // Skip the characters which are ignorable at the primary level. An
+    // exhausted string has weight 0, which orders it before a longer one.
+    uint32_t LeftWeight = 0, RightWeight = 0;
+    while (LeftPos < LeftLength && LeftWeight == 0)
+      LeftWeight = Table->primary((unsigned char)LeftString[LeftPos++]);
+    while (RightPos < RightLength && RightWeight == 0)
+      RightWeight = Table->primary((unsigned char)RightString[RightPos++]);
+
+    if (LeftWeight != RightWeight)
+      return LeftWeight < RightWeight ? -1 : 1;
+    if (LeftWeight == 0)
+      return 0;
+  }
+}
+
+/// Returns true if the UTF-16 string is known to be in FCD form, which is all
+/// that the collator's normalization pass ensures. Text in NFC is almost
+/// always FCD, and so is any text without combining marks.
+static bool isFCD(const uint16_t *Str, int32_t Length) {
+  // Code points below U+0300 have a canonical combining class of zero, and
+  // text made of them is trivially FCD.
+  int32_t Pos = 0;
+  while (Pos < Length && Str[Pos] < 0x300)
+    ++Pos;
+  if (Pos == Length)
+    return true;
+
+  static const UNormalizer2 *FCD = [] {
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    const UNormalizer2 *Normalizer =
+      unorm2_getInstance(nullptr, "nfc", UNORM2_FCD, &ErrorCode);
+    return U_SUCCESS(ErrorCode) ? Normalizer : nullptr;
+  }();
+  if (!FCD)
+    return false;
+
+  UErrorCode ErrorCode = U_ZERO_ERROR;
+  UNormalizationCheckResult Result =
+    unorm2_quickCheck(FCD, Str, Length, &ErrorCode);
+  return U_SUCCESS(ErrorCode) && Result == UNORM_YES;
+}
+
+/// Returns the sign of the result of comparing two zero-terminated sort keys.
+static int32_t compareSortKeys(const uint8_t *LeftKey,
+                               const uint8_t *RightKey) {
+  int Diff = strcmp(reinterpret_cast<const char *>(LeftKey),
+                    reinterpret_cast<const char *>(RightKey));
+  return (Diff > 0) - (Diff < 0);
+}
+
+/// Appends the sort key of the string at \p Iterator to \p Key, without the
+/// terminating zero byte.
+static void appendSortKey(UCharIterator *Iterator, std::vector<uint8_t> &Key) {
+  uint32_t State[2] = { 0, 0 };
+  UErrorCode ErrorCode = U_ZERO_ERROR;
+  while (true) {
+    size_t Start = Key.size();
+    Key.resize(Start + 64);
+    int32_t Written = ucol_nextSortKeyPart(GetRootCollator(), Iterator, State,
+                                           Key.data() + Start, 64, &ErrorCode);
+    if (U_FAILURE(ErrorCode)) {
+      swift::crash("ucol_nextSortKeyPart: Unexpected error computing a "
+                   "collation key.");
+    }
+    Key.resize(Start + Written);
+    if (Written < 64)
+      return;
+  }
+}
+
+namespace {
+
+/// The sort keys of the UTF-16 strings the current thread compared more than
+/// once recently.
+///
+/// Sorting compares each string to many others. Comparing the sort keys of two
+/// strings is a byte comparison, which is much cheaper than collating them
+/// again. Computing a sort key costs about as much as one collation, so a
+/// string only gets a key the second time it misses the cache.
+class CollationKeyCache {
+  struct Entry {
+    /// The hash of the code units of the string, or 0 if the entry is empty.
+    size_t Hash;
+    /// A copy of the code units, or null if the string has only been seen
+    /// once.
+    uint16_t *Text;
+    int32_t Length;
+    /// The zero-terminated sort key.
+    uint8_t *Key;
+  };
+
+  static const unsigned NumEntries = 64;
+
+  /// Longer strings are rarely compared to the end, and their keys would
+  /// take up much memory.
+  static const int32_t MaxLength = 256;
+
+  Entry Entries[NumEntries];
+
+  static size_t hash(const uint16_t *Str, int32_t Length) {
+    size_t Hash = 2166136261u;
+    for (int32_t i = 0; i != Length; ++i)
+      Hash = (Hash ^ Str[i]) * 16777619u;
+    // Keep 0 for empty entries.
+    return Hash | 1;
+  }
+
+  /// Returns the sort key of the string, computing it if this is the second
+  /// time in a row the string uses the entry, or null.
+  const uint8_t *getKey(Entry &E, size_t Hash, const uint16_t *Str,
+                        int32_t Length) {
+    if (E.Hash == Hash && E.Text && E.Length == Length &&
+        memcmp(E.Text, Str, Length * sizeof(uint16_t)) == 0)
+      return E.Key;
+
+    if (E.Hash != Hash || E.Text) {
+      // Remember the string, but don't compute its key yet.
+      clear(E);
+      E.Hash = Hash;
+      return nullptr;
+    }
+
+    int32_t KeyLength = ucol_getSortKey(GetRootCollator(), Str, Length,
+                                        nullptr, 0);
+    uint8_t *Key = static_cast<uint8_t *>(malloc(KeyLength));
+    uint16_t *Text = static_cast<uint16_t *>(
+      malloc(std::max(Length, 1) * sizeof(uint16_t)));
+    if (!Key || !Text) {
+      free(Key);
+      free(Text);
+      return nullptr;
+    }
+    ucol_getSortKey(GetRootCollator(), Str, Length, Key, KeyLength);
+    memcpy(Text, Str, Length * sizeof(uint16_t));
+    E.Text = Text;
+    E.Length = Length;
+    E.Key = Key;
+    return Key;
+  }
+
+  static void clear(Entry &E) {
+    free(E.Text);
+    free(E.Key);
+    E = Entry();
+  }
+
+public:
+  CollationKeyCache() : Entries() {}
+
+  ~CollationKeyCache() {
+    for (Entry &E : Entries)
+      clear(E);
+  }
+
+  /// Compares the strings by their cached sort keys. Returns false if the
+  /// cache doesn't have the keys of both strings.
+  bool compare(const uint16_t *LeftString, int32_t LeftLength,
+               const uint16_t *RightString, int32_t RightLength,
+               int32_t &Result) {
+    if (LeftLength > MaxLength || RightLength > MaxLength)
+      return false;
+
+    size_t LeftHash = hash(LeftString, LeftLength);
+    size_t RightHash = hash(RightString, RightLength);
+    Entry &LeftEntry = Entries[LeftHash % NumEntries];
+    Entry &RightEntry = Entries[RightHash % NumEntries];
+    // The strings would evict each other's keys.
+    if (&LeftEntry == &RightEntry)
+      return false;
+
+    const uint8_t *LeftKey = getKey(LeftEntry, LeftHash, LeftString,
+                                    LeftLength);
+    const uint8_t *RightKey = getKey(RightEntry, RightHash, RightString,
+                                     RightLength);
+    if (!LeftKey || !RightKey)
+      return false;
+    Result = compareSortKeys(LeftKey, RightKey);
+    return true;
+  }
+
+  /// Returns the current thread's cache.
+  static CollationKeyCache &get();
+};
+
+} // end anonymous namespace
+
+static __thread CollationKeyCache *LocalKeyCache = nullptr;
+static pthread_key_t LocalKeyCacheKey;
+static std::once_flag LocalKeyCacheKeyOnce;
+
+/// Free the cache of an exiting thread.
+static void _freeLocalKeyCache(void *cache) {
+  LocalKeyCache = nullptr;
+  delete static_cast<CollationKeyCache *>(cache);
+}
+
+CollationKeyCache &CollationKeyCache::get() {
+  if (LocalKeyCache)
+    return *LocalKeyCache;
+
+  std::call_once(LocalKeyCacheKeyOnce, [] {
+    pthread_key_create(&LocalKeyCacheKey, _freeLocalKeyCache);
+  });
+  LocalKeyCache = new CollationKeyCache();
+  pthread_setspecific(LocalKeyCacheKey, LocalKeyCache);
+  return *LocalKeyCache;
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -128,7 +403,28 @@ int32_t _swift_stdlib_unicode_compare_utf16_utf16(const uint16_t *LeftString,
                                                   int32_t LeftLength,
                                                   const uint16_t *RightString,
                                                   int32_t RightLength) {
-  return ucol_strcoll(GetRootCollator(),
+  // Identical code units always collate as equal.
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength * sizeof(uint16_t)) == 0)
+    return 0;
+
+  // UTF-16 storage often holds only ASCII characters, and most ASCII strings
+  // are ordered by their primary weights.
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength)) {
+    if (int32_t Diff = compareASCIIPrimary(LeftString, LeftLength,
+                                           RightString, RightLength))
+      return Diff;
+  }
+
+  int32_t Diff;
+  if (CollationKeyCache::get().compare(LeftString, LeftLength,
+                                       RightString, RightLength, Diff))
+    return Diff;
+
+  const UCollator *Collator = GetRootCollator();
+  if (isFCD(LeftString, LeftLength) && isFCD(RightString, RightLength))
+    Collator = GetNonNormalizingRootCollator();
+  return ucol_strcoll(Collator,
     LeftString, LeftLength,
     RightString, RightLength);
 }
@@ -143,6 +439,13 @@ int32_t _swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
                                                  int32_t LeftLength,
                                                  const uint16_t *RightString,
                                                  int32_t RightLength) {
+  bool LeftIsASCII = isASCII(LeftString, LeftLength);
+  if (LeftIsASCII && isASCII(RightString, RightLength)) {
+    if (int32_t Diff = compareASCIIPrimary(LeftString, LeftLength,
+                                           RightString, RightLength))
+      return Diff;
+  }
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -150,7 +453,11 @@ int32_t _swift_stdlib_unicode_compare_utf8_utf16(const char *LeftString,
   uiter_setUTF8(&LeftIterator, LeftString, LeftLength);
   uiter_setString(&RightIterator, RightString, RightLength);
 
-  uint32_t Diff = ucol_strcollIter(GetRootCollator(),
+  // ASCII text is in FCD form.
+  const UCollator *Collator = GetRootCollator();
+  if (LeftIsASCII && isFCD(RightString, RightLength))
+    Collator = GetNonNormalizingRootCollator();
+  uint32_t Diff = ucol_strcollIter(Collator,
     &LeftIterator, &RightIterator, &ErrorCode);
   if (U_FAILURE(ErrorCode)) {
     swift::crash("ucol_strcollIter: Unexpected error doing utf8<->utf16 string comparison.");
@@ -168,6 +475,20 @@ int32_t _swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
                                                 int32_t LeftLength,
                                                 const char *RightString,
                                                 int32_t RightLength) {
+  // Identical code units always collate as equal.
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength) == 0)
+    return 0;
+
+  // ASCII text is in FCD form, so it doesn't need to be normalized either.
+  const UCollator *Collator = GetRootCollator();
+  if (isASCII(LeftString, LeftLength) && isASCII(RightString, RightLength)) {
+    if (int32_t Diff = compareASCIIPrimary(LeftString, LeftLength,
+                                           RightString, RightLength))
+      return Diff;
+    Collator = GetNonNormalizingRootCollator();
+  }
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -175,7 +496,7 @@ int32_t _swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
   uiter_setUTF8(&LeftIterator, LeftString, LeftLength);
   uiter_setUTF8(&RightIterator, RightString, RightLength);
 
-  uint32_t Diff = ucol_strcollIter(GetRootCollator(),
+  uint32_t Diff = ucol_strcollIter(Collator,
     &LeftIterator, &RightIterator, &ErrorCode);
   if (U_FAILURE(ErrorCode)) {
     swift::crash("ucol_strcollIter: Unexpected error doing utf8<->utf8 string comparison.");
@@ -183,6 +504,76 @@ int32_t _swift_stdlib_unicode_compare_utf8_utf8(const char *LeftString,
   return Diff;
 }
 
+static void setIterator(UCharIterator *Iterator,
+                        const swift::_swift_stdlib_CollationString &Str) {
+  if (Str.IsASCII)
+    uiter_setUTF8(Iterator, static_cast<const char *>(Str.Start), Str.Length);
+  else
+    uiter_setString(Iterator, static_cast<const uint16_t *>(Str.Start),
+                    Str.Length);
+}
+
+/// Compares the candidate at \p Iterator to the string whose sort key is
+/// \p Key, computing only as much of the candidate's sort key as is needed to
+/// tell them apart.
+static int32_t compareToSortKey(const std::vector<uint8_t> &Key,
+                                UCharIterator *Iterator) {
+  uint32_t State[2] = { 0, 0 };
+  uint8_t Part[64];
+  size_t Pos = 0;
+  while (true) {
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    int32_t Written = ucol_nextSortKeyPart(GetRootCollator(), Iterator, State,
+                                           Part, sizeof(Part), &ErrorCode);
+    if (U_FAILURE(ErrorCode)) {
+      swift::crash("ucol_nextSortKeyPart: Unexpected error computing a "
+                   "collation key.");
+    }
+
+    // The candidate's key is the right-hand side of the comparison.
+    size_t Common = std::min(Key.size() - Pos, size_t(Written));
+    if (int Diff = memcmp(Key.data() + Pos, Part, Common))
+      return Diff < 0 ? -1 : 1;
+    if (Common < size_t(Written))
+      return -1;
+    Pos += Written;
+    if (Written < int32_t(sizeof(Part)))
+      return Pos < Key.size() ? 1 : 0;
+  }
+}
+
+extern "C"
+void _swift_stdlib_unicode_compare_many(
+    const swift::_swift_stdlib_CollationString *String,
+    const swift::_swift_stdlib_CollationString *Candidates, int32_t Count,
+    int32_t *Results) {
+  std::vector<uint8_t> Key;
+  bool HasKey = false;
+  for (int32_t i = 0; i != Count; ++i) {
+    const swift::_swift_stdlib_CollationString &Candidate = Candidates[i];
+
+    // ASCII pairs are usually ordered without ICU.
+    if (String->IsASCII && Candidate.IsASCII) {
+      Results[i] = compareASCIIPrimary(
+        static_cast<const char *>(String->Start), String->Length,
+        static_cast<const char *>(Candidate.Start), Candidate.Length);
+      if (Results[i] != 0)
+        continue;
+    }
+
+    if (!HasKey) {
+      UCharIterator Iterator;
+      setIterator(&Iterator, *String);
+      appendSortKey(&Iterator, Key);
+      HasKey = true;
+    }
+
+    UCharIterator Iterator;
+    setIterator(&Iterator, Candidate);
+    Results[i] = compareToSortKey(Key, &Iterator);
+  }
+}
+
 // These functions use murmurhash2 in its 32 and 64bit forms, which are
 // differentiated by the constants defined below. This seems like a good choice
 // for now because it operates efficiently in blocks rather than bytes, and 
@@ -230,26 +621,17 @@ static intptr_t hashFinish(intptr_t HashState) {
   return HashState;
 }
 
-extern "C"
-intptr_t _swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
-  UErrorCode ErrorCode = U_ZERO_ERROR;
-  intptr_t HashState = HASH_SEED;
-  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
-
-  if (U_FAILURE(ErrorCode)) {
-    swift::crash("hashChunk: Unexpected error hashing unicode string.");
-  }
-  return hashFinish(HashState);
-}
-
-extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
-                                                     int32_t Length) {
+/// Hashes a string of ASCII code units using the cached collation elements
+/// of the ASCII subset. The result is the same as hashing the string with the
+/// collation iterator.
+template <typename CodeUnit>
+static intptr_t hashASCII(const CodeUnit *Str, int32_t Length) {
   const ASCIICollation *Table = ASCIICollation::getTable();
   intptr_t HashState = HASH_SEED;
   int32_t Pos = 0;
   while (Pos < Length) {
-    const char c = Str[Pos++];
-    assert((c & 0x80) == 0 && "This table only exists for the ASCII subset");
+    const CodeUnit c = Str[Pos++];
+    assert((c & ~0x7F) == 0 && "This table only exists for the ASCII subset");
     intptr_t Elem = Table->map(c);
     // Ignore zero valued collation elements. They don't participate in the
     // ordering relation.
@@ -265,6 +647,28 @@ extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
   return hashFinish(HashState);
 }
 
+extern "C"
+intptr_t _swift_stdlib_unicode_hash(const uint16_t *Str, int32_t Length) {
+  // UTF-16 storage often holds only ASCII characters, which do not need the
+  // collation iterator.
+  if (isASCII(Str, Length))
+    return hashASCII(Str, Length);
+
+  UErrorCode ErrorCode = U_ZERO_ERROR;
+  intptr_t HashState = HASH_SEED;
+  HashState = hashChunk(GetRootCollator(), HashState, Str, Length, &ErrorCode);
+
+  if (U_FAILURE(ErrorCode)) {
+    swift::crash("hashChunk: Unexpected error hashing unicode string.");
+  }
+  return hashFinish(HashState);
+}
+
+extern "C" intptr_t _swift_stdlib_unicode_hash_ascii(const char *Str,
+                                                     int32_t Length) {
+  return hashASCII(reinterpret_cast<const unsigned char *>(Str), Length);
+}
+
 /// Convert the unicode string to uppercase. This function will return the
 /// required buffer length as a result. If this length does not match the
 /// 'DestinationCapacity' this function must be called again with a buffer of
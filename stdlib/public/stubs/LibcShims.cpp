@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "../SwiftShims/LibcShims.h"
+#include "swift/Runtime/Heap.h"
 
 #if defined(__linux__)
 #include <bsd/stdlib.h>
@@ -49,10 +50,16 @@ int _swift_stdlib_close(int fd) { return close(fd); }
 
 #if defined(__APPLE__)
 #include <malloc/malloc.h>
-size_t _swift_stdlib_malloc_size(const void *ptr) { return malloc_size(ptr); }
+size_t _swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = swift_slowAllocSize(ptr))
+    return size;
+  return malloc_size(ptr);
+}
 #elif defined(__GNU_LIBRARY__)
 #include <malloc.h>
 size_t _swift_stdlib_malloc_size(const void *ptr) {
+  if (size_t size = swift_slowAllocSize(ptr))
+    return size;
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #else
@@ -114,8 +114,12 @@ func testScope() {
   var one = nsx.objectAtIndex(0) as! Tracked
   print("nsx[0]: \(one.value) .")
 
-  // We can get the element again, but it may not have the same identity
-  // CHECK-NEXT: object identity matches?
+  // Only the requested element has been bridged
+  // CHECK-NEXT: trackedCount = 1 .
+  print("trackedCount = \(trackedCount) .")
+
+  // We can get the element again, and it keeps its identity
+  // CHECK-NEXT: object identity matches? true
   var anotherOne = nsx.objectAtIndex(0) as! Tracked
   print("object identity matches? \(one === anotherOne)")
 
@@ -244,6 +244,21 @@ CharacterTests.test(
     { x in { String(Character(x)) < String(Character($0)) } } as PredicateFn)
 }
 
+CharacterTests.test("String(Character(x)) for ASCII x shares static storage") {
+  for i in 0..<128 {
+    let x = UnicodeScalar(i)
+    var s = String(Character(x))
+    expectEmpty(s._core._owner)
+    expectEqual(1, s._core.count)
+    expectEqual(String(x), s)
+
+    // Mutation copies the string out of the shared storage.
+    s.append(UnicodeScalar("z"))
+    expectEqual(String(x) + "z", s)
+    expectEqual(String(x), String(Character(x)))
+  }
+}
+
 CharacterTests.test("String.append(_: Character)") {
   for test in testCharacters {
     let character = Character(test)
@@ -255,6 +270,18 @@ CharacterTests.test("String.append(_: Character)") {
   }
 }
 
+CharacterTests.test("String.characters/ASCII boundaries") {
+  // Clusters next to ASCII, which are measured without the property trie.
+  let s = "a\r\nb\r\r\n\u{65}\u{301}x\u{4e00}1\u{1F1EF}\u{1F1F5}!\n"
+  let expected: [String] = [
+    "a", "\r\n", "b", "\r", "\r\n", "\u{65}\u{301}", "x", "\u{4e00}", "1",
+    "\u{1F1EF}\u{1F1F5}", "!", "\n"
+  ]
+  expectEqualSequence(expected, s.characters.map { String($0) })
+  expectEqualSequence(
+    expected.reverse(), s.characters.reverse().map { String($0) })
+}
+
 var UnicodeScalarTests = TestSuite("UnicodeScalar")
 
 UnicodeScalarTests.test("UInt8(ascii: UnicodeScalar)") {
@@ -0,0 +1,90 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+import SwiftPrivate
+
+var ParallelTestSuite = TestSuite("Parallel")
+
+ParallelTestSuite.test("parallelMap") {
+  for count in [ 0, 1, 10, 1000, 100_000 ] {
+    let ary = ContiguousArray(0..<count)
+    expectEqual(ary.map { $0 * 2 }, ary.parallelMap { $0 * 2 })
+    expectEqual(
+      ary.map { $0 * 2 }, ary.parallelMap(grainSize: 7) { $0 * 2 })
+  }
+}
+
+ParallelTestSuite.test("parallelMap/NonTrivialElements") {
+  let ary = Array(0..<10_000)
+  let strings = ary.parallelMap(grainSize: 100) { String($0) }
+  expectEqual(ary.map { String($0) }, strings)
+}
+
+ParallelTestSuite.test("parallelReduce") {
+  for count in [ 0, 1, 10, 1000, 100_000 ] {
+    let ary = ContiguousArray(0..<count)
+    let expected = ary.reduce(0, combine: +)
+    expectEqual(expected,
+      ary.parallelReduce(0, combine: +, merge: +))
+    expectEqual(expected,
+      ary.parallelReduce(0, grainSize: 3, combine: +, merge: +))
+  }
+}
+
+ParallelTestSuite.test("parallelReduce/MergesInOrder") {
+  let ary = Array(0..<1000)
+  // Concatenation is associative but not commutative.
+  let result = ary.parallelReduce([], grainSize: 10,
+    combine: { $0 + [ $1 ] }, merge: { $0 + $1 })
+  expectEqual(ary, result)
+}
+
+ParallelTestSuite.test("concurrentForEach") {
+  let count = 10_000
+  let ary = Array(0..<count)
+  var visited = [Int](count: count, repeatedValue: 0)
+  visited.withUnsafeMutableBufferPointer {
+    (visited) -> Void in
+    ary.concurrentForEach(grainSize: 16) {
+      visited[$0] += 1
+    }
+  }
+  expectEqual([Int](count: count, repeatedValue: 1), visited)
+}
+
+ParallelTestSuite.test("concurrentForEach/Nested") {
+  let ary = Array(0..<100)
+  var sums = [Int](count: ary.count, repeatedValue: 0)
+  sums.withUnsafeMutableBufferPointer {
+    (sums) -> Void in
+    ary.concurrentForEach(grainSize: 1) {
+      (i) in
+      sums[i] = ary.parallelReduce(0, grainSize: 1, combine: +, merge: +)
+    }
+  }
+  expectEqual(
+    [Int](count: ary.count, repeatedValue: ary.reduce(0, combine: +)), sums)
+}
+
+ParallelTestSuite.test("parallelSortInPlace") {
+  for count in [ 0, 1, 10, 1000, 100_000 ] {
+    let original = randArray(count)
+    var ary = original
+    ary.parallelSortInPlace()
+    expectEqual(original.sort(), ary)
+
+    ary = original
+    ary.parallelSortInPlace(grainSize: 13) { $0 > $1 }
+    expectEqual(original.sort { $0 > $1 }, ary)
+  }
+}
+
+ParallelTestSuite.test("parallelSortInPlace/NonContiguous") {
+  let original = randArray(1000)
+  var ary = DefaultedRandomAccessMutableCollection(original)
+  ary.parallelSortInPlace()
+  expectEqual(original.sort(), Array(ary))
+}
+
+runAllTests()
@@ -1114,6 +1114,57 @@ Reflection.test("Struct/Generic/DefaultMirror") {
   }
 }
 
+Reflection.test("Struct/ForEachStoredProperty") {
+  let value = GenericStructWithDefaultMirror<Int, String>(
+    first: 123, second: "abc")
+  var names: [String] = []
+  var types: [String] = []
+  var ints: [Int] = []
+  let enumerated = _forEachStoredProperty(value) {
+    (name, type, address) in
+    names.append(String.fromCString(name)!)
+    types.append(_typeName(type))
+    if type == Int.self {
+      ints.append(UnsafePointer<Int>(address).memory)
+    }
+  }
+  expectTrue(enumerated)
+  expectEqual([ "first", "second" ], names)
+  expectEqual([ "Swift.Int", "Swift.String" ], types)
+  expectEqual([ 123 ], ints)
+}
+
+class ClassWithStoredProperties {
+  var x = 17
+  var y = 2.5
+}
+
+class SubclassWithStoredProperties : ClassWithStoredProperties {
+  var z = 42
+}
+
+Reflection.test("Class/ForEachStoredProperty") {
+  let object: ClassWithStoredProperties = SubclassWithStoredProperties()
+  var names: [String] = []
+  var ints: [Int] = []
+  // The dynamic class's own properties are enumerated.
+  let enumerated = _forEachStoredProperty(object) {
+    (name, type, address) in
+    names.append(String.fromCString(name)!)
+    ints.append(UnsafePointer<Int>(address).memory)
+  }
+  expectTrue(enumerated)
+  expectEqual([ "z" ], names)
+  expectEqual([ 42 ], ints)
+}
+
+Reflection.test("ForEachStoredProperty/Unsupported") {
+  var called = false
+  expectFalse(_forEachStoredProperty((1, 2)) { _ in called = true })
+  expectFalse(_forEachStoredProperty(Optional(1)) { _ in called = true })
+  expectFalse(called)
+}
+
 enum NoPayloadEnumWithDefaultMirror {
   case A, ß
 }
@@ -0,0 +1,22 @@
+@import Foundation;
+
+@protocol LazyMembersProto
+- (NSInteger)fromProtocol;
+@end
+
+@interface LazyMembersBase : NSObject
+- (NSInteger)fromBase;
+@end
+
+@interface LazyMembers : LazyMembersBase <LazyMembersProto>
+- (NSInteger)first;
+- (NSInteger)second;
+- (NSInteger)overloaded:(NSInteger)x;
+- (NSInteger)overloaded:(NSInteger)x other:(NSInteger)y;
+@property NSInteger property;
++ (instancetype)lazyMembersWithValue:(NSInteger)value;
+@end
+
+@interface LazyMembers (Category)
+- (NSInteger)fromCategory;
+@end
@@ -0,0 +1,25 @@
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -I %S/Inputs/custom-modules -parse -verify %s
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -I %S/Inputs/custom-modules -emit-sil %s -o /dev/null
+// RUN: %target-swift-frontend(mock-sdk: %clang-importer-sdk) -I %S/Inputs/custom-modules -parse %s -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// REQUIRES: objc_interop
+// REQUIRES: asserts
+
+// STATS: {{[1-9][0-9]*}} Name lookup{{ +}}- # of member lookups that loaded only the named members
+
+import Foundation
+import LazyMembers
+
+func test(m: LazyMembers) {
+  let a: Int = m.second()
+  let b: Int = m.overloaded(1)
+  let c: Int = m.overloaded(1, other: 2)
+  let d: Int = m.fromCategory()
+  let e: Int = m.fromProtocol()
+  let f: Int = m.fromBase()
+  m.property = a + b + c + d + e + f
+  m.nonexistent() // expected-error {{value of type 'LazyMembers' has no member 'nonexistent'}}
+}
+
+// Factory methods still become initializers.
+let m = LazyMembers(value: 1)
@@ -0,0 +1,51 @@
+// RUN: %target-parse-verify-swift -solve-closure-bodies-separately
+// RUN: %target-swift-frontend -parse -solve-closure-bodies-separately -debug-time-expression-type-checking %s 2>&1 | FileCheck %s
+
+// Single-expression closures whose types follow from context have their
+// bodies type-checked separately from the enclosing call. Closures whose
+// types depend on their bodies are still solved together with them.
+
+struct Spec {
+  var name: String
+}
+
+func describe(name: String, _ body: Spec -> Bool) -> Bool {
+  return body(Spec(name: name))
+}
+
+func layout(width: Int, _ build: Int -> Int) -> Int {
+  return build(width)
+}
+
+func apply<T>(x: Int, _ f: Int -> T) -> T {
+  return f(x)
+}
+
+func forEachName(names: [String], _ f: String -> ()) {
+  for name in names { f(name) }
+}
+
+func overloaded(f: Int -> Int) -> Int { return f(0) }
+func overloaded(f: String -> String) -> String { return f("") }
+
+func makeInt() -> Int { return 0 }
+
+// CHECK: NumDeferredClosureBodies=1
+let a: Bool = describe("a") { $0.name.isEmpty }
+let b = layout(10) { layout($0) { $0 * 2 + 1 } }
+let c = layout(10) { (w: Int) -> Int in w + 1 }
+
+// The result type is only known from the body.
+let d: String = apply(1) { _ in "x" }
+let e = apply(1) { $0 + 1 }
+let _: Int = e
+
+// Closures converted to ones returning () need the type of their body.
+forEachName(["a", "b"]) { _ in makeInt() }
+
+// The overload can only be chosen by looking at the body.
+let f = overloaded { $0 + 1 }
+let _: Int = f
+
+// Errors in a separately type-checked body are still diagnosed.
+let g = layout(10) { $0.name } // expected-error {{value of type 'Int' has no member 'name'}}
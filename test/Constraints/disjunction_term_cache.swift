@@ -0,0 +1,37 @@
+// RUN: %target-parse-verify-swift
+
+// Failed disjunction terms are remembered across expressions. Make sure the
+// remembered failures never hide a choice that is valid in a later
+// expression.
+
+struct Meters {
+  var value: Double
+}
+
+func +(lhs: Meters, rhs: Meters) -> Meters {
+  return Meters(value: lhs.value + rhs.value)
+}
+
+func +(lhs: Meters, rhs: Double) -> Meters {
+  return Meters(value: lhs.value + rhs)
+}
+
+func takesDouble(x: Double) {}
+func takesMeters(x: Meters) {}
+
+let m = Meters(value: 1)
+let d = 2.0
+
+let a = m + m + m + m + m + m
+let b = m + d + d + d + d + d
+let c = d + d + d + d + d + d
+takesMeters(a)
+takesMeters(b)
+takesDouble(c)
+
+let arr: [Double] = [c, d, c, d, c, d, c, d]
+let marr: [Meters] = [a, b, a, b, a, b, m]
+
+let e: Meters = d // expected-error {{cannot convert value of type 'Double' to specified type 'Meters'}}
+let f = m + m + m + m
+takesMeters(f)
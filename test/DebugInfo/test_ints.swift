@@ -1,10 +1,11 @@
 // RUN: %target-swift-frontend %s -emit-ir -g -o - | FileCheck %s
 
 // These two should not have the same type.
+// Int64 is defined in the standard library, so it is only declared here.
 // CHECK: !DICompositeType(tag: DW_TAG_structure_type, name: "Int64"
 // CHECK-SAME:             size: 64, align: 64
 // CHECK-NOT:              offset: 0
-// CHECK-NOT:              DIFlagFwdDecl
+// CHECK-SAME:             DIFlagFwdDecl
 // CHECK-SAME:             identifier: "_TtVs5Int64"
 // CHECK: !DIGlobalVariable(name: "a",{{.*}} line: [[@LINE+2]]
 // CHECK-SAME:              type: !"_TtVs5Int64"
@@ -12,3 +12,8 @@ RUN: diff %t.check %t.output
 ; RUN: swift-demangle __TtSi | FileCheck %s -check-prefix=DOUBLE
 ; DOUBLE: _TtSi ---> Swift.Int
 
+; RUN: swift-demangle -input-file=%t.input > %t.output-file
+; RUN: diff %t.check %t.output-file
+
+; RUN: echo "x _T _TtSi,__TtSi _T" | swift-demangle | FileCheck %s -check-prefix=EMBEDDED
+; EMBEDDED: x _T Swift.Int,_Swift.Int _T
@@ -0,0 +1,5 @@
+# Dependencies after compilation:
+provides-nominal: [T]
+provides-member: [[T, ""], [T, x], [T, y]]
+interface-hash: "after"
+decl-interface-hashes: [[T, "t"], [T, x, "x"], [T, y, "y-after"]]
@@ -0,0 +1,4 @@
+# Dependencies after compilation:
+depends-nominal: [T]
+depends-member: [[T, x]]
+interface-hash: "uses-x"
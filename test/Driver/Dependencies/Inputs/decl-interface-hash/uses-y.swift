@@ -0,0 +1,4 @@
+# Dependencies after compilation:
+depends-nominal: [T]
+depends-member: [[T, y]]
+interface-hash: "uses-y"
@@ -0,0 +1,11 @@
+public func libFunc() -> Int {
+#if PRIVATE_CHANGE
+  return 2
+#else
+  return 1
+#endif
+}
+
+#if PUBLIC_CHANGE
+public func addedFunc() {}
+#endif
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+
+// The build record remembers how long each compile job took.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -driver-build-trace %t/trace.json
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+// RUN: FileCheck -check-prefix=CHECK-TRACE %s < %t/trace.json
+
+// CHECK-RECORD: job_durations:
+// CHECK-RECORD-NEXT: "./main.swift": {{[0-9]+$}}
+// CHECK-RECORD-NEXT: "./other.swift": {{[0-9]+$}}
+
+// CHECK-TRACE: {"traceEvents": [
+// CHECK-TRACE-NEXT: {"name": "compile main.swift", "ph": "X", "pid": 1, "tid": 0, "ts": {{[0-9]+}}, "dur": {{[0-9]+}}}
+// CHECK-TRACE-NEXT: {"name": "compile other.swift", "ph": "X", "pid": 1, "tid": 0, "ts": {{[0-9]+}}, "dur": {{[0-9]+}}}
+// CHECK-TRACE-NEXT: ]}
+
+// With several parallel commands, the job that took longest starts first.
+// RUN: echo '{job_durations: {"./main.swift": 1, "./other.swift": 100000}}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j2 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-ORDER %s
+
+// CHECK-ORDER: "kind": "began"
+// CHECK-ORDER: ".\/other.swift"
+// CHECK-ORDER: "kind": "began"
+// CHECK-ORDER: ".\/main.swift"
+
+// A single parallel command keeps the input order.
+// RUN: echo '{job_durations: {"./main.swift": 1, "./other.swift": 100000}}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-INPUT-ORDER %s
+
+// CHECK-INPUT-ORDER: "kind": "began"
+// CHECK-INPUT-ORDER: ".\/main.swift"
+// CHECK-INPUT-ORDER: "kind": "began"
+// CHECK-INPUT-ORDER: ".\/other.swift"
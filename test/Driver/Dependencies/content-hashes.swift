@@ -0,0 +1,50 @@
+/// other ==> main
+/// "./main1-external" ==> main
+/// "./other1-external" ==> other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/one-way-external/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -incremental-content-hashes ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+// RUN: FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled other.swift
+
+// CHECK-RECORD: inputs:
+// CHECK-RECORD-NEXT: "./main.swift": [{{[0-9]+}}, {{[0-9]+}}, "{{[0-9a-f]{16}}}"]
+// CHECK-RECORD-NEXT: "./other.swift": [{{[0-9]+}}, {{[0-9]+}}, "{{[0-9a-f]{16}}}"]
+// CHECK-RECORD: external_dependencies:
+// CHECK-RECORD-NEXT: "./main1-external": "{{[0-9a-f]{16}}}"
+// CHECK-RECORD-NEXT: "./main2-external": "{{[0-9a-f]{16}}}"
+// CHECK-RECORD-NEXT: "./other1-external": "{{[0-9a-f]{16}}}"
+// CHECK-RECORD-NEXT: "./other2-external": "{{[0-9a-f]{16}}}"
+
+// Touching inputs and external dependencies without changing them doesn't
+// cause anything to be rebuilt.
+// RUN: touch -t 201401240006 %t/*.swift
+// RUN: touch -t 300004010005 %t/*-external
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -incremental-content-hashes ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-TOUCHED %s
+
+// CHECK-TOUCHED-NOT: Handled
+
+// Without -incremental-content-hashes, modification times are all that count.
+// RUN: touch -t 201401240004 %t/*-external
+// RUN: touch -t 201401240007 %t/main.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-MAIN %s
+
+// Changing the contents of an input rebuilds it.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -incremental-content-hashes ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-TOUCHED %s
+// RUN: echo "# changed" >> %t/main.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -incremental-content-hashes ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-MAIN %s
+
+// CHECK-MAIN-NOT: Handled other.swift
+// CHECK-MAIN: Handled main.swift
+// CHECK-MAIN-NOT: Handled other.swift
+
+// Changing the contents of an external dependency rebuilds its dependents.
+// RUN: echo "changed" >> %t/other1-external
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -incremental-content-hashes ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-EXTERNAL %s
+
+// CHECK-EXTERNAL: Handled other.swift
@@ -0,0 +1,23 @@
+/// changed ==> uses-y, but not uses-x (only T.y's interface changes)
+
+// RUN: rm -rf %t && cp -r %S/Inputs/decl-interface-hash/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// Generate the build record...
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changed.swift ./uses-x.swift ./uses-y.swift -module-name main -j1 -v
+
+// ...then reset the .swiftdeps files.
+// RUN: cp -r %S/Inputs/decl-interface-hash/*.swiftdeps %t
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changed.swift ./uses-x.swift ./uses-y.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-CLEAN %s
+
+// CHECK-CLEAN-NOT: Handled
+
+// RUN: touch -t 201401240006 %t/changed.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./changed.swift ./uses-x.swift ./uses-y.swift -module-name main -j1 -v > %t/changed.txt 2>&1
+// RUN: FileCheck -check-prefix=CHECK-CHANGE %s < %t/changed.txt
+// RUN: FileCheck -check-prefix=NEGATIVE-CHANGE %s < %t/changed.txt
+
+// CHECK-CHANGE: Handled changed.swift
+// CHECK-CHANGE: Handled uses-y.swift
+// NEGATIVE-CHANGE-NOT: Handled uses-x.swift
@@ -0,0 +1,26 @@
+/// "./lib.swiftmodule" ==> main
+
+// RUN: rm -rf %t && cp -r %S/Inputs/external-interface-hash/ %t
+// RUN: %target-swift-frontend -emit-module -o %t/lib.swiftmodule %t/lib.swift -module-name lib
+
+// Make the fake frontend record the interface hash of lib in main.swiftdeps.
+// RUN: llvm-bcanalyzer -dump %t/lib.swiftmodule | sed -n -e "s/.*<INTERFACE_HASH .* blob data = '\(.*\)'/\1/p" > %t/hash
+// RUN: echo 'depends-external: ["./lib.swiftmodule"]' > %t/main.swift
+// RUN: sed -e 's/.*/external-interface-hashes: [["\.\/lib.swiftmodule", "&"]]/' %t/hash >> %t/main.swift
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST: Handled main.swift
+
+// Rebuilding lib with a change to a function body leaves its interface alone.
+// RUN: %target-swift-frontend -emit-module -o %t/lib.swiftmodule %t/lib.swift -module-name lib -DPRIVATE_CHANGE
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-PRIVATE %s
+
+// CHECK-PRIVATE-NOT: Handled
+
+// Adding a public function changes it.
+// RUN: %target-swift-frontend -emit-module -o %t/lib.swiftmodule %t/lib.swift -module-name lib -DPUBLIC_CHANGE
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift -module-name main -j1 -v 2>&1 | FileCheck -check-prefix=CHECK-PUBLIC %s
+
+// CHECK-PUBLIC: Handled main.swift
@@ -0,0 +1,31 @@
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+
+// "finished" messages report the resources the job consumed.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift -j1 -parseable-output 2>&1 | FileCheck -check-prefix=CHECK-USAGE %s
+
+// CHECK-USAGE: "kind": "finished"
+// CHECK-USAGE-NEXT: "name": "compile"
+// CHECK-USAGE-NEXT: "pid": {{[1-9][0-9]*}}
+// CHECK-USAGE-NEXT: "output": "Handled main.swift\n"
+// CHECK-USAGE-NEXT: "user-time-usec": {{[0-9]+}}
+// CHECK-USAGE-NEXT: "system-time-usec": {{[0-9]+}}
+// CHECK-USAGE-NEXT: "max-rss-bytes": {{[1-9][0-9]*}}
+// CHECK-USAGE-NEXT: "exit-status": 0
+
+// With -driver-stream-output, output is reported in "output" messages instead.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift -j1 -parseable-output -driver-stream-output 2>&1 | FileCheck -check-prefix=CHECK-STREAM %s
+
+// CHECK-STREAM: "kind": "began"
+// CHECK-STREAM: "kind": "output"
+// CHECK-STREAM-NEXT: "name": "compile"
+// CHECK-STREAM-NEXT: "pid": {{[1-9][0-9]*}}
+// CHECK-STREAM-NEXT: "output": "Handled main.swift\n"
+// CHECK-STREAM: "kind": "finished"
+// CHECK-STREAM-NOT: "output"
+// CHECK-STREAM: "exit-status": 0
+
+// Without parseable output, streamed output is forwarded as is.
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json ./main.swift ./other.swift -module-name main -j1 -driver-stream-output 2>&1 | FileCheck -check-prefix=CHECK-PLAIN %s
+
+// CHECK-PLAIN: Handled main.swift
+// CHECK-PLAIN-NEXT: Handled other.swift
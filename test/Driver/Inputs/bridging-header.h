@@ -0,0 +1 @@
+static inline int bridgedValue(void) { return 42; }
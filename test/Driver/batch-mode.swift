@@ -0,0 +1,23 @@
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -enable-batch-mode -j 2 -c %S/Inputs/main.swift %S/Inputs/lib.swift %S/Inputs/single_int.swift %s 2>&1 | FileCheck -check-prefix=OBJECT %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -enable-batch-mode -j 2 -g %S/Inputs/main.swift %S/Inputs/lib.swift %S/Inputs/single_int.swift %s 2>&1 | FileCheck -check-prefix=LINK %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -enable-batch-mode -j 4 -c %S/Inputs/main.swift %S/Inputs/lib.swift 2>&1 | FileCheck -check-prefix=SMALL %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -enable-batch-mode -j 2 -c -serialize-diagnostics %S/Inputs/main.swift %S/Inputs/lib.swift 2>&1 | FileCheck -check-prefix=IGNORED %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -enable-batch-mode -j 2 -emit-module %S/Inputs/main.swift %S/Inputs/lib.swift 2>&1 | FileCheck -check-prefix=IGNORED-MODULE %s
+
+// OBJECT: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{[^ ]*}}/Inputs/single_int.swift {{[^ ]*}}/batch-mode.swift {{.*}} -o main.o -o lib.o
+// OBJECT-NEXT: bin/swift -frontend -c {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/Inputs/lib.swift -primary-file {{[^ ]*}}/Inputs/single_int.swift -primary-file {{[^ ]*}}/batch-mode.swift {{.*}} -o single_int.o -o batch-mode.o
+// OBJECT-NOT: bin/swift -frontend
+
+// LINK: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{.*}} -emit-module-doc-path {{[^ ]*}}/main-{{[^ ]*}}.swiftdoc -emit-module-doc-path {{[^ ]*}}/lib-{{[^ ]*}}.swiftdoc {{.*}} -emit-module-path [[MAIN:[^ ]*]].swiftmodule -emit-module-path [[LIB:[^ ]*]].swiftmodule {{.*}} -o [[MAIN]].o -o [[LIB]].o
+// LINK-NEXT: bin/swift -frontend -c {{.*}} -primary-file {{[^ ]*}}/Inputs/single_int.swift -primary-file {{[^ ]*}}/batch-mode.swift {{.*}} -emit-module-path [[SINGLE:[^ ]*]].swiftmodule -emit-module-path [[BATCH:[^ ]*]].swiftmodule {{.*}} -o [[SINGLE]].o -o [[BATCH]].o
+// LINK-NEXT: bin/swift -frontend -emit-module [[MAIN]].swiftmodule [[LIB]].swiftmodule [[SINGLE]].swiftmodule [[BATCH]].swiftmodule {{.*}}
+// LINK-NEXT: bin/ld [[MAIN]].o [[LIB]].o [[SINGLE]].o [[BATCH]].o
+
+// SMALL: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/Inputs/lib.swift {{.*}} -o main.o
+// SMALL-NEXT: bin/swift -frontend -c {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{.*}} -o lib.o
+
+// IGNORED: warning: ignoring -enable-batch-mode because '-serialize-diagnostics' was also specified
+// IGNORED: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift {{[^ ]*}}/Inputs/lib.swift
+// IGNORED: bin/swift -frontend -c {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift
+
+// IGNORED-MODULE: warning: ignoring -enable-batch-mode because '-emit-module' was also specified
@@ -0,0 +1,22 @@
+// RUN: %swiftc_driver -driver-print-actions -target x86_64-apple-macosx10.9 -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch %s 2>&1 | FileCheck -check-prefix=ACTIONS %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -c %S/Inputs/main.swift %s 2>&1 | FileCheck -check-prefix=JOBS %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -import-objc-header %S/Inputs/bridging-header.h -enable-bridging-pch -enable-batch-mode -j 2 -c %S/Inputs/main.swift %S/Inputs/lib.swift %s 2>&1 | FileCheck -check-prefix=BATCH %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -import-objc-header %S/Inputs/bridging-header.h -c %s 2>&1 | FileCheck -check-prefix=NOPCH %s
+
+// ACTIONS: 0: input, "{{.*}}bridging-pch.swift", swift
+// ACTIONS: 1: input, "{{.*}}bridging-header.h", objc-header
+// ACTIONS: 2: generate-pch, {1}, pch
+// ACTIONS: 3: compile, {0, 2}, object
+// ACTIONS: 4: link, {3}, image
+
+// JOBS: bin/swift -frontend {{.*}}/Inputs/bridging-header.h -emit-pch -module-name ThisModule -o [[PCH:[^ ]*]].pch
+// JOBS-NEXT: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift {{.*}} -import-objc-header [[PCH]].pch
+// JOBS-NEXT: bin/swift -frontend -c {{.*}} -primary-file {{[^ ]*}}/bridging-pch.swift {{.*}} -import-objc-header [[PCH]].pch
+// JOBS-NOT: -emit-pch
+
+// BATCH: bin/swift -frontend {{.*}} -emit-pch {{.*}} -o [[PCH:[^ ]*]].pch
+// BATCH-NEXT: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift -primary-file {{[^ ]*}}/Inputs/lib.swift {{.*}} -import-objc-header [[PCH]].pch {{.*}} -o main.o -o lib.o
+// BATCH-NEXT: bin/swift -frontend -c {{.*}} -primary-file {{[^ ]*}}/bridging-pch.swift {{.*}} -import-objc-header [[PCH]].pch {{.*}} -o bridging-pch.o
+
+// NOPCH-NOT: -emit-pch
+// NOPCH: bin/swift -frontend -c -primary-file {{[^ ]*}}/bridging-pch.swift {{.*}} -import-objc-header {{[^ ]*}}/Inputs/bridging-header.h
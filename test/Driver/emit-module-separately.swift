@@ -0,0 +1,15 @@
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -emit-module-separately -c -emit-module %S/Inputs/lib.swift %s 2>&1 | FileCheck %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -emit-module-separately -c -emit-module %S/Inputs/lib.swift %s 2>&1 | FileCheck -check-prefix=NO-PARTIAL %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -emit-module-separately -enable-batch-mode -j 2 -c -emit-module %S/Inputs/lib.swift %s 2>&1 | FileCheck -check-prefix=NO-PARTIAL %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -emit-module-separately -O -c -emit-module %S/Inputs/lib.swift %s 2>&1 | FileCheck -check-prefix=OPTIMIZED %s
+
+// The module is built from the sources, rather than from partial modules.
+// CHECK-DAG: bin/swift{{c?}} -frontend -c -primary-file {{[^ ]*}}/Inputs/lib.swift {{.*}}-o {{[^ ]*}}.o
+// CHECK-DAG: bin/swift{{c?}} -frontend -c {{[^ ]*}}/Inputs/lib.swift -primary-file {{[^ ]*}}/emit-module-separately.swift {{.*}}-o {{[^ ]*}}.o
+// CHECK-DAG: bin/swift{{c?}} -frontend -emit-module {{[^ ]*}}/Inputs/lib.swift {{[^ ]*}}/emit-module-separately.swift {{.*}}-module-name ThisModule -o ThisModule.swiftmodule{{$}}
+
+// NO-PARTIAL-NOT: -primary-file {{.*}}-emit-module-path
+// NO-PARTIAL-NOT: -primary-file {{.*}}-emit-module-doc-path
+// NO-PARTIAL-NOT: -parse-as-library
+
+// OPTIMIZED: bin/swift{{c?}} -frontend -emit-module {{.*}} -O {{.*}}-o ThisModule.swiftmodule{{$}}
@@ -0,0 +1,4 @@
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -wmo -num-threads 4 -O -object-cache-path /tmp/objects -c %S/Inputs/main.swift %s 2>&1 | FileCheck %s
+
+// CHECK: bin/swift -frontend -c {{.*}} -O -object-cache-path /tmp/objects
+// CHECK-NOT: -object-cache-path
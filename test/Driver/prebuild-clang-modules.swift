@@ -0,0 +1,21 @@
+// RUN: %swiftc_driver -driver-print-actions -target x86_64-apple-macosx10.9 -prebuild-clang-modules %S/Inputs/main.swift %s 2>&1 | FileCheck -check-prefix=ACTIONS %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -prebuild-clang-modules -c %S/Inputs/main.swift %s 2>&1 | FileCheck -check-prefix=JOBS %s
+// RUN: %swiftc_driver -driver-print-jobs -target x86_64-apple-macosx10.9 -module-name ThisModule -prebuild-clang-modules -c %s 2>&1 | FileCheck -check-prefix=SINGLE %s
+
+// ACTIONS: 0: input, "{{.*}}/Inputs/main.swift", swift
+// ACTIONS: 1: input, "{{.*}}/Inputs/main.swift", swift
+// ACTIONS: 2: input, "{{.*}}prebuild-clang-modules.swift", swift
+// ACTIONS: 3: resolve-imports, {1, 2}, none
+// ACTIONS: 4: compile, {0, 3}, object
+// ACTIONS: 5: input, "{{.*}}prebuild-clang-modules.swift", swift
+// ACTIONS: 6: compile, {5, 3}, object
+// ACTIONS: 7: link, {4, 6}, image
+
+// JOBS: bin/swift -frontend {{.*}}/Inputs/main.swift {{[^ ]*}}/prebuild-clang-modules.swift -resolve-imports -module-name ThisModule{{$}}
+// JOBS-NEXT: bin/swift -frontend -c -primary-file {{[^ ]*}}/Inputs/main.swift {{.*}} -o main.o{{$}}
+// JOBS-NEXT: bin/swift -frontend -c {{.*}} -primary-file {{[^ ]*}}/prebuild-clang-modules.swift {{.*}} -o prebuild-clang-modules.o{{$}}
+// JOBS-NOT: -resolve-imports
+
+// SINGLE-NOT: -resolve-imports
+// SINGLE: bin/swift -frontend -c -primary-file {{[^ ]*}}/prebuild-clang-modules.swift
+// SINGLE-NOT: -resolve-imports
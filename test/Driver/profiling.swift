@@ -8,6 +8,8 @@
 
 // RUN: %swiftc_driver -driver-print-jobs -profile-generate -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=CHECK -check-prefix=LINUX %s
 
+// RUN: %swiftc_driver -driver-print-jobs -profile-generate -profile-thread-local-counters -target x86_64-unknown-linux-gnu %s | FileCheck -check-prefix=THREAD_LOCAL %s
+
 // CHECK: swift
 // CHECK: -profile-generate
 
@@ -26,3 +28,7 @@
 // LINUX: clang++{{"? }}
 // LINUX: lib/swift/clang/{{[^ ]*}}/lib/linux/libclang_rt.profile-x86_64.a
 
+
+// THREAD_LOCAL: swift
+// THREAD_LOCAL: -profile-generate
+// THREAD_LOCAL: -profile-thread-local-counters
@@ -0,0 +1,3 @@
+public func libraryFunction() -> Int {
+  return 42
+}
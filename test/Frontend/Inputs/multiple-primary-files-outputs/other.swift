@@ -0,0 +1,3 @@
+public func otherFunction() -> Int {
+  return 42
+}
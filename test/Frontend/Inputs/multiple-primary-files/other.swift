@@ -0,0 +1,11 @@
+struct Other {
+  var value: Int
+}
+
+func makeOther() -> Other {
+  return Other(value: 42)
+}
+
+func otherError() {
+  let _: String = makeOther().value // expected-error {{cannot convert value of type 'Int' to specified type 'String'}}
+}
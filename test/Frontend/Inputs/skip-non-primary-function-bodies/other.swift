@@ -0,0 +1,15 @@
+func helper() -> Int {
+  // This body doesn't parse.  It is only diagnosed when this file is parsed
+  // in full.
+  return (1 +
+}
+
+@_transparent func transparentHelper() -> Int {
+  return 1
+}
+
+struct Other {
+  var computed: Int {
+    return ]
+  }
+}
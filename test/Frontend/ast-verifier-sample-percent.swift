@@ -0,0 +1,15 @@
+// RUN: %target-swift-frontend -parse -ast-verifier-sample-percent 0 %s
+// RUN: %target-swift-frontend -parse -ast-verifier-sample-percent 50 %s
+// RUN: not %target-swift-frontend -parse -ast-verifier-sample-percent 101 %s 2>&1 | FileCheck %s
+
+// CHECK: error: invalid value '101' in '-ast-verifier-sample-percent 101'
+
+struct S {
+  var x: Int
+}
+
+func f(s: S) -> Int {
+  return s.x + 1
+}
+
+let y = f(S(x: 1))
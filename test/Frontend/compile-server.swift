@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %swift_driver_plain -frontend -emit-module -o %t %S/Inputs/compile-server/ServerLib.swift -module-name ServerLib
+
+// Each job is one argument per line, terminated by an empty line. The second
+// job imports the same module as the first and fails to type-check.
+// RUN: echo '-parse' > %t/jobs
+// RUN: echo '-I' >> %t/jobs
+// RUN: echo '%t' >> %t/jobs
+// RUN: echo '%s' >> %t/jobs
+// RUN: echo '' >> %t/jobs
+// RUN: echo '-parse' >> %t/jobs
+// RUN: echo '-I' >> %t/jobs
+// RUN: echo '%t' >> %t/jobs
+// RUN: echo '-D' >> %t/jobs
+// RUN: echo 'BROKEN' >> %t/jobs
+// RUN: echo '%s' >> %t/jobs
+// RUN: echo '' >> %t/jobs
+// RUN: %swift_driver_plain -compile-server < %t/jobs > %t/statuses 2> %t/diags
+// RUN: FileCheck -check-prefix=STATUS %s < %t/statuses
+// RUN: FileCheck -check-prefix=DIAGS %s < %t/diags
+
+// RUN: not %swift_driver_plain -compile-server %s 2>&1 | FileCheck -check-prefix=ARGS %s
+
+// STATUS: exit-status: 0
+// STATUS-NEXT: exit-status: 1
+
+// DIAGS: compile-server.swift:[[@LINE+9]]:{{[0-9]+}}: error: cannot convert value of type 'Int' to specified type 'String'
+// DIAGS-NOT: error
+
+// ARGS: error: -compile-server does not take any arguments
+
+import ServerLib
+
+let x: Int = libraryFunction()
+#if BROKEN
+let y: String = libraryFunction()
+#endif
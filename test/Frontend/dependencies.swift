@@ -17,7 +17,9 @@
 // CHECK-BASIC-YAML-LABEL: depends-external:
 // CHECK-BASIC-YAML-NOT: empty\ file.swift
 // CHECK-BASIC-YAML: "{{.*}}/Swift.swiftmodule"
-// CHECK-BASIC-YAML-NOT: {{:$}}
+// CHECK-BASIC-YAML-NOT: {{^-}}
+// CHECK-BASIC-YAML-LABEL: external-interface-hashes:
+// CHECK-BASIC-YAML: - ["{{.*}}/Swift.swiftmodule", "{{[0-9a-f]+}}"]
 
 
 // RUN: %target-swift-frontend -emit-dependencies-path %t.d -emit-reference-dependencies-path %t.swiftdeps -parse %S/../Inputs/empty\ file.swift 2>&1 | FileCheck -check-prefix=NO-PRIMARY-FILE %s
@@ -64,7 +66,8 @@
 // CHECK-IMPORT-YAML-DAG: "{{.*}}Inputs/dependencies/UserClangModule.h"
 // CHECK-IMPORT-YAML-DAG: "{{.*}}Inputs/dependencies/module.modulemap"
 // CHECK-IMPORT-YAML-NOT: {{^-}}
-// CHECK-IMPORT-YAML-NOT: {{:$}}
+// CHECK-IMPORT-YAML-LABEL: external-interface-hashes:
+// CHECK-IMPORT-YAML: - ["{{.*}}/Swift.swiftmodule", "{{[0-9a-f]+}}"]
 
 // RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -DERROR -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-dependencies-path - -parse %s | FileCheck -check-prefix=CHECK-IMPORT %s
 // RUN: not %target-swift-frontend(mock-sdk: %clang-importer-sdk) -DERROR -import-objc-header %S/Inputs/dependencies/extra-header.h -emit-reference-dependencies-path - -parse -primary-file %s | FileCheck -check-prefix=CHECK-IMPORT-YAML %s
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir %t
+
+// Each primary file is compiled to its own output, in the order the
+// -primary-file options were given.
+
+// RUN: %target-swift-frontend -emit-sil -primary-file %s -primary-file %S/Inputs/multiple-primary-files-outputs/other.swift -o %t/main.sil -o %t/other.sil -module-name main
+// RUN: FileCheck -check-prefix=CHECK-MAIN %s < %t/main.sil
+// RUN: FileCheck -check-prefix=CHECK-OTHER %s < %t/other.sil
+
+// CHECK-MAIN: sil hidden @_TF4main12mainFunctionFT_Si
+// CHECK-MAIN-NOT: sil @_TF4main13otherFunctionFT_Si :
+// CHECK-OTHER: sil @_TF4main13otherFunctionFT_Si
+// CHECK-OTHER-NOT: sil hidden @_TF4main12mainFunctionFT_Si :
+
+// RUN: %target-swift-frontend -c -primary-file %s -primary-file %S/Inputs/multiple-primary-files-outputs/other.swift -o %t/main.o -o %t/other.o -module-name main
+// RUN: test -f %t/main.o && test -f %t/other.o
+
+// RUN: %target-swift-frontend -emit-sil -primary-file %s -primary-file %S/Inputs/multiple-primary-files-outputs/other.swift -o %t/main-partial.sil -o %t/other-partial.sil -module-name main -emit-module-path %t/main.swiftmodule -emit-module-path %t/other.swiftmodule
+// RUN: test -f %t/main.swiftmodule && test -f %t/other.swiftmodule
+
+func mainFunction() -> Int {
+  return otherFunction()
+}
@@ -0,0 +1,21 @@
+// RUN: %target-swift-frontend -parse -primary-file %s -primary-file %S/Inputs/multiple-primary-files/other.swift -verify
+
+// Several primary files are type-checked by one frontend invocation, and
+// diagnostics are reported for all of them.
+
+// RUN: not %target-swift-frontend -emit-module -primary-file %s -primary-file %S/Inputs/multiple-primary-files/other.swift 2>&1 | FileCheck -check-prefix=CHECK-MODE %s
+// CHECK-MODE: error: this mode does not support more than one -primary-file
+
+// RUN: not %target-swift-frontend -parse -primary-file %s -primary-file %S/Inputs/multiple-primary-files/other.swift -emit-reference-dependencies-path %t.swiftdeps 2>&1 | FileCheck -check-prefix=CHECK-DEPS %s
+// CHECK-DEPS: error: -emit-reference-dependencies-path does not support more than one -primary-file
+
+// RUN: not %target-swift-frontend -emit-object -primary-file %s -primary-file %S/Inputs/multiple-primary-files/other.swift -o %t.o 2>&1 | FileCheck -check-prefix=CHECK-OUTPUTS %s
+// CHECK-OUTPUTS: error: -o must be given once for each -primary-file (expected 2, got 1)
+
+func useOther() -> Int {
+  return makeOther().value
+}
+
+func primaryError() {
+  let _: Int = makeOther() // expected-error {{cannot convert value of type 'Other' to specified type 'Int'}}
+}
@@ -0,0 +1,14 @@
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-function-bodies/other.swift 2>&1 | FileCheck -check-prefix=FULL %s
+// RUN: %target-swift-frontend -parse -skip-non-primary-function-bodies -primary-file %s %S/Inputs/skip-non-primary-function-bodies/other.swift
+// RUN: %target-swift-frontend -emit-silgen -skip-non-primary-function-bodies -primary-file %s %S/Inputs/skip-non-primary-function-bodies/other.swift | FileCheck %s
+
+// FULL: other.swift:{{[0-9]+}}:{{[0-9]+}}: error:
+
+// CHECK-LABEL: sil hidden @{{.*}}useHelpers
+// CHECK: function_ref @{{.*}}helper
+// CHECK: function_ref @{{.*}}transparentHelper
+// CHECK: function_ref @{{.*}}computed
+// CHECK: return
+func useHelpers(o: Other) -> Int {
+  return helper() + transparentHelper() + o.computed
+}
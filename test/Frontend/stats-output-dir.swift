@@ -0,0 +1,38 @@
+// RUN: rm -rf %t && mkdir %t
+
+// RUN: %target-swift-frontend -c -primary-file %s -o %t/main.o -module-name main -stats-output-dir %t/frontend
+// RUN: cat %t/frontend/frontend-*.json | FileCheck %s
+
+// The driver passes the directory on to each frontend job, and writes the
+// totals for all of them.
+// RUN: %target-swiftc_driver -c %s %S/../Inputs/empty.swift -module-name main -o %t/driver.o -stats-output-dir %t/driver -j2 -force-single-frontend-invocation
+// RUN: cat %t/driver/driver-*.json | FileCheck %s
+
+// CHECK: "phases": {
+// CHECK-NEXT: "parse": {"wall-usec": {{[0-9]+}}, "user-usec": {{[0-9]+}}, "system-usec": {{[0-9]+}}},
+// CHECK-NEXT: "import": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: "sema": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: "silgen": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: "sil-optimization": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: "irgen": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: "llvm": {"wall-usec": {{[0-9]+}}
+// CHECK-NEXT: },
+// CHECK-NEXT: "counters": {
+// CHECK-NEXT: "jobs": 1,
+// CHECK-NEXT: "decls-deserialized": {{[1-9][0-9]*}},
+// CHECK-NEXT: "clang-decls-imported": {{[0-9]+}},
+// CHECK-NEXT: "sil-instructions": {{[1-9][0-9]*}},
+// CHECK-NEXT: "llvm-instructions": {{[1-9][0-9]*}}
+// CHECK-NEXT: },
+// CHECK-NEXT: "memory": {
+// CHECK-NEXT: "parse": {"ast-context": 0,
+// CHECK-NEXT: "import": {"ast-context": 0,
+// CHECK-NEXT: "sema": {"ast-context": {{[1-9][0-9]*}}, "constraint-solver-peak": {{[0-9]+}}, "sil-module": 0, "sil-type-lowering": 0, "clang-importer": {{[0-9]+}}, "clang": {{[0-9]+}}, "serialized-modules": {{[1-9][0-9]*}}, "malloc": {{[0-9]+}}},
+// CHECK-NEXT: "silgen": {"ast-context": {{[1-9][0-9]*}}, "constraint-solver-peak": {{[0-9]+}}, "sil-module": {{[1-9][0-9]*}}, "sil-type-lowering": {{[1-9][0-9]*}},
+// CHECK-NEXT: "sil-optimization": {"ast-context": {{[1-9][0-9]*}}, "constraint-solver-peak": {{[0-9]+}}, "sil-module": {{[1-9][0-9]*}},
+// CHECK-NEXT: "irgen": {"ast-context": {{[1-9][0-9]*}},
+// CHECK-NEXT: "llvm": {"ast-context": 0, "constraint-solver-peak": 0, "sil-module": 0, "sil-type-lowering": 0, "clang-importer": 0, "clang": 0, "serialized-modules": 0, "malloc": {{[0-9]+}}}
+
+func add(x: Int, _ y: Int) -> Int {
+  return x + y
+}
@@ -0,0 +1,86 @@
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=DEP_1 | FileCheck %s -check-prefix=FOO_STRUCT_COMMON
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=DEP_2 | FileCheck %s -check-prefix=FOO_STRUCT_COMMON
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=DEP_3 | FileCheck %s -check-prefix=FOO_STRUCT_COMMON
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=DEP_4 | FileCheck %s -check-prefix=FOO_STRUCT_COMMON
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=DEP_5 | FileCheck %s -check-prefix=BAR_STRUCT_COMMON
+
+// Completions other than member accesses still type check all locals.
+// RUN: %target-swift-ide-test -code-completion -code-complete-only-dependencies -source-filename %s -code-completion-token=EXPR_POSTFIX_BEGIN_1 | FileCheck %s -check-prefix=LOCALS_COMMON
+
+struct FooStruct {
+  var instanceVar = 0
+  func instanceFunc0() {}
+
+  func builderFunc1() -> FooStruct {
+    return self
+  }
+}
+
+struct BarStruct {
+  var fooVar = FooStruct()
+}
+
+func makeLocalInt() -> Int { return 0 }
+
+// FOO_STRUCT_COMMON: Begin completions
+// FOO_STRUCT_COMMON-NEXT: Decl[InstanceVar]/CurrNominal:    instanceVar[#Int#]{{; name=.+$}}
+// FOO_STRUCT_COMMON-NEXT: Decl[InstanceMethod]/CurrNominal: instanceFunc0()[#Void#]{{; name=.+$}}
+// FOO_STRUCT_COMMON-NEXT: Decl[InstanceMethod]/CurrNominal: builderFunc1()[#FooStruct#]{{; name=.+$}}
+// FOO_STRUCT_COMMON-NEXT: End completions
+
+// BAR_STRUCT_COMMON: Begin completions
+// BAR_STRUCT_COMMON-NEXT: Decl[InstanceVar]/CurrNominal: fooVar[#FooStruct#]{{; name=.+$}}
+// BAR_STRUCT_COMMON-NEXT: End completions
+
+// LOCALS_COMMON: Begin completions
+// LOCALS_COMMON-DAG: Decl[LocalVar]/Local: localInt[#Int#]{{; name=.+$}}
+// LOCALS_COMMON-DAG: Decl[LocalVar]/Local: localFooObject[#FooStruct#]{{; name=.+$}}
+// LOCALS_COMMON: End completions
+
+func testDependencies1() {
+  var localInt = makeLocalInt()
+  localInt += 1
+  var localFooObject = FooStruct()
+  for i in 0..<localInt {
+    localFooObject.instanceFunc0()
+  }
+  localFooObject.#^DEP_1^#
+}
+
+func testDependencies2() {
+  var localFooObject = FooStruct()
+  var localBuilt = localFooObject.builderFunc1()
+  var localInt = makeLocalInt()
+  localBuilt.#^DEP_2^#
+}
+
+func testDependencies3() {
+  var localFooObject = FooStruct()
+  var localInt = makeLocalInt()
+  if localInt > 0 {
+    var localInner = localFooObject.builderFunc1()
+    localInt = 0
+    localInner.#^DEP_3^#
+  }
+}
+
+func testDependencies4(opt: FooStruct?) {
+  var localInt = makeLocalInt()
+  guard let localFooObject = opt else { return }
+  localInt = 1
+  localFooObject.#^DEP_4^#
+}
+
+func testDependencies5() {
+  let localBarObject = BarStruct()
+  let localClosure = { (x: Int) -> Int in x + 1 }
+  localClosure(1)
+  localBarObject.#^DEP_5^#
+}
+
+func testExprPostfixBegin1() {
+  var localInt = makeLocalInt()
+  var localFooObject = FooStruct()
+  localInt += 1
+  #^EXPR_POSTFIX_BEGIN_1^#
+}
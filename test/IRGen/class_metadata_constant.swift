@@ -0,0 +1,21 @@
+// RUN: %target-swift-frontend -disable-objc-interop -primary-file %s -emit-ir | FileCheck %s
+
+// Without ObjC interop, class metadata that is complete at compile time is
+// emitted as a constant.
+
+// CHECK-DAG: @_TMfC23class_metadata_constant4Root = internal constant
+// CHECK-DAG: @_TMfC23class_metadata_constant7Derived = internal constant
+class Root {
+  var x: Int = 0
+}
+
+class Derived : Root {
+  var y: String = ""
+}
+
+// The superclass of a class with generic ancestry is filled in at runtime.
+
+// CHECK-DAG: @_TMfC23class_metadata_constant15ConcreteDerived = internal global
+class GenericBase<T> {}
+
+class ConcreteDerived : GenericBase<Int> {}
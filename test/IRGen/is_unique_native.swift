@@ -0,0 +1,47 @@
+// RUN: %target-swift-frontend -parse-stdlib -primary-file %s -O -disable-llvm-optzns -emit-ir | FileCheck %s
+
+// With optimization the uniqueness check of a native object is done inline.
+
+// CHECK-LABEL: define {{.*}}i1 @_TF16is_unique_native8isUniqueFRBoBi1_(%swift.refcounted** {{.*}}) {{.*}} {
+// CHECK-NOT: call
+// CHECK: [[RC_ADDR:%.*]] = getelementptr inbounds %swift.refcounted, %swift.refcounted* {{%.*}}, i32 0, i32 1
+// CHECK: [[RC:%.*]] = load atomic i32, i32* [[RC_ADDR]] monotonic
+// CHECK: [[COUNT:%.*]] = and i32 [[RC]], -4
+// CHECK: icmp eq i32 [[COUNT]], 4
+// CHECK-NOT: call
+// CHECK: ret i1
+public func isUnique(inout ref: Builtin.NativeObject) -> Bool {
+  return Builtin.isUnique(&ref)
+}
+
+// CHECK-LABEL: define {{.*}}i1 @_TF16is_unique_native8isUniqueFRGSqBo_Bi1_({{.*}}) {{.*}} {
+// CHECK: icmp eq %swift.refcounted* {{%.*}}, null
+// CHECK: is-unique.nonnull:
+// CHECK: load atomic i32, i32* {{%.*}} monotonic
+// CHECK: is-unique.cont:
+// CHECK: phi i1 [ false, %entry ], [ {{%.*}}, %is-unique.nonnull ]
+// CHECK-NOT: call
+// CHECK: ret i1
+public func isUnique(inout ref: Builtin.NativeObject?) -> Bool {
+  return Builtin.isUnique(&ref)
+}
+
+// CHECK-LABEL: define {{.*}}i1 @_TF16is_unique_native16isUniqueOrPinnedFRBoBi1_(%swift.refcounted** {{.*}}) {{.*}} {
+// CHECK: [[RC:%.*]] = load atomic i32, i32* {{%.*}} monotonic
+// CHECK: [[COUNT:%.*]] = and i32 [[RC]], -4
+// CHECK: [[UNIQUE:%.*]] = icmp eq i32 [[COUNT]], 4
+// CHECK: [[PINNED_BIT:%.*]] = and i32 [[RC]], 1
+// CHECK: [[PINNED:%.*]] = icmp ne i32 [[PINNED_BIT]], 0
+// CHECK: or i1 [[UNIQUE]], [[PINNED]]
+// CHECK-NOT: call
+// CHECK: ret i1
+public func isUniqueOrPinned(inout ref: Builtin.NativeObject) -> Bool {
+  return Builtin.isUniqueOrPinned(&ref)
+}
+
+// Objects which may be ObjC objects still go through the runtime.
+// CHECK-LABEL: define {{.*}}i1 @_TF16is_unique_native8isUniqueFRBOBi1_(%objc_object** {{.*}}) {{.*}} {
+// CHECK: call i1 @swift_isUniquelyReferencedNonObjC_nonNull(%objc_object*
+public func isUnique(inout ref: Builtin.UnknownObject) -> Bool {
+  return Builtin.isUnique(&ref)
+}
@@ -0,0 +1,26 @@
+// RUN: %target-swift-frontend -emit-ir -parse-stdlib -primary-file %s -emit-metadata-prefetch-table | FileCheck %s
+// RUN: %target-swift-frontend -emit-ir -parse-stdlib -primary-file %s | FileCheck --check-prefix=NO-PREFETCH %s
+
+// CHECK: @metadata_prefetch_accessors = private constant [2 x i8*] [i8* bitcast (%swift.type* ()* @_TMaGV17metadata_prefetch3BoxVS_3Foo_ to i8*), i8* bitcast (%swift.type* ()* @_TMaGV17metadata_prefetch4PairVS_3FooS1__ to i8*)]
+// CHECK: @llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @metadata_prefetch_registration, i8* null }]
+
+// NO-PREFETCH-NOT: metadata_prefetch_accessors
+// NO-PREFETCH-NOT: llvm.global_ctors
+
+struct Foo {}
+struct Box<T> {}
+struct Pair<T, U> {}
+
+func takeMetatype<T>(t: T.Type) {}
+
+func useMetatypes() {
+  takeMetatype(Box<Foo>.self)
+  takeMetatype(Pair<Foo, Foo>.self)
+
+  // Non-generic types are not instantiated at runtime and need no prefetch.
+  takeMetatype(Foo.self)
+}
+
+// CHECK-LABEL: define private void @metadata_prefetch_registration()
+// CHECK:         call void @swift_prefetchGenericMetadata(i8** getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata_prefetch_accessors, i32 0, i32 0), i8** getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata_prefetch_accessors, i32 0, i32 2))
+// CHECK-NEXT:    ret void
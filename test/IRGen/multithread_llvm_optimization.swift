@@ -0,0 +1,27 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -O -num-threads 4 -module-name test | FileCheck %s
+
+// Test that optimizing the LLVM module of a primary file in several
+// partitions preserves the linkage of the symbols in the module.
+
+// CHECK-DAG: define {{.*}}@_TF4test9publicSumFSiSi(
+public func publicSum(x: Int) -> Int {
+  return privateSum(x) + internalSum(x)
+}
+
+// CHECK-DAG: define internal {{.*}}@_TF4testP{{.*}}10privateSumFSiSi(
+@inline(never)
+private func privateSum(x: Int) -> Int {
+  var sum = 0
+  for i in 0..<x {
+    sum = sum &+ i
+  }
+  return sum
+}
+
+// CHECK-DAG: define hidden {{.*}}@_TF4test11internalSumFSiSi(
+@inline(never)
+func internalSum(x: Int) -> Int {
+  return x &* 3
+}
+
+// CHECK-NOT: __swift_partition_unnamed
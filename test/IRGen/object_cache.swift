@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t/first %t/second
+
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -o %t/first/main.o %S/multithread_module.swift -o %t/first/mt_module.o -num-threads 2 -O -module-name test -object-cache-path %t/cache
+// RUN: ls %t/cache/*.o | count 2
+// RUN: ls %t/cache/*.input | count 2
+
+// The second compilation must reuse the cached object files.
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -o %t/second/main.o %S/multithread_module.swift -o %t/second/mt_module.o -num-threads 2 -O -module-name test -object-cache-path %t/cache
+// RUN: ls %t/cache/*.o | count 2
+// RUN: cmp %t/first/main.o %t/second/main.o
+// RUN: cmp %t/first/mt_module.o %t/second/mt_module.o
+
+// Unchanged modules are found before the LLVM optimizations run.
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -o %t/second/main.o %S/multithread_module.swift -o %t/second/mt_module.o -num-threads 2 -O -module-name test -object-cache-path %t/cache -Xllvm -print-after-all 2>&1 | FileCheck -allow-empty -check-prefix=CACHED %s
+// CACHED-NOT: IR Dump
+
+// A different optimization level must not hit the cache.
+// RUN: %target-swift-frontend -c %S/Inputs/multithread_module/main.swift -o %t/second/main.o %S/multithread_module.swift -o %t/second/mt_module.o -num-threads 2 -Onone -module-name test -object-cache-path %t/cache
+// RUN: ls %t/cache/*.o | count 4
+
+// Test that unchanged LLVM modules reuse the object files of a previous
+// multi-threaded compilation.
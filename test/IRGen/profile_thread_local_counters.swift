@@ -0,0 +1,20 @@
+// RUN: %target-swift-frontend -profile-generate -profile-thread-local-counters -emit-ir %s | FileCheck %s
+
+// The counters are incremented in a per-thread copy, which a merge function
+// adds to the shared counters when the thread exits.
+
+// CHECK: @{{.*}}.thread = internal thread_local global [{{[0-9]+}} x i64] zeroinitializer
+// CHECK: @__swift_thread_profile_counters_registered = internal thread_local global i8 0
+
+// CHECK-LABEL: define {{.*}} @_TF29profile_thread_local_counters3fooFSbT_
+// CHECK: load i8, i8* @__swift_thread_profile_counters_registered
+// CHECK: call void @swift_registerThreadLocalProfileCounters(void ()* @__swift_merge_thread_profile_counters)
+// CHECK: ret void
+func foo(b: Bool) {
+  if b {
+  }
+}
+
+// CHECK-LABEL: define internal void @__swift_merge_thread_profile_counters()
+// CHECK: call void @swift_mergeProfileCounters(i64* {{.*}}, i64* {{.*}}.thread, {{.*}}), i{{32|64}} 2)
+// CHECK: ret void
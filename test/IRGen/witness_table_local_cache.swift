@@ -0,0 +1,23 @@
+// RUN: %target-swift-frontend -emit-ir -primary-file %s | FileCheck %s
+
+// Test that a witness table for a dependent conformance is only fetched once
+// per block in unspecialized generic code.
+
+protocol Wrapper {
+  typealias Wrapped
+}
+
+struct Box<T> : Wrapper {
+  typealias Wrapped = T
+}
+
+func takesWrapper<W : Wrapper>(w: W) {}
+
+// CHECK-LABEL: define hidden void @_TF25witness_table_local_cache8useTwice
+// CHECK:         call i8** @_TWa{{.*}}3Box{{.*}}7Wrapper{{.*}}(
+// CHECK-NOT:     call i8** @_TWa
+// CHECK:         ret void
+func useTwice<T>(x: Box<T>) {
+  takesWrapper(x)
+  takesWrapper(x)
+}
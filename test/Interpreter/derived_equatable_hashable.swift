@@ -0,0 +1,73 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+struct Point : Hashable {
+  var x: Int
+  var y: Int
+}
+
+struct Labeled : Hashable {
+  var label: String
+  var point: Point
+}
+
+enum Shape : Hashable {
+  case Circle(center: Point, radius: Int)
+  case Polygon(String, Int)
+  case Empty
+}
+
+var DerivedEquatableHashable = TestSuite("Derived Equatable and Hashable")
+
+DerivedEquatableHashable.test("struct equality") {
+  expectTrue(Point(x: 1, y: 2) == Point(x: 1, y: 2))
+  expectFalse(Point(x: 1, y: 2) == Point(x: 2, y: 1))
+  expectTrue(Labeled(label: "a", point: Point(x: 0, y: 0)) ==
+             Labeled(label: "a", point: Point(x: 0, y: 0)))
+  expectFalse(Labeled(label: "a", point: Point(x: 0, y: 0)) ==
+              Labeled(label: "b", point: Point(x: 0, y: 0)))
+}
+
+DerivedEquatableHashable.test("struct hashing") {
+  expectEqual(Point(x: 1, y: 2).hashValue, Point(x: 1, y: 2).hashValue)
+  // The members are combined in order.
+  expectNotEqual(Point(x: 1, y: 2).hashValue, Point(x: 2, y: 1).hashValue)
+
+  var points = Set<Point>()
+  for x in 0..<10 {
+    for y in 0..<10 {
+      points.insert(Point(x: x, y: y))
+    }
+  }
+  expectEqual(100, points.count)
+  expectTrue(points.contains(Point(x: 3, y: 7)))
+  expectFalse(points.contains(Point(x: 3, y: 10)))
+}
+
+DerivedEquatableHashable.test("enum equality") {
+  let circle = Shape.Circle(center: Point(x: 0, y: 0), radius: 1)
+  expectTrue(circle == .Circle(center: Point(x: 0, y: 0), radius: 1))
+  expectFalse(circle == .Circle(center: Point(x: 0, y: 0), radius: 2))
+  expectFalse(circle == .Empty)
+  expectTrue(Shape.Polygon("square", 4) == .Polygon("square", 4))
+  expectFalse(Shape.Polygon("square", 4) == .Polygon("diamond", 4))
+  expectTrue(Shape.Empty == .Empty)
+}
+
+DerivedEquatableHashable.test("enum hashing") {
+  expectEqual(Shape.Polygon("square", 4).hashValue,
+              Shape.Polygon("square", 4).hashValue)
+  // Cases with the same payload hash differently.
+  expectNotEqual(Shape.Polygon("", 0).hashValue, Shape.Empty.hashValue)
+  let shapes: Set<Shape> = [.Empty, .Polygon("square", 4), .Empty]
+  expectEqual(2, shapes.count)
+}
+
+DerivedEquatableHashable.test("_combineHashValues") {
+  expectNotEqual(_combineHashValues(_combineHashValues(0, 1), 2),
+                 _combineHashValues(_combineHashValues(0, 2), 1))
+}
+
+runAllTests()
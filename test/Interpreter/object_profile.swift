@@ -0,0 +1,26 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: env SWIFT_RUNTIME_OBJECT_PROFILE=%t/profile.json SWIFT_RUNTIME_OBJECT_PROFILE_SAMPLE=1 %target-run %t/a.out
+// RUN: FileCheck %s < %t/profile.json
+// REQUIRES: executable_test
+
+// CHECK: "sampleInterval": 1,
+// CHECK: "types": [
+// CHECK: {"name": "{{[A-Za-z_]+}}.Profiled", "allocations": 100, "allocatedBytes": {{[0-9]+}}, "retains": {{[0-9]+}}, "releases": {{[0-9]+}}}
+
+final class Profiled {
+  var value: Int
+  init(_ value: Int) { self.value = value }
+}
+
+@inline(never)
+func makeObjects() -> Int {
+  var total = 0
+  for i in 0..<100 {
+    let object = Profiled(i)
+    total += object.value
+  }
+  return total
+}
+
+print(makeObjects())
@@ -365,6 +365,43 @@ bb1:
   ret void
 }
 
+; CHECK-LABEL: @retain_release_across_branch(
+; CHECK-NOT: swift_retain
+; CHECK-NOT: swift_release
+; CHECK: ret void
+define void @retain_release_across_branch(%swift.refcounted* %A, i1 %c, i8* %P) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  store i8 1, i8* %P
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb3
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb3
+bb3:
+  ret void
+}
+
+; A successor that can be entered from elsewhere keeps the pair.
+; CHECK-LABEL: @retain_release_across_branch_join(
+; CHECK: swift_retain
+; CHECK: swift_release
+; CHECK: swift_release
+; CHECK: ret void
+define void @retain_release_across_branch_join(%swift.refcounted* %A, i1 %c) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  br i1 %c, label %bb1, label %bb2
+bb1:
+  tail call void @swift_release(%swift.refcounted* %A)
+  br label %bb2
+bb2:
+  tail call void @swift_release(%swift.refcounted* %A)
+  ret void
+}
+
 
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
@@ -12,6 +12,7 @@ declare %swift.bridge* @swift_bridgeObjectRetain(%swift.bridge*)
 declare void @swift_bridgeObjectRelease(%swift.bridge* )
 declare void @swift_release(%swift.refcounted* nocapture)
 declare void @swift_retain(%swift.refcounted* ) nounwind
+declare void @swift_retainUnowned(%swift.refcounted* ) nounwind
 declare void @swift_unknownRelease(%swift.refcounted* nocapture)
 declare void @swift_unknownRetain(%swift.refcounted* ) nounwind
 declare void @swift_fixLifetime(%swift.refcounted*)
@@ -580,3 +581,35 @@ bb3:
 !2 = !DIFile(filename: "contract.swift", directory: "")
 !3 = distinct !DISubprogram(name: "_", scope: !1, file: !2, type: !DISubroutineType(types: !{}))
 !4 = !{i32 1, !"Debug Info Version", i32 3}
+
+; CHECK-LABEL: define void @swift_contractRetainUnownedN(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @swift_retainUnowned_n(%swift.refcounted* %A, i32 3)
+; CHECK-NEXT: call void @noread_user(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainUnownedN(%swift.refcounted* %A) {
+entry:
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_retainUnowned(%swift.refcounted* %A)
+  call void @noread_user(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_retainUnowned(%swift.refcounted* %A)
+  ret void
+}
+
+; A release between two retainUnowned calls may make the second one fail.
+; CHECK-LABEL: define void @swift_contractRetainUnownedNRelease(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @swift_retainUnowned_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: tail call void @swift_release(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @swift_retainUnowned(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainUnownedNRelease(%swift.refcounted* %A) {
+entry:
+  tail call void @swift_retainUnowned(%swift.refcounted* %A)
+  tail call void @swift_retain(%swift.refcounted* %A)
+  tail call void @swift_release(%swift.refcounted* %A)
+  tail call void @swift_retainUnowned(%swift.refcounted* %A)
+  ret void
+}
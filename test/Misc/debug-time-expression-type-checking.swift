@@ -0,0 +1,7 @@
+// RUN: %target-swift-frontend -parse -debug-time-expression-type-checking %s 2>&1 | FileCheck %s
+
+// CHECK-DAG: {{[0-9.]+}}ms{{.*}}debug-time-expression-type-checking.swift:4:6{{.*}}function body
+func foo() -> Int {
+  // CHECK-DAG: {{[0-9.]+}}ms{{.*}}debug-time-expression-type-checking.swift:6:{{[0-9]+}}{{.*}}expression{{.*}}PeakSolverMemory={{[0-9]+}}
+  return 1 + 2 * 3
+}
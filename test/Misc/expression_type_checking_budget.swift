@@ -0,0 +1,11 @@
+// RUN: %target-parse-verify-swift -warn-expression-type-variable-bindings=2
+// RUN: %target-swift-frontend -parse -solver-binding-threshold 2 %s 2>&1 | FileCheck -check-prefix=HARD %s
+
+// Each of these literals is a separate component, so solving the tuple
+// attempts at least four bindings.
+let tuple = (1, 2.5, "a", true) // expected-warning{{type variable bindings to type-check (limit: 2)}}
+// HARD: expression_type_checking_budget.swift:[[@LINE-1]]:{{[0-9]+}}: error: expression was too complex to be solved in reasonable time
+
+// This one stays within budget.
+let single = 1
+// HARD-NOT: error
@@ -10,6 +10,8 @@
 // RUN: FileCheck -check-prefix=DEPENDS-NOMINAL-NEGATIVE %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER %s < %t.swiftdeps
 // RUN: FileCheck -check-prefix=DEPENDS-MEMBER-NEGATIVE %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=DECL-HASHES %s < %t.swiftdeps
+// RUN: FileCheck -check-prefix=DECL-HASHES-NEGATIVE %s < %t.swiftdeps
 
 
 // PROVIDES-NOMINAL-LABEL: {{^provides-nominal:$}}
@@ -20,11 +22,16 @@
 // DEPENDS-NOMINAL-NEGATIVE-LABEL: {{^depends-nominal:$}}
 // DEPENDS-MEMBER-LABEL: {{^depends-member:$}}
 // DEPENDS-MEMBER-NEGATIVE-LABEL: {{^depends-member:$}}
+// DECL-HASHES-LABEL: {{^decl-interface-hashes:$}}
+// DECL-HASHES-NEGATIVE-LABEL: {{^decl-interface-hashes:$}}
 
 // PROVIDES-NOMINAL-DAG: 4Base"
+// DECL-HASHES-DAG: - ["Base", "{{[0-9a-f]+}}"]
+// DECL-HASHES-DAG: - ["{{.+}}4Base", "{{[0-9a-f]+}}"]
 class Base {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}4Base", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}4Base", "foo"]
+  // DECL-HASHES-DAG: - ["{{.+}}4Base", "foo", "{{[0-9a-f]+}}"]
   func foo() {}
 }
   
@@ -32,7 +39,7 @@ class Base {
 // DEPENDS-NOMINAL-DAG: 9OtherBase"
 class Sub : OtherBase {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", ""]
-  // PROVIDES-MEMBER-NEGATIVE-NOT: - ["{{.+}}3Sub", "{{.+}}"]
+  // PROVIDES-MEMBER-DAG: - ["{{.+}}3Sub", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", ""]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}9OtherBase", "init"]
@@ -58,6 +65,9 @@ extension OtherStruct {
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // PROVIDES-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // PROVIDES-MEMBER-NEGATIVE-NOT: "baz"
+  // DECL-HASHES-DAG: - ["{{.+}}11OtherStruct", "foo", "{{[0-9a-f]+}}"]
+  // DECL-HASHES-DAG: - ["{{.+}}11OtherStruct", "bar", "{{[0-9a-f]+}}"]
+  // DECL-HASHES-NEGATIVE-NOT: "baz"
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "foo"]
   // DEPENDS-MEMBER-DAG: - ["{{.+}}11OtherStruct", "bar"]
   // DEPENDS-MEMBER-DAG: - !private ["{{.+}}11OtherStruct", "baz"]
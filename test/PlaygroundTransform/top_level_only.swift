@@ -0,0 +1,45 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cp %s %t/main.swift
+// RUN: %target-build-swift -Xfrontend -playground -Xfrontend -playground-top-level-only -Xfrontend -debugger-support -o %t/main %S/Inputs/PlaygroundsRuntime.swift %t/main.swift
+// RUN: %target-run %t/main | FileCheck %s
+// REQUIRES: executable_test
+
+func next(x: Int) -> Int {
+  let y = x + 1
+  return y
+}
+
+var a = 0
+for i in 0..<3 {
+  a = next(a)
+}
+// CHECK: [{{.*}}] $builtin_log[a='0']
+// CHECK-NEXT: [{{.*}}] $builtin_log[='3']
+
+var b = 0
+while b < 5 {
+  b += 1
+}
+// CHECK-NEXT: [{{.*}}] $builtin_log[b='0']
+// CHECK-NEXT: [{{.*}}] $builtin_log[='5']
+
+for i in 0..<10 {
+  for j in 0..<10 {
+    b += j
+  }
+  if i == 2 {
+    break
+  }
+}
+// CHECK-NEXT: [{{.*}}] $builtin_log[='3']
+
+var c = 0
+repeat {
+  c = next(c)
+} while c < 4
+// CHECK-NEXT: [{{.*}}] $builtin_log[c='0']
+// CHECK-NEXT: [{{.*}}] $builtin_log[='4']
+
+a
+// CHECK-NEXT: [{{.*}}] $builtin_log[='3']
@@ -3,13 +3,13 @@
 // CHECK-LABEL: sil_coverage_map {{.*}}// coverage_switch.f1
 func f1(x : Int32) {
   switch (x) {
-  case 1: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 2
+  case 1: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 1
     break
-  case 2: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:16 : 3
+  case 2: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:16 : 2
     fallthrough
-  default: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:14 : (3 + 4)
+  default: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:14 : (0 - 1)
     f1(x - 1)
-  } // CHECK: [[@LINE]]:4 -> [[@LINE+3]]:2 : 1
+  } // CHECK: [[@LINE]]:4 -> [[@LINE+3]]:2 : 0
 
   var y = x
 }
@@ -26,18 +26,18 @@ func nop() {}
 // CHECK-LABEL: sil_coverage_map {{.*}}// coverage_switch.f2
 func f2(x : Algebraic) -> Int32 {
   switch(x) {
-  case let .Type1(y, z): // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 2
+  case let .Type1(y, z): // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 1
     nop()
-  case .Type2(let b): // CHECK: [[@LINE]]:3 -> [[@LINE+2]]:16 : 3
+  case .Type2(let b): // CHECK: [[@LINE]]:3 -> [[@LINE+2]]:16 : 2
     nop()
     fallthrough
-  case .Type3: // CHECK: [[@LINE]]:3 -> [[@LINE+3]]:6 : (3 + 4)
-    if (false) { // CHECK: [[@LINE]]:16 -> [[@LINE+2]]:6 : 5
+  case .Type3: // CHECK: [[@LINE]]:3 -> [[@LINE+3]]:6 : (2 + 3)
+    if (false) { // CHECK: [[@LINE]]:16 -> [[@LINE+2]]:6 : 4
       fallthrough
     }
-  case .Type4: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : (5 + 6)
+  case .Type4: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : ((((0 + 4) - 1) - 2) - 3)
     break
-  } // CHECK: [[@LINE]]:4 -> [[@LINE+1]]:11 : 1
+  } // CHECK: [[@LINE]]:4 -> [[@LINE+1]]:11 : 0
   return 0
 }
 
@@ -48,11 +48,11 @@ public enum Simple {
 // CHECK-LABEL: sil_coverage_map {{.*}}// coverage_switch.f3
 func f3(x : Simple) -> Int32 {
   switch (x) {
-  case .First: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:13 : 2
+  case .First: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:13 : 1
     return 1
-  case .Second: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : 3
+  case .Second: // CHECK: [[@LINE]]:3 -> [[@LINE+1]]:10 : (0 - 1)
     break
-  } // CHECK: [[@LINE]]:4 -> [[@LINE+2]]:11 : 1
+  } // CHECK: [[@LINE]]:4 -> [[@LINE+2]]:11 : 0
 
   return 0
 }
@@ -61,3 +61,25 @@ func exceptions() {
 
   // CHECK-NOT: builtin "int_instrprof_increment"
 }
+
+// The count of the last case is derived from the others.
+// CHECK: sil hidden @[[F_SWITCHES:.*switches.*]] :
+// CHECK: %[[NAME:.*]] = string_literal utf8 "[[F_SWITCHES]]"
+// CHECK: %[[HASH:.*]] = integer_literal $Builtin.Int64,
+// CHECK: %[[NCOUNTS:.*]] = integer_literal $Builtin.Int32, 3
+// CHECK: %[[INDEX:.*]] = integer_literal $Builtin.Int32, 0
+// CHECK: builtin "int_instrprof_increment"(%[[NAME]] : {{.*}}, %[[HASH]] : {{.*}}, %[[NCOUNTS]] : {{.*}}, %[[INDEX]] : {{.*}})
+func switches(a : Int32) {
+  switch a {
+  // CHECK: builtin "int_instrprof_increment"
+  case 0:
+    break
+  // CHECK: builtin "int_instrprof_increment"
+  case 1:
+    break
+  default:
+    break
+  }
+
+  // CHECK-NOT: builtin "int_instrprof_increment"
+}
@@ -0,0 +1,57 @@
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s
+
+// Reading a stored element of a loadable value returned by a getter projects
+// the element out of the returned value, rather than storing the value to a
+// temporary to address into it.
+
+class Ref {}
+
+struct Point {
+  var x: Int
+  var y: Int
+}
+
+struct Holder {
+  var ref: Ref
+  var count: Int
+}
+
+struct Shape {
+  var origin: Point { return Point(x: 0, y: 0) }
+  var holder: Holder { return Holder(ref: Ref(), count: 0) }
+  var pair: (Int, Ref) { return (0, Ref()) }
+}
+
+// CHECK-LABEL: sil hidden @_TF24lvalue_getter_projection11readOriginX
+func readOriginX(inout shape: Shape) -> Int {
+  // CHECK: [[GET:%.*]] = function_ref @_TFV24lvalue_getter_projection5Shapeg6origin
+  // CHECK: [[POINT:%.*]] = apply [[GET]]
+  // CHECK-NOT: alloc_stack
+  // CHECK: [[X:%.*]] = struct_extract [[POINT]] : $Point, #Point.x
+  // CHECK: return [[X]]
+  return shape.origin.x
+}
+
+// CHECK-LABEL: sil hidden @_TF24lvalue_getter_projection10readHolder
+func readHolder(inout shape: Shape) -> Ref {
+  // CHECK: [[GET:%.*]] = function_ref @_TFV24lvalue_getter_projection5Shapeg6holder
+  // CHECK: [[HOLDER:%.*]] = apply [[GET]]
+  // CHECK-NOT: alloc_stack
+  // CHECK: [[REF:%.*]] = struct_extract [[HOLDER]] : $Holder, #Holder.ref
+  // CHECK: strong_retain [[REF]]
+  // CHECK: release_value [[HOLDER]]
+  // CHECK: return [[REF]]
+  return shape.holder.ref
+}
+
+// CHECK-LABEL: sil hidden @_TF24lvalue_getter_projection8readPair
+func readPair(inout shape: Shape) -> Ref {
+  // CHECK: [[GET:%.*]] = function_ref @_TFV24lvalue_getter_projection5Shapeg4pair
+  // CHECK: [[PAIR:%.*]] = apply [[GET]]
+  // CHECK-NOT: alloc_stack
+  // CHECK: [[REF:%.*]] = tuple_extract [[PAIR]] : $(Int, Ref), 1
+  // CHECK: strong_retain [[REF]]
+  // CHECK: release_value [[PAIR]]
+  // CHECK: return [[REF]]
+  return shape.pair.1
+}
@@ -0,0 +1,10 @@
+// RUN: not %target-swift-frontend -profile-use=%t.missing.profdata -emit-silgen -module-name profile_use %s 2>&1 | FileCheck --check-prefix=MISSING %s
+
+// MISSING: error: cannot open profile data '{{.*}}missing.profdata'
+
+func foo(x: Bool) -> Int {
+  if x {
+    return 1
+  }
+  return 0
+}
@@ -0,0 +1,67 @@
+// RUN: %target-swift-frontend -emit-silgen %s | FileCheck %s
+
+func a() {}
+func b() {}
+func c() {}
+func d() {}
+
+// Literal cases are dispatched with one switch_value instead of a '~=' call
+// per case.
+
+// CHECK-LABEL: sil hidden @_TF23switch_integer_literals8classify
+func classify(x: Int) {
+  // CHECK: [[VALUE:%.*]] = struct_extract %0 : $Int, #Int._value
+  // CHECK: switch_value [[VALUE]] : $Builtin.Int{{[0-9]+}}, case {{%.*}}: [[CASE1:bb[0-9]+]], case {{%.*}}: [[CASE2:bb[0-9]+]], case {{%.*}}: [[CASE3:bb[0-9]+]], default [[DEFAULT:bb[0-9]+]]
+  // CHECK-NOT: ~=
+  switch x {
+  // CHECK: [[CASE1]]:
+  // CHECK: function_ref @_TF23switch_integer_literals1aFT_T_
+  case 1:
+    a()
+  // CHECK: [[CASE2]]:
+  // CHECK: function_ref @_TF23switch_integer_literals1bFT_T_
+  case -2:
+    b()
+  // CHECK: [[CASE3]]:
+  // CHECK: function_ref @_TF23switch_integer_literals1cFT_T_
+  case 300:
+    c()
+  // CHECK: [[DEFAULT]]:
+  // CHECK: function_ref @_TF23switch_integer_literals1dFT_T_
+  default:
+    d()
+  }
+}
+
+// A guard ends the run; the rows after it are tested with '~='.
+
+// CHECK-LABEL: sil hidden @_TF23switch_integer_literals12classifyUInt8
+func classifyUInt8(x: UInt8, flag: Bool) {
+  // CHECK: switch_value {{%.*}} : $Builtin.Int8, case {{%.*}}: {{bb[0-9]+}}, case {{%.*}}: {{bb[0-9]+}}, default [[DEFAULT:bb[0-9]+]]
+  switch x {
+  case 0:
+    a()
+  case 255:
+    b()
+  // CHECK: [[DEFAULT]]:
+  // CHECK: function_ref static Swift.~= infix
+  case 7 where flag:
+    c()
+  default:
+    d()
+  }
+}
+
+// A single literal case isn't worth a switch_value.
+
+// CHECK-LABEL: sil hidden @_TF23switch_integer_literals9singleton
+func singleton(x: Int) {
+  // CHECK-NOT: switch_value
+  // CHECK: function_ref static Swift.~= infix
+  switch x {
+  case 42:
+    a()
+  default:
+    d()
+  }
+}
@@ -0,0 +1,8 @@
+public let maxBatch = 64
+
+public struct Limits {
+  public static let maxDepth = 16
+}
+
+// Not statically initialized, so its value can't be published.
+public let startTime = Int(readLine()?.characters.count ?? 0)
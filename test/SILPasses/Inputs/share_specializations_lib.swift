@@ -0,0 +1,7 @@
+public func identity<T>(x: T) -> T {
+  return x
+}
+
+public func identityOfInt(x: Int) -> Int {
+  return identity(x)
+}
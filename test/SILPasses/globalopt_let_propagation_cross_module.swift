@@ -0,0 +1,34 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -O -parse-as-library -module-name LetLib -o %t %S/Inputs/globalopt_let_lib.swift
+// RUN: %target-swift-frontend -emit-sil -O -module-name main -I %t %s | FileCheck %s
+
+// Check that the values of statically initialized global and static lets of
+// another module are propagated into their uses.
+
+import LetLib
+
+// CHECK-LABEL: sil @{{.*}}batchLimit
+// CHECK-NOT: function_ref
+// CHECK: integer_literal $Builtin.Int{{32|64}}, 64
+// CHECK-NOT: function_ref
+// CHECK: return
+public func batchLimit() -> Int {
+  return maxBatch
+}
+
+// CHECK-LABEL: sil @{{.*}}depthLimit
+// CHECK-NOT: function_ref
+// CHECK: integer_literal $Builtin.Int{{32|64}}, 32
+// CHECK-NOT: function_ref
+// CHECK: return
+public func depthLimit() -> Int {
+  return Limits.maxDepth * 2
+}
+
+// CHECK-LABEL: sil @{{.*}}elapsed
+// CHECK: function_ref {{.*}}startTime
+// CHECK: return
+public func elapsed() -> Int {
+  return startTime
+}
@@ -0,0 +1,22 @@
+// RUN: %target-swift-frontend -emit-sil -O -parse-as-library -module-name PrespecLib -prespecialize-from-profile %S/Inputs/prespecialization_profile.txt %s | FileCheck %s
+// RUN: not %target-swift-frontend -emit-sil -O -parse-as-library -module-name PrespecLib -prespecialize-from-profile %t.missing %s 2>&1 | FileCheck --check-prefix=MISSING %s
+
+// Box<Int> was requested often enough, so its methods are specialized and
+// published. Box<Double> was not, and Unknown isn't a type of this module.
+
+// CHECK-DAG: sil @_TTSg{{.*}}Si{{.*}}10PrespecLib3Box3get
+// CHECK-NOT: sil {{.*}}@_TTSg{{.*}}Sd{{.*}}10PrespecLib3Box3get
+
+// MISSING: cannot open profile data
+
+public struct Box<T> {
+  public var value: T
+
+  public init(_ value: T) {
+    self.value = value
+  }
+
+  public func get() -> T {
+    return value
+  }
+}
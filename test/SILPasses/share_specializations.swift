@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -O -sil-serialize-all -share-specializations -parse-as-library -module-name SpecLib -o %t %S/Inputs/share_specializations_lib.swift
+// RUN: %target-swift-frontend -emit-sil -O -share-specializations -module-name main -I %t %s | FileCheck %s
+// RUN: %target-swift-frontend -emit-sil -O -module-name main -I %t %s | FileCheck --check-prefix=NOSHARE %s
+
+import SpecLib
+
+// SpecLib published its specialization of identity<Int>, so we call it
+// instead of creating our own copy.
+
+// CHECK-LABEL: sil @_TF4main4testFSiSi
+// CHECK: function_ref @_TTSg{{.*}}7SpecLib8identity
+// CHECK: return
+// CHECK-NOT: sil shared @_TTSg{{.*}}7SpecLib8identity
+
+// NOSHARE-NOT: function_ref @_TTSg{{.*}}7SpecLib8identity
+public func test(x: Int) -> Int {
+  return identity(x)
+}
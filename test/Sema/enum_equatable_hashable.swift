@@ -121,5 +121,25 @@ public func ==(lhs: Medicine, rhs: Medicine) -> Bool { // expected-note{{non-mat
   return true
 }
 
+// Enums with payloads derive the conformance explicitly if the payloads
+// conform.
+enum ComplexHashable {
+  case A(Int, String)
+  case B(Foo)
+  case C
+}
+
+extension ComplexHashable : Hashable {}
+
+if ComplexHashable.A(1, "one") == .C { }
+var complexHash: Int = ComplexHashable.B(.A).hashValue
+
+struct NotEquatable {}
+
+enum ComplexNotHashable {
+  case A(NotEquatable)
+  case B
+}
+
 // No explicit conformance and cannot be derived
-extension Complex : Hashable {} // expected-error 2 {{does not conform}}
+extension ComplexNotHashable : Hashable {} // expected-error 2 {{does not conform}} expected-note 2 {{cannot automatically derive}}
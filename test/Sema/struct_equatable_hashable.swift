@@ -0,0 +1,37 @@
+// RUN: %target-parse-verify-swift
+
+struct Point {
+  var x: Int
+  var y: Int
+  static var origin = Point(x: 0, y: 0)
+}
+
+extension Point : Hashable {}
+
+if Point(x: 1, y: 2) == Point.origin { }
+var pointHash: Int = Point.origin.hashValue
+
+struct Record : Equatable {
+  let name: String
+  private var point: Point
+}
+
+func compareRecords(a: Record, b: Record) -> Bool {
+  return a == b
+}
+
+struct Generic<T : Hashable> : Hashable {
+  var value: T
+  var values: Set<T>
+}
+
+func hashGeneric<T : Hashable>(g: Generic<T>) -> Int {
+  return g.hashValue
+}
+
+struct NotEquatable {}
+
+struct NotHashable : Hashable { // expected-error 2 {{does not conform}} expected-note 2 {{cannot automatically derive}}
+  var x: Int
+  var y: NotEquatable
+}
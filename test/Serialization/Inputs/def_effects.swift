@@ -0,0 +1,10 @@
+public func addWithoutTraps(a: Int, _ b: Int) -> Int {
+  return a &+ b
+}
+
+public var counter = 0
+
+public func incrementCounter() -> Int {
+  counter = counter &+ 1
+  return counter
+}
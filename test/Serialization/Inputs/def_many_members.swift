@@ -0,0 +1,15 @@
+public class ManyMembers {
+  public init() {}
+
+  public func first() -> Int { return 1 }
+  public func second() -> Int { return 2 }
+  public func third() -> Int { return 3 }
+  public func overloaded(x: Int) -> Int { return x }
+  public func overloaded(y: String) -> String { return y }
+  public var property: Int { return 4 }
+  public subscript(i: Int) -> Int { return i }
+}
+
+extension ManyMembers {
+  public func fromExtension() -> Int { return 5 }
+}
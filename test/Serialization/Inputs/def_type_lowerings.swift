@@ -0,0 +1,23 @@
+public class Referent {}
+public protocol Opaque {}
+
+public struct TrivialPair {
+  public var x, y: Int
+}
+
+public struct HoldsReference {
+  public var r: Referent
+}
+
+public struct HoldsExistential {
+  public var o: Opaque
+}
+
+public enum TrivialChoice {
+  case A, B
+}
+
+public enum ReferenceChoice {
+  case Some(Referent)
+  case None
+}
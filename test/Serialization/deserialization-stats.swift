@@ -0,0 +1,15 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_struct.swift
+// RUN: %target-swift-frontend -parse -I %t %s -print-deserialization-stats 2>&1 | FileCheck %s
+// RUN: %target-swift-frontend -parse -I %t %s 2>&1 | FileCheck -check-prefix=NO-STATS %s
+
+// CHECK: *** Deserialization statistics ***
+// CHECK-DAG: {{^}}def_struct: {{[1-9][0-9]*}} decls, {{[0-9]+}} types, {{[0-9]+}} conformances, 0 SIL functions
+// CHECK-DAG: {{^}}  {{[1-9][0-9]*}} decls for lookup of 'TwoInts'
+
+// NO-STATS-NOT: Deserialization statistics
+
+import def_struct
+
+var b = TwoInts(x: 1, y: 2)
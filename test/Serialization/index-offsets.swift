@@ -0,0 +1,20 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_struct.swift
+// RUN: llvm-bcanalyzer -dump %t/def_struct.swiftmodule | FileCheck %s
+// RUN: %target-swift-frontend -emit-silgen -I %t %s -o /dev/null
+
+// The offset tables are stored as fixed-width blobs, so that they can be read
+// in place rather than decoded when the module is opened.
+
+// CHECK-LABEL: <INDEX_BLOCK
+// CHECK: <DECL_OFFSETS abbrevid={{[0-9]+}}/> blob data =
+// CHECK: <TYPE_OFFSETS abbrevid={{[0-9]+}}/> blob data =
+// CHECK: <IDENTIFIER_OFFSETS abbrevid={{[0-9]+}}/> blob data =
+// CHECK: <DECL_CONTEXT_OFFSETS abbrevid={{[0-9]+}}/> blob data =
+// CHECK: </INDEX_BLOCK>
+
+import def_struct
+
+var b = TwoInts(x: 1, y: 2)
+var sum = b.x + b.y
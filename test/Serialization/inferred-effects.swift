@@ -0,0 +1,24 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -O -parse-as-library -o %t %S/Inputs/def_effects.swift
+// RUN: %target-swift-frontend -emit-sil -O -module-name main -I %t %s | FileCheck %s
+
+// The bodies of the library functions are not serialized. Their effects,
+// inferred when the library was optimized, are.
+
+import def_effects
+
+// CHECK-LABEL: sil @_TF4main12callReadNoneFT_T_
+// CHECK-NOT: apply
+// CHECK: return
+public func callReadNone() {
+  addWithoutTraps(1, 2)
+}
+
+// CHECK-LABEL: sil @_TF4main14callReadWriteFT_T_
+// CHECK: [[FN:%.*]] = function_ref @_TF11def_effects16incrementCounterFT_Si
+// CHECK: apply [[FN]]()
+// CHECK: return
+public func callReadWrite() {
+  incrementCounter()
+}
@@ -0,0 +1,46 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t/base.swiftmodule %s -module-name interface_hash
+// RUN: %target-swift-frontend -emit-module -o %t/private.swiftmodule %s -module-name interface_hash -DPRIVATE_CHANGE
+// RUN: %target-swift-frontend -emit-module -o %t/public.swiftmodule %s -module-name interface_hash -DPUBLIC_CHANGE
+// RUN: %target-swift-frontend -emit-module -o %t/layout.swiftmodule %s -module-name interface_hash -DLAYOUT_CHANGE
+
+// RUN: llvm-bcanalyzer -dump %t/base.swiftmodule | FileCheck %s
+// CHECK-LABEL: <CONTROL_BLOCK
+// CHECK: <INTERFACE_HASH abbrevid={{[0-9]+}}/> blob data = '{{[0-9a-f]{32}}}'
+// CHECK: </CONTROL_BLOCK>
+
+// RUN: llvm-bcanalyzer -dump %t/base.swiftmodule | grep INTERFACE_HASH > %t/base.txt
+// RUN: llvm-bcanalyzer -dump %t/private.swiftmodule | grep INTERFACE_HASH > %t/private.txt
+// RUN: llvm-bcanalyzer -dump %t/public.swiftmodule | grep INTERFACE_HASH > %t/public.txt
+// RUN: llvm-bcanalyzer -dump %t/layout.swiftmodule | grep INTERFACE_HASH > %t/layout.txt
+
+// Changes to function bodies and private declarations don't affect clients.
+// RUN: diff %t/base.txt %t/private.txt
+
+// Changes to public declarations and to the layout of types do.
+// RUN: not diff %t/base.txt %t/public.txt
+// RUN: not diff %t/base.txt %t/layout.txt
+
+public func publicFunc() -> Int {
+#if PRIVATE_CHANGE
+  return helper()
+#else
+  return 1
+#endif
+}
+
+#if PRIVATE_CHANGE
+private func helper() -> Int { return 2 }
+#endif
+
+#if PUBLIC_CHANGE
+public func addedFunc() {}
+#endif
+
+public struct Point {
+  public var x: Int
+#if LAYOUT_CHANGE
+  private var y: Int = 0
+#endif
+  public init() { x = 0 }
+}
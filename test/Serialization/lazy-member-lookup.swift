@@ -0,0 +1,23 @@
+// REQUIRES: asserts
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_many_members.swift
+// RUN: llvm-bcanalyzer %t/def_many_members.swiftmodule | FileCheck -check-prefix=BCANALYZER %s
+// RUN: %target-swift-frontend -parse -I %t %s
+// RUN: %target-swift-frontend -emit-sil -I %t %s -o /dev/null
+
+// RUN: %target-swift-frontend -parse -I %t %s -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// BCANALYZER-NOT: UnknownCode
+
+// STATS: {{[1-9][0-9]*}} Name lookup{{ +}}- # of member lookups that loaded only the named members
+
+import def_many_members
+
+let m = ManyMembers()
+let a: Int = m.second()
+let b: String = m.overloaded("b")
+let c: Int = m.overloaded(3)
+let d: Int = m.fromExtension()
+let e: Int = m.property + m[0]
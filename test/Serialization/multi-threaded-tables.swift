@@ -0,0 +1,7 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -sil-serialize-all -o %t/serial.swiftmodule -module-name def_many_members %S/Inputs/def_many_members.swift
+// RUN: %target-swift-frontend -emit-module -sil-serialize-all -num-threads 4 -o %t/parallel.swiftmodule -module-name def_many_members %S/Inputs/def_many_members.swift
+// RUN: cmp %t/serial.swiftmodule %t/parallel.swiftmodule
+
+// Building the lookup tables on several threads must not change the module.
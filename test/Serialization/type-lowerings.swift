@@ -0,0 +1,29 @@
+// REQUIRES: asserts
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: %target-swift-frontend -emit-module -o %t %S/Inputs/def_type_lowerings.swift
+// RUN: llvm-bcanalyzer -dump %t/def_type_lowerings.swiftmodule | FileCheck -check-prefix=BCANALYZER %s
+// RUN: %target-swift-frontend -emit-silgen -I %t %s | FileCheck %s
+// RUN: %target-swift-frontend -emit-silgen -I %t %s -o /dev/null -print-stats 2>&1 | FileCheck -check-prefix=STATS %s
+
+// Modules record how their public, non-generic structs and enums lower, so
+// that clients don't have to classify the fields of imported types again.
+
+// BCANALYZER-LABEL: <SIL_INDEX_BLOCK
+// BCANALYZER: <SIL_TYPE_LOWERING_NAMES abbrevid={{[0-9]+}} op0={{[0-9]+}}/> blob data =
+// BCANALYZER-NEXT: <SIL_TYPE_LOWERINGS abbrevid={{[0-9]+}}/> blob data =
+// BCANALYZER: </SIL_INDEX_BLOCK>
+
+// STATS: {{[1-9][0-9]*}} libsil{{ +}}- Number of type lowerings built from their module file's record
+
+import def_type_lowerings
+
+// CHECK-LABEL: sil hidden @_TF{{.*}}7trivial{{.*}} : $@convention(thin) (TrivialPair, TrivialChoice) -> ()
+func trivial(p: TrivialPair, _ c: TrivialChoice) {}
+
+// CHECK-LABEL: sil hidden @_TF{{.*}}8loadable{{.*}} : $@convention(thin) (@owned HoldsReference, @owned ReferenceChoice) -> ()
+func loadable(h: HoldsReference, _ c: ReferenceChoice) {}
+
+// CHECK-LABEL: sil hidden @_TF{{.*}}11addressOnly{{.*}} : $@convention(thin) (@in HoldsExistential) -> ()
+func addressOnly(h: HoldsExistential) {}
@@ -0,0 +1,4 @@
+func helper() -> Int {
+  // Doesn't parse, but only the primary file's bodies are parsed.
+  return (1 +
+}
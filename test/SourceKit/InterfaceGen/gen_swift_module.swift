@@ -3,3 +3,8 @@
 // RUN: %swift -emit-module -o %t.mod/swift_mod.swiftmodule %S/Inputs/swift_mod.swift -parse-as-library
 // RUN: %sourcekitd-test -req=interface-gen -module swift_mod -- -I %t.mod > %t.response
 // RUN: diff -u %s.response %t.response
+
+// The second request reuses the interface generated by the first one.
+// RUN: %sourcekitd-test -req=interface-gen-open -module swift_mod -- -I %t.mod \
+// RUN:     == -req=interface-gen -module swift_mod -- -I %t.mod > %t.reused.response
+// RUN: diff -u %s.response %t.reused.response
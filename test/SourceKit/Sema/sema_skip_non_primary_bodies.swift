@@ -0,0 +1,11 @@
+func useHelper() -> Int {
+  helper()
+}
+
+// Errors anywhere in the module turn off the SIL diagnostics. The broken body
+// in the other file must not get parsed, because that would hide the
+// missing-return diagnostic.
+// RUN: %sourcekitd-test -req=sema %s -- %s %S/../Inputs/skip_non_primary_bodies_other.swift | FileCheck %s
+// CHECK: key.kind: source.lang.swift.ref.function.free,
+// CHECK: key.severity: source.diagnostic.severity.error,
+// CHECK-NEXT: key.description: "missing return in a function expected to return 'Int'",
@@ -0,0 +1,29 @@
+func foo() {}
+foo()
+
+// RUN: %sourcekitd-test -req=cursor -pos=2:1 %s -- %s == \
+// RUN:     -req=cursor -pos=2:1 %s -- %s == -req=statistics | FileCheck %s
+
+// CHECK: key.results: [
+// CHECK:      key.kind: source.statistic.latency,
+// CHECK-NEXT: key.name: "request.source.request.cursorinfo",
+// CHECK-NEXT: key.count: 2,
+// CHECK-NEXT: key.total: {{[0-9]+}},
+// CHECK-NEXT: key.max: {{[0-9]+}},
+// CHECK-NEXT: key.buckets: [
+
+// CHECK:      key.kind: source.statistic.value,
+// CHECK-NEXT: key.name: "ast.cache.hit",
+// CHECK-NEXT: key.value: {{[1-9][0-9]*}}
+
+// CHECK:      key.kind: source.statistic.value,
+// CHECK-NEXT: key.name: "ast.cache.miss",
+// CHECK-NEXT: key.value: 1
+
+// CHECK:      key.kind: source.statistic.value,
+// CHECK-NEXT: key.name: "ast.count",
+// CHECK-NEXT: key.value: 1
+
+// CHECK:      key.kind: source.statistic.value,
+// CHECK-NEXT: key.name: "ast.memory",
+// CHECK-NEXT: key.value: {{[1-9][0-9]*}}
@@ -0,0 +1,17 @@
+struct Layout {
+  var stored: Int
+  lazy var lazyStored: Int = 0
+
+  func used() -> Int { return stored }
+
+  // Invalid, but never validated when this file isn't primary and no one
+  // refers to it.
+  func unused() -> UndeclaredType { return stored }
+}
+
+enum Cases {
+  case Small(Int)
+  case Large(Layout)
+
+  subscript(i: Int) -> UndeclaredType { return i }
+}
@@ -0,0 +1,14 @@
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/lazy-member-validation/other.swift
+// RUN: %target-swift-frontend -emit-silgen -primary-file %s %S/Inputs/lazy-member-validation/other.swift -o /dev/null
+// RUN: not %target-swift-frontend -parse %s %S/Inputs/lazy-member-validation/other.swift 2>&1 | FileCheck %s
+
+// CHECK: other.swift:{{[0-9]+}}:{{[0-9]+}}: error: use of undeclared type 'UndeclaredType'
+
+func useLayout(var l: Layout, c: Cases) -> Int {
+  switch c {
+  case .Small(let i):
+    return i + l.used() + l.lazyStored
+  case .Large(let other):
+    return other.stored
+  }
+}
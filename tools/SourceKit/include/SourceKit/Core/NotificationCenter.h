@@ -14,6 +14,8 @@
 #define LLVM_SOURCEKIT_CORE_NOTIFICATIONCENTER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Mutex.h"
 #include <functional>
 #include <vector>
 
@@ -25,10 +27,27 @@ typedef std::function<void(StringRef DocumentName)>
 class NotificationCenter {
   std::vector<DocumentUpdateNotificationReceiver> DocUpdReceivers;
 
+  /// The documents with an update notification which has been posted but not
+  /// yet delivered. Further updates of these documents are folded into the
+  /// pending notification.
+  mutable llvm::StringSet<> PendingDocUpdates;
+  mutable llvm::sys::Mutex PendingDocUpdatesMtx;
+
+  /// How long an update notification is held back to collect further updates
+  /// of the same document.
+  unsigned DocUpdCoalescingWindowMs = 0;
+
 public:
   void addDocumentUpdateNotificationReceiver(
       DocumentUpdateNotificationReceiver Receiver);
 
+  /// Sets how many milliseconds a document update notification waits before
+  /// it is delivered. Any updates of the same document within that window
+  /// are delivered as a single notification.
+  void setDocumentUpdateCoalescingWindow(unsigned Milliseconds) {
+    DocUpdCoalescingWindowMs = Milliseconds;
+  }
+
   void postDocumentUpdateNotification(StringRef DocumentName) const;
 };
 
@@ -92,6 +92,15 @@ public:
     Impl::dispatchOnMain(DispatchData(std::forward<Callable>(Fn), isStackDeep));
   }
 
+  /// Dispatches \p Fn on the main queue once \p Milliseconds have passed.
+  template <typename Callable>
+  static void dispatchOnMainAfter(unsigned Milliseconds, Callable &&Fn,
+                                  bool isStackDeep = false) {
+    Impl::dispatchOnMainAfter(Milliseconds,
+                              DispatchData(std::forward<Callable>(Fn),
+                                           isStackDeep));
+  }
+
   static void dispatchConcurrent(void *Context, DispatchFn Fn,
                                  Priority Prio = Priority::Default,
                                  bool isStackDeep = false) {
@@ -178,6 +187,8 @@ private:
     static void dispatchBarrier(Ty Obj, const DispatchData &Fn);
     static void dispatchBarrierSync(Ty Obj, const DispatchData &Fn);
     static void dispatchOnMain(const DispatchData &Fn);
+    static void dispatchOnMainAfter(unsigned Milliseconds,
+                                    const DispatchData &Fn);
     static void dispatchConcurrent(Priority Prio, const DispatchData &Fn);
     static void suspend(Ty Obj);
     static void resume(Ty Obj);
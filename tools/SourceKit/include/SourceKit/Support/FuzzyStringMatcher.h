@@ -15,6 +15,7 @@
 
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/BitVector.h"
+#include <cstdint>
 #include <string>
 
 namespace SourceKit {
@@ -32,6 +33,8 @@ class FuzzyStringMatcher {
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  /// The character mask of the pattern; see getCharacterMask().
+  uint64_t patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -39,12 +42,26 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Returns a summary of the characters in \p str, ignoring case.
+  ///
+  /// Each character sets one bit, and distinct characters may share a bit, so
+  /// the mask of a string that matches a pattern always contains the mask of
+  /// the pattern. Clients that match the same candidates against many patterns
+  /// should compute this once per candidate.
+  static uint64_t getCharacterMask(StringRef str);
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
   /// the candidate's score.
   bool matchesCandidate(StringRef candidate) const;
 
+  /// Whether \p candidate matches the pattern, where \p candidateMask is
+  /// \c getCharacterMask(candidate).
+  ///
+  /// Most non-matching candidates are rejected by the mask alone.
+  bool matchesCandidate(StringRef candidate, uint64_t candidateMask) const;
+
   /// Calculates the numerical score for \p candidate.
   double scoreCandidate(StringRef candidate) const;
 };
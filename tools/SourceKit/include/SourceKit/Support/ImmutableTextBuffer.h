@@ -14,6 +14,7 @@
 #define LLVM_SOURCEKIT_SUPPORT_IMMUTABLETEXTBUFFER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/TextRope.h"
 #include "SourceKit/Support/ThreadSafeRefCntPtr.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
 #include "llvm/ADT/StringMap.h"
@@ -117,17 +118,16 @@ class ImmutableTextSnapshot :
   EditableTextBufferRef EditableBuf;
   ImmutableTextBufferRef BufferStart;
   ImmutableTextUpdateRef DiffEnd;
-
-  ImmutableTextSnapshot(EditableTextBufferRef EditableBuf,
-                        ImmutableTextBufferRef Buffer)
-    : EditableBuf(std::move(EditableBuf)),
-      BufferStart(std::move(Buffer)), DiffEnd(BufferStart) {}
+  /// The text of the snapshot.
+  TextRope Rope;
 
   ImmutableTextSnapshot(EditableTextBufferRef EditableBuf,
                         ImmutableTextBufferRef BufferStart,
-                        ImmutableTextUpdateRef DiffEnd)
+                        ImmutableTextUpdateRef DiffEnd,
+                        TextRope Rope)
     : EditableBuf(std::move(EditableBuf)),
-      BufferStart(std::move(BufferStart)), DiffEnd(std::move(DiffEnd)) {}
+      BufferStart(std::move(BufferStart)), DiffEnd(std::move(DiffEnd)),
+      Rope(std::move(Rope)) {}
 
 friend class EditableTextBuffer;
 
@@ -136,8 +136,19 @@ public:
 
   uint64_t getStamp() const;
 
+  /// Returns the text as a contiguous buffer. This copies the text, unless
+  /// a buffer for the snapshot was already created.
   ImmutableTextBufferRef getBuffer() const;
 
+  /// Returns the text without making it contiguous.
+  const TextRope &getRope() const { return Rope; }
+
+  /// Returns the 1-based line and column of \p ByteOffset, without making the
+  /// text contiguous.
+  std::pair<unsigned, unsigned> getLineAndColumn(unsigned ByteOffset) const {
+    return Rope.getLineAndColumn(ByteOffset);
+  }
+
   bool isFromSameBuffer(ImmutableTextSnapshotRef Other) const {
     return Other->EditableBuf.get() == EditableBuf.get();
   }
@@ -156,6 +167,9 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   llvm::sys::Mutex EditMtx;
   ImmutableTextBufferRef Root;
   ImmutableTextUpdateRef CurrUpd;
+  /// The text after CurrUpd. Edits update it in place of copying the text,
+  /// and snapshots share it.
+  TextRope CurrRope;
   std::string Filename;
 
 public:
@@ -0,0 +1,82 @@
+//===--- TextRope.h - Persistent rope of text -------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKIT_SUPPORT_TEXTROPE_H
+#define LLVM_SOURCEKIT_SUPPORT_TEXTROPE_H
+
+#include "SourceKit/Core/LLVM.h"
+#include "swift/Basic/ThreadSafeRefCounted.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringRef.h"
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace SourceKit {
+
+/// An immutable sequence of bytes, stored as a balanced tree of chunks.
+///
+/// Edits return a new rope which shares all the chunks the edit did not touch
+/// with the original, so an edit costs time logarithmic in the length of the
+/// text, and copying a rope is a reference count increment. Each subtree
+/// knows the number of newlines in it, so that line and column lookups don't
+/// need the text to be contiguous.
+class TextRope {
+public:
+  class Node;
+  typedef RefPtr<const Node> NodeRef;
+
+private:
+  NodeRef Root;
+
+  explicit TextRope(NodeRef Root);
+
+public:
+  TextRope();
+  explicit TextRope(StringRef Text);
+  TextRope(const TextRope &Other);
+  TextRope(TextRope &&Other);
+  TextRope &operator=(const TextRope &Other);
+  TextRope &operator=(TextRope &&Other);
+  ~TextRope();
+
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  /// Returns the number of newline characters in the text.
+  size_t getNumNewlines() const;
+
+  /// Returns a rope in which the \p Length bytes at \p ByteOffset are
+  /// replaced with \p Text.
+  TextRope replace(size_t ByteOffset, size_t Length, StringRef Text) const;
+
+  /// Returns the 1-based line and column of \p ByteOffset, like
+  /// llvm::SourceMgr::getLineAndColumn, or (0, 0) if the offset is past the
+  /// end of the text.
+  std::pair<unsigned, unsigned> getLineAndColumn(size_t ByteOffset) const;
+
+  /// Returns the offset of the first byte of the 1-based line \p Line, or the
+  /// size of the text if it has fewer lines.
+  size_t getLineStartOffset(unsigned Line) const;
+
+  /// Calls \p Fn with the chunks of the text, in order.
+  void forEachChunk(std::function<void(StringRef)> Fn) const;
+
+  /// Copies the text to \p Out, which must have room for \c size() bytes.
+  void copyTo(char *Out) const;
+
+  std::string str() const;
+};
+
+} // namespace SourceKit
+
+#endif
@@ -15,7 +15,10 @@
 
 #include "SourceKit/Support/UIdent.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
 
+#include <chrono>
+#include <string>
 #include <vector>
 
 namespace SourceKit {
@@ -126,6 +129,56 @@ public:
 
 };
 
+//----------------------------------------------------------------------------//
+// Metrics
+//----------------------------------------------------------------------------//
+
+// Number of buckets of a latency histogram. Bucket I counts the samples which
+// took less than 2^I microseconds and not less than 2^(I-1), the last bucket
+// counts all longer samples.
+static const unsigned NumLatencyBuckets = 24;
+
+struct LatencyMetric {
+  std::string Name;
+  uint64_t Count = 0;
+  uint64_t TotalMicros = 0;
+  uint64_t MaxMicros = 0;
+  uint64_t Buckets[NumLatencyBuckets] = {};
+};
+
+struct ValueMetric {
+  std::string Name;
+  int64_t Value = 0;
+};
+
+// Record a sample of the latency metric Name, which is created on first use
+void recordLatency(llvm::StringRef Name, uint64_t Micros);
+
+// Add Delta to the counter or gauge Name, which is created on first use
+void addToMetric(llvm::StringRef Name, int64_t Delta);
+
+// Get a snapshot of all metrics, sorted by name
+void getMetrics(std::vector<LatencyMetric> &Latencies,
+                std::vector<ValueMetric> &Values);
+
+// Class that utilizes the RAII idiom to record the latency of a scope
+class MeasuredLatency final {
+  std::string Name;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  explicit MeasuredLatency(std::string Name)
+    : Name(std::move(Name)), Start(std::chrono::steady_clock::now()) {}
+  ~MeasuredLatency() {
+    auto Elapsed = std::chrono::steady_clock::now() - Start;
+    recordLatency(Name,
+      std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count());
+  }
+
+  MeasuredLatency(const MeasuredLatency &) = delete;
+  MeasuredLatency &operator=(const MeasuredLatency &) = delete;
+};
+
 } // namespace sourcekitd
 } // namespace trace
 
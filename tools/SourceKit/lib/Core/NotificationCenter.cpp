@@ -25,10 +25,27 @@ void NotificationCenter::addDocumentUpdateNotificationReceiver(
 
 void NotificationCenter::postDocumentUpdateNotification(
     StringRef DocumentName) const {
-  
+  {
+    llvm::sys::ScopedLock L(PendingDocUpdatesMtx);
+    // A notification for this document is already on its way; the receivers
+    // will query the latest state when it arrives.
+    if (!PendingDocUpdates.insert(DocumentName).second)
+      return;
+  }
+
   std::string DocName = DocumentName;
-  WorkQueue::dispatchOnMain([this, DocName]{
+  auto Deliver = [this, DocName]{
+    {
+      llvm::sys::ScopedLock L(PendingDocUpdatesMtx);
+      PendingDocUpdates.erase(DocName);
+    }
     for (auto &Fn : DocUpdReceivers)
       Fn(DocName);
-  });
+  };
+
+  if (DocUpdCoalescingWindowMs == 0)
+    WorkQueue::dispatchOnMain(std::move(Deliver));
+  else
+    WorkQueue::dispatchOnMainAfter(DocUpdCoalescingWindowMs,
+                                   std::move(Deliver));
 }
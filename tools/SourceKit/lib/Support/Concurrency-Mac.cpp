@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/Concurrency.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Config/config.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -101,12 +102,51 @@ toCFunction(void *Ctx, WorkQueue::DispatchFn Fn, bool isStackDeep) {
   return std::make_pair(ExecuteInfo, executeOnLargeStackThread);
 }
 
+namespace {
+struct TimedWorkInfo {
+  std::string MetricPrefix;
+  void *Context;
+  WorkQueue::DispatchFn Fn;
+  std::chrono::steady_clock::time_point EnqueueTime;
+};
+}
+
+static uint64_t microsecondsSince(std::chrono::steady_clock::time_point T) {
+  auto Elapsed = std::chrono::steady_clock::now() - T;
+  return std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count();
+}
+
+static void executeTimedWork(void *Data) {
+  auto Info = (TimedWorkInfo*)Data;
+  trace::recordLatency(Info->MetricPrefix + ".wait",
+                       microsecondsSince(Info->EnqueueTime));
+  {
+    trace::MeasuredLatency Execution(Info->MetricPrefix + ".exec");
+    Info->Fn(Info->Context);
+  }
+  delete Info;
+}
+
+/// Wraps asynchronously dispatched work so that the time it waits in the queue
+/// and the time it executes are recorded in the "queue.<label>" metrics.
+static std::pair<void *, WorkQueue::DispatchFn>
+toTimedFunction(llvm::StringRef Label, void *Ctx, WorkQueue::DispatchFn Fn) {
+  auto Info = new TimedWorkInfo;
+  Info->MetricPrefix = "queue.";
+  Info->MetricPrefix += Label.empty() ? "<unnamed>" : Label.str();
+  Info->Context = Ctx;
+  Info->Fn = Fn;
+  Info->EnqueueTime = std::chrono::steady_clock::now();
+  return std::make_pair(Info, executeTimedWork);
+}
+
 void WorkQueue::Impl::dispatch(Ty Obj, const DispatchData &Fn) {
   void *Context;
   WorkQueue::DispatchFn CFn;
-  std::tie(Context, CFn) = toCFunction(Fn.getContext(), Fn.getFunction(),
-                                       Fn.isStackDeep());
   dispatch_queue_t queue = dispatch_queue_t(Obj);
+  std::tie(Context, CFn) = toTimedFunction(getLabel(Obj), Fn.getContext(),
+                                           Fn.getFunction());
+  std::tie(Context, CFn) = toCFunction(Context, CFn, Fn.isStackDeep());
   dispatch_async_f(queue, Context, CFn);
 }
 
@@ -122,9 +162,10 @@ void WorkQueue::Impl::dispatchSync(Ty Obj, const DispatchData &Fn) {
 void WorkQueue::Impl::dispatchBarrier(Ty Obj, const DispatchData &Fn) {
   void *Context;
   WorkQueue::DispatchFn CFn;
-  std::tie(Context, CFn) = toCFunction(Fn.getContext(), Fn.getFunction(),
-                                       Fn.isStackDeep());
   dispatch_queue_t queue = dispatch_queue_t(Obj);
+  std::tie(Context, CFn) = toTimedFunction(getLabel(Obj), Fn.getContext(),
+                                           Fn.getFunction());
+  std::tie(Context, CFn) = toCFunction(Context, CFn, Fn.isStackDeep());
   dispatch_barrier_async_f(queue, Context, CFn);
 }
 
@@ -145,11 +186,23 @@ void WorkQueue::Impl::dispatchOnMain(const DispatchData &Fn) {
   dispatch_async_f(dispatch_get_main_queue(), Context, CFn);
 }
 
-void WorkQueue::Impl::dispatchConcurrent(Priority Prio, const DispatchData &Fn) {
+void WorkQueue::Impl::dispatchOnMainAfter(unsigned Milliseconds,
+                                          const DispatchData &Fn) {
   void *Context;
   WorkQueue::DispatchFn CFn;
   std::tie(Context, CFn) = toCFunction(Fn.getContext(), Fn.getFunction(),
                                        Fn.isStackDeep());
+  dispatch_time_t When = dispatch_time(DISPATCH_TIME_NOW,
+                                       NSEC_PER_MSEC * Milliseconds);
+  dispatch_after_f(When, dispatch_get_main_queue(), Context, CFn);
+}
+
+void WorkQueue::Impl::dispatchConcurrent(Priority Prio, const DispatchData &Fn) {
+  void *Context;
+  WorkQueue::DispatchFn CFn;
+  std::tie(Context, CFn) = toTimedFunction("global", Fn.getContext(),
+                                           Fn.getFunction());
+  std::tie(Context, CFn) = toCFunction(Context, CFn, Fn.isStackDeep());
   dispatch_async_f(getDispatchGlobalQueue(Prio), Context, CFn);
 }
 
@@ -33,6 +33,7 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
   }
   assert(pattern.size() == lowercasePattern.size());
+  patternMask = getCharacterMask(lowercasePattern);
 
   // FIXME: pull out the magic constants.
   // This depends on the inner details of the matching algorithm and  will need
@@ -50,6 +51,24 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+uint64_t FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  // Letters and digits get a bit each; everything else, including the
+  // individual bytes of non-ASCII characters, shares the remaining bits.
+  uint64_t mask = 0;
+  for (char c : str) {
+    unsigned char lower = static_cast<unsigned char>(toLowercase(c));
+    unsigned bit;
+    if (lower >= 'a' && lower <= 'z')
+      bit = lower - 'a';
+    else if (lower >= '0' && lower <= '9')
+      bit = 26 + (lower - '0');
+    else
+      bit = 36 + lower % 28;
+    mask |= uint64_t(1) << bit;
+  }
+  return mask;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
@@ -69,6 +88,13 @@ bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   return pidx == patternLength;
 }
 
+bool FuzzyStringMatcher::matchesCandidate(StringRef candidate,
+                                          uint64_t candidateMask) const {
+  if ((patternMask & ~candidateMask) != 0)
+    return false;
+  return matchesCandidate(candidate);
+}
+
 static bool isTokenizingChar(char c) {
   switch (c) {
   case '/':
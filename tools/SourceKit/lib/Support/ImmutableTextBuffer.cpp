@@ -11,13 +11,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "SourceKit/Support/ImmutableTextBuffer.h"
-#include "clang/Rewrite/Core/RewriteRope.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace llvm;
-using clang::RewriteRope;
 
 void ImmutableTextUpdate::anchor() {}
 
@@ -123,11 +122,13 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   this->Filename = Filename;
   Root = new ImmutableTextBuffer(Filename, Text, ++Generation);
   CurrUpd = Root;
+  CurrRope = TextRope(Text);
 }
 
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
-  return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
-                                   CurrUpd);
+  auto *This = const_cast<EditableTextBuffer*>(this);
+  llvm::sys::ScopedLock L(This->EditMtx);
+  return new ImmutableTextSnapshot(This, Root, CurrUpd, CurrRope);
 }
 
 ImmutableTextSnapshotRef EditableTextBuffer::insert(unsigned ByteOffset,
@@ -165,26 +166,22 @@ ImmutableTextSnapshotRef EditableTextBuffer::addAtomicUpdate(
   CurrUpd->Next = NewUpd;
   CurrUpd = NewUpd;
 
-  return new ImmutableTextSnapshot(this, Root, CurrUpd);
-}
-
-static std::unique_ptr<llvm::MemoryBuffer>
-getMemBufferFromRope(StringRef Filename, const RewriteRope &Rope) {
-  size_t Length = 0;
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    Length += I.piece().size();
+  if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(NewUpd)) {
+    size_t Size = CurrRope.size();
+    size_t ByteOffset = std::min<size_t>(ReplaceUpd->getByteOffset(), Size);
+    size_t Length = std::min<size_t>(ReplaceUpd->getLength(),
+                                     Size - ByteOffset);
+    CurrRope = CurrRope.replace(ByteOffset, Length, ReplaceUpd->getText());
   }
 
-  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Length, Filename);
-  char *Ptr = (char*)MemBuf->getBufferStart();
-  for (RewriteRope::iterator I = Rope.begin(), E = Rope.end(); I != E;
-       I.MoveToNextPiece()) {
-    StringRef Text = I.piece();
-    memcpy(Ptr, Text.data(), Text.size());
-    Ptr += Text.size();
-  }
+  return new ImmutableTextSnapshot(this, Root, CurrUpd, CurrRope);
+}
 
+static std::unique_ptr<llvm::MemoryBuffer>
+getMemBufferFromRope(StringRef Filename, const TextRope &Rope) {
+  auto MemBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(Rope.size(),
+                                                          Filename);
+  Rope.copyTo(const_cast<char *>(MemBuf->getBufferStart()));
   return MemBuf;
 }
 
@@ -198,33 +195,8 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
-  // Check if a buffer was created in the middle of the snapshot updates.
-  ImmutableTextBufferRef StartBuf = Snap.BufferStart;
-  ImmutableTextUpdateRef Upd = StartBuf;  
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
-      StartBuf = Buf;
-  }
-  StringRef StartText = StartBuf->getText();
-
-  RewriteRope Rope;
-  auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
-    if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
-      StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
-    }
-  };
-
-  Rope.assign(StartText.begin(), StartText.end());
-  Upd = StartBuf;
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    applyUpdate(Upd);
-  }
-
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
+  // The snapshot's rope already has the updates applied; only flatten it.
+  auto MemBuf = getMemBufferFromRope(getFilename(), Snap.Rope);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
                                                           Snap.getStamp());
 
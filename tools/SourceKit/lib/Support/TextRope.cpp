@@ -0,0 +1,248 @@
+//===--- TextRope.cpp -----------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The rope is an AVL-balanced binary tree. Leaves hold up to MaxLeafSize bytes
+// of text; inner nodes concatenate their children. Nodes are never mutated
+// after construction, so they can be shared between ropes and threads.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/TextRope.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace SourceKit;
+using llvm::StringRef;
+
+/// Leaves are split at this size, so that an edit copies little text.
+static const size_t MaxLeafSize = 1024;
+
+class TextRope::Node : public swift::ThreadSafeRefCountedBase<Node> {
+public:
+  /// The text of a leaf; empty for inner nodes.
+  const std::string Text;
+  const NodeRef Left, Right;
+  const size_t Length;
+  const size_t Newlines;
+  const unsigned Height;
+
+  explicit Node(StringRef Text)
+    : Text(Text), Length(Text.size()),
+      Newlines(std::count(Text.begin(), Text.end(), '\n')), Height(1) {}
+
+  Node(NodeRef L, NodeRef R)
+    : Left(std::move(L)), Right(std::move(R)),
+      Length(Left->Length + Right->Length),
+      Newlines(Left->Newlines + Right->Newlines),
+      Height(std::max(Left->Height, Right->Height) + 1) {}
+
+  bool isLeaf() const { return !Left; }
+};
+
+typedef TextRope::NodeRef NodeRef;
+
+static unsigned height(const NodeRef &N) { return N ? N->Height : 0; }
+
+static NodeRef makeNode(NodeRef L, NodeRef R) {
+  return new TextRope::Node(std::move(L), std::move(R));
+}
+
+/// Joins \p L and \p R, whose heights differ by at most 2, rotating once if
+/// needed to restore the balance.
+static NodeRef balance(NodeRef L, NodeRef R) {
+  if (height(L) > height(R) + 1) {
+    if (height(L->Left) >= height(L->Right))
+      return makeNode(L->Left, makeNode(L->Right, std::move(R)));
+    return makeNode(makeNode(L->Left, L->Right->Left),
+                    makeNode(L->Right->Right, std::move(R)));
+  }
+  if (height(R) > height(L) + 1) {
+    if (height(R->Right) >= height(R->Left))
+      return makeNode(makeNode(std::move(L), R->Left), R->Right);
+    return makeNode(makeNode(std::move(L), R->Left->Left),
+                    makeNode(R->Left->Right, R->Right));
+  }
+  return makeNode(std::move(L), std::move(R));
+}
+
+static NodeRef concat(NodeRef L, NodeRef R) {
+  if (!L || L->Length == 0)
+    return R;
+  if (!R || R->Length == 0)
+    return L;
+
+  // Keep the leaves from getting tiny with repeated small insertions.
+  if (L->isLeaf() && R->isLeaf() && L->Length + R->Length <= MaxLeafSize)
+    return new TextRope::Node(L->Text + R->Text);
+
+  if (height(L) > height(R) + 1)
+    return balance(L->Left, concat(L->Right, std::move(R)));
+  if (height(R) > height(L) + 1)
+    return balance(concat(std::move(L), R->Left), R->Right);
+  return makeNode(std::move(L), std::move(R));
+}
+
+/// Splits \p N into the text before \p Offset and the text from it.
+static std::pair<NodeRef, NodeRef> split(const NodeRef &N, size_t Offset) {
+  if (!N)
+    return { nullptr, nullptr };
+  if (Offset == 0)
+    return { nullptr, N };
+  if (Offset >= N->Length)
+    return { N, nullptr };
+
+  if (N->isLeaf()) {
+    StringRef Text = N->Text;
+    return { new TextRope::Node(Text.substr(0, Offset)),
+             new TextRope::Node(Text.substr(Offset)) };
+  }
+
+  size_t LeftLength = N->Left->Length;
+  if (Offset < LeftLength) {
+    auto Parts = split(N->Left, Offset);
+    return { std::move(Parts.first),
+             concat(std::move(Parts.second), N->Right) };
+  }
+  auto Parts = split(N->Right, Offset - LeftLength);
+  return { concat(N->Left, std::move(Parts.first)), std::move(Parts.second) };
+}
+
+/// Builds a balanced tree of leaves holding \p Text.
+static NodeRef build(StringRef Text) {
+  if (Text.empty())
+    return nullptr;
+  if (Text.size() <= MaxLeafSize)
+    return new TextRope::Node(Text);
+
+  // Split at a leaf boundary, so that all leaves but the last are full.
+  size_t NumLeaves = (Text.size() + MaxLeafSize - 1) / MaxLeafSize;
+  size_t Mid = (NumLeaves / 2) * MaxLeafSize;
+  return makeNode(build(Text.substr(0, Mid)), build(Text.substr(Mid)));
+}
+
+// The special members are defined here, where Node is complete.
+TextRope::TextRope() = default;
+TextRope::TextRope(NodeRef Root) : Root(std::move(Root)) {}
+TextRope::TextRope(StringRef Text) : Root(build(Text)) {}
+TextRope::TextRope(const TextRope &Other) = default;
+TextRope::TextRope(TextRope &&Other) = default;
+TextRope &TextRope::operator=(const TextRope &Other) = default;
+TextRope &TextRope::operator=(TextRope &&Other) = default;
+TextRope::~TextRope() = default;
+
+size_t TextRope::size() const {
+  return Root ? Root->Length : 0;
+}
+
+size_t TextRope::getNumNewlines() const {
+  return Root ? Root->Newlines : 0;
+}
+
+TextRope TextRope::replace(size_t ByteOffset, size_t Length,
+                           StringRef Text) const {
+  assert(ByteOffset <= size() && "replacing past the end of the text");
+  auto Prefix = split(Root, ByteOffset);
+  auto Suffix = split(Prefix.second, Length);
+  return TextRope(concat(concat(std::move(Prefix.first), build(Text)),
+                         std::move(Suffix.second)));
+}
+
+/// Returns the number of newlines before \p Offset.
+static size_t countNewlinesBefore(const TextRope::Node *N, size_t Offset) {
+  size_t Count = 0;
+  while (N && !N->isLeaf()) {
+    if (Offset >= N->Left->Length) {
+      Count += N->Left->Newlines;
+      Offset -= N->Left->Length;
+      N = N->Right.get();
+    } else {
+      N = N->Left.get();
+    }
+  }
+  if (N) {
+    StringRef Text = N->Text;
+    Text = Text.substr(0, Offset);
+    Count += std::count(Text.begin(), Text.end(), '\n');
+  }
+  return Count;
+}
+
+size_t TextRope::getLineStartOffset(unsigned Line) const {
+  if (Line <= 1)
+    return 0;
+  size_t NewlineIndex = Line - 2;
+  if (!Root || NewlineIndex >= Root->Newlines)
+    return size();
+
+  // Find the newline which ends the previous line.
+  const Node *N = Root.get();
+  size_t Offset = 0;
+  while (!N->isLeaf()) {
+    if (NewlineIndex >= N->Left->Newlines) {
+      NewlineIndex -= N->Left->Newlines;
+      Offset += N->Left->Length;
+      N = N->Right.get();
+    } else {
+      N = N->Left.get();
+    }
+  }
+  const char *Start = N->Text.data();
+  const char *P = Start;
+  for (;; ++P) {
+    P = static_cast<const char *>(memchr(P, '\n', N->Text.size() - (P-Start)));
+    assert(P && "newline count out of sync with the text");
+    if (NewlineIndex-- == 0)
+      break;
+  }
+  return Offset + (P - Start) + 1;
+}
+
+std::pair<unsigned, unsigned>
+TextRope::getLineAndColumn(size_t ByteOffset) const {
+  if (ByteOffset > size())
+    return std::make_pair(0, 0);
+
+  unsigned Line = countNewlinesBefore(Root.get(), ByteOffset) + 1;
+  size_t LineStart = getLineStartOffset(Line);
+  return std::make_pair(Line, unsigned(ByteOffset - LineStart) + 1);
+}
+
+static void forEachLeaf(const TextRope::Node *N,
+                        const std::function<void(StringRef)> &Fn) {
+  if (!N)
+    return;
+  if (N->isLeaf()) {
+    Fn(N->Text);
+    return;
+  }
+  forEachLeaf(N->Left.get(), Fn);
+  forEachLeaf(N->Right.get(), Fn);
+}
+
+void TextRope::forEachChunk(std::function<void(StringRef)> Fn) const {
+  forEachLeaf(Root.get(), Fn);
+}
+
+void TextRope::copyTo(char *Out) const {
+  forEachChunk([&](StringRef Chunk) {
+    memcpy(Out, Chunk.data(), Chunk.size());
+    Out += Chunk.size();
+  });
+}
+
+std::string TextRope::str() const {
+  std::string Result(size(), '\0');
+  if (!Result.empty())
+    copyTo(&Result[0]);
+  return Result;
+}
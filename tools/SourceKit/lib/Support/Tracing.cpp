@@ -14,9 +14,14 @@
 
 #include "swift/Frontend/Frontend.h"
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/YAMLTraits.h"
 
+#include <algorithm>
+#include <mutex>
+
 using namespace SourceKit;
 using namespace llvm;
 
@@ -91,3 +96,67 @@ void trace::registerConsumer(trace::TraceConsumer *Consumer) {
                                            std::memory_order_release,
                                            std::memory_order_relaxed));
 }
+
+//----------------------------------------------------------------------------//
+// Metrics
+//----------------------------------------------------------------------------//
+
+namespace {
+struct MetricRegistry {
+  std::mutex Mtx;
+  llvm::StringMap<trace::LatencyMetric> Latencies;
+  llvm::StringMap<int64_t> Values;
+};
+}
+
+static MetricRegistry &getMetricRegistry() {
+  static MetricRegistry *Registry = new MetricRegistry();
+  return *Registry;
+}
+
+static unsigned getLatencyBucket(uint64_t Micros) {
+  unsigned Bucket = Micros ? 64 - llvm::countLeadingZeros(Micros) : 0;
+  return std::min(Bucket, trace::NumLatencyBuckets - 1);
+}
+
+void trace::recordLatency(StringRef Name, uint64_t Micros) {
+  auto &Registry = getMetricRegistry();
+  std::lock_guard<std::mutex> L(Registry.Mtx);
+  auto &Metric = Registry.Latencies[Name];
+  ++Metric.Count;
+  Metric.TotalMicros += Micros;
+  Metric.MaxMicros = std::max(Metric.MaxMicros, Micros);
+  ++Metric.Buckets[getLatencyBucket(Micros)];
+}
+
+void trace::addToMetric(StringRef Name, int64_t Delta) {
+  auto &Registry = getMetricRegistry();
+  std::lock_guard<std::mutex> L(Registry.Mtx);
+  Registry.Values[Name] += Delta;
+}
+
+void trace::getMetrics(std::vector<trace::LatencyMetric> &Latencies,
+                       std::vector<trace::ValueMetric> &Values) {
+  auto &Registry = getMetricRegistry();
+  {
+    std::lock_guard<std::mutex> L(Registry.Mtx);
+    for (auto &Entry : Registry.Latencies) {
+      Latencies.push_back(Entry.getValue());
+      Latencies.back().Name = Entry.getKey();
+    }
+    for (auto &Entry : Registry.Values) {
+      Values.push_back(trace::ValueMetric());
+      Values.back().Name = Entry.getKey();
+      Values.back().Value = Entry.getValue();
+    }
+  }
+  std::sort(Latencies.begin(), Latencies.end(),
+            [](const trace::LatencyMetric &LHS,
+               const trace::LatencyMetric &RHS) {
+    return LHS.Name < RHS.Name;
+  });
+  std::sort(Values.begin(), Values.end(),
+            [](const trace::ValueMetric &LHS, const trace::ValueMetric &RHS) {
+    return LHS.Name < RHS.Name;
+  });
+}
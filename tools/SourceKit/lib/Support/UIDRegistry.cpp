@@ -12,7 +12,9 @@
 
 #include "SourceKit/Support/UIdent.h"
 #include "SourceKit/Support/Concurrency.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <mutex>
 #include <vector>
@@ -36,6 +38,15 @@ public:
 };
 }
 
+/// A direct-mapped cache of the entries most recently looked up by the current
+/// thread, indexed by the hash of the name.
+///
+/// Entries are never moved or freed once inserted, so a hit needs no
+/// synchronization with the registry.
+static constexpr unsigned LookupCacheSize = 256;
+static LLVM_THREAD_LOCAL
+    llvm::StringMapEntry<void *> *LookupCache[LookupCacheSize];
+
 static UIDRegistryImpl *getGlobalRegistry() {
   static UIDRegistryImpl *GlobalRegistry = 0;
   if (!GlobalRegistry) {
@@ -85,6 +96,13 @@ void UIdent::print(llvm::raw_ostream &OS) const {
 void *UIDRegistryImpl::get(StringRef Str) {
   assert(!Str.empty());
   assert(Str.find(' ') == StringRef::npos);
+
+  // The request and response builders ask for the same few keys over and
+  // over, from every thread; don't go through the queue for those.
+  EntryTy *&Cached = LookupCache[llvm::HashString(Str) % LookupCacheSize];
+  if (Cached && Cached->getKey() == Str)
+    return Cached;
+
   EntryTy *Ptr = 0;
   Queue.dispatchSync([&]{
     HashTableTy::iterator It = HashTable.find(Str);
@@ -99,6 +117,7 @@ void *UIDRegistryImpl::get(StringRef Str) {
     });
   }
 
+  Cached = Ptr;
   return Ptr;
 }
 
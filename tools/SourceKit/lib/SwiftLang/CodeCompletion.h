@@ -14,6 +14,7 @@
 #define LLVM_SOURCEKIT_LIB_SWIFTLANG_CODECOMPLETION_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "SourceKit/Support/FuzzyStringMatcher.h"
 #include "swift/IDE/CodeCompletion.h"
 #include "llvm/ADT/Optional.h"
 
@@ -76,6 +77,7 @@ class Completion : public SwiftResult {
   PopularityFactor popularityFactor;
   StringRef name;
   StringRef description;
+  uint64_t nameCharacterMask;
   friend class CompletionBuilder;
 
 public:
@@ -86,12 +88,15 @@ public:
   /// should outlive the result, generally by being stored in the same
   /// \c CompletionSink.
   Completion(SwiftResult base, StringRef name, StringRef description)
-      : SwiftResult(base), name(name), description(description) {}
+      : SwiftResult(base), name(name), description(description),
+        nameCharacterMask(FuzzyStringMatcher::getCharacterMask(name)) {}
 
   bool hasCustomKind() const { return opaqueCustomKind; }
   void *getCustomKind() const { return opaqueCustomKind; }
   StringRef getName() const { return name; }
   StringRef getDescription() const { return description; }
+  /// The \c FuzzyStringMatcher character mask of the name.
+  uint64_t getNameCharacterMask() const { return nameCharacterMask; }
   Optional<uint8_t> getModuleImportDepth() const { return moduleImportDepth; }
 
   /// A popularity factory in the range [-1, 1]. The higher the value, the more
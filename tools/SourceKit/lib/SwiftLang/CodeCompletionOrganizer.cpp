@@ -197,7 +197,8 @@ public:
 
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
                                 StringRef filterText, Options options,
-                                Completion *&exactMatch);
+                                Completion *&exactMatch,
+                                std::vector<Completion *> *matched);
 
   void sort(Options options);
 
@@ -271,8 +272,14 @@ void CodeCompletionOrganizer::preSortCompletions(
 
 void CodeCompletionOrganizer::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText,
-    Completion *&exactMatch) {
-  impl.addCompletionsWithFilter(completions, filterText, options, exactMatch);
+    Completion *&exactMatch, std::vector<Completion *> *matched) {
+  impl.addCompletionsWithFilter(completions, filterText, options, exactMatch,
+                                matched);
+}
+
+bool CodeCompletionOrganizer::usesFuzzyMatching(const Options &options,
+                                                StringRef filterText) {
+  return options.fuzzyMatching && filterText.size() >= options.minFuzzyLength;
 }
 
 void CodeCompletionOrganizer::groupAndSort(const Options &options) {
@@ -426,7 +433,7 @@ static bool isHighPriorityKeyword(CodeCompletionKeywordKind kind) {
 
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
-    Completion *&exactMatch) {
+    Completion *&exactMatch, std::vector<Completion *> *matched) {
   assert(rootGroup);
 
   auto &contents = rootGroup->contents;
@@ -486,14 +493,19 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
+  bool fuzzy = CodeCompletionOrganizer::usesFuzzyMatching(options, filterText);
   for (Completion *completion : completions) {
     bool match = false;
-    if (options.fuzzyMatching && filterText.size() >= options.minFuzzyLength) {
-      match = pattern.matchesCandidate(completion->getName());
+    if (fuzzy) {
+      match = pattern.matchesCandidate(completion->getName(),
+                                       completion->getNameCharacterMask());
     } else {
       match = completion->getName().startswith_lower(filterText);
     }
 
+    if (match && matched)
+      matched->push_back(completion);
+
     if (match && completion->getName().equals_lower(filterText)) {
       if (!exactMatch)
         exactMatch = completion;
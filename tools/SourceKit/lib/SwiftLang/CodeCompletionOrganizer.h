@@ -84,9 +84,20 @@ public:
   /// Add \p completions to the organizer, removing any results that don't match
   /// \p filterText and returning \p exactMatch if there is an exact match.
   ///
+  /// If \p matched is non-null and there is filter text, every completion that
+  /// matches \p filterText is appended to it, in order, including an exact
+  /// match that is not added to the results.
+  ///
   /// Precondition: \p completions should be sorted with preSortCompletions().
   void addCompletionsWithFilter(ArrayRef<Completion *> completions,
-                                StringRef filterText, Completion *&exactMatch);
+                                StringRef filterText, Completion *&exactMatch,
+                                std::vector<Completion *> *matched = nullptr);
+
+  /// Whether \p filterText is matched fuzzily rather than as a prefix.
+  ///
+  /// Within one mode, a completion that matches some filter text also matches
+  /// every prefix of it, which lets callers narrow a previous match set.
+  static bool usesFuzzyMatching(const Options &options, StringRef filterText);
 
   void groupAndSort(const Options &options);
 
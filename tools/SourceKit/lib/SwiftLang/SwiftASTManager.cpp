@@ -26,6 +26,7 @@
 #include "swift/Strings.h"
 #include "swift/Subsystems.h"
 #include "swift/SILPasses/Passes.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/CodeCompletionTypeChecking.h"
 
@@ -234,11 +235,24 @@ class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   ThreadSafeRefCntPtr<ASTUnit> AST;
   SmallVector<std::pair<std::string, BufferStamp>, 8> DependencyStamps;
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
+  /// The snapshots of the most recent request; a build always uses these.
+  SmallVector<ImmutableTextSnapshotRef, 4> LatestSnapshots;
   llvm::sys::Mutex Mtx;
+  /// Held for the duration of a build, since builds for the same invocation
+  /// must not overlap.
+  llvm::sys::Mutex BuildMtx;
+  /// The memory cost of the AST which was added to the "ast.memory" metric.
+  size_t ReportedMemoryCost = 0;
 
 public:
   explicit ASTProducer(SwiftInvocationRef InvokRef)
     : InvokRef(std::move(InvokRef)) {}
+  ~ASTProducer() {
+    if (ReportedMemoryCost) {
+      trace::addToMetric("ast.memory", -int64_t(ReportedMemoryCost));
+      trace::addToMetric("ast.count", -1);
+    }
+  }
 
   ASTUnitRef getExistingAST() {
     // FIXME: ThreadSafeRefCntPtr is racy.
@@ -248,12 +262,14 @@ public:
 
   void getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                        ArrayRef<ImmutableTextSnapshotRef> Snapshots,
-                std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver);
+                std::function<void(ASTUnitRef Unit, StringRef Error,
+                          ArrayRef<SwiftASTConsumerRef> Consumers)> Receiver);
   bool shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                      ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
-  std::vector<SwiftASTConsumerRef> popQueuedConsumers();
+  std::vector<SwiftASTConsumerRef>
+  popQueuedConsumers(SmallVectorImpl<ImmutableTextSnapshotRef> &Snapshots);
 
   size_t getMemoryCost() const {
     // FIXME: Report the memory cost of the overall CompilerInstance.
@@ -310,7 +326,9 @@ struct SwiftASTManager::Implementation {
   Cache<ASTKey, ASTProducerRef> ASTCache{ "sourcekit.swift.ASTCache" };
   llvm::sys::Mutex CacheMtx;
 
-  WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Serial,
+  /// ASTs for different invocations are built concurrently, so that a
+  /// document is not held up by building the ASTs of other documents.
+  WorkQueue ASTBuildQueue{ WorkQueue::Dequeuing::Concurrent,
                            "sourcekit.swift.ASTBuilding" };
 
   ASTProducerRef getASTProducer(SwiftInvocationRef InvokRef);
@@ -322,6 +340,9 @@ struct SwiftASTManager::Implementation {
 
 SwiftASTManager::SwiftASTManager(SwiftLangSupport &LangSupport)
   : Impl(*new Implementation(LangSupport)) {
+  // Every AST imports the stdlib and usually the same frameworks; share the
+  // module file contents between them instead of reading a copy for each.
+  SerializedModuleLoader::enableProcessWideBufferCache();
 }
 
 SwiftASTManager::~SwiftASTManager() {
@@ -479,12 +500,11 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
   Producer->enqueueConsumer(std::move(ASTConsumer), OncePerASTToken);
 
   Producer->getASTUnitAsync(Impl, Snapshots,
-    [Producer](ASTUnitRef Unit, StringRef Error) {
-      auto Consumers = Producer->popQueuedConsumers();
-
+    [](ASTUnitRef Unit, StringRef Error,
+       ArrayRef<SwiftASTConsumerRef> Consumers) {
       for (auto &Consumer : Consumers) {
         if (Unit)
-          Unit->Impl.consumeAsync(std::move(Consumer), Unit);
+          Unit->Impl.consumeAsync(Consumer, Unit);
         else
           Consumer->failed(Error);
       }
@@ -556,16 +576,30 @@ SwiftASTManager::Implementation::getMemoryBuffer(StringRef Filename,
 
 void ASTProducer::getASTUnitAsync(SwiftASTManager::Implementation &MgrImpl,
                                   ArrayRef<ImmutableTextSnapshotRef> Snaps,
-               std::function<void(ASTUnitRef Unit, StringRef Error)> Receiver) {
+               std::function<void(ASTUnitRef Unit, StringRef Error,
+                          ArrayRef<SwiftASTConsumerRef> Consumers)> Receiver) {
 
   ASTProducerRef ThisProducer = this;
-  SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
-  Snapshots.append(Snaps.begin(), Snaps.end());
+  {
+    llvm::sys::ScopedLock L(Mtx);
+    LatestSnapshots.assign(Snaps.begin(), Snaps.end());
+  }
+
+  MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Receiver] {
+    llvm::sys::ScopedLock BuildLock(ThisProducer->BuildMtx);
+
+    // Every build serves all the consumers queued so far, with the snapshots
+    // of the newest request.  So while the user keeps typing, stale requests
+    // don't get ASTs of their own, and a job whose consumers were already
+    // served by an earlier build has nothing left to do.
+    SmallVector<ImmutableTextSnapshotRef, 4> Snapshots;
+    auto Consumers = ThisProducer->popQueuedConsumers(Snapshots);
+    if (Consumers.empty())
+      return;
 
-  MgrImpl.ASTBuildQueue.dispatch([ThisProducer, &MgrImpl, Snapshots, Receiver] {
     std::string Error;
     ASTUnitRef Unit = ThisProducer->getASTUnitImpl(MgrImpl, Snapshots, Error);
-    Receiver(Unit, Error);
+    Receiver(Unit, Error, Consumers);
   }, /*isStackDeep=*/true);
 }
 
@@ -575,6 +609,7 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
   if (!AST || shouldRebuild(MgrImpl, Snapshots)) {
     bool IsRebuild = AST != nullptr;
     const InvocationOptions &Opts = InvokRef->Impl.Opts;
+    trace::addToMetric(IsRebuild ? "ast.cache.rebuild" : "ast.cache.miss", 1);
 
     LOG_FUNC_SECTION(InfoHighPrio) {
       Log->getOS() << "AST build (";
@@ -591,6 +626,12 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
       AST = NewAST;
+      size_t MemoryCost = getMemoryCost();
+      if (!ReportedMemoryCost)
+        trace::addToMetric("ast.count", 1);
+      trace::addToMetric("ast.memory",
+                         int64_t(MemoryCost) - int64_t(ReportedMemoryCost));
+      ReportedMemoryCost = MemoryCost;
     }
 
     {
@@ -599,6 +640,8 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
     }
+  } else {
+    trace::addToMetric("ast.cache.hit", 1);
   }
 
   return AST;
@@ -620,8 +663,10 @@ void ASTProducer::enqueueConsumer(SwiftASTConsumerRef Consumer,
   QueuedConsumers.push_back({ std::move(Consumer), OncePerASTToken });
 }
 
-std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
+std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers(
+    SmallVectorImpl<ImmutableTextSnapshotRef> &Snapshots) {
   llvm::sys::ScopedLock L(Mtx);
+  Snapshots.assign(LatestSnapshots.begin(), LatestSnapshots.end());
   std::vector<SwiftASTConsumerRef> Consumers;
   Consumers.reserve(QueuedConsumers.size());
   for (auto &C : QueuedConsumers)
@@ -773,6 +818,11 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CompilerInvocation Invocation;
   Opts.applyTo(Invocation);
 
+  // Only the primary file is type-checked, and nothing we serve from the AST
+  // looks into function bodies in the other files, so don't parse them.  This
+  // keeps rebuilds after an edit from growing with the size of the module.
+  Invocation.getFrontendOptions().SkipNonPrimaryFunctionBodies = true;
+
   for (auto &Content : Contents)
     Invocation.addInputBuffer(Content.Buffer.get());
 
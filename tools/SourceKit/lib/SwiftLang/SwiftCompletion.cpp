@@ -163,6 +163,9 @@ static bool swiftCodeCompleteImpl(SwiftLangSupport &Lang,
   std::copy(Position, InputFile->getBufferEnd(), NewPos+1);
 
   Invocation.setCodeCompletionPoint(NewBuffer.get(), CodeCompletionOffset);
+  // Member completions don't need the statements before the completion
+  // point which the completed expression doesn't depend on.
+  Invocation.getLangOptions().CodeCompleteOnlyDependencies = true;
 
   auto swiftCache = Lang.getCodeCompletionCache(); // Pin the cache.
   ide::CodeCompletionContext CompletionContext(swiftCache->getCache());
@@ -641,11 +644,29 @@ void CodeCompletion::SessionCache::setSortedCompletions(
     std::vector<Completion *> &&completions) {
   llvm::sys::ScopedLock L(mtx);
   sortedCompletions = std::move(completions);
+  lastFilterText.clear();
+  lastFilterMatches.clear();
 }
 ArrayRef<Completion *> CodeCompletion::SessionCache::getSortedCompletions() {
   llvm::sys::ScopedLock L(mtx);
   return sortedCompletions;
 }
+std::vector<Completion *>
+CodeCompletion::SessionCache::getFilterCandidates(StringRef filterText,
+                                                  bool fuzzy) {
+  llvm::sys::ScopedLock L(mtx);
+  if (!lastFilterText.empty() && fuzzy == lastFilterFuzzy &&
+      filterText.startswith_lower(lastFilterText))
+    return lastFilterMatches;
+  return sortedCompletions;
+}
+void CodeCompletion::SessionCache::setFilterMatches(
+    StringRef filterText, bool fuzzy, std::vector<Completion *> &&matches) {
+  llvm::sys::ScopedLock L(mtx);
+  lastFilterText = filterText;
+  lastFilterFuzzy = fuzzy;
+  lastFilterMatches = std::move(matches);
+}
 llvm::MemoryBuffer *CodeCompletion::SessionCache::getBuffer() {
   llvm::sys::ScopedLock L(mtx);
   return buffer.get();
@@ -848,8 +869,16 @@ static void transformAndForwardResults(
       session->getCompletionKind() == CompletionKind::PostfixExpr;
 
   if (!hasEarlyInnerResults) {
-    organizer.addCompletionsWithFilter(session->getSortedCompletions(),
-                                       filterText, exactMatch);
+    // Each keystroke usually extends the filter text, so only the previous
+    // matches need to be considered again.
+    bool fuzzy = CodeCompletion::CodeCompletionOrganizer::usesFuzzyMatching(
+        options, filterText);
+    std::vector<Completion *> matched;
+    organizer.addCompletionsWithFilter(
+        session->getFilterCandidates(filterText, fuzzy), filterText,
+        exactMatch, filterText.empty() ? nullptr : &matched);
+    if (!filterText.empty())
+      session->setFilterMatches(filterText, fuzzy, std::move(matched));
   }
 
   if (hasEarlyInnerResults &&
@@ -763,9 +763,9 @@ SwiftDocumentSemanticInfo::getSemanticDiagnostics(
     });
 
   if (!SemaDiags.empty()) {
-    auto ImmBuf = NewSnapshot->getBuffer();
     for (auto &Diag : SemaDiags) {
-      std::tie(Diag.Line, Diag.Column) = ImmBuf->getLineAndColumn(Diag.Offset);
+      std::tie(Diag.Line, Diag.Column) =
+          NewSnapshot->getLineAndColumn(Diag.Offset);
     }
 
     // If there is a parser diagnostic in a line, ignore diagnostics in the same
@@ -1351,13 +1351,21 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+
+    // Once we're synced up with the previous syntax map, the rest of the nodes
+    // don't need any line information; skip them as cheaply as possible since
+    // that's most of the file for a typical edit.
+    if (EditedLineRange.isValid() &&
+        Offset > AffectedRange.first + AffectedRange.second)
+      return true;
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
     // Note that the length can span multiple lines.
     unsigned Length = Node.Range.getByteLength();
 
@@ -1383,10 +1391,6 @@ public:
         AffectedRange.first -= AdjCharCount;
         AffectedRange.second += AdjCharCount;
       }
-      else if (Offset > AffectedRange.first + AffectedRange.second) {
-        // We're passed the affected range and already synced up, just return.
-        return true;
-      }
       else if (StartLine > EditedLineRange.endLine()) {
         // We're after the edited line range, let's test if we're synced up.
         if (SyntaxMap.matchesFirstTokenOnLine(StartLine, Token)) {
@@ -25,6 +25,9 @@
 
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <algorithm>
 
 using namespace SourceKit;
 using namespace swift;
@@ -67,15 +70,31 @@ public:
     llvm::StringMap<TextDecl> USRMap;
   };
 
+  /// The state of a module file when the interface was generated.
+  struct FileStamp {
+    std::string Path;
+    bool Exists;
+    uint64_t Size;
+    uint64_t ModTime;
+
+    static FileStamp get(StringRef Path);
+
+    bool isUpToDate() const {
+      FileStamp Current = get(Path);
+      return Current.Exists == Exists && Current.Size == Size &&
+             Current.ModTime == ModTime;
+    }
+  };
+
   // Hold an AstUnit so that the Decl* we have are always valid.
   ASTUnitRef AstUnit;
-  std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
   CompilerInvocation Invocation;
   PrintingDiagnosticConsumer DiagConsumer;
   CompilerInstance Instance;
   Module *Mod = nullptr;
+  std::vector<FileStamp> ModuleFiles;
   SourceTextInfo Info;
   // This is the non-typechecked AST for the generated interface source.
   CompilerInstance TextCI;
@@ -85,6 +104,15 @@ typedef SwiftInterfaceGenContext::Implementation::TextRange TextRange;
 typedef SwiftInterfaceGenContext::Implementation::TextReference TextReference;
 typedef SwiftInterfaceGenContext::Implementation::TextDecl TextDecl;
 typedef SwiftInterfaceGenContext::Implementation::SourceTextInfo SourceTextInfo;
+typedef SwiftInterfaceGenContext::Implementation::FileStamp FileStamp;
+
+FileStamp FileStamp::get(StringRef Path) {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(Path, Status))
+    return { Path.str(), false, 0, 0 };
+  return { Path.str(), true, Status.getSize(),
+           Status.getLastModificationTime().toEpochTime() };
+}
 
 static Module *getModuleByFullName(ASTContext &Ctx, StringRef ModuleName) {
   SmallVector<std::pair<Identifier, SourceLoc>, 4>
@@ -280,6 +308,14 @@ static bool getModuleInterfaceInfo(ASTContext &Ctx,
     }
   }
 
+  for (auto *File : Mod->getFiles()) {
+    if (auto *LF = dyn_cast<LoadedFile>(File)) {
+      StringRef Filename = LF->getFilename();
+      if (!Filename.empty())
+        Impl.ModuleFiles.push_back(FileStamp::get(Filename));
+    }
+  }
+
   PrintOptions Options = PrintOptions::printInterface();
   ModuleTraversalOptions TraversalOptions = None; // Don't print submodules.
   SmallString<128> Text;
@@ -318,8 +354,9 @@ SwiftInterfaceGenContext::createForSwiftSource(StringRef DocumentName,
                                                StringRef SourceFileName,
                                                ASTUnitRef AstUnit,
                                                std::string &ErrMsg) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(DocumentName,
+                                 std::make_shared<Implementation>()) };
   IFaceGenCtx->Impl.IsModule = true;
   IFaceGenCtx->Impl.ModuleOrHeaderName = SourceFileName;
   IFaceGenCtx->Impl.AstUnit = AstUnit;
@@ -343,8 +380,9 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
                                  StringRef ModuleOrHeaderName,
                                  CompilerInvocation Invocation,
                                  std::string &ErrMsg) {
-  SwiftInterfaceGenContextRef IFaceGenCtx{ new SwiftInterfaceGenContext() };
-  IFaceGenCtx->Impl.DocumentName = DocumentName;
+  SwiftInterfaceGenContextRef IFaceGenCtx{
+    new SwiftInterfaceGenContext(DocumentName,
+                                 std::make_shared<Implementation>()) };
   IFaceGenCtx->Impl.IsModule = IsModule;
   IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
   IFaceGenCtx->Impl.Invocation = Invocation;
@@ -398,15 +436,22 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   return IFaceGenCtx;
 }
 
-SwiftInterfaceGenContext::SwiftInterfaceGenContext()
-  : Impl(*new Implementation) {
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenContext::createShared(StringRef DocumentName,
+                                       SwiftInterfaceGenContextRef Other) {
+  return SwiftInterfaceGenContextRef{
+    new SwiftInterfaceGenContext(DocumentName, Other->SharedImpl) };
 }
-SwiftInterfaceGenContext::~SwiftInterfaceGenContext() {
-  delete &Impl;
+
+SwiftInterfaceGenContext::SwiftInterfaceGenContext(
+    StringRef DocumentName, std::shared_ptr<Implementation> SharedImpl)
+  : SharedImpl(std::move(SharedImpl)), Impl(*this->SharedImpl),
+    DocumentName(DocumentName) {
 }
+SwiftInterfaceGenContext::~SwiftInterfaceGenContext() = default;
 
 StringRef SwiftInterfaceGenContext::getDocumentName() const {
-  return Impl.DocumentName;
+  return DocumentName;
 }
 
 StringRef SwiftInterfaceGenContext::getModuleOrHeaderName() const {
@@ -419,7 +464,7 @@ bool SwiftInterfaceGenContext::isModule() const {
 
 bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
                                        const swift::CompilerInvocation &Invok) {
-  if (!Impl.IsModule)
+  if (!Impl.IsModule || !Impl.Mod)
     return false;
   if (ModuleName != Impl.ModuleOrHeaderName)
     return false;
@@ -450,6 +495,14 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+bool SwiftInterfaceGenContext::isStale() const {
+  for (auto &Stamp : Impl.ModuleFiles) {
+    if (!Stamp.isUpToDate())
+      return true;
+  }
+  return false;
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -528,7 +581,25 @@ void SwiftInterfaceGenMap::set(StringRef Name,
 
 bool SwiftInterfaceGenMap::remove(StringRef Name) {
   llvm::sys::ScopedLock L(Mtx);
-  return IFaceGens.erase(Name);
+  auto It = IFaceGens.find(Name);
+  if (It == IFaceGens.end())
+    return false;
+  SwiftInterfaceGenContextRef IFaceGen = It->second;
+  IFaceGens.erase(It);
+
+  // Keep the interface of a module around for a while, in case the document
+  // is opened again.
+  if (IFaceGen->isModule()) {
+    RecentlyClosed.erase(std::remove_if(RecentlyClosed.begin(),
+                                        RecentlyClosed.end(),
+      [&](const SwiftInterfaceGenContextRef &Closed) {
+        return Closed->sharesInterfaceWith(*IFaceGen);
+      }), RecentlyClosed.end());
+    RecentlyClosed.push_back(IFaceGen);
+    if (RecentlyClosed.size() > MaxRecentlyClosed)
+      RecentlyClosed.erase(RecentlyClosed.begin());
+  }
+  return true;
 }
 
 SwiftInterfaceGenContextRef
@@ -542,6 +613,29 @@ SwiftInterfaceGenMap::find(StringRef ModuleName,
   return nullptr;
 }
 
+SwiftInterfaceGenContextRef
+SwiftInterfaceGenMap::findReusable(StringRef ModuleName,
+                                   const CompilerInvocation &Invok) {
+  llvm::sys::ScopedLock L(Mtx);
+  for (auto &Entry : IFaceGens) {
+    auto &IFaceGen = Entry.getValue();
+    if (IFaceGen->matches(ModuleName, Invok) && !IFaceGen->isStale())
+      return IFaceGen;
+  }
+
+  for (auto It = RecentlyClosed.rbegin(), E = RecentlyClosed.rend();
+       It != E; ++It) {
+    if (!(*It)->matches(ModuleName, Invok))
+      continue;
+    SwiftInterfaceGenContextRef IFaceGen = *It;
+    RecentlyClosed.erase(std::next(It).base());
+    if (IFaceGen->isStale())
+      return nullptr;
+    return IFaceGen;
+  }
+  return nullptr;
+}
+
 //============================================================================//
 // EditorOpenInterface
 //============================================================================//
@@ -576,15 +670,22 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
-  std::string ErrMsg;
-  auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
-                                                      /*IsModule=*/true,
-                                                      ModuleName,
-                                                      Invocation,
-                                                      ErrMsg);
-  if (!IFaceGenRef) {
-    Consumer.handleRequestError(ErrMsg.c_str());
-    return;
+  // Generating the interface of a large module is expensive, so share it with
+  // another document of the same module if its files did not change since.
+  SwiftInterfaceGenContextRef IFaceGenRef;
+  if (auto Existing = IFaceGenContexts.findReusable(ModuleName, Invocation)) {
+    IFaceGenRef = SwiftInterfaceGenContext::createShared(Name, Existing);
+  } else {
+    std::string ErrMsg;
+    IFaceGenRef = SwiftInterfaceGenContext::create(Name,
+                                                   /*IsModule=*/true,
+                                                   ModuleName,
+                                                   Invocation,
+                                                   ErrMsg);
+    if (!IFaceGenRef) {
+      Consumer.handleRequestError(ErrMsg.c_str());
+      return;
+    }
   }
 
   IFaceGenContexts.set(Name, IFaceGenRef);
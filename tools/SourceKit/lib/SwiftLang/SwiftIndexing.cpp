@@ -38,6 +38,137 @@ static UIdent KindImportModuleClang("source.lang.swift.import.module.clang");
 static UIdent KindImportModuleSwift("source.lang.swift.import.module.swift");
 static UIdent KindImportSourceFile("source.lang.swift.import.sourcefile");
 
+namespace {
+/// The state of a file, as far as the index hashes are concerned.
+struct IndexedFileStamp {
+  std::string Path;
+  bool Exists;
+  uint64_t Size;
+  uint64_t ModTime;
+
+  static IndexedFileStamp get(StringRef Path,
+                              const llvm::sys::fs::file_status *Status) {
+    if (!Status)
+      return { Path.str(), false, 0, 0 };
+    return { Path.str(), true, Status->getSize(),
+             Status->getLastModificationTime().toEpochTime() };
+  }
+
+  bool isUpToDate() const {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status))
+      return !Exists;
+    return Exists && Status.getSize() == Size &&
+           Status.getLastModificationTime().toEpochTime() == ModTime;
+  }
+};
+
+struct IndexedDependency {
+  UIdent Kind;
+  bool IsFinish;
+  std::string Name;
+  std::string Path;
+  bool IsSystem;
+  std::string Hash;
+};
+} // anonymous namespace
+
+struct SwiftIndexRecordCache::Record {
+  std::string Hash;
+  std::vector<IndexedDependency> Dependencies;
+  /// Every file whose state went into the hashes, plus the other input files,
+  /// whose imports affect the module's dependencies.
+  std::vector<IndexedFileStamp> Files;
+
+  bool isUpToDate() const {
+    return std::all_of(Files.begin(), Files.end(),
+                       [](const IndexedFileStamp &F) { return F.isUpToDate(); });
+  }
+
+  void replay(IndexingConsumer &Consumer) const {
+    if (!Consumer.recordHash(Hash, /*isKnown=*/true))
+      return;
+    for (auto &Dep : Dependencies) {
+      bool Continue = Dep.IsFinish
+          ? Consumer.finishDependency(Dep.Kind)
+          : Consumer.startDependency(Dep.Kind, Dep.Name, Dep.Path,
+                                     Dep.IsSystem, Dep.Hash);
+      if (!Continue)
+        return;
+    }
+  }
+};
+
+std::shared_ptr<const SwiftIndexRecordCache::Record>
+SwiftIndexRecordCache::get(StringRef Key) {
+  llvm::sys::ScopedLock L(Mtx);
+  auto It = Records.find(Key);
+  if (It == Records.end())
+    return nullptr;
+  return It->second;
+}
+
+void SwiftIndexRecordCache::set(StringRef Key, std::shared_ptr<const Record> R) {
+  llvm::sys::ScopedLock L(Mtx);
+  Records[Key] = std::move(R);
+}
+
+namespace {
+/// Forwards to another consumer, recording the hash and the dependencies.
+class RecordingIndexingConsumer : public IndexingConsumer {
+  IndexingConsumer &Next;
+  bool Complete = true;
+
+public:
+  SwiftIndexRecordCache::Record Record;
+
+  RecordingIndexingConsumer(IndexingConsumer &Next) : Next(Next) {}
+
+  /// Whether everything was reported without failure or cancellation.
+  bool isComplete() const { return Complete && !Record.Hash.empty(); }
+
+  void failed(StringRef ErrDescription) override {
+    Complete = false;
+    Next.failed(ErrDescription);
+  }
+
+  bool recordHash(StringRef Hash, bool isKnown) override {
+    Record.Hash = Hash.str();
+    return check(Next.recordHash(Hash, isKnown));
+  }
+
+  bool startDependency(UIdent Kind, StringRef Name, StringRef Path,
+                       bool IsSystem, StringRef Hash) override {
+    Record.Dependencies.push_back(
+        { Kind, false, Name.str(), Path.str(), IsSystem, Hash.str() });
+    return check(Next.startDependency(Kind, Name, Path, IsSystem, Hash));
+  }
+
+  bool finishDependency(UIdent Kind) override {
+    Record.Dependencies.push_back({ Kind, true, "", "", false, "" });
+    return check(Next.finishDependency(Kind));
+  }
+
+  bool startSourceEntity(const EntityInfo &Info) override {
+    return check(Next.startSourceEntity(Info));
+  }
+
+  bool recordRelatedEntity(const EntityInfo &Info) override {
+    return check(Next.recordRelatedEntity(Info));
+  }
+
+  bool finishSourceEntity(UIdent Kind) override {
+    return check(Next.finishSourceEntity(Kind));
+  }
+
+private:
+  bool check(bool Continue) {
+    Complete &= Continue;
+    return Continue;
+  }
+};
+} // anonymous namespace
+
 namespace {
 
 // Adapter providing a common interface for a SourceFile/Module.
@@ -98,13 +229,16 @@ class IndexSwiftASTWalker : public ide::SourceEntityWalker {
   SmallVector<Entity, 6> EntitiesStack;
   SmallVector<Expr *, 8> ExprStack;
   bool Cancelled = false;
+  /// If set, receives the state of every file that goes into a hash.
+  std::vector<IndexedFileStamp> *HashedFiles;
 
 public:
   IndexSwiftASTWalker(IndexingConsumer &IdxConsumer,
                       ASTContext &Ctx,
-                      unsigned BufferID)
+                      unsigned BufferID,
+                      std::vector<IndexedFileStamp> *HashedFiles = nullptr)
     : IdxConsumer(IdxConsumer), SrcMgr(Ctx.SourceMgr),
-      BufferID(BufferID) {
+      BufferID(BufferID), HashedFiles(HashedFiles) {
   }
   ~IndexSwiftASTWalker() {
     assert(Cancelled || EntitiesStack.empty());
@@ -267,6 +401,8 @@ private:
 
   void getModuleHash(SourceFileOrModule SFOrMod, llvm::raw_ostream &OS);
   llvm::hash_code hashModule(llvm::hash_code code, SourceFileOrModule SFOrMod);
+  llvm::hash_code hashFileReference(llvm::hash_code code,
+                                    SourceFileOrModule SFOrMod);
   void getRecursiveModuleImports(Module &Mod,
                                  SmallVectorImpl<Module *> &Imports);
   void collectRecursiveModuleImports(Module &Mod,
@@ -816,8 +952,9 @@ bool IndexSwiftASTWalker::initCallRefEntityInfo(Expr *CurrentE, Expr *ParentE,
   return false;
 }
 
-static llvm::hash_code hashFileReference(llvm::hash_code code,
-                                         SourceFileOrModule SFOrMod) {
+llvm::hash_code
+IndexSwiftASTWalker::hashFileReference(llvm::hash_code code,
+                                       SourceFileOrModule SFOrMod) {
   StringRef Filename = SFOrMod.getFilename();
   if (Filename.empty())
     return code;
@@ -829,9 +966,14 @@ static llvm::hash_code hashFileReference(llvm::hash_code code,
     // Failure to read the file, just use filename to recover.
     LOG_WARN_FUNC("failed to stat file: " << Filename
                   << " (" << Ret.message() << ')');
+    if (HashedFiles)
+      HashedFiles->push_back(IndexedFileStamp::get(Filename, nullptr));
     return hash_combine(code, Filename);
   }
 
+  if (HashedFiles)
+    HashedFiles->push_back(IndexedFileStamp::get(Filename, &Status));
+
   // Don't use inode because it can easily change when you update the repository
   // even though the file is supposed to be the same (same size/time).
   code = hash_combine(code, Filename);
@@ -1081,6 +1223,31 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
     return;
   }
 
+  // If the client already has the results for this hash and nothing that
+  // went into it changed, there is nothing to type-check.
+  std::string RecordKey = InputFile;
+  for (auto Arg : Args) {
+    RecordKey += '\0';
+    RecordKey += Arg;
+  }
+  if (!Hash.empty()) {
+    auto Record = IndexRecords.get(RecordKey);
+    if (Record && Record->Hash == Hash && Record->isUpToDate()) {
+      Record->replay(IdxConsumer);
+      return;
+    }
+  }
+
+  // Stat the inputs before reading them, so that the record can never be
+  // newer than what was indexed.
+  std::vector<IndexedFileStamp> InputStamps;
+  for (auto &Filename : Invocation.getInputFilenames()) {
+    llvm::sys::fs::file_status Status;
+    bool Exists = !llvm::sys::fs::status(Filename, Status);
+    InputStamps.push_back(
+        IndexedFileStamp::get(Filename, Exists ? &Status : nullptr));
+  }
+
   if (CI.setup(Invocation))
     return;
 
@@ -1104,7 +1271,16 @@ void SwiftLangSupport::indexSource(StringRef InputFile,
   // Setup a typechecker for protocol conformance resolving.
   OwnedResolver TypeResolver = createLazyResolver(CI.getASTContext());
 
+  RecordingIndexingConsumer Recorder(IdxConsumer);
+  std::vector<IndexedFileStamp> &Files = Recorder.Record.Files;
+  Files = std::move(InputStamps);
+
   unsigned BufferID = CI.getPrimarySourceFile()->getBufferID().getValue();
-  IndexSwiftASTWalker Walker(IdxConsumer, CI.getASTContext(), BufferID);
+  IndexSwiftASTWalker Walker(Recorder, CI.getASTContext(), BufferID, &Files);
   Walker.visitModule(*CI.getMainModule(), Hash);
+
+  if (Recorder.isComplete()) {
+    IndexRecords.set(RecordKey, std::make_shared<SwiftIndexRecordCache::Record>(
+                                    std::move(Recorder.Record)));
+  }
 }
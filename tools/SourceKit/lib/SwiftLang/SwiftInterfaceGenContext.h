@@ -16,6 +16,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "swift/AST/Module.h"
 #include "swift/Basic/ThreadSafeRefCounted.h"
+#include <memory>
 #include <string>
 
 namespace swift {
@@ -44,6 +45,11 @@ public:
                                                           ASTUnitRef AstUnit,
                                                           std::string &ErrMsg);
 
+  /// Returns a context for the document \p DocumentName which shares the
+  /// interface generated for \p Other, instead of generating it again.
+  static SwiftInterfaceGenContextRef
+  createShared(StringRef DocumentName, SwiftInterfaceGenContextRef Other);
+
   ~SwiftInterfaceGenContext();
 
   StringRef getDocumentName() const;
@@ -52,6 +58,16 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Returns true if a file of the module the interface was generated from
+  /// was modified or removed since.
+  bool isStale() const;
+
+  /// Returns true if this context and \p Other share the same generated
+  /// interface.
+  bool sharesInterfaceWith(const SwiftInterfaceGenContext &Other) const {
+    return &Impl == &Other.Impl;
+  }
+
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
   struct ResolvedEntity {
@@ -81,9 +97,12 @@ public:
   class Implementation;
 
 private:
+  std::shared_ptr<Implementation> SharedImpl;
   Implementation &Impl;
+  std::string DocumentName;
 
-  SwiftInterfaceGenContext();
+  SwiftInterfaceGenContext(StringRef DocumentName,
+                           std::shared_ptr<Implementation> SharedImpl);
 };
 
 } // namespace SourceKit.
@@ -25,6 +25,7 @@
 #include "llvm/Support/Mutex.h"
 #include <map>
 #include <string>
+#include <vector>
 
 namespace swift {
   class ASTContext;
@@ -137,6 +138,11 @@ class SessionCache : public ThreadSafeRefCountedBase<SessionCache> {
   CompletionSink sink;
   std::vector<Completion *> sortedCompletions;
   CompletionKind completionKind;
+  /// The completions matching the most recent non-empty filter text, in
+  /// sorted order, so that a longer filter only needs to look at these.
+  std::string lastFilterText;
+  bool lastFilterFuzzy = false;
+  std::vector<Completion *> lastFilterMatches;
   llvm::sys::Mutex mtx;
 
 public:
@@ -147,6 +153,13 @@ public:
         completionKind(completionKind) {}
   void setSortedCompletions(std::vector<Completion *> &&completions);
   ArrayRef<Completion *> getSortedCompletions();
+  /// Returns the sorted completions that can possibly match \p filterText,
+  /// which is a subset of getSortedCompletions() when \p filterText extends
+  /// the filter text of a previous update in the same matching mode.
+  std::vector<Completion *> getFilterCandidates(StringRef filterText,
+                                                bool fuzzy);
+  void setFilterMatches(StringRef filterText, bool fuzzy,
+                        std::vector<Completion *> &&matches);
   llvm::MemoryBuffer *getBuffer();
   ArrayRef<std::string> getCompilerArgs();
   CompletionKind getCompletionKind();
@@ -173,14 +186,43 @@ public:
 
 class SwiftInterfaceGenMap {
   llvm::StringMap<SwiftInterfaceGenContextRef> IFaceGens;
+  /// The module interfaces of recently closed documents, the most recently
+  /// closed one last, so that opening them again does not regenerate them.
+  std::vector<SwiftInterfaceGenContextRef> RecentlyClosed;
   mutable llvm::sys::Mutex Mtx;
 
+  static const unsigned MaxRecentlyClosed = 4;
+
 public:
   SwiftInterfaceGenContextRef get(StringRef Name) const;
   void set(StringRef Name, SwiftInterfaceGenContextRef IFaceGen);
   bool remove(StringRef Name);
   SwiftInterfaceGenContextRef find(StringRef ModuleName,
                                    const swift::CompilerInvocation &Invok);
+
+  /// Returns an up-to-date interface of \p ModuleName generated with options
+  /// matching \p Invok, either of an open document or a recently closed one.
+  SwiftInterfaceGenContextRef findReusable(StringRef ModuleName,
+                                        const swift::CompilerInvocation &Invok);
+};
+
+/// A thread-safe map from an indexed source file and its compiler arguments to
+/// what the last \c indexSource() of it reported before any entities.
+///
+/// When the client already knows the hash of a file whose hashed inputs are
+/// unchanged, the request can be answered from the record without running
+/// semantic analysis.
+class SwiftIndexRecordCache {
+public:
+  struct Record;
+
+private:
+  llvm::StringMap<std::shared_ptr<const Record>> Records;
+  llvm::sys::Mutex Mtx;
+
+public:
+  std::shared_ptr<const Record> get(StringRef Key);
+  void set(StringRef Key, std::shared_ptr<const Record> R);
 };
 
 struct SwiftCompletionCache
@@ -207,6 +249,7 @@ class SwiftLangSupport : public LangSupport {
   std::unique_ptr<SwiftASTManager> ASTMgr;
   SwiftEditorDocumentFileMap EditorDocuments;
   SwiftInterfaceGenMap IFaceGenContexts;
+  SwiftIndexRecordCache IndexRecords;
   ThreadSafeRefCntPtr<SwiftCompletionCache> CCCache;
   ThreadSafeRefCntPtr<SwiftPopularAPI> PopularAPI;
   CodeCompletion::SessionCacheMap CCSessions;
@@ -120,6 +120,7 @@ static sourcekitd_uid_t RequestEditorExpandPlaceholder;
 static sourcekitd_uid_t RequestEditorFindUSR;
 static sourcekitd_uid_t RequestEditorFindInterfaceDoc;
 static sourcekitd_uid_t RequestDocInfo;
+static sourcekitd_uid_t RequestStatistics;
 
 static sourcekitd_uid_t SemaDiagnosticStage;
 
@@ -210,6 +211,7 @@ static int skt_main(int argc, const char **argv) {
   RequestEditorFindUSR = sourcekitd_uid_get_from_cstr("source.request.editor.find_usr");
   RequestEditorFindInterfaceDoc = sourcekitd_uid_get_from_cstr("source.request.editor.find_interface_doc");
   RequestDocInfo = sourcekitd_uid_get_from_cstr("source.request.docinfo");
+  RequestStatistics = sourcekitd_uid_get_from_cstr("source.request.statistics");
 
   // A test invocation may initialize the options to be used for subsequent
   // invocations.
@@ -551,6 +553,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestEditorFindUSR);
     sourcekitd_request_dictionary_set_string(Req, KeyUSR, Opts.USR.c_str());
     break;
+
+  case SourceKitRequest::Statistics:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestStatistics);
+    break;
   }
 
   if (!SourceFile.empty()) {
@@ -613,6 +619,7 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     case SourceKitRequest::CodeCompleteUpdate:
     case SourceKitRequest::CodeCompleteCacheOnDisk:
     case SourceKitRequest::CodeCompleteSetPopularAPI:
+    case SourceKitRequest::Statistics:
       sourcekitd_response_description_dump_filedesc(Resp, STDOUT_FILENO);
       break;
 
@@ -104,6 +104,12 @@ extern SourceKit::UIdent KeyObsoleted;
 extern SourceKit::UIdent KeyRemoveCache;
 extern SourceKit::UIdent KeyTypeInterface;
 
+extern SourceKit::UIdent KeyCount;
+extern SourceKit::UIdent KeyValue;
+extern SourceKit::UIdent KeyTotal;
+extern SourceKit::UIdent KeyMax;
+extern SourceKit::UIdent KeyBuckets;
+
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
 
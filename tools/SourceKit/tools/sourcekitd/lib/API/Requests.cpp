@@ -20,6 +20,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
 #include "llvm/ADT/ArrayRef.h"
@@ -90,11 +91,15 @@ static LazySKDUID RequestEditorFindInterfaceDoc(
     "source.request.editor.find_interface_doc");
 static LazySKDUID RequestBuildSettingsRegister(
     "source.request.buildsettings.register");
+static LazySKDUID RequestStatistics("source.request.statistics");
 
 static LazySKDUID KindExpr("source.lang.swift.expr");
 static LazySKDUID KindStmt("source.lang.swift.stmt");
 static LazySKDUID KindType("source.lang.swift.type");
 
+static LazySKDUID KindStatLatency("source.statistic.latency");
+static LazySKDUID KindStatValue("source.statistic.value");
+
 static UIdent DiagKindNote("source.diagnostic.severity.note");
 static UIdent DiagKindWarning("source.diagnostic.severity.warning");
 static UIdent DiagKindError("source.diagnostic.severity.error");
@@ -113,8 +118,20 @@ static void onDocumentUpdateNotification(StringRef DocumentName) {
 
 static SourceKit::Context *GlobalCtx = nullptr;
 
+/// Returns the document update coalescing window, in milliseconds, set with
+/// the SOURCEKIT_DOCUMENT_UPDATE_COALESCING_WINDOW environment variable.
+static unsigned getDocumentUpdateCoalescingWindow() {
+  const char *EnvOpt = ::getenv("SOURCEKIT_DOCUMENT_UPDATE_COALESCING_WINDOW");
+  unsigned Milliseconds;
+  if (!EnvOpt || StringRef(EnvOpt).getAsInteger(10, Milliseconds))
+    return 0;
+  return Milliseconds;
+}
+
 void sourcekitd::initialize() {
   GlobalCtx = new SourceKit::Context(sourcekitd::getRuntimeLibPath());
+  GlobalCtx->getNotificationCenter().setDocumentUpdateCoalescingWindow(
+    getDocumentUpdateCoalescingWindow());
   GlobalCtx->getNotificationCenter().addDocumentUpdateNotificationReceiver(
     onDocumentUpdateNotification);
 }
@@ -205,6 +222,8 @@ editorFindUSR(StringRef DocumentName, StringRef USR);
 static sourcekitd_response_t
 editorFindInterfaceDoc(StringRef ModuleName, ArrayRef<const char *> Args);
 
+static sourcekitd_response_t reportStatistics();
+
 static bool isSemanticEditorDisabled();
 
 static void fillDictionaryForDiagnosticInfo(
@@ -219,7 +238,20 @@ void sourcekitd::handleRequest(sourcekitd_object_t Req,
     sourcekitd::printRequestObject(Req, Log->getOS());
   }
 
-  handleRequestImpl(Req, [Receiver](sourcekitd_response_t Resp) {
+  // Record the latency of each kind of request until its response is ready.
+  std::string LatencyMetric = "request.";
+  if (sourcekitd_uid_t ReqUID = RequestDict(Req).getUID(KeyRequest))
+    LatencyMetric += UIdentFromSKDUID(ReqUID).getName();
+  else
+    LatencyMetric += "<invalid>";
+  auto StartTime = std::chrono::steady_clock::now();
+
+  handleRequestImpl(Req, [Receiver, LatencyMetric, StartTime](
+                             sourcekitd_response_t Resp) {
+    auto Elapsed = std::chrono::steady_clock::now() - StartTime;
+    trace::recordLatency(LatencyMetric,
+      std::chrono::duration_cast<std::chrono::microseconds>(Elapsed).count());
+
     LOG_SECTION("handleRequest-after", InfoHighPrio) {
       // Responses are big, print them out with info medium priority.
       if (Logger::isLoggingEnabledForLevel(Logger::Level::InfoMediumPrio))
@@ -285,6 +317,10 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     return Rec(ResponseBuilder().createResponse());
   }
 
+  if (ReqUID == RequestStatistics) {
+    return Rec(reportStatistics());
+  }
+
   Optional<StringRef> SourceFile = Req.getString(KeySourceFile);
   Optional<StringRef> SourceText = Req.getString(KeySourceText);
 
@@ -1158,6 +1194,47 @@ static void findRelatedIdents(StringRef Filename,
   });
 }
 
+//============================================================================//
+// Statistics
+//============================================================================//
+
+static sourcekitd_response_t reportStatistics() {
+  std::vector<trace::LatencyMetric> Latencies;
+  std::vector<trace::ValueMetric> Values;
+  trace::getMetrics(Latencies, Values);
+
+  ResponseBuilder RespBuilder;
+  auto Arr = RespBuilder.getDictionary().setArray(KeyResults);
+  for (auto &Metric : Latencies) {
+    auto Elem = Arr.appendDictionary();
+    Elem.set(KeyKind, KindStatLatency);
+    Elem.set(KeyName, Metric.Name);
+    Elem.set(KeyCount, int64_t(Metric.Count));
+    Elem.set(KeyTotal, int64_t(Metric.TotalMicros));
+    Elem.set(KeyMax, int64_t(Metric.MaxMicros));
+
+    // Only report the buckets which have samples, each one with the exclusive
+    // upper bound of its latencies in microseconds.
+    auto Buckets = Elem.setArray(KeyBuckets);
+    for (unsigned I = 0; I != trace::NumLatencyBuckets; ++I) {
+      if (!Metric.Buckets[I])
+        continue;
+      auto Bucket = Buckets.appendDictionary();
+      if (I + 1 != trace::NumLatencyBuckets)
+        Bucket.set(KeyValue, int64_t(1) << I);
+      Bucket.set(KeyCount, int64_t(Metric.Buckets[I]));
+    }
+  }
+  for (auto &Metric : Values) {
+    auto Elem = Arr.appendDictionary();
+    Elem.set(KeyKind, KindStatValue);
+    Elem.set(KeyName, Metric.Name);
+    Elem.set(KeyValue, Metric.Value);
+  }
+
+  return RespBuilder.createResponse();
+}
+
 //============================================================================//
 // CodeComplete
 //============================================================================//
@@ -117,6 +117,12 @@ UIdent sourcekitd::KeyObsoleted("key.obsoleted");
 UIdent sourcekitd::KeyRemoveCache("key.removecache");
 UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 
+UIdent sourcekitd::KeyCount("key.count");
+UIdent sourcekitd::KeyValue("key.value");
+UIdent sourcekitd::KeyTotal("key.total");
+UIdent sourcekitd::KeyMax("key.max");
+UIdent sourcekitd::KeyBuckets("key.buckets");
+
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
 static UIdent *OrderedKeys[] = {
@@ -193,7 +199,13 @@ static UIdent *OrderedKeys[] = {
   &KeyIntroduced,
   &KeyDeprecated,
   &KeyObsoleted,
-  &KeyRemoveCache
+  &KeyRemoveCache,
+
+  &KeyValue,
+  &KeyCount,
+  &KeyTotal,
+  &KeyMax,
+  &KeyBuckets
 };
 
 static unsigned findPrintOrderForDictKey(UIdent Key) {
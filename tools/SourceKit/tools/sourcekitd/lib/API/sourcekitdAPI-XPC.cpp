@@ -20,6 +20,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <dispatch/dispatch.h>
 #include <map>
 #include <vector>
 #include <xpc/xpc.h>
@@ -288,16 +289,24 @@ void ResponseBuilder::Dictionary::setCustomBuffer(
       SourceKit::UIdent Key,
       CustomBufferKind Kind, std::unique_ptr<llvm::MemoryBuffer> MemBuf) {
 
-  std::unique_ptr<llvm::MemoryBuffer> CustomBuf;
-  CustomBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(
-      sizeof(uint64_t) + MemBuf->getBufferSize());
-  char *BufPtr = (char*)CustomBuf->getBufferStart();
-  *reinterpret_cast<uint64_t*>(BufPtr) = (uint64_t)Kind;
-  BufPtr += sizeof(uint64_t);
-  memcpy(BufPtr, MemBuf->getBufferStart(), MemBuf->getBufferSize());
-
-  xpc_object_t xdata = xpc_data_create(CustomBuf->getBufferStart(),
-                                       CustomBuf->getBufferSize());
+  // Build the payload once and hand its ownership to XPC, instead of building
+  // it in a temporary buffer that xpc_data_create() would copy again. This
+  // also lets XPC send large payloads by mapping their pages into the client,
+  // where the custom buffer readers decode them in place.
+  size_t CustomBufSize = sizeof(uint64_t) + MemBuf->getBufferSize();
+  char *CustomBuf = static_cast<char *>(malloc(CustomBufSize));
+  if (!CustomBuf)
+    llvm::report_fatal_error("out of memory allocating custom buffer");
+  *reinterpret_cast<uint64_t*>(CustomBuf) = (uint64_t)Kind;
+  memcpy(CustomBuf + sizeof(uint64_t), MemBuf->getBufferStart(),
+         MemBuf->getBufferSize());
+  MemBuf.reset();
+
+  dispatch_data_t ddata = dispatch_data_create(CustomBuf, CustomBufSize,
+                                               nullptr,
+                                               DISPATCH_DATA_DESTRUCTOR_FREE);
+  xpc_object_t xdata = xpc_data_create_with_dispatch_data(ddata);
+  dispatch_release(ddata);
   xpc_dictionary_set_value(Impl, Key.c_str(), xdata);
   xpc_release(xdata);
 }
@@ -0,0 +1,84 @@
+//===-- compile_server_main.cpp - Long-running frontend process -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Runs many frontend jobs in a single process, so that the cost of starting
+// the compiler and reading imported module files is paid once rather than
+// once per job.
+//
+// Jobs are read from standard input. Each job is a list of frontend
+// arguments (everything that would follow 'swift -frontend'), one argument
+// per line, terminated by an empty line. After running a job the server
+// writes "exit-status: <N>" on a line of its own to standard output.
+// Diagnostics go to standard error as usual. Jobs should therefore write
+// their outputs to files rather than to standard output.
+//
+// Jobs run in the server's working directory, and LLVM options (-Xllvm)
+// only take effect for the first job that passes them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/LLVM.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+extern int frontend_main(ArrayRef<const char *> Args, const char *Argv0,
+                         void *MainAddr);
+
+int compile_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                        void *MainAddr) {
+  if (!Args.empty()) {
+    llvm::errs() << "error: -compile-server does not take any arguments; "
+                    "jobs are read from standard input\n";
+    return 1;
+  }
+
+  // Unchanged module files only need to be read once for all jobs.
+  SerializedModuleLoader::enableProcessWideBufferCache();
+
+  std::vector<std::string> JobArgs;
+  std::string Line;
+  auto runJob = [&] {
+    SmallVector<const char *, 64> JobArgPtrs;
+    for (const std::string &Arg : JobArgs)
+      JobArgPtrs.push_back(Arg.c_str());
+
+    int ExitStatus = frontend_main(JobArgPtrs, Argv0, MainAddr);
+    JobArgs.clear();
+
+    llvm::errs().flush();
+    llvm::outs() << "exit-status: " << ExitStatus << '\n';
+    llvm::outs().flush();
+  };
+
+  while (std::getline(std::cin, Line)) {
+    if (!Line.empty()) {
+      JobArgs.push_back(Line);
+      continue;
+    }
+    if (!JobArgs.empty())
+      runJob();
+  }
+
+  // Allow the last job to be terminated by the end of input.
+  if (!JobArgs.empty())
+    runJob();
+
+  return 0;
+}
@@ -59,6 +59,10 @@ extern int autolink_extract_main(ArrayRef<const char *> Args, const char *Argv0,
 extern int modulewrap_main(ArrayRef<const char *> Args, const char *Argv0,
                            void *MainAddr);
 
+/// Run frontend jobs read from standard input in this process.
+extern int compile_server_main(ArrayRef<const char *> Args, const char *Argv0,
+                               void *MainAddr);
+
 /// Determine if the given invocation should run as a subcommand.
 ///
 /// \param ExecName The name of the argv[0] we were invoked as.
@@ -162,6 +166,11 @@ int main(int argc_, const char **argv_) {
                                                 argv.data()+argv.size()),
                              argv[0], (void *)(intptr_t)getExecutablePath);
     }
+    if (FirstArg == "-compile-server") {
+      return compile_server_main(llvm::makeArrayRef(argv.data()+2,
+                                                    argv.data()+argv.size()),
+                                 argv[0], (void *)(intptr_t)getExecutablePath);
+    }
   }
 
   std::string Path = getExecutablePath(argv[0]);
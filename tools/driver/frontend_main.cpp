@@ -27,15 +27,20 @@
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/FileSystem.h"
+#include "swift/Basic/FrontendStats.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
 #include "swift/Frontend/SerializedDiagnosticConsumer.h"
 #include "swift/Immediate/Immediate.h"
 #include "swift/Option/Options.h"
+#include "swift/Parse/Lexer.h"
 #include "swift/PrintAsObjC/PrintAsObjC.h"
 #include "swift/Serialization/SerializationOptions.h"
+#include "swift/Serialization/SerializedModuleLoader.h"
+#include "swift/SIL/SILModule.h"
 #include "swift/SILPasses/Passes.h"
 
 // FIXME: We're just using CompilerInstance::createOutputFile.
@@ -43,17 +48,21 @@
 #include "clang/Frontend/CompilerInstance.h"
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Option/OptTable.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/YAMLParser.h"
 
+#include <map>
 #include <memory>
 #include <unordered_set>
 
@@ -172,6 +181,151 @@ static void mangleTypeAsContext(StreamTy &&out, const NominalTypeDecl *type) {
   mangler.mangleContext(type, Mangle::Mangler::BindGenerics::None);
 }
 
+/// Returns the location of the first attribute or modifier of \p D, or of the
+/// declaration itself if it has none.
+static SourceLoc getInterfaceStartLoc(const SourceManager &SM, const Decl *D) {
+  SourceLoc start = D->getStartLoc();
+  for (bool forModifiers : {false, true}) {
+    SourceLoc attrStart = D->getAttrs().getStartLoc(forModifiers);
+    if (attrStart.isValid() &&
+        (start.isInvalid() || SM.isBeforeInBuffer(attrStart, start)))
+      start = attrStart;
+  }
+  return start;
+}
+
+/// Appends the source text in [\p start, \p end) to \p out.
+static void appendSourceText(std::string &out, const SourceManager &SM,
+                             SourceLoc start, SourceLoc end) {
+  if (start.isInvalid() || end.isInvalid() || !SM.isBeforeInBuffer(start, end))
+    return;
+  out += SM.extractText(CharSourceRange(SM, start, end));
+  out += '\n';
+}
+
+static void appendDeclInterface(std::string &out, const SourceManager &SM,
+                                const ValueDecl *VD);
+
+/// Describes the parts of \p NTD that other files can depend on just by
+/// naming the type: its header (attributes, generic parameters, inherited
+/// types), plus any members that affect its layout.
+///
+/// Stored properties affect the layout of structs and classes, cases affect
+/// the layout of enums, and every member of a class or protocol occupies a
+/// slot in its vtable or witness table. These are included whatever their
+/// accessibility.
+static std::string getNominalInterface(const SourceManager &SM,
+                                       const NominalTypeDecl *NTD) {
+  std::string out;
+  out += Decl::getKindName(NTD->getKind());
+  out += '\n';
+  appendSourceText(out, SM, getInterfaceStartLoc(SM, NTD),
+                   NTD->getBraces().Start);
+
+  bool allMembersAffectLayout = isa<ClassDecl>(NTD) || isa<ProtocolDecl>(NTD);
+  for (const Decl *member : NTD->getMembers(/*forceDelayed=*/false)) {
+    auto *VD = dyn_cast<ValueDecl>(member);
+    if (!VD)
+      continue;
+    bool affectsLayout = allMembersAffectLayout || isa<EnumElementDecl>(VD);
+    if (auto *var = dyn_cast<VarDecl>(VD))
+      affectsLayout |= var->hasStorage() && !var->isStatic();
+    if (!affectsLayout || isa<NominalTypeDecl>(VD))
+      continue;
+    out += VD->getName().str();
+    out += '\n';
+    appendDeclInterface(out, SM, VD);
+  }
+  return out;
+}
+
+/// Describes the parts of \p VD that uses of it from other files can depend
+/// on. Function bodies and property initializers are deliberately excluded.
+static void appendDeclInterface(std::string &out, const SourceManager &SM,
+                                const ValueDecl *VD) {
+  out += Decl::getKindName(VD->getKind());
+  if (VD->hasAccessibility())
+    out += " access=" + std::to_string(unsigned(VD->getFormalAccess()));
+  if (VD->isStatic())
+    out += " static";
+  if (VD->hasType()) {
+    out += " type=";
+    out += VD->getType().getString();
+    if (isa<AbstractStorageDecl>(VD) && VD->isSettable(nullptr))
+      out += " settable";
+  }
+  out += '\n';
+
+  if (auto *NTD = dyn_cast<NominalTypeDecl>(VD)) {
+    out += getNominalInterface(SM, NTD);
+  } else if (auto *AFD = dyn_cast<AbstractFunctionDecl>(VD)) {
+    SourceLoc end = AFD->getBodySourceRange().Start;
+    if (end.isInvalid() && AFD->getEndLoc().isValid())
+      end = Lexer::getLocForEndOfToken(SM, AFD->getEndLoc());
+    appendSourceText(out, SM, getInterfaceStartLoc(SM, AFD), end);
+  }
+}
+
+namespace {
+/// Collects the interface of every provided top-level name, type, and member,
+/// so that the driver can tell which of them changed between two builds and
+/// only rebuild the files that use those.
+class DeclInterfaceCollector {
+  const SourceManager &SM;
+  std::map<std::string, std::string> TopLevel;
+  std::map<std::pair<std::string, std::string>, std::string> Members;
+
+  static void printHash(raw_ostream &out, StringRef interface) {
+    llvm::MD5 hash;
+    hash.update(interface);
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    out << str;
+  }
+
+public:
+  explicit DeclInterfaceCollector(const SourceManager &SM) : SM(SM) {}
+
+  const SourceManager &getSourceManager() const { return SM; }
+
+  /// Returns the interface text for a top-level name or a mangled type name.
+  std::string &getTopLevel(StringRef name) { return TopLevel[name.str()]; }
+
+  /// Returns the interface text for the member \p name of the type whose
+  /// mangled name is \p mangledType.
+  std::string &getMember(StringRef mangledType, StringRef name) {
+    return Members[std::make_pair(mangledType.str(), name.str())];
+  }
+
+  /// Prints the "provides-member" entries for every individual member.
+  template <typename EscapeFn>
+  void printProvidedMembers(raw_ostream &out, EscapeFn escape) const {
+    for (auto &entry : Members) {
+      out << "- [\"" << entry.first.first << "\", \""
+          << escape(entry.first.second) << "\"]\n";
+    }
+  }
+
+  template <typename EscapeFn>
+  void printHashes(raw_ostream &out, EscapeFn escape) const {
+    out << "decl-interface-hashes:\n";
+    for (auto &entry : TopLevel) {
+      out << "- [\"" << escape(entry.first) << "\", \"";
+      printHash(out, entry.second);
+      out << "\"]\n";
+    }
+    for (auto &entry : Members) {
+      out << "- [\"" << entry.first.first << "\", \""
+          << escape(entry.first.second) << "\", \"";
+      printHash(out, entry.second);
+      out << "\"]\n";
+    }
+  }
+};
+}
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
@@ -197,11 +351,16 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   auto escape = [](Identifier name) -> std::string {
     return llvm::yaml::escape(name.str());
   };
+  auto escapeString = [](StringRef name) -> std::string {
+    return llvm::yaml::escape(name);
+  };
 
   out << "### Swift dependencies file v0 ###\n";
 
   llvm::MapVector<const NominalTypeDecl *, bool> extendedNominals;
-  llvm::SmallVector<const ExtensionDecl *, 8> extensionsWithJustMembers;
+  llvm::SmallVector<std::pair<const ExtensionDecl *, bool>, 8> extensions;
+  DeclInterfaceCollector interfaces(SF->getASTContext().SourceMgr);
+  const SourceManager &SM = interfaces.getSourceManager();
 
   out << "provides-top-level:\n";
   for (const Decl *D : SF->Decls) {
@@ -230,10 +389,9 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         if (std::all_of(ED->getMembers().begin(), ED->getMembers().end(),
                         declIsPrivate)) {
           break;
-        } else {
-          extensionsWithJustMembers.push_back(ED);
         }
       }
+      extensions.push_back({ED, justMembers});
       extendedNominals[NTD] |= !justMembers;
       findNominals(extendedNominals, ED->getMembers());
       break;
@@ -243,6 +401,10 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     case DeclKind::PrefixOperator:
     case DeclKind::PostfixOperator:
       out << "- \"" << escape(cast<OperatorDecl>(D)->getName()) << "\"\n";
+      appendSourceText(interfaces.getTopLevel(
+                         cast<OperatorDecl>(D)->getName().str()),
+                       SM, D->getStartLoc(),
+                       Lexer::getLocForEndOfToken(SM, D->getEndLoc()));
       break;
 
     case DeclKind::Enum:
@@ -257,6 +419,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(NTD->getName()) << "\"\n";
+      interfaces.getTopLevel(NTD->getName().str()) +=
+          getNominalInterface(SM, NTD);
       extendedNominals[NTD] |= true;
       findNominals(extendedNominals, NTD->getMembers());
       break;
@@ -273,6 +437,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
         break;
       }
       out << "- \"" << escape(VD->getName()) << "\"\n";
+      appendDeclInterface(interfaces.getTopLevel(VD->getName().str()), SM, VD);
       break;
     }
 
@@ -294,6 +459,22 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     }
   }
 
+  // Record the interface of each member that other files can look up, so
+  // that changing one member only invalidates the files that use it.
+  auto addMemberInterfaces = [&](StringRef mangledName, DeclRange members,
+                                 StringRef contextHeader) {
+    for (auto *member : members) {
+      auto *VD = dyn_cast<ValueDecl>(member);
+      if (!VD || !VD->hasName() ||
+          VD->getFormalAccess() == Accessibility::Private) {
+        continue;
+      }
+      std::string &text = interfaces.getMember(mangledName, VD->getName().str());
+      text += contextHeader;
+      appendDeclInterface(text, SM, VD);
+    }
+  };
+
   out << "provides-nominal:\n";
   for (auto entry : extendedNominals) {
     if (!entry.second)
@@ -301,6 +482,33 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
     out << "- \"";
     mangleTypeAsContext(out, entry.first);
     out << "\"\n";
+
+    const NominalTypeDecl *NTD = entry.first;
+    if (NTD->getDeclContext()->getParentSourceFile() != SF)
+      continue;
+    if (NTD->hasAccessibility() &&
+        NTD->getFormalAccess() == Accessibility::Private)
+      continue;
+    SmallString<32> mangledName;
+    mangleTypeAsContext(llvm::raw_svector_ostream(mangledName), NTD);
+    interfaces.getTopLevel(mangledName) += getNominalInterface(SM, NTD);
+    addMemberInterfaces(mangledName, NTD->getMembers(/*forceDelayed=*/false),
+                        "");
+  }
+
+  for (auto entry : extensions) {
+    const ExtensionDecl *ED = entry.first;
+    SmallString<32> mangledName;
+    mangleTypeAsContext(llvm::raw_svector_ostream(mangledName),
+                        ED->getExtendedType()->getAnyNominal());
+
+    // The extension's header carries its conformances and constraints.
+    std::string header;
+    appendSourceText(header, SM, getInterfaceStartLoc(SM, ED),
+                     ED->getBraces().Start);
+    if (!entry.second)
+      interfaces.getTopLevel(mangledName) += header;
+    addMemberInterfaces(mangledName, ED->getMembers(), header);
   }
 
   out << "provides-member:\n";
@@ -311,21 +519,7 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   }
 
   // This is also part of "provides-member".
-  for (auto *ED : extensionsWithJustMembers) {
-    SmallString<32> mangledName;
-    mangleTypeAsContext(llvm::raw_svector_ostream(mangledName),
-                        ED->getExtendedType()->getAnyNominal());
-
-    for (auto *member : ED->getMembers()) {
-      auto *VD = dyn_cast<ValueDecl>(member);
-      if (!VD || !VD->hasName() ||
-          VD->getFormalAccess() == Accessibility::Private) {
-        continue;
-      }
-      out << "- [\"" << mangledName.str() << "\", \""
-          << escape(VD->getName()) << "\"]\n";
-    }
-  }
+  interfaces.printProvidedMembers(out, escapeString);
 
   if (SF->getASTContext().LangOpts.EnableObjCInterop) {
     // FIXME: This requires a traversal of the whole file to compute.
@@ -432,14 +626,36 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   }
 
   out << "depends-external:\n";
+  llvm::StringSet<> externalDependencies;
   for (auto &entry : depTracker.getDependencies()) {
     out << "- \"" << llvm::yaml::escape(entry) << "\"\n";
+    externalDependencies.insert(entry);
+  }
+
+  // Record the interfaces of the Swift modules this file was compiled
+  // against, so that rebuilding one of them without changing its interface
+  // doesn't cause this file to be rebuilt.
+  out << "external-interface-hashes:\n";
+  for (auto &loaded : SF->getASTContext().LoadedModules) {
+    for (const FileUnit *file : loaded.second->getFiles()) {
+      auto *serialized = dyn_cast<SerializedASTFile>(file);
+      if (!serialized)
+        continue;
+      StringRef hash = serialized->getInterfaceHash();
+      StringRef path = serialized->getFilename();
+      if (hash.empty() || !externalDependencies.count(path))
+        continue;
+      out << "- [\"" << llvm::yaml::escape(path) << "\", \"" << hash
+          << "\"]\n";
+    }
   }
 
   llvm::SmallString<32> interfaceHash;
   SF->getInterfaceHash(interfaceHash);
   out << "interface-hash: \"" << interfaceHash << "\"\n";
 
+  interfaces.printHashes(out, escapeString);
+
   return false;
 }
 
@@ -609,138 +825,56 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
-/// Performs the compile requested by the user.
-/// \returns true on error
-static bool performCompile(CompilerInstance &Instance,
-                           CompilerInvocation &Invocation,
-                           ArrayRef<const char *> Args,
-                           int &ReturnValue) {
-  FrontendOptions opts = Invocation.getFrontendOptions();
-  FrontendOptions::ActionType Action = opts.RequestedAction;
-
-  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
-
-  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
-  if (inputIsLLVMIr) {
-    auto &LLVMContext = llvm::getGlobalContext();
-
-    // Load in bitcode file.
-    assert(Invocation.getInputFilenames().size() == 1 &&
-           "We expect a single input for bitcode input!");
-    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
-      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
-    if (!FileBufOrErr) {
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_open_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              FileBufOrErr.getError().message());
-      return true;
-    }
-    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
-
-    llvm::SMDiagnostic Err;
-    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
-                                             MainFile->getMemBufferRef(),
-                                             Err, LLVMContext);
-    if (!Module) {
-      // TODO: Translate from the diagnostic info to the SourceManager location
-      // if available.
-      Instance.getASTContext().Diags.diagnose(SourceLoc(),
-                                              diag::error_parse_input_file,
-                                              Invocation.getInputFilenames()[0],
-                                              Err.getMessage());
-      return true;
-    }
-
-    // TODO: remove once the frontend understands what action it should perform
-    IRGenOpts.OutputKind = getOutputKind(Action);
-
-    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
-  }
-
-  ReferencedNameTracker nameTracker;
-  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
-    Instance.setReferencedNameTracker(&nameTracker);
-
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpInterfaceHash)
-    Instance.performParseOnly();
-  else
-    Instance.performSema();
-
-  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
-  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
-    debugFailWithAssertion();
-  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
-    debugFailWithCrash();
-
-  ASTContext &Context = Instance.getASTContext();
+/// Returns the number of instructions in \p SM.
+static uint64_t getInstructionCount(const SILModule &SM) {
+  uint64_t Count = 0;
+  for (const SILFunction &F : SM)
+    for (const SILBasicBlock &BB : F)
+      Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
 
-  if (Action == FrontendOptions::REPL) {
-    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
-            Invocation.getParseStdlib());
-    return false;
+/// Records the memory held by each subsystem at the end of \p P, if the job
+/// collects statistics.
+static void recordMemoryUsage(ASTContext &Context, FrontendStats::Phase P,
+                              const SILModule *SM = nullptr) {
+  if (!Context.Stats)
+    return;
+
+  using Category = FrontendStats::MemoryCategory;
+  FrontendStats::MemoryUsage Usage;
+  Usage[Category::ASTContext] =
+    Context.getTotalMemory() - Context.getSolverMemory();
+  Usage[Category::ConstraintSolverPeak] = Context.getPeakSolverMemory();
+  if (SM) {
+    Usage[Category::SILModule] = SM->getAllocatedMemory();
+    Usage[Category::SILTypeLowering] = SM->Types.getTotalMemory();
   }
-
-  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
-
-  // We've been told to dump the AST (either after parsing or type-checking,
-  // which is already differentiated in CompilerInstance::performSema()),
-  // so dump or print the main source file and return.
-  if (Action == FrontendOptions::DumpParse ||
-      Action == FrontendOptions::DumpAST ||
-      Action == FrontendOptions::PrintAST ||
-      Action == FrontendOptions::DumpTypeRefinementContexts ||
-      Action == FrontendOptions::DumpInterfaceHash) {
-    SourceFile *SF = PrimarySourceFile;
-    if (!SF) {
-      SourceFileKind Kind = Invocation.getSourceFileKind();
-      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
-    }
-    if (Action == FrontendOptions::PrintAST)
-      SF->print(llvm::outs(), PrintOptions::printEverything());
-    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
-      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
-    else if (Action == FrontendOptions::DumpInterfaceHash)
-      SF->dumpInterfaceHash(llvm::errs());
-    else
-      SF->dump();
-    return false;
+  if (auto *importer =
+        static_cast<ClangImporter *>(Context.getClangModuleLoader())) {
+    Usage[Category::ClangImporter] = importer->getImporterMemory();
+    Usage[Category::Clang] = importer->getClangMemory();
   }
+  for (auto &loaded : Context.LoadedModules)
+    for (const FileUnit *file : loaded.second->getFiles())
+      if (auto *serialized = dyn_cast<SerializedASTFile>(file))
+        Usage[Category::SerializedModules] += serialized->getBufferMemory();
+  Usage[Category::Malloc] = llvm::sys::Process::GetMallocUsage();
 
-  // If we were asked to print Clang stats, do so.
-  if (opts.PrintClangStats && Context.getClangModuleLoader())
-    Context.getClangModuleLoader()->printStatistics();
-
-  if (!opts.DependenciesFilePath.empty())
-    (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
-                               opts);
-
-  if (shouldTrackReferences)
-    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
-                              *Instance.getDependencyTracker(), opts);
-
-  if (Context.hadError())
-    return true;
-
-  // FIXME: This is still a lousy approximation of whether the module file will
-  // be externally consumed.
-  bool moduleIsPublic =
-      !Instance.getMainModule()->hasEntryPoint() &&
-      opts.ImplicitObjCHeaderPath.empty() &&
-      !Context.LangOpts.EnableAppExtensionRestrictions;
-
-  // We've just been told to perform a parse, so we can return now.
-  if (Action == FrontendOptions::Parse) {
-    if (!opts.ObjCHeaderOutputPath.empty())
-      return printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
-                         opts.ImplicitObjCHeaderPath, moduleIsPublic);
-    return false;
-  }
+  Context.Stats->recordMemoryUsage(P, Usage);
+}
 
-  assert(Action >= FrontendOptions::EmitSILGen &&
-         "All actions not requiring SILGen must have been handled!");
+/// Runs SILGen, the SIL pipeline, serialization and IRGen for the whole
+/// module, or for \p PrimarySourceFile if \p opts has a primary input.
+static bool performCompileStepsPostSema(CompilerInstance &Instance,
+                                        CompilerInvocation &Invocation,
+                                        const FrontendOptions &opts,
+                                        SourceFile *PrimarySourceFile,
+                                        IRGenOptions &IRGenOpts,
+                                        bool moduleIsPublic,
+                                        int &ReturnValue) {
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  ASTContext &Context = Instance.getASTContext();
 
   std::unique_ptr<SILModule> SM = Instance.takeSILModule();
   if (!SM) {
@@ -750,13 +884,18 @@ static bool performCompile(CompilerInstance &Instance,
         auto Index = opts.PrimaryInput.getValue().Index;
         PrimaryFile = Instance.getMainModule()->getFiles()[Index];
       }
+      FrontendStats::PhaseTimer timer(Context.Stats,
+                                     FrontendStats::Phase::SILGen);
       SM = performSILGeneration(*PrimaryFile, Invocation.getSILOptions(),
                                 None, opts.SILSerializeAll);
     } else {
+      FrontendStats::PhaseTimer timer(Context.Stats,
+                                     FrontendStats::Phase::SILGen);
       SM = performSILGeneration(Instance.getMainModule(), Invocation.getSILOptions(),
                                 opts.SILSerializeAll,
                                 true);
     }
+    recordMemoryUsage(Context, FrontendStats::Phase::SILGen, SM.get());
   }
 
   // We've been told to emit SIL after SILGen, so write it now.
@@ -786,6 +925,10 @@ static bool performCompile(CompilerInstance &Instance,
     return false;
   }
 
+  Optional<FrontendStats::PhaseTimer> SILOptimizationTimer;
+  SILOptimizationTimer.emplace(Context.Stats,
+                               FrontendStats::Phase::SILOptimization);
+
   // Perform "stable" optimizations that are invariant across compiler versions.
   if (!Invocation.getDiagnosticOptions().SkipDiagnosticPasses &&
       runSILDiagnosticPasses(*SM))
@@ -811,6 +954,11 @@ static bool performCompile(CompilerInstance &Instance,
     runSILPassesForOnone(*SM);
   }
   SM->verify();
+  SILOptimizationTimer.reset();
+  recordMemoryUsage(Context, FrontendStats::Phase::SILOptimization, SM.get());
+
+  if (Context.Stats)
+    Context.Stats->NumSILInstructions += getInstructionCount(*SM);
 
   // Gather instruction counts if we are asked to do so.
   if (SM->getOptions().PrintInstCounts) {
@@ -852,13 +1000,24 @@ static bool performCompile(CompilerInstance &Instance,
       serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
       serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
       serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
-      if (opts.SerializeBridgingHeader)
+      if (opts.SerializeBridgingHeader) {
         serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
+        // Modules refer to the bridging header itself, not to a PCH of it
+        // that only lives as long as the build.
+        if (auto *clangImporter = static_cast<ClangImporter *>(
+              Context.getClangModuleLoader())) {
+          StringRef originalHeader =
+              clangImporter->getBridgingPCHOriginalHeader();
+          if (!originalHeader.empty())
+            serializationOpts.ImportedHeader = originalHeader;
+        }
+      }
       serializationOpts.ModuleLinkName = opts.ModuleLinkName;
       serializationOpts.ExtraClangOptions =
           Invocation.getClangImporterOptions().ExtraArgs;
       if (!IRGenOpts.ForceLoadSymbolName.empty())
         serializationOpts.AutolinkForceLoad = true;
+      serializationOpts.NumThreads = Invocation.getSILOptions().NumThreads;
 
       // Options contain information about the developer's computer,
       // so only serialize them if the module isn't going to be shipped to
@@ -911,6 +1070,8 @@ static bool performCompile(CompilerInstance &Instance,
   // FIXME: We shouldn't need to use the global context here, but
   // something is persisting across calls to performIRGeneration.
   auto &LLVMContext = llvm::getGlobalContext();
+  FrontendStats::PhaseTimer IRGenTimer(Context.Stats,
+                                       FrontendStats::Phase::IRGen);
   if (PrimarySourceFile) {
     performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
                         opts.getSingleOutputFilename(), LLVMContext);
@@ -918,10 +1079,207 @@ static bool performCompile(CompilerInstance &Instance,
     performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
                         opts.getSingleOutputFilename(), LLVMContext);
   }
+  recordMemoryUsage(Context, FrontendStats::Phase::IRGen, SM.get());
 
   return false;
 }
 
+/// Performs the compile requested by the user.
+/// \returns true on error
+static bool performCompile(CompilerInstance &Instance,
+                           CompilerInvocation &Invocation,
+                           ArrayRef<const char *> Args,
+                           int &ReturnValue) {
+  FrontendOptions opts = Invocation.getFrontendOptions();
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+
+  IRGenOptions &IRGenOpts = Invocation.getIRGenOptions();
+
+  bool inputIsLLVMIr = Invocation.getInputKind() == InputFileKind::IFK_LLVM_IR;
+  if (inputIsLLVMIr) {
+    auto &LLVMContext = llvm::getGlobalContext();
+
+    // Load in bitcode file.
+    assert(Invocation.getInputFilenames().size() == 1 &&
+           "We expect a single input for bitcode input!");
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileBufOrErr =
+      llvm::MemoryBuffer::getFileOrSTDIN(Invocation.getInputFilenames()[0]);
+    if (!FileBufOrErr) {
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_open_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              FileBufOrErr.getError().message());
+      return true;
+    }
+    llvm::MemoryBuffer *MainFile = FileBufOrErr.get().get();
+
+    llvm::SMDiagnostic Err;
+    std::unique_ptr<llvm::Module> Module = llvm::parseIR(
+                                             MainFile->getMemBufferRef(),
+                                             Err, LLVMContext);
+    if (!Module) {
+      // TODO: Translate from the diagnostic info to the SourceManager location
+      // if available.
+      Instance.getASTContext().Diags.diagnose(SourceLoc(),
+                                              diag::error_parse_input_file,
+                                              Invocation.getInputFilenames()[0],
+                                              Err.getMessage());
+      return true;
+    }
+
+    // TODO: remove once the frontend understands what action it should perform
+    IRGenOpts.OutputKind = getOutputKind(Action);
+
+    return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
+  }
+
+  // Precompiling the bridging header only needs the Clang importer.
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+        Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(opts.InputFilenames[0],
+                                          opts.getSingleOutputFilename());
+  }
+
+  ReferencedNameTracker nameTracker;
+  bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
+  if (shouldTrackReferences)
+    Instance.setReferencedNameTracker(&nameTracker);
+
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpInterfaceHash)
+    Instance.performParseOnly();
+  else
+    Instance.performSema();
+
+  FrontendOptions::DebugCrashMode CrashMode = opts.CrashMode;
+  if (CrashMode == FrontendOptions::DebugCrashMode::AssertAfterParse)
+    debugFailWithAssertion();
+  else if (CrashMode == FrontendOptions::DebugCrashMode::CrashAfterParse)
+    debugFailWithCrash();
+
+  ASTContext &Context = Instance.getASTContext();
+  recordMemoryUsage(Context, FrontendStats::Phase::Sema);
+
+  if (Action == FrontendOptions::REPL) {
+    runREPL(Instance, ProcessCmdLine(Args.begin(), Args.end()),
+            Invocation.getParseStdlib());
+    return false;
+  }
+
+  SourceFile *PrimarySourceFile = Instance.getPrimarySourceFile();
+
+  // We've been told to dump the AST (either after parsing or type-checking,
+  // which is already differentiated in CompilerInstance::performSema()),
+  // so dump or print the main source file and return.
+  if (Action == FrontendOptions::DumpParse ||
+      Action == FrontendOptions::DumpAST ||
+      Action == FrontendOptions::PrintAST ||
+      Action == FrontendOptions::DumpTypeRefinementContexts ||
+      Action == FrontendOptions::DumpInterfaceHash) {
+    SourceFile *SF = PrimarySourceFile;
+    if (!SF) {
+      SourceFileKind Kind = Invocation.getSourceFileKind();
+      SF = &Instance.getMainModule()->getMainSourceFile(Kind);
+    }
+    if (Action == FrontendOptions::PrintAST)
+      SF->print(llvm::outs(), PrintOptions::printEverything());
+    else if (Action == FrontendOptions::DumpTypeRefinementContexts)
+      SF->getTypeRefinementContext()->dump(llvm::errs(), Context.SourceMgr);
+    else if (Action == FrontendOptions::DumpInterfaceHash)
+      SF->dumpInterfaceHash(llvm::errs());
+    else
+      SF->dump();
+    return false;
+  }
+
+  // If we were asked to print Clang stats, do so.
+  if (opts.PrintClangStats && Context.getClangModuleLoader())
+    Context.getClangModuleLoader()->printStatistics();
+
+  if (!opts.DependenciesFilePath.empty())
+    (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
+                               opts);
+
+  if (shouldTrackReferences)
+    emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
+                              *Instance.getDependencyTracker(), opts);
+
+  if (Context.hadError())
+    return true;
+
+  // The imported modules are loaded, so there is nothing left to do.
+  if (Action == FrontendOptions::ResolveImports)
+    return false;
+
+  // FIXME: This is still a lousy approximation of whether the module file will
+  // be externally consumed.
+  bool moduleIsPublic =
+      !Instance.getMainModule()->hasEntryPoint() &&
+      opts.ImplicitObjCHeaderPath.empty() &&
+      !Context.LangOpts.EnableAppExtensionRestrictions;
+
+  // We've just been told to perform a parse, so we can return now.
+  if (Action == FrontendOptions::Parse) {
+    if (!opts.ObjCHeaderOutputPath.empty())
+      return printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
+                         opts.ImplicitObjCHeaderPath, moduleIsPublic);
+    return false;
+  }
+
+  assert(Action >= FrontendOptions::EmitSILGen &&
+         "All actions not requiring SILGen must have been handled!");
+
+  if (!opts.hasMultiplePrimaryInputs()) {
+    return performCompileStepsPostSema(Instance, Invocation, opts,
+                                       PrimarySourceFile, IRGenOpts,
+                                       moduleIsPublic, ReturnValue);
+  }
+
+  // Each primary file gets its own SIL module and its own outputs, but they
+  // all share the ASTContext and the modules it has already loaded.
+  bool hadError = false;
+  for (unsigned i = 0, e = opts.AdditionalPrimaryInputs.size() + 1; i != e;
+       ++i) {
+    FrontendOptions primaryOpts = opts.getOptionsForPrimaryInput(i);
+    IRGenOptions primaryIRGenOpts = IRGenOpts;
+    hadError |= performCompileStepsPostSema(
+        Instance, Invocation, primaryOpts,
+        Instance.getPrimarySourceFileForInput(i), primaryIRGenOpts,
+        moduleIsPublic, ReturnValue);
+  }
+  return hadError;
+}
+
+/// Prints what was deserialized from each Swift module that was loaded, for
+/// -print-deserialization-stats.
+static void printDeserializationStats(ASTContext &Context, raw_ostream &os) {
+  os << "*** Deserialization statistics ***\n";
+  for (auto &loaded : Context.LoadedModules)
+    for (const FileUnit *file : loaded.second->getFiles())
+      if (auto *serialized = dyn_cast<SerializedASTFile>(file))
+        serialized->printDeserializationStats(os);
+}
+
+/// Writes \p Stats to a file named after this process in \p OutDir, so that
+/// the driver can find the statistics of each job it ran.
+static void writeFrontendStats(DiagnosticEngine &Diags,
+                               const FrontendStats &Stats, StringRef OutDir) {
+  std::error_code EC = llvm::sys::fs::create_directories(OutDir);
+  SmallString<128> Path(OutDir);
+  llvm::sys::path::append(Path, "frontend-" +
+                                llvm::Twine(llvm::sys::Process::getProcessId()) +
+                                ".json");
+  if (!EC) {
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+    if (!EC) {
+      Stats.writeJSON(OS);
+      return;
+    }
+  }
+  Diags.diagnose(SourceLoc(), diag::cannot_open_file, Path, EC.message());
+}
+
 /// Returns true if an error occurred.
 static bool dumpAPI(Module *Mod, StringRef OutDir) {
   using namespace llvm::sys;
@@ -1104,10 +1462,25 @@ int frontend_main(ArrayRef<const char *>Args,
     return 1;
   }
 
+  const std::string &StatsOutputDir =
+    Invocation.getFrontendOptions().StatsOutputDir;
+  std::unique_ptr<FrontendStats> Stats;
+  if (!StatsOutputDir.empty()) {
+    Stats.reset(new FrontendStats());
+    Stats->NumJobs = 1;
+    Instance.getASTContext().Stats = Stats.get();
+  }
+
   int ReturnValue = 0;
   bool HadError = performCompile(Instance, Invocation, Args, ReturnValue) ||
                   Instance.getASTContext().hadError();
 
+  if (Stats)
+    writeFrontendStats(Instance.getDiags(), *Stats, StatsOutputDir);
+
+  if (Invocation.getLangOptions().TraceDeserialization)
+    printDeserializationStats(Instance.getASTContext(), llvm::errs());
+
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
                        Invocation.getFrontendOptions().DumpAPIPath);
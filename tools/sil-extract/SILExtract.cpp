@@ -219,6 +219,10 @@ int main(int argc, char **argv) {
       SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
     else
       SL->getAll();
+
+    // Continue where the pipeline that wrote the file stopped.
+    if (extendedInfo.isCanonicalSIL())
+      CI.getSILModule()->setStage(SILStage::Canonical);
   }
 
   if (!FunctionName.empty())
@@ -37,6 +37,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
 using namespace swift;
 
 namespace {
@@ -153,6 +154,11 @@ ASTVerifierProcessId("ast-verifier-process-id", llvm::cl::Hidden,
 static llvm::cl::opt<bool>
 PerformWMO("wmo", llvm::cl::desc("Enable whole-module optimizations"));
 
+static llvm::cl::opt<bool>
+TimePhases("time-phases",
+           llvm::cl::desc("Print the time spent loading, optimizing and "
+                          "emitting the SIL"));
+
 static void runCommandLineSelectedPasses(SILModule *Module) {
   SILPassManager PM(Module);
 
@@ -267,7 +273,17 @@ int main(int argc, char **argv) {
   if (CI.setup(Invocation))
     return 1;
 
-  CI.performSema();
+  // The timers are printed when the group is destroyed at the end of main.
+  llvm::TimerGroup PhaseTimers("sil-opt phases");
+  llvm::Timer ParseTimer("Parse and type-check", PhaseTimers);
+  llvm::Timer LoadTimer("Load serialized SIL", PhaseTimers);
+  llvm::Timer OptimizeTimer("Run SIL passes", PhaseTimers);
+  llvm::Timer EmitTimer("Emit output", PhaseTimers);
+
+  {
+    llvm::TimeRegion Region(TimePhases ? &ParseTimer : nullptr);
+    CI.performSema();
+  }
 
   // If parsing produced an error, don't run any passes.
   if (CI.getASTContext().hadError())
@@ -276,6 +292,7 @@ int main(int argc, char **argv) {
   // Load the SIL if we have a module. We have to do this after SILParse
   // creating the unfortunate double if statement.
   if (HasSerializedAST) {
+    llvm::TimeRegion Region(TimePhases ? &LoadTimer : nullptr);
     assert(!CI.hasSILModule() &&
            "performSema() should not create a SILModule.");
     CI.setSILModule(SILModule::createEmptyModule(CI.getMainModule(),
@@ -287,6 +304,10 @@ int main(int argc, char **argv) {
       SL->getAllForModule(CI.getMainModule()->getName(), nullptr);
     else
       SL->getAll();
+
+    // Continue where the pipeline that wrote the file stopped.
+    if (extendedInfo.isCanonicalSIL())
+      CI.getSILModule()->setStage(SILStage::Canonical);
   }
 
   // If we're in verify mode, install a custom diagnostic handling for
@@ -294,14 +315,18 @@ int main(int argc, char **argv) {
   if (VerifyMode)
     enableDiagnosticVerifier(CI.getSourceMgr());
 
-  if (OptimizationGroup == OptGroup::Diagnostics) {
-    runSILDiagnosticPasses(*CI.getSILModule());
-  } else if (OptimizationGroup == OptGroup::Performance) {
-    runSILOptimizationPasses(*CI.getSILModule());
-  } else {
-    runCommandLineSelectedPasses(CI.getSILModule());
+  {
+    llvm::TimeRegion Region(TimePhases ? &OptimizeTimer : nullptr);
+    if (OptimizationGroup == OptGroup::Diagnostics) {
+      runSILDiagnosticPasses(*CI.getSILModule());
+    } else if (OptimizationGroup == OptGroup::Performance) {
+      runSILOptimizationPasses(*CI.getSILModule());
+    } else {
+      runCommandLineSelectedPasses(CI.getSILModule());
+    }
   }
 
+  llvm::TimeRegion EmitRegion(TimePhases ? &EmitTimer : nullptr);
   if (EmitSIB) {
     llvm::SmallString<128> OutputFile;
     if (OutputFilename.size()) {
@@ -18,7 +18,6 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/PrettyStackTrace.h"
-#include "llvm/Support/Regex.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -48,6 +47,11 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<std::string>
+InputFile("input-file",
+          llvm::cl::desc("Demangle the symbols in this file instead of stdin"),
+          llvm::cl::value_desc("filename"));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -85,14 +89,35 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
   }
 }
 
-static llvm::StringRef substrBefore(llvm::StringRef whole,
-                                    llvm::StringRef part) {
-  return whole.slice(0, part.data() - whole.data());
+static bool isMangledNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == '$';
 }
 
-static llvm::StringRef substrAfter(llvm::StringRef whole,
-                                   llvm::StringRef part) {
-  return whole.substr((part.data() - whole.data()) + part.size());
+/// Copies \p text to the output, demangling everything that looks like a
+/// symbol, i.e. matches "_T[_a-zA-Z0-9$]+".
+static void demangleText(llvm::StringRef text,
+                         const swift::Demangle::DemangleOptions &options) {
+  // This doesn't handle Unicode symbols, but maybe that's okay.
+  size_t pos = 0;
+  while (true) {
+    size_t start = text.find("_T", pos);
+    if (start == llvm::StringRef::npos)
+      break;
+    size_t end = start + 2;
+    while (end < text.size() && isMangledNameChar(text[end]))
+      ++end;
+    if (end == start + 2) {
+      // A lone "_T" is not a symbol.
+      llvm::outs() << text.slice(pos, end);
+      pos = end;
+      continue;
+    }
+    llvm::outs() << text.slice(pos, start);
+    demangle(llvm::outs(), text.slice(start, end), options);
+    pos = end;
+  }
+  llvm::outs() << text.substr(pos);
 }
 
 int main(int argc, char **argv) {
@@ -105,22 +130,14 @@ int main(int argc, char **argv) {
 
   if (InputNames.empty()) {
     CompactMode = true;
-    auto input = llvm::MemoryBuffer::getSTDIN();
+    // A file is mapped into memory instead of being read.
+    auto input = llvm::MemoryBuffer::getFileOrSTDIN(
+        InputFile.empty() ? "-" : InputFile);
     if (!input) {
       llvm::errs() << input.getError().message() << '\n';
       return EXIT_FAILURE;
     }
-    llvm::StringRef inputContents = input.get()->getBuffer();
-
-    // This doesn't handle Unicode symbols, but maybe that's okay.
-    llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-    llvm::outs() << inputContents;
+    demangleText(input.get()->getBuffer(), options);
 
   } else {
     for (llvm::StringRef name : InputNames) {
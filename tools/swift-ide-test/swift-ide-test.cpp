@@ -263,6 +263,11 @@ static llvm::cl::opt<bool> CodeCompleteInitsInPostfixExpr(
     llvm::cl::desc(
         "Include initializers when completing a postfix expression"));
 
+static llvm::cl::opt<bool> CodeCompleteOnlyDependencies(
+    "code-complete-only-dependencies",
+    llvm::cl::desc(
+        "Only type check the statements a member completion depends on"));
+
 static llvm::cl::opt<bool>
 ObjCForwardDeclarations("enable-objc-forward-declarations",
     llvm::cl::desc("Import Objective-C forward declarations when possible"),
@@ -2507,6 +2512,8 @@ int main(int argc, char *argv[]) {
     !options::DisableAccessControl;
   InitInvok.getLangOptions().CodeCompleteInitsInPostfixExpr |=
       options::CodeCompleteInitsInPostfixExpr;
+  InitInvok.getLangOptions().CodeCompleteOnlyDependencies |=
+      options::CodeCompleteOnlyDependencies;
   InitInvok.getClangImporterOptions().InferImplicitProperties |=
     options::ImplicitProperties;
   InitInvok.getClangImporterOptions().ImportForwardDeclarations |=
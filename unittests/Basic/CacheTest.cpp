@@ -0,0 +1,110 @@
+#include "swift/Basic/Cache.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace swift::sys;
+
+namespace {
+
+/// A value which counts its live instances and whose cost is chosen by the
+/// test.
+struct CostedValue : llvm::RefCountedBase<CostedValue> {
+  static unsigned NumLive;
+  size_t Cost;
+
+  explicit CostedValue(size_t Cost) : Cost(Cost) { ++NumLive; }
+  ~CostedValue() { --NumLive; }
+};
+unsigned CostedValue::NumLive = 0;
+
+typedef llvm::IntrusiveRefCntPtr<CostedValue> CostedValueRef;
+
+} // end anonymous namespace
+
+namespace swift {
+namespace sys {
+template <>
+struct CacheValueCostInfo<CostedValue> {
+  static size_t getCost(const CostedValue &V) { return V.Cost; }
+};
+} // namespace sys
+} // namespace swift
+
+TEST(Cache, SetGetRemove) {
+  Cache<int, std::string> C("swift.test.cache");
+  EXPECT_FALSE(C.get(1).hasValue());
+
+  C.set(1, "one");
+  C.set(2, "two");
+  ASSERT_TRUE(C.get(1).hasValue());
+  EXPECT_EQ("one", C.get(1).getValue());
+  EXPECT_EQ("two", C.get(2).getValue());
+
+  C.set(1, "uno");
+  EXPECT_EQ("uno", C.get(1).getValue());
+
+  EXPECT_TRUE(C.remove(1));
+  EXPECT_FALSE(C.remove(1));
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_TRUE(C.get(2).hasValue());
+
+  C.clear();
+  EXPECT_FALSE(C.get(2).hasValue());
+}
+
+TEST(Cache, DestroysRemovedValues) {
+  {
+    Cache<int, CostedValueRef> C("swift.test.cache");
+    C.set(1, new CostedValue(1));
+    C.set(2, new CostedValue(1));
+    EXPECT_EQ(2u, CostedValue::NumLive);
+
+    // A value that is still referenced survives its removal.
+    CostedValueRef Held = C.get(1).getValue();
+    C.remove(1);
+    C.remove(2);
+    EXPECT_EQ(1u, CostedValue::NumLive);
+    Held = nullptr;
+    EXPECT_EQ(0u, CostedValue::NumLive);
+
+    C.set(3, new CostedValue(1));
+  }
+  EXPECT_EQ(0u, CostedValue::NumLive);
+}
+
+// libcache only evicts under memory pressure.
+#if !defined(__APPLE__)
+TEST(Cache, EvictsLeastRecentlyUsedOverCostLimit) {
+  Cache<int, CostedValueRef> C("swift.test.cache");
+  C.setCostLimit(100);
+
+  for (int i = 0; i != 3; ++i)
+    C.set(i, new CostedValue(30));
+
+  // Use 0, so that 1 is the least recently used entry.
+  EXPECT_TRUE(C.get(0).hasValue());
+
+  C.set(3, new CostedValue(30));
+  EXPECT_TRUE(C.get(0).hasValue());
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_TRUE(C.get(2).hasValue());
+  EXPECT_TRUE(C.get(3).hasValue());
+  EXPECT_EQ(3u, CostedValue::NumLive);
+
+  // A large value evicts several entries.
+  C.set(4, new CostedValue(70));
+  EXPECT_TRUE(C.get(3).hasValue());
+  EXPECT_TRUE(C.get(4).hasValue());
+  EXPECT_EQ(2u, CostedValue::NumLive);
+
+  // Lowering the limit evicts right away.
+  C.setCostLimit(70);
+  EXPECT_FALSE(C.get(3).hasValue());
+  EXPECT_TRUE(C.get(4).hasValue());
+  EXPECT_EQ(1u, CostedValue::NumLive);
+
+  C.clear();
+  EXPECT_EQ(0u, CostedValue::NumLive);
+}
+#endif
@@ -1,4 +1,5 @@
 #include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
 #include "gtest/gtest.h"
 
 using namespace swift;
@@ -208,3 +209,30 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, FromAPInt) {
+  auto vec = ClusteredBitVector::fromAPInt(APInt(0, 0));
+  EXPECT_EQ(0u, vec.size());
+
+  vec = ClusteredBitVector::fromAPInt(APInt(200, 0));
+  EXPECT_EQ(200u, vec.size());
+  EXPECT_EQ(0u, vec.count());
+
+  uint64_t words[] = { 0x8000000000000001ULL, 0, 0x5 };
+  APInt value(131, words);
+  vec = ClusteredBitVector::fromAPInt(value);
+  EXPECT_EQ(131u, vec.size());
+  EXPECT_EQ(3u, vec.count());
+  EXPECT_EQ(true, vec[0]);
+  EXPECT_EQ(true, vec[63]);
+  EXPECT_EQ(false, vec[64]);
+  EXPECT_EQ(true, vec[128]);
+  EXPECT_EQ(false, vec[129]);
+  EXPECT_EQ(true, vec[130]);
+  EXPECT_TRUE(vec.asAPInt() == value);
+
+  vec = ClusteredBitVector::fromAPInt(APInt(7, 0x55));
+  EXPECT_EQ(7u, vec.size());
+  EXPECT_EQ(4u, vec.count());
+  EXPECT_TRUE(vec.asAPInt() == APInt(7, 0x55));
+}
@@ -0,0 +1,53 @@
+#include "swift/Basic/JSONSerialization.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+#include <string>
+
+using namespace swift;
+
+namespace {
+struct Entry {
+  std::string Name;
+  uint32_t Count;
+};
+} // end anonymous namespace
+
+namespace swift {
+namespace json {
+template <>
+struct ObjectTraits<Entry> {
+  static void mapping(Output &out, Entry &E) {
+    out.mapRequired("name", E.Name);
+    out.mapRequired("count", E.Count);
+  }
+};
+} // end namespace json
+} // end namespace swift
+
+static std::string toJSON(Entry E) {
+  std::string Result;
+  llvm::raw_string_ostream OS(Result);
+  json::Output Out(OS, /*PrettyPrint=*/false);
+  Out << E;
+  return OS.str();
+}
+
+TEST(JSONSerialization, Scalars) {
+  EXPECT_EQ("{\"name\":\"\",\"count\":0}", toJSON({ "", 0 }));
+  EXPECT_EQ("{\"name\":\"main.swift\",\"count\":4294967295}",
+            toJSON({ "main.swift", 4294967295u }));
+}
+
+TEST(JSONSerialization, Escapes) {
+  EXPECT_EQ("{\"name\":\"\\\"a\\\\b\\/c\\\"\",\"count\":1}",
+            toJSON({ "\"a\\b/c\"", 1 }));
+  EXPECT_EQ("{\"name\":\"\\n\\r\\t\\b\\f\\u0001\\u001f\",\"count\":2}",
+            toJSON({ "\n\r\t\b\f\x01\x1f", 2 }));
+  EXPECT_EQ("{\"name\":\"x\\ny\\u0000z\",\"count\":3}",
+            toJSON({ std::string("x\ny\0z", 5), 3 }));
+
+  // Long runs without escapes, and non-ASCII bytes, are copied as-is.
+  std::string Long(1000, 'a');
+  Long += "\xC3\xA9";
+  EXPECT_EQ("{\"name\":\"" + Long + "\",\"count\":4}", toJSON({ Long, 4 }));
+}
@@ -67,6 +67,19 @@ struct Tester {
     EXPECT_EQ(key.begin() + stdmapResult->first.size(), premapResult.second);
   }
 
+  // Bulk-inserts entries with sorted keys into both maps.
+  void insertSorted(ArrayRef<std::pair<StringRef, int>> entries) {
+    for (auto &entry : entries)
+      StdMap.insert({entry.first, entry.second});
+    PreMap.insertSorted(entries,
+                        [](const std::pair<StringRef, int> &entry) {
+                          return asArray(entry.first);
+                        },
+                        [](const std::pair<StringRef, int> &entry) {
+                          return entry.second;
+                        });
+  }
+
   // Perform a clear operation.  Tests that that actually clears out the map.
   void clear() {
     StdMap.clear();
@@ -182,3 +195,26 @@ TEST(PrefixMapTest, Test4) {
   tester.validate();
   tester.find("zguowwnctgmkg");
 }
+
+TEST(PrefixMapTest, InsertSorted) {
+  Tester tester;
+  tester.insertSorted({ {"", 0}, {"a", 1}, {"ab", 2}, {"abc", 3},
+                        {"abcdefghijklmnop", 4}, {"abd", 5}, {"b", 6},
+                        {"bcd", 7}, {"c", 8}, {"cc", 9}, {"zzz", 10} });
+  tester.validate();
+  tester.find("");
+  tester.find("abcdefg");
+  tester.find("abcdefghijklmnopq");
+  tester.find("abdd");
+  tester.find("bc");
+  tester.find("bcde");
+  tester.find("ccc");
+  tester.find("zz");
+  tester.find("zzzz");
+
+  // Later single insertions still work.
+  tester.insert("abce", 11);
+  tester.insert("bcd", 12);
+  tester.validate();
+  tester.find("abcex");
+}
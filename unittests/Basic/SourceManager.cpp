@@ -85,3 +85,50 @@ TEST(SourceManager, RangeContains) {
   EXPECT_TRUE(SM.rangeContains(R_ad, R_bc));
 }
 
+
+TEST(SourceManager, LineAndColumn) {
+  SourceManager SM;
+  auto Locs = tokenize(SM, "a\nbb cc\n\ndd\r\nee ff");
+  ASSERT_EQ(3u, Locs.size());
+
+  EXPECT_EQ(std::make_pair(1u, 1u), SM.getLineAndColumn(Locs[0]));
+  EXPECT_EQ(std::make_pair(1u, 2u),
+            SM.getLineAndColumn(Locs[0].getAdvancedLoc(1)));
+  EXPECT_EQ(std::make_pair(2u, 1u),
+            SM.getLineAndColumn(Locs[0].getAdvancedLoc(2)));
+  EXPECT_EQ(std::make_pair(2u, 4u), SM.getLineAndColumn(Locs[1]));
+  EXPECT_EQ(std::make_pair(3u, 1u),
+            SM.getLineAndColumn(Locs[1].getAdvancedLoc(3)));
+  EXPECT_EQ(std::make_pair(4u, 1u),
+            SM.getLineAndColumn(Locs[1].getAdvancedLoc(4)));
+  EXPECT_EQ(std::make_pair(5u, 1u),
+            SM.getLineAndColumn(Locs[1].getAdvancedLoc(8)));
+  EXPECT_EQ(std::make_pair(5u, 4u), SM.getLineAndColumn(Locs[2]));
+
+  // Agree with llvm::SourceMgr everywhere in the buffer, including the end.
+  auto Start = static_cast<const char *>(Locs[0].getOpaquePointerValue());
+  for (unsigned i = 0; i <= 18; ++i) {
+    SMLoc Loc = SMLoc::getFromPointer(Start + i);
+    auto Expected = SM.getLLVMSourceMgr().getLineAndColumn(Loc);
+    auto Actual = SM.getLineAndColumn(Locs[0].getAdvancedLoc(i));
+    EXPECT_EQ(Expected.first, Actual.first);
+    EXPECT_EQ(Expected.second, Actual.second);
+    EXPECT_EQ(Expected.first, SM.getLineNumber(Locs[0].getAdvancedLoc(i)));
+  }
+}
+
+TEST(SourceManager, LineAndColumns) {
+  SourceManager SM;
+  auto LocsA = tokenize(SM, "aaa\nbbb ccc");
+  auto LocsB = tokenize(SM, "ddd eee\nfff");
+
+  SmallVector<std::pair<unsigned, unsigned>, 4> Result;
+  SM.getLineAndColumns({ LocsA[0], LocsB[1], LocsB[1].getAdvancedLoc(4),
+                         LocsA[1], LocsB[0] }, Result);
+  ASSERT_EQ(5u, Result.size());
+  EXPECT_EQ(std::make_pair(1u, 1u), Result[0]);
+  EXPECT_EQ(std::make_pair(1u, 5u), Result[1]);
+  EXPECT_EQ(std::make_pair(2u, 1u), Result[2]);
+  EXPECT_EQ(std::make_pair(2u, 5u), Result[3]);
+  EXPECT_EQ(std::make_pair(1u, 1u), Result[4]);
+}
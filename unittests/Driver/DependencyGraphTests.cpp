@@ -1,5 +1,6 @@
 #include "swift/Driver/DependencyGraph.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 
 using namespace swift;
 using LoadResult = DependencyGraphImpl::LoadResult;
@@ -790,3 +791,97 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, DeclInterfaceHashes) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "provides-nominal: [T]\n"
+                                 "provides-member: [[T, ''], [T, x], [T, y]]\n"
+                                 "interface-hash: \"1\"\n"
+                                 "decl-interface-hashes: [[a, a1], [b, b1], "
+                                 "[T, t1], [T, x, x1], [T, y, y1]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[T, x]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-member: [[T, y]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-nominal: [T]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(4, "depends-member: [[T, '']]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(5, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(6, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Change only the interface of T.y and b.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "interface-hash: \"2\"\n"
+                                 "decl-interface-hashes: [[a, a1], [b, b2], "
+                                 "[T, t1], [T, x, x1], [T, y, y2]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  std::sort(marked.begin(), marked.end());
+  ASSERT_EQ(3u, marked.size());
+  EXPECT_EQ(2u, marked[0]);
+  EXPECT_EQ(4u, marked[1]);
+  EXPECT_EQ(6u, marked[2]);
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_FALSE(graph.isMarked(3));
+  EXPECT_FALSE(graph.isMarked(5));
+}
+
+TEST(DependencyGraph, DeclInterfaceHashesMissing) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"1\"\n"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  // Without per-declaration hashes from the previous load, every dependent
+  // is affected.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "interface-hash: \"2\"\n"
+                                 "decl-interface-hashes: [[a, a1], [b, b1]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, ExternalInterfaceHashes) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "depends-external: [/foo, /bar]\n"
+                                 "external-interface-hashes: [[/foo, abc]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1,
+                                 "depends-external: [/foo]\n"
+                                 "external-interface-hashes: [[/foo, abc]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ("abc", graph.getExternalInterfaceHash("/foo"));
+  EXPECT_EQ("", graph.getExternalInterfaceHash("/bar"));
+
+  // If nodes were built against different interfaces, the hash is unknown.
+  EXPECT_EQ(graph.loadFromString(2,
+                                 "depends-external: [/foo]\n"
+                                 "external-interface-hashes: [[/foo, def]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ("", graph.getExternalInterfaceHash("/foo"));
+
+  EXPECT_EQ(graph.loadFromString(3, "external-interface-hashes: [/foo]"),
+            LoadResult::HadError);
+}
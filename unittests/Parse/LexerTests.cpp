@@ -352,3 +352,33 @@ TEST_F(LexerTest, NestedPlaceholder) {
   std::vector<Token> Toks = checkLex(Source, ExpectedTokens);
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
+
+TEST_F(LexerTest, LongRuns) {
+  // Runs longer than the chunks the lexer scans at once, with the interesting
+  // characters at varying offsets.
+  const char *Source =
+      "                                 \t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\tx\n"
+      "// a line comment that is long enough to span several chunks\n"
+      "/* a block comment /* nested after twenty bytes */ and\n"
+      "   continued on a second line with \xC3\xA9 in it */\n"
+      "let identifier_with_$_and_digits_0123456789_\xC3\xA9_more_ascii\n"
+      "\"a string literal with \\(interpolation) and \\\"escapes\\\" in it\"\n"
+      "// a line comment ending at the end of the buffer, no newline";
+  std::vector<tok> ExpectedTokens{
+    tok::identifier, tok::comment, tok::comment, tok::kw_let, tok::identifier,
+    tok::string_literal, tok::comment
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ("x", Toks[0].getText());
+  EXPECT_EQ(61U, Toks[1].getLength());
+  EXPECT_EQ(StringRef("/* a block comment /* nested after twenty bytes */ and\n"
+                      "   continued on a second line with \xC3\xA9 in it */"),
+            Toks[2].getText());
+  EXPECT_TRUE(Toks[3].isAtStartOfLine());
+  EXPECT_EQ(StringRef("identifier_with_$_and_digits_0123456789_\xC3\xA9"
+                      "_more_ascii"),
+            Toks[4].getText());
+  EXPECT_EQ(62U, Toks[5].getLength());
+  EXPECT_EQ(61U, Toks[6].getLength());
+}
@@ -75,6 +75,28 @@ TEST(FuzzyStringMatcher, UnicodeMatching) {
   EXPECT_FALSE(FuzzyStringMatcher(u8"ss").matchesCandidate(u8"\u00DF"));
 }
 
+TEST(FuzzyStringMatcher, CharacterMask) {
+  auto mask = FuzzyStringMatcher::getCharacterMask;
+  EXPECT_EQ(mask("abc"), mask("ABC"));
+  EXPECT_EQ(mask("abc"), mask("cabbage") & mask("abc"));
+  EXPECT_NE(mask("abz"), mask("cabbage") & mask("abz"));
+  EXPECT_EQ(0U, mask(""));
+
+  auto matches = [&](llvm::StringRef pattern, llvm::StringRef candidate) {
+    FuzzyStringMatcher m(pattern);
+    bool result = m.matchesCandidate(candidate);
+    EXPECT_EQ(result, m.matchesCandidate(candidate, mask(candidate)));
+    return result;
+  };
+  EXPECT_TRUE(matches("ASDF", "a_s_d_f"));
+  EXPECT_TRUE(matches("sd2", "asdf2"));
+  EXPECT_FALSE(matches("ASDF", "asd"));
+  EXPECT_FALSE(matches("asdf", "fdsa"));
+  EXPECT_FALSE(matches("a9", "a8"));
+  EXPECT_TRUE(matches(u8"\u2602a", u8"\u2602A"));
+  EXPECT_FALSE(matches(u8"\u00E0", u8"\u00C0"));
+}
+
 TEST(FuzzyStringMatcher, BasicScoring) {
   FuzzyStringMatcher m("ASDF");
   EXPECT_GT(m.scoreCandidate("ASDF"), m.scoreCandidate("ASDF_"));  // exact
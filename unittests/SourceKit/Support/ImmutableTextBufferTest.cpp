@@ -43,3 +43,17 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, SnapshotLineAndColumn) {
+  EditableTextBufferRef EdBuf = new EditableTextBuffer("/a/test", "ab\ncd");
+  ImmutableTextSnapshotRef Snap = EdBuf->insert(3, "xy\n");
+  EXPECT_EQ(std::make_pair(2u, 3u), Snap->getLineAndColumn(5));
+  EXPECT_EQ(std::make_pair(3u, 2u), Snap->getLineAndColumn(7));
+  EXPECT_EQ(Snap->getBuffer()->getLineAndColumn(7),
+            Snap->getLineAndColumn(7));
+
+  // Earlier snapshots keep their text.
+  ImmutableTextSnapshotRef Later = EdBuf->erase(0, 3);
+  EXPECT_EQ("ab\nxy\ncd", Snap->getRope().str());
+  EXPECT_EQ("xy\ncd", Later->getBuffer()->getText());
+}
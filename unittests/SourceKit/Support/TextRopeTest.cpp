@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2015 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/TextRope.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace SourceKit;
+using namespace llvm;
+
+TEST(TextRope, Replace) {
+  TextRope Rope("hello world");
+  EXPECT_EQ(11u, Rope.size());
+
+  TextRope Inserted = Rope.replace(6, 0, "all ");
+  EXPECT_EQ("hello all world", Inserted.str());
+  // The original rope is unchanged.
+  EXPECT_EQ("hello world", Rope.str());
+
+  EXPECT_EQ("hello all", Inserted.replace(9, 6, "").str());
+  EXPECT_EQ("yo world", Rope.replace(0, 5, "yo").str());
+  EXPECT_EQ("", Rope.replace(0, 11, "").str());
+  EXPECT_TRUE(TextRope().empty());
+}
+
+TEST(TextRope, LineAndColumn) {
+  TextRope Rope("ab\ncd\n\nefg");
+  EXPECT_EQ(3u, Rope.getNumNewlines());
+  EXPECT_EQ(std::make_pair(1u, 1u), Rope.getLineAndColumn(0));
+  EXPECT_EQ(std::make_pair(1u, 3u), Rope.getLineAndColumn(2));
+  EXPECT_EQ(std::make_pair(2u, 1u), Rope.getLineAndColumn(3));
+  EXPECT_EQ(std::make_pair(3u, 1u), Rope.getLineAndColumn(6));
+  EXPECT_EQ(std::make_pair(4u, 4u), Rope.getLineAndColumn(10));
+  EXPECT_EQ(std::make_pair(0u, 0u), Rope.getLineAndColumn(11));
+
+  EXPECT_EQ(0u, Rope.getLineStartOffset(1));
+  EXPECT_EQ(3u, Rope.getLineStartOffset(2));
+  EXPECT_EQ(7u, Rope.getLineStartOffset(4));
+  EXPECT_EQ(10u, Rope.getLineStartOffset(5));
+}
+
+/// Applies random edits to a rope of a large text, and checks it against the
+/// same edits on a std::string.
+TEST(TextRope, RandomEdits) {
+  std::string Text;
+  for (unsigned i = 0; i != 5000; ++i)
+    Text += "let x" + std::to_string(i) + " = " + std::to_string(i * 7) + "\n";
+
+  TextRope Rope(Text);
+  std::mt19937 Gen(42);
+  for (unsigned i = 0; i != 2000; ++i) {
+    size_t Offset = Gen() % (Text.size() + 1);
+    size_t Length = std::min<size_t>(Gen() % 8, Text.size() - Offset);
+    std::string Insert(Gen() % 4, 'a' + i % 26);
+    if (i % 5 == 0)
+      Insert += '\n';
+
+    Text.replace(Offset, Length, Insert);
+    Rope = Rope.replace(Offset, Length, Insert);
+  }
+
+  ASSERT_EQ(Text.size(), Rope.size());
+  EXPECT_EQ(Text, Rope.str());
+
+  for (size_t Offset = 0; Offset < Text.size(); Offset += 997) {
+    unsigned Line = 1 + std::count(Text.begin(), Text.begin() + Offset, '\n');
+    size_t LineStart = Text.rfind('\n', Offset == 0 ? 0 : Offset - 1);
+    LineStart = (LineStart == std::string::npos || Offset == 0) ? 0
+                                                                : LineStart + 1;
+    EXPECT_EQ(std::make_pair(Line, unsigned(Offset - LineStart + 1)),
+              Rope.getLineAndColumn(Offset));
+  }
+}
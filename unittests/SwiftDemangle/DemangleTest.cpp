@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "swift/SwiftDemangle/SwiftDemangle.h"
@@ -60,3 +61,33 @@ TEST(FunctionNameDemangleTests, IgnoresNonMangledInputs) {
   EXPECT_STREQ("0123456789abcdef", OutputBuffer);
 }
 
+
+TEST(FunctionNameDemangleTests, DemanglesBatch) {
+  const char *FunctionNames[] = {
+    "_TFC3foo3bar3basfT3zimCS_3zim_T_",
+    "printf",
+    "_TF4main3fooFT3argGSqGSaSi___T_",
+  };
+  const char *DemangledName0 = "foo.bar.bas (zim : foo.zim) -> ()";
+  const char *DemangledName2 = "main.foo (arg : [Swift.Int]?) -> ()";
+  size_t Needed = strlen(DemangledName0) + 1 + strlen(DemangledName2) + 1;
+
+  char OutputBuffer[128];
+  size_t Offsets[3];
+  size_t Result = swift_demangle_getDemangledNames(
+      FunctionNames, 3, OutputBuffer, sizeof(OutputBuffer), Offsets);
+
+  EXPECT_EQ(Needed, Result);
+  EXPECT_EQ(0U, Offsets[0]);
+  EXPECT_EQ(SIZE_MAX, Offsets[1]);
+  EXPECT_EQ(strlen(DemangledName0) + 1, Offsets[2]);
+  EXPECT_STREQ(DemangledName0, OutputBuffer + Offsets[0]);
+  EXPECT_STREQ(DemangledName2, OutputBuffer + Offsets[2]);
+
+  // Names which don't fit are not written, but still counted.
+  Result = swift_demangle_getDemangledNames(FunctionNames, 3, OutputBuffer,
+                                            Offsets[2], Offsets);
+  EXPECT_EQ(Needed, Result);
+  EXPECT_EQ(0U, Offsets[0]);
+  EXPECT_EQ(SIZE_MAX, Offsets[2]);
+}
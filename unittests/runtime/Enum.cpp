@@ -153,3 +153,136 @@ TEST(EnumTest, storeEnumTagSinglePayload) {
   ASSERT_TRUE(test_storeEnumTagSinglePayload({1, 1}, {219, 123},
                                               XI_TMBi8_, 3, 4));
 }
+
+// Mock up the metadata of a multi-payload enum with the given payload area and
+// tag sizes. The payload size is stored in the word after the parent field.
+struct MultiPayloadEnum {
+  ValueWitnessTable ValueWitnesses;
+  NominalTypeDescriptor Description;
+  FullMetadata<EnumMetadata> Metadata;
+  size_t PayloadSize;
+
+  MultiPayloadEnum(size_t payloadSize, size_t numTagBytes,
+                   unsigned numPayloads, unsigned numEmptyCases)
+    : ValueWitnesses(_TWVBi8_), Description(), Metadata(),
+      PayloadSize(payloadSize) {
+    ValueWitnesses.size = payloadSize + numTagBytes;
+    ValueWitnesses.stride = payloadSize + numTagBytes;
+    Description.Kind = NominalTypeKind::Enum;
+    Description.Enum.NumPayloadCasesAndPayloadSizeOffset
+      = numPayloads | (3U << 24);
+    Description.Enum.NumEmptyCases = numEmptyCases;
+    Metadata.ValueWitnesses = &ValueWitnesses;
+    Metadata.Description = &Description;
+    Metadata.Parent = nullptr;
+  }
+
+  const EnumMetadata *get() const { return &Metadata; }
+};
+
+bool test_storeEnumTagMultiPayload(std::initializer_list<uint8_t> after,
+                                   const MultiPayloadEnum &enumType,
+                                   unsigned whichCase) {
+  std::vector<uint8_t> buf(after.size(), 0xAA);
+  swift_storeEnumTagMultiPayload(asOpaque(buf.data()), enumType.get(),
+                                 whichCase);
+  return memcmp(buf.data(), after.begin(), after.size()) == 0;
+}
+
+TEST(EnumTest, storeEnumTagMultiPayload) {
+  // One payload byte, one tag byte.
+  MultiPayloadEnum smallEnum(1, 1, 2, 512);
+  ASSERT_EQ(1u, smallEnum.get()->getPayloadSize());
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0xAA, 0}, smallEnum, 0));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0xAA, 1}, smallEnum, 1));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0, 2}, smallEnum, 2));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({5, 2}, smallEnum, 7));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({255, 2}, smallEnum, 257));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0, 3}, smallEnum, 258));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({255, 3}, smallEnum, 513));
+
+  // Pointer-sized payload, one tag byte.
+  MultiPayloadEnum wordEnum(8, 1, 3, 2);
+  ASSERT_TRUE(test_storeEnumTagMultiPayload(
+                {0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 2},
+                wordEnum, 2));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0, 0, 0, 0, 0, 0, 0, 0, 3},
+                                            wordEnum, 3));
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({1, 0, 0, 0, 0, 0, 0, 0, 3},
+                                            wordEnum, 4));
+
+  // Two tag bytes.
+  MultiPayloadEnum wideTagEnum(1, 2, 300, 0);
+  ASSERT_TRUE(test_storeEnumTagMultiPayload({0xAA, 43, 1}, wideTagEnum, 299));
+}
+
+TEST(EnumTest, getEnumCaseMultiPayload) {
+  // Check that every case survives the round trip through the enum's
+  // representation.
+  auto testRoundTrip = [](const MultiPayloadEnum &enumType) {
+    auto &desc = enumType.get()->Description->Enum;
+    std::vector<uint8_t> buf(enumType.ValueWitnesses.size);
+    for (unsigned whichCase = 0; whichCase < desc.getNumCases();
+         ++whichCase) {
+      swift_storeEnumTagMultiPayload(asOpaque(buf.data()), enumType.get(),
+                                     whichCase);
+      ASSERT_EQ(whichCase,
+                swift_getEnumCaseMultiPayload(asOpaque(buf.data()),
+                                              enumType.get()));
+    }
+  };
+
+  testRoundTrip(MultiPayloadEnum(1, 1, 2, 512));
+  testRoundTrip(MultiPayloadEnum(2, 1, 4, 1000));
+  testRoundTrip(MultiPayloadEnum(8, 1, 3, 2));
+  testRoundTrip(MultiPayloadEnum(8, 1, 3, 1000));
+  testRoundTrip(MultiPayloadEnum(1, 2, 300, 0));
+}
+
+// Mock up the metadata of a multi-payload enum instance which is laid out by
+// swift_initEnumMetadataMultiPayload, as generic metadata instantiation does.
+struct InstantiatedMultiPayloadEnum {
+  EnumValueWitnessTable ValueWitnesses;
+  NominalTypeDescriptor Description;
+  FullMetadata<EnumMetadata> Metadata;
+  size_t PayloadSize;
+
+  InstantiatedMultiPayloadEnum(const TypeLayout *payloadLayout,
+                               unsigned numPayloads, unsigned numEmptyCases)
+    : ValueWitnesses(), Description(), Metadata(), PayloadSize(0) {
+    Description.Kind = NominalTypeKind::Enum;
+    Description.Enum.NumPayloadCasesAndPayloadSizeOffset
+      = numPayloads | (3U << 24);
+    Description.Enum.NumEmptyCases = numEmptyCases;
+    Metadata.ValueWitnesses = &ValueWitnesses;
+    Metadata.Description = &Description;
+    Metadata.Parent = nullptr;
+
+    std::vector<const TypeLayout *> payloadLayouts(numPayloads, payloadLayout);
+    swift_initEnumMetadataMultiPayload(&ValueWitnesses, &Metadata,
+                                       numPayloads, payloadLayouts.data());
+  }
+
+  const EnumMetadata *get() const { return &Metadata; }
+};
+
+TEST(EnumTest, getEnumTagMultiPayloadWitness) {
+  // The getEnumTag witness installed by swift_initEnumMetadataMultiPayload
+  // must agree with swift_storeEnumTagMultiPayload for every case.
+  auto testWitness = [](const InstantiatedMultiPayloadEnum &enumType) {
+    auto &desc = enumType.get()->Description->Enum;
+    std::vector<uint8_t> buf(enumType.ValueWitnesses.size);
+    for (unsigned whichCase = 0; whichCase < desc.getNumCases();
+         ++whichCase) {
+      swift_storeEnumTagMultiPayload(asOpaque(buf.data()), enumType.get(),
+                                     whichCase);
+      ASSERT_EQ(whichCase,
+                enumType.get()->vw_getEnumTag(asOpaque(buf.data())));
+    }
+  };
+
+  testWitness(InstantiatedMultiPayloadEnum(_TWVBi8_.getTypeLayout(), 2, 512));
+  testWitness(InstantiatedMultiPayloadEnum(_TWVBi64_.getTypeLayout(), 3,
+                                           1000));
+  testWitness(InstantiatedMultiPayloadEnum(_TWVBi8_.getTypeLayout(), 300, 0));
+}
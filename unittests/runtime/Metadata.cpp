@@ -13,6 +13,7 @@
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Concurrent.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <iterator>
 #include <functional>
 #include <sys/mman.h>
@@ -215,6 +216,32 @@ TEST(Concurrent, ConcurrentList) {
   EXPECT_EQ(ListLen, results.size() * numElem);
 }
 
+TEST(Concurrent, ConcurrentHashTable) {
+  const size_t numElem = 100;
+
+  ConcurrentHashTable<size_t, 4> Table;
+  auto results = RaceTest<int*>(
+    [&]() -> int* {
+        for (size_t i = 0; i < numElem; i++)
+          Table.getBucket(i).push_front(i);
+        return nullptr;
+    }
+  );
+
+  // Every element must be found in the bucket its hash maps to, once for
+  // every racing thread.
+  size_t Total = 0;
+  for (size_t i = 0; i < numElem; i++) {
+    size_t Found = 0;
+    for (auto A : Table.getBucket(i))
+      if (A == i)
+        ++Found;
+    EXPECT_EQ(results.size(), Found);
+    Total += Found;
+  }
+  EXPECT_EQ(results.size() * numElem, Total);
+}
+
 TEST(MetadataAllocator, alloc_firstAllocationMoreThanPageSized) {
   using swift::MetadataAllocator;
   MetadataAllocator allocator;
@@ -232,6 +259,23 @@ TEST(MetadataAllocator, alloc_firstAllocationMoreThanPageSized) {
   munmap(page, pagesize);
 }
 
+TEST(MetadataAllocator, alloc_concurrent) {
+  using swift::MetadataAllocator;
+  MetadataAllocator allocator;
+
+  // Allocations made from many threads at once must never overlap.
+  auto results = RaceTest<void*>(
+    [&]() -> void* {
+      return allocator.alloc(3 * sizeof(void*));
+    });
+
+  std::sort(results.begin(), results.end());
+  for (size_t i = 1; i < results.size(); i++) {
+    EXPECT_GE((char*)results[i] - (char*)results[i-1],
+              (ptrdiff_t)(3 * sizeof(void*)));
+  }
+}
+
 TEST(MetadataTest, getGenericMetadata) {
   auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
 
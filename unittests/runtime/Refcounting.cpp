@@ -156,3 +156,36 @@ TEST(RefcountingTest, unowned_retain_release_n) {
   swift_release(object);
   EXPECT_EQ(1u, value);
 }
+
+TEST(RefcountingTest, retain_unowned_n) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  swift_retainUnowned_n(object, 31);
+  swift_retainUnowned(object);
+  EXPECT_EQ(0u, value);
+  EXPECT_EQ(33u, swift_retainCount(object));
+  swift_release_n(object, 32);
+  EXPECT_EQ(0u, value);
+  EXPECT_EQ(1u, swift_retainCount(object));
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+}
+
+TEST(RefcountingTest, weak_references_do_not_retain_memory) {
+  size_t value = 0;
+  auto object = allocTestObject(&value, 1);
+  WeakReference ref1, ref2;
+  swift_weakInit(&ref1, object);
+  swift_weakCopyInit(&ref2, &ref1);
+  // Weak references go through a side table, not the unowned count.
+  EXPECT_EQ(1u, swift_weakRetainCount(object));
+  auto loaded = swift_weakLoadStrong(&ref2);
+  EXPECT_EQ(object, loaded);
+  EXPECT_EQ(2u, swift_retainCount(object));
+  swift_release(loaded);
+  swift_release(object);
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(nullptr, swift_weakLoadStrong(&ref1));
+  EXPECT_EQ(nullptr, swift_weakTakeStrong(&ref2));
+  swift_weakDestroy(&ref1);
+}
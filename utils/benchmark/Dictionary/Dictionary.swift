@@ -0,0 +1,49 @@
+@_silgen_name("mach_absolute_time") func __mach_absolute_time__() -> UInt64
+
+// Measures insert, lookup and iteration of a Dictionary with String keys.
+// Pass the entry counts to measure on the command line; the default is 1k and
+// 1M entries (100M entries need many gigabytes of memory).
+
+func makeKeys(count: Int) -> [String] {
+  var keys = [String]()
+  keys.reserveCapacity(count)
+  for i in 0..<count {
+    keys.append("key-\(i)")
+  }
+  return keys
+}
+
+func benchDictionary(count: Int) {
+  let keys = makeKeys(count)
+
+  var start = __mach_absolute_time__()
+  var d = [String: Int]()
+  for (i, key) in keys.enumerate() {
+    d[key] = i
+  }
+  let insert = __mach_absolute_time__() - start
+
+  start = __mach_absolute_time__()
+  var sum = 0
+  for key in keys {
+    sum += d[key]!
+  }
+  let lookup = __mach_absolute_time__() - start
+
+  start = __mach_absolute_time__()
+  for (_, value) in d {
+    sum -= value
+  }
+  let iterate = __mach_absolute_time__() - start
+
+  print("\(count) entries: insert \(insert), lookup \(lookup), " +
+        "iterate \(iterate) nanoseconds. (\(sum))")
+}
+
+var counts = Process.arguments.dropFirst().map { Int($0)! }
+if counts.isEmpty {
+  counts = [1_000, 1_000_000]
+}
+for count in counts {
+  benchDictionary(count)
+}
@@ -0,0 +1,26 @@
+@_silgen_name("mach_absolute_time") func __mach_absolute_time__() -> UInt64
+
+// A few lines of a web server access log.
+let log = [
+"127.0.0.1 - - [10/Oct/2015:13:55:36 -0700] \"GET /index.html HTTP/1.1\" 200 2326\r\n",
+"10.0.0.7 - frank [10/Oct/2015:13:55:38 -0700] \"POST /api/v1/items HTTP/1.1\" 201 512\r\n",
+"10.0.0.9 - - [10/Oct/2015:13:56:02 -0700] \"GET /search?q=caf\u{e9} HTTP/1.1\" 200 8812\r\n",
+"192.168.1.20 - - [10/Oct/2015:13:57:11 -0700] \"GET /\u{6771}\u{4eac} HTTP/1.1\" 404 0\r\n",
+].reduce("", combine: +)
+
+func benchStringCharacterWalk() {
+  let start = __mach_absolute_time__()
+  var count = 0
+  let laps = 10000
+  for _ in 0..<laps {
+    for _ in log.characters {
+      count++
+    }
+  }
+  let delta = __mach_absolute_time__() - start
+
+  print("\(delta) nanoseconds. (\(count))")
+  print("\(Double(delta) / Double(laps)) nanoseconds/lap")
+}
+
+benchStringCharacterWalk()
@@ -0,0 +1,31 @@
+@_silgen_name("mach_absolute_time") func __mach_absolute_time__() -> UInt64
+
+// Short ASCII keys, as found in JSON objects and HTTP headers.
+var keys = [
+"id", "name", "type", "value", "count", "Content-Type", "Content-Length",
+"Accept", "Accept-Encoding", "Host", "User-Agent", "Connection", "Cookie",
+"Cache-Control", "Authorization", "Date", "Server", "ETag", "Location", "Vary"]
+
+func benchStringDictionary() {
+  var d = [String: Int]()
+  for (i, key) in keys.enumerate() {
+    d[key] = i
+  }
+
+  // Build the lookup keys at runtime so that they don't share storage with
+  // the dictionary's keys.
+  let lookups = keys.map { String($0.characters) }
+
+  let start = __mach_absolute_time__()
+  var sum = 0
+  for _ in 0..<100_000 {
+    for key in lookups {
+      sum += d[key]!
+    }
+  }
+  let delta = __mach_absolute_time__() - start
+
+  print("\(delta) nanoseconds. (\(sum))")
+}
+
+benchStringDictionary()
@@ -34,6 +34,7 @@ LICM = Pass('LICM')
 LateInliner = Pass('LateInliner')
 LoopInfoPrinter = Pass('LoopInfoPrinter')
 LoopRotate = Pass('LoopRotate')
+LoopUnroll = Pass('LoopUnroll')
 LowerAggregateInstrs = Pass('LowerAggregateInstrs')
 MandatoryInlining = Pass('MandatoryInlining')
 Mem2Reg = Pass('Mem2Reg')
@@ -83,6 +84,7 @@ PASSES = [
     LateInliner,
     LoopInfoPrinter,
     LoopRotate,
+    LoopUnroll,
     LowerAggregateInstrs,
     MandatoryInlining,
     Mem2Reg,
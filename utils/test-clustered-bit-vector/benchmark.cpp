@@ -0,0 +1,84 @@
+#include "swift/Basic/ClusteredBitVector.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include "stdlib.h"
+
+using namespace swift;
+
+/// Runs fn the given number of times and prints the average time per run.
+template <class Fn>
+static void measure(const char *name, unsigned iterations, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i != iterations; ++i)
+    fn();
+  auto end = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  llvm::outs() << llvm::format("%-28s %10.1f ns\n", name, ns / iterations);
+}
+
+/// Returns a vector of the given size with roughly one bit in density set.
+static ClusteredBitVector makeVector(size_t numBits, unsigned density) {
+  ClusteredBitVector result;
+  for (size_t i = 0; i != numBits; ++i) {
+    if (unsigned(rand()) % density == 0)
+      result.appendSetBits(1);
+    else
+      result.appendClearBits(1);
+  }
+  return result;
+}
+
+static volatile size_t Sink;
+
+static void run(size_t numBits, unsigned iterations) {
+  llvm::outs() << numBits << " bits:\n";
+  auto a = makeVector(numBits, 3);
+  auto b = makeVector(numBits, 5);
+  auto sparse = makeVector(numBits, 200);
+  auto value = a.asAPInt();
+
+  measure("operator&=", iterations, [&] {
+    auto c = a;
+    c &= b;
+    Sink = c.size();
+  });
+  measure("operator|=", iterations, [&] {
+    auto c = a;
+    c |= b;
+    Sink = c.size();
+  });
+  measure("flipAll", iterations, [&] {
+    auto c = a;
+    c.flipAll();
+    Sink = c.size();
+  });
+  measure("count", iterations, [&] { Sink = a.count(); });
+  measure("enumerateSetBits (sparse)", iterations, [&] {
+    size_t total = 0;
+    auto e = sparse.enumerateSetBits();
+    while (auto bit = e.findNext())
+      total += *bit;
+    Sink = total;
+  });
+  measure("append (unaligned)", iterations, [&] {
+    ClusteredBitVector c;
+    c.add(3, 5);
+    c.append(a);
+    Sink = c.size();
+  });
+  measure("fromAPInt", iterations, [&] {
+    Sink = ClusteredBitVector::fromAPInt(value).size();
+  });
+  measure("asAPInt", iterations, [&] {
+    Sink = a.asAPInt().getBitWidth();
+  });
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = argc > 1 ? atoi(argv[1]) : 100000;
+  srand(0);
+  for (size_t numBits : { 64, 256, 4096 })
+    run(numBits, iterations);
+}
@@ -0,0 +1,117 @@
+#include "swift/Basic/PrefixMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace swift;
+
+static ArrayRef<char> asArray(StringRef str) {
+  return ArrayRef<char>(str.begin(), str.end());
+}
+
+/// Returns the number of seconds fn takes to run.
+template <class Fn>
+static double measure(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+/// Generates distinct keys that look like mangled names: a few common
+/// prefixes followed by random identifier characters.
+static std::vector<std::string> makeKeys(size_t count, std::mt19937 &rng) {
+  static const char *const prefixes[] = {
+    "_TF", "_TFC", "_TFV", "_TWP", "_TMd", "_TTW", "_TToF"
+  };
+  std::uniform_int_distribution<unsigned> prefix(0, 6), length(4, 24);
+  std::uniform_int_distribution<char> letter('a', 'z');
+
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  while (keys.size() != count) {
+    std::string key = prefixes[prefix(rng)];
+    for (unsigned i = 0, e = length(rng); i != e; ++i)
+      key += letter(rng);
+    keys.push_back(std::move(key));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+static void report(const char *name, double seconds, size_t count) {
+  llvm::outs() << llvm::format("%-32s %8.1f ns/op\n", name,
+                               seconds * 1e9 / count);
+}
+
+/// Looks up every key in random order and reports the average latency.
+static void benchmarkLookups(const char *name, const PrefixMap<char, int> &map,
+                             const std::vector<std::string> &queries) {
+  size_t found = 0;
+  double seconds = measure([&] {
+    for (auto &query : queries)
+      if (map.findPrefix(asArray(query)).first)
+        ++found;
+  });
+  if (found != queries.size()) {
+    llvm::errs() << "error: " << name << " found only " << found << " of "
+                 << queries.size() << " keys\n";
+    exit(1);
+  }
+  report(name, seconds, queries.size());
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? atol(argv[1]) : 1000000;
+  std::mt19937 rng(0);
+  auto keys = makeKeys(count, rng);
+  count = keys.size();
+  llvm::outs() << count << " keys\n";
+
+  // Queries extend each key, so that they exercise prefix matching.
+  std::vector<std::string> queries;
+  queries.reserve(count);
+  for (auto &key : keys)
+    queries.push_back(key + "_suffix");
+  std::shuffle(queries.begin(), queries.end(), rng);
+
+  std::vector<size_t> shuffled(count);
+  for (size_t i = 0; i != count; ++i)
+    shuffled[i] = i;
+  std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+  {
+    PrefixMap<char, int> map;
+    report("insert (random order)", measure([&] {
+      for (size_t i : shuffled)
+        map.insert(asArray(keys[i]), int(i));
+    }), count);
+    benchmarkLookups("findPrefix (random inserts)", map, queries);
+  }
+
+  {
+    PrefixMap<char, int> map;
+    report("insertSorted", measure([&] {
+      map.insertSorted(ArrayRef<std::string>(keys),
+                       [](const std::string &key) { return asArray(key); },
+                       [&](const std::string &key) {
+                         return int(&key - keys.data());
+                       });
+    }), count);
+    benchmarkLookups("findPrefix (insertSorted)", map, queries);
+  }
+
+  {
+    PrefixMap<char, int> map;
+    report("insert (sorted order)", measure([&] {
+      for (size_t i = 0; i != count; ++i)
+        map.insert(asArray(keys[i]), int(i));
+    }), count);
+    benchmarkLookups("findPrefix (sorted inserts)", map, queries);
+  }
+}
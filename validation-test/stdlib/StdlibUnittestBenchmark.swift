@@ -0,0 +1,34 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/a.out
+// RUN: %target-run %t/a.out | FileCheck %s
+// RUN: env SWIFT_RUNTIME_ALLOCATION_STATS=1 %target-run %t/a.out 2>/dev/null | FileCheck --check-prefix=ALLOCS %s
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+//
+// Check the output format of benchmark() and that allocations are counted
+// when the runtime collects allocation statistics.
+//
+
+let result = benchmark("ArrayAppend", samples: 3, warmupSamples: 1,
+                       minimumSampleTime: 0.001) {
+  var array: [Int] = []
+  for i in 0..<identity(16) {
+    array.append(i)
+  }
+  blackHole(array)
+}
+// CHECK: [ BENCH    ] {"name": "ArrayAppend", "iterations": {{[0-9]+}}, "samples": 3, "outliers": {{[0-9]+}}, "min": {{[-+.e0-9]+}}, "median": {{[-+.e0-9]+}}, "mad": {{[-+.e0-9]+}}}{{$}}
+// ALLOCS: [ BENCH    ] {"name": "ArrayAppend", {{.*}}, "allocations": {{[.0-9]+}}, "allocated_bytes": {{[.0-9]+}}}
+
+// CHECK: iterations positive: true
+print("iterations positive: \(result.iterations > 0)")
+// CHECK: median within range: true
+print("median within range: \(result.min <= result.median)")
+
+// The benchmark's array grows at least once per iteration.
+// ALLOCS: allocates: true
+if let allocations = result.allocations {
+  print("allocates: \(allocations >= 1)")
+}
@@ -893,6 +893,23 @@ StringTests.test(
     String._compareDeterministicUnicodeCollation, String._compareASCII)
 }
 
+StringTests.test("compareDeterministicUnicodeCollation/candidates") {
+  let domain = [
+    "", "a", "A", "ab", "aB", "b", "a-b", "a b", "\u{0}a", "abc",
+    "\u{E9}", "e\u{301}", "\u{E9}t\u{E9}", "\u{1F1FA}\u{1F1F8}", "\u{B977}",
+  ]
+  // Also check strings in UTF-16 storage that only hold ASCII characters.
+  let utf16Domain = domain.map {
+    String(($0 + "\u{B977}").characters.dropLast())
+  }
+  let candidates = domain + utf16Domain
+  for s in candidates {
+    expectEqual(
+      candidates.map { s._compareDeterministicUnicodeCollation($0) },
+      s._compareDeterministicUnicodeCollation(candidates: candidates))
+  }
+}
+
 StringTests.test("lowercaseString") {
   // Use setlocale so tolower() is correct on ASCII.
   setlocale(LC_ALL, "C")